@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory::core {
+
+// === Block compression ===
+//
+// Codecs for independently compressed blocks of stored data, recorded per
+// block so that a file can mix them and new codecs can be added.
+//
+// LZ is a byte-oriented LZ77 in the LZ4 block format: sequences of a token
+// (literal length, match length), the literals and a 16-bit match offset.
+// It compresses text around 2x at several hundred MB/s and decompresses at
+// memory speed, which matters more here than the last few percent of ratio.
+enum class BlockCodec : uint8_t {
+    NONE = 0,
+    LZ = 1
+};
+
+std::string blockCodecToString(BlockCodec codec);
+// "none" or "lz"; anything else throws std::invalid_argument
+BlockCodec stringToBlockCodec(const std::string& name);
+
+// Upper bound of lzCompress() output for size input bytes
+size_t lzCompressBound(size_t size);
+
+// Appends the compressed form of input to out; returns the bytes appended
+size_t lzCompress(std::span<const uint8_t> input, std::vector<uint8_t>& out);
+
+// Decompresses input into exactly output.size() bytes. Throws
+// StorageException if input is malformed or does not decode to that size.
+void lzDecompress(std::span<const uint8_t> input, std::span<uint8_t> output);
+
+} // namespace memory::core
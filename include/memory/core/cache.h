@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace memory::core {
+
+// Count-min sketch of recent access frequencies (TinyLFU), with counters
+// saturating at 15, one byte each. Counts are halved every 10 x width
+// increments, so old popularity fades. Not thread-safe.
+class FrequencySketch {
+public:
+    // width is rounded up to a power of two
+    explicit FrequencySketch(size_t width);
+
+    void increment(uint64_t hash);
+    // Estimated recent accesses, 0..15
+    uint32_t frequency(uint64_t hash) const;
+    size_t memoryBytes() const { return table_.capacity(); }
+
+private:
+    static constexpr int kDepth = 4;
+    static constexpr uint8_t kMaxCount = 15;
+
+    size_t slot(uint64_t hash, int row) const;
+    void age();
+
+    std::vector<uint8_t> table_;  // kDepth rows of width counters
+    size_t mask_;
+    size_t additions_ = 0;
+    size_t sample_size_;
+};
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t admitted = 0;  // Window entries let into the main area
+    uint64_t rejected = 0;  // Window entries dropped by the admission filter
+    uint64_t evicted = 0;
+    size_t entries = 0;
+    size_t bytes = 0;  // Charged bytes resident, pinned included
+    size_t pinned_bytes = 0;
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+// === Sharded cache ===
+//
+// Byte-budgeted cache with W-TinyLFU admission, split into independently
+// locked shards by key hash. Each shard keeps a small LRU window (1% of its
+// budget) in front of a segmented LRU main area (80% protected, the rest
+// probation). An entry leaving the window enters the main area only if the
+// sketch has seen it more often than the probation entry it would evict, so
+// a one-off scan churns the window and leaves the hot set alone.
+//
+// Pinned keys bypass admission and eviction: once inserted they stay until
+// unpinned or erased, even if pinned bytes exceed the budget, which then
+// squeezes the unpinned entries. Pins are set per key and outlive the value,
+// so a pinned key that is erased or cleared is pinned again on its next
+// insert.
+//
+// Values are shared_ptrs: a reader keeps its value alive even if the entry
+// is evicted meanwhile. Thread-safe.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedCache {
+public:
+    // average_charge sizes the frequency sketch at one counter per expected
+    // entry; guessing low only costs memory
+    explicit ShardedCache(size_t capacity_bytes, size_t shards = 16, size_t average_charge = 256)
+        : capacity_(capacity_bytes), shards_(std::max<size_t>(shards, 1)) {
+        size_t per_shard = capacity_bytes / shards_.size();
+        for (Shard& shard : shards_) shard.configure(per_shard, std::max<size_t>(average_charge, 1));
+    }
+
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+
+    // nullptr on a miss; counts towards the hit rate
+    std::shared_ptr<const Value> find(const Key& key) {
+        uint64_t hash = mix(hasher_(key));
+        Shard& shard = shardOf(hash);
+        std::lock_guard lock(shard.mutex);
+        return shard.find(key, hash);
+    }
+
+    // Inserts or replaces the entry for key, charged charge bytes. The window
+    // always takes it; whether it stays is up to admission.
+    void insert(const Key& key, std::shared_ptr<const Value> value, size_t charge) {
+        uint64_t hash = mix(hasher_(key));
+        Shard& shard = shardOf(hash);
+        std::lock_guard lock(shard.mutex);
+        shard.insert(key, hash, std::move(value), charge);
+    }
+
+    void erase(const Key& key) {
+        uint64_t hash = mix(hasher_(key));
+        Shard& shard = shardOf(hash);
+        std::lock_guard lock(shard.mutex);
+        shard.erase(key);
+    }
+
+    void pin(const Key& key) {
+        uint64_t hash = mix(hasher_(key));
+        Shard& shard = shardOf(hash);
+        std::lock_guard lock(shard.mutex);
+        shard.pin(key);
+    }
+
+    void unpin(const Key& key) {
+        uint64_t hash = mix(hasher_(key));
+        Shard& shard = shardOf(hash);
+        std::lock_guard lock(shard.mutex);
+        shard.unpin(key);
+    }
+
+    bool pinned(const Key& key) const {
+        uint64_t hash = mix(hasher_(key));
+        const Shard& shard = shardOf(hash);
+        std::lock_guard lock(shard.mutex);
+        return shard.pins.count(key) > 0;
+    }
+
+    // Drops every value; pins and frequencies are kept
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            shard.clear();
+        }
+    }
+
+    CacheStats stats() const {
+        CacheStats total;
+        for (const Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            total.hits += shard.stats.hits;
+            total.misses += shard.stats.misses;
+            total.admitted += shard.stats.admitted;
+            total.rejected += shard.stats.rejected;
+            total.evicted += shard.stats.evicted;
+            total.entries += shard.entries.size();
+            total.bytes += shard.window_bytes + shard.probation_bytes + shard.protected_bytes + shard.pinned_bytes;
+            total.pinned_bytes += shard.pinned_bytes;
+        }
+        return total;
+    }
+
+    size_t capacityBytes() const { return capacity_; }
+
+private:
+    enum class Region : uint8_t { Window, Probation, Protected, Pinned };
+
+    struct Node {
+        Key key;
+        std::shared_ptr<const Value> value;
+        size_t charge;
+        uint64_t hash;
+        Region region;
+    };
+    using List = std::list<Node>;
+
+    // Lists are most recent first
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, typename List::iterator, Hash> entries;
+        std::unordered_set<Key, Hash> pins;
+        List window;
+        List probation;
+        List protected_;
+        List pinned;
+        size_t window_bytes = 0;
+        size_t probation_bytes = 0;
+        size_t protected_bytes = 0;
+        size_t pinned_bytes = 0;
+        size_t window_capacity = 0;
+        size_t main_capacity = 0;
+        size_t protected_capacity = 0;
+        FrequencySketch sketch{1};
+        CacheStats stats;
+
+        void configure(size_t capacity, size_t average_charge) {
+            window_capacity = std::max<size_t>(capacity / 100, 1);
+            main_capacity = capacity > window_capacity ? capacity - window_capacity : 0;
+            protected_capacity = main_capacity / 5 * 4;
+            sketch = FrequencySketch(std::max<size_t>(capacity / average_charge, 64));
+        }
+
+        List& list(Region region) {
+            switch (region) {
+            case Region::Window: return window;
+            case Region::Probation: return probation;
+            case Region::Protected: return protected_;
+            case Region::Pinned: return pinned;
+            }
+            return window;
+        }
+
+        size_t& bytes(Region region) {
+            switch (region) {
+            case Region::Window: return window_bytes;
+            case Region::Probation: return probation_bytes;
+            case Region::Protected: return protected_bytes;
+            case Region::Pinned: return pinned_bytes;
+            }
+            return window_bytes;
+        }
+
+        // Pinned bytes come out of the main area's share
+        size_t mainBytes() const { return probation_bytes + protected_bytes + pinned_bytes; }
+
+        // Moves node to the front of region's list
+        void move(typename List::iterator node, Region region) {
+            bytes(node->region) -= node->charge;
+            list(region).splice(list(region).begin(), list(node->region), node);
+            node->region = region;
+            bytes(region) += node->charge;
+        }
+
+        void remove(typename List::iterator node) {
+            bytes(node->region) -= node->charge;
+            entries.erase(node->key);
+            list(node->region).erase(node);
+        }
+
+        std::shared_ptr<const Value> find(const Key& key, uint64_t hash) {
+            sketch.increment(hash);
+            auto it = entries.find(key);
+            if (it == entries.end()) {
+                ++stats.misses;
+                return nullptr;
+            }
+            ++stats.hits;
+            auto node = it->second;
+            switch (node->region) {
+            case Region::Window:
+            case Region::Protected:
+            case Region::Pinned:
+                move(node, node->region);
+                break;
+            case Region::Probation:
+                move(node, Region::Protected);
+                demoteProtected();
+                break;
+            }
+            return node->value;
+        }
+
+        void insert(const Key& key, uint64_t hash, std::shared_ptr<const Value> value, size_t charge) {
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                auto node = it->second;
+                bytes(node->region) += charge;
+                bytes(node->region) -= node->charge;
+                node->value = std::move(value);
+                node->charge = charge;
+                move(node, node->region);
+            } else {
+                sketch.increment(hash);
+                Region region = pins.count(key) ? Region::Pinned : Region::Window;
+                list(region).push_front(Node{key, std::move(value), charge, hash, region});
+                bytes(region) += charge;
+                entries.emplace(key, list(region).begin());
+            }
+            drainWindow();
+            evictMain();
+        }
+
+        void erase(const Key& key) {
+            auto it = entries.find(key);
+            if (it != entries.end()) remove(it->second);
+        }
+
+        void pin(const Key& key) {
+            pins.insert(key);
+            auto it = entries.find(key);
+            if (it != entries.end() && it->second->region != Region::Pinned) {
+                move(it->second, Region::Pinned);
+                evictMain();
+            }
+        }
+
+        void unpin(const Key& key) {
+            if (!pins.erase(key)) return;
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                move(it->second, Region::Probation);
+                evictMain();
+            }
+        }
+
+        void clear() {
+            entries.clear();
+            window.clear();
+            probation.clear();
+            protected_.clear();
+            pinned.clear();
+            window_bytes = probation_bytes = protected_bytes = pinned_bytes = 0;
+        }
+
+        void demoteProtected() {
+            while (protected_bytes > protected_capacity && !protected_.empty()) {
+                move(std::prev(protected_.end()), Region::Probation);
+            }
+        }
+
+        // Evicts least recently used main entries, probation first, until
+        // the main area fits or only pinned entries are left
+        void evictMain() {
+            while (mainBytes() > main_capacity) {
+                List& victims = !probation.empty() ? probation : protected_;
+                if (victims.empty()) return;
+                remove(std::prev(victims.end()));
+                ++stats.evicted;
+            }
+        }
+
+        // Moves overflowing window entries into probation if they are
+        // more popular than the main entries they would displace
+        void drainWindow() {
+            while (window_bytes > window_capacity && !window.empty()) {
+                auto candidate = std::prev(window.end());
+                uint32_t frequency = sketch.frequency(candidate->hash);
+                bool admit = candidate->charge <= main_capacity;
+                while (admit && mainBytes() + candidate->charge > main_capacity) {
+                    List& victims = !probation.empty() ? probation : protected_;
+                    if (victims.empty() || frequency <= sketch.frequency(std::prev(victims.end())->hash)) {
+                        admit = false;
+                        break;
+                    }
+                    remove(std::prev(victims.end()));
+                    ++stats.evicted;
+                }
+                if (admit) {
+                    move(candidate, Region::Probation);
+                    ++stats.admitted;
+                } else {
+                    remove(candidate);
+                    ++stats.rejected;
+                }
+            }
+        }
+    };
+
+    // Spreads weak hashes (std::hash of integers is the identity)
+    static uint64_t mix(uint64_t hash) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    Shard& shardOf(uint64_t hash) { return shards_[hash % shards_.size()]; }
+    const Shard& shardOf(uint64_t hash) const { return shards_[hash % shards_.size()]; }
+
+    size_t capacity_;
+    std::vector<Shard> shards_;
+    Hash hasher_;
+};
+
+} // namespace memory::core
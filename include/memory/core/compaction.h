@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace memory::core {
+
+class Config;
+
+// === Compaction ===
+//
+// The search, graph and vector engines accumulate dead weight: removed
+// documents stay in their segments, edge changes pile up in deltas, and
+// removed vectors keep routing HNSW searches. One Compactor watches all of
+// them through ICompactable and compacts whichever crosses the
+// fragmentation threshold of design doc §22.4 (index_fragmentation > 0.25),
+// or has merge_factor segments in one size tier, on a background thread
+// whose I/O is rate-limited so recall latency does not spike.
+
+struct CompactionOptions {
+    // Compact a target once this share of what it stores is dead
+    double fragmentation_threshold = 0.25;
+    // Segments of one size tier (sizes within a factor of merge_factor)
+    // that are merged together
+    size_t merge_factor = 10;
+    // Bytes per second compaction may read and write; 0 for no limit
+    double rate_bytes = 32.0 * (1 << 20);
+    // Pause between two checks of the background thread
+    std::chrono::milliseconds interval{1000};
+
+    // Reads database.compaction_threshold / compaction_rate_mb /
+    // compaction_interval_ms and search.merge_factor
+    static CompactionOptions fromConfig(const Config& config);
+};
+
+// Token bucket over bytes. acquire() blocks until the bytes fit into the
+// rate; up to one second's worth may be spent in a burst. Thread-safe.
+class RateLimiter {
+public:
+    // bytes_per_second 0 never blocks
+    explicit RateLimiter(double bytes_per_second = 0.0);
+
+    void acquire(size_t bytes);
+    double rate() const { return rate_; }
+    // Time spent blocked so far
+    std::chrono::nanoseconds throttled() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double rate_;
+    mutable std::mutex mutex_;
+    double tokens_;
+    Clock::time_point last_;
+    std::chrono::nanoseconds throttled_{0};
+};
+
+// Outcome of one compaction pass (compaction_ratio = bytesRatio())
+struct CompactionResult {
+    std::string target;
+    uint64_t bytes_before = 0;
+    uint64_t bytes_after = 0;
+    // Stored items, dead ones included: docs, edge entries, linked nodes
+    uint64_t items_before = 0;
+    uint64_t items_after = 0;
+    double fragmentation_before = 0.0;
+    double fragmentation_after = 0.0;
+    double seconds = 0.0;
+    // Empty unless compact() threw; the target is then left as it was
+    std::string error;
+
+    double bytesRatio() const {
+        return bytes_before ? static_cast<double>(bytes_after) / static_cast<double>(bytes_before) : 1.0;
+    }
+};
+
+// Something a Compactor can compact. compact() runs on the compactor's
+// thread alongside readers and writers of the target.
+class ICompactable {
+public:
+    virtual ~ICompactable() = default;
+
+    virtual std::string compactionName() const = 0;
+    // index_fragmentation: share of stored items that are dead, in [0, 1]
+    virtual double fragmentation() const = 0;
+    // Whether compact() has work to do under options
+    virtual bool compactionDue(const CompactionOptions& options) const = 0;
+    // One pass; charges the bytes it reads and writes to limiter
+    virtual CompactionResult compact(const CompactionOptions& options, RateLimiter& limiter) = 0;
+};
+
+// Running totals over every pass
+struct CompactionMetrics {
+    uint64_t runs = 0;
+    uint64_t failures = 0;  // Passes that threw; not counted in runs
+    uint64_t bytes_before = 0;
+    uint64_t bytes_after = 0;
+    double seconds = 0.0;
+    double throttled_seconds = 0.0;  // Spent waiting on the rate limit
+    // Fragmentation of each target at the last check, in add() order
+    std::vector<std::pair<std::string, double>> fragmentation;
+
+    double compactionRatio() const {
+        return bytes_before ? static_cast<double>(bytes_after) / static_cast<double>(bytes_before) : 1.0;
+    }
+};
+
+// Schedules compaction of its targets. Targets are not owned and must be
+// removed (or the compactor destroyed) before they go away.
+class Compactor {
+public:
+    explicit Compactor(CompactionOptions options = {});
+    // Stops the background thread
+    ~Compactor();
+
+    Compactor(const Compactor&) = delete;
+    Compactor& operator=(const Compactor&) = delete;
+
+    void add(ICompactable& target);
+    // Waits for a pass over target that is under way
+    void remove(ICompactable& target);
+
+    // Checks every interval in a background thread until stop()
+    void start();
+    void stop();
+    // Compacts every due target once in the calling thread; returns the
+    // passes that ran. A target that throws is logged and reported with
+    // its error, and the pass moves on to the next target.
+    std::vector<CompactionResult> runOnce();
+
+    // Last passes, oldest first (at most kHistory)
+    std::vector<CompactionResult> history() const;
+    CompactionMetrics metrics() const;
+    const CompactionOptions& options() const { return options_; }
+
+    static constexpr size_t kHistory = 64;
+
+private:
+    void loop();
+
+    CompactionOptions options_;
+    RateLimiter limiter_;
+    std::mutex run_mutex_;  // One pass at a time; guards targets_
+    std::vector<ICompactable*> targets_;
+    mutable std::mutex stats_mutex_;
+    std::deque<CompactionResult> history_;
+    CompactionMetrics metrics_;
+
+    std::mutex signal_mutex_;
+    std::condition_variable signal_cv_;
+    bool stopping_ = false;
+    std::thread worker_;
+};
+
+} // namespace memory::core
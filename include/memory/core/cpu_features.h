@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+// Architecture and per-function ISA targeting. SIMD kernels are compiled with
+// MEMORY_TARGET("avx2") etc. so the rest of the tree keeps baseline flags and
+// the best variant is picked at runtime from cpuFeatures().
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MEMORY_ARCH_X86 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MEMORY_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MEMORY_TARGET(isa)
+#endif
+
+namespace memory::core {
+
+enum class SimdLevel {
+    SCALAR = 0,
+    SSE42 = 1,
+    AVX2 = 2
+};
+
+struct CpuFeatures {
+    bool sse42 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool sha = false;  // SHA-NI (sha256rnds2 / sha256msg1 / sha256msg2)
+};
+
+// CPUID-based detection, cached after the first call
+const CpuFeatures& cpuFeatures();
+
+// Highest level supported by the CPU. The MEMORY_SIMD environment variable
+// (scalar|sse42|avx2) can lower it, e.g. to compare kernels.
+SimdLevel bestSimdLevel();
+bool simdLevelSupported(SimdLevel level);
+
+std::string simdLevelToString(SimdLevel level);
+
+} // namespace memory::core
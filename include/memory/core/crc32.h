@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace memory::core {
+
+// CRC-32C (Castagnoli), the checksum used by every segment file, WAL record
+// and manifest. Uses the SSE4.2 crc32 instruction when available and a
+// slice-by-8 table otherwise. Pass a previous result as `crc` to continue a
+// running checksum over several buffers.
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+inline uint32_t crc32c(std::span<const uint8_t> bytes, uint32_t crc = 0) {
+    return crc32c(bytes.data(), bytes.size(), crc);
+}
+
+} // namespace memory::core
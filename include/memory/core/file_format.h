@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory::core {
+
+// Packs a four-character tag into a little-endian magic number
+inline constexpr uint32_t makeMagic(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8)
+         | (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+
+// Fixed header at the start of every segment file (design doc §3.1). The
+// payload follows immediately; both are covered by CRC-32C. Fields are
+// stored in host (little-endian) byte order.
+struct FileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint64_t payload_bytes;
+    uint32_t payload_crc;
+    uint32_t reserved;
+    uint32_t reserved2;
+    uint32_t header_crc;  // Over the preceding 28 bytes
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout is part of the on-disk format");
+
+// Reserves a header at the end of out; returns its offset for sealFileHeader()
+size_t beginFileHeader(std::vector<uint8_t>& out);
+
+// Fills in the header reserved at header_offset; the payload is everything
+// appended to out after it
+void sealFileHeader(std::vector<uint8_t>& out, size_t header_offset, uint32_t magic, uint16_t version,
+                    uint16_t flags = 0);
+
+// Validates magic, version, payload length and both checksums. Returns the
+// payload (trailing bytes beyond payload_bytes are ignored). Throws
+// StorageException naming `what` on any mismatch.
+std::span<const uint8_t> checkFileHeader(std::span<const uint8_t> file, uint32_t magic, uint16_t version,
+                                         const std::string& what, FileHeader* header = nullptr);
+
+} // namespace memory::core
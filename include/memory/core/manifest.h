@@ -0,0 +1,117 @@
+#pragma once
+
+#include "memory/core/file_format.h"
+#include "memory/core/wal.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace memory::search {
+struct SearchSnapshot;
+}
+namespace memory::graph {
+class GraphSnapshot;
+}
+namespace memory::vector {
+struct HnswSnapshot;
+}
+
+namespace memory::core {
+
+// === Manifest ===
+//
+// Durable list of the segment files that make up the store at one
+// checkpoint, plus the WAL position they cover (design doc §3.1). It lives
+// in `<directory>/MANIFEST`, is replaced atomically and is covered by
+// CRC-32C like every segment file. On startup the engines open the listed
+// files and replay the log after `lsn`.
+inline constexpr uint32_t kManifestMagic = makeMagic('M', 'N', 'F', 'T');
+inline constexpr uint16_t kManifestVersion = 1;
+
+struct ManifestFile {
+    WalStream engine;
+    std::string name;  // Relative to the manifest's directory
+};
+
+struct Manifest {
+    uint64_t version = 0;  // Bumped by every checkpoint
+    uint64_t lsn = 0;      // Every WAL record up to it is in the files
+    std::vector<ManifestFile> files;
+
+    std::vector<std::string> filesOf(WalStream engine) const;
+
+    // Writes `<directory>/MANIFEST` atomically and durably: the rename is
+    // synced before this returns. Throws StorageException.
+    void save(const std::string& directory) const;
+    // nullopt if the directory holds no manifest; throws StorageException
+    // if it is damaged
+    static std::optional<Manifest> load(const std::string& directory);
+};
+
+// One consistent version of the whole store: the latest immutable snapshot
+// of each engine at one point. Holding it keeps every segment it references
+// alive, however much the engines change or compact meanwhile. Parts of
+// engines not attached to the set stay null.
+struct StoreView {
+    uint64_t version = 0;
+    std::shared_ptr<const search::SearchSnapshot> search;
+    std::shared_ptr<const graph::GraphSnapshot> graph;
+    std::shared_ptr<const vector::HnswSnapshot> vector;
+};
+
+// Current StoreView of the store, swapped atomically.
+//
+// Engines attached to the set publish every new snapshot of theirs into it
+// (writes, seals, merges); each publish replaces that engine's part and
+// bumps the version. A query pins the view once through current() and
+// reads all three engines from it, so it sees every engine as of the same
+// instant while writers and compaction carry on. Search and graph reads
+// take no lock a writer holds. Vector reads still take short per-node
+// locks: HNSW neighbor lists are rewritten in place, and only which nodes
+// a search may return is versioned (HnswSnapshot). Superseded segments are
+// reclaimed when the last view holding them is released.
+//
+// checkpoint() persists a new Manifest next to the view, then drops the
+// WAL segments it made redundant.
+class VersionSet {
+public:
+    // Without a directory, views are kept in memory only and checkpoint()
+    // is unavailable. With one, the last manifest there is loaded.
+    explicit VersionSet(std::string directory = {});
+
+    VersionSet(const VersionSet&) = delete;
+    VersionSet& operator=(const VersionSet&) = delete;
+
+    std::shared_ptr<const StoreView> current() const { return current_.load(); }
+    uint64_t version() const { return current()->version; }
+
+    void publish(std::shared_ptr<const search::SearchSnapshot> snapshot);
+    void publish(std::shared_ptr<const graph::GraphSnapshot> snapshot);
+    void publish(std::shared_ptr<const vector::HnswSnapshot> snapshot);
+
+    // Last manifest written or loaded, nullopt before the first checkpoint
+    std::optional<Manifest> manifest() const;
+    // Records files as the store up to lsn, then deletes the files of the
+    // previous manifest that are no longer listed (open mappings keep their
+    // pages) and, with a log, its segments up to lsn. Throws
+    // StorageException, leaving the previous manifest in place.
+    Manifest checkpoint(uint64_t lsn, std::vector<ManifestFile> files, WriteAheadLog* wal = nullptr);
+
+    const std::string& directory() const { return directory_; }
+
+private:
+    template <typename Replace>
+    void publishWith(const Replace& replace);
+
+    std::string directory_;
+    std::mutex publish_mutex_;  // Serializes publishers
+    std::atomic<std::shared_ptr<const StoreView>> current_;
+    mutable std::mutex manifest_mutex_;  // Serializes checkpoints
+    std::optional<Manifest> manifest_;
+};
+
+} // namespace memory::core
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace memory::core {
+
+enum class MapMode {
+    READ_ONLY,
+    // Writable copy-on-write mapping: written pages become private copies
+    // and never reach the file
+    PRIVATE
+};
+
+// Expected access to a range of a mapping (madvise)
+enum class Access {
+    NORMAL,
+    RANDOM,      // No readahead around faults
+    SEQUENTIAL,  // Aggressive readahead
+    WILLNEED     // Start reading the range in now
+};
+
+// Memory mapping of a whole file. Move-only; unmaps on destruction.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Throws StorageException if the file cannot be opened or mapped
+    static MappedFile open(const std::string& path, MapMode mode = MapMode::READ_ONLY);
+
+    const uint8_t* data() const { return data_; }
+    // nullptr unless mapped PRIVATE
+    uint8_t* mutableData() const { return mode_ == MapMode::PRIVATE ? const_cast<uint8_t*>(data_) : nullptr; }
+    size_t size() const { return size_; }
+    std::span<const uint8_t> bytes() const { return {data_, size_}; }
+    const std::string& path() const { return path_; }
+    bool isOpen() const { return !path_.empty(); }
+
+    // Hints how [offset, offset + length) will be read; the range is widened
+    // to whole pages and clipped to the file. Best effort: errors are
+    // ignored, and it does nothing on Windows.
+    void advise(size_t offset, size_t length, Access access) const;
+
+private:
+    void reset();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    MapMode mode_ = MapMode::READ_ONLY;
+    std::string path_;
+};
+
+// Streams a file into `path.tmp`, then on commit() flushes it, renames it
+// over path and syncs the directory, so readers never observe a partially
+// written file and the rename survives a crash once commit() returns. A writer
+// destroyed before commit() removes the temporary file. Move-only. Throws
+// StorageException.
+class AtomicFileWriter {
+public:
+    explicit AtomicFileWriter(std::string path);
+    ~AtomicFileWriter();
+    AtomicFileWriter(AtomicFileWriter&& other) noexcept;
+    AtomicFileWriter& operator=(AtomicFileWriter&&) = delete;
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    void append(std::span<const uint8_t> bytes);
+    // Overwrites bytes already appended, e.g. a header reserved up front
+    void writeAt(uint64_t offset, std::span<const uint8_t> bytes);
+    uint64_t size() const { return size_; }
+    // Where the bytes go until commit()
+    const std::string& tmpPath() const { return tmp_; }
+    void commit();
+
+private:
+    void close();
+
+    std::string path_;
+    std::string tmp_;
+    intptr_t handle_ = -1;  // File descriptor, or HANDLE on Windows
+    uint64_t size_ = 0;
+};
+
+// Writes bytes to `path.tmp`, flushes it and renames it over path, so
+// readers never observe a partially written file. Throws StorageException.
+void writeFileAtomically(const std::string& path, std::span<const uint8_t> bytes);
+
+// Flushes directory's entries, so files created, renamed or removed in it
+// survive a crash. Does nothing on Windows or on file systems that cannot
+// sync a directory. Throws StorageException.
+void syncDirectory(const std::string& directory);
+
+} // namespace memory::core
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "memory/core/string_interner.h"
+#include "memory/core/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memory::core {
+
+class NodeStore;
+
+// Read-only accessor for one node of a NodeStore; two words, cheap to copy.
+// Valid until the next write to the store.
+class NodeView {
+public:
+    NodeView(const NodeStore& store, uint32_t index) : store_(&store), index_(index) {}
+
+    uint32_t index() const { return index_; }
+    NodeId id() const;
+    NodeType type() const;
+    float importance() const;
+    float confidence() const;
+    Timestamp recency() const;
+    uint32_t frequency() const;
+    uint32_t tenantOrdinal() const;
+    std::string_view tenant() const;
+    std::string_view title() const;
+    std::string_view text() const;
+    // Interned IDs, see NodeStore::label()
+    std::span<const uint32_t> keywordIds() const;
+    std::span<const uint32_t> entityIds() const;
+    // nullptr if the node has no metadata
+    const std::unordered_map<std::string, std::string>* metadata() const;
+
+    // Copies the node back out, e.g. at an API boundary
+    Node materialize() const;
+
+private:
+    const NodeStore* store_;
+    uint32_t index_;
+};
+
+// === Columnar node store ===
+//
+// Node records as a structure of arrays indexed by a dense node index.
+// Scoring reads type, importance, confidence, recency, frequency and tenant
+// from flat columns, so a ranking loop over 1e6 candidates streams only the
+// bytes it needs instead of chasing the half-dozen heap blocks of every
+// core::Node. Title and text live back to back in one string heap, keywords
+// and entities as interned IDs in one label heap, and the tenant as an
+// ordinal; metadata, rarely read on the hot path, sits in a side table.
+//
+// Upserting an existing node rewrites its columns in place and appends its
+// new strings and labels; the old ones become garbage until compact().
+// Erased nodes keep their index, with type() and the other columns left as
+// they were, until compact() renumbers the survivors.
+//
+// Not thread-safe; the owner serializes writes against readers.
+class NodeStore {
+public:
+    // Inserts or replaces node; returns its index. Throws IndexException
+    // when a heap outgrows its 32-bit offsets.
+    uint32_t upsert(const Node& node);
+    // False if the node is unknown
+    bool erase(NodeId id);
+    std::optional<uint32_t> find(NodeId id) const;
+    std::optional<NodeView> get(NodeId id) const;
+    NodeView view(uint32_t index) const { return NodeView(*this, index); }
+    bool live(uint32_t index) const { return !deleted_[index]; }
+
+    // Indexes in [0, size()), erased ones included
+    uint32_t size() const { return static_cast<uint32_t>(ids_.size()); }
+    size_t liveCount() const { return index_.size(); }
+
+    // Columns, indexed by node index. recency is milliseconds since the
+    // system_clock epoch.
+    std::span<const NodeId> ids() const { return ids_; }
+    std::span<const NodeType> types() const { return types_; }
+    std::span<const float> importance() const { return importance_; }
+    std::span<const float> confidence() const { return confidence_; }
+    std::span<const int64_t> recencyMillis() const { return recency_ms_; }
+    std::span<const uint32_t> frequency() const { return frequency_; }
+    std::span<const uint32_t> tenants() const { return tenants_; }
+
+    // Tenant ordinal of tenant, StringInterner::kUnknownId if no node has it
+    uint32_t tenantOrdinal(std::string_view tenant) const { return tenant_names_.find(tenant); }
+    std::string_view tenantName(uint32_t ordinal) const { return tenant_names_.str(ordinal); }
+    // Keywords and entities share one ID space
+    uint32_t labelId(std::string_view label) const { return labels_.find(label); }
+    std::string_view label(uint32_t id) const { return labels_.str(id); }
+
+    // Heap bytes no longer referenced by any node
+    size_t garbageBytes() const { return garbage_bytes_; }
+    // Drops erased nodes and unreferenced strings; indexes of the survivors
+    // are renumbered densely in their old order
+    void compact();
+    size_t memoryBytes() const;
+
+    static int64_t toMillis(Timestamp time);
+    static Timestamp fromMillis(int64_t millis);
+
+private:
+    friend class NodeView;
+
+    // Title and text of a node, back to back in the text heap
+    struct TextRef {
+        uint32_t offset;
+        uint32_t title_size;
+        uint32_t text_size;
+    };
+    // Keywords then entities of a node in the label heap
+    struct LabelRef {
+        uint32_t offset;
+        uint32_t keywords;
+        uint32_t entities;
+    };
+
+    void store(uint32_t index, const Node& node);
+
+    std::vector<NodeId> ids_;
+    std::vector<NodeType> types_;
+    std::vector<float> importance_;
+    std::vector<float> confidence_;
+    std::vector<int64_t> recency_ms_;
+    std::vector<uint32_t> frequency_;
+    std::vector<uint32_t> tenants_;
+    std::vector<uint8_t> deleted_;
+    std::vector<TextRef> text_refs_;
+    std::vector<LabelRef> label_refs_;
+
+    std::vector<char> text_heap_;
+    std::vector<uint32_t> label_heap_;
+    size_t garbage_bytes_ = 0;
+    StringInterner tenant_names_;
+    StringInterner labels_;
+    std::unordered_map<uint32_t, std::unordered_map<std::string, std::string>> metadata_;
+    std::unordered_map<NodeId, uint32_t> index_;
+};
+
+} // namespace memory::core
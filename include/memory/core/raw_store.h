@@ -0,0 +1,221 @@
+#pragma once
+
+#include "memory/core/block_codec.h"
+#include "memory/core/sha256.h"
+#include "memory/core/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memory::core {
+
+class Config;
+class ThreadPool;
+
+// === Raw chunk store ===
+//
+// The original content behind memories (design doc §3.0): RawChunks,
+// addressed by the SHA-256 of their bytes and stored once per tenant.
+// Nodes point into them with raw_refs (RawRef), which name a byte range of
+// one chunk.
+//
+// Chunks are packed many to a file rather than one file each:
+//
+//   <directory>/tenants/<tenant>/raw/index.rawi
+//   <directory>/tenants/<tenant>/raw/YYYY/MM/DD/pack_00000001.rawp
+//
+// The date is the UTC day a chunk was created. A pack is a RawFileHeader
+// followed by chunk records, each a RawChunkHeader, a RawBlockEntry per
+// block and the blocks. Every block of block_bytes (the last one shorter)
+// is compressed on its own, so a range read decodes only the blocks it
+// overlaps. index.rawi is a RawFileHeader followed by one RawIndexRecord per
+// chunk, in the order they were written; a chunk's record is appended only
+// once its bytes are durable, and a torn last record is cut off on open.
+//
+// Thread-safe: reads run concurrently with each other and with writers;
+// writes are serialized.
+inline constexpr uint16_t kRawStoreVersion = 1;
+
+struct RawFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t reserved2;
+    uint32_t header_crc;  // Over the preceding 12 bytes
+};
+static_assert(sizeof(RawFileHeader) == 16, "RawFileHeader layout is part of the on-disk format");
+
+struct RawChunkHeader {
+    uint32_t magic;
+    uint32_t block_bytes;  // Uncompressed bytes per block
+    uint32_t block_count;
+    uint32_t reserved;
+    uint64_t length;       // Uncompressed chunk bytes
+    uint8_t sha256[32];
+    uint32_t reserved2;
+    uint32_t crc;          // Over the preceding 60 bytes and the block table
+};
+static_assert(sizeof(RawChunkHeader) == 64, "RawChunkHeader layout is part of the on-disk format");
+
+struct RawBlockEntry {
+    uint32_t stored_bytes;
+    uint8_t codec;         // BlockCodec
+    uint8_t reserved[3];
+    uint32_t crc;          // Of the stored bytes
+};
+static_assert(sizeof(RawBlockEntry) == 12, "RawBlockEntry layout is part of the on-disk format");
+
+struct RawIndexRecord {
+    uint8_t sha256[32];
+    uint64_t offset;        // Of the chunk record in its pack
+    uint64_t stored_bytes;  // Whole chunk record
+    uint64_t length;        // Uncompressed chunk bytes
+    int64_t created_ms;     // Since the epoch
+    uint32_t pack;          // Sequence number, unique per tenant
+    uint32_t day;           // YYYYMMDD, the pack's directory
+    uint32_t block_count;
+    uint32_t crc;           // Over the preceding 76 bytes
+};
+static_assert(sizeof(RawIndexRecord) == 80, "RawIndexRecord layout is part of the on-disk format");
+
+// raw_refs entry: bytes [offset, offset + length) of a chunk
+struct RawRef {
+    Sha256Digest chunk;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+// "raw_" followed by the hex digest, the RawChunk id of the design doc
+std::string rawChunkId(const Sha256Digest& digest);
+std::optional<Sha256Digest> parseRawChunkId(std::string_view id);
+
+struct RawStoreOptions {
+    // Root holding tenants/<tenant>/raw
+    std::string directory;
+    // Uncompressed bytes per block: the most a range read decodes beyond
+    // what it asked for, at either end
+    size_t block_bytes = size_t{64} << 10;
+    // A pack is sealed and the next one started past this size
+    size_t pack_bytes = size_t{64} << 20;
+    BlockCodec codec = BlockCodec::LZ;
+    // Acknowledge a put only once the chunk and its index record are on
+    // disk (fdatasync)
+    bool sync = true;
+
+    // Reads raw.raw_dir / raw_block_kb / raw_pack_mb / raw_compression /
+    // raw_sync
+    static RawStoreOptions fromConfig(const Config& config);
+};
+
+struct RawChunkInfo {
+    Sha256Digest sha256;
+    uint64_t length = 0;        // Uncompressed
+    uint64_t stored_bytes = 0;  // Headers included
+    Timestamp created_at;
+    std::string pack;           // Path of the pack holding it
+};
+
+struct RawPutResult {
+    Sha256Digest sha256;
+    bool deduplicated = false;  // Already stored; nothing was written
+};
+
+// One ingest() call, or the running totals of a store
+struct RawIngestStats {
+    uint64_t chunks = 0;
+    uint64_t deduplicated = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_stored = 0;  // Of the new chunks, headers included
+    double hash_seconds = 0.0;
+    double compress_seconds = 0.0;
+    double write_seconds = 0.0;  // Syncs included
+    double seconds = 0.0;        // Wall clock
+
+    // Ingested (not stored) megabytes per second of wall clock
+    double mbPerSecond() const { return seconds > 0.0 ? static_cast<double>(bytes_in) / (1 << 20) / seconds : 0.0; }
+    double compressionRatio() const {
+        return bytes_in ? static_cast<double>(bytes_stored) / static_cast<double>(bytes_in) : 1.0;
+    }
+};
+
+class RawStore {
+public:
+    // Creates the directory if needed and loads the index of every tenant
+    // in it. Throws StorageException. Bulk ingests hash and compress on
+    // pool when given.
+    explicit RawStore(RawStoreOptions options, std::shared_ptr<ThreadPool> pool = nullptr);
+    ~RawStore();
+
+    RawStore(const RawStore&) = delete;
+    RawStore& operator=(const RawStore&) = delete;
+
+    // Stores content for tenant unless the tenant already has it. An empty
+    // tenant is "default"; others are limited to [A-Za-z0-9_.-] and may not
+    // start with a dot.
+    RawPutResult put(std::string_view tenant, std::span<const uint8_t> content,
+                     Timestamp created_at = std::chrono::system_clock::now());
+    RawPutResult put(std::string_view tenant, std::string_view content,
+                     Timestamp created_at = std::chrono::system_clock::now()) {
+        return put(tenant, std::span(reinterpret_cast<const uint8_t*>(content.data()), content.size()), created_at);
+    }
+
+    // Bulk path: hashes and compresses every chunk (in parallel on the
+    // pool), then writes the new ones with one write and one sync per pack.
+    // Results are in input order; a chunk repeated in the batch is stored
+    // once. stats, if given, receives the figures of this call.
+    std::vector<RawPutResult> ingest(std::string_view tenant, const std::vector<std::span<const uint8_t>>& contents,
+                                     Timestamp created_at = std::chrono::system_clock::now(),
+                                     RawIngestStats* stats = nullptr);
+
+    bool contains(std::string_view tenant, const Sha256Digest& digest) const;
+    std::optional<RawChunkInfo> info(std::string_view tenant, const Sha256Digest& digest) const;
+
+    // Whole chunk. Throws StorageException if it is unknown or damaged.
+    std::vector<uint8_t> read(std::string_view tenant, const Sha256Digest& digest) const;
+    // The range of ref, clipped to the chunk; reads and decodes only the
+    // blocks it overlaps
+    std::vector<uint8_t> read(std::string_view tenant, const RawRef& ref) const;
+
+    // Chunks of tenant created at or after since, oldest first
+    std::vector<RawChunkInfo> list(std::string_view tenant, Timestamp since = {}) const;
+
+    size_t chunkCount() const;
+    std::vector<std::string> tenants() const;
+    // Name a tenant is stored under: "default" for an empty one. Throws
+    // std::invalid_argument for names that are not valid directory names.
+    static std::string tenantName(std::string_view tenant);
+    // Totals over every put() and ingest() of this instance
+    RawIngestStats stats() const;
+    const RawStoreOptions& options() const { return options_; }
+
+private:
+    struct Tenant;
+    struct Encoded;
+
+    const Tenant* findTenant(const std::string& name) const;
+    Tenant& tenantForWrite(const std::string& name);
+    void loadTenant(const std::string& name);
+    Encoded encode(std::span<const uint8_t> content, const Sha256Digest& digest) const;
+    // Appends encoded chunks of one tenant and day; under write_mutex_
+    void writeChunks(Tenant& tenant, const std::vector<const Encoded*>& chunks, Timestamp created_at);
+    std::vector<uint8_t> readRange(std::string_view tenant, const Sha256Digest& digest, uint64_t offset,
+                                   uint64_t length) const;
+
+    RawStoreOptions options_;
+    std::shared_ptr<ThreadPool> pool_;
+    std::mutex write_mutex_;                 // One writer at a time
+    mutable std::shared_mutex mutex_;        // Guards tenants_ and their chunk maps
+    std::unordered_map<std::string, std::unique_ptr<Tenant>> tenants_;
+    mutable std::mutex stats_mutex_;
+    RawIngestStats stats_;
+};
+
+} // namespace memory::core
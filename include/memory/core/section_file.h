@@ -0,0 +1,118 @@
+#pragma once
+
+#include "memory/core/file_format.h"
+#include "memory/core/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory::core {
+
+// === Section files ===
+//
+// Segment file of tagged arrays ("sections") laid out to be used in place
+// through a memory mapping. The FileHeader is followed by a directory of up
+// to kMaxSections (tag, offset, bytes) entries with its own CRC-32C, and
+// every section starts on a kSectionAlign boundary, so arrays of any
+// element type are aligned and advice applies to whole pages.
+//
+// Opening checks the header and the directory only, so it costs the same
+// for any file size and section pages fault in when first read. The
+// header's payload CRC still covers everything; verify() checks it.
+inline constexpr size_t kMaxSections = 32;
+inline constexpr size_t kSectionAlign = 4096;
+
+struct SectionEntry {
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t offset;  // From the start of the file
+    uint64_t bytes;
+};
+static_assert(sizeof(SectionEntry) == 24, "SectionEntry layout is part of the on-disk format");
+
+// Streams sections into a file that replaces path atomically on commit()
+class SectionFileWriter {
+public:
+    // Throws StorageException if the file cannot be created
+    SectionFileWriter(const std::string& path, uint32_t magic, uint16_t version, uint16_t flags = 0);
+
+    // Starts a section; what is appended until the next begin() or commit()
+    // belongs to it. Throws StorageException past kMaxSections.
+    void begin(uint32_t tag);
+    void append(const void* data, size_t bytes);
+    template <typename T>
+    void append(std::span<const T> values) {
+        append(values.data(), values.size_bytes());
+    }
+    void appendZeros(size_t bytes);
+    // Writes the directory and header and publishes the file
+    void commit();
+
+private:
+    void pad(size_t alignment);
+    void flushBuffer();
+
+    AtomicFileWriter file_;
+    uint32_t magic_;
+    uint16_t version_;
+    uint16_t flags_;
+    std::vector<SectionEntry> sections_;
+    std::vector<uint8_t> buffer_;  // Written out in large chunks
+    uint64_t offset_;              // Logical end of the file, buffer included
+};
+
+// Mapped section file. Move-only; section spans stay valid while it lives.
+class SectionFile {
+public:
+    SectionFile() = default;
+
+    // Maps path and checks its header and directory. Throws StorageException
+    // naming `what` on a missing, foreign or damaged file.
+    static SectionFile open(const std::string& path, uint32_t magic, uint16_t version, const std::string& what,
+                            MapMode mode = MapMode::READ_ONLY);
+
+    bool isOpen() const { return file_.isOpen(); }
+    uint16_t flags() const { return flags_; }
+    bool has(uint32_t tag) const { return find(tag) != nullptr; }
+    // Throws StorageException if the section is missing
+    std::span<const uint8_t> section(uint32_t tag) const;
+    // The section as an array of T; throws StorageException if it is
+    // missing or not a whole number of elements
+    template <typename T>
+    std::span<const T> array(uint32_t tag) const {
+        auto bytes = section(tag);
+        checkElements(tag, bytes.size(), sizeof(T));
+        return {reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T)};
+    }
+    // Same, writable; the file must be mapped PRIVATE
+    template <typename T>
+    std::span<T> mutableArray(uint32_t tag) const {
+        auto bytes = section(tag);
+        checkElements(tag, bytes.size(), sizeof(T));
+        checkWritable();
+        return {reinterpret_cast<T*>(file_.mutableData() + (bytes.data() - file_.data())), bytes.size() / sizeof(T)};
+    }
+    // Access hint for bytes [offset, offset + length) of a section
+    void advise(uint32_t tag, Access access, size_t offset = 0, size_t length = SIZE_MAX) const;
+    // Checks the payload CRC, reading the whole file. Throws
+    // StorageException on a mismatch.
+    void verify() const;
+
+    const std::string& path() const { return file_.path(); }
+    size_t fileBytes() const { return file_.size(); }
+
+private:
+    const SectionEntry* find(uint32_t tag) const;
+    void checkElements(uint32_t tag, size_t bytes, size_t element) const;
+    void checkWritable() const;
+
+    MappedFile file_;
+    std::string what_;
+    uint16_t flags_ = 0;
+    uint32_t payload_crc_ = 0;
+    std::vector<SectionEntry> sections_;
+};
+
+} // namespace memory::core
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace memory::core {
+
+// SHA-256 (FIPS 180-4), the content address of RawChunks. The compression
+// function runs on the SHA-NI instructions when the CPU has them (about
+// 2 GB/s per core) and in portable code otherwise.
+using Sha256Digest = std::array<uint8_t, 32>;
+
+enum class Sha256Impl {
+    SCALAR,
+    SHA_NI
+};
+
+bool sha256Supported(Sha256Impl impl);
+// SHA_NI when supported, unless MEMORY_SIMD=scalar
+Sha256Impl bestSha256Impl();
+
+// Incremental hashing over any number of update() calls
+class Sha256 {
+public:
+    explicit Sha256(Sha256Impl impl = bestSha256Impl());
+
+    Sha256& update(const void* data, size_t size);
+    Sha256& update(std::span<const uint8_t> bytes) { return update(bytes.data(), bytes.size()); }
+    // Pads and returns the digest; the hasher starts over afterwards
+    Sha256Digest finish();
+
+private:
+    void reset();
+
+    void (*blocks_)(uint32_t* state, const uint8_t* data, size_t count);
+    uint32_t state_[8];
+    uint8_t buffer_[64];
+    size_t buffered_;
+    uint64_t length_;
+};
+
+Sha256Digest sha256(const void* data, size_t size);
+
+inline Sha256Digest sha256(std::span<const uint8_t> bytes) {
+    return sha256(bytes.data(), bytes.size());
+}
+
+inline Sha256Digest sha256(std::string_view text) {
+    return sha256(text.data(), text.size());
+}
+
+// Lower-case hex, 64 characters
+std::string toHex(const Sha256Digest& digest);
+// Parses 64 hex characters of either case
+std::optional<Sha256Digest> sha256FromHex(std::string_view hex);
+
+} // namespace memory::core
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memory::core {
+
+// Maps strings to dense uint32_t IDs in first-seen order. String bytes are
+// copied once into an append-only arena, so interning costs a hash lookup
+// instead of a std::string. Not thread-safe; the owner serializes intern()
+// against readers.
+class StringInterner {
+public:
+    static constexpr uint32_t kUnknownId = std::numeric_limits<uint32_t>::max();
+
+    // Returns the ID of str, assigning the next free ID on first sight
+    uint32_t intern(std::string_view str);
+    // Returns kUnknownId if str was never interned
+    uint32_t find(std::string_view str) const;
+    std::string_view str(uint32_t id) const { return strings_[id]; }
+
+    size_t size() const { return strings_.size(); }
+    // Forgets every string; IDs restart at 0 and earlier views are invalidated
+    void clear();
+    size_t memoryBytes() const;
+
+private:
+    static constexpr size_t kChunkBytes = 64 * 1024;
+
+    // Chunks never move once allocated, so the views below stay valid
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    size_t chunk_used_ = kChunkBytes;
+    std::vector<std::string_view> strings_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+};
+
+} // namespace memory::core
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace memory::core {
+
+// Fixed-size FIFO thread pool shared by the engines
+class ThreadPool {
+public:
+    // threads == 0 is valid: parallelFor() then runs on the caller alone
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    template <typename F>
+    auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> future = task->get_future();
+        enqueue([task] { (*task)(); });
+        return future;
+    }
+
+    // Runs fn(task, worker) for every task in [0, tasks) and blocks until all
+    // are done. The caller works too, as worker 0; pool threads that pick up
+    // a share are workers 1..size(). Safe to call from a pool thread: the
+    // caller alone can finish every task. Rethrows the first exception.
+    void parallelFor(size_t tasks, const std::function<void(size_t task, size_t worker)>& fn);
+
+private:
+    void enqueue(std::function<void()> job);
+    void workerLoop();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace memory::core
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "memory/core/types.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace memory::core {
+
+// Bounded min-heap keeping the k best ScoredIds seen so far.
+// Ties are broken by ascending id so results are deterministic.
+class TopKCollector {
+public:
+    explicit TopKCollector(size_t k) : k_(k) {
+        heap_.reserve(k);
+    }
+
+    // True if (a) ranks strictly better than (b)
+    static bool better(const ScoredId& a, const ScoredId& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.id < b.id;
+    }
+
+    bool full() const { return heap_.size() >= k_; }
+    size_t size() const { return heap_.size(); }
+
+    // Score a candidate must beat to enter a full heap
+    float threshold() const {
+        return full() && k_ > 0 ? heap_.front().score : std::numeric_limits<float>::lowest();
+    }
+
+    bool push(uint64_t id, float score) {
+        if (k_ == 0) return false;
+        ScoredId candidate{id, score};
+        if (!full()) {
+            heap_.push_back(candidate);
+            std::push_heap(heap_.begin(), heap_.end(), better);
+            return true;
+        }
+        if (!better(candidate, heap_.front())) return false;
+        std::pop_heap(heap_.begin(), heap_.end(), better);
+        heap_.back() = candidate;
+        std::push_heap(heap_.begin(), heap_.end(), better);
+        return true;
+    }
+
+    // Drains the heap into a vector sorted best-first
+    std::vector<ScoredId> take() {
+        std::sort_heap(heap_.begin(), heap_.end(), better);
+        std::vector<ScoredId> result = std::move(heap_);
+        heap_.clear();
+        return result;
+    }
+
+private:
+    size_t k_;
+    std::vector<ScoredId> heap_;
+};
+
+} // namespace memory::core
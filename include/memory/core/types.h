@@ -14,7 +14,7 @@ using TenantId = std::string;
 using Timestamp = std::chrono::system_clock::time_point;
 
 // Node type enumeration
-enum class NodeType {
+enum class NodeType : uint8_t {
     EPISODE,    // Conversation/experience/one-time event
     FACT,       // Declarative fact
     PREFERENCE, // User preference/habit/constraint
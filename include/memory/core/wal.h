@@ -0,0 +1,237 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace memory::core {
+
+class Config;
+
+// === Write-ahead log ===
+//
+// One log shared by the search, graph and vector engines (design doc
+// §3.1). Every change is appended as a record before it is acknowledged;
+// on open an engine replays the records of its own stream on top of its
+// last snapshot.
+//
+// The log is a directory of segment files named after the first LSN they
+// hold (`00000000000000000001.wal`). A segment starts with a WalSegmentHeader
+// and holds back-to-back records, each a WalRecordHeader followed by its
+// payload. LSNs start at 1 and are consecutive across segments.
+inline constexpr uint16_t kWalVersion = 1;
+
+struct WalSegmentHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t first_lsn;
+    uint32_t reserved2;
+    uint32_t header_crc;  // Over the preceding 20 bytes
+};
+static_assert(sizeof(WalSegmentHeader) == 24, "WalSegmentHeader layout is part of the on-disk format");
+
+struct WalRecordHeader {
+    uint32_t crc;  // CRC-32C of the rest of the header and the payload
+    uint32_t length;  // Payload bytes
+    uint64_t lsn;
+    uint8_t stream;
+    uint8_t op;
+    uint16_t reserved;
+    uint32_t reserved2;
+};
+static_assert(sizeof(WalRecordHeader) == 24, "WalRecordHeader layout is part of the on-disk format");
+
+// Engine a record belongs to
+enum class WalStream : uint8_t {
+    SEARCH = 1,
+    GRAPH = 2,
+    VECTOR = 3
+};
+
+struct WalRecord {
+    uint64_t lsn;
+    WalStream stream;
+    uint8_t op;  // Meaning is up to the stream
+    std::span<const uint8_t> payload;
+};
+
+struct WalOptions {
+    // Acknowledge a record only once it is on disk (fdatasync); otherwise
+    // once the OS has it, which survives a process crash but not power loss
+    bool sync = true;
+    // Writers waiting for a sync share it: one of them writes and syncs
+    // everything appended so far while the others wait. Without it every
+    // record is written and synced on its own.
+    bool group_commit = true;
+    // A new segment is started once the current one reaches this size
+    size_t segment_bytes = size_t{64} << 20;
+
+    // Reads database.wal_sync / wal_group_commit / wal_segment_mb
+    static WalOptions fromConfig(const Config& config);
+};
+
+struct WalStats {
+    uint64_t records = 0;
+    uint64_t bytes = 0;  // Record headers and payloads
+    uint64_t writes = 0;  // Batches handed to the OS
+    uint64_t syncs = 0;
+};
+
+// Segmented, checksummed write-ahead log with group commit. Thread-safe.
+//
+// append() frames a record into an in-memory batch and returns its LSN;
+// commit(lsn) returns once that record is durable. Callers that need
+// records applied in LSN order append under their own write lock and
+// commit after releasing it, so concurrent writers still share syncs.
+//
+// Opening scans every segment. A torn or corrupt tail of the last segment,
+// left by a crash in the middle of a write, is cut off; damage anywhere
+// else throws StorageException. Writing resumes in a new segment.
+class WriteAheadLog {
+public:
+    // Opens or creates the log in directory. Throws StorageException.
+    explicit WriteAheadLog(std::string directory, WalOptions options = {});
+    // Writes out records still in memory
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    uint64_t append(WalStream stream, uint8_t op, std::span<const uint8_t> payload);
+    // Waits until lsn is durable (or written, without options.sync). Throws
+    // StorageException if writing failed; the log refuses records after that.
+    void commit(uint64_t lsn);
+    // append() then commit()
+    uint64_t write(WalStream stream, uint8_t op, std::span<const uint8_t> payload) {
+        uint64_t lsn = append(stream, op, payload);
+        commit(lsn);
+        return lsn;
+    }
+    // Commits everything appended so far
+    void flush();
+
+    // Calls apply for the records after after_lsn that were written when
+    // replay started, in LSN order, optionally of one stream only
+    void replay(uint64_t after_lsn, const std::function<void(const WalRecord&)>& apply) const;
+    void replay(WalStream stream, uint64_t after_lsn, const std::function<void(const WalRecord&)>& apply) const;
+
+    // Deletes segments that hold only records up to lsn, e.g. once a
+    // snapshot covers them. The segment being written is kept.
+    void releaseUpTo(uint64_t lsn);
+
+    // Last LSN handed out (0 while the log is empty)
+    uint64_t lastLsn() const;
+    uint64_t durableLsn() const;
+    size_t segmentCount() const;
+    WalStats stats() const;
+    const std::string& directory() const { return directory_; }
+
+private:
+    struct Segment {
+        uint64_t first_lsn;
+        uint64_t bytes;  // Valid bytes: header and whole records
+        std::string path;
+    };
+
+    void recover();
+    // Leader only: writes batch, starting with record first_lsn, to the
+    // current segment and optionally syncs it
+    void writeBatch(const std::vector<uint8_t>& batch, uint64_t first_lsn, bool sync);
+    void openSegment(uint64_t first_lsn);
+    // Syncs and closes the current segment
+    void closeSegment();
+    // Records the current segment's progress in segments_
+    void publishSegmentLocked();
+    void checkUsableLocked() const;
+
+    std::string directory_;
+    WalOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable written_cv_;
+    std::vector<Segment> segments_;
+    std::vector<uint8_t> pending_;  // Framed records after written_lsn_
+    std::vector<uint8_t> spare_;  // Recycled batch buffer
+    uint64_t next_lsn_ = 1;
+    uint64_t written_lsn_ = 0;  // Last LSN handed to the OS
+    uint64_t durable_lsn_ = 0;  // Last LSN synced
+    bool leader_ = false;  // A writer is writing a batch outside the lock
+    bool failed_ = false;
+    std::string failure_;
+    WalStats stats_;
+
+    // Touched by the leader only
+    intptr_t handle_ = -1;  // File descriptor, or HANDLE on Windows
+    std::string segment_path_;
+    uint64_t segment_first_lsn_ = 0;
+    uint64_t segment_bytes_ = 0;
+};
+
+// Little-endian payload builder for WAL records
+class WalEncoder {
+public:
+    template <typename T>
+    WalEncoder& put(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        size_t offset = bytes_.size();
+        bytes_.resize(offset + sizeof(T));
+        std::memcpy(bytes_.data() + offset, &value, sizeof(T));
+        return *this;
+    }
+    // Length-prefixed
+    WalEncoder& putString(std::string_view value);
+    template <typename T>
+    WalEncoder& putArray(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        put<uint32_t>(static_cast<uint32_t>(values.size()));
+        const auto* data = reinterpret_cast<const uint8_t*>(values.data());
+        bytes_.insert(bytes_.end(), data, data + values.size_bytes());
+        return *this;
+    }
+
+    std::span<const uint8_t> bytes() const { return bytes_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+// Reads what WalEncoder wrote; throws StorageException past the end
+class WalDecoder {
+public:
+    explicit WalDecoder(const WalRecord& record) : record_(record) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+    std::string_view getString();
+    template <typename T>
+    std::vector<T> getArray() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint32_t count = get<uint32_t>();
+        const uint8_t* data = take(size_t{count} * sizeof(T));
+        std::vector<T> values(count);
+        if (count > 0) std::memcpy(values.data(), data, size_t{count} * sizeof(T));
+        return values;
+    }
+
+private:
+    const uint8_t* take(size_t bytes);
+
+    const WalRecord& record_;
+    size_t offset_ = 0;
+};
+
+} // namespace memory::core
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "memory/core/cache.h"
+#include "memory/graph/csr_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace memory::graph {
+
+struct AdjacencyKey {
+    uint32_t node;
+    Direction direction;
+
+    bool operator==(const AdjacencyKey&) const = default;
+};
+
+struct AdjacencyKeyHash {
+    size_t operator()(const AdjacencyKey& key) const {
+        return std::hash<uint64_t>()(static_cast<uint64_t>(key.node) << 1 | (key.direction == Direction::IN));
+    }
+};
+
+// A node's hot and cold edges merged, for the base they were read from.
+// Deltas are applied on top at read time, so a block stays valid until the
+// next merge replaces the base.
+struct AdjacencyBlock {
+    std::weak_ptr<const CsrGraph> base;
+    std::vector<PackedEdge> edges;
+
+    // Identity, not contents: a weak_ptr never matches a later base
+    // allocated at the same address
+    bool builtFrom(const std::shared_ptr<const CsrGraph>& graph) const {
+        return !base.owner_before(graph) && !graph.owner_before(base);
+    }
+    size_t memoryBytes() const { return sizeof(AdjacencyBlock) + edges.capacity() * sizeof(PackedEdge); }
+};
+
+// Hot-node cache of full (L0) adjacency blocks (design doc §22.3)
+using AdjacencyCache = core::ShardedCache<AdjacencyKey, AdjacencyBlock, AdjacencyKeyHash>;
+
+} // namespace memory::graph
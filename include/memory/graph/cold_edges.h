@@ -0,0 +1,66 @@
+#pragma once
+
+#include "memory/core/file_format.h"
+#include "memory/core/mapped_file.h"
+#include "memory/graph/csr_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory::graph {
+
+inline constexpr uint32_t kColdEdgeMagic = core::makeMagic('G', 'C', 'O', 'L');
+inline constexpr uint16_t kColdEdgeVersion = 1;
+
+// Edge spilled out of the pruned graph; edge.dst is the target
+struct ColdEdge {
+    uint32_t src;
+    PackedEdge edge;
+};
+
+// === Cold edge segment ===
+//
+// Edges cut by the per-type degree caps (design doc §22.1). Traversals run
+// on the pruned graph and never touch them; they are read back only for
+// full (L0) adjacency and when a later merge re-ranks them against the hot
+// edges.
+//
+// Stored as one image, both directions, in the same sorted-nodes/offsets
+// layout as a DeltaSegment. With a path the image is written to a segment
+// file and memory-mapped, so a node's cold edges are paged in only when
+// read; the file is removed along with the segment.
+class ColdEdgeSegment {
+public:
+    // Throws StorageException if the segment file cannot be written or mapped
+    explicit ColdEdgeSegment(std::vector<ColdEdge> edges, std::string path = {});
+    ~ColdEdgeSegment();
+
+    ColdEdgeSegment(const ColdEdgeSegment&) = delete;
+    ColdEdgeSegment& operator=(const ColdEdgeSegment&) = delete;
+
+    // Cold edges of node in adjacencyLess order, empty if it has none
+    std::span<const PackedEdge> edges(uint32_t node, Direction direction) const;
+    uint64_t edgeCount() const { return edge_count_; }
+    const std::string& path() const { return file_.path(); }
+    // Heap bytes; a mapped image is left to the page cache
+    size_t memoryBytes() const { return image_.capacity(); }
+
+private:
+    struct Adjacency {
+        std::span<const uint32_t> nodes;
+        std::span<const uint32_t> offsets;
+        std::span<const PackedEdge> edges;
+    };
+
+    void attach(std::span<const uint8_t> image);
+
+    std::vector<uint8_t> image_;
+    core::MappedFile file_;
+    uint64_t edge_count_ = 0;
+    Adjacency out_;
+    Adjacency in_;
+};
+
+} // namespace memory::graph
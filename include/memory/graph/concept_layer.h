@@ -0,0 +1,129 @@
+#pragma once
+
+#include "memory/graph/csr_graph.h"
+#include "memory/graph/traversal.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace memory::graph {
+
+class DeltaSegment;
+class GraphSnapshot;
+
+// Concept/Entity/Task nodes are the super-nodes of the L2 layer
+bool isSuperNodeType(core::NodeType type);
+
+// Edges making a node a member of the super-node they point to
+inline constexpr EdgeTypeMask kMembershipTypes =
+    edgeTypeBit(core::EdgeType::ABOUT) | edgeTypeBit(core::EdgeType::MENTIONS);
+// Relations aggregated between super-nodes; CAUSED_BY counts as a
+// reversed CAUSES
+inline constexpr EdgeTypeMask kConceptRelationTypes =
+    edgeTypeBit(core::EdgeType::SUPPORTS) | edgeTypeBit(core::EdgeType::CONTRADICTS) |
+    edgeTypeBit(core::EdgeType::CAUSES) | edgeTypeBit(core::EdgeType::CAUSED_BY);
+
+// Aggregated relation between two super-nodes
+struct ConceptEdge {
+    uint32_t node;   // The other super-node, as a dense index
+    uint8_t type;    // core::EdgeType: SUPPORTS, CONTRADICTS or CAUSES
+    float weight;    // Sum of the underlying edge weights
+    uint32_t count;  // Underlying edges
+};
+
+// Adjacency order within a super-node: by type, then neighbor
+inline bool conceptEdgeLess(const ConceptEdge& a, const ConceptEdge& b) {
+    return a.type != b.type ? a.type < b.type : a.node < b.node;
+}
+
+struct SuperNode {
+    uint32_t node;
+    core::NodeType type;
+    std::vector<uint32_t> members;  // Sorted; every member, pruned or not
+    std::vector<ConceptEdge> out;   // conceptEdgeLess order
+    std::vector<ConceptEdge> in;
+};
+
+// === L2 concept layer ===
+//
+// Summary graph over the super-nodes (design doc §22.2). A node's groups
+// are the super-nodes it points to through ABOUT/MENTIONS edges, or the
+// node itself if it is a super-node. Every relation edge u -> v then adds
+// its weight to the L2 edge g -> h for each group g of u and h of v, g != h.
+// Built from the full (L0) graph, so pruning never changes it.
+//
+// Immutable and shared between snapshots like the rest of a GraphSnapshot.
+// Super-nodes are held by shared_ptr, so publishing a change copies only
+// the super-nodes it touched.
+class ConceptGraph {
+public:
+    // nullptr if node is not a super-node
+    const SuperNode* find(uint32_t node) const;
+    // Sorted by node
+    std::span<const std::shared_ptr<const SuperNode>> superNodes() const { return supers_; }
+    size_t superNodeCount() const { return supers_.size(); }
+    uint64_t edgeCount() const { return edge_count_; }
+    uint64_t memberCount() const { return member_count_; }
+    size_t memoryBytes() const;
+
+private:
+    friend class ConceptLayerBuilder;
+
+    std::vector<std::shared_ptr<const SuperNode>> supers_;
+    uint64_t edge_count_ = 0;
+    uint64_t member_count_ = 0;
+};
+
+// Writer-side maintenance of the concept layer. Each frozen delta is
+// folded in by re-aggregating only the relation edges it changed and the
+// edges of nodes whose groups it changed, so the work follows the size of
+// the delta rather than the graph. Not thread-safe; the store calls it
+// under its write lock.
+class ConceptLayerBuilder {
+public:
+    ConceptLayerBuilder();
+
+    // Takes effect with the next apply()
+    void setNodeType(uint32_t node, core::NodeType type);
+    bool hasPendingTypes() const { return !pending_types_.empty(); }
+
+    // Folds delta, the last change between before and after, into the layer
+    // and returns the new version
+    std::shared_ptr<const ConceptGraph> apply(const GraphSnapshot& before, const GraphSnapshot& after,
+                                              const DeltaSegment& delta);
+    const std::shared_ptr<const ConceptGraph>& current() const { return current_; }
+
+private:
+    struct Draft;
+
+    bool isSuper(uint32_t node) const { return super_types_.count(node) > 0; }
+    std::vector<uint32_t> groups(uint32_t node) const;
+    std::vector<uint32_t> groupsIn(const GraphSnapshot& graph, uint32_t node) const;
+
+    std::unordered_map<uint32_t, core::NodeType> super_types_;
+    std::unordered_map<uint32_t, core::NodeType> pending_types_;
+    // Super-nodes each non-super node belongs to, sorted; absent if none
+    std::unordered_map<uint32_t, std::vector<uint32_t>> memberships_;
+    std::shared_ptr<const ConceptGraph> current_;
+};
+
+struct ConceptRouteStats {
+    size_t super_nodes = 0;  // Super-nodes reached
+    uint64_t l2_edges = 0;   // Concept edges scanned
+    uint64_t l1_edges = 0;   // Graph edges scanned
+};
+
+// L2 -> L1 expansion (design doc §22.2): locate the seeds' super-nodes,
+// travel between super-nodes over concept edges of the masked relation
+// types, then refine each super-node with its members from the pruned
+// (L1) graph. Hops count one per step: seed -> group -> related group ->
+// ..., and group -> member. Only seeds and super-nodes expand, so a query
+// touches the concept layer and the capped member lists instead of every
+// hub on the way. Appends like expandKHop: seeds first, then by hop.
+ConceptRouteStats expandViaConcepts(const GraphSnapshot& graph, std::span<const uint32_t> seeds, uint32_t k,
+                                    EdgeTypeMask relations, EpochVisitedSet& visited, std::vector<HopIndex>& out);
+
+} // namespace memory::graph
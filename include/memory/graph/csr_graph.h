@@ -0,0 +1,157 @@
+#pragma once
+
+#include "memory/core/section_file.h"
+#include "memory/core/types.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory::graph {
+
+inline constexpr size_t kEdgeTypeCount = static_cast<size_t>(core::EdgeType::SAME_AS) + 1;
+
+// Set of edge types, one bit per core::EdgeType
+using EdgeTypeMask = uint16_t;
+static_assert(kEdgeTypeCount <= 16, "EdgeTypeMask is too narrow");
+
+inline constexpr EdgeTypeMask kAllEdgeTypes = static_cast<EdgeTypeMask>((1u << kEdgeTypeCount) - 1);
+
+inline constexpr EdgeTypeMask edgeTypeBit(core::EdgeType type) {
+    return static_cast<EdgeTypeMask>(1u << static_cast<unsigned>(type));
+}
+
+// Mask of the listed types; all types when empty
+EdgeTypeMask edgeTypeMask(std::span<const core::EdgeType> types);
+
+// Edge write times are kept at day resolution, which is plenty for recency
+// decay measured in weeks and fits 16 bits until 2199
+inline constexpr std::chrono::sys_days kEdgeDayEpoch{std::chrono::year{2020} / 1 / 1};
+
+// Day of time since kEdgeDayEpoch, clamped to the 16-bit range
+inline uint16_t edgeDay(std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) {
+    auto days = std::chrono::floor<std::chrono::days>(time) - kEdgeDayEpoch;
+    return static_cast<uint16_t>(std::clamp<int64_t>(days.count(), 0, std::numeric_limits<uint16_t>::max()));
+}
+
+// PackedEdge::flags bits
+inline constexpr uint8_t kEdgeTombstone = 1;  // Delta entry deleting the edge
+
+// Adjacency record. Endpoints are dense node indexes, not core::NodeId.
+struct PackedEdge {
+    uint32_t dst;    // Neighbor: the target of an out-edge, the source of an in-edge
+    float weight;
+    uint8_t type;    // core::EdgeType
+    uint8_t flags;   // Zero in a CsrGraph
+    uint16_t day;    // Last written, in days since kEdgeDayEpoch (see edgeDay)
+
+    core::EdgeType edgeType() const { return static_cast<core::EdgeType>(type); }
+    bool tombstone() const { return flags & kEdgeTombstone; }
+};
+
+// Adjacency order within a node: by type, then neighbor
+inline bool adjacencyLess(const PackedEdge& a, const PackedEdge& b) {
+    return a.type != b.type ? a.type < b.type : a.dst < b.dst;
+}
+static_assert(sizeof(PackedEdge) == 12, "PackedEdge must stay 12 bytes");
+
+enum class Direction { OUT, IN };
+
+inline constexpr uint32_t kCsrGraphMagic = core::makeMagic('G', 'C', 'S', 'R');
+inline constexpr uint16_t kCsrGraphVersion = 1;
+
+// === Immutable CSR adjacency ===
+//
+// Per direction, the edges of node n are edges[offsets[n], offsets[n + 1]),
+// grouped by edge type and sorted by neighbor within a type, so the edges of
+// one type form a contiguous partition found by binary search. A per-node
+// type mask lets traversals skip nodes without any requested type without
+// touching their edges.
+//
+// The arrays live on the heap when built, or in a memory-mapped file when
+// opened from one written by save(); then a node's edges are paged in the
+// first time they are read. Move-only.
+class CsrGraph {
+public:
+    CsrGraph() = default;
+    CsrGraph(CsrGraph&&) = default;
+    CsrGraph& operator=(CsrGraph&&) = default;
+    CsrGraph(const CsrGraph&) = delete;
+    CsrGraph& operator=(const CsrGraph&) = delete;
+
+    // Maps a graph written by save(); with verify, checks the CRC of the
+    // whole file first. Throws StorageException if the file is missing,
+    // foreign or damaged.
+    static CsrGraph open(const std::string& path, bool verify = false);
+    // Writes the graph to path atomically. Throws StorageException.
+    void save(const std::string& path) const;
+    bool mapped() const { return file_.isOpen(); }
+
+    uint32_t nodeCount() const { return node_count_; }
+    // Each edge counted once (it is stored in both directions)
+    uint64_t edgeCount() const { return out_.edges.size(); }
+
+    std::span<const PackedEdge> edges(uint32_t node, Direction direction) const;
+    // The partition of one edge type
+    std::span<const PackedEdge> edges(uint32_t node, Direction direction, core::EdgeType type) const;
+    EdgeTypeMask typeMask(uint32_t node, Direction direction) const;
+
+    // Heap bytes; a mapped file is left to the page cache
+    size_t memoryBytes() const;
+
+private:
+    friend class CsrBuilder;
+
+    struct Adjacency {
+        std::span<const uint32_t> offsets;  // node_count + 1 entries
+        std::span<const PackedEdge> edges;
+        std::span<const EdgeTypeMask> masks;
+        // Backing arrays of a built graph
+        std::vector<uint32_t> offset_storage;
+        std::vector<PackedEdge> edge_storage;
+        std::vector<EdgeTypeMask> mask_storage;
+    };
+
+    const Adjacency& adjacency(Direction direction) const {
+        return direction == Direction::OUT ? out_ : in_;
+    }
+
+    uint32_t node_count_ = 0;
+    Adjacency out_;
+    Adjacency in_;
+    core::SectionFile file_;  // Backs the spans of an opened graph
+};
+
+// Collects edges and builds a CsrGraph with two counting-sort passes.
+// Duplicate (src, dst, type) edges keep the weight added last.
+class CsrBuilder {
+public:
+    explicit CsrBuilder(uint32_t node_count);
+
+    void reserve(size_t edges);
+    // Throws IndexException if an endpoint is out of range
+    void add(uint32_t src, uint32_t dst, core::EdgeType type, float weight, uint16_t day = 0);
+    size_t size() const { return edges_.size(); }
+
+    CsrGraph build();
+
+private:
+    struct RawEdge {
+        uint32_t src;
+        uint32_t dst;
+        float weight;
+        uint8_t type;
+        uint16_t day;
+    };
+
+    void buildDirection(CsrGraph::Adjacency& adjacency, bool reverse) const;
+
+    uint32_t node_count_;
+    std::vector<RawEdge> edges_;
+};
+
+} // namespace memory::graph
@@ -0,0 +1,260 @@
+#pragma once
+
+#include "memory/graph/graph_store.h"
+#include "memory/core/cache.h"
+#include "memory/core/compaction.h"
+#include "memory/graph/adjacency_cache.h"
+#include "memory/graph/concept_layer.h"
+#include "memory/graph/csr_graph.h"
+#include "memory/graph/degree_caps.h"
+#include "memory/graph/graph_snapshot.h"
+#include "memory/graph/ppr.h"
+#include "memory/graph/traversal.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace memory::core {
+class Config;
+class ThreadPool;
+class VersionSet;
+class WriteAheadLog;
+}
+
+namespace memory::graph {
+
+struct GraphStoreOptions {
+    // Buffered edge changes that are frozen into a delta segment
+    size_t max_buffered_edges = 100000;
+    // Delta segments that trigger merging them into a new base CSR
+    size_t max_delta_segments = 4;
+    // Merge on a background thread; otherwise the writer that crosses
+    // max_delta_segments merges inline
+    bool background_merge = true;
+    // Threads a single k-hop expansion may use, the caller included
+    size_t max_threads = 1;
+    KHopTuning khop;
+    PprOptions ppr;
+    // Degree caps applied whenever deltas are merged into the base
+    DegreeCaps caps;
+    // Directory for cold edge segment files (in memory when empty)
+    std::string cold_edge_dir;
+    // Byte budget of the hot-node adjacency cache
+    size_t cache_bytes = size_t{256} << 20;
+
+    // Reads graph.max_buffered_edges / max_delta_segments / background_merge,
+    // the degree cap and graph.ppr_* keys, graph.cold_edge_dir and
+    // performance.max_threads / cache_size_mb
+    static GraphStoreOptions fromConfig(const core::Config& config);
+};
+
+// L1 is the pruned graph every traversal runs on; L0 adds the cold edges
+// cut by the degree caps (design doc §22.2)
+enum class GraphLayer { L1, L0 };
+
+// Neighbor as seen through the store, with external node IDs
+struct Neighbor {
+    core::NodeId node;
+    core::EdgeType type;
+    float weight;
+};
+
+// Graph store with an LSM-style layout over immutable CSR.
+//
+// Writers append edge changes to a per-node delta buffer. Flush(), or
+// reaching max_buffered_edges, sorts the buffer into an immutable
+// DeltaSegment and publishes a new GraphSnapshot. Once max_delta_segments
+// deltas have piled up, a merge folds them into a new base CsrGraph and
+// swaps it in atomically; writes keep flowing meanwhile and land in deltas
+// on top of the new base.
+//
+// Readers load the current snapshot and traverse it without taking any
+// lock a writer or the merge holds, so they never block either and always
+// see one consistent version.
+//
+// Each merge also enforces the per-type degree caps: edges outside the top
+// max_degree by weight x recency at either endpoint are spilled to a cold
+// edge segment and re-ranked against the hot edges on every later merge,
+// so raising a cap or deleting hot edges brings them back. Between merges
+// the deltas may take a node past its cap.
+//
+// Node IDs are mapped to dense indexes in order of first appearance. Only
+// endpoints, type, weight and the day of the last write are kept; edge
+// metadata and tenant live with the node records.
+//
+// Full (L0) reads of nodes with cold edges go through a hot-node cache of
+// merged adjacency blocks with TinyLFU admission, so a one-off scan cannot
+// flush it; PinNode keeps key nodes resident. A merge invalidates it.
+//
+// Nodes typed Concept/Entity/Task through SetNodeType become super-nodes of
+// the L2 concept layer, which is folded forward with every frozen delta and
+// published in the same snapshot. ExpandSeeds routes a query through it
+// when the query asks for "use_l2".
+//
+// KHopSeeds is a level-synchronous BFS (expandKHop) following edges in both
+// directions: an ABOUT edge leads from the episode to its concept and from
+// the concept back to its episodes. Large levels are split across the
+// thread pool.
+//
+// With a write-ahead log attached, edge and node type changes are logged
+// before they are applied and return once their record is durable.
+//
+// As a compaction target, the store runs the same delta merge early once
+// delta entries (upserts and tombstones) make up more than the threshold
+// of the stored edges, so removed edges are physically dropped.
+class CsrGraphStore : public IGraphStore, public core::ICompactable {
+public:
+    // Expansions use pool if given, else a private pool of max_threads - 1
+    // workers when max_threads > 1
+    explicit CsrGraphStore(GraphStoreOptions options = {}, std::shared_ptr<core::ThreadPool> pool = nullptr);
+    ~CsrGraphStore() override;
+
+    CsrGraphStore(const CsrGraphStore&) = delete;
+    CsrGraphStore& operator=(const CsrGraphStore&) = delete;
+
+    // Stamps the edge with the current day
+    void AddEdge(const core::Edge& edge) override;
+    // Stamps the edge with day (see edgeDay), for replaying older edges
+    void AddEdge(const core::Edge& edge, uint16_t day);
+    void RemoveEdge(core::NodeId src, core::NodeId dst, core::EdgeType type) override;
+    std::vector<HopNode> KHopSeeds(std::span<const core::NodeId> seeds, int k,
+                                   std::span<const core::EdgeType> types = {}) const override;
+    // Publishes buffered changes
+    void Flush() override;
+    // Flush() plus merging every delta into the base CSR, synchronously
+    void Compact();
+    // Records a node's type; Concept/Entity/Task nodes are L2 super-nodes.
+    // Visible after the next flush, like edge changes.
+    void SetNodeType(core::NodeId node, core::NodeType type);
+    // Replaces the degree caps and re-prunes the whole graph synchronously
+    void SetDegreeCaps(const DegreeCaps& caps);
+
+    // Replays the GRAPH records of wal after after_lsn (the LSN the graph
+    // was last persisted at), then logs every later change to it. Call
+    // before any writes.
+    void attachWal(std::shared_ptr<core::WriteAheadLog> wal, uint64_t after_lsn = 0);
+    // Publishes the current and every later snapshot into versions
+    void attachVersions(std::shared_ptr<core::VersionSet> versions);
+
+    // Traversals of a pinned snapshot, e.g. one from a core::StoreView
+    std::vector<HopNode> KHopSeeds(const GraphSnapshot& snapshot, std::span<const core::NodeId> seeds, int k,
+                                   std::span<const core::EdgeType> types = {}) const;
+    std::vector<HopNode> ExpandSeeds(const GraphSnapshot& snapshot, std::span<const core::NodeId> seeds,
+                                     const core::RecallQuery& query, std::span<const core::EdgeType> types = {},
+                                     ConceptRouteStats* stats = nullptr) const;
+    std::vector<core::ScoredId> PersonalizedPageRank(const GraphSnapshot& snapshot,
+                                                     std::span<const core::NodeId> seeds, size_t k,
+                                                     std::span<const float> seed_weights = {}) const;
+
+    // Recall-time expansion honoring query.k_hop. With query.options
+    // "use_l2" set to true (or 1), routes through the concept layer
+    // (expandViaConcepts, relations among types), otherwise runs KHopSeeds.
+    std::vector<HopNode> ExpandSeeds(std::span<const core::NodeId> seeds, const core::RecallQuery& query,
+                                     std::span<const core::EdgeType> types = {},
+                                     ConceptRouteStats* stats = nullptr) const;
+
+    // Visible edges of one node, all types when types is empty. L0 pages in
+    // the node's cold edges too.
+    std::vector<Neighbor> Neighbors(core::NodeId node, Direction direction,
+                                    std::span<const core::EdgeType> types = {},
+                                    GraphLayer layer = GraphLayer::L1) const;
+
+    // Keeps the node's full adjacency resident in the cache, e.g. for key
+    // Concept/Preference nodes (design doc §22.3). False if the node is not
+    // visible yet.
+    bool PinNode(core::NodeId node);
+    void UnpinNode(core::NodeId node);
+    // Hit rate and occupancy of the adjacency cache (cache_hit_rate, §11.1)
+    core::CacheStats cacheStats() const { return adjacency_cache_.stats(); }
+
+    // k best nodes by personalized PageRank from the seeds (forwardPushPpr
+    // with options.ppr), seeds included. seed_weights, when given, sets the
+    // restart distribution, e.g. the seeds' first-stage scores.
+    std::vector<core::ScoredId> PersonalizedPageRank(std::span<const core::NodeId> seeds, size_t k,
+                                                     std::span<const float> seed_weights = {}) const;
+
+    // Current consistent view; stays valid while held
+    std::shared_ptr<const GraphSnapshot> snapshot() const { return snapshot_.load(); }
+
+    std::optional<uint32_t> nodeIndex(core::NodeId node) const;
+    // Visible (flushed) nodes and edges; edgeCount() is the pruned graph
+    size_t nodeCount() const;
+    uint64_t edgeCount() const;
+    uint64_t coldEdgeCount() const;
+    size_t bufferedCount() const;
+    size_t deltaCount() const;
+    uint64_t mergeCount() const { return merges_.load(); }
+    size_t memoryBytes() const;
+
+    std::string compactionName() const override { return "graph"; }
+    // Share of the stored edge entries that sit in deltas
+    double fragmentation() const override;
+    bool compactionDue(const core::CompactionOptions& options) const override;
+    // Charges the snapshot's size to limiter, then merges the deltas
+    core::CompactionResult compact(const core::CompactionOptions& options, core::RateLimiter& limiter) override;
+
+private:
+    // Methods below require write_mutex_
+    uint32_t internLocked(core::NodeId node);
+    std::optional<uint32_t> findLocked(core::NodeId node) const;
+    void bufferLocked(uint32_t src, uint32_t dst, core::EdgeType type, float weight, uint8_t flags, uint16_t day);
+    // Freezes the buffer; returns true if a merge is due
+    bool freezeLocked();
+    void publishLocked(std::shared_ptr<const GraphSnapshot> snapshot);
+
+    // Folds the deltas of the current snapshot into a new base, applying
+    // the degree caps; with force, rebuilds even without deltas
+    void mergeDeltas(bool force = false);
+    void requestMerge();
+    void mergeLoop();
+
+    // Borrows a visited set from visited_free_ and hands it back when it
+    // goes out of scope, exceptions included
+    class VisitedLease {
+    public:
+        explicit VisitedLease(const CsrGraphStore& store);
+        ~VisitedLease();
+
+        VisitedLease(const VisitedLease&) = delete;
+        VisitedLease& operator=(const VisitedLease&) = delete;
+
+        EpochVisitedSet& operator*() const { return *visited_; }
+
+    private:
+        const CsrGraphStore& store_;
+        std::unique_ptr<EpochVisitedSet> visited_;
+    };
+
+    GraphStoreOptions options_;
+    std::shared_ptr<core::ThreadPool> pool_;
+    mutable std::mutex visited_mutex_;
+    mutable std::vector<std::unique_ptr<EpochVisitedSet>> visited_free_;  // One per concurrent query
+    mutable AdjacencyCache adjacency_cache_;
+    mutable std::mutex write_mutex_;
+    std::shared_ptr<core::WriteAheadLog> wal_;
+    std::shared_ptr<core::VersionSet> versions_;
+    DeltaSegment::Buffer out_buffer_;
+    DeltaSegment::Buffer in_buffer_;
+    NodeTable new_nodes_;  // Nodes first seen since the last freeze
+    ConceptLayerBuilder concepts_;
+    size_t buffered_ = 0;
+    std::atomic<std::shared_ptr<const GraphSnapshot>> snapshot_;
+
+    std::mutex merge_mutex_;  // Serializes merges and guards options_.caps
+    uint64_t cold_segments_ = 0;  // Cold segment files written, for naming
+    std::mutex merge_signal_mutex_;
+    std::condition_variable merge_cv_;
+    bool merge_requested_ = false;
+    bool stopping_ = false;
+    std::atomic<uint64_t> merges_{0};
+    std::thread merger_;
+};
+
+} // namespace memory::graph
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "memory/graph/cold_edges.h"
+#include "memory/graph/csr_graph.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace memory::core {
+class Config;
+}
+
+namespace memory::graph {
+
+class GraphSnapshot;
+
+// Per-type degree caps of the pruned (L1) graph (design doc §22.1). Each
+// (node, edge type, direction) keeps at most max_degree edges, the best by
+// weight x recency, where recency = exp(-age / recency_tau_days).
+struct DegreeCaps {
+    // Indexed by core::EdgeType; 0 means unlimited
+    std::array<uint32_t, kEdgeTypeCount> max_degree = defaultMaxDegree();
+    double recency_tau_days = 30.0;
+
+    static constexpr std::array<uint32_t, kEdgeTypeCount> defaultMaxDegree() {
+        std::array<uint32_t, kEdgeTypeCount> caps{};
+        caps.fill(256);
+        caps[static_cast<size_t>(core::EdgeType::SIMILAR_TO)] = 64;
+        return caps;
+    }
+    // No caps: the pruned graph is the full graph
+    static DegreeCaps unlimited();
+    // Reads graph.max_degree_per_type / similar_to_max_degree /
+    // edge_recency_tau_days
+    static DegreeCaps fromConfig(const core::Config& config);
+
+    bool enabled() const;
+    // log(weight x recency) up to a term shared by every edge, so ranking
+    // does not depend on the current day; -inf for non-positive weights
+    double retentionKey(const PackedEdge& edge) const;
+};
+
+struct PruneStats {
+    uint64_t kept = 0;
+    uint64_t spilled = 0;
+    // Over-cap (node, type, direction) lists that were cut
+    uint64_t capped_lists = 0;
+};
+
+// Splits the full graph (hot, cold and deltas) into the edges kept under
+// the caps, added to kept, and the rest, appended to spilled. An edge stays
+// only if it ranks within the cap at both endpoints, so the pruned graph
+// looks the same from either direction. Ties rank the lower neighbor first.
+PruneStats pruneToCaps(const GraphSnapshot& graph, const DegreeCaps& caps, CsrBuilder& kept,
+                       std::vector<ColdEdge>& spilled);
+
+} // namespace memory::graph
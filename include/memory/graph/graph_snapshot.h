@@ -0,0 +1,136 @@
+#pragma once
+
+#include "memory/graph/adjacency_cache.h"
+#include "memory/graph/cold_edges.h"
+#include "memory/graph/csr_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace memory::graph {
+
+class ConceptGraph;
+
+// Merges two adjacency lists in adjacencyLess order into out. Entries of
+// newer replace older entries with the same (type, neighbor); tombstones in
+// newer delete them. Tombstones are kept in out only if keep_tombstones is
+// set, for stacking deltas.
+void mergeAdjacency(std::span<const PackedEdge> older, std::span<const PackedEdge> newer,
+                    std::vector<PackedEdge>& out, bool keep_tombstones = false);
+
+// Dense index <-> core::NodeId mapping for a contiguous index range
+struct NodeTable {
+    uint32_t first = 0;  // Index of ids[0]
+    std::vector<core::NodeId> ids;
+    std::unordered_map<core::NodeId, uint32_t> index;
+
+    uint32_t end() const { return first + static_cast<uint32_t>(ids.size()); }
+    std::optional<uint32_t> find(core::NodeId node) const;
+};
+
+// === Delta layer ===
+//
+// Edge changes between two CSR merges. A frozen delta is immutable: per
+// direction the touched nodes are sorted, and each node's entries are in
+// adjacencyLess order with at most one entry (upsert or tombstone) per
+// (type, neighbor). It also carries the nodes first seen in it.
+class DeltaSegment {
+public:
+    // Changes collected by the writer, per node in arrival order
+    using Buffer = std::unordered_map<uint32_t, std::vector<PackedEdge>>;
+
+    DeltaSegment(Buffer& out, Buffer& in, NodeTable nodes);
+
+    // Entries of node, empty if the delta does not touch it
+    std::span<const PackedEdge> edges(uint32_t node, Direction direction) const;
+    // Sorted nodes with entries
+    std::span<const uint32_t> touchedNodes(Direction direction) const {
+        return direction == Direction::OUT ? out_.nodes : in_.nodes;
+    }
+    const NodeTable& nodes() const { return nodes_; }
+    size_t entryCount() const { return out_.edges.size(); }
+    size_t memoryBytes() const;
+
+private:
+    struct Adjacency {
+        std::vector<uint32_t> nodes;    // Sorted touched nodes
+        std::vector<uint32_t> offsets;  // nodes.size() + 1 entries
+        std::vector<PackedEdge> edges;
+    };
+
+    static void freeze(Buffer& buffer, Adjacency& adjacency);
+
+    Adjacency out_;
+    Adjacency in_;
+    NodeTable nodes_;
+};
+
+// === Snapshot ===
+//
+// Immutable view of the graph: a base CsrGraph plus the frozen deltas
+// published since it was built, oldest first. Readers obtain one through
+// an atomic shared_ptr and traverse it without locks; the shared_ptr keeps
+// the base and deltas alive until the last reader lets go.
+//
+// The base holds the pruned (L1) edges; edges cut by the degree caps sit in
+// an optional cold segment, disjoint from the base. edges() is the L1 view
+// every traversal uses, fullEdges() the L0 view with the cold edges. The
+// L2 concept layer summarizing the same version rides along.
+class GraphSnapshot {
+public:
+    GraphSnapshot(std::shared_ptr<const CsrGraph> base, std::shared_ptr<const NodeTable> base_nodes,
+                  std::vector<std::shared_ptr<const DeltaSegment>> deltas, uint64_t edge_count,
+                  std::shared_ptr<const ColdEdgeSegment> cold = nullptr,
+                  std::shared_ptr<const ConceptGraph> concepts = nullptr);
+
+    uint32_t nodeCount() const { return node_count_; }
+    uint64_t edgeCount() const { return edge_count_; }
+    std::optional<uint32_t> nodeIndex(core::NodeId node) const;
+    core::NodeId nodeId(uint32_t index) const;
+
+    // Visible edges of node in adjacencyLess order. Points into the base CSR
+    // when no delta touches the node, otherwise into scratch.
+    std::span<const PackedEdge> edges(uint32_t node, Direction direction,
+                                      std::vector<PackedEdge>& scratch) const;
+    // Visible edges including cold ones, in adjacencyLess order
+    std::span<const PackedEdge> fullEdges(uint32_t node, Direction direction,
+                                          std::vector<PackedEdge>& scratch) const;
+    // Same, with the merged hot and cold edges read through cache. The
+    // result may point into block, which the caller holds while reading.
+    std::span<const PackedEdge> fullEdges(uint32_t node, Direction direction, std::vector<PackedEdge>& scratch,
+                                          AdjacencyCache& cache, std::shared_ptr<const AdjacencyBlock>& block) const;
+    // Superset of the types present; exact for nodes no delta touches
+    EdgeTypeMask typeMask(uint32_t node, Direction direction) const;
+    // Edges in the base plus delta entries; an upper bound of the visible
+    // degree, cheap enough for traversal cost estimates
+    uint32_t degreeBound(uint32_t node, Direction direction) const;
+
+    const std::shared_ptr<const CsrGraph>& base() const { return base_; }
+    const std::shared_ptr<const NodeTable>& baseNodes() const { return base_nodes_; }
+    const std::vector<std::shared_ptr<const DeltaSegment>>& deltas() const { return deltas_; }
+    const std::shared_ptr<const ColdEdgeSegment>& cold() const { return cold_; }
+    uint64_t coldEdgeCount() const { return cold_ ? cold_->edgeCount() : 0; }
+    // L2 concept layer matching this version; null until a super-node exists
+    const std::shared_ptr<const ConceptGraph>& concepts() const { return concepts_; }
+    size_t deltaEntryCount() const;
+    size_t memoryBytes() const;
+
+private:
+    // Applies the deltas on top of visible, which may alias scratch
+    std::span<const PackedEdge> overlay(std::span<const PackedEdge> visible, bool in_scratch, uint32_t node,
+                                        Direction direction, std::vector<PackedEdge>& scratch) const;
+
+    std::shared_ptr<const CsrGraph> base_;
+    std::shared_ptr<const NodeTable> base_nodes_;
+    std::vector<std::shared_ptr<const DeltaSegment>> deltas_;
+    std::shared_ptr<const ColdEdgeSegment> cold_;
+    std::shared_ptr<const ConceptGraph> concepts_;
+    uint32_t node_count_;
+    uint64_t edge_count_;
+};
+
+} // namespace memory::graph
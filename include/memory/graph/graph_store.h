@@ -0,0 +1,31 @@
+#pragma once
+
+#include "memory/core/types.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace memory::graph {
+
+// Node reached by a k-hop expansion
+struct HopNode {
+    core::NodeId node;
+    uint32_t hops;  // 0 for seeds
+};
+
+// Graph store interface (design doc §9.2)
+class IGraphStore {
+public:
+    virtual ~IGraphStore() = default;
+
+    // Adds or re-weights the (src, dst, type) edge
+    virtual void AddEdge(const core::Edge& edge) = 0;
+    virtual void RemoveEdge(core::NodeId src, core::NodeId dst, core::EdgeType type) = 0;
+    // Nodes within k hops of the seeds over the given edge types (all types
+    // when empty) with their hop distance, seeds included, nearest first
+    virtual std::vector<HopNode> KHopSeeds(std::span<const core::NodeId> seeds, int k,
+                                                std::span<const core::EdgeType> types = {}) const = 0;
+    virtual void Flush() = 0;
+};
+
+} // namespace memory::graph
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "memory/graph/graph_snapshot.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace memory::core {
+class Config;
+}
+
+namespace memory::graph {
+
+// Per-type transition weights. ABOUT, SUPPORTS, SIMILAR_TO and
+// TEMPORAL_NEXT follow design doc Appendix A; the rest sit between them by
+// how strongly the relation ties two memories together.
+constexpr std::array<float, kEdgeTypeCount> defaultPprTypeWeights() {
+    std::array<float, kEdgeTypeCount> w{};
+    auto set = [&w](core::EdgeType type, float weight) { w[static_cast<size_t>(type)] = weight; };
+    set(core::EdgeType::TEMPORAL_NEXT, 0.3f);
+    set(core::EdgeType::ABOUT, 1.0f);
+    set(core::EdgeType::MENTIONS, 0.7f);
+    set(core::EdgeType::CAUSES, 0.8f);
+    set(core::EdgeType::CAUSED_BY, 0.8f);
+    set(core::EdgeType::SUPPORTS, 0.8f);
+    set(core::EdgeType::CONTRADICTS, 0.4f);
+    set(core::EdgeType::DERIVED_FROM, 0.9f);
+    set(core::EdgeType::REFERS_TO, 0.6f);
+    set(core::EdgeType::SIMILAR_TO, 0.5f);
+    set(core::EdgeType::VERSION_NEXT, 0.2f);
+    set(core::EdgeType::ACTIVE_OF, 0.9f);
+    set(core::EdgeType::SAME_AS, 1.0f);
+    return w;
+}
+
+struct PprOptions {
+    // Restart (teleport) probability
+    float alpha = 0.15f;
+    // Forward push stops once every residual is below epsilon times its
+    // node's weighted degree; the L1 error is at most epsilon * total weight
+    double epsilon = 1e-4;
+    // Power iteration only: iteration cap and L1 convergence tolerance
+    size_t max_iterations = 50;
+    double tolerance = 1e-9;
+    // Multiplier of an edge's weight by type, indexed by core::EdgeType; a
+    // zero weight keeps the walk off that type
+    std::array<float, kEdgeTypeCount> type_weights = defaultPprTypeWeights();
+
+    // Reads graph.ppr_alpha / ppr_epsilon / ppr_iterations; alpha is clamped
+    // to [0.01, 1] and epsilon to a small positive floor
+    static PprOptions fromConfig(const core::Config& config);
+};
+
+struct PprScore {
+    uint32_t node;  // Dense index
+    float score;
+};
+
+struct PprStats {
+    uint64_t pushes = 0;         // Forward push: nodes pushed
+    size_t touched = 0;          // Nodes given any mass
+    size_t iterations = 0;       // Power iteration: iterations run
+    double residual_mass = 0.0;  // Mass not yet settled when stopping
+};
+
+// Personalized PageRank restarting at the seeds, walking edges in both
+// directions with probability proportional to type weight x edge weight.
+// A walk stuck on a node without usable edges restarts at the seeds.
+// seed_weights gives the restart distribution (uniform when empty) and is
+// normalized. Results have score > 0, best first, ties by node.
+
+// Local forward push (Andersen, Chung, Lang 2006). Work depends on epsilon
+// and the seeds' neighborhood, not on the graph size.
+std::vector<PprScore> forwardPushPpr(const GraphSnapshot& graph, std::span<const uint32_t> seeds,
+                                     std::span<const float> seed_weights, const PprOptions& options,
+                                     PprStats* stats = nullptr);
+
+// Global power iteration over every node; the accuracy reference
+std::vector<PprScore> powerIterationPpr(const GraphSnapshot& graph, std::span<const uint32_t> seeds,
+                                        std::span<const float> seed_weights, const PprOptions& options,
+                                        PprStats* stats = nullptr);
+
+} // namespace memory::graph
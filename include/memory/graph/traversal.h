@@ -0,0 +1,69 @@
+#pragma once
+
+#include "memory/graph/graph_snapshot.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace memory::core {
+class ThreadPool;
+}
+
+namespace memory::graph {
+
+// Reusable visited set for k-hop expansion. Each node holds a stamp; one
+// expansion claims a fresh range of stamps, so starting a query costs
+// nothing and the array is only cleared when the 32-bit stamps wrap.
+// Within an expansion, stamp base() + h marks a node reached at hop h.
+class EpochVisitedSet {
+public:
+    // Starts an expansion of up to max_hops over node_count nodes
+    void begin(uint32_t node_count, uint32_t max_hops);
+
+    uint32_t base() const { return base_; }
+    std::atomic<uint32_t>* stamps() { return stamps_.get(); }
+    size_t capacity() const { return capacity_; }
+
+private:
+    std::unique_ptr<std::atomic<uint32_t>[]> stamps_;
+    size_t capacity_ = 0;
+    uint32_t next_ = 1;
+    uint32_t base_ = 1;
+};
+
+// Node reached by an expansion, as a dense index
+struct HopIndex {
+    uint32_t node;
+    uint32_t hops;
+};
+
+struct KHopTuning {
+    // Direction-optimizing switches (Beamer et al.): go bottom-up when the
+    // frontier's edges exceed the unexplored edges / alpha, back top-down
+    // when the frontier shrinks below node_count / beta
+    double alpha = 15.0;
+    double beta = 18.0;
+    // Levels scanning fewer edges (top-down) or nodes (bottom-up) than this
+    // run on the calling thread
+    size_t parallel_threshold = 16384;
+};
+
+struct KHopStats {
+    uint32_t top_down_levels = 0;
+    uint32_t bottom_up_levels = 0;
+    uint32_t parallel_levels = 0;
+};
+
+// Level-synchronous BFS over edges of the masked types, in both
+// directions. Appends every node within k hops of the seeds to out, seeds
+// first with hops 0, then level by level; order within a level is
+// unspecified when a level runs in parallel. With a pool, large levels are
+// split by edges across its workers, so a hub's adjacency is shared too.
+KHopStats expandKHop(const GraphSnapshot& graph, std::span<const uint32_t> seeds, uint32_t k, EdgeTypeMask types,
+                     EpochVisitedSet& visited, std::vector<HopIndex>& out, core::ThreadPool* pool = nullptr,
+                     const KHopTuning& tuning = {});
+
+} // namespace memory::graph
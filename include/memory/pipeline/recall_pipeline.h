@@ -0,0 +1,170 @@
+#pragma once
+
+#include "memory/core/types.h"
+#include "memory/pipeline/score_combiner.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace memory::core {
+class Config;
+class NodeStore;
+class ThreadPool;
+class VersionSet;
+}
+
+namespace memory::search {
+class ISearchIndex;
+class InvertedIndex;
+}
+
+namespace memory::vector {
+class IVectorIndex;
+class HnswIndex;
+}
+
+namespace memory::graph {
+class CsrGraphStore;
+}
+
+namespace memory::pipeline {
+
+// Recall pipeline interface (design doc §9.2): picks keyword, vector and
+// graph retrieval by configuration and module health
+class IRecallPipeline {
+public:
+    virtual ~IRecallPipeline() = default;
+
+    virtual std::vector<core::ScoredId> Run(const core::RecallQuery& query) = 0;
+};
+
+struct RecallPipelineOptions {
+    // λ and node-weight parameters of the §5.3 re-ranking score
+    ScoreWeights weights;
+    // Hits each of stages A and B contribute, and nodes stage C ranks
+    size_t topk_candidates = 200;
+    // Results of Run()
+    size_t topk = 20;
+    // Upper bound on query.k_hop
+    int max_k_hop = 2;
+    // Stage B runs only when set, even with a vector index attached
+    bool vector_enabled = false;
+    // Workers of the private pool, when none is given
+    size_t max_threads = 4;
+    // Stages A and B must finish this long after Run() starts, stage C this
+    // long after it starts; a late stage is left behind and its result dropped
+    std::chrono::milliseconds bm25_deadline{50};
+    std::chrono::milliseconds vector_deadline{50};
+    std::chrono::milliseconds graph_deadline{100};
+
+    // Reads the weights as ScoreWeights::fromConfig does, and
+    // recall.topk_candidates / recall_topk / max_k_hop / bm25_deadline_ms /
+    // vector_deadline_ms / graph_deadline_ms, vector.enabled and
+    // performance.max_threads
+    static RecallPipelineOptions fromConfig(const core::Config& config);
+};
+
+// Query text to embedding; an empty result means the embedder is down
+using Embedder = std::function<std::vector<float>(std::string_view text)>;
+
+// Modules the pipeline draws on; any may be missing
+struct RecallSources {
+    std::shared_ptr<const search::ISearchIndex> search;   // Stage A
+    std::shared_ptr<const vector::IVectorIndex> vectors;  // Stage B, with embed
+    Embedder embed;
+    std::shared_ptr<const graph::CsrGraphStore> graph;    // Stage C
+    // Node columns for the weight term; without it the term is 0. Read by
+    // concurrent Run() calls, so the owner must not write it meanwhile.
+    std::shared_ptr<const core::NodeStore> nodes;
+    // Set the engines above are attached to. Each Run() then pins one
+    // StoreView and every stage reads its engine's snapshot from it; an
+    // engine without a part in the view, or that is not an InvertedIndex /
+    // HnswIndex, is read as of when its stage runs.
+    std::shared_ptr<core::VersionSet> versions;
+};
+
+enum class StageStatus {
+    OK,
+    SKIPPED,      // Disabled or not attached
+    UNAVAILABLE,  // Attached but could not run, e.g. no embedding or no seeds
+    TIMED_OUT,
+    FAILED        // Threw
+};
+
+std::string stageStatusToString(StageStatus status);
+
+struct StageTrace {
+    StageStatus status = StageStatus::SKIPPED;
+    size_t hits = 0;
+    double millis = 0.0;  // Until the result was taken or given up on
+    std::string detail;
+};
+
+// What one Run() did, for `memctl recall --trace`
+struct RecallTrace {
+    StageTrace bm25;    // A
+    StageTrace vector;  // B
+    StageTrace graph;   // C
+    // Stages whose results were used, in the notation of the §18 capability
+    // matrix: "A→B→C" when everything answered, "A→C" without vectors,
+    // "A→B" while the graph is unavailable, "A" for keywords alone
+    std::string path;
+    bool degraded = false;  // A stage that should have run did not contribute
+    double millis = 0.0;
+};
+
+// Multi-stage recall of design doc §5.2 with the degradation of §18.
+//
+// Stage A (BM25) and stage B (embedding + ANN) are independent and run
+// concurrently on the pool; stage C (k-hop expansion and personalized
+// PageRank from their seeds) starts once both have answered or missed their
+// deadlines. Run() never waits on a stage past its deadline: the stage keeps
+// running on the pool, its result is dropped, and the pipeline carries on
+// along the path the §18 matrix gives for the stages that did answer —
+// without B the score loses its vector term, without C its graph term.
+//
+// Final scores are λ1·BM25 + λ2·cos + λ3·GraphRank + λ4·Weight over the
+// union of the candidates, each stage term scaled by the best score of its
+// stage and Weight taken from the node store (see ScoreWeights). They are
+// combined column-wise by scoreKernels() and the top k selected without
+// sorting the rest.
+//
+// With RecallSources::versions, all stages of one Run() read the same
+// StoreView, so a recall never mixes versions of the engines.
+//
+// Thread-safe: concurrent Run() calls share the pool.
+class RecallPipeline : public IRecallPipeline {
+public:
+    // Runs stages on pool if given, else on a private pool of max_threads
+    // workers. A pool without workers runs the stages one after the other
+    // on the caller; a stage that overran its deadline is dropped all the
+    // same.
+    explicit RecallPipeline(RecallPipelineOptions options, RecallSources sources,
+                            std::shared_ptr<core::ThreadPool> pool = nullptr);
+    ~RecallPipeline() override;
+
+    RecallPipeline(const RecallPipeline&) = delete;
+    RecallPipeline& operator=(const RecallPipeline&) = delete;
+
+    std::vector<core::ScoredId> Run(const core::RecallQuery& query) override;
+    // Same, recording the path taken into trace
+    std::vector<core::ScoredId> Run(const core::RecallQuery& query, RecallTrace* trace);
+
+    const RecallPipelineOptions& options() const { return options_; }
+
+private:
+    RecallPipelineOptions options_;
+    RecallSources sources_;
+    // The sources again, typed for searching a pinned snapshot; null when
+    // no version set is attached or the source is another implementation
+    std::shared_ptr<const search::InvertedIndex> pinned_search_;
+    std::shared_ptr<const vector::HnswIndex> pinned_vectors_;
+    std::shared_ptr<core::ThreadPool> pool_;
+};
+
+} // namespace memory::pipeline
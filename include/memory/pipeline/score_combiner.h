@@ -0,0 +1,104 @@
+#pragma once
+
+#include "memory/core/cpu_features.h"
+#include "memory/core/types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace memory::core {
+class Config;
+class NodeStore;
+}
+
+namespace memory::pipeline {
+
+// One slot per core::NodeType
+inline constexpr size_t kNodeTypeSlots = 8;
+
+// Weights of the final re-ranking score (design doc §5.3)
+//
+//   score  = λ1·BM25 + λ2·cos + λ3·GraphRank + λ4·Weight
+//   Weight = α·importance + β·log(1 + frequency) + γ·exp(−Δt / τ_type)
+//
+// Weight is the §6.1 memory weight restricted to what NodeStore records:
+// the emotion, feedback and staleness terms have no column yet and count
+// as zero.
+struct ScoreWeights {
+    // λ1..λ4; stage scores are scaled to [0, 1] before they are weighted
+    float bm25 = 0.4f;
+    float vector = 0.3f;
+    float graph = 0.3f;
+    float node = 0.1f;
+    // α, β, γ of §6.1
+    float importance = 0.5f;
+    float frequency = 0.2f;
+    float recency = 0.3f;
+    // τ in days by NodeType: episodes fade in weeks, facts, preferences and
+    // tasks in months, concepts, entities and meta nodes slowest
+    std::array<float, kNodeTypeSlots> tau_days{14.0f, 90.0f, 90.0f, 180.0f, 180.0f, 90.0f, 180.0f, 180.0f};
+
+    float tau(core::NodeType type) const { return tau_days[static_cast<size_t>(type) % kNodeTypeSlots]; }
+
+    // Reads recall.bm25_weight / vector_weight / graph_weight / node_weight,
+    // memory.importance_weight / frequency_weight / recency_weight and
+    // memory.episode_tau / fact_tau / concept_tau
+    static ScoreWeights fromConfig(const core::Config& config);
+};
+
+// Re-ranking candidates as parallel columns: entry i of each belongs to
+// ids[i]. Stage scores default to 0 for stages that did not return the
+// node; node features default to "unknown node", which has no weight.
+struct CandidateColumns {
+    std::vector<core::NodeId> ids;
+    std::vector<float> bm25;
+    std::vector<float> cosine;
+    std::vector<float> graph;
+    // Node features, filled by gather()
+    std::vector<uint8_t> types;  // core::NodeType
+    std::vector<float> importance;
+    std::vector<float> frequency;
+    std::vector<float> age_days;
+
+    size_t size() const { return ids.size(); }
+    void clear();
+    void reserve(size_t n);
+    // Appends a candidate with zero scores and returns its position
+    size_t add(core::NodeId id);
+    // Looks every candidate up in nodes; age is measured up to now
+    void gather(const core::NodeStore& nodes, core::Timestamp now);
+};
+
+// One implementation of the combiner loop. Variants agree up to float
+// rounding; the vector ones use their own exp and log, accurate to a few
+// ulps.
+struct ScoreKernels {
+    const char* name;
+    core::SimdLevel level;
+
+    // out[i] = final score of candidate i, for all of columns
+    void (*combine)(const CandidateColumns& columns, const ScoreWeights& weights, float* out);
+};
+
+// Kernels for core::bestSimdLevel(), resolved once on first use
+const ScoreKernels& scoreKernels();
+// Kernels for a specific level, or nullptr if not compiled in or not
+// supported by the CPU. AVX2 also requires FMA.
+const ScoreKernels* scoreKernels(core::SimdLevel level);
+
+// Weight term of one node, the reference for the kernels
+float nodeWeight(const ScoreWeights& weights, core::NodeType type, float importance, float frequency,
+                 float age_days);
+
+// Final scores of columns into scores, resized to match
+void combineScores(const CandidateColumns& columns, const ScoreWeights& weights, std::vector<float>& scores);
+
+// The k best (id, score) pairs best-first, ordered like
+// core::TopKCollector::better. Costs O(n log k) through a bounded heap
+// when k is small against n, O(n + k log k) through nth_element otherwise;
+// never a full sort.
+std::vector<core::ScoredId> selectTopK(std::span<const core::NodeId> ids, std::span<const float> scores, size_t k);
+
+} // namespace memory::pipeline
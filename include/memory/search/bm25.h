@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace memory::search {
+
+struct Bm25Params {
+    float k1 = 1.2f;
+    float b = 0.75f;
+};
+
+// Okapi BM25 with the non-negative (Lucene) IDF variant
+class Bm25Scorer {
+public:
+    Bm25Scorer(Bm25Params params, double avg_doc_length)
+        : k1_(params.k1),
+          b_(params.b),
+          inv_avg_length_(avg_doc_length > 0.0 ? static_cast<float>(1.0 / avg_doc_length) : 0.0f) {}
+
+    // doc_count must count every doc that doc_freq may count (Lucene maxDoc);
+    // the clamp keeps stale statistics from ever yielding a negative weight
+    static float idf(uint64_t doc_count, uint64_t doc_freq) {
+        double n = static_cast<double>(doc_count);
+        double df = static_cast<double>(doc_freq);
+        return static_cast<float>(std::max(0.0, std::log(1.0 + (n - df + 0.5) / (df + 0.5))));
+    }
+
+    float score(float idf, uint32_t tf, uint32_t doc_length) const {
+        float f = static_cast<float>(tf);
+        float norm = k1_ * (1.0f - b_ + b_ * static_cast<float>(doc_length) * inv_avg_length_);
+        return idf * f * (k1_ + 1.0f) / (f + norm);
+    }
+
+private:
+    float k1_;
+    float b_;
+    float inv_avg_length_;
+};
+
+} // namespace memory::search
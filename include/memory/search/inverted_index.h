@@ -0,0 +1,194 @@
+#pragma once
+
+#include "memory/search/search_index.h"
+#include "memory/search/bm25.h"
+#include "memory/search/query_eval.h"
+#include "memory/search/query_parser.h"
+#include "memory/search/segment.h"
+#include "memory/search/term_interner.h"
+#include "memory/search/tokenizer.h"
+#include "memory/core/compaction.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace memory::core {
+class Config;
+class VersionSet;
+class WriteAheadLog;
+}
+
+namespace memory::search {
+
+struct SearchIndexOptions {
+    Bm25Params bm25;
+    size_t max_buffered_docs = 1000;
+    QueryEvaluation evaluation = QueryEvaluation::BLOCK_MAX_WAND;
+    TokenizerOptions tokenizer;
+    // Most distinct terms a `prefix*` query term expands to, highest
+    // document frequency first
+    size_t max_prefix_expansions = 64;
+    // When set, each sealed segment's term dictionary is written here and
+    // memory-mapped instead of kept on the heap
+    std::string directory;
+    // Store token positions for phrase ("a b") and proximity ("a b"~N)
+    // queries, in a stream separate from the doc/freq postings
+    bool index_positions = false;
+
+    // Reads search.bm25_k1 / bm25_b / max_buffered_docs / query_evaluation /
+    // max_prefix_expansions / index_dir / index_positions and the tokenizer
+    // options
+    static SearchIndexOptions fromConfig(const core::Config& config);
+};
+
+// Searchable state of an InvertedIndex at one version: the sealed segments
+// and the collection statistics BM25 needs. Never changes once published;
+// deletions stamped with a later version are still live in it.
+struct SearchSnapshot {
+    struct Part {
+        std::shared_ptr<const Segment> segment;
+        uint32_t live_count = 0;
+    };
+
+    uint64_t version = 0;
+    std::vector<Part> segments;
+    uint64_t live_docs = 0;
+    uint64_t live_length = 0;
+};
+
+// Segmented BM25 inverted index.
+//
+// Upserts are buffered in memory and become searchable once the buffer is
+// sealed into an immutable segment, either by Flush() or automatically when
+// max_buffered_docs is reached. Until then a replaced document keeps
+// answering with its previous version. Removes take effect immediately.
+//
+// Every change that affects searches publishes a new SearchSnapshot through
+// an atomic shared_ptr. Queries load the current one, or run against one
+// the caller pinned, and never take a lock: a removal only stamps the
+// document with the version of the snapshot it first disappears from.
+//
+// Queries are tokenized like documents, with the phrase, proximity and
+// prefix syntax of parseQuery(). Phrase queries need index_positions.
+//
+// With a write-ahead log attached, every Upsert and Remove is logged
+// before it is applied and returns once the record is durable.
+//
+// As a compaction target, the index merges sealed segments by size tier
+// (merge_factor segments whose live doc counts share a power of
+// merge_factor) and rewrites segments whose deleted share exceeds the
+// fragmentation threshold. Merging re-inverts the docs live in the current
+// snapshot outside the writer lock, so deleted docs are physically dropped
+// while writes and queries continue.
+class InvertedIndex : public ISearchIndex, public core::ICompactable {
+public:
+    // Uses a StandardTokenizer built from options.tokenizer unless another
+    // tokenizer is supplied
+    explicit InvertedIndex(SearchIndexOptions options = {}, std::shared_ptr<const Tokenizer> tokenizer = nullptr);
+
+    void Upsert(uint64_t docId, std::string_view text, std::span<const uint32_t> fields = {}) override;
+    void Remove(uint64_t docId) override;
+    std::vector<core::ScoredId> Search(std::string_view query, size_t topk) const override;
+    void Flush() override;
+
+    // Replays the SEARCH records of wal after after_lsn (the LSN the index
+    // was last persisted at), then logs every later change to it. Call
+    // before any writes.
+    void attachWal(std::shared_ptr<core::WriteAheadLog> wal, uint64_t after_lsn = 0);
+    // Publishes the current and every later snapshot into versions
+    void attachVersions(std::shared_ptr<core::VersionSet> versions);
+
+    // Same as Search() with an explicit evaluation strategy, e.g. EXHAUSTIVE
+    // to cross-check that Block-Max WAND pruning returns identical results
+    std::vector<core::ScoredId> Search(std::string_view query, size_t topk, QueryEvaluation evaluation) const;
+    // Searches a pinned snapshot of this index
+    std::vector<core::ScoredId> Search(const SearchSnapshot& snapshot, std::string_view query, size_t topk) const;
+    std::vector<core::ScoredId> Search(const SearchSnapshot& snapshot, std::string_view query, size_t topk,
+                                       QueryEvaluation evaluation) const;
+
+    // Boolean retrieval without scoring: ids of live docs containing every
+    // (MatchAll) or any (MatchAny) query term, ascending
+    std::vector<uint64_t> MatchAll(std::string_view query) const;
+    std::vector<uint64_t> MatchAny(std::string_view query) const;
+    std::vector<uint64_t> MatchAll(const SearchSnapshot& snapshot, std::string_view query) const;
+    std::vector<uint64_t> MatchAny(const SearchSnapshot& snapshot, std::string_view query) const;
+
+    // Current consistent view; stays valid while held
+    std::shared_ptr<const SearchSnapshot> snapshot() const { return snapshot_.load(); }
+
+    size_t segmentCount() const;
+    // Searchable (sealed and live) documents
+    size_t docCount() const;
+    size_t bufferedCount() const;
+    size_t memoryBytes() const;
+
+    std::string compactionName() const override { return "search"; }
+    // Share of the docs in sealed segments that are deleted
+    double fragmentation() const override;
+    bool compactionDue(const core::CompactionOptions& options) const override;
+    core::CompactionResult compact(const core::CompactionOptions& options, core::RateLimiter& limiter) override;
+
+private:
+    struct BufferedDoc {
+        SegmentBuilder::TermFreqs term_freqs;
+        std::vector<uint32_t> positions;  // Grouped by term, when index_positions is set
+        uint32_t length = 0;
+    };
+
+    struct DocLocation {
+        uint32_t segment;  // Index into segments_
+        uint32_t ord;
+    };
+
+    struct SealedSegment {
+        std::shared_ptr<Segment> segment;
+        uint32_t live_count = 0;
+        std::string dictionary_path;  // Empty when the dictionary is on the heap
+    };
+
+    // Indices into snapshot.segments of the segments to merge, empty if none
+    static std::vector<size_t> compactionPlan(const SearchSnapshot& snapshot,
+                                              const core::CompactionOptions& options);
+
+    ParsedQuery parse(const SearchSnapshot& snapshot, std::string_view query) const;
+    std::vector<std::string> expandPrefix(const SearchSnapshot& snapshot, std::string_view prefix) const;
+    // Cursors for every phrase in the segment; false if a phrase term is missing
+    bool phraseCursors(const Segment& segment, const ParsedQuery& query, const std::vector<float>* phrase_idfs,
+                       std::vector<PhraseCursor>& phrases) const;
+    std::vector<uint64_t> matchBoolean(const SearchSnapshot& snapshot, std::string_view query,
+                                       bool conjunctive) const;
+
+    // Methods below require mutex_
+    // Drops the buffered and the sealed copy; returns true if a searchable
+    // document was deleted
+    bool removeLocked(uint64_t doc_id);
+    // Stamps the sealed copy deleted as of the next version, if any
+    bool unsealLocked(uint64_t doc_id);
+    // Returns true if a segment was sealed
+    bool sealBufferLocked();
+    // Publishes the writer state as the next snapshot version
+    void publishLocked();
+    // Path for the next sealed or merged segment's dictionary, if on disk
+    std::string nextDictionaryPathLocked();
+
+    SearchIndexOptions options_;
+    std::shared_ptr<const Tokenizer> tokenizer_;
+    std::shared_ptr<core::WriteAheadLog> wal_;
+    std::shared_ptr<core::VersionSet> versions_;
+    mutable std::mutex mutex_;  // Serializes writers
+    std::mutex compaction_mutex_;  // One compaction at a time; taken before mutex_
+    TermInterner terms_;  // Terms of the buffered docs; cleared on seal
+    std::vector<SealedSegment> segments_;
+    std::unordered_map<uint64_t, DocLocation> locations_;
+    std::unordered_map<uint64_t, BufferedDoc> buffer_;
+    uint64_t next_segment_ = 0;
+    uint64_t live_docs_ = 0;
+    uint64_t live_length_ = 0;
+    uint64_t version_ = 0;  // Of the last published snapshot
+    std::atomic<std::shared_ptr<const SearchSnapshot>> snapshot_;
+};
+
+} // namespace memory::search
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace memory::search {
+
+// Number of doc IDs per compressed postings block
+inline constexpr uint32_t kPostingBlockSize = 128;
+
+// Sentinel returned by cursors once the list is exhausted
+inline constexpr uint32_t kNoMoreDocs = std::numeric_limits<uint32_t>::max();
+
+// Bytes of zero padding appended after every postings buffer so that block
+// decoders may read a full vector past the last packed word.
+inline constexpr size_t kPostingPadding = 32;
+
+// Per-block skip entry. One entry per block, stored contiguously per term.
+// max_freq/min_length bound the BM25 contribution of any doc in the block
+// (the score grows with tf and shrinks with doc length), which is what
+// Block-Max WAND uses to skip blocks without decoding them.
+struct SkipEntry {
+    uint32_t last_doc;    // Largest doc ordinal in the block
+    uint32_t offset;      // Byte offset of the block from the term's first block
+    uint32_t max_freq;    // Largest term frequency in the block
+    uint32_t min_length;  // Shortest document length in the block
+};
+
+// === Block codec ===
+//
+// Full blocks hold 128 values bit-packed in a 4-lane interleaved layout:
+// value i lives in lane (i % 4), and the 32-bit words of the four lanes are
+// interleaved, so each lane contributes `bits` words and a block takes
+// exactly 16 * bits bytes. Short tail blocks fall back to varint.
+
+// Smallest bit width able to represent every value
+uint32_t requiredBits(const uint32_t* values, size_t count);
+
+// Size in bytes of one packed 128-value block at the given width
+inline constexpr size_t packedBlockBytes(uint32_t bits) {
+    return static_cast<size_t>(bits) * 16;
+}
+
+void packBlock(const uint32_t* values, uint32_t bits, uint8_t* out);
+// Decoding goes through the runtime-dispatched kernels (simd_kernels.h)
+void unpackBlock(const uint8_t* in, uint32_t bits, uint32_t* out);
+
+// In-place inclusive prefix sum of 128 deltas starting from base
+void prefixSumBlock(uint32_t* values, uint32_t base);
+
+void encodeVarint(uint32_t value, std::vector<uint8_t>& out);
+const uint8_t* decodeVarint(const uint8_t* in, uint32_t& value);
+
+// Appends postings for one term (doc ordinals ascending) to a shared buffer
+class PostingsWriter {
+public:
+    PostingsWriter(std::vector<uint8_t>& bytes, std::vector<SkipEntry>& skips);
+
+    void add(uint32_t doc, uint32_t freq, uint32_t doc_length);
+    // Flushes the pending tail block; returns the number of postings written
+    uint32_t finish();
+
+private:
+    void writeBlock(bool full);
+
+    std::vector<uint8_t>& bytes_;
+    std::vector<SkipEntry>& skips_;
+    size_t term_start_;
+    uint32_t docs_[kPostingBlockSize];
+    uint32_t freqs_[kPostingBlockSize];
+    uint32_t max_freq_ = 0;
+    uint32_t min_length_ = 0;
+    uint32_t buffered_ = 0;
+    uint32_t last_doc_ = 0;
+    uint32_t count_ = 0;
+};
+
+// Forward iterator over one term's postings with skip-based advance
+class PostingCursor {
+public:
+    PostingCursor() = default;
+    PostingCursor(const uint8_t* data, const SkipEntry* skips, uint32_t doc_freq);
+
+    uint32_t doc() const { return doc_; }
+    uint32_t freq() const { return freqs_[pos_]; }
+    uint32_t docFreq() const { return doc_freq_; }
+    uint32_t blockCount() const { return block_count_; }
+    const SkipEntry& skipEntry(uint32_t block) const { return skips_[block]; }
+
+    // Decoded state of the current block, used to locate positions
+    uint32_t block() const { return block_; }
+    uint32_t blockPosition() const { return pos_; }
+    uint32_t blockLength() const { return block_len_; }
+    const uint32_t* blockFreqs() const { return freqs_; }
+
+    void next();
+    // Moves to the first doc >= target, skipping whole blocks where possible
+    void advance(uint32_t target);
+    // Returns the skip entry of the block that would hold target without
+    // decoding anything, or nullptr if target is past the last block
+    const SkipEntry* shallowAdvance(uint32_t target);
+    // Appends the remaining doc ordinals to out and exhausts the cursor
+    void decodeAll(std::vector<uint32_t>& out);
+
+private:
+    void loadBlock(uint32_t block);
+
+    const uint8_t* data_ = nullptr;
+    const SkipEntry* skips_ = nullptr;
+    uint32_t doc_freq_ = 0;
+    uint32_t block_count_ = 0;
+    uint32_t block_ = 0;
+    uint32_t shallow_block_ = 0;
+    uint32_t block_len_ = 0;
+    uint32_t pos_ = 0;
+    uint32_t doc_ = kNoMoreDocs;
+    uint32_t docs_[kPostingBlockSize];
+    uint32_t freqs_[kPostingBlockSize];
+};
+
+// === Positions ===
+//
+// Optional per-occurrence token positions live in a stream separate from the
+// doc/freq blocks, so queries that never ask for positions never touch them.
+// For every postings block the positions of its docs are concatenated as
+// gaps (first position of a doc absolute, then deltas) and stored in chunks
+// of 128: full chunks as [u8 bits][packed block], the tail as varints.
+
+// Appends positions for one term; one add() per posting, in posting order
+class PositionsWriter {
+public:
+    // block_offsets receives one entry per postings block, relative to the
+    // term's first positions byte, parallel to the term's skip entries
+    PositionsWriter(std::vector<uint8_t>& bytes, std::vector<uint32_t>& block_offsets);
+
+    void add(const uint32_t* positions, uint32_t count);
+    void finish();
+
+private:
+    void writeBlock();
+
+    std::vector<uint8_t>& bytes_;
+    std::vector<uint32_t>& block_offsets_;
+    size_t term_start_;
+    std::vector<uint32_t> gaps_;
+    uint32_t docs_ = 0;
+};
+
+// Decodes the positions of a PostingCursor's current doc. Decodes a whole
+// block at a time and caches it while the cursor stays in that block.
+class PositionReader {
+public:
+    PositionReader() = default;
+    PositionReader(const uint8_t* data, const uint32_t* block_offsets);
+
+    // Ascending positions of cursor.doc(); valid until the next call
+    std::span<const uint32_t> positions(const PostingCursor& cursor);
+
+private:
+    void decodeBlock(const PostingCursor& cursor);
+
+    const uint8_t* data_ = nullptr;
+    const uint32_t* block_offsets_ = nullptr;
+    uint32_t block_ = kNoMoreDocs;
+    std::vector<uint32_t> values_;
+    uint32_t starts_[kPostingBlockSize + 1];
+};
+
+} // namespace memory::search
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "memory/search/bm25.h"
+#include "memory/search/postings.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace memory::core {
+class TopKCollector;
+}
+
+namespace memory::search {
+
+class Segment;
+
+// Strategy used to compute top-k for a disjunctive (OR) BM25 query
+enum class QueryEvaluation {
+    BLOCK_MAX_WAND,  // Dynamic pruning with per-block score bounds (default)
+    EXHAUSTIVE       // Scores every posting; reference for validating pruning
+};
+
+QueryEvaluation stringToQueryEvaluation(std::string_view str);
+
+// One query term's cursor inside a single segment
+struct TermCursor {
+    PostingCursor cursor;
+    float idf = 0.0f;
+    float max_score = 0.0f;  // Upper bound of the term's contribution in this segment
+    size_t term = 0;         // Position of the term in the query, fixes summation order
+};
+
+// One phrase's terms inside a single segment
+struct PhraseCursor {
+    std::vector<PostingCursor> cursors;    // One per phrase term, in phrase order
+    std::vector<PositionReader> positions;  // Parallel to cursors
+    std::vector<uint32_t> offsets;         // Query position of each term relative to the first
+    uint32_t slop = 0;
+    float idf = 0.0f;                      // Sum of the phrase terms' idf
+
+    // Occurrences of the phrase in the doc every cursor is positioned on.
+    // With slop 0 the terms must sit exactly at their query offsets;
+    // otherwise a window counts when its offset-adjusted positions span at
+    // most slop.
+    uint32_t matchCount();
+
+private:
+    std::vector<std::span<const uint32_t>> lists_;  // Scratch for matchCount()
+    std::vector<size_t> index_;
+};
+
+// Builds a cursor and computes its segment-wide score bound from the skip
+// entries. The bounds start at 0 and are only valid for non-negative term
+// scores, so a negative idf is clamped to 0.
+TermCursor makeTermCursor(PostingCursor cursor, float idf, size_t term, const Bm25Scorer& scorer);
+
+// Both evaluators push docs of the segment live in snapshot version into
+// the shared collector. Scores are summed in query-term order, so both
+// produce bit-identical results.
+void evaluateExhaustive(const Segment& segment, uint64_t version, std::vector<TermCursor>& cursors,
+                        const Bm25Scorer& scorer, core::TopKCollector& collector);
+void evaluateBlockMaxWand(const Segment& segment, uint64_t version, std::vector<TermCursor>& cursors,
+                          const Bm25Scorer& scorer, core::TopKCollector& collector);
+
+// Scores the docs live in version that contain every phrase. Each phrase
+// is scored as one BM25 pseudo-term (tf = occurrences, idf =
+// PhraseCursor::idf), then the optional terms are added in query-term
+// order. No pruning: phrase conjunctions are already selective.
+void evaluatePhrases(const Segment& segment, uint64_t version, std::vector<PhraseCursor>& phrases,
+                     std::vector<TermCursor>& cursors, const Bm25Scorer& scorer,
+                     core::TopKCollector& collector);
+
+// Ordinals (live or not) of the docs containing every phrase, ascending
+std::vector<uint32_t> matchPhrases(std::vector<PhraseCursor>& phrases);
+
+} // namespace memory::search
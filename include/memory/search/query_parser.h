@@ -0,0 +1,45 @@
+#pragma once
+
+#include "memory/search/tokenizer.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace memory::search {
+
+// A single query term, or the alternatives a prefix term expanded to
+struct TermClause {
+    std::vector<std::string> terms;
+};
+
+// Quoted phrase; a non-zero slop turns it into a proximity match
+struct PhraseClause {
+    std::vector<std::string> terms;  // In query order, may repeat
+    std::vector<uint32_t> offsets;   // Token position of each term relative to the first
+    uint32_t slop = 0;
+};
+
+struct ParsedQuery {
+    std::vector<TermClause> terms;
+    std::vector<PhraseClause> phrases;
+
+    bool empty() const { return terms.empty() && phrases.empty(); }
+};
+
+// Returns the index terms starting with prefix
+using PrefixExpander = std::function<std::vector<std::string>(std::string_view prefix)>;
+
+// Query syntax layered over the tokenizer:
+//   "a b c"    phrase: the tokens must occur at the same relative positions,
+//              e.g. "0x8007045D" or "C:\Windows\System32\drivers"
+//   "a b"~N    proximity: the phrase within N position moves (Lucene slop)
+//   word*      prefix: the last token of word matches every term it starts
+// Phrases are required; plain and prefix terms are optional in ranked
+// search. Text outside these forms goes to the tokenizer unchanged. A phrase
+// that tokenizes to a single term becomes a plain term; an unterminated quote
+// runs to the end of the query.
+ParsedQuery parseQuery(std::string_view query, const Tokenizer& tokenizer, const PrefixExpander& expand);
+
+} // namespace memory::search
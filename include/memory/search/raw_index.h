@@ -0,0 +1,179 @@
+#pragma once
+
+#include "memory/search/inverted_index.h"
+#include "memory/core/raw_store.h"
+#include "memory/core/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace memory::core {
+class Config;
+}
+
+namespace memory::search {
+
+struct RawIndexOptions {
+    // Days of raw content that stay searchable, today (UTC) included
+    int window_days = 7;
+    // Target passage size; paragraphs are merged up to it and longer ones
+    // are cut near it
+    size_t passage_bytes = 1024;
+    // When set, the segment dictionaries of every partition are memory-mapped
+    // from <directory>/<tenant>/<YYYYMMDD>
+    std::string directory;
+    // Settings of the per-day indexes. Positions are always on and the
+    // directory is set per partition.
+    SearchIndexOptions search;
+
+    // Reads raw.raw_window_days / raw_passage_bytes / raw_index_dir and the
+    // search options (positions are always on)
+    static RawIndexOptions fromConfig(const core::Config& config);
+};
+
+// Byte range of a passage within its chunk
+struct Passage {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+// Cuts text into passages of about passage_bytes: paragraphs (separated by
+// blank lines) with their surrounding whitespace trimmed, short neighbours
+// joined and long ones split at a line break, sentence end or space near the
+// limit, never inside a UTF-8 sequence. Whitespace-only text has none.
+std::vector<Passage> splitPassages(std::string_view text, size_t passage_bytes);
+
+struct RawHit {
+    core::RawRef ref;  // The passage
+    float score = 0.0f;
+    uint32_t day = 0;  // YYYYMMDD of its partition
+};
+
+// === W5 trigger ===
+//
+// When recall answers from raw text instead of, or besides, the graph
+// (design doc §4.y): on request, when the node index found too little, or
+// when the query carries literals (error codes, paths, URLs, ids) that
+// summarised nodes rarely keep verbatim.
+struct RawFallbackOptions {
+    // Fewer node hits than this counts as low coverage
+    size_t low_coverage_topn = 10;
+    // Fall back on literal-looking query tokens
+    bool pattern_trigger = true;
+
+    // Reads raw.raw_low_coverage_topn / raw_pattern_trigger
+    static RawFallbackOptions fromConfig(const core::Config& config);
+};
+
+enum class RawFallbackReason {
+    NONE,
+    EXPLICIT,
+    LOW_COVERAGE,
+    LITERAL
+};
+
+// URL, file path, UUID, hex constant or hash, error code (E1234,
+// ORA-00942), number of five or more digits, file name or identifier
+// (snake_case, a::b, f())
+bool looksLikeLiteral(std::string_view token);
+
+RawFallbackReason needsRawFallback(std::string_view query, size_t node_hits, const RawFallbackOptions& options,
+                                   bool explicit_request = false);
+
+// === Passage index ===
+//
+// BM25 over the passages of the RawChunks of the short-term window. Every
+// (tenant, UTC day) is a partition of its own, an InvertedIndex over that
+// day's passages, so a day leaving the window is dropped as a whole — its
+// segments and files — instead of deleting passages one by one. Scores are
+// per partition (each day has its own statistics) and merged by score.
+//
+// The index is derived data: it is not persisted but rebuilt from the
+// RawStore on start (Rebuild), which reads only the chunks of the window.
+//
+// Literal-looking query tokens are searched as phrases, so 0x80070005 or
+// C:\Windows\System32 match the exact token sequence rather than any of
+// their parts.
+//
+// Thread-safe; searches run concurrently with each other.
+class RawIndex {
+public:
+    explicit RawIndex(RawIndexOptions options = {});
+    ~RawIndex();
+
+    RawIndex(const RawIndex&) = delete;
+    RawIndex& operator=(const RawIndex&) = delete;
+
+    // Indexes the passages of a chunk created at created_at. Returns the
+    // number indexed: 0 when the chunk is outside the window at now or
+    // already indexed. Like InvertedIndex, passages become searchable once
+    // their partition's buffer is sealed, at the latest on Flush().
+    size_t Add(std::string_view tenant, const core::Sha256Digest& chunk, std::string_view text,
+               core::Timestamp created_at, core::Timestamp now = std::chrono::system_clock::now());
+    void Flush();
+    // Indexes every chunk of store within the window at now, then flushes.
+    // Returns the number of chunks read.
+    size_t Rebuild(const core::RawStore& store, core::Timestamp now = std::chrono::system_clock::now());
+
+    // Best passages of tenant across the partitions within the window at now,
+    // highest score first, ties to the newer day
+    std::vector<RawHit> Search(std::string_view tenant, std::string_view query, size_t topk,
+                               core::Timestamp now = std::chrono::system_clock::now()) const;
+
+    // Drops the partitions that left the window at now, with their files.
+    // Returns how many were dropped.
+    size_t Expire(core::Timestamp now = std::chrono::system_clock::now());
+
+    size_t partitionCount() const;
+    size_t passageCount() const;
+    const RawIndexOptions& options() const { return options_; }
+
+    // The query as Search() runs it: literal-looking tokens quoted, unless
+    // the query already uses phrase syntax
+    static std::string rewriteQuery(std::string_view query);
+
+private:
+    struct Partition;
+
+    // Days since the epoch of the first day within the window at now
+    int64_t firstDay(core::Timestamp now) const;
+
+    RawIndexOptions options_;
+    mutable std::shared_mutex mutex_;  // Guards partitions_ and their passage lists
+    // By tenant name, then days since the epoch
+    std::map<std::string, std::map<int64_t, std::unique_ptr<Partition>>> partitions_;
+};
+
+// === Merge with graph recall ===
+
+struct RecallHit {
+    enum class Source : uint8_t {
+        GRAPH,
+        RAW
+    };
+
+    Source source = Source::GRAPH;
+    core::NodeId node = 0;  // GRAPH
+    core::RawRef ref;       // RAW
+    float score = 0.0f;
+};
+
+// raw_refs of a node, empty if it has none or is unknown
+using RawRefsOf = std::function<std::vector<core::RawRef>(core::NodeId)>;
+
+// Ranks graph hits and raw passages in one list of at most topk. Each list
+// is scaled by its best score (raw scores then by raw_weight) so the two
+// compare; a passage overlapping the raw_refs of a graph hit, or a passage
+// already taken, is dropped as the same evidence. Equal scores keep graph
+// hits first.
+std::vector<RecallHit> mergeRawHits(std::span<const core::ScoredId> graph_hits, std::span<const RawHit> raw_hits,
+                                    size_t topk, const RawRefsOf& raw_refs_of, float raw_weight = 1.0f);
+
+} // namespace memory::search
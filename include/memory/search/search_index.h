@@ -0,0 +1,22 @@
+#pragma once
+
+#include "memory/core/types.h"
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace memory::search {
+
+// Inverted index interface (design doc §9.2). Required module, can run standalone.
+class ISearchIndex {
+public:
+    virtual ~ISearchIndex() = default;
+
+    virtual void Upsert(uint64_t docId, std::string_view text, std::span<const uint32_t> fields = {}) = 0;
+    virtual void Remove(uint64_t docId) = 0;
+    virtual std::vector<core::ScoredId> Search(std::string_view query, size_t topk) const = 0;
+    virtual void Flush() = 0;
+};
+
+} // namespace memory::search
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "memory/search/postings.h"
+#include "memory/search/term_dictionary.h"
+#include "memory/search/term_interner.h"
+#include "memory/core/mapped_file.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace memory::search {
+
+// Dictionary entry pointing into a segment's postings and skip arrays
+struct TermInfo {
+    uint32_t doc_freq = 0;
+    uint32_t skip_start = 0;        // Index of the first SkipEntry of the term
+    uint64_t postings_offset = 0;   // Byte offset of the first block
+    uint64_t positions_offset = 0;  // Byte offset of the first positions block
+};
+
+// Immutable, block-compressed slice of the index. Documents are addressed by
+// dense ordinals and terms by their ordinal in the segment's front-coded
+// TermDictionary. Only deletion stamps are added after the segment is built:
+// each records the snapshot version that deleted the document, so readers
+// of older snapshots still see it.
+class Segment {
+public:
+    uint32_t docCount() const { return static_cast<uint32_t>(doc_ids_.size()); }
+    uint64_t docId(uint32_t ord) const { return doc_ids_[ord]; }
+    uint32_t docLength(uint32_t ord) const { return doc_lengths_[ord]; }
+    size_t termCount() const { return term_infos_.size(); }
+
+    // Whether the document is live in snapshot version
+    bool isLive(uint32_t ord, uint64_t version) const {
+        uint64_t deleted_at = std::atomic_ref(deleted_at_[ord]).load(std::memory_order_relaxed);
+        return deleted_at == 0 || deleted_at > version;
+    }
+    // Deletes the document as of snapshot version (nonzero); returns false
+    // if it was already deleted
+    bool markDeleted(uint32_t ord, uint64_t version);
+
+    const TermInfo* findTerm(std::string_view term) const;
+    const TermInfo& termInfo(uint32_t ordinal) const { return term_infos_[ordinal]; }
+    const TermDictionary& dictionary() const { return dictionary_; }
+    PostingCursor cursor(const TermInfo& info) const;
+
+    // Whether token positions were indexed; positions() requires it
+    bool hasPositions() const { return has_positions_; }
+    PositionReader positions(const TermInfo& info) const;
+
+    // Dictionary file image, memory-mapped when the segment was built with a
+    // dictionary path and held on the heap otherwise
+    std::span<const uint8_t> dictionaryImage() const;
+    bool dictionaryMapped() const { return dictionary_file_.isOpen(); }
+
+    // Approximate heap footprint of postings, dictionary and per-doc arrays
+    // (mapped dictionary pages are not counted)
+    size_t memoryBytes() const;
+
+private:
+    friend class SegmentBuilder;
+
+    std::vector<uint8_t> dictionary_bytes_;
+    core::MappedFile dictionary_file_;
+    TermDictionary dictionary_;
+    std::vector<TermInfo> term_infos_;  // By dictionary ordinal
+    std::vector<SkipEntry> skips_;
+    std::vector<uint8_t> postings_;
+    std::vector<uint8_t> positions_;
+    std::vector<uint32_t> position_blocks_;  // Parallel to skips_
+    bool has_positions_ = false;
+    std::vector<uint64_t> doc_ids_;
+    std::vector<uint32_t> doc_lengths_;
+    // Snapshot version that deleted each doc, 0 while live. Written by the
+    // index writer, read by queries through std::atomic_ref.
+    mutable std::vector<uint64_t> deleted_at_;
+};
+
+// Accumulates tokenized documents and seals them into a Segment
+class SegmentBuilder {
+public:
+    // (term ID, frequency) pairs of one document
+    using TermFreqs = std::vector<std::pair<uint32_t, uint32_t>>;
+
+    explicit SegmentBuilder(bool with_positions = false) : has_positions_(with_positions) {}
+
+    // Assigns the next ordinal to the document and returns it. With
+    // positions enabled, positions holds the ascending positions of every
+    // term back to back in term_freqs order (freq values per term).
+    uint32_t addDocument(uint64_t doc_id, const TermFreqs& term_freqs, uint32_t length,
+                         std::span<const uint32_t> positions = {});
+    uint32_t docCount() const { return static_cast<uint32_t>(doc_ids_.size()); }
+
+    // Writes postings and the term dictionary in one pass over the terms in
+    // byte order. With a dictionary_path the dictionary is written there and
+    // memory-mapped instead of kept on the heap.
+    std::unique_ptr<Segment> build(const TermInterner& terms, const std::string& dictionary_path = {});
+
+private:
+    struct PendingPostings {
+        std::vector<std::pair<uint32_t, uint32_t>> docs;  // (ordinal, freq)
+        std::vector<uint32_t> positions;
+    };
+
+    std::unordered_map<uint32_t, PendingPostings> postings_;
+    bool has_positions_;
+    std::vector<uint64_t> doc_ids_;
+    std::vector<uint32_t> doc_lengths_;
+};
+
+} // namespace memory::search
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "memory/core/cpu_features.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace memory::search {
+
+// Extra output capacity (in values) the intersect/union kernels may write
+// past the logical end of their result; SIMD variants store whole vectors.
+inline constexpr size_t kKernelOutputSlack = 8;
+
+// One implementation of the postings hot loops. All variants produce
+// identical results; they differ only in the instruction set used.
+struct PostingKernels {
+    const char* name;
+    core::SimdLevel level;
+
+    // Unpacks a 128-value block in the interleaved layout of packBlock()
+    void (*unpack)(const uint8_t* in, uint32_t bits, uint32_t* out);
+    // In-place inclusive prefix sum of 128 deltas starting from base
+    void (*prefix_sum)(uint32_t* values, uint32_t base);
+    // Sorted, duplicate-free inputs. `out` needs min(na, nb) + kKernelOutputSlack slots.
+    size_t (*intersect)(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out);
+    // Sorted, duplicate-free inputs. `out` needs na + nb + kKernelOutputSlack slots.
+    size_t (*merge_union)(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out);
+};
+
+// Kernels for core::bestSimdLevel(), resolved once on first use
+const PostingKernels& postingKernels();
+// Kernels for a specific level, or nullptr if not compiled in or not supported by the CPU
+const PostingKernels* postingKernels(core::SimdLevel level);
+
+std::vector<uint32_t> intersectSorted(std::span<const uint32_t> a, std::span<const uint32_t> b);
+std::vector<uint32_t> unionSorted(std::span<const uint32_t> a, std::span<const uint32_t> b);
+
+} // namespace memory::search
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "memory/core/file_format.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace memory::search {
+
+// === On-disk term dictionary ===
+//
+// Sorted, front-coded term list mapping each term to its ordinal (rank in
+// byte order). Values such as TermInfo live in separate arrays indexed by
+// ordinal, so a prefix maps to a contiguous ordinal range.
+//
+// Layout after the core::FileHeader (magic "TDIC"):
+//   blocks     groups of kDictBlockTerms terms; the first term of a block is
+//              stored whole as [varint len][bytes], the rest as
+//              [varint shared prefix][varint suffix len][suffix bytes]
+//   offsets    u32 payload offset of every block, 4-byte aligned
+//   trailer    u32 term_count, u32 block_count
+// The reader works directly on the bytes, e.g. a read-only memory mapping.
+
+inline constexpr uint32_t kTermDictionaryMagic = core::makeMagic('T', 'D', 'I', 'C');
+inline constexpr uint16_t kTermDictionaryVersion = 1;
+inline constexpr uint32_t kDictBlockTerms = 16;
+
+// Streams strictly increasing terms into a dictionary image in one pass
+class TermDictionaryWriter {
+public:
+    // Appends to out, starting with a placeholder header
+    explicit TermDictionaryWriter(std::vector<uint8_t>& out);
+
+    // Returns the ordinal of term. Throws IndexException if term is not
+    // greater than the previous one.
+    uint32_t add(std::string_view term);
+    // Writes the block offsets and trailer and seals the header
+    void finish();
+
+private:
+    std::vector<uint8_t>& out_;
+    size_t header_offset_;
+    std::string last_;
+    std::vector<uint32_t> block_offsets_;
+    uint32_t count_ = 0;
+    bool finished_ = false;
+};
+
+// Read-only view over a dictionary image. Does not own the bytes.
+class TermDictionary {
+public:
+    static constexpr uint32_t kNotFound = std::numeric_limits<uint32_t>::max();
+
+    TermDictionary() = default;
+    // Validates header and structure; throws core::StorageException if the
+    // image is corrupt
+    explicit TermDictionary(std::span<const uint8_t> image);
+
+    uint32_t size() const { return term_count_; }
+
+    // Ordinal of term, or kNotFound
+    uint32_t find(std::string_view term) const;
+    // Ordinal of the first term >= key (size() if none)
+    uint32_t lowerBound(std::string_view key) const;
+    // Ordinals [first, second) of all terms starting with prefix
+    std::pair<uint32_t, uint32_t> prefixRange(std::string_view prefix) const;
+
+    // Sequential decoder; term() stays valid until the next call to next()
+    class Iterator {
+    public:
+        bool valid() const { return ordinal_ < end_; }
+        uint32_t ordinal() const { return ordinal_; }
+        std::string_view term() const { return term_; }
+        void next();
+
+    private:
+        friend class TermDictionary;
+        void decode();
+
+        const TermDictionary* dict_ = nullptr;
+        const uint8_t* pos_ = nullptr;
+        uint32_t ordinal_ = 0;
+        uint32_t end_ = 0;
+        std::string term_;
+    };
+
+    // Iterates ordinals [first, last), last clamped to size()
+    Iterator iterate(uint32_t first, uint32_t last = kNotFound) const;
+
+private:
+    std::string_view blockFirstTerm(uint32_t block, const uint8_t** after) const;
+    // Ordinal of the first term >= key; sets exact when it equals key
+    uint32_t seek(std::string_view key, bool& exact) const;
+
+    uint32_t blockOffset(uint32_t block) const;
+
+    const uint8_t* payload_ = nullptr;
+    const uint8_t* block_offsets_ = nullptr;  // Read via memcpy; the image need not be aligned
+    uint32_t term_count_ = 0;
+    uint32_t block_count_ = 0;
+};
+
+} // namespace memory::search
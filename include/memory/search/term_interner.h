@@ -0,0 +1,19 @@
+#pragma once
+
+#include "memory/core/string_interner.h"
+#include "memory/search/tokenizer.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace memory::search {
+
+// Term strings <-> dense term IDs
+using TermInterner = core::StringInterner;
+
+// Tokenizes text and appends the interned ID of every token to ids, e.g. to
+// index a document or to turn query text into RecallQuery keyword IDs
+void internTokens(const Tokenizer& tokenizer, std::string_view text, TermInterner& interner,
+                  std::vector<uint32_t>& ids);
+
+} // namespace memory::search
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace memory::core {
+class Config;
+}
+
+namespace memory::search {
+
+// Longest token in bytes; longer runs (base64 blobs, hashes) are dropped
+inline constexpr size_t kMaxTokenBytes = 255;
+
+struct Token {
+    // Points into the input text, or into scratch space owned by the
+    // tokenize() call when the token had to be rewritten (lowercased or
+    // folded). Only valid for the duration of the sink callback.
+    std::string_view text;
+    // Ordinal of the token in the stream. Filtered stopwords still consume a
+    // position so phrase distances stay faithful to the input.
+    uint32_t position;
+};
+
+// Non-owning, non-allocating reference to a token callback
+class TokenSink {
+public:
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, TokenSink>>>
+    TokenSink(F&& fn)
+        : obj_(const_cast<void*>(static_cast<const void*>(&fn))),
+          call_([](void* obj, const Token& token) { (*static_cast<std::remove_reference_t<F>*>(obj))(token); }) {}
+
+    void operator()(const Token& token) const { call_(obj_, token); }
+
+private:
+    void* obj_;
+    void (*call_)(void*, const Token&);
+};
+
+// Pluggable tokenizer. Implementations must not allocate per token.
+class Tokenizer {
+public:
+    virtual ~Tokenizer() = default;
+    virtual void tokenize(std::string_view text, TokenSink sink) const = 0;
+};
+
+struct TokenizerOptions {
+    // Index runs of CJK characters as overlapping bigrams ("小明在" ->
+    // "小明", "明在"); otherwise every CJK character is its own token
+    bool cjk_bigrams = true;
+    bool filter_stopwords = true;
+    // Empty means the built-in English/Chinese list
+    std::vector<std::string> stopwords;
+
+    // Reads search.cjk_bigrams / filter_stopwords
+    static TokenizerOptions fromConfig(const core::Config& config);
+};
+
+// Default tokenizer, replacing the whitespace-only fallback of design doc
+// §3.3 when no external segmenter is configured:
+//   - splits on ASCII, Latin-1, general and CJK punctuation
+//   - lowercases ASCII and folds fullwidth letters/digits to ASCII
+//   - emits CJK (Han, kana, Hangul) runs as bigrams; a lone character
+//     becomes a unigram
+//   - drops stopwords and tokens longer than kMaxTokenBytes
+// Invalid UTF-8 bytes act as separators.
+class StandardTokenizer : public Tokenizer {
+public:
+    explicit StandardTokenizer(TokenizerOptions options = {});
+
+    void tokenize(std::string_view text, TokenSink sink) const override;
+
+    bool isStopword(std::string_view token) const;
+
+private:
+    struct TermHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    TokenizerOptions options_;
+    std::unordered_set<std::string, TermHash, std::equal_to<>> stopwords_;
+};
+
+} // namespace memory::search
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "memory/core/cpu_features.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace memory::vector {
+
+enum class Metric {
+    COSINE,  // Vectors are normalized on the way in; score is the cosine
+    DOT,     // Inner product; score is the dot product
+    L2       // Euclidean; score is the negated squared distance
+};
+
+std::string metricToString(Metric metric);
+// Throws std::invalid_argument for unknown names
+Metric stringToMetric(const std::string& str);
+
+// One implementation of the distance hot loops. All variants agree up to
+// float rounding; they differ only in the instruction set used. n is any
+// length, but multiples of kVectorAlignFloats avoid the scalar tail.
+struct DistanceKernels {
+    const char* name;
+    core::SimdLevel level;
+
+    float (*dot)(const float* a, const float* b, size_t n);
+    float (*l2_squared)(const float* a, const float* b, size_t n);
+
+    // Asymmetric kernels over 8-bit codes, see quantizer.h.
+    // sum q[i] * codes[i]
+    float (*dot_u8)(const float* q, const uint8_t* codes, size_t n);
+    // sum (q[i] - scale[i] * codes[i])^2
+    float (*l2_u8)(const float* q, const float* scale, const uint8_t* codes, size_t n);
+    // sum table[256 * i + codes[i]] over m codes
+    float (*lookup_sum)(const float* table, const uint8_t* codes, size_t m);
+};
+
+// Vectors are stored 64-byte aligned and zero-padded to a multiple of 16
+// floats, which leaves the distances unchanged and the kernels tail-free
+inline constexpr size_t kVectorAlignBytes = 64;
+inline constexpr size_t kVectorAlignFloats = kVectorAlignBytes / sizeof(float);
+
+inline size_t paddedDimension(size_t dimension) {
+    return (dimension + kVectorAlignFloats - 1) / kVectorAlignFloats * kVectorAlignFloats;
+}
+
+// Kernels for core::bestSimdLevel(), resolved once on first use
+const DistanceKernels& distanceKernels();
+// Kernels for a specific level, or nullptr if not compiled in or not
+// supported by the CPU. AVX2 also requires FMA.
+const DistanceKernels* distanceKernels(core::SimdLevel level);
+
+// Distance under metric where smaller is closer: 1 - dot for COSINE and
+// DOT, the squared distance for L2
+float metricDistance(const DistanceKernels& kernels, Metric metric, const float* a, const float* b, size_t n);
+// Caller-facing score, higher is closer
+float distanceToScore(Metric metric, float distance);
+
+} // namespace memory::vector
@@ -0,0 +1,361 @@
+#pragma once
+
+#include "memory/vector/distance.h"
+#include "memory/vector/quantizer.h"
+#include "memory/vector/vector_filter.h"
+#include "memory/core/compaction.h"
+#include "memory/core/section_file.h"
+#include "memory/core/string_interner.h"
+#include "memory/vector/vector_index.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace memory::core {
+class Config;
+class VersionSet;
+class WriteAheadLog;
+}
+
+namespace memory::vector {
+
+struct HnswOptions {
+    size_t dimension = 768;
+    Metric metric = Metric::COSINE;
+    // Links per node on the upper layers; layer 0 keeps up to 2m
+    size_t m = 16;
+    // Candidate list size while inserting and, by default, while searching
+    size_t ef_construction = 200;
+    size_t ef_search = 50;
+    uint64_t seed = 42;
+    // Codes the graph is searched over; SQ8 and PQ need train() before the
+    // first insert
+    Quantization quantization = Quantization::NONE;
+    // PQ bytes per vector; 0 picks one per 8 dimensions. Must divide the
+    // dimension padded to a multiple of kVectorAlignFloats.
+    size_t pq_subspaces = 0;
+    // With quantization, re-scores this many of the nearest candidates with
+    // the float vectors, which are then kept next to the codes. 0 keeps
+    // codes only.
+    size_t rerank = 0;
+
+    // Reads vector.dimension / hnsw_m / hnsw_ef_construction / hnsw_ef_search,
+    // vector.distance_metric / quantization / pq_subspaces / rerank_candidates
+    static HnswOptions fromConfig(const core::Config& config);
+};
+
+inline constexpr uint32_t kHnswSegmentMagic = core::makeMagic('H', 'N', 'S', 'W');
+// 2: deletions are stored as 64-bit version stamps
+inline constexpr uint16_t kHnswSegmentVersion = 3;
+
+struct HnswLoadOptions {
+    // Asks the kernel to read the upper layers, with the vectors and layer-0
+    // links of their nodes, right away: every search starts through them
+    bool prefetch_upper_layers = true;
+    // Checks the CRC of the whole file first, reading all of it
+    bool verify = false;
+    // Overrides the saved ef_search when nonzero
+    size_t ef_search = 0;
+};
+
+// Point-in-time view of an HnswIndex: the nodes whose insert was published
+// by version, less those deleted as of version. Nodes inserted later, or
+// still being inserted, may route a search through it but are never
+// returned.
+//
+// Only the result set is versioned. Neighbor lists are shared with inserts
+// and compact(), which rewrite them in place, so a search of a pinned
+// snapshot still takes the striped link locks and the entry-point lock
+// (plus the tenant and scratch-pool mutexes), and may route differently as
+// the graph changes.
+struct HnswSnapshot {
+    uint32_t nodes = 0;
+    uint64_t version = 0;
+};
+
+// How a filtered search went
+struct FilteredSearchStats {
+    double selectivity = 1.0;  // Estimated share of live vectors matching
+    bool scanned = false;      // Brute-force scan rather than graph search
+    size_t ef = 0;             // Matches a graph search collected
+};
+
+// Hierarchical navigable small world graph (Malkov & Yashunin) over
+// vectors kept in 64-byte-aligned blocks.
+//
+// Every node lives on layer 0 and, with probability 1/m per layer, on the
+// layers above it. A search descends greedily from the top layer's entry
+// point, then runs a best-first search with an ef-sized candidate list on
+// layer 0. Inserting runs the same search with ef_construction on every
+// layer of the new node and links it to the neighbors picked by the
+// diversity heuristic, pruning neighbor lists that overflow.
+//
+// Inserts and searches may run concurrently from any number of threads.
+// Storage grows in fixed blocks that never move; neighbor lists are guarded
+// by striped locks, and only an insert that raises the top layer holds the
+// entry-point lock throughout.
+//
+// Removal and replacement only tombstone the old node: it keeps routing
+// searches but is never returned, so removed vectors keep their memory
+// until the index is rebuilt. A tombstone is the version of the first
+// HnswSnapshot that no longer holds the node, so a search against an
+// older, pinned snapshot still returns it.
+//
+// As a compaction target, the index unlinks the tombstones that no held
+// snapshot can return any more: every node pointing at one re-selects its
+// neighbors from its remaining ones plus the tombstone's, so searches stop
+// detouring through dead nodes. Their storage is not reclaimed.
+//
+// Filtered searches test each vector's tenant, node type and time, given
+// at insert time, during the traversal itself: non-matching nodes still
+// route the search but never enter the ef-sized result list, so the search
+// keeps expanding until ef matches are in, effectively widening by 1 /
+// selectivity. Selectivity is estimated from a fixed-size sample; when the
+// widened walk would cost more than scoring every match, the search scans
+// the matching vectors with the SIMD kernels instead.
+//
+// With SQ8 or PQ the graph is searched over compact codes with asymmetric
+// distances (float query against codes, quantizer.h), 4x and 32x smaller
+// than the floats at the defaults. Recall drops with the coding error;
+// rerank buys most of it back by re-scoring the final candidates exactly,
+// at the price of keeping the floats as well. Those are touched only for
+// the few re-scored candidates and at insert time, so they suit colder
+// memory.
+//
+// save() writes the index as a section file whose columns are the block
+// arrays themselves, nodes renumbered by descending level so the upper
+// layers come first. open() maps it copy-on-write and points the blocks
+// into the mapping: startup costs a header check whatever the size, pages
+// fault in as searches reach them, and later inserts and removals dirty
+// private copies of the pages they touch without changing the file.
+//
+// With a write-ahead log attached, training, upserts and removals are
+// logged and return once their record is durable. An upsert is logged
+// where it replaces the id's previous node, so concurrent upserts of one
+// id replay in the order that decided the winner.
+
+class HnswIndex : public IVectorIndex, public core::ICompactable {
+public:
+    explicit HnswIndex(HnswOptions options = {});
+    ~HnswIndex() override;
+
+    // Maps an index written by save(). Throws StorageException if the file
+    // is missing, foreign or damaged.
+    static std::unique_ptr<HnswIndex> open(const std::string& path, HnswLoadOptions load = {});
+
+    HnswIndex(const HnswIndex&) = delete;
+    HnswIndex& operator=(const HnswIndex&) = delete;
+
+    // Fits the quantizer to samples, rows of options.dimension floats, e.g.
+    // a random subset of the vectors to come. Must precede the first
+    // insert; a no-op without quantization. Throws IndexException on a
+    // populated index or malformed samples. Not thread-safe.
+    void train(std::span<const float> samples);
+    bool trained() const { return !quantizer_ || quantizer_->trained(); }
+
+    // Throws IndexException if vec does not have the index dimension, for
+    // a zero vector under the cosine metric, or if the quantizer is not
+    // trained yet
+    void Upsert(core::NodeId id, std::span<const float> vec) override;
+    void Upsert(core::NodeId id, std::span<const float> vec, const VectorAttributes& attributes);
+    void Remove(core::NodeId id) override;
+    // Searches with ef = max(options.ef_search, topk)
+    std::vector<core::ScoredId> Search(std::span<const float> query, size_t topk) const override;
+    // Inserts are visible as soon as Upsert returns
+    void Flush() override {}
+    // Writes the index to path atomically. Searches may run meanwhile, but
+    // not inserts or removals. Throws StorageException.
+    void save(const std::string& path) const;
+    // Replays the VECTOR records of wal after after_lsn (the LSN the index
+    // was last saved at), then logs every later change to it. Call before
+    // any writes.
+    void attachWal(std::shared_ptr<core::WriteAheadLog> wal, uint64_t after_lsn = 0);
+
+    std::vector<core::ScoredId> Search(std::span<const float> query, size_t topk, size_t ef) const;
+    // Up to topk nearest vectors matching filter. ef 0 means
+    // options.ef_search.
+    std::vector<core::ScoredId> Search(std::span<const float> query, size_t topk, const VectorFilter& filter,
+                                       size_t ef = 0, FilteredSearchStats* stats = nullptr) const;
+    // Same, returning only vectors visible in a pinned snapshot
+    std::vector<core::ScoredId> Search(const HnswSnapshot& snapshot, std::span<const float> query, size_t topk,
+                                       const VectorFilter& filter = {}, size_t ef = 0,
+                                       FilteredSearchStats* stats = nullptr) const;
+
+    // Current consistent view; published by every upsert and removal
+    std::shared_ptr<const HnswSnapshot> snapshot() const { return snapshot_.load(); }
+    // Publishes the current and every later snapshot into versions
+    void attachVersions(std::shared_ptr<core::VersionSet> versions);
+
+    // Live vectors
+    size_t size() const;
+    // Graph nodes, tombstones included
+    size_t nodeCount() const { return count_.load(std::memory_order_acquire); }
+    int maxLevel() const;
+    const HnswOptions& options() const { return options_; }
+    const DistanceKernels& kernels() const { return kernels_; }
+    // nullptr without quantization
+    const Quantizer* quantizer() const { return quantizer_.get(); }
+    // Heap bytes; pages of an opened file are left to the page cache
+    size_t memoryBytes() const;
+    // Size of the file the index was opened from, 0 if built in memory
+    size_t mappedBytes() const { return segment_.fileBytes(); }
+
+    std::string compactionName() const override { return "vector"; }
+    // Share of the nodes that are tombstones still linked into the graph
+    double fragmentation() const override;
+    bool compactionDue(const core::CompactionOptions& options) const override;
+    core::CompactionResult compact(const core::CompactionOptions& options, core::RateLimiter& limiter) override;
+
+private:
+    struct Block;
+    struct Candidate {
+        float distance;
+        uint32_t node;
+
+        bool operator<(const Candidate& other) const { return distance < other.distance; }
+        bool operator>(const Candidate& other) const { return distance > other.distance; }
+    };
+    class VisitedList;
+    // A VectorFilter resolved against the stored attribute columns
+    struct Predicate {
+        bool any_tenant;
+        uint32_t tenant;
+        NodeTypeMask types;  // kAllNodeTypes skips the test
+        int64_t since;       // Milliseconds, [since, until)
+        int64_t until;
+    };
+    // A search target: compared exactly against the float vectors, or
+    // through the quantizer's table against the codes
+    struct Query {
+        const float* vector;  // Prepared, padded_ floats
+        bool exact;
+        QueryTable table;
+    };
+
+    static constexpr uint32_t kBlockBits = 12;
+    static constexpr uint32_t kBlockNodes = 1u << kBlockBits;
+    static constexpr uint32_t kMaxBlocks = 1u << 16;
+    static constexpr uint32_t kLockStripes = 4096;
+
+    // Carves the columns of a kBlockNodes-row block out of base; with base
+    // null only sums up the bytes
+    size_t layoutBlock(Block& b, std::byte* base) const;
+    Block& block(uint32_t node) const;
+    // Only if keep_vectors_
+    const float* vectorOf(uint32_t node) const;
+    // Only with quantization
+    const uint8_t* codeOf(uint32_t node) const;
+    uint32_t* links(uint32_t node, int layer) const;
+    int levelOf(uint32_t node) const;
+    // Deleted in the latest version
+    bool deleted(uint32_t node) const;
+    // Insert published, in some version
+    bool created(uint32_t node) const;
+    bool visible(const HnswSnapshot& snapshot, uint32_t node) const;
+    void markDeleted(uint32_t node, uint64_t version) const;
+    // Requires labels_mutex_: publishes count_ and the next version
+    void publishLocked();
+    // Oldest version a held snapshot may still search
+    uint64_t oldestHeldVersion();
+    std::vector<core::ScoredId> searchAll(const HnswSnapshot& snapshot, std::span<const float> query, size_t topk,
+                                          size_t ef) const;
+    bool matches(const Predicate& predicate, uint32_t node) const;
+    // Share of a sample of live nodes matching predicate
+    double estimateSelectivity(const Predicate& predicate) const;
+    core::NodeId labelOf(uint32_t node) const;
+    // Requires labels_mutex_
+    void loadLabelsLocked();
+    std::mutex& linkLock(uint32_t node) const { return link_locks_[node % kLockStripes]; }
+
+    float distance(const float* a, const float* b) const {
+        return metricDistance(kernels_, options_.metric, a, b, padded_);
+    }
+    // Copies query into the padded layout, normalized for COSINE; false
+    // for a zero vector under COSINE
+    bool prepare(std::span<const float> query, float* out) const;
+    void makeQuery(const float* prepared, bool exact, Query& query) const;
+    float distance(const Query& query, uint32_t node) const {
+        return query.exact ? distance(query.vector, vectorOf(node)) : quantizer_->distance(query.table, codeOf(node));
+    }
+    // The float vector of node, or if only its code is kept, the decoded
+    // code in scratch (padded_ floats)
+    const float* fullVector(uint32_t node, float* scratch) const;
+
+    uint32_t allocate();
+    int randomLevel();
+    // Copies node's neighbors on layer into out, returns the count
+    size_t readLinks(uint32_t node, int layer, std::vector<uint32_t>& out) const;
+    void greedySearch(const Query& query, uint32_t& current, float& current_distance, int layer) const;
+    // Best-first search on one layer; out is sorted nearest first and
+    // holds only nodes accept() takes, though all of them route
+    template <typename Accept>
+    void searchLayer(const Query& query, uint32_t entry, float entry_distance, size_t ef, int layer,
+                     const Accept& accept, std::vector<Candidate>& out) const;
+    // Entry point on layer 0 for query; false if the index is empty
+    bool descend(const Query& query, uint32_t& entry, float& entry_distance) const;
+    // Re-ranks (if configured) and turns the nearest candidates into up to
+    // topk results, one per id
+    std::vector<core::ScoredId> finish(std::vector<Candidate>& nearest, const float* prepared, size_t topk) const;
+    // Diversity heuristic: keeps a candidate only if it is closer to the
+    // base than to every candidate already kept. sorted is nearest first.
+    void selectNeighbors(std::vector<Candidate>& sorted, size_t limit) const;
+    void link(uint32_t node, uint32_t neighbor, float distance, int layer);
+
+    std::unique_ptr<VisitedList> acquireVisited() const;
+    void releaseVisited(std::unique_ptr<VisitedList> visited) const;
+
+    HnswOptions options_;
+    const DistanceKernels& kernels_;
+    size_t padded_;      // Floats per stored vector
+    size_t max_links0_;  // Neighbor capacity on layer 0
+    std::unique_ptr<Quantizer> quantizer_;
+    size_t code_size_ = 0;
+    bool keep_vectors_;  // No quantization, or rerank
+    double level_mult_;
+    std::shared_ptr<core::WriteAheadLog> wal_;
+
+    std::unique_ptr<std::atomic<Block*>[]> blocks_;
+    std::atomic<uint32_t> count_{0};
+    std::mutex grow_mutex_;
+    std::unique_ptr<std::mutex[]> link_locks_;
+
+    mutable std::mutex entry_mutex_;  // Guards entry_point_ and max_level_
+    uint32_t entry_point_ = 0;
+    int max_level_ = -1;
+
+    mutable std::mutex labels_mutex_;
+    std::unordered_map<core::NodeId, uint32_t> labels_;  // Live id -> node
+    // An opened index fills labels_ from the mapped columns on first use
+    bool labels_loaded_ = true;
+    size_t mapped_live_ = 0;  // Live vectors in the file
+    uint64_t version_ = 1;  // Of the last published snapshot
+    std::shared_ptr<core::VersionSet> versions_;
+    std::atomic<std::shared_ptr<const HnswSnapshot>> snapshot_;
+    // Snapshots handed out, oldest first; expired ones are swept lazily
+    std::deque<std::weak_ptr<const HnswSnapshot>> published_;
+    size_t sweep_published_at_ = 64;
+
+    std::mutex compaction_mutex_;
+    std::vector<uint8_t> unlinked_;  // Tombstones compaction took out of the graph
+    std::atomic<size_t> unlinked_count_{0};
+
+    mutable std::mutex tenants_mutex_;
+    core::StringInterner tenants_;
+
+    std::mutex rng_mutex_;
+    std::mt19937_64 rng_;
+
+    mutable std::mutex visited_mutex_;
+    mutable std::vector<std::unique_ptr<VisitedList>> visited_free_;
+
+    core::SectionFile segment_;  // Backs the blocks of an opened index
+};
+
+} // namespace memory::vector
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "memory/vector/distance.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory::vector {
+
+enum class Quantization {
+    NONE,  // 4 bytes per dimension
+    SQ8,   // 1 byte per dimension
+    PQ     // 1 byte per subspace
+};
+
+std::string quantizationToString(Quantization quantization);
+// Throws std::invalid_argument for unknown names
+Quantization stringToQuantization(const std::string& str);
+
+// Query-side precomputation for asymmetric distances: the query stays in
+// float and is compared against codes without decoding them
+struct QueryTable {
+    std::vector<float> values;
+    float bias = 0.0f;
+};
+
+// Lossy fixed-size vector codes. Distances follow metricDistance(): smaller
+// is closer, 1 - dot for COSINE and DOT, the squared distance for L2.
+// Vectors are in the padded layout of distance.h. Train once, before
+// encoding; afterwards all methods are const and thread-safe.
+class Quantizer {
+public:
+    virtual ~Quantizer() = default;
+
+    // samples holds rows of dimension floats
+    virtual void train(std::span<const float> samples, size_t dimension) = 0;
+    virtual bool trained() const = 0;
+    // Bytes per code
+    virtual size_t codeSize() const = 0;
+    virtual void encode(const float* vec, uint8_t* code) const = 0;
+    // Approximate reconstruction, dimension floats
+    virtual void decode(const uint8_t* code, float* out) const = 0;
+    virtual void prepareQuery(const float* query, QueryTable& table) const = 0;
+    virtual float distance(const QueryTable& table, const uint8_t* code) const = 0;
+    virtual size_t memoryBytes() const = 0;
+
+    // Trained parameters, for persisting next to the codes
+    virtual std::vector<float> state() const = 0;
+    // Takes back state() of a quantizer trained on vectors of dimension
+    // floats. Throws IndexException if it does not fit.
+    virtual void restore(std::span<const float> state, size_t dimension) = 0;
+};
+
+// === SQ8 ===
+//
+// Maps each dimension affinely onto 0..255 over the range seen in
+// training, x ~ min[i] + scale[i] * code[i], so a code is a quarter of the
+// float vector. Values outside the trained range are clamped.
+class ScalarQuantizer : public Quantizer {
+public:
+    ScalarQuantizer(Metric metric, const DistanceKernels& kernels) : metric_(metric), kernels_(kernels) {}
+
+    void train(std::span<const float> samples, size_t dimension) override;
+    bool trained() const override { return !scale_.empty(); }
+    size_t codeSize() const override { return scale_.size(); }
+    void encode(const float* vec, uint8_t* code) const override;
+    void decode(const uint8_t* code, float* out) const override;
+    void prepareQuery(const float* query, QueryTable& table) const override;
+    float distance(const QueryTable& table, const uint8_t* code) const override;
+    size_t memoryBytes() const override { return (min_.capacity() + scale_.capacity()) * sizeof(float); }
+    // min, then scale
+    std::vector<float> state() const override;
+    void restore(std::span<const float> state, size_t dimension) override;
+
+private:
+    Metric metric_;
+    const DistanceKernels& kernels_;
+    std::vector<float> min_;
+    std::vector<float> scale_;
+};
+
+struct ProductQuantizerOptions {
+    // Subspaces, each encoded as one byte; must divide the dimension
+    size_t subspaces = 96;
+    // k-means rounds per subspace
+    size_t iterations = 15;
+    // Training uses a random subset of at most this many samples; 40 per
+    // centroid is plenty for k-means
+    size_t max_samples = 40 * 256;
+    uint64_t seed = 42;
+};
+
+// === PQ ===
+//
+// Splits the dimensions into equal subspaces and replaces each slice by the
+// nearest of 256 k-means centroids learned for that subspace. A query
+// precomputes its distance to every centroid once (subspaces x 256 floats),
+// after which each code costs one table lookup per subspace.
+class ProductQuantizer : public Quantizer {
+public:
+    static constexpr size_t kCentroids = 256;
+
+    ProductQuantizer(Metric metric, const DistanceKernels& kernels, ProductQuantizerOptions options = {})
+        : metric_(metric), kernels_(kernels), options_(options) {}
+
+    // Throws IndexException if subspaces does not divide dimension. Fewer
+    // than 256 samples leave some centroids as duplicates.
+    void train(std::span<const float> samples, size_t dimension) override;
+    bool trained() const override { return !centroids_.empty(); }
+    size_t codeSize() const override { return options_.subspaces; }
+    void encode(const float* vec, uint8_t* code) const override;
+    void decode(const uint8_t* code, float* out) const override;
+    void prepareQuery(const float* query, QueryTable& table) const override;
+    float distance(const QueryTable& table, const uint8_t* code) const override;
+    size_t memoryBytes() const override { return (centroids_.capacity() + columns_.capacity()) * sizeof(float); }
+    // The centroids
+    std::vector<float> state() const override { return centroids_; }
+    void restore(std::span<const float> state, size_t dimension) override;
+
+private:
+    // Centroid c of subspace s
+    const float* centroid(size_t s, size_t c) const {
+        return centroids_.data() + (s * kCentroids + c) * sub_dimension_;
+    }
+    // Index of the centroid of subspace s nearest to slice, the slice's
+    // sub_dimension floats
+    uint8_t nearest(size_t s, const float* slice) const;
+
+    Metric metric_;
+    const DistanceKernels& kernels_;
+    ProductQuantizerOptions options_;
+    size_t sub_dimension_ = 0;
+    std::vector<float> centroids_;  // subspaces x 256 x sub_dimension
+    // The same centroids as subspaces x sub_dimension x 256, so scoring a
+    // slice against all 256 runs down contiguous columns
+    std::vector<float> columns_;
+};
+
+// nullptr for Quantization::NONE
+std::unique_ptr<Quantizer> makeQuantizer(Quantization quantization, Metric metric, const DistanceKernels& kernels,
+                                         ProductQuantizerOptions pq = {});
+
+} // namespace memory::vector
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "memory/core/types.h"
+#include <cstdint>
+#include <optional>
+
+namespace memory::vector {
+
+// Set of core::NodeType values, one bit per type
+using NodeTypeMask = uint8_t;
+
+inline constexpr NodeTypeMask nodeTypeBit(core::NodeType type) {
+    return static_cast<NodeTypeMask>(1u << static_cast<unsigned>(type));
+}
+
+inline constexpr NodeTypeMask kAllNodeTypes = static_cast<NodeTypeMask>((1u << 7) - 1);
+static_assert(nodeTypeBit(core::NodeType::META) < (1u << 7), "kAllNodeTypes misses a NodeType");
+
+// What a filtered search can test about a vector, given at insert time
+struct VectorAttributes {
+    core::TenantId tenant;
+    // Vectors inserted without a type match only unrestricted type masks
+    std::optional<core::NodeType> type;
+    core::Timestamp time{};
+};
+
+// Conjunction of tenant, node types and time window; default-constructed
+// it matches everything
+struct VectorFilter {
+    std::optional<core::TenantId> tenant;
+    NodeTypeMask types = kAllNodeTypes;
+    // [since, until)
+    std::optional<core::Timestamp> since;
+    std::optional<core::Timestamp> until;
+
+    bool empty() const { return !tenant && types == kAllNodeTypes && !since && !until; }
+};
+
+} // namespace memory::vector
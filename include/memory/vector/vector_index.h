@@ -0,0 +1,24 @@
+#pragma once
+
+#include "memory/core/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace memory::vector {
+
+// Vector index interface (design doc §9.2)
+class IVectorIndex {
+public:
+    virtual ~IVectorIndex() = default;
+
+    // Adds the vector of id, replacing any earlier one
+    virtual void Upsert(core::NodeId id, std::span<const float> vec) = 0;
+    virtual void Remove(core::NodeId id) = 0;
+    // Up to topk nearest ids, best first; higher scores are closer
+    virtual std::vector<core::ScoredId> Search(std::span<const float> query, size_t topk) const = 0;
+    virtual void Flush() = 0;
+};
+
+} // namespace memory::vector
@@ -1,10 +1,138 @@
 #include "memory/cli/commands.h"
 #include "memory/core/logger.h"
 #include "memory/core/config.h"
+#include "memory/graph/csr_graph_store.h"
+#include "memory/pipeline/recall_pipeline.h"
+#include "memory/search/inverted_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
 
 namespace memory::cli {
 
+namespace {
+
+// 图剪枝前后对比的统计量
+struct GraphPruneStats {
+    double avg_degree = 0;       // 出度+入度的平均值
+    uint32_t max_degree = 0;
+    double similar_avg_degree = 0;
+    double khop_ms = 0;          // 单种子 k-hop 平均耗时
+    double khop_nodes = 0;       // 单种子 k-hop 平均可达节点数
+};
+
+GraphPruneStats measureGraph(const memory::graph::CsrGraphStore& store, const std::vector<core::NodeId>& seeds,
+                             int k) {
+    using memory::graph::Direction;
+    GraphPruneStats stats;
+    auto snap = store.snapshot();
+    std::vector<memory::graph::PackedEdge> scratch;
+    uint64_t similar = 0;
+    for (uint32_t node = 0; node < snap->nodeCount(); ++node) {
+        uint32_t degree = 0;
+        for (Direction direction : {Direction::OUT, Direction::IN}) {
+            auto edges = snap->edges(node, direction, scratch);
+            degree += static_cast<uint32_t>(edges.size());
+            similar += static_cast<uint64_t>(std::count_if(edges.begin(), edges.end(), [](const auto& e) {
+                return e.edgeType() == core::EdgeType::SIMILAR_TO;
+            }));
+        }
+        stats.max_degree = std::max(stats.max_degree, degree);
+    }
+    if (snap->nodeCount() > 0) {
+        stats.avg_degree = 2.0 * static_cast<double>(snap->edgeCount()) / snap->nodeCount();
+        stats.similar_avg_degree = static_cast<double>(similar) / snap->nodeCount();
+    }
+
+    uint64_t reached = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (core::NodeId seed : seeds) {
+        reached += store.KHopSeeds(std::span<const core::NodeId>(&seed, 1), k).size();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!seeds.empty()) {
+        stats.khop_ms = elapsed / static_cast<double>(seeds.size());
+        stats.khop_nodes = static_cast<double>(reached) / static_cast<double>(seeds.size());
+    }
+    return stats;
+}
+
+// 合成记忆图：情节按时间串联，以幂律分布连向概念/实体，少量情节互为 SIMILAR_TO
+void addSyntheticGraph(memory::graph::CsrGraphStore& store, size_t nodes) {
+    std::mt19937_64 rng(7);
+    size_t hubs = std::max<size_t>(1, nodes / 20);
+    core::Edge e{};
+    for (core::NodeId n = hubs; n < nodes; ++n) {
+        e.src = n;
+        if (n + 1 < nodes && rng() % 4 != 0) {
+            e.dst = n + 1;
+            e.type = core::EdgeType::TEMPORAL_NEXT;
+            e.weight = 0.3f;
+            store.AddEdge(e);
+        }
+        for (int i = 0; i < 2; ++i) {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            e.dst = static_cast<core::NodeId>(std::pow(u, 3.0) * static_cast<double>(hubs));
+            e.type = rng() % 3 == 0 ? core::EdgeType::MENTIONS : core::EdgeType::ABOUT;
+            e.weight = 0.5f + 0.5f * std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+            store.AddEdge(e);
+        }
+        if (rng() % 10 == 0) {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            e.dst = hubs + static_cast<core::NodeId>(u * u * static_cast<double>(nodes - hubs));
+            e.type = core::EdgeType::SIMILAR_TO;
+            e.weight = 0.75f + 0.25f * std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+            store.AddEdge(e);
+        }
+    }
+}
+
+// 边表文件：每行 "src dst [type] [weight] [day]"，type 默认 ABOUT，day 为 2020-01-01 起的天数
+bool addEdgeFile(memory::graph::CsrGraphStore& store, const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "无法打开边表文件: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        core::Edge e{};
+        std::string type = "ABOUT";
+        int day = memory::graph::edgeDay();
+        if (!(fields >> e.src >> e.dst)) {
+            std::cerr << "边表第 " << line_no << " 行格式错误: " << line << std::endl;
+            return false;
+        }
+        fields >> type >> e.weight >> day;
+        try {
+            e.type = core::stringToEdgeType(type);
+        } catch (const std::invalid_argument&) {
+            std::cerr << "边表第 " << line_no << " 行未知边类型: " << type << std::endl;
+            return false;
+        }
+        store.AddEdge(e, static_cast<uint16_t>(std::clamp(day, 0, 65535)));
+    }
+    return true;
+}
+
+std::string dropPercent(double before, double after) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << (before > 0 ? 100.0 * (before - after) / before : 0.0) << "%";
+    return out.str();
+}
+
+} // namespace
+
 int Commands::execute(const CommandArgs& args) {
     if (args.command.empty() || args.command == "help" || args.command == "--help" || args.command == "-h") {
         CliParser parser;
@@ -64,6 +192,80 @@ int Commands::executeIndex(const CommandArgs& args) {
     }
 
     LOG_INFO("索引操作: " + args.subcommand);
+
+    if (args.subcommand == "search" && !args.arguments.empty()) {
+        auto corpus_it = args.options.find("corpus");
+        if (corpus_it == args.options.end()) {
+            std::cerr << "缺少参数: --corpus <file>" << std::endl;
+            return 1;
+        }
+        std::ifstream corpus(corpus_it->second);
+        if (!corpus.is_open()) {
+            std::cerr << "无法打开语料文件: " << corpus_it->second << std::endl;
+            return 1;
+        }
+
+        auto& config = memory::core::Config::getInstance();
+        memory::search::InvertedIndex index(memory::search::SearchIndexOptions::fromConfig(config));
+
+        // 每个非空行作为一个文档，行号作为文档ID
+        std::vector<std::string> lines;
+        std::string line;
+        auto build_start = std::chrono::steady_clock::now();
+        while (std::getline(corpus, line)) {
+            if (!line.empty()) {
+                index.Upsert(lines.size(), line);
+            }
+            lines.push_back(line);
+        }
+        index.Flush();
+        auto build_end = std::chrono::steady_clock::now();
+
+        size_t topk = 10;
+        if (auto it = args.options.find("topk"); it != args.options.end()) {
+            topk = static_cast<size_t>(std::stoul(it->second));
+        }
+
+        auto evaluation = memory::search::SearchIndexOptions::fromConfig(config).evaluation;
+        if (auto it = args.options.find("evaluation"); it != args.options.end()) {
+            evaluation = memory::search::stringToQueryEvaluation(it->second);
+        }
+
+        auto search_start = std::chrono::steady_clock::now();
+        auto results = index.Search(args.arguments[0], topk, evaluation);
+        auto search_end = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::cout << "[" << (i + 1) << "] doc=" << results[i].id
+                      << " score=" << results[i].score
+                      << "  " << lines[results[i].id] << std::endl;
+        }
+        std::cout << "索引文档数: " << index.docCount()
+                  << ", 段数: " << index.segmentCount()
+                  << ", 建索引耗时: "
+                  << std::chrono::duration<double, std::milli>(build_end - build_start).count() << " ms"
+                  << ", 查询耗时: "
+                  << std::chrono::duration<double, std::milli>(search_end - search_start).count() << " ms"
+                  << std::endl;
+
+        if (args.options.count("validate")) {
+            // 以穷举打分为基准校验剪枝结果
+            auto exact_start = std::chrono::steady_clock::now();
+            auto exact = index.Search(args.arguments[0], topk, memory::search::QueryEvaluation::EXHAUSTIVE);
+            auto exact_end = std::chrono::steady_clock::now();
+
+            bool same = exact.size() == results.size();
+            for (size_t i = 0; same && i < exact.size(); ++i) {
+                same = exact[i].id == results[i].id && exact[i].score == results[i].score;
+            }
+            std::cout << "穷举打分耗时: "
+                      << std::chrono::duration<double, std::milli>(exact_end - exact_start).count() << " ms"
+                      << ", 结果一致: " << (same ? "是" : "否") << std::endl;
+            return same ? 0 : 1;
+        }
+        return 0;
+    }
+
     std::cout << "索引功能正在开发中..." << std::endl;
     return 0;
 }
@@ -75,6 +277,77 @@ int Commands::executeGraph(const CommandArgs& args) {
     }
 
     LOG_INFO("图操作: " + args.subcommand);
+
+    if (args.subcommand == "prune") {
+        auto& config = memory::core::Config::getInstance();
+        auto options = memory::graph::GraphStoreOptions::fromConfig(config);
+        memory::graph::DegreeCaps caps = options.caps;
+        if (auto it = args.options.find("cap"); it != args.options.end()) {
+            caps.max_degree.fill(static_cast<uint32_t>(std::stoul(it->second)));
+        }
+        if (auto it = args.options.find("similar-cap"); it != args.options.end()) {
+            caps.max_degree[static_cast<size_t>(core::EdgeType::SIMILAR_TO)] =
+                static_cast<uint32_t>(std::stoul(it->second));
+        }
+        int k = 2;
+        if (auto it = args.options.find("k"); it != args.options.end()) {
+            k = std::stoi(it->second);
+        }
+        size_t queries = 200;
+        if (auto it = args.options.find("queries"); it != args.options.end()) {
+            queries = static_cast<size_t>(std::stoul(it->second));
+        }
+
+        // 先以不设上限的完整图（L0）为基线
+        options.caps = memory::graph::DegreeCaps::unlimited();
+        options.background_merge = false;
+        memory::graph::CsrGraphStore store(options);
+        if (auto it = args.options.find("edges"); it != args.options.end()) {
+            if (!addEdgeFile(store, it->second)) return 1;
+        } else {
+            size_t nodes = 100000;
+            if (auto syn = args.options.find("synthetic"); syn != args.options.end()) {
+                nodes = static_cast<size_t>(std::stoul(syn->second));
+            }
+            addSyntheticGraph(store, std::max<size_t>(nodes, 2));
+        }
+        store.Compact();
+        if (store.nodeCount() == 0) {
+            std::cerr << "图为空" << std::endl;
+            return 1;
+        }
+
+        std::mt19937_64 rng(13);
+        std::vector<core::NodeId> seeds;
+        auto snap = store.snapshot();
+        for (size_t i = 0; i < queries; ++i) {
+            seeds.push_back(snap->nodeId(static_cast<uint32_t>(rng() % snap->nodeCount())));
+        }
+        snap.reset();
+
+        GraphPruneStats before = measureGraph(store, seeds, k);
+        uint64_t edges_before = store.edgeCount();
+        auto prune_start = std::chrono::steady_clock::now();
+        store.SetDegreeCaps(caps);
+        auto prune_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - prune_start).count();
+        GraphPruneStats after = measureGraph(store, seeds, k);
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "节点数: " << store.nodeCount() << ", 边数: " << edges_before << " -> " << store.edgeCount()
+                  << " (冷边 " << store.coldEdgeCount() << "), 剪枝耗时: " << prune_ms << " ms" << std::endl;
+        std::cout << "avg_degree: " << before.avg_degree << " -> " << after.avg_degree << " (下降 "
+                  << dropPercent(before.avg_degree, after.avg_degree) << ")" << std::endl;
+        std::cout << "avg_degree(SIMILAR_TO): " << before.similar_avg_degree << " -> " << after.similar_avg_degree
+                  << " (下降 " << dropPercent(before.similar_avg_degree, after.similar_avg_degree) << ")"
+                  << std::endl;
+        std::cout << "max_degree: " << before.max_degree << " -> " << after.max_degree << std::endl;
+        std::cout << k << "-hop 平均耗时: " << before.khop_ms << " ms -> " << after.khop_ms << " ms (下降 "
+                  << dropPercent(before.khop_ms, after.khop_ms) << "), 平均可达节点: " << before.khop_nodes
+                  << " -> " << after.khop_nodes << std::endl;
+        return 0;
+    }
+
     std::cout << "图数据库功能正在开发中..." << std::endl;
     return 0;
 }
@@ -86,7 +359,75 @@ int Commands::executeRecall(const CommandArgs& args) {
     }
 
     LOG_INFO("召回操作");
-    std::cout << "记忆召回功能正在开发中..." << std::endl;
+
+    auto query_it = args.options.find("query");
+    auto corpus_it = args.options.find("corpus");
+    if (query_it == args.options.end() || corpus_it == args.options.end()) {
+        std::cerr << "缺少参数: --query <text> --corpus <file>" << std::endl;
+        return 1;
+    }
+    std::ifstream corpus(corpus_it->second);
+    if (!corpus.is_open()) {
+        std::cerr << "无法打开语料文件: " << corpus_it->second << std::endl;
+        return 1;
+    }
+
+    auto& config = memory::core::Config::getInstance();
+    // 每个非空行作为一个节点，行号作为节点ID
+    auto index =
+        std::make_shared<memory::search::InvertedIndex>(memory::search::SearchIndexOptions::fromConfig(config));
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(corpus, line)) {
+        if (!line.empty()) {
+            index->Upsert(lines.size(), line);
+        }
+        lines.push_back(line);
+    }
+    index->Flush();
+
+    memory::pipeline::RecallSources sources;
+    sources.search = index;
+    if (auto it = args.options.find("edges"); it != args.options.end()) {
+        auto store = std::make_shared<memory::graph::CsrGraphStore>(
+            memory::graph::GraphStoreOptions::fromConfig(config));
+        if (!addEdgeFile(*store, it->second)) return 1;
+        store->Flush();
+        sources.graph = store;
+    }
+
+    auto options = memory::pipeline::RecallPipelineOptions::fromConfig(config);
+    if (auto it = args.options.find("topk"); it != args.options.end()) {
+        options.topk = static_cast<size_t>(std::stoul(it->second));
+    }
+    memory::pipeline::RecallPipeline pipeline(options, sources);
+
+    core::RecallQuery query;
+    query.text = query_it->second;
+    query.k_hop = options.max_k_hop;
+    if (auto it = args.options.find("k-hop"); it != args.options.end()) {
+        query.k_hop = std::stoi(it->second);
+    }
+    memory::pipeline::RecallTrace trace;
+    auto results = pipeline.Run(query, &trace);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::cout << "[" << (i + 1) << "] node=" << results[i].id << " score=" << results[i].score;
+        if (results[i].id < lines.size()) std::cout << "  " << lines[results[i].id];
+        std::cout << std::endl;
+    }
+    if (args.options.count("trace") || config.get<bool>("trace_enabled", false)) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "路径: " << trace.path << (trace.degraded ? " (已降级)" : "") << ", 总耗时: " << trace.millis
+                  << " ms" << std::endl;
+        for (auto [name, stage] : {std::pair{"A bm25  ", &trace.bm25}, std::pair{"B vector", &trace.vector},
+                                   std::pair{"C graph ", &trace.graph}}) {
+            std::cout << "  " << name << "  " << memory::pipeline::stageStatusToString(stage->status)
+                      << "  命中 " << stage->hits << "  " << stage->millis << " ms";
+            if (!stage->detail.empty()) std::cout << "  " << stage->detail;
+            std::cout << std::endl;
+        }
+    }
     return 0;
 }
 
@@ -117,6 +458,11 @@ void Commands::printIndexHelp() {
     std::cout << "  add <file>           添加文档到索引\n";
     std::cout << "  search <query>       搜索文档\n";
     std::cout << "  rebuild              重建索引\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --corpus <file>      语料文件（每行一个文档）\n";
+    std::cout << "  --topk <number>      返回结果数（默认10）\n";
+    std::cout << "  --evaluation <mode>  block_max_wand | exhaustive\n";
+    std::cout << "  --validate           与穷举打分对比结果与耗时\n\n";
 }
 
 void Commands::printGraphHelp() {
@@ -126,7 +472,15 @@ void Commands::printGraphHelp() {
     std::cout << "  add-node <type>      添加节点\n";
     std::cout << "  add-edge <src> <dst> 添加边\n";
     std::cout << "  query <id>           查询节点信息\n";
-    std::cout << "  neighbors <id>       查询邻居节点\n\n";
+    std::cout << "  neighbors <id>       查询邻居节点\n";
+    std::cout << "  prune                按边类型度上限剪枝，对比剪枝前后的平均度与 k-hop 耗时\n\n";
+    std::cout << "Options (prune):\n";
+    std::cout << "  --cap <number>       所有边类型的度上限（默认取 graph.max_degree_per_type）\n";
+    std::cout << "  --similar-cap <n>    SIMILAR_TO 的度上限（默认取 graph.similar_to_max_degree）\n";
+    std::cout << "  --edges <file>       边表文件，每行 \"src dst [type] [weight] [day]\"\n";
+    std::cout << "  --synthetic <nodes>  无边表时生成的合成图节点数（默认100000）\n";
+    std::cout << "  --k <number>         k-hop 跳数（默认2）\n";
+    std::cout << "  --queries <number>   k-hop 测量的随机种子数（默认200）\n\n";
 }
 
 void Commands::printRecallHelp() {
@@ -134,9 +488,12 @@ void Commands::printRecallHelp() {
     std::cout << "Usage: memctl recall [options]\n\n";
     std::cout << "Options:\n";
     std::cout << "  --query <text>       查询文本\n";
+    std::cout << "  --corpus <file>      语料文件（每行一个节点，行号为节点ID）\n";
+    std::cout << "  --edges <file>       边表文件，每行 \"src dst [type] [weight] [day]\"（无则跳过图扩散）\n";
     std::cout << "  --budget <tokens>    Token预算\n";
-    std::cout << "  --k-hop <number>     图扩散跳数\n";
-    std::cout << "  --trace              显示执行追踪\n\n";
+    std::cout << "  --k-hop <number>     图扩散跳数（默认取 recall.max_k_hop）\n";
+    std::cout << "  --topk <number>      返回结果数（默认取 recall.recall_topk）\n";
+    std::cout << "  --trace              显示各阶段状态、耗时与降级路径\n\n";
 }
 
 void Commands::printMetricsHelp() {
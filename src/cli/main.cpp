@@ -2,6 +2,7 @@
 #include "memory/cli/commands.h"
 #include "memory/core/logger.h"
 #include "memory/core/config.h"
+#include <filesystem>
 #include <iostream>
 #ifdef _WIN32
 #include <windows.h>
@@ -23,6 +24,14 @@ int main(int argc, char* argv[]) {
         memory::cli::CliParser parser;
         auto args = parser.parse(argc, argv);
 
+        // Load configuration: explicit --config, otherwise ./config.yaml if present
+        auto& config = memory::core::Config::getInstance();
+        if (auto it = args.options.find("config"); it != args.options.end()) {
+            config.loadFromFile(it->second);
+        } else if (std::filesystem::exists("config.yaml")) {
+            config.loadFromFile("config.yaml");
+        }
+
         // Execute command
         return memory::cli::Commands::execute(args);
 
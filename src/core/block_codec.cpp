@@ -0,0 +1,187 @@
+#include "memory/core/block_codec.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace memory::core {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+// The format ends every block with at least 5 literals, and no match
+// starts in the last 12 bytes
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchSearchEnd = 12;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashBits = 13;
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hashOf(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Length beyond the 15 that fit into the token: runs of 255 and a remainder
+void putLength(uint8_t*& op, size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = static_cast<uint8_t>(length);
+}
+
+// match_length 0 writes the last sequence, which has literals only
+void putSequence(uint8_t*& op, const uint8_t* literals, size_t literal_count, size_t offset, size_t match_length) {
+    size_t match_code = match_length ? match_length - kMinMatch : 0;
+    *op++ = static_cast<uint8_t>((std::min<size_t>(literal_count, 15) << 4) | std::min<size_t>(match_code, 15));
+    if (literal_count >= 15) putLength(op, literal_count - 15);
+    std::memcpy(op, literals, literal_count);
+    op += literal_count;
+    if (match_length == 0) return;
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    if (match_code >= 15) putLength(op, match_code - 15);
+}
+
+// Bytes from ip and ref on that are equal, up to limit
+inline size_t commonLength(const uint8_t* ip, const uint8_t* ref, size_t length, size_t limit) {
+    while (length + sizeof(uint64_t) <= limit) {
+        uint64_t diff = read64(ip + length) ^ read64(ref + length);
+        if (diff) return length + static_cast<size_t>(std::countr_zero(diff)) / 8;  // Little-endian
+        length += sizeof(uint64_t);
+    }
+    while (length < limit && ip[length] == ref[length]) ++length;
+    return length;
+}
+
+[[noreturn]] void malformed(const char* what) {
+    throw StorageException(std::string("Malformed LZ block: ") + what);
+}
+
+} // namespace
+
+std::string blockCodecToString(BlockCodec codec) {
+    switch (codec) {
+        case BlockCodec::NONE: return "none";
+        case BlockCodec::LZ: return "lz";
+        default: return "unknown";
+    }
+}
+
+BlockCodec stringToBlockCodec(const std::string& name) {
+    if (name == "none") return BlockCodec::NONE;
+    if (name == "lz") return BlockCodec::LZ;
+    throw std::invalid_argument("Unknown block codec: " + name);
+}
+
+size_t lzCompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lzCompress(std::span<const uint8_t> input, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.resize(start + lzCompressBound(input.size()));
+    uint8_t* op = out.data() + start;
+    const uint8_t* base = input.data();
+    size_t size = input.size();
+    size_t anchor = 0;
+    if (size > kMatchSearchEnd) {
+        // Last position + 1 seen with each hash of four bytes; 0 for none
+        std::array<uint32_t, size_t{1} << kHashBits> table{};
+        size_t search_end = size - kMatchSearchEnd;
+        size_t match_limit = size - kLastLiterals;
+        size_t ip = 0;
+        while (ip < search_end) {
+            uint32_t sequence = read32(base + ip);
+            uint32_t& slot = table[hashOf(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(ip + 1);
+            if (candidate == 0 || ip - (candidate - 1) > kMaxOffset || read32(base + candidate - 1) != sequence) {
+                // Step further the longer nothing matched, so incompressible
+                // data passes quickly
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            size_t ref = candidate - 1;
+            while (ip > anchor && ref > 0 && base[ip - 1] == base[ref - 1]) {
+                --ip;
+                --ref;
+            }
+            size_t length = commonLength(base + ip, base + ref, kMinMatch, match_limit - ip);
+            putSequence(op, base + anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+            if (ip < search_end) table[hashOf(read32(base + ip - 2))] = static_cast<uint32_t>(ip - 1);
+        }
+    }
+    putSequence(op, base + anchor, size - anchor, 0, 0);
+    out.resize(static_cast<size_t>(op - out.data()));
+    return out.size() - start;
+}
+
+void lzDecompress(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    const uint8_t* ip = input.data();
+    const uint8_t* in_end = ip + input.size();
+    uint8_t* op = output.data();
+    uint8_t* out_end = op + output.size();
+    auto readLength = [&](size_t length) {
+        if (length != 15) return length;
+        uint8_t byte;
+        do {
+            if (ip == in_end) malformed("truncated length");
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return length;
+    };
+
+    for (;;) {
+        if (ip == in_end) malformed("truncated sequence");
+        uint8_t token = *ip++;
+        size_t literals = readLength(token >> 4);
+        if (literals > static_cast<size_t>(in_end - ip)) malformed("literals past the end of the input");
+        if (literals > static_cast<size_t>(out_end - op)) malformed("literals past the end of the output");
+        if (literals <= 16 && in_end - ip >= 16 && out_end - op >= 16) {
+            // Short runs dominate: one fixed-size copy, the excess
+            // overwritten by what follows
+            std::memcpy(op, ip, 16);
+        } else {
+            std::memcpy(op, ip, literals);
+        }
+        ip += literals;
+        op += literals;
+        if (ip == in_end) break;
+
+        if (in_end - ip < 2) malformed("truncated offset");
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - output.data())) malformed("offset out of range");
+        size_t length = readLength(token & 0x0F) + kMinMatch;
+        if (length > static_cast<size_t>(out_end - op)) malformed("match past the end of the output");
+        const uint8_t* ref = op - offset;
+        if (offset >= 8 && static_cast<size_t>(out_end - op) >= length + 8) {
+            // Eight bytes at a time; an offset of 8 or more never reads what
+            // this copy has yet to write
+            for (size_t i = 0; i < length; i += 8) std::memcpy(op + i, ref + i, 8);
+        } else if (offset >= length) {
+            std::memcpy(op, ref, length);
+        } else {
+            // Overlapping match: repeats the last offset bytes
+            for (size_t i = 0; i < length; ++i) op[i] = ref[i];
+        }
+        op += length;
+    }
+    if (op != out_end) malformed("decoded size differs");
+}
+
+} // namespace memory::core
@@ -0,0 +1,45 @@
+#include "memory/core/cache.h"
+#include <bit>
+
+namespace memory::core {
+
+FrequencySketch::FrequencySketch(size_t width) {
+    width = std::bit_ceil(std::max<size_t>(width, 1));
+    table_.assign(width * kDepth, 0);
+    mask_ = width - 1;
+    sample_size_ = width * 10;
+}
+
+size_t FrequencySketch::slot(uint64_t hash, int row) const {
+    static constexpr uint64_t kSeeds[kDepth] = {0x97cb3127u, 0xab7d45e3u, 0xc2b2ae3du, 0x27d4eb2fu};
+    uint64_t h = (hash + kSeeds[row]) * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 32;
+    return static_cast<size_t>(row) * (mask_ + 1) + (static_cast<size_t>(h) & mask_);
+}
+
+void FrequencySketch::increment(uint64_t hash) {
+    bool added = false;
+    for (int row = 0; row < kDepth; ++row) {
+        uint8_t& count = table_[slot(hash, row)];
+        if (count < kMaxCount) {
+            ++count;
+            added = true;
+        }
+    }
+    if (added && ++additions_ >= sample_size_) age();
+}
+
+uint32_t FrequencySketch::frequency(uint64_t hash) const {
+    uint32_t result = kMaxCount;
+    for (int row = 0; row < kDepth; ++row) {
+        result = std::min<uint32_t>(result, table_[slot(hash, row)]);
+    }
+    return result;
+}
+
+void FrequencySketch::age() {
+    for (uint8_t& count : table_) count >>= 1;
+    additions_ /= 2;
+}
+
+} // namespace memory::core
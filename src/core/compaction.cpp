@@ -0,0 +1,167 @@
+#include "memory/core/compaction.h"
+#include "memory/core/config.h"
+#include "memory/core/logger.h"
+#include <algorithm>
+#include <exception>
+#include <sstream>
+
+namespace memory::core {
+
+CompactionOptions CompactionOptions::fromConfig(const Config& config) {
+    CompactionOptions options;
+    double threshold = config.get<double>("compaction_threshold", options.fragmentation_threshold);
+    options.fragmentation_threshold = std::clamp(threshold, 0.0, 1.0);
+    int factor = config.get<int>("merge_factor", static_cast<int>(options.merge_factor));
+    options.merge_factor = static_cast<size_t>(std::max(factor, 2));
+    double rate_mb = config.get<double>("compaction_rate_mb", options.rate_bytes / (1 << 20));
+    options.rate_bytes = std::max(rate_mb, 0.0) * (1 << 20);
+    int interval = config.get<int>("compaction_interval_ms", static_cast<int>(options.interval.count()));
+    options.interval = std::chrono::milliseconds(std::max(interval, 1));
+    return options;
+}
+
+// === RateLimiter ===
+
+RateLimiter::RateLimiter(double bytes_per_second)
+    : rate_(std::max(bytes_per_second, 0.0)), tokens_(rate_), last_(Clock::now()) {}
+
+void RateLimiter::acquire(size_t bytes) {
+    if (rate_ <= 0.0 || bytes == 0) return;
+    std::chrono::nanoseconds wait{0};
+    {
+        std::lock_guard lock(mutex_);
+        Clock::time_point now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_).count();
+        last_ = now;
+        tokens_ = std::min(rate_, tokens_ + elapsed * rate_);
+        // Going into debt lets a request larger than the burst through; the
+        // next callers then wait for it to be paid back
+        tokens_ -= static_cast<double>(bytes);
+        if (tokens_ < 0.0) {
+            wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::duration<double>(-tokens_ / rate_));
+            throttled_ += wait;
+        }
+    }
+    if (wait.count() > 0) std::this_thread::sleep_for(wait);
+}
+
+std::chrono::nanoseconds RateLimiter::throttled() const {
+    std::lock_guard lock(mutex_);
+    return throttled_;
+}
+
+// === Compactor ===
+
+Compactor::Compactor(CompactionOptions options) : options_(options), limiter_(options.rate_bytes) {}
+
+Compactor::~Compactor() {
+    stop();
+}
+
+void Compactor::add(ICompactable& target) {
+    std::lock_guard lock(run_mutex_);
+    if (std::find(targets_.begin(), targets_.end(), &target) == targets_.end()) targets_.push_back(&target);
+}
+
+void Compactor::remove(ICompactable& target) {
+    std::lock_guard lock(run_mutex_);
+    targets_.erase(std::remove(targets_.begin(), targets_.end(), &target), targets_.end());
+}
+
+void Compactor::start() {
+    std::lock_guard lock(signal_mutex_);
+    if (worker_.joinable()) return;
+    stopping_ = false;
+    worker_ = std::thread([this] { loop(); });
+}
+
+void Compactor::stop() {
+    {
+        std::lock_guard lock(signal_mutex_);
+        stopping_ = true;
+    }
+    signal_cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void Compactor::loop() {
+    for (;;) {
+        {
+            std::unique_lock lock(signal_mutex_);
+            signal_cv_.wait_for(lock, options_.interval, [this] { return stopping_; });
+            if (stopping_) return;
+        }
+        try {
+            runOnce();
+        } catch (const std::exception& e) {
+            // Leaves the target as it was; the next round retries
+            LOG_ERROR(std::string("Background compaction failed: ") + e.what());
+        }
+    }
+}
+
+std::vector<CompactionResult> Compactor::runOnce() {
+    std::lock_guard run_lock(run_mutex_);
+    std::vector<std::pair<std::string, double>> fragmentation;
+    std::vector<CompactionResult> results;
+    for (ICompactable* target : targets_) {
+        fragmentation.emplace_back(target->compactionName(), target->fragmentation());
+        if (!target->compactionDue(options_)) continue;
+
+        auto started = std::chrono::steady_clock::now();
+        CompactionResult result;
+        try {
+            result = target->compact(options_, limiter_);
+        } catch (const std::exception& e) {
+            // Leaves the target as it was; the next round retries it
+            result.error = e.what();
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        if (result.target.empty()) result.target = target->compactionName();
+        if (!result.error.empty()) {
+            result.fragmentation_before = result.fragmentation_after = fragmentation.back().second;
+            LOG_ERROR("Compaction of " + result.target + " failed: " + result.error);
+            results.push_back(std::move(result));
+            continue;
+        }
+        fragmentation.back().second = result.fragmentation_after;
+
+        std::ostringstream message;
+        message << "Compacted " << result.target << ": " << result.bytes_before << " -> " << result.bytes_after
+                << " bytes, " << result.items_before << " -> " << result.items_after << " items, fragmentation "
+                << result.fragmentation_before << " -> " << result.fragmentation_after << " in "
+                << result.seconds << " s";
+        LOG_INFO(message.str());
+        results.push_back(std::move(result));
+    }
+
+    std::lock_guard stats_lock(stats_mutex_);
+    for (const CompactionResult& result : results) {
+        history_.push_back(result);
+        if (history_.size() > kHistory) history_.pop_front();
+        if (!result.error.empty()) {
+            ++metrics_.failures;
+            continue;
+        }
+        ++metrics_.runs;
+        metrics_.bytes_before += result.bytes_before;
+        metrics_.bytes_after += result.bytes_after;
+        metrics_.seconds += result.seconds;
+    }
+    metrics_.throttled_seconds = std::chrono::duration<double>(limiter_.throttled()).count();
+    metrics_.fragmentation = std::move(fragmentation);
+    return results;
+}
+
+std::vector<CompactionResult> Compactor::history() const {
+    std::lock_guard lock(stats_mutex_);
+    return {history_.begin(), history_.end()};
+}
+
+CompactionMetrics Compactor::metrics() const {
+    std::lock_guard lock(stats_mutex_);
+    return metrics_;
+}
+
+} // namespace memory::core
@@ -74,6 +74,24 @@ bool Config::get<bool>(const std::string& key, const bool& default_value) const
     return default_value;
 }
 
+template<>
+double Config::get<double>(const std::string& key, const double& default_value) const {
+    auto it = config_map_.find(key);
+    if (it != config_map_.end()) {
+        try {
+            return std::stod(it->second);
+        } catch (...) {
+            return default_value;
+        }
+    }
+    return default_value;
+}
+
+template<>
+float Config::get<float>(const std::string& key, const float& default_value) const {
+    return static_cast<float>(get<double>(key, default_value));
+}
+
 void Config::set(const std::string& key, const std::string& value) {
     config_map_[key] = value;
 }
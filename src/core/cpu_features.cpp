@@ -0,0 +1,92 @@
+#include "memory/core/cpu_features.h"
+#include <cstdlib>
+#include <string_view>
+
+#if defined(MEMORY_ARCH_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(MEMORY_ARCH_X86)
+#include <cpuid.h>
+#endif
+
+namespace memory::core {
+
+namespace {
+
+CpuFeatures detectFeatures() {
+    CpuFeatures features;
+#if defined(MEMORY_ARCH_X86)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool ymm_enabled = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+    features.sse42 = (info[2] & (1 << 20)) != 0;
+    features.fma = ymm_enabled && avx && (info[2] & (1 << 12)) != 0;
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        features.avx2 = ymm_enabled && avx && (info[1] & (1 << 5)) != 0;
+        features.sha = (info[1] & (1 << 29)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.fma = __builtin_cpu_supports("fma");
+    // Not every supported compiler knows __builtin_cpu_supports("sha")
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) features.sha = (ebx & (1u << 29)) != 0;
+#endif
+#endif
+    return features;
+}
+
+} // namespace
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectFeatures();
+    return features;
+}
+
+bool simdLevelSupported(SimdLevel level) {
+    const CpuFeatures& features = cpuFeatures();
+    switch (level) {
+        case SimdLevel::SCALAR: return true;
+        case SimdLevel::SSE42: return features.sse42;
+        case SimdLevel::AVX2: return features.avx2 && features.sse42;
+        default: return false;
+    }
+}
+
+SimdLevel bestSimdLevel() {
+    SimdLevel level = SimdLevel::SCALAR;
+    if (simdLevelSupported(SimdLevel::AVX2)) {
+        level = SimdLevel::AVX2;
+    } else if (simdLevelSupported(SimdLevel::SSE42)) {
+        level = SimdLevel::SSE42;
+    }
+
+    if (const char* env = std::getenv("MEMORY_SIMD")) {
+        std::string_view requested(env);
+        SimdLevel cap = level;
+        if (requested == "scalar") cap = SimdLevel::SCALAR;
+        else if (requested == "sse42") cap = SimdLevel::SSE42;
+        else if (requested == "avx2") cap = SimdLevel::AVX2;
+        if (cap < level) level = cap;
+    }
+    return level;
+}
+
+std::string simdLevelToString(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return "scalar";
+        case SimdLevel::SSE42: return "sse42";
+        case SimdLevel::AVX2: return "avx2";
+        default: return "unknown";
+    }
+}
+
+} // namespace memory::core
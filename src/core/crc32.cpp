@@ -0,0 +1,91 @@
+#include "memory/core/crc32.h"
+#include "memory/core/cpu_features.h"
+#include <array>
+#include <cstring>
+
+#if defined(MEMORY_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+namespace memory::core {
+
+namespace {
+
+constexpr uint32_t kPolynomial = 0x82F63B78u;  // Reflected Castagnoli
+
+using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr Tables makeTables() {
+    Tables tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t t = 1; t < 8; ++t) {
+            tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr Tables kTables = makeTables();
+
+uint32_t crc32cScalar(const uint8_t* p, size_t size, uint32_t crc) {
+    while (size >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        word ^= crc;
+        crc = kTables[7][word & 0xFF] ^ kTables[6][(word >> 8) & 0xFF]
+            ^ kTables[5][(word >> 16) & 0xFF] ^ kTables[4][(word >> 24) & 0xFF]
+            ^ kTables[3][(word >> 32) & 0xFF] ^ kTables[2][(word >> 40) & 0xFF]
+            ^ kTables[1][(word >> 48) & 0xFF] ^ kTables[0][word >> 56];
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = (crc >> 8) ^ kTables[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(MEMORY_ARCH_X86) && (defined(__x86_64__) || defined(_M_X64))
+MEMORY_TARGET("sse4.2")
+uint32_t crc32cSse42(const uint8_t* p, size_t size, uint32_t crc) {
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (size-- > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#define MEMORY_HAVE_CRC32C_HW 1
+#endif
+
+using Crc32cFn = uint32_t (*)(const uint8_t*, size_t, uint32_t);
+
+Crc32cFn selectCrc32c() {
+#if defined(MEMORY_HAVE_CRC32C_HW)
+    if (simdLevelSupported(SimdLevel::SSE42)) return crc32cSse42;
+#endif
+    return crc32cScalar;
+}
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+    static const Crc32cFn impl = selectCrc32c();
+    return ~impl(static_cast<const uint8_t*>(data), size, ~crc);
+}
+
+} // namespace memory::core
@@ -0,0 +1,62 @@
+#include "memory/core/file_format.h"
+#include "memory/core/crc32.h"
+#include "memory/core/errors.h"
+#include <cstring>
+
+namespace memory::core {
+
+namespace {
+
+uint32_t headerCrc(const FileHeader& header) {
+    return crc32c(&header, offsetof(FileHeader, header_crc));
+}
+
+} // namespace
+
+size_t beginFileHeader(std::vector<uint8_t>& out) {
+    size_t offset = out.size();
+    out.resize(offset + sizeof(FileHeader), 0);
+    return offset;
+}
+
+void sealFileHeader(std::vector<uint8_t>& out, size_t header_offset, uint32_t magic, uint16_t version,
+                    uint16_t flags) {
+    size_t payload_start = header_offset + sizeof(FileHeader);
+    FileHeader header{};
+    header.magic = magic;
+    header.version = version;
+    header.flags = flags;
+    header.payload_bytes = out.size() - payload_start;
+    header.payload_crc = crc32c(out.data() + payload_start, header.payload_bytes);
+    header.header_crc = headerCrc(header);
+    std::memcpy(out.data() + header_offset, &header, sizeof(header));
+}
+
+std::span<const uint8_t> checkFileHeader(std::span<const uint8_t> file, uint32_t magic, uint16_t version,
+                                         const std::string& what, FileHeader* out_header) {
+    if (file.size() < sizeof(FileHeader)) {
+        throw StorageException(what + ": truncated header");
+    }
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.header_crc != headerCrc(header)) {
+        throw StorageException(what + ": header checksum mismatch");
+    }
+    if (header.magic != magic) {
+        throw StorageException(what + ": bad magic");
+    }
+    if (header.version != version) {
+        throw StorageException(what + ": unsupported version " + std::to_string(header.version));
+    }
+    if (header.payload_bytes > file.size() - sizeof(FileHeader)) {
+        throw StorageException(what + ": truncated payload");
+    }
+    auto payload = file.subspan(sizeof(FileHeader), header.payload_bytes);
+    if (crc32c(payload) != header.payload_crc) {
+        throw StorageException(what + ": payload checksum mismatch");
+    }
+    if (out_header) *out_header = header;
+    return payload;
+}
+
+} // namespace memory::core
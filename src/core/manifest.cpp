@@ -0,0 +1,166 @@
+#include "memory/core/manifest.h"
+#include "memory/core/errors.h"
+#include "memory/core/logger.h"
+#include "memory/core/mapped_file.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+namespace memory::core {
+
+namespace {
+
+constexpr const char* kManifestName = "MANIFEST";
+
+// Payload: this header, then per file an EntryHeader and the name bytes
+struct ManifestHeader {
+    uint64_t version;
+    uint64_t lsn;
+    uint32_t file_count;
+    uint32_t reserved;
+};
+
+struct EntryHeader {
+    uint8_t engine;
+    uint8_t reserved;
+    uint16_t reserved2;
+    uint32_t name_length;
+};
+
+template <typename T>
+void appendValue(std::vector<uint8_t>& out, const T& value) {
+    size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+std::string manifestPath(const std::string& directory) {
+    return (std::filesystem::path(directory) / kManifestName).string();
+}
+
+} // namespace
+
+std::vector<std::string> Manifest::filesOf(WalStream engine) const {
+    std::vector<std::string> names;
+    for (const ManifestFile& file : files) {
+        if (file.engine == engine) names.push_back(file.name);
+    }
+    return names;
+}
+
+void Manifest::save(const std::string& directory) const {
+    std::vector<uint8_t> image;
+    size_t header_offset = beginFileHeader(image);
+    appendValue(image, ManifestHeader{version, lsn, static_cast<uint32_t>(files.size()), 0});
+    for (const ManifestFile& file : files) {
+        appendValue(image, EntryHeader{static_cast<uint8_t>(file.engine), 0, 0,
+                                       static_cast<uint32_t>(file.name.size())});
+        image.insert(image.end(), file.name.begin(), file.name.end());
+    }
+    sealFileHeader(image, header_offset, kManifestMagic, kManifestVersion);
+    writeFileAtomically(manifestPath(directory), image);
+}
+
+std::optional<Manifest> Manifest::load(const std::string& directory) {
+    std::string path = manifestPath(directory);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) return std::nullopt;
+
+    MappedFile file = MappedFile::open(path);
+    std::string what = "manifest " + path;
+    auto payload = checkFileHeader(file.bytes(), kManifestMagic, kManifestVersion, what);
+    auto take = [&](size_t bytes) {
+        if (payload.size() < bytes) throw StorageException(what + ": truncated payload");
+        const uint8_t* data = payload.data();
+        payload = payload.subspan(bytes);
+        return data;
+    };
+
+    ManifestHeader header;
+    std::memcpy(&header, take(sizeof(header)), sizeof(header));
+    Manifest manifest;
+    manifest.version = header.version;
+    manifest.lsn = header.lsn;
+    for (uint32_t i = 0; i < header.file_count; ++i) {
+        EntryHeader entry;
+        std::memcpy(&entry, take(sizeof(entry)), sizeof(entry));
+        if (entry.engine < static_cast<uint8_t>(WalStream::SEARCH) ||
+            entry.engine > static_cast<uint8_t>(WalStream::VECTOR)) {
+            throw StorageException(what + ": unknown engine " + std::to_string(entry.engine));
+        }
+        const auto* name = reinterpret_cast<const char*>(take(entry.name_length));
+        manifest.files.push_back(ManifestFile{static_cast<WalStream>(entry.engine),
+                                              std::string(name, entry.name_length)});
+    }
+    return manifest;
+}
+
+VersionSet::VersionSet(std::string directory) : directory_(std::move(directory)) {
+    current_.store(std::make_shared<const StoreView>());
+    if (directory_.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        throw StorageException("Cannot create manifest directory " + directory_ + ": " + ec.message());
+    }
+    manifest_ = Manifest::load(directory_);
+}
+
+template <typename Replace>
+void VersionSet::publishWith(const Replace& replace) {
+    std::lock_guard lock(publish_mutex_);
+    auto next = std::make_shared<StoreView>(*current_.load());
+    ++next->version;
+    replace(*next);
+    current_.store(std::move(next));
+}
+
+void VersionSet::publish(std::shared_ptr<const search::SearchSnapshot> snapshot) {
+    publishWith([&](StoreView& view) { view.search = std::move(snapshot); });
+}
+
+void VersionSet::publish(std::shared_ptr<const graph::GraphSnapshot> snapshot) {
+    publishWith([&](StoreView& view) { view.graph = std::move(snapshot); });
+}
+
+void VersionSet::publish(std::shared_ptr<const vector::HnswSnapshot> snapshot) {
+    publishWith([&](StoreView& view) { view.vector = std::move(snapshot); });
+}
+
+std::optional<Manifest> VersionSet::manifest() const {
+    std::lock_guard lock(manifest_mutex_);
+    return manifest_;
+}
+
+Manifest VersionSet::checkpoint(uint64_t lsn, std::vector<ManifestFile> files, WriteAheadLog* wal) {
+    if (directory_.empty()) throw StorageException("Checkpoint needs a manifest directory");
+    std::lock_guard lock(manifest_mutex_);
+    Manifest next;
+    next.version = manifest_ ? manifest_->version + 1 : 1;
+    next.lsn = std::max(lsn, manifest_ ? manifest_->lsn : 0);
+    next.files = std::move(files);
+    // save() syncs the directory, so a crash cannot keep the deletions
+    // below while losing the rename that made them safe
+    next.save(directory_);
+
+    if (manifest_) {
+        for (const ManifestFile& old : manifest_->files) {
+            bool kept = std::any_of(next.files.begin(), next.files.end(), [&](const ManifestFile& file) {
+                return file.name == old.name;
+            });
+            if (kept) continue;
+            std::error_code ec;
+            std::filesystem::remove(std::filesystem::path(directory_) / old.name, ec);
+            if (ec) LOG_WARN("Cannot remove obsolete segment " + old.name + ": " + ec.message());
+        }
+    }
+    manifest_ = next;
+    if (wal) wal->releaseUpTo(next.lsn);
+    LOG_DEBUG("Checkpoint " + std::to_string(next.version) + " at LSN " + std::to_string(next.lsn) + " with " +
+              std::to_string(next.files.size()) + " files");
+    return next;
+}
+
+} // namespace memory::core
@@ -0,0 +1,274 @@
+#include "memory/core/mapped_file.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace memory::core {
+
+namespace {
+
+std::string lastError() {
+#if defined(_WIN32)
+    return "error " + std::to_string(::GetLastError());
+#else
+    return std::strerror(errno);
+#endif
+}
+
+} // namespace
+
+MappedFile::~MappedFile() {
+    reset();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mode_(other.mode_),
+      path_(std::move(other.path_)) {
+    other.path_.clear();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        reset();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mode_ = other.mode_;
+        path_ = std::move(other.path_);
+        other.path_.clear();
+    }
+    return *this;
+}
+
+void MappedFile::reset() {
+    if (data_) {
+#if defined(_WIN32)
+        ::UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    path_.clear();
+}
+
+MappedFile MappedFile::open(const std::string& path, MapMode mode) {
+    MappedFile file;
+    bool copy_on_write = mode == MapMode::PRIVATE;
+#if defined(_WIN32)
+    HANDLE handle = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw StorageException("Cannot open " + path + ": " + lastError());
+    }
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(handle, &size)) {
+        ::CloseHandle(handle);
+        throw StorageException("Cannot stat " + path + ": " + lastError());
+    }
+    if (size.QuadPart > 0) {
+        HANDLE mapping = ::CreateFileMappingA(handle, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0,
+                                              0, nullptr);
+        void* view = mapping ? ::MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0)
+                             : nullptr;
+        std::string error = view ? "" : lastError();
+        if (mapping) ::CloseHandle(mapping);
+        if (!view) {
+            ::CloseHandle(handle);
+            throw StorageException("Cannot map " + path + ": " + error);
+        }
+        file.data_ = static_cast<const uint8_t*>(view);
+        file.size_ = static_cast<size_t>(size.QuadPart);
+    }
+    ::CloseHandle(handle);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw StorageException("Cannot open " + path + ": " + lastError());
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        std::string error = lastError();
+        ::close(fd);
+        throw StorageException("Cannot stat " + path + ": " + error);
+    }
+    if (st.st_size > 0) {
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ,
+                            copy_on_write ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            std::string error = lastError();
+            ::close(fd);
+            throw StorageException("Cannot map " + path + ": " + error);
+        }
+        file.data_ = static_cast<const uint8_t*>(addr);
+        file.size_ = static_cast<size_t>(st.st_size);
+    }
+    ::close(fd);  // The mapping keeps the file referenced
+#endif
+    file.mode_ = mode;
+    file.path_ = path;
+    return file;
+}
+
+void MappedFile::advise(size_t offset, size_t length, Access access) const {
+#if defined(_WIN32)
+    (void)offset;
+    (void)length;
+    (void)access;
+#else
+    if (!data_ || offset >= size_) return;
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t first = offset / page * page;
+    size_t last = offset + std::min(length, size_ - offset);
+    int advice = MADV_NORMAL;
+    switch (access) {
+        case Access::NORMAL: advice = MADV_NORMAL; break;
+        case Access::RANDOM: advice = MADV_RANDOM; break;
+        case Access::SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+        case Access::WILLNEED: advice = MADV_WILLNEED; break;
+    }
+    ::madvise(const_cast<uint8_t*>(data_) + first, last - first, advice);
+#endif
+}
+
+// === AtomicFileWriter ===
+
+AtomicFileWriter::AtomicFileWriter(std::string path)
+    : path_(std::move(path)), tmp_(path_ + ".tmp") {
+#if defined(_WIN32)
+    HANDLE handle = ::CreateFileA(tmp_.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                                  nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw StorageException("Cannot create " + tmp_ + ": " + lastError());
+    }
+    handle_ = reinterpret_cast<intptr_t>(handle);
+#else
+    int fd = ::open(tmp_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw StorageException("Cannot create " + tmp_ + ": " + lastError());
+    }
+    handle_ = fd;
+#endif
+}
+
+AtomicFileWriter::AtomicFileWriter(AtomicFileWriter&& other) noexcept
+    : path_(std::move(other.path_)),
+      tmp_(std::move(other.tmp_)),
+      handle_(std::exchange(other.handle_, -1)),
+      size_(other.size_) {}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    if (handle_ == -1) return;
+    close();
+    std::error_code ec;
+    std::filesystem::remove(tmp_, ec);
+}
+
+void AtomicFileWriter::close() {
+#if defined(_WIN32)
+    ::CloseHandle(reinterpret_cast<HANDLE>(handle_));
+#else
+    ::close(static_cast<int>(handle_));
+#endif
+    handle_ = -1;
+}
+
+void AtomicFileWriter::append(std::span<const uint8_t> bytes) {
+    writeAt(size_, bytes);
+}
+
+void AtomicFileWriter::writeAt(uint64_t offset, std::span<const uint8_t> bytes) {
+    if (handle_ == -1) throw StorageException("Cannot write " + tmp_ + ": already committed");
+    size_t written = 0;
+#if defined(_WIN32)
+    HANDLE handle = reinterpret_cast<HANDLE>(handle_);
+    while (written < bytes.size()) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes.size() - written, 1u << 30));
+        OVERLAPPED at{};
+        at.Offset = static_cast<DWORD>(offset + written);
+        at.OffsetHigh = static_cast<DWORD>((offset + written) >> 32);
+        DWORD done = 0;
+        if (!::WriteFile(handle, bytes.data() + written, chunk, &done, &at)) {
+            throw StorageException("Cannot write " + tmp_ + ": " + lastError());
+        }
+        written += done;
+    }
+#else
+    int fd = static_cast<int>(handle_);
+    while (written < bytes.size()) {
+        ssize_t done = ::pwrite(fd, bytes.data() + written, bytes.size() - written,
+                                static_cast<off_t>(offset + written));
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            throw StorageException("Cannot write " + tmp_ + ": " + lastError());
+        }
+        written += static_cast<size_t>(done);
+    }
+#endif
+    size_ = std::max<uint64_t>(size_, offset + bytes.size());
+}
+
+void AtomicFileWriter::commit() {
+    if (handle_ == -1) throw StorageException("Cannot commit " + tmp_ + " twice");
+#if defined(_WIN32)
+    std::string sync_error = ::FlushFileBuffers(reinterpret_cast<HANDLE>(handle_)) ? "" : lastError();
+#else
+    std::string sync_error = ::fsync(static_cast<int>(handle_)) == 0 ? "" : lastError();
+#endif
+    close();
+    std::error_code ec;
+    if (!sync_error.empty()) {
+        std::filesystem::remove(tmp_, ec);
+        throw StorageException("Cannot sync " + tmp_ + ": " + sync_error);
+    }
+    std::filesystem::rename(tmp_, path_, ec);
+    if (ec) {
+        std::string error = ec.message();
+        std::filesystem::remove(tmp_, ec);
+        throw StorageException("Cannot rename " + tmp_ + " to " + path_ + ": " + error);
+    }
+    // Callers may delete what the new file supersedes right after this
+    std::string parent = std::filesystem::path(path_).parent_path().string();
+    syncDirectory(parent.empty() ? "." : parent);
+}
+
+void writeFileAtomically(const std::string& path, std::span<const uint8_t> bytes) {
+    AtomicFileWriter writer(path);
+    writer.append(bytes);
+    writer.commit();
+}
+
+void syncDirectory(const std::string& directory) {
+#if !defined(_WIN32)
+    int fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw StorageException("Cannot open directory " + directory + ": " + lastError());
+    int result = ::fsync(fd);
+    int sync_errno = errno;
+    std::string error = result == 0 ? "" : lastError();
+    ::close(fd);
+    // EINVAL / EROFS: the file system cannot sync directories at all
+    bool unsupported = sync_errno == EINVAL || sync_errno == EROFS;
+    if (!error.empty() && !unsupported) throw StorageException("Cannot sync directory " + directory + ": " + error);
+#else
+    (void)directory;
+#endif
+}
+
+} // namespace memory::core
@@ -0,0 +1,243 @@
+#include "memory/core/node_store.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <limits>
+
+namespace memory::core {
+
+NodeId NodeView::id() const {
+    return store_->ids_[index_];
+}
+
+NodeType NodeView::type() const {
+    return store_->types_[index_];
+}
+
+float NodeView::importance() const {
+    return store_->importance_[index_];
+}
+
+float NodeView::confidence() const {
+    return store_->confidence_[index_];
+}
+
+Timestamp NodeView::recency() const {
+    return NodeStore::fromMillis(store_->recency_ms_[index_]);
+}
+
+uint32_t NodeView::frequency() const {
+    return store_->frequency_[index_];
+}
+
+uint32_t NodeView::tenantOrdinal() const {
+    return store_->tenants_[index_];
+}
+
+std::string_view NodeView::tenant() const {
+    return store_->tenantName(store_->tenants_[index_]);
+}
+
+std::string_view NodeView::title() const {
+    const NodeStore::TextRef& ref = store_->text_refs_[index_];
+    return std::string_view(store_->text_heap_.data() + ref.offset, ref.title_size);
+}
+
+std::string_view NodeView::text() const {
+    const NodeStore::TextRef& ref = store_->text_refs_[index_];
+    return std::string_view(store_->text_heap_.data() + ref.offset + ref.title_size, ref.text_size);
+}
+
+std::span<const uint32_t> NodeView::keywordIds() const {
+    const NodeStore::LabelRef& ref = store_->label_refs_[index_];
+    return std::span<const uint32_t>(store_->label_heap_.data() + ref.offset, ref.keywords);
+}
+
+std::span<const uint32_t> NodeView::entityIds() const {
+    const NodeStore::LabelRef& ref = store_->label_refs_[index_];
+    return std::span<const uint32_t>(store_->label_heap_.data() + ref.offset + ref.keywords, ref.entities);
+}
+
+const std::unordered_map<std::string, std::string>* NodeView::metadata() const {
+    auto it = store_->metadata_.find(index_);
+    return it != store_->metadata_.end() ? &it->second : nullptr;
+}
+
+Node NodeView::materialize() const {
+    Node node;
+    node.id = id();
+    node.type = type();
+    node.title = std::string(title());
+    node.text = std::string(text());
+    for (uint32_t keyword : keywordIds()) node.keywords.emplace_back(store_->label(keyword));
+    for (uint32_t entity : entityIds()) node.entities.emplace_back(store_->label(entity));
+    node.importance = importance();
+    node.confidence = confidence();
+    node.recency = recency();
+    node.frequency = static_cast<int>(std::min<uint32_t>(frequency(), std::numeric_limits<int>::max()));
+    node.tenant_id = std::string(tenant());
+    if (const auto* meta = metadata()) node.metadata = *meta;
+    return node;
+}
+
+uint32_t NodeStore::upsert(const Node& node) {
+    auto it = index_.find(node.id);
+    if (it != index_.end()) {
+        uint32_t index = it->second;
+        garbage_bytes_ += text_refs_[index].title_size + text_refs_[index].text_size;
+        garbage_bytes_ += (label_refs_[index].keywords + label_refs_[index].entities) * sizeof(uint32_t);
+        store(index, node);
+        return index;
+    }
+    if (ids_.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw IndexException("Node store is full at node " + std::to_string(node.id));
+    }
+    auto index = static_cast<uint32_t>(ids_.size());
+    ids_.push_back(node.id);
+    types_.emplace_back();
+    importance_.emplace_back();
+    confidence_.emplace_back();
+    recency_ms_.emplace_back();
+    frequency_.emplace_back();
+    tenants_.emplace_back();
+    deleted_.push_back(0);
+    text_refs_.emplace_back();
+    label_refs_.emplace_back();
+    store(index, node);
+    index_.emplace(node.id, index);
+    return index;
+}
+
+void NodeStore::store(uint32_t index, const Node& node) {
+    size_t text_size = node.title.size() + node.text.size();
+    size_t label_count = node.keywords.size() + node.entities.size();
+    if (text_heap_.size() + text_size > std::numeric_limits<uint32_t>::max() ||
+        label_heap_.size() + label_count > std::numeric_limits<uint32_t>::max()) {
+        throw IndexException("Node store heap is full at node " + std::to_string(node.id));
+    }
+
+    types_[index] = node.type;
+    importance_[index] = node.importance;
+    confidence_[index] = node.confidence;
+    recency_ms_[index] = toMillis(node.recency);
+    frequency_[index] = static_cast<uint32_t>(std::max(node.frequency, 0));
+    tenants_[index] = tenant_names_.intern(node.tenant_id);
+
+    TextRef& text = text_refs_[index];
+    text.offset = static_cast<uint32_t>(text_heap_.size());
+    text.title_size = static_cast<uint32_t>(node.title.size());
+    text.text_size = static_cast<uint32_t>(node.text.size());
+    text_heap_.insert(text_heap_.end(), node.title.begin(), node.title.end());
+    text_heap_.insert(text_heap_.end(), node.text.begin(), node.text.end());
+
+    LabelRef& labels = label_refs_[index];
+    labels.offset = static_cast<uint32_t>(label_heap_.size());
+    labels.keywords = static_cast<uint32_t>(node.keywords.size());
+    labels.entities = static_cast<uint32_t>(node.entities.size());
+    for (const std::string& keyword : node.keywords) label_heap_.push_back(labels_.intern(keyword));
+    for (const std::string& entity : node.entities) label_heap_.push_back(labels_.intern(entity));
+
+    if (node.metadata.empty()) {
+        metadata_.erase(index);
+    } else {
+        metadata_[index] = node.metadata;
+    }
+}
+
+bool NodeStore::erase(NodeId id) {
+    auto it = index_.find(id);
+    if (it == index_.end()) return false;
+    uint32_t index = it->second;
+    garbage_bytes_ += text_refs_[index].title_size + text_refs_[index].text_size;
+    garbage_bytes_ += (label_refs_[index].keywords + label_refs_[index].entities) * sizeof(uint32_t);
+    deleted_[index] = 1;
+    metadata_.erase(index);
+    index_.erase(it);
+    return true;
+}
+
+std::optional<uint32_t> NodeStore::find(NodeId id) const {
+    auto it = index_.find(id);
+    if (it == index_.end()) return std::nullopt;
+    return it->second;
+}
+
+std::optional<NodeView> NodeStore::get(NodeId id) const {
+    auto index = find(id);
+    if (!index) return std::nullopt;
+    return view(*index);
+}
+
+void NodeStore::compact() {
+    std::vector<char> text_heap;
+    std::vector<uint32_t> label_heap;
+    text_heap.reserve(text_heap_.size() - std::min(text_heap_.size(), garbage_bytes_));
+    std::unordered_map<uint32_t, std::unordered_map<std::string, std::string>> metadata;
+    uint32_t next = 0;
+    for (uint32_t index = 0; index < size(); ++index) {
+        if (deleted_[index]) continue;
+        TextRef text = text_refs_[index];
+        LabelRef labels = label_refs_[index];
+        auto text_begin = text_heap_.begin() + text.offset;
+        auto label_begin = label_heap_.begin() + labels.offset;
+        text.offset = static_cast<uint32_t>(text_heap.size());
+        labels.offset = static_cast<uint32_t>(label_heap.size());
+        text_heap.insert(text_heap.end(), text_begin, text_begin + text.title_size + text.text_size);
+        label_heap.insert(label_heap.end(), label_begin, label_begin + labels.keywords + labels.entities);
+
+        ids_[next] = ids_[index];
+        types_[next] = types_[index];
+        importance_[next] = importance_[index];
+        confidence_[next] = confidence_[index];
+        recency_ms_[next] = recency_ms_[index];
+        frequency_[next] = frequency_[index];
+        tenants_[next] = tenants_[index];
+        deleted_[next] = 0;
+        text_refs_[next] = text;
+        label_refs_[next] = labels;
+        if (auto it = metadata_.find(index); it != metadata_.end()) {
+            metadata.emplace(next, std::move(it->second));
+        }
+        index_[ids_[next]] = next;
+        ++next;
+    }
+
+    ids_.resize(next);
+    types_.resize(next);
+    importance_.resize(next);
+    confidence_.resize(next);
+    recency_ms_.resize(next);
+    frequency_.resize(next);
+    tenants_.resize(next);
+    deleted_.resize(next);
+    text_refs_.resize(next);
+    label_refs_.resize(next);
+    text_heap_ = std::move(text_heap);
+    label_heap_ = std::move(label_heap);
+    metadata_ = std::move(metadata);
+    garbage_bytes_ = 0;
+}
+
+size_t NodeStore::memoryBytes() const {
+    size_t columns = ids_.capacity() * sizeof(NodeId) + types_.capacity() * sizeof(NodeType) +
+                     (importance_.capacity() + confidence_.capacity()) * sizeof(float) +
+                     recency_ms_.capacity() * sizeof(int64_t) +
+                     (frequency_.capacity() + tenants_.capacity()) * sizeof(uint32_t) + deleted_.capacity() +
+                     text_refs_.capacity() * sizeof(TextRef) + label_refs_.capacity() * sizeof(LabelRef);
+    size_t heaps = text_heap_.capacity() + label_heap_.capacity() * sizeof(uint32_t);
+    size_t index = index_.size() * (sizeof(NodeId) + sizeof(uint32_t) + sizeof(void*) * 2);
+    size_t metadata = 0;
+    for (const auto& [node, entries] : metadata_) {
+        for (const auto& [key, value] : entries) metadata += key.capacity() + value.capacity() + sizeof(void*) * 4;
+    }
+    return columns + heaps + index + metadata + tenant_names_.memoryBytes() + labels_.memoryBytes();
+}
+
+int64_t NodeStore::toMillis(Timestamp time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+Timestamp NodeStore::fromMillis(int64_t millis) {
+    return Timestamp(std::chrono::duration_cast<Timestamp::duration>(std::chrono::milliseconds(millis)));
+}
+
+} // namespace memory::core
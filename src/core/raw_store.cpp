@@ -0,0 +1,743 @@
+#include "memory/core/raw_store.h"
+#include "memory/core/config.h"
+#include "memory/core/crc32.h"
+#include "memory/core/errors.h"
+#include "memory/core/file_format.h"
+#include "memory/core/logger.h"
+#include "memory/core/mapped_file.h"
+#include "memory/core/thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace memory::core {
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kPackMagic = makeMagic('R', 'A', 'W', 'P');
+constexpr uint32_t kIndexMagic = makeMagic('R', 'A', 'W', 'I');
+constexpr uint32_t kChunkMagic = makeMagic('R', 'A', 'W', 'C');
+constexpr const char* kIndexName = "index.rawi";
+constexpr const char* kDefaultTenant = "default";
+
+std::string lastError() {
+#if defined(_WIN32)
+    return "error " + std::to_string(::GetLastError());
+#else
+    return std::strerror(errno);
+#endif
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct DigestHash {
+    size_t operator()(const Sha256Digest& digest) const {
+        size_t hash;
+        std::memcpy(&hash, digest.data(), sizeof(hash));
+        return hash;
+    }
+};
+
+// Positional reads and appends on one open file. A pack being written is
+// shared by its writer and concurrent readers: appends only ever extend it.
+class RawFile {
+public:
+    // Creates the file if writable. Throws StorageException.
+    RawFile(std::string path, bool writable) : path_(std::move(path)) {
+#if defined(_WIN32)
+        DWORD access = GENERIC_READ | (writable ? GENERIC_WRITE : 0);
+        HANDLE handle = ::CreateFileA(path_.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                      nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) throw StorageException("Cannot open " + path_ + ": " + lastError());
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(handle, &size)) {
+            std::string error = lastError();
+            ::CloseHandle(handle);
+            throw StorageException("Cannot stat " + path_ + ": " + error);
+        }
+        handle_ = reinterpret_cast<intptr_t>(handle);
+        size_ = static_cast<uint64_t>(size.QuadPart);
+#else
+        int fd = ::open(path_.c_str(), writable ? (O_RDWR | O_CREAT | O_CLOEXEC) : (O_RDONLY | O_CLOEXEC), 0644);
+        if (fd < 0) throw StorageException("Cannot open " + path_ + ": " + lastError());
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            std::string error = lastError();
+            ::close(fd);
+            throw StorageException("Cannot stat " + path_ + ": " + error);
+        }
+        handle_ = fd;
+        size_ = static_cast<uint64_t>(st.st_size);
+#endif
+    }
+
+    ~RawFile() {
+#if defined(_WIN32)
+        ::CloseHandle(reinterpret_cast<HANDLE>(handle_));
+#else
+        ::close(static_cast<int>(handle_));
+#endif
+    }
+
+    RawFile(const RawFile&) = delete;
+    RawFile& operator=(const RawFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    // Bytes appended so far; only meaningful to the writer
+    uint64_t size() const { return size_; }
+
+    void append(std::span<const uint8_t> bytes) {
+        size_t written = 0;
+        while (written < bytes.size()) {
+#if defined(_WIN32)
+            OVERLAPPED at{};
+            uint64_t offset = size_ + written;
+            at.Offset = static_cast<DWORD>(offset);
+            at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes.size() - written, 1u << 30));
+            DWORD done = 0;
+            if (!::WriteFile(reinterpret_cast<HANDLE>(handle_), bytes.data() + written, chunk, &done, &at)) {
+                throw StorageException("Cannot write " + path_ + ": " + lastError());
+            }
+#else
+            ssize_t done = ::pwrite(static_cast<int>(handle_), bytes.data() + written, bytes.size() - written,
+                                    static_cast<off_t>(size_ + written));
+            if (done < 0) {
+                if (errno == EINTR) continue;
+                throw StorageException("Cannot write " + path_ + ": " + lastError());
+            }
+#endif
+            written += static_cast<size_t>(done);
+        }
+        size_ += bytes.size();
+    }
+
+    void sync() {
+#if defined(_WIN32)
+        bool synced = ::FlushFileBuffers(reinterpret_cast<HANDLE>(handle_));
+#else
+        bool synced = ::fdatasync(static_cast<int>(handle_)) == 0;
+#endif
+        if (!synced) throw StorageException("Cannot sync " + path_ + ": " + lastError());
+    }
+
+    // Fills out from offset; a short read throws
+    void readAt(uint64_t offset, std::span<uint8_t> out) const {
+        size_t done_total = 0;
+        while (done_total < out.size()) {
+#if defined(_WIN32)
+            OVERLAPPED at{};
+            uint64_t position = offset + done_total;
+            at.Offset = static_cast<DWORD>(position);
+            at.OffsetHigh = static_cast<DWORD>(position >> 32);
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(out.size() - done_total, 1u << 30));
+            DWORD done = 0;
+            if (!::ReadFile(reinterpret_cast<HANDLE>(handle_), out.data() + done_total, chunk, &done, &at)) {
+                throw StorageException("Cannot read " + path_ + ": " + lastError());
+            }
+#else
+            ssize_t done = ::pread(static_cast<int>(handle_), out.data() + done_total, out.size() - done_total,
+                                   static_cast<off_t>(offset + done_total));
+            if (done < 0) {
+                if (errno == EINTR) continue;
+                throw StorageException("Cannot read " + path_ + ": " + lastError());
+            }
+#endif
+            if (done == 0) {
+                throw StorageException(path_ + " ends before byte " + std::to_string(offset + out.size()));
+            }
+            done_total += static_cast<size_t>(done);
+        }
+    }
+
+private:
+    std::string path_;
+    intptr_t handle_ = -1;  // File descriptor, or HANDLE on Windows
+    uint64_t size_ = 0;
+};
+
+RawFileHeader fileHeader(uint32_t magic) {
+    RawFileHeader header{};
+    header.magic = magic;
+    header.version = kRawStoreVersion;
+    header.header_crc = crc32c(&header, offsetof(RawFileHeader, header_crc));
+    return header;
+}
+
+bool validFileHeader(std::span<const uint8_t> file, uint32_t magic) {
+    if (file.size() < sizeof(RawFileHeader)) return false;
+    RawFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    return header.magic == magic && header.version == kRawStoreVersion
+        && header.header_crc == crc32c(&header, offsetof(RawFileHeader, header_crc));
+}
+
+uint32_t indexRecordCrc(const RawIndexRecord& record) {
+    return crc32c(&record, offsetof(RawIndexRecord, crc));
+}
+
+uint32_t chunkCrc(const RawChunkHeader& header, std::span<const uint8_t> table) {
+    return crc32c(table, crc32c(&header, offsetof(RawChunkHeader, crc)));
+}
+
+// YYYYMMDD of the UTC day
+uint32_t dayOf(Timestamp time) {
+    std::chrono::year_month_day date{std::chrono::floor<std::chrono::days>(time)};
+    return static_cast<uint32_t>(static_cast<int>(date.year())) * 10000 + static_cast<unsigned>(date.month()) * 100
+         + static_cast<unsigned>(date.day());
+}
+
+fs::path packPath(const fs::path& root, uint32_t day, uint32_t pack) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%04u/%02u/%02u/pack_%08u.rawp", day / 10000, day / 100 % 100, day % 100,
+                  pack);
+    return root / name;
+}
+
+int64_t toMillis(Timestamp time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+std::string rawChunkId(const Sha256Digest& digest) {
+    return "raw_" + toHex(digest);
+}
+
+std::optional<Sha256Digest> parseRawChunkId(std::string_view id) {
+    if (id.substr(0, 4) != "raw_") return std::nullopt;
+    return sha256FromHex(id.substr(4));
+}
+
+RawStoreOptions RawStoreOptions::fromConfig(const Config& config) {
+    RawStoreOptions options;
+    options.directory = config.get<std::string>("raw_dir", "");
+    int block_kb = config.get<int>("raw_block_kb", static_cast<int>(options.block_bytes >> 10));
+    options.block_bytes = static_cast<size_t>(std::clamp(block_kb, 1, 1 << 20)) << 10;
+    int pack_mb = config.get<int>("raw_pack_mb", static_cast<int>(options.pack_bytes >> 20));
+    options.pack_bytes = static_cast<size_t>(std::max(pack_mb, 1)) << 20;
+    options.codec = stringToBlockCodec(config.get<std::string>("raw_compression", blockCodecToString(options.codec)));
+    options.sync = config.get<bool>("raw_sync", options.sync);
+    return options;
+}
+
+// === RawStore ===
+
+struct RawStore::Tenant {
+    struct Chunk {
+        uint64_t offset;
+        uint64_t stored_bytes;
+        uint64_t length;
+        int64_t created_ms;
+        uint32_t pack;
+        uint32_t day;
+        uint32_t block_count;
+    };
+
+    std::string name;
+    fs::path root;  // <directory>/tenants/<name>/raw
+    std::unordered_map<Sha256Digest, Chunk, DigestHash> chunks;  // Under RawStore::mutex_
+
+    // Writer state, under RawStore::write_mutex_
+    std::unique_ptr<RawFile> index;
+    uint32_t next_pack = 1;
+    std::shared_ptr<RawFile> pack;
+    uint32_t pack_number = 0;
+    uint32_t pack_day = 0;
+
+    // Open packs by number, the one being written included
+    mutable std::mutex files_mutex;
+    mutable std::unordered_map<uint32_t, std::shared_ptr<RawFile>> files;
+
+    RawChunkInfo describe(const Sha256Digest& digest, const Chunk& chunk) const;
+
+    std::shared_ptr<RawFile> file(uint32_t number, uint32_t day) const {
+        std::lock_guard lock(files_mutex);
+        std::shared_ptr<RawFile>& slot = files[number];
+        if (!slot) slot = std::make_shared<RawFile>(packPath(root, day, number).string(), false);
+        return slot;
+    }
+};
+
+// A chunk record ready to append: header, block table and blocks
+struct RawStore::Encoded {
+    Sha256Digest digest;
+    uint64_t length = 0;
+    uint32_t block_count = 0;
+    std::vector<uint8_t> record;
+};
+
+RawStore::RawStore(RawStoreOptions options, std::shared_ptr<ThreadPool> pool)
+    : options_(std::move(options)), pool_(std::move(pool)) {
+    if (options_.directory.empty()) throw StorageException("Raw chunk store needs a directory");
+    options_.block_bytes = std::clamp<size_t>(options_.block_bytes, 1 << 10, size_t{1} << 30);
+    std::error_code ec;
+    fs::create_directories(fs::path(options_.directory) / "tenants", ec);
+    if (ec) throw StorageException("Cannot create raw chunk directory " + options_.directory + ": " + ec.message());
+    for (const auto& entry : fs::directory_iterator(fs::path(options_.directory) / "tenants")) {
+        if (entry.is_directory() && fs::exists(entry.path() / "raw" / kIndexName)) {
+            loadTenant(entry.path().filename().string());
+        }
+    }
+}
+
+RawStore::~RawStore() = default;
+
+std::string RawStore::tenantName(std::string_view tenant) {
+    if (tenant.empty()) return kDefaultTenant;
+    bool valid = tenant.front() != '.' && std::all_of(tenant.begin(), tenant.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-'
+            || c == '.';
+    });
+    if (!valid) throw std::invalid_argument("Invalid tenant name for the raw chunk store: " + std::string(tenant));
+    return std::string(tenant);
+}
+
+void RawStore::loadTenant(const std::string& name) {
+    auto tenant = std::make_unique<Tenant>();
+    tenant->name = name;
+    tenant->root = fs::path(options_.directory) / "tenants" / name / "raw";
+    fs::path path = tenant->root / kIndexName;
+
+    size_t size;
+    size_t end = 0;
+    {
+        MappedFile file = MappedFile::open(path.string());
+        size = file.size();
+        std::span<const uint8_t> bytes = file.bytes();
+        if (validFileHeader(bytes, kIndexMagic)) {
+            end = sizeof(RawFileHeader);
+            while (size - end >= sizeof(RawIndexRecord)) {
+                RawIndexRecord record;
+                std::memcpy(&record, bytes.data() + end, sizeof(record));
+                if (record.crc != indexRecordCrc(record)) break;
+                Sha256Digest digest;
+                std::memcpy(digest.data(), record.sha256, digest.size());
+                tenant->chunks[digest] = Tenant::Chunk{record.offset,     record.stored_bytes, record.length,
+                                                       record.created_ms, record.pack,         record.day,
+                                                       record.block_count};
+                tenant->next_pack = std::max(tenant->next_pack, record.pack + 1);
+                end += sizeof(record);
+            }
+        }
+    }
+    if (end < size) {
+        // A record the crash left half written; its chunk is rewritten by
+        // the next put of the same content
+        LOG_WARN("Cutting off the torn tail of raw chunk index " + path.string() + " at offset " +
+                 std::to_string(end));
+        fs::resize_file(path, end);
+    }
+    std::unique_lock lock(mutex_);
+    tenants_[name] = std::move(tenant);
+}
+
+const RawStore::Tenant* RawStore::findTenant(const std::string& name) const {
+    auto it = tenants_.find(name);
+    return it == tenants_.end() ? nullptr : it->second.get();
+}
+
+RawStore::Tenant& RawStore::tenantForWrite(const std::string& name) {
+    {
+        std::shared_lock lock(mutex_);
+        auto it = tenants_.find(name);
+        if (it != tenants_.end()) return *it->second;
+    }
+    auto tenant = std::make_unique<Tenant>();
+    tenant->name = name;
+    tenant->root = fs::path(options_.directory) / "tenants" / name / "raw";
+    Tenant& created = *tenant;
+    std::unique_lock lock(mutex_);
+    tenants_[name] = std::move(tenant);
+    return created;
+}
+
+RawStore::Encoded RawStore::encode(std::span<const uint8_t> content, const Sha256Digest& digest) const {
+    Encoded encoded;
+    encoded.digest = digest;
+    encoded.length = content.size();
+    size_t block_bytes = options_.block_bytes;
+    size_t blocks = (content.size() + block_bytes - 1) / block_bytes;
+    encoded.block_count = static_cast<uint32_t>(blocks);
+
+    std::vector<uint8_t>& record = encoded.record;
+    size_t table_offset = sizeof(RawChunkHeader);
+    size_t data_offset = table_offset + blocks * sizeof(RawBlockEntry);
+    record.reserve(data_offset + (options_.codec == BlockCodec::LZ ? lzCompressBound(content.size())
+                                                                    : content.size()));
+    record.resize(data_offset);
+    std::vector<RawBlockEntry> table(blocks);
+    for (size_t b = 0; b < blocks; ++b) {
+        std::span<const uint8_t> block = content.subspan(b * block_bytes, std::min(block_bytes,
+                                                                                   content.size() - b * block_bytes));
+        size_t start = record.size();
+        BlockCodec codec = options_.codec;
+        if (codec == BlockCodec::LZ && lzCompress(block, record) >= block.size()) {
+            // Incompressible: kept as is, so no block grows
+            record.resize(start);
+            codec = BlockCodec::NONE;
+        }
+        if (codec == BlockCodec::NONE) record.insert(record.end(), block.begin(), block.end());
+        table[b].stored_bytes = static_cast<uint32_t>(record.size() - start);
+        table[b].codec = static_cast<uint8_t>(codec);
+        table[b].crc = crc32c(record.data() + start, record.size() - start);
+    }
+    if (blocks > 0) std::memcpy(record.data() + table_offset, table.data(), blocks * sizeof(RawBlockEntry));
+
+    RawChunkHeader header{};
+    header.magic = kChunkMagic;
+    header.block_bytes = static_cast<uint32_t>(block_bytes);
+    header.block_count = encoded.block_count;
+    header.length = content.size();
+    std::memcpy(header.sha256, digest.data(), digest.size());
+    header.crc = chunkCrc(header, {record.data() + table_offset, blocks * sizeof(RawBlockEntry)});
+    std::memcpy(record.data(), &header, sizeof(header));
+    return encoded;
+}
+
+void RawStore::writeChunks(Tenant& tenant, const std::vector<const Encoded*>& chunks, Timestamp created_at) {
+    if (chunks.empty()) return;
+    if (!tenant.index) {
+        std::error_code ec;
+        fs::create_directories(tenant.root, ec);
+        if (ec) throw StorageException("Cannot create " + tenant.root.string() + ": " + ec.message());
+        auto index = std::make_unique<RawFile>((tenant.root / kIndexName).string(), true);
+        if (index->size() == 0) {
+            RawFileHeader header = fileHeader(kIndexMagic);
+            index->append({reinterpret_cast<const uint8_t*>(&header), sizeof(header)});
+            if (options_.sync) syncDirectory(tenant.root.string());
+        }
+        tenant.index = std::move(index);
+    }
+
+    uint32_t day = dayOf(created_at);
+    int64_t created_ms = toMillis(created_at);
+    std::vector<RawIndexRecord> records;
+    std::vector<Tenant::Chunk> located;
+    std::vector<uint8_t> pending;
+    // Writes what is pending to the open pack in one go
+    auto flushPack = [&] {
+        if (!tenant.pack) return;
+        if (!pending.empty()) tenant.pack->append(pending);
+        pending.clear();
+        if (options_.sync) tenant.pack->sync();
+    };
+    for (const Encoded* chunk : chunks) {
+        uint64_t pack_size = tenant.pack ? tenant.pack->size() + pending.size() : 0;
+        if (!tenant.pack || tenant.pack_day != day || pack_size >= options_.pack_bytes) {
+            flushPack();
+            uint32_t number = tenant.next_pack++;
+            fs::path path = packPath(tenant.root, day, number);
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            if (ec) throw StorageException("Cannot create " + path.parent_path().string() + ": " + ec.message());
+            auto pack = std::make_shared<RawFile>(path.string(), true);
+            if (pack->size() == 0) {
+                RawFileHeader header = fileHeader(kPackMagic);
+                pack->append({reinterpret_cast<const uint8_t*>(&header), sizeof(header)});
+                if (options_.sync) syncDirectory(path.parent_path().string());
+            }
+            {
+                std::lock_guard lock(tenant.files_mutex);
+                tenant.files[number] = pack;
+            }
+            tenant.pack = std::move(pack);
+            tenant.pack_number = number;
+            tenant.pack_day = day;
+        }
+
+        Tenant::Chunk location{tenant.pack->size() + pending.size(),
+                               chunk->record.size(),
+                               chunk->length,
+                               created_ms,
+                               tenant.pack_number,
+                               day,
+                               chunk->block_count};
+        pending.insert(pending.end(), chunk->record.begin(), chunk->record.end());
+
+        RawIndexRecord record{};
+        std::memcpy(record.sha256, chunk->digest.data(), chunk->digest.size());
+        record.offset = location.offset;
+        record.stored_bytes = location.stored_bytes;
+        record.length = location.length;
+        record.created_ms = created_ms;
+        record.pack = location.pack;
+        record.day = day;
+        record.block_count = location.block_count;
+        record.crc = indexRecordCrc(record);
+        records.push_back(record);
+        located.push_back(location);
+    }
+    flushPack();
+
+    // Indexed only once the packs are durable, so a record never points at
+    // bytes a crash can lose
+    tenant.index->append({reinterpret_cast<const uint8_t*>(records.data()), records.size() * sizeof(RawIndexRecord)});
+    if (options_.sync) tenant.index->sync();
+
+    std::unique_lock lock(mutex_);
+    for (size_t i = 0; i < chunks.size(); ++i) tenant.chunks[chunks[i]->digest] = located[i];
+}
+
+RawPutResult RawStore::put(std::string_view tenant, std::span<const uint8_t> content, Timestamp created_at) {
+    std::vector<std::span<const uint8_t>> contents{content};
+    return ingest(tenant, contents, created_at)[0];
+}
+
+std::vector<RawPutResult> RawStore::ingest(std::string_view tenant,
+                                           const std::vector<std::span<const uint8_t>>& contents,
+                                           Timestamp created_at, RawIngestStats* stats) {
+    std::string name = tenantName(tenant);
+    RawIngestStats batch;
+    auto started = Clock::now();
+    auto forEach = [this](size_t count, const std::function<void(size_t)>& fn) {
+        if (pool_ && count > 1) {
+            pool_->parallelFor(count, [&](size_t task, size_t) { fn(task); });
+        } else {
+            for (size_t i = 0; i < count; ++i) fn(i);
+        }
+    };
+
+    std::vector<RawPutResult> results(contents.size());
+    forEach(contents.size(), [&](size_t i) { results[i].sha256 = sha256(contents[i]); });
+    batch.hash_seconds = secondsSince(started);
+
+    // The first occurrence of each digest the tenant does not have yet
+    std::vector<size_t> fresh;
+    {
+        std::shared_lock lock(mutex_);
+        const Tenant* existing = findTenant(name);
+        std::unordered_set<Sha256Digest, DigestHash> seen;
+        for (size_t i = 0; i < contents.size(); ++i) {
+            batch.bytes_in += contents[i].size();
+            bool stored = existing && existing->chunks.count(results[i].sha256);
+            results[i].deduplicated = stored || !seen.insert(results[i].sha256).second;
+            if (!results[i].deduplicated) fresh.push_back(i);
+        }
+    }
+
+    auto compress_started = Clock::now();
+    std::vector<Encoded> encoded(fresh.size());
+    forEach(fresh.size(), [&](size_t i) { encoded[i] = encode(contents[fresh[i]], results[fresh[i]].sha256); });
+    batch.compress_seconds = secondsSince(compress_started);
+
+    if (!encoded.empty()) {
+        auto write_started = Clock::now();
+        std::lock_guard write_lock(write_mutex_);
+        Tenant& target = tenantForWrite(name);
+        std::vector<const Encoded*> chunks;
+        {
+            // Another writer may have stored some in the meantime
+            std::shared_lock lock(mutex_);
+            for (size_t i = 0; i < encoded.size(); ++i) {
+                if (target.chunks.count(encoded[i].digest)) {
+                    results[fresh[i]].deduplicated = true;
+                } else {
+                    chunks.push_back(&encoded[i]);
+                    batch.bytes_stored += encoded[i].record.size();
+                }
+            }
+        }
+        writeChunks(target, chunks, created_at);
+        batch.write_seconds = secondsSince(write_started);
+    }
+
+    batch.chunks = contents.size();
+    batch.deduplicated = static_cast<uint64_t>(
+        std::count_if(results.begin(), results.end(), [](const RawPutResult& result) { return result.deduplicated; }));
+    batch.seconds = secondsSince(started);
+    {
+        std::lock_guard lock(stats_mutex_);
+        stats_.chunks += batch.chunks;
+        stats_.deduplicated += batch.deduplicated;
+        stats_.bytes_in += batch.bytes_in;
+        stats_.bytes_stored += batch.bytes_stored;
+        stats_.hash_seconds += batch.hash_seconds;
+        stats_.compress_seconds += batch.compress_seconds;
+        stats_.write_seconds += batch.write_seconds;
+        stats_.seconds += batch.seconds;
+    }
+    if (stats) *stats = batch;
+    return results;
+}
+
+bool RawStore::contains(std::string_view tenant, const Sha256Digest& digest) const {
+    std::string name = tenantName(tenant);
+    std::shared_lock lock(mutex_);
+    const Tenant* found = findTenant(name);
+    return found && found->chunks.count(digest);
+}
+
+RawChunkInfo RawStore::Tenant::describe(const Sha256Digest& digest, const Chunk& chunk) const {
+    RawChunkInfo info;
+    info.sha256 = digest;
+    info.length = chunk.length;
+    info.stored_bytes = chunk.stored_bytes;
+    info.created_at = Timestamp(std::chrono::milliseconds(chunk.created_ms));
+    info.pack = packPath(root, chunk.day, chunk.pack).string();
+    return info;
+}
+
+std::optional<RawChunkInfo> RawStore::info(std::string_view tenant, const Sha256Digest& digest) const {
+    std::string name = tenantName(tenant);
+    std::shared_lock lock(mutex_);
+    const Tenant* found = findTenant(name);
+    if (!found) return std::nullopt;
+    auto it = found->chunks.find(digest);
+    if (it == found->chunks.end()) return std::nullopt;
+    return found->describe(digest, it->second);
+}
+
+std::vector<RawChunkInfo> RawStore::list(std::string_view tenant, Timestamp since) const {
+    std::string name = tenantName(tenant);
+    int64_t since_ms = toMillis(since);
+    std::vector<RawChunkInfo> chunks;
+    std::shared_lock lock(mutex_);
+    const Tenant* found = findTenant(name);
+    if (!found) return chunks;
+    for (const auto& [digest, chunk] : found->chunks) {
+        if (chunk.created_ms >= since_ms) chunks.push_back(found->describe(digest, chunk));
+    }
+    lock.unlock();
+    std::sort(chunks.begin(), chunks.end(), [](const RawChunkInfo& a, const RawChunkInfo& b) {
+        return a.created_at != b.created_at ? a.created_at < b.created_at : a.sha256 < b.sha256;
+    });
+    return chunks;
+}
+
+std::vector<uint8_t> RawStore::read(std::string_view tenant, const Sha256Digest& digest) const {
+    return readRange(tenant, digest, 0, UINT64_MAX);
+}
+
+std::vector<uint8_t> RawStore::read(std::string_view tenant, const RawRef& ref) const {
+    return readRange(tenant, ref.chunk, ref.offset, ref.length);
+}
+
+std::vector<uint8_t> RawStore::readRange(std::string_view tenant, const Sha256Digest& digest, uint64_t offset,
+                                         uint64_t length) const {
+    std::string name = tenantName(tenant);
+    const Tenant* owner = nullptr;
+    Tenant::Chunk chunk;
+    {
+        std::shared_lock lock(mutex_);
+        owner = findTenant(name);
+        if (!owner || !owner->chunks.count(digest)) {
+            throw StorageException("Unknown raw chunk " + rawChunkId(digest) + " of tenant " + name);
+        }
+        // Tenants are never dropped, so owner outlives the lock
+        chunk = owner->chunks.at(digest);
+    }
+    offset = std::min(offset, chunk.length);
+    length = std::min(length, chunk.length - offset);
+    std::shared_ptr<RawFile> file = owner->file(chunk.pack, chunk.day);
+    std::string where = rawChunkId(digest) + " in " + file->path();
+
+    size_t table_bytes = size_t{chunk.block_count} * sizeof(RawBlockEntry);
+    std::vector<uint8_t> head(sizeof(RawChunkHeader) + table_bytes);
+    if (head.size() > chunk.stored_bytes) throw StorageException("Raw chunk index entry of " + where + " is damaged");
+    file->readAt(chunk.offset, head);
+    RawChunkHeader header;
+    std::memcpy(&header, head.data(), sizeof(header));
+    std::span<const uint8_t> table_bytes_span(head.data() + sizeof(header), table_bytes);
+    if (header.magic != kChunkMagic || header.block_count != chunk.block_count || header.length != chunk.length
+        || std::memcmp(header.sha256, digest.data(), digest.size()) != 0 || header.block_bytes == 0
+        || header.crc != chunkCrc(header, table_bytes_span)) {
+        throw StorageException("Raw chunk " + where + " has a damaged header");
+    }
+    std::vector<uint8_t> out(length);
+    if (length == 0) return out;
+
+    std::vector<RawBlockEntry> table(chunk.block_count);
+    std::memcpy(table.data(), table_bytes_span.data(), table_bytes);
+    uint64_t block_bytes = header.block_bytes;
+    size_t first = static_cast<size_t>(offset / block_bytes);
+    size_t last = static_cast<size_t>((offset + length - 1) / block_bytes);
+    if (last >= table.size()) throw StorageException("Raw chunk " + where + " has too few blocks");
+    uint64_t skipped = 0;
+    for (size_t b = 0; b < first; ++b) skipped += table[b].stored_bytes;
+    uint64_t needed = 0;
+    for (size_t b = first; b <= last; ++b) needed += table[b].stored_bytes;
+    if (head.size() + skipped + needed > chunk.stored_bytes) {
+        throw StorageException("Raw chunk " + where + " has a damaged block table");
+    }
+
+    // The overlapped blocks are contiguous: one read
+    std::vector<uint8_t> stored(needed);
+    file->readAt(chunk.offset + head.size() + skipped, stored);
+    std::vector<uint8_t> scratch;
+    size_t position = 0;
+    for (size_t b = first; b <= last; ++b) {
+        std::span<const uint8_t> block(stored.data() + position, table[b].stored_bytes);
+        position += block.size();
+        if (crc32c(block) != table[b].crc) {
+            throw StorageException("Raw chunk " + where + " fails its checksum in block " + std::to_string(b));
+        }
+        uint64_t block_start = b * block_bytes;
+        uint64_t block_length = std::min(block_bytes, chunk.length - block_start);
+        uint64_t from = std::max(offset, block_start);
+        uint64_t to = std::min(offset + length, block_start + block_length);
+        uint8_t* target = out.data() + (from - offset);
+        auto codec = static_cast<BlockCodec>(table[b].codec);
+        if (codec == BlockCodec::NONE) {
+            if (block.size() != block_length) throw StorageException("Raw chunk " + where + " has a short block");
+            std::memcpy(target, block.data() + (from - block_start), to - from);
+        } else if (codec == BlockCodec::LZ) {
+            if (from == block_start && to == block_start + block_length) {
+                lzDecompress(block, {target, block_length});
+            } else {
+                scratch.resize(block_length);
+                lzDecompress(block, scratch);
+                std::memcpy(target, scratch.data() + (from - block_start), to - from);
+            }
+        } else {
+            throw StorageException("Raw chunk " + where + " uses unknown codec " + std::to_string(table[b].codec));
+        }
+    }
+    return out;
+}
+
+size_t RawStore::chunkCount() const {
+    std::shared_lock lock(mutex_);
+    size_t count = 0;
+    for (const auto& [name, tenant] : tenants_) count += tenant->chunks.size();
+    return count;
+}
+
+std::vector<std::string> RawStore::tenants() const {
+    std::shared_lock lock(mutex_);
+    std::vector<std::string> names;
+    for (const auto& [name, tenant] : tenants_) names.push_back(name);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+RawIngestStats RawStore::stats() const {
+    std::lock_guard lock(stats_mutex_);
+    return stats_;
+}
+
+} // namespace memory::core
@@ -0,0 +1,194 @@
+#include "memory/core/section_file.h"
+#include "memory/core/crc32.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <cstring>
+
+namespace memory::core {
+
+namespace {
+
+constexpr size_t kBufferBytes = size_t{1} << 20;
+
+// Follows the FileHeader
+struct SectionDirectory {
+    uint32_t count;
+    uint32_t crc;  // Over the first count entries
+    SectionEntry entries[kMaxSections];
+};
+static_assert(sizeof(SectionDirectory) == 8 + kMaxSections * sizeof(SectionEntry),
+              "SectionDirectory layout is part of the on-disk format");
+
+constexpr size_t kFirstSection =
+    (sizeof(FileHeader) + sizeof(SectionDirectory) + kSectionAlign - 1) / kSectionAlign * kSectionAlign;
+
+uint32_t directoryCrc(const SectionDirectory& directory) {
+    return crc32c(directory.entries, directory.count * sizeof(SectionEntry));
+}
+
+std::string tagName(uint32_t tag) {
+    std::string name(4, ' ');
+    for (size_t i = 0; i < 4; ++i) name[i] = static_cast<char>((tag >> (8 * i)) & 0xFF);
+    return name;
+}
+
+} // namespace
+
+// === SectionFileWriter ===
+
+SectionFileWriter::SectionFileWriter(const std::string& path, uint32_t magic, uint16_t version, uint16_t flags)
+    : file_(path), magic_(magic), version_(version), flags_(flags), offset_(kFirstSection) {
+    // Header and directory are written last, over these zeros
+    std::vector<uint8_t> zeros(kFirstSection, 0);
+    file_.append(zeros);
+    buffer_.reserve(kBufferBytes);
+}
+
+void SectionFileWriter::begin(uint32_t tag) {
+    if (sections_.size() == kMaxSections) {
+        throw StorageException("Too many sections in " + file_.tmpPath() + ": " + std::to_string(kMaxSections));
+    }
+    pad(kSectionAlign);
+    sections_.push_back(SectionEntry{tag, 0, offset_, 0});
+}
+
+void SectionFileWriter::append(const void* data, size_t bytes) {
+    if (sections_.empty()) throw StorageException("Section data before begin() in " + file_.tmpPath());
+    const auto* source = static_cast<const uint8_t*>(data);
+    while (bytes > 0) {
+        size_t chunk = std::min(bytes, kBufferBytes - buffer_.size());
+        buffer_.insert(buffer_.end(), source, source + chunk);
+        source += chunk;
+        bytes -= chunk;
+        offset_ += chunk;
+        sections_.back().bytes += chunk;
+        if (buffer_.size() == kBufferBytes) flushBuffer();
+    }
+}
+
+void SectionFileWriter::appendZeros(size_t bytes) {
+    static const uint8_t zeros[4096] = {};
+    while (bytes > 0) {
+        size_t chunk = std::min(bytes, sizeof(zeros));
+        append(zeros, chunk);
+        bytes -= chunk;
+    }
+}
+
+void SectionFileWriter::pad(size_t alignment) {
+    size_t padding = static_cast<size_t>((alignment - offset_ % alignment) % alignment);
+    buffer_.resize(buffer_.size() + padding, 0);
+    offset_ += padding;
+    if (buffer_.size() >= kBufferBytes) flushBuffer();
+}
+
+void SectionFileWriter::flushBuffer() {
+    file_.append(buffer_);
+    buffer_.clear();
+}
+
+void SectionFileWriter::commit() {
+    flushBuffer();
+    SectionDirectory directory{};
+    directory.count = static_cast<uint32_t>(sections_.size());
+    std::copy(sections_.begin(), sections_.end(), directory.entries);
+    directory.crc = directoryCrc(directory);
+    file_.writeAt(sizeof(FileHeader), std::span(reinterpret_cast<const uint8_t*>(&directory), sizeof(directory)));
+
+    // The payload CRC needs the directory first, so it is taken over the
+    // written file; the pages are still cached
+    uint32_t payload_crc;
+    {
+        MappedFile written = MappedFile::open(file_.tmpPath());
+        payload_crc = crc32c(written.bytes().subspan(sizeof(FileHeader)));
+    }
+    FileHeader header{};
+    header.magic = magic_;
+    header.version = version_;
+    header.flags = flags_;
+    header.payload_bytes = offset_ - sizeof(FileHeader);
+    header.payload_crc = payload_crc;
+    header.header_crc = crc32c(&header, offsetof(FileHeader, header_crc));
+    file_.writeAt(0, std::span(reinterpret_cast<const uint8_t*>(&header), sizeof(header)));
+    file_.commit();
+}
+
+// === SectionFile ===
+
+SectionFile SectionFile::open(const std::string& path, uint32_t magic, uint16_t version, const std::string& what,
+                              MapMode mode) {
+    SectionFile file;
+    file.what_ = what;
+    file.file_ = MappedFile::open(path, mode);
+    auto image = file.file_.bytes();
+    if (image.size() < kFirstSection) throw StorageException(what + ": truncated header");
+
+    FileHeader header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    if (header.header_crc != crc32c(&header, offsetof(FileHeader, header_crc))) {
+        throw StorageException(what + ": header checksum mismatch");
+    }
+    if (header.magic != magic) throw StorageException(what + ": bad magic");
+    if (header.version != version) {
+        throw StorageException(what + ": unsupported version " + std::to_string(header.version));
+    }
+    if (header.payload_bytes != image.size() - sizeof(FileHeader)) {
+        throw StorageException(what + ": file is " + std::to_string(image.size()) + " bytes, header says " +
+                               std::to_string(header.payload_bytes + sizeof(FileHeader)));
+    }
+
+    SectionDirectory directory;
+    std::memcpy(&directory, image.data() + sizeof(FileHeader), sizeof(directory));
+    if (directory.count > kMaxSections || directory.crc != directoryCrc(directory)) {
+        throw StorageException(what + ": section directory checksum mismatch");
+    }
+    for (uint32_t i = 0; i < directory.count; ++i) {
+        const SectionEntry& entry = directory.entries[i];
+        if (entry.offset % kSectionAlign != 0 || entry.offset < kFirstSection || entry.offset > image.size() ||
+            entry.bytes > image.size() - entry.offset) {
+            throw StorageException(what + ": section " + tagName(entry.tag) + " out of bounds");
+        }
+    }
+    file.sections_.assign(directory.entries, directory.entries + directory.count);
+    file.flags_ = header.flags;
+    file.payload_crc_ = header.payload_crc;
+    return file;
+}
+
+const SectionEntry* SectionFile::find(uint32_t tag) const {
+    for (const SectionEntry& entry : sections_) {
+        if (entry.tag == tag) return &entry;
+    }
+    return nullptr;
+}
+
+std::span<const uint8_t> SectionFile::section(uint32_t tag) const {
+    const SectionEntry* entry = find(tag);
+    if (!entry) throw StorageException(what_ + ": missing section " + tagName(tag));
+    return file_.bytes().subspan(entry->offset, entry->bytes);
+}
+
+void SectionFile::checkElements(uint32_t tag, size_t bytes, size_t element) const {
+    if (bytes % element != 0) {
+        throw StorageException(what_ + ": section " + tagName(tag) + " is not a whole number of " +
+                               std::to_string(element) + "-byte elements");
+    }
+}
+
+void SectionFile::checkWritable() const {
+    if (!file_.mutableData()) throw StorageException(what_ + ": not mapped for writing");
+}
+
+void SectionFile::advise(uint32_t tag, Access access, size_t offset, size_t length) const {
+    const SectionEntry* entry = find(tag);
+    if (!entry || offset >= entry->bytes) return;
+    file_.advise(entry->offset + offset, std::min<uint64_t>(length, entry->bytes - offset), access);
+}
+
+void SectionFile::verify() const {
+    if (crc32c(file_.bytes().subspan(sizeof(FileHeader))) != payload_crc_) {
+        throw StorageException(what_ + ": payload checksum mismatch");
+    }
+}
+
+} // namespace memory::core
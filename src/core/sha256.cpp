@@ -0,0 +1,231 @@
+#include "memory/core/sha256.h"
+#include "memory/core/cpu_features.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(MEMORY_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+namespace memory::core {
+
+namespace {
+
+alignas(16) constexpr uint32_t kRound[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr uint32_t kInitial[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+inline uint32_t loadBigEndian(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+         | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+void blocksScalar(uint32_t* state, const uint8_t* data, size_t count) {
+    for (; count > 0; --count, data += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) w[i] = loadBigEndian(data + 4 * i);
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + kRound[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(MEMORY_ARCH_X86)
+// Four rounds per iteration: sha256rnds2 does two, on the state split into
+// ABEF and CDGH; sha256msg1/msg2 extend the message schedule four words at
+// a time, W[i % 4] holding words 4i..4i+3.
+MEMORY_TARGET("sha,sse4.1")
+void blocksShaNi(uint32_t* state, const uint8_t* data, size_t count) {
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    __m128i cdgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    __m128i abef = _mm_alignr_epi8(tmp, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, tmp, 0xF0);
+
+    for (; count > 0; --count, data += 64) {
+        __m128i abef_saved = abef;
+        __m128i cdgh_saved = cdgh;
+        __m128i w[4];
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 16
+#endif
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4) w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + i), byte_swap);
+            __m128i message = _mm_add_epi32(w[i % 4], _mm_load_si128(reinterpret_cast<const __m128i*>(kRound) + i));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+            if (i >= 3 && i <= 14) {
+                __m128i& next = w[(i + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(w[i % 4], w[(i + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, w[i % 4]);
+            }
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0E));
+            if (i >= 1 && i <= 12) w[(i + 3) % 4] = _mm_sha256msg1_epu32(w[(i + 3) % 4], w[i % 4]);
+        }
+        abef = _mm_add_epi32(abef, abef_saved);
+        cdgh = _mm_add_epi32(cdgh, cdgh_saved);
+    }
+
+    tmp = _mm_shuffle_epi32(abef, 0x1B);
+    cdgh = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(tmp, cdgh, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(cdgh, tmp, 8));
+}
+#define MEMORY_HAVE_SHA_NI 1
+#endif
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+bool sha256Supported(Sha256Impl impl) {
+    switch (impl) {
+        case Sha256Impl::SCALAR: return true;
+#if defined(MEMORY_HAVE_SHA_NI)
+        case Sha256Impl::SHA_NI: return cpuFeatures().sha && cpuFeatures().sse42;
+#endif
+        default: return false;
+    }
+}
+
+Sha256Impl bestSha256Impl() {
+    static const Sha256Impl best = sha256Supported(Sha256Impl::SHA_NI) && bestSimdLevel() != SimdLevel::SCALAR
+                                       ? Sha256Impl::SHA_NI
+                                       : Sha256Impl::SCALAR;
+    return best;
+}
+
+// === Sha256 ===
+
+Sha256::Sha256(Sha256Impl impl) : blocks_(blocksScalar) {
+#if defined(MEMORY_HAVE_SHA_NI)
+    if (impl == Sha256Impl::SHA_NI && sha256Supported(impl)) blocks_ = blocksShaNi;
+#else
+    (void)impl;
+#endif
+    reset();
+}
+
+void Sha256::reset() {
+    std::memcpy(state_, kInitial, sizeof(state_));
+    buffered_ = 0;
+    length_ = 0;
+}
+
+Sha256& Sha256::update(const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    length_ += size;
+    if (buffered_ > 0) {
+        size_t take = std::min(size, sizeof(buffer_) - buffered_);
+        std::memcpy(buffer_ + buffered_, p, take);
+        buffered_ += take;
+        p += take;
+        size -= take;
+        if (buffered_ < sizeof(buffer_)) return *this;
+        blocks_(state_, buffer_, 1);
+        buffered_ = 0;
+    }
+    // Whole blocks straight from the input
+    if (size >= 64) {
+        blocks_(state_, p, size / 64);
+        p += size & ~size_t{63};
+        size &= 63;
+    }
+    if (size > 0) std::memcpy(buffer_, p, size);
+    buffered_ = size;
+    return *this;
+}
+
+Sha256Digest Sha256::finish() {
+    uint64_t bits = length_ * 8;
+    buffer_[buffered_++] = 0x80;
+    if (buffered_ > 56) {
+        std::memset(buffer_ + buffered_, 0, sizeof(buffer_) - buffered_);
+        blocks_(state_, buffer_, 1);
+        buffered_ = 0;
+    }
+    std::memset(buffer_ + buffered_, 0, 56 - buffered_);
+    for (int i = 0; i < 8; ++i) buffer_[56 + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    blocks_(state_, buffer_, 1);
+
+    Sha256Digest digest;
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<uint8_t>(state_[i] >> 24);
+        digest[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        digest[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        digest[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+    }
+    reset();
+    return digest;
+}
+
+Sha256Digest sha256(const void* data, size_t size) {
+    return Sha256().update(data, size).finish();
+}
+
+std::string toHex(const Sha256Digest& digest) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string hex(digest.size() * 2, '0');
+    for (size_t i = 0; i < digest.size(); ++i) {
+        hex[2 * i] = kDigits[digest[i] >> 4];
+        hex[2 * i + 1] = kDigits[digest[i] & 0x0F];
+    }
+    return hex;
+}
+
+std::optional<Sha256Digest> sha256FromHex(std::string_view hex) {
+    Sha256Digest digest;
+    if (hex.size() != digest.size() * 2) return std::nullopt;
+    for (size_t i = 0; i < digest.size(); ++i) {
+        int high = hexValue(hex[2 * i]);
+        int low = hexValue(hex[2 * i + 1]);
+        if (high < 0 || low < 0) return std::nullopt;
+        digest[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return digest;
+}
+
+} // namespace memory::core
@@ -0,0 +1,46 @@
+#include "memory/core/string_interner.h"
+#include <algorithm>
+#include <cstring>
+
+namespace memory::core {
+
+uint32_t StringInterner::intern(std::string_view str) {
+    auto it = ids_.find(str);
+    if (it != ids_.end()) return it->second;
+
+    // The first string needs a chunk even when it is empty
+    if (chunks_.empty() || chunk_used_ + str.size() > kChunkBytes) {
+        chunks_.push_back(std::make_unique<char[]>(std::max(kChunkBytes, str.size())));
+        chunk_used_ = 0;
+    }
+    char* stored = chunks_.back().get() + chunk_used_;
+    std::memcpy(stored, str.data(), str.size());
+    chunk_used_ += str.size();
+
+    uint32_t id = static_cast<uint32_t>(strings_.size());
+    strings_.emplace_back(stored, str.size());
+    ids_.emplace(strings_.back(), id);
+    return id;
+}
+
+uint32_t StringInterner::find(std::string_view str) const {
+    auto it = ids_.find(str);
+    return it != ids_.end() ? it->second : kUnknownId;
+}
+
+void StringInterner::clear() {
+    // Keep one chunk around for the next batch of strings
+    if (chunks_.size() > 1) {
+        chunks_.resize(1);
+    }
+    chunk_used_ = chunks_.empty() ? kChunkBytes : 0;
+    strings_.clear();
+    ids_.clear();
+}
+
+size_t StringInterner::memoryBytes() const {
+    return chunks_.size() * kChunkBytes + strings_.capacity() * sizeof(std::string_view)
+         + ids_.size() * (sizeof(std::string_view) + sizeof(uint32_t) + sizeof(void*) * 2);
+}
+
+} // namespace memory::core
@@ -0,0 +1,93 @@
+#include "memory/core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace memory::core {
+
+ThreadPool::ThreadPool(size_t threads) {
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;  // Stopping and drained
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallelFor(size_t tasks, const std::function<void(size_t, size_t)>& fn) {
+    if (tasks == 0) return;
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        size_t tasks = 0;
+        const std::function<void(size_t, size_t)>* fn = nullptr;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    state->tasks = tasks;
+    state->fn = &fn;
+
+    // Claims tasks until none are left. Helpers that start after the caller
+    // has claimed everything return without touching fn.
+    auto run = [](State& s, size_t worker) {
+        size_t finished = 0;
+        for (size_t task; (task = s.next.fetch_add(1)) < s.tasks; ++finished) {
+            try {
+                (*s.fn)(task, worker);
+            } catch (...) {
+                std::lock_guard lock(s.mutex);
+                if (!s.error) s.error = std::current_exception();
+            }
+        }
+        if (finished > 0 && s.done.fetch_add(finished) + finished == s.tasks) {
+            std::lock_guard lock(s.mutex);
+            s.cv.notify_all();
+        }
+    };
+
+    size_t helpers = std::min(workers_.size(), tasks - 1);
+    for (size_t h = 1; h <= helpers; ++h) {
+        enqueue([state, run, h] { run(*state, h); });
+    }
+    run(*state, 0);
+
+    std::unique_lock lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == tasks; });
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+} // namespace memory::core
@@ -0,0 +1,438 @@
+#include "memory/core/wal.h"
+#include "memory/core/config.h"
+#include "memory/core/crc32.h"
+#include "memory/core/errors.h"
+#include "memory/core/file_format.h"
+#include "memory/core/logger.h"
+#include "memory/core/mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace memory::core {
+
+namespace {
+
+constexpr uint32_t kWalMagic = makeMagic('W', 'L', 'O', 'G');
+constexpr size_t kSegmentNameLength = 24;  // 20 digits + ".wal"
+
+std::string lastError() {
+#if defined(_WIN32)
+    return "error " + std::to_string(::GetLastError());
+#else
+    return std::strerror(errno);
+#endif
+}
+
+std::string segmentName(uint64_t first_lsn) {
+    char name[kSegmentNameLength + 1];
+    std::snprintf(name, sizeof(name), "%020llu.wal", static_cast<unsigned long long>(first_lsn));
+    return name;
+}
+
+bool parseSegmentName(const std::string& name, uint64_t& first_lsn) {
+    if (name.size() != kSegmentNameLength || name.compare(20, 4, ".wal") != 0) return false;
+    first_lsn = 0;
+    for (size_t i = 0; i < 20; ++i) {
+        if (name[i] < '0' || name[i] > '9') return false;
+        first_lsn = first_lsn * 10 + static_cast<uint64_t>(name[i] - '0');
+    }
+    return true;
+}
+
+uint32_t headerCrc(const WalSegmentHeader& header) {
+    return crc32c(&header, offsetof(WalSegmentHeader, header_crc));
+}
+
+uint32_t recordCrc(const WalRecordHeader& header, const uint8_t* payload) {
+    uint32_t crc = crc32c(reinterpret_cast<const uint8_t*>(&header) + sizeof(header.crc),
+                          sizeof(header) - sizeof(header.crc));
+    return crc32c(payload, header.length, crc);
+}
+
+bool validHeader(std::span<const uint8_t> file, uint64_t first_lsn) {
+    if (file.size() < sizeof(WalSegmentHeader)) return false;
+    WalSegmentHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    return header.magic == kWalMagic && header.version == kWalVersion && header.first_lsn == first_lsn
+        && header.header_crc == headerCrc(header);
+}
+
+// Visits the records of a segment up to the first invalid one: short,
+// out of sequence or failing its CRC. Returns where that one starts.
+template <typename Visit>
+size_t scanRecords(std::span<const uint8_t> file, uint64_t first_lsn, Visit&& visit) {
+    size_t offset = sizeof(WalSegmentHeader);
+    uint64_t lsn = first_lsn;
+    while (file.size() - offset >= sizeof(WalRecordHeader)) {
+        WalRecordHeader header;
+        std::memcpy(&header, file.data() + offset, sizeof(header));
+        if (header.lsn != lsn || header.length > file.size() - offset - sizeof(header)) break;
+        const uint8_t* payload = file.data() + offset + sizeof(header);
+        if (recordCrc(header, payload) != header.crc) break;
+        visit(WalRecord{lsn, static_cast<WalStream>(header.stream), header.op, {payload, header.length}});
+        offset += sizeof(header) + header.length;
+        ++lsn;
+    }
+    return offset;
+}
+
+} // namespace
+
+WalOptions WalOptions::fromConfig(const Config& config) {
+    WalOptions options;
+    options.sync = config.get<bool>("wal_sync", options.sync);
+    options.group_commit = config.get<bool>("wal_group_commit", options.group_commit);
+    int segment_mb = config.get<int>("wal_segment_mb", static_cast<int>(options.segment_bytes >> 20));
+    options.segment_bytes = static_cast<size_t>(std::max(segment_mb, 1)) << 20;
+    return options;
+}
+
+// === WriteAheadLog ===
+
+WriteAheadLog::WriteAheadLog(std::string directory, WalOptions options)
+    : directory_(std::move(directory)), options_(options) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) throw StorageException("Cannot create WAL directory " + directory_ + ": " + ec.message());
+    recover();
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    try {
+        flush();
+    } catch (const StorageException&) {
+        // Already reported to the writers waiting on these records
+    }
+    if (handle_ != -1) {
+        try {
+            closeSegment();
+        } catch (const StorageException&) {
+        }
+    }
+}
+
+void WriteAheadLog::recover() {
+    std::vector<std::pair<uint64_t, std::string>> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+        uint64_t first_lsn = 0;
+        if (entry.is_regular_file() && parseSegmentName(entry.path().filename().string(), first_lsn)) {
+            files.emplace_back(first_lsn, entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        const auto& [first_lsn, path] = files[i];
+        bool last = i + 1 == files.size();
+        if (!segments_.empty() && first_lsn != next_lsn_) {
+            throw StorageException("WAL segment " + path + " starts at LSN " + std::to_string(first_lsn) +
+                                   ", expected " + std::to_string(next_lsn_));
+        }
+        next_lsn_ = first_lsn;
+        size_t size;
+        size_t end = 0;
+        uint64_t records = 0;
+        {
+            MappedFile file = MappedFile::open(path);
+            size = file.size();
+            if (validHeader(file.bytes(), first_lsn)) {
+                end = scanRecords(file.bytes(), first_lsn, [&](const WalRecord&) { ++records; });
+            }
+        }
+        if (end < size && !last) {
+            throw StorageException("WAL segment " + path + " is damaged at offset " + std::to_string(end));
+        }
+        next_lsn_ = first_lsn + records;
+        if (records == 0) {
+            // A segment the crash left without a complete record
+            std::filesystem::remove(path);
+            continue;
+        }
+        if (end < size) {
+            LOG_WARN("Cutting off the torn tail of WAL segment " + path + " at offset " + std::to_string(end));
+            std::filesystem::resize_file(path, end);
+        }
+        segments_.push_back(Segment{first_lsn, end, path});
+    }
+    written_lsn_ = next_lsn_ - 1;
+    durable_lsn_ = written_lsn_;
+}
+
+uint64_t WriteAheadLog::append(WalStream stream, uint8_t op, std::span<const uint8_t> payload) {
+    WalRecordHeader header{};
+    header.length = static_cast<uint32_t>(payload.size());
+    header.stream = static_cast<uint8_t>(stream);
+    header.op = op;
+
+    std::lock_guard lock(mutex_);
+    checkUsableLocked();
+    header.lsn = next_lsn_++;
+    header.crc = recordCrc(header, payload.data());
+    size_t offset = pending_.size();
+    pending_.resize(offset + sizeof(header) + payload.size());
+    std::memcpy(pending_.data() + offset, &header, sizeof(header));
+    if (!payload.empty()) std::memcpy(pending_.data() + offset + sizeof(header), payload.data(), payload.size());
+    ++stats_.records;
+    stats_.bytes += sizeof(header) + payload.size();
+
+    if (!options_.group_commit) {
+        // Every record pays for its own write and sync, under the lock
+        try {
+            writeBatch(pending_, header.lsn, options_.sync);
+        } catch (const StorageException& e) {
+            failed_ = true;
+            failure_ = e.what();
+            throw;
+        }
+        pending_.clear();
+        ++stats_.writes;
+        stats_.syncs += options_.sync;
+        written_lsn_ = header.lsn;
+        if (options_.sync) durable_lsn_ = header.lsn;
+        publishSegmentLocked();
+    }
+    return header.lsn;
+}
+
+void WriteAheadLog::commit(uint64_t lsn) {
+    std::unique_lock lock(mutex_);
+    lsn = std::min(lsn, next_lsn_ - 1);
+    while (true) {
+        checkUsableLocked();
+        if (written_lsn_ >= lsn && (!options_.sync || durable_lsn_ >= lsn)) return;
+        if (leader_) {
+            written_cv_.wait(lock);
+            continue;
+        }
+        // Lead: write everything appended so far, including records of
+        // writers that arrive while this batch is on its way
+        leader_ = true;
+        std::vector<uint8_t> batch = std::move(pending_);
+        pending_ = std::move(spare_);
+        pending_.clear();
+        uint64_t first = written_lsn_ + 1;
+        uint64_t last = next_lsn_ - 1;
+        lock.unlock();
+        try {
+            writeBatch(batch, first, options_.sync);
+        } catch (const StorageException& e) {
+            lock.lock();
+            failed_ = true;
+            failure_ = e.what();
+            leader_ = false;
+            written_cv_.notify_all();
+            throw;
+        }
+        lock.lock();
+        ++stats_.writes;
+        stats_.syncs += options_.sync;
+        written_lsn_ = last;
+        if (options_.sync) durable_lsn_ = last;
+        publishSegmentLocked();
+        spare_ = std::move(batch);
+        leader_ = false;
+        written_cv_.notify_all();
+    }
+}
+
+void WriteAheadLog::flush() {
+    commit(lastLsn());
+}
+
+void WriteAheadLog::checkUsableLocked() const {
+    if (failed_) throw StorageException("WAL " + directory_ + " stopped after a failed write: " + failure_);
+}
+
+void WriteAheadLog::writeBatch(const std::vector<uint8_t>& batch, uint64_t first_lsn, bool sync) {
+    if (handle_ != -1 && segment_bytes_ >= options_.segment_bytes) closeSegment();
+    if (handle_ == -1) openSegment(first_lsn);
+    const std::string& path = segment_path_;
+    size_t written = 0;
+#if defined(_WIN32)
+    HANDLE handle = reinterpret_cast<HANDLE>(handle_);
+    while (written < batch.size()) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(batch.size() - written, 1u << 30));
+        DWORD done = 0;
+        if (!::WriteFile(handle, batch.data() + written, chunk, &done, nullptr)) {
+            throw StorageException("Cannot write " + path + ": " + lastError());
+        }
+        written += done;
+    }
+    if (sync && !::FlushFileBuffers(handle)) throw StorageException("Cannot sync " + path + ": " + lastError());
+#else
+    int fd = static_cast<int>(handle_);
+    while (written < batch.size()) {
+        ssize_t done = ::write(fd, batch.data() + written, batch.size() - written);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            throw StorageException("Cannot write " + path + ": " + lastError());
+        }
+        written += static_cast<size_t>(done);
+    }
+    if (sync && ::fdatasync(fd) != 0) throw StorageException("Cannot sync " + path + ": " + lastError());
+#endif
+    segment_bytes_ += batch.size();
+}
+
+void WriteAheadLog::openSegment(uint64_t first_lsn) {
+    std::string path = (std::filesystem::path(directory_) / segmentName(first_lsn)).string();
+    WalSegmentHeader header{};
+    header.magic = kWalMagic;
+    header.version = kWalVersion;
+    header.first_lsn = first_lsn;
+    header.header_crc = headerCrc(header);
+#if defined(_WIN32)
+    HANDLE handle = ::CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) throw StorageException("Cannot create " + path + ": " + lastError());
+    DWORD done = 0;
+    if (!::WriteFile(handle, &header, sizeof(header), &done, nullptr) || done != sizeof(header)) {
+        std::string error = lastError();
+        ::CloseHandle(handle);
+        throw StorageException("Cannot write " + path + ": " + error);
+    }
+    handle_ = reinterpret_cast<intptr_t>(handle);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw StorageException("Cannot create " + path + ": " + lastError());
+    if (::write(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+        std::string error = lastError();
+        ::close(fd);
+        throw StorageException("Cannot write " + path + ": " + error);
+    }
+    handle_ = fd;
+#endif
+    if (options_.sync) syncDirectory(directory_);
+    segment_path_ = std::move(path);
+    segment_first_lsn_ = first_lsn;
+    segment_bytes_ = sizeof(header);
+}
+
+void WriteAheadLog::closeSegment() {
+    intptr_t handle = std::exchange(handle_, -1);
+    // Sealed segments are always synced, so only the last one can be torn
+#if defined(_WIN32)
+    bool synced = ::FlushFileBuffers(reinterpret_cast<HANDLE>(handle));
+    std::string error = synced ? "" : lastError();
+    ::CloseHandle(reinterpret_cast<HANDLE>(handle));
+#else
+    bool synced = ::fdatasync(static_cast<int>(handle)) == 0;
+    std::string error = synced ? "" : lastError();
+    ::close(static_cast<int>(handle));
+#endif
+    if (!synced) throw StorageException("Cannot sync " + segment_path_ + ": " + error);
+}
+
+void WriteAheadLog::publishSegmentLocked() {
+    if (segments_.empty() || segments_.back().first_lsn != segment_first_lsn_) {
+        segments_.push_back(Segment{segment_first_lsn_, 0, segment_path_});
+    }
+    segments_.back().bytes = segment_bytes_;
+}
+
+void WriteAheadLog::replay(uint64_t after_lsn, const std::function<void(const WalRecord&)>& apply) const {
+    std::vector<Segment> segments;
+    {
+        std::lock_guard lock(mutex_);
+        segments = segments_;
+    }
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const Segment& segment = segments[i];
+        if (i + 1 < segments.size() && segments[i + 1].first_lsn <= after_lsn + 1) continue;
+        MappedFile file = MappedFile::open(segment.path);
+        if (file.size() < segment.bytes) {
+            throw StorageException("WAL segment " + segment.path + " shrank to " + std::to_string(file.size()) +
+                                   " bytes");
+        }
+        auto bytes = file.bytes().first(segment.bytes);
+        size_t end = scanRecords(bytes, segment.first_lsn, [&](const WalRecord& record) {
+            if (record.lsn > after_lsn) apply(record);
+        });
+        if (end != segment.bytes) {
+            throw StorageException("WAL segment " + segment.path + " is damaged at offset " + std::to_string(end));
+        }
+    }
+}
+
+void WriteAheadLog::replay(WalStream stream, uint64_t after_lsn,
+                           const std::function<void(const WalRecord&)>& apply) const {
+    replay(after_lsn, [&](const WalRecord& record) {
+        if (record.stream == stream) apply(record);
+    });
+}
+
+void WriteAheadLog::releaseUpTo(uint64_t lsn) {
+    std::lock_guard lock(mutex_);
+    // The last segment stays, even when released in full: it carries the
+    // LSN to continue from after a restart
+    size_t released = 0;
+    while (released + 1 < segments_.size() && segments_[released + 1].first_lsn <= lsn + 1) {
+        std::error_code ec;
+        std::filesystem::remove(segments_[released].path, ec);
+        if (ec) {
+            LOG_WARN("Cannot remove WAL segment " + segments_[released].path + ": " + ec.message());
+            break;
+        }
+        ++released;
+    }
+    segments_.erase(segments_.begin(), segments_.begin() + static_cast<ptrdiff_t>(released));
+}
+
+uint64_t WriteAheadLog::lastLsn() const {
+    std::lock_guard lock(mutex_);
+    return next_lsn_ - 1;
+}
+
+uint64_t WriteAheadLog::durableLsn() const {
+    std::lock_guard lock(mutex_);
+    return options_.sync ? durable_lsn_ : written_lsn_;
+}
+
+size_t WriteAheadLog::segmentCount() const {
+    std::lock_guard lock(mutex_);
+    return segments_.size();
+}
+
+WalStats WriteAheadLog::stats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+// === WalEncoder / WalDecoder ===
+
+WalEncoder& WalEncoder::putString(std::string_view value) {
+    put<uint32_t>(static_cast<uint32_t>(value.size()));
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+    return *this;
+}
+
+const uint8_t* WalDecoder::take(size_t bytes) {
+    if (bytes > record_.payload.size() - offset_) {
+        throw StorageException("WAL record " + std::to_string(record_.lsn) + " is shorter than its contents");
+    }
+    const uint8_t* data = record_.payload.data() + offset_;
+    offset_ += bytes;
+    return data;
+}
+
+std::string_view WalDecoder::getString() {
+    uint32_t length = get<uint32_t>();
+    return {reinterpret_cast<const char*>(take(length)), length};
+}
+
+} // namespace memory::core
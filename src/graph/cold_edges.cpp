@@ -0,0 +1,125 @@
+#include "memory/graph/cold_edges.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace memory::graph {
+
+namespace {
+
+// Payload: this header, then out and in adjacency, each as sorted nodes,
+// nodes + 1 offsets and edge_count edges
+struct ColdHeader {
+    uint64_t edge_count;
+    uint32_t out_nodes;
+    uint32_t in_nodes;
+};
+
+template <typename T>
+void append(std::vector<uint8_t>& out, std::span<const T> values) {
+    size_t offset = out.size();
+    out.resize(offset + values.size_bytes());
+    if (!values.empty()) std::memcpy(out.data() + offset, values.data(), values.size_bytes());
+}
+
+// Appends one direction; edges must be sorted by (node, type, neighbor)
+void appendAdjacency(std::vector<uint8_t>& out, const std::vector<ColdEdge>& edges, bool reverse,
+                     uint32_t& node_count) {
+    std::vector<uint32_t> nodes;
+    std::vector<uint32_t> offsets{0};
+    std::vector<PackedEdge> packed;
+    packed.reserve(edges.size());
+    for (const ColdEdge& cold : edges) {
+        uint32_t node = reverse ? cold.edge.dst : cold.src;
+        if (nodes.empty() || nodes.back() != node) {
+            if (!nodes.empty()) offsets.push_back(static_cast<uint32_t>(packed.size()));
+            nodes.push_back(node);
+        }
+        PackedEdge e = cold.edge;
+        e.dst = reverse ? cold.src : cold.edge.dst;
+        e.flags = 0;
+        packed.push_back(e);
+    }
+    if (!nodes.empty()) offsets.push_back(static_cast<uint32_t>(packed.size()));
+    node_count = static_cast<uint32_t>(nodes.size());
+    append<uint32_t>(out, nodes);
+    append<uint32_t>(out, offsets);
+    append<PackedEdge>(out, packed);
+}
+
+template <typename T>
+std::span<const T> take(std::span<const uint8_t>& bytes, size_t count) {
+    if (bytes.size() < count * sizeof(T)) {
+        throw core::StorageException("cold edge segment: truncated payload");
+    }
+    std::span<const T> values(reinterpret_cast<const T*>(bytes.data()), count);
+    bytes = bytes.subspan(count * sizeof(T));
+    return values;
+}
+
+} // namespace
+
+ColdEdgeSegment::ColdEdgeSegment(std::vector<ColdEdge> edges, std::string path) {
+    if (edges.size() > std::numeric_limits<uint32_t>::max()) {
+        throw core::IndexException("Too many cold edges for one segment: " + std::to_string(edges.size()));
+    }
+    std::vector<uint8_t> image;
+    size_t header_offset = core::beginFileHeader(image);
+    ColdHeader header{edges.size(), 0, 0};
+    size_t payload_offset = image.size();
+    image.resize(payload_offset + sizeof(header));
+
+    std::sort(edges.begin(), edges.end(), [](const ColdEdge& a, const ColdEdge& b) {
+        if (a.src != b.src) return a.src < b.src;
+        return adjacencyLess(a.edge, b.edge);
+    });
+    appendAdjacency(image, edges, false, header.out_nodes);
+    std::sort(edges.begin(), edges.end(), [](const ColdEdge& a, const ColdEdge& b) {
+        if (a.edge.dst != b.edge.dst) return a.edge.dst < b.edge.dst;
+        if (a.edge.type != b.edge.type) return a.edge.type < b.edge.type;
+        return a.src < b.src;
+    });
+    appendAdjacency(image, edges, true, header.in_nodes);
+    std::memcpy(image.data() + payload_offset, &header, sizeof(header));
+    core::sealFileHeader(image, header_offset, kColdEdgeMagic, kColdEdgeVersion);
+
+    if (path.empty()) {
+        image_ = std::move(image);
+        attach(image_);
+        return;
+    }
+    core::writeFileAtomically(path, image);
+    file_ = core::MappedFile::open(path);
+    attach(file_.bytes());
+}
+
+ColdEdgeSegment::~ColdEdgeSegment() {
+    if (file_.isOpen()) {
+        // Unlinking is fine while mapped; the pages go with the mapping
+        std::remove(file_.path().c_str());
+    }
+}
+
+void ColdEdgeSegment::attach(std::span<const uint8_t> image) {
+    auto payload = core::checkFileHeader(image, kColdEdgeMagic, kColdEdgeVersion, "cold edge segment");
+    ColdHeader header = take<ColdHeader>(payload, 1)[0];
+    edge_count_ = header.edge_count;
+    for (auto [adj, nodes] : {std::pair{&out_, header.out_nodes}, std::pair{&in_, header.in_nodes}}) {
+        adj->nodes = take<uint32_t>(payload, nodes);
+        adj->offsets = take<uint32_t>(payload, nodes == 0 ? 0 : nodes + 1);
+        adj->edges = take<PackedEdge>(payload, edge_count_);
+    }
+}
+
+std::span<const PackedEdge> ColdEdgeSegment::edges(uint32_t node, Direction direction) const {
+    const Adjacency& adj = direction == Direction::OUT ? out_ : in_;
+    auto it = std::lower_bound(adj.nodes.begin(), adj.nodes.end(), node);
+    if (it == adj.nodes.end() || *it != node) return {};
+    size_t i = static_cast<size_t>(it - adj.nodes.begin());
+    return adj.edges.subspan(adj.offsets[i], adj.offsets[i + 1] - adj.offsets[i]);
+}
+
+} // namespace memory::graph
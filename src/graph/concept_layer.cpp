@@ -0,0 +1,363 @@
+#include "memory/graph/concept_layer.h"
+#include "memory/graph/graph_snapshot.h"
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+namespace memory::graph {
+
+bool isSuperNodeType(core::NodeType type) {
+    return type == core::NodeType::CONCEPT || type == core::NodeType::ENTITY || type == core::NodeType::TASK;
+}
+
+const SuperNode* ConceptGraph::find(uint32_t node) const {
+    auto it = std::lower_bound(supers_.begin(), supers_.end(), node,
+                               [](const std::shared_ptr<const SuperNode>& s, uint32_t n) { return s->node < n; });
+    if (it == supers_.end() || (*it)->node != node) return nullptr;
+    return it->get();
+}
+
+size_t ConceptGraph::memoryBytes() const {
+    size_t bytes = supers_.capacity() * sizeof(std::shared_ptr<const SuperNode>);
+    for (const auto& s : supers_) {
+        bytes += sizeof(SuperNode) + s->members.capacity() * sizeof(uint32_t) +
+                 (s->out.capacity() + s->in.capacity()) * sizeof(ConceptEdge);
+    }
+    return bytes;
+}
+
+namespace {
+
+constexpr Direction kDirections[] = {Direction::OUT, Direction::IN};
+
+bool inMask(EdgeTypeMask mask, uint8_t type) {
+    return mask & static_cast<EdgeTypeMask>(1u << type);
+}
+
+std::optional<PackedEdge> findEdge(const GraphSnapshot& graph, uint32_t src, uint32_t dst, uint8_t type,
+                                   std::vector<PackedEdge>& scratch) {
+    if (src >= graph.nodeCount()) return std::nullopt;
+    auto edges = graph.fullEdges(src, Direction::OUT, scratch);
+    PackedEdge probe{dst, 0.0f, type, 0, 0};
+    auto it = std::lower_bound(edges.begin(), edges.end(), probe, adjacencyLess);
+    if (it == edges.end() || adjacencyLess(probe, *it)) return std::nullopt;
+    return *it;
+}
+
+struct RelationKey {
+    uint32_t src;
+    uint32_t dst;
+    uint8_t type;
+
+    bool operator<(const RelationKey& o) const {
+        return std::tie(src, dst, type) < std::tie(o.src, o.dst, o.type);
+    }
+    bool operator==(const RelationKey& o) const = default;
+};
+
+// Applies summed adjustments to an adjacency list; edges whose count drops
+// to zero disappear
+void adjust(std::vector<ConceptEdge>& edges,
+            const std::map<std::pair<uint8_t, uint32_t>, std::pair<double, int64_t>>& changes) {
+    if (changes.empty()) return;
+    std::vector<ConceptEdge> result;
+    result.reserve(edges.size() + changes.size());
+    auto it = changes.begin();
+    auto emit = [&](ConceptEdge e, double weight, int64_t count) {
+        count += e.count;
+        if (count <= 0) return;
+        e.weight = static_cast<float>(e.weight + weight);
+        e.count = static_cast<uint32_t>(count);
+        result.push_back(e);
+    };
+    for (const ConceptEdge& e : edges) {
+        for (; it != changes.end() && it->first < std::pair{e.type, e.node}; ++it) {
+            emit(ConceptEdge{it->first.second, it->first.first, 0.0f, 0}, it->second.first, it->second.second);
+        }
+        if (it != changes.end() && it->first == std::pair{e.type, e.node}) {
+            emit(e, it->second.first, it->second.second);
+            ++it;
+        } else {
+            result.push_back(e);
+        }
+    }
+    for (; it != changes.end(); ++it) {
+        emit(ConceptEdge{it->first.second, it->first.first, 0.0f, 0}, it->second.first, it->second.second);
+    }
+    edges = std::move(result);
+}
+
+} // namespace
+
+// Copy-on-write state of one super-node while a delta is folded in
+struct ConceptLayerBuilder::Draft {
+    std::shared_ptr<SuperNode> node;
+    const SuperNode* previous = nullptr;
+    std::vector<uint32_t> added;
+    std::vector<uint32_t> removed;
+    std::map<std::pair<uint8_t, uint32_t>, std::pair<double, int64_t>> out;
+    std::map<std::pair<uint8_t, uint32_t>, std::pair<double, int64_t>> in;
+    bool erase = false;
+};
+
+ConceptLayerBuilder::ConceptLayerBuilder() : current_(std::make_shared<const ConceptGraph>()) {}
+
+void ConceptLayerBuilder::setNodeType(uint32_t node, core::NodeType type) {
+    pending_types_[node] = type;
+}
+
+std::vector<uint32_t> ConceptLayerBuilder::groups(uint32_t node) const {
+    if (isSuper(node)) return {node};
+    auto it = memberships_.find(node);
+    return it == memberships_.end() ? std::vector<uint32_t>{} : it->second;
+}
+
+std::vector<uint32_t> ConceptLayerBuilder::groupsIn(const GraphSnapshot& graph, uint32_t node) const {
+    if (isSuper(node)) return {node};
+    std::vector<uint32_t> result;
+    if (node >= graph.nodeCount()) return result;
+    std::vector<PackedEdge> scratch;
+    for (const PackedEdge& e : graph.fullEdges(node, Direction::OUT, scratch)) {
+        if (inMask(kMembershipTypes, e.type) && isSuper(e.dst)) result.push_back(e.dst);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::shared_ptr<const ConceptGraph> ConceptLayerBuilder::apply(const GraphSnapshot& before,
+                                                               const GraphSnapshot& after,
+                                                               const DeltaSegment& delta) {
+    if (super_types_.empty() && pending_types_.empty()) return current_;
+
+    std::unordered_map<uint32_t, Draft> drafts;
+    auto draft = [&](uint32_t super) -> Draft& {
+        auto [it, inserted] = drafts.try_emplace(super);
+        if (inserted) {
+            it->second.previous = current_->find(super);
+            if (it->second.previous) {
+                it->second.node = std::make_shared<SuperNode>(*it->second.previous);
+            } else {
+                it->second.node = std::make_shared<SuperNode>();
+                it->second.node->node = super;
+            }
+        }
+        return it->second;
+    };
+
+    // Nodes whose groups may change, with their groups before the delta
+    std::unordered_map<uint32_t, std::vector<uint32_t>> old_groups;
+    auto regroup = [&](uint32_t node) {
+        if (!old_groups.count(node)) old_groups.emplace(node, groups(node));
+    };
+    std::vector<PackedEdge> scratch;
+    for (const auto& [node, type] : pending_types_) {
+        if (isSuper(node) == isSuperNodeType(type)) continue;
+        // Becoming or ceasing to be a super-node regroups the node and
+        // every node pointing to it
+        regroup(node);
+        for (const GraphSnapshot* graph : {&before, &after}) {
+            if (node >= graph->nodeCount()) continue;
+            for (const PackedEdge& e : graph->fullEdges(node, Direction::IN, scratch)) {
+                if (inMask(kMembershipTypes, e.type)) regroup(e.dst);
+            }
+        }
+    }
+    for (uint32_t node : delta.touchedNodes(Direction::OUT)) {
+        for (const PackedEdge& e : delta.edges(node, Direction::OUT)) {
+            if (inMask(kMembershipTypes, e.type)) {
+                regroup(node);
+                break;
+            }
+        }
+    }
+
+    for (const auto& [node, type] : pending_types_) {
+        if (isSuperNodeType(type)) {
+            super_types_[node] = type;
+            draft(node).node->type = type;
+        } else if (isSuper(node)) {
+            super_types_.erase(node);
+            draft(node).erase = true;
+        }
+    }
+    pending_types_.clear();
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> new_groups;
+    for (const auto& [node, old] : old_groups) {
+        new_groups.emplace(node, groupsIn(after, node));
+    }
+    auto groupsBefore = [&](uint32_t node) {
+        auto it = old_groups.find(node);
+        return it != old_groups.end() ? it->second : groups(node);
+    };
+    auto groupsAfter = [&](uint32_t node) {
+        auto it = new_groups.find(node);
+        return it != new_groups.end() ? it->second : groups(node);
+    };
+
+    // Relation edges to re-aggregate: those the delta changed, and every
+    // relation edge of a regrouped node
+    std::vector<RelationKey> affected;
+    for (uint32_t node : delta.touchedNodes(Direction::OUT)) {
+        for (const PackedEdge& e : delta.edges(node, Direction::OUT)) {
+            if (inMask(kConceptRelationTypes, e.type)) affected.push_back(RelationKey{node, e.dst, e.type});
+        }
+    }
+    for (const auto& [node, old] : old_groups) {
+        if (old == new_groups[node]) continue;
+        for (const GraphSnapshot* graph : {&before, &after}) {
+            if (node >= graph->nodeCount()) continue;
+            for (Direction direction : kDirections) {
+                for (const PackedEdge& e : graph->fullEdges(node, direction, scratch)) {
+                    if (!inMask(kConceptRelationTypes, e.type)) continue;
+                    affected.push_back(direction == Direction::OUT ? RelationKey{node, e.dst, e.type}
+                                                                   : RelationKey{e.dst, node, e.type});
+                }
+            }
+        }
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    auto contribute = [&](uint8_t type, std::vector<uint32_t> from, std::vector<uint32_t> to, double weight,
+                          int64_t count) {
+        if (type == static_cast<uint8_t>(core::EdgeType::CAUSED_BY)) {
+            std::swap(from, to);
+            type = static_cast<uint8_t>(core::EdgeType::CAUSES);
+        }
+        for (uint32_t a : from) {
+            for (uint32_t b : to) {
+                if (a == b) continue;
+                auto& out = draft(a).out[{type, b}];
+                out.first += weight;
+                out.second += count;
+                auto& in = draft(b).in[{type, a}];
+                in.first += weight;
+                in.second += count;
+            }
+        }
+    };
+    for (const RelationKey& key : affected) {
+        if (auto old = findEdge(before, key.src, key.dst, key.type, scratch)) {
+            contribute(key.type, groupsBefore(key.src), groupsBefore(key.dst), -old->weight, -1);
+        }
+        if (auto now = findEdge(after, key.src, key.dst, key.type, scratch)) {
+            contribute(key.type, groupsAfter(key.src), groupsAfter(key.dst), now->weight, 1);
+        }
+    }
+
+    for (const auto& [node, old] : old_groups) {
+        const std::vector<uint32_t>& now = new_groups[node];
+        for (uint32_t g : old) {
+            if (g != node && !std::binary_search(now.begin(), now.end(), g)) draft(g).removed.push_back(node);
+        }
+        for (uint32_t g : now) {
+            if (g != node && !std::binary_search(old.begin(), old.end(), g)) draft(g).added.push_back(node);
+        }
+        if (isSuper(node) || now.empty()) {
+            memberships_.erase(node);
+        } else {
+            memberships_[node] = now;
+        }
+    }
+
+    if (drafts.empty()) return current_;
+    auto next = std::make_shared<ConceptGraph>(*current_);
+    for (auto& [super, d] : drafts) {
+        if (d.previous) {
+            next->edge_count_ -= d.previous->out.size();
+            next->member_count_ -= d.previous->members.size();
+        }
+        auto it = std::lower_bound(next->supers_.begin(), next->supers_.end(), super,
+                                   [](const std::shared_ptr<const SuperNode>& s, uint32_t n) { return s->node < n; });
+        if (d.erase || !isSuper(super)) {
+            if (d.previous) next->supers_.erase(it);
+            continue;
+        }
+
+        SuperNode& node = *d.node;
+        if (!d.added.empty() || !d.removed.empty()) {
+            std::sort(d.added.begin(), d.added.end());
+            std::sort(d.removed.begin(), d.removed.end());
+            std::vector<uint32_t> kept;
+            std::set_difference(node.members.begin(), node.members.end(), d.removed.begin(), d.removed.end(),
+                                std::back_inserter(kept));
+            node.members.clear();
+            std::set_union(kept.begin(), kept.end(), d.added.begin(), d.added.end(), std::back_inserter(node.members));
+        }
+        adjust(node.out, d.out);
+        adjust(node.in, d.in);
+        next->edge_count_ += node.out.size();
+        next->member_count_ += node.members.size();
+        if (d.previous) {
+            *it = d.node;
+        } else {
+            next->supers_.insert(it, d.node);
+        }
+    }
+    current_ = std::move(next);
+    return current_;
+}
+
+ConceptRouteStats expandViaConcepts(const GraphSnapshot& graph, std::span<const uint32_t> seeds, uint32_t k,
+                                    EdgeTypeMask relations, EpochVisitedSet& visited, std::vector<HopIndex>& out) {
+    ConceptRouteStats stats;
+    uint32_t node_count = graph.nodeCount();
+    visited.begin(node_count, k);
+    std::atomic<uint32_t>* stamps = visited.stamps();
+    uint32_t base = visited.base();
+    const ConceptGraph* concepts = graph.concepts().get();
+
+    std::vector<uint32_t> frontier;
+    for (uint32_t seed : seeds) {
+        if (seed >= node_count || stamps[seed].load(std::memory_order_relaxed) >= base) continue;
+        stamps[seed].store(base, std::memory_order_relaxed);
+        frontier.push_back(seed);
+        out.push_back(HopIndex{seed, 0});
+    }
+    if (!concepts) return stats;
+
+    std::vector<uint32_t> next;
+    std::vector<PackedEdge> scratch;
+    for (uint32_t hop = 1; hop <= k && !frontier.empty(); ++hop) {
+        next.clear();
+        auto visit = [&](uint32_t node) {
+            if (stamps[node].load(std::memory_order_relaxed) >= base) return;
+            stamps[node].store(base + hop, std::memory_order_relaxed);
+            next.push_back(node);
+            out.push_back(HopIndex{node, hop});
+        };
+        for (uint32_t node : frontier) {
+            if (const SuperNode* super = concepts->find(node)) {
+                ++stats.super_nodes;
+                // Related super-nodes over the concept layer
+                for (const auto* edges : {&super->out, &super->in}) {
+                    stats.l2_edges += edges->size();
+                    for (const ConceptEdge& e : *edges) {
+                        if (inMask(relations, e.type)) visit(e.node);
+                    }
+                }
+                // Members, refined on the pruned graph
+                auto members = graph.edges(node, Direction::IN, scratch);
+                stats.l1_edges += members.size();
+                for (const PackedEdge& e : members) {
+                    if (inMask(kMembershipTypes, e.type)) visit(e.dst);
+                }
+            } else if (hop == 1) {
+                // A seed: locate its groups, cold memberships included
+                auto edges = graph.fullEdges(node, Direction::OUT, scratch);
+                stats.l1_edges += edges.size();
+                for (const PackedEdge& e : edges) {
+                    if (inMask(kMembershipTypes, e.type) && concepts->find(e.dst)) visit(e.dst);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+    return stats;
+}
+
+} // namespace memory::graph
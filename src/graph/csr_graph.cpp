@@ -0,0 +1,204 @@
+#include "memory/graph/csr_graph.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace memory::graph {
+
+namespace {
+
+constexpr uint32_t kMetaSection = core::makeMagic('M', 'E', 'T', 'A');
+constexpr uint32_t kOutOffsetsSection = core::makeMagic('O', 'O', 'F', 'F');
+constexpr uint32_t kOutEdgesSection = core::makeMagic('O', 'E', 'D', 'G');
+constexpr uint32_t kOutMasksSection = core::makeMagic('O', 'M', 'S', 'K');
+constexpr uint32_t kInOffsetsSection = core::makeMagic('I', 'O', 'F', 'F');
+constexpr uint32_t kInEdgesSection = core::makeMagic('I', 'E', 'D', 'G');
+constexpr uint32_t kInMasksSection = core::makeMagic('I', 'M', 'S', 'K');
+
+struct GraphMeta {
+    uint32_t node_count;
+    uint32_t reserved;
+    uint64_t edge_count;
+};
+
+} // namespace
+
+EdgeTypeMask edgeTypeMask(std::span<const core::EdgeType> types) {
+    if (types.empty()) return kAllEdgeTypes;
+    EdgeTypeMask mask = 0;
+    for (core::EdgeType type : types) {
+        mask |= edgeTypeBit(type);
+    }
+    return mask;
+}
+
+std::span<const PackedEdge> CsrGraph::edges(uint32_t node, Direction direction) const {
+    const Adjacency& adj = adjacency(direction);
+    return {adj.edges.data() + adj.offsets[node], adj.edges.data() + adj.offsets[node + 1]};
+}
+
+std::span<const PackedEdge> CsrGraph::edges(uint32_t node, Direction direction, core::EdgeType type) const {
+    const Adjacency& adj = adjacency(direction);
+    if (!(adj.masks[node] & edgeTypeBit(type))) return {};
+
+    const PackedEdge* first = adj.edges.data() + adj.offsets[node];
+    const PackedEdge* last = adj.edges.data() + adj.offsets[node + 1];
+    auto key = static_cast<uint16_t>(type);
+    first = std::lower_bound(first, last, key, [](const PackedEdge& e, uint16_t t) { return e.type < t; });
+    last = std::upper_bound(first, last, key, [](uint16_t t, const PackedEdge& e) { return t < e.type; });
+    return {first, last};
+}
+
+EdgeTypeMask CsrGraph::typeMask(uint32_t node, Direction direction) const {
+    return adjacency(direction).masks[node];
+}
+
+size_t CsrGraph::memoryBytes() const {
+    size_t bytes = 0;
+    for (const Adjacency* adj : {&out_, &in_}) {
+        bytes += adj->offset_storage.capacity() * sizeof(uint32_t) +
+                 adj->edge_storage.capacity() * sizeof(PackedEdge) +
+                 adj->mask_storage.capacity() * sizeof(EdgeTypeMask);
+    }
+    return bytes;
+}
+
+void CsrGraph::save(const std::string& path) const {
+    core::SectionFileWriter writer(path, kCsrGraphMagic, kCsrGraphVersion);
+    GraphMeta meta{node_count_, 0, edgeCount()};
+    writer.begin(kMetaSection);
+    writer.append(&meta, sizeof(meta));
+    writer.begin(kOutOffsetsSection);
+    writer.append(out_.offsets);
+    writer.begin(kOutEdgesSection);
+    writer.append(out_.edges);
+    writer.begin(kOutMasksSection);
+    writer.append(out_.masks);
+    writer.begin(kInOffsetsSection);
+    writer.append(in_.offsets);
+    writer.begin(kInEdgesSection);
+    writer.append(in_.edges);
+    writer.begin(kInMasksSection);
+    writer.append(in_.masks);
+    writer.commit();
+}
+
+CsrGraph CsrGraph::open(const std::string& path, bool verify) {
+    std::string what = "CSR graph " + path;
+    CsrGraph graph;
+    graph.file_ = core::SectionFile::open(path, kCsrGraphMagic, kCsrGraphVersion, what);
+    if (verify) graph.file_.verify();
+    auto meta_bytes = graph.file_.section(kMetaSection);
+    if (meta_bytes.size() != sizeof(GraphMeta)) throw core::StorageException(what + ": bad meta section");
+    GraphMeta meta;
+    std::memcpy(&meta, meta_bytes.data(), sizeof(meta));
+    graph.node_count_ = meta.node_count;
+
+    // Checks what traversals rely on without reading the arrays through
+    auto attach = [&](Adjacency& adj, uint32_t offsets, uint32_t edges, uint32_t masks) {
+        adj.offsets = graph.file_.array<uint32_t>(offsets);
+        adj.edges = graph.file_.array<PackedEdge>(edges);
+        adj.masks = graph.file_.array<EdgeTypeMask>(masks);
+        if (adj.offsets.size() != static_cast<size_t>(meta.node_count) + 1 || adj.masks.size() != meta.node_count ||
+            adj.edges.size() != meta.edge_count || adj.offsets.back() != meta.edge_count) {
+            throw core::StorageException(what + ": inconsistent adjacency arrays");
+        }
+    };
+    attach(graph.out_, kOutOffsetsSection, kOutEdgesSection, kOutMasksSection);
+    attach(graph.in_, kInOffsetsSection, kInEdgesSection, kInMasksSection);
+    return graph;
+}
+
+CsrBuilder::CsrBuilder(uint32_t node_count)
+    : node_count_(node_count) {}
+
+void CsrBuilder::reserve(size_t edges) {
+    edges_.reserve(edges);
+}
+
+void CsrBuilder::add(uint32_t src, uint32_t dst, core::EdgeType type, float weight, uint16_t day) {
+    if (src >= node_count_ || dst >= node_count_) {
+        throw core::IndexException("Edge endpoint out of range: " + std::to_string(std::max(src, dst)) +
+                                   " >= " + std::to_string(node_count_));
+    }
+    edges_.push_back(RawEdge{src, dst, weight, static_cast<uint8_t>(type), day});
+}
+
+CsrGraph CsrBuilder::build() {
+    // Sort by (src, type, dst); stability makes the last duplicate win
+    std::stable_sort(edges_.begin(), edges_.end(), [](const RawEdge& a, const RawEdge& b) {
+        if (a.src != b.src) return a.src < b.src;
+        if (a.type != b.type) return a.type < b.type;
+        return a.dst < b.dst;
+    });
+    size_t kept = 0;
+    for (size_t i = 0; i < edges_.size(); ++i) {
+        const RawEdge& e = edges_[i];
+        if (kept > 0) {
+            RawEdge& prev = edges_[kept - 1];
+            if (prev.src == e.src && prev.type == e.type && prev.dst == e.dst) {
+                prev.weight = e.weight;
+                prev.day = e.day;
+                continue;
+            }
+        }
+        edges_[kept++] = e;
+    }
+    edges_.resize(kept);
+    if (edges_.size() > std::numeric_limits<uint32_t>::max()) {
+        throw core::IndexException("Too many edges for one CSR graph: " + std::to_string(edges_.size()));
+    }
+
+    CsrGraph graph;
+    graph.node_count_ = node_count_;
+    buildDirection(graph.out_, false);
+    buildDirection(graph.in_, true);
+    edges_.clear();
+    edges_.shrink_to_fit();
+    return graph;
+}
+
+void CsrBuilder::buildDirection(CsrGraph::Adjacency& adj, bool reverse) const {
+    std::vector<uint32_t>& offsets = adj.offset_storage;
+    std::vector<EdgeTypeMask>& masks = adj.mask_storage;
+    std::vector<PackedEdge>& edges = adj.edge_storage;
+    offsets.assign(static_cast<size_t>(node_count_) + 1, 0);
+    masks.assign(node_count_, 0);
+    for (const RawEdge& e : edges_) {
+        uint32_t node = reverse ? e.dst : e.src;
+        ++offsets[node + 1];
+        masks[node] |= static_cast<EdgeTypeMask>(1u << e.type);
+    }
+    for (uint32_t n = 0; n < node_count_; ++n) {
+        offsets[n + 1] += offsets[n];
+    }
+
+    // Scatter. Out-edges arrive sorted by (src, type, dst) already; in-edges
+    // arrive in (src) order within each (dst, type) group, which is the
+    // neighbor order we want, so grouping by type is all that is left.
+    edges.resize(edges_.size());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const RawEdge& e : edges_) {
+        uint32_t node = reverse ? e.dst : e.src;
+        uint32_t neighbor = reverse ? e.src : e.dst;
+        edges[cursor[node]++] = PackedEdge{neighbor, e.weight, e.type, 0, e.day};
+    }
+    if (reverse) {
+        for (uint32_t n = 0; n < node_count_; ++n) {
+            auto first = edges.begin() + offsets[n];
+            auto last = edges.begin() + offsets[n + 1];
+            if (last - first > 1) {
+                std::stable_sort(first, last, [](const PackedEdge& a, const PackedEdge& b) {
+                    return a.type < b.type;
+                });
+            }
+        }
+    }
+    adj.offsets = offsets;
+    adj.edges = edges;
+    adj.masks = masks;
+}
+
+} // namespace memory::graph
@@ -0,0 +1,580 @@
+#include "memory/graph/csr_graph_store.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/logger.h"
+#include "memory/core/manifest.h"
+#include "memory/core/thread_pool.h"
+#include "memory/core/top_k.h"
+#include "memory/core/wal.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <limits>
+#include <string>
+
+namespace memory::graph {
+
+namespace {
+
+// Ops of WalStream::GRAPH records
+enum : uint8_t {
+    kWalAddEdge = 1,     // src, dst, type, weight, day
+    kWalRemoveEdge = 2,  // src, dst, type
+    kWalNodeType = 3     // node, type
+};
+
+uint64_t storedEdgeEntries(const GraphSnapshot& snapshot) {
+    return snapshot.base()->edgeCount() + snapshot.coldEdgeCount() + snapshot.deltaEntryCount();
+}
+
+double deltaShare(const GraphSnapshot& snapshot) {
+    uint64_t stored = storedEdgeEntries(snapshot);
+    return stored ? static_cast<double>(snapshot.deltaEntryCount()) / static_cast<double>(stored) : 0.0;
+}
+
+} // namespace
+
+GraphStoreOptions GraphStoreOptions::fromConfig(const core::Config& config) {
+    GraphStoreOptions options;
+    int buffered = config.get<int>("max_buffered_edges", static_cast<int>(options.max_buffered_edges));
+    options.max_buffered_edges = buffered > 0 ? static_cast<size_t>(buffered) : 1;
+    int deltas = config.get<int>("max_delta_segments", static_cast<int>(options.max_delta_segments));
+    options.max_delta_segments = deltas > 0 ? static_cast<size_t>(deltas) : 1;
+    options.background_merge = config.get<bool>("background_merge", options.background_merge);
+    int threads = config.get<int>("max_threads", static_cast<int>(options.max_threads));
+    options.max_threads = threads > 0 ? static_cast<size_t>(threads) : 1;
+    options.ppr = PprOptions::fromConfig(config);
+    options.caps = DegreeCaps::fromConfig(config);
+    options.cold_edge_dir = config.get<std::string>("cold_edge_dir", "");
+    int cache_mb = config.get<int>("cache_size_mb", static_cast<int>(options.cache_bytes >> 20));
+    options.cache_bytes = static_cast<size_t>(std::max(cache_mb, 0)) << 20;
+    return options;
+}
+
+CsrGraphStore::CsrGraphStore(GraphStoreOptions options, std::shared_ptr<core::ThreadPool> pool)
+    : options_(std::move(options)), pool_(std::move(pool)), adjacency_cache_(options_.cache_bytes) {
+    if (!options_.cold_edge_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(options_.cold_edge_dir, ec);
+        if (ec) {
+            throw core::StorageException("Cannot create cold edge directory " + options_.cold_edge_dir + ": " +
+                                         ec.message());
+        }
+    }
+    if (!pool_ && options_.max_threads > 1) {
+        pool_ = std::make_shared<core::ThreadPool>(options_.max_threads - 1);
+    }
+    snapshot_.store(std::make_shared<const GraphSnapshot>(
+        std::make_shared<const CsrGraph>(), std::make_shared<const NodeTable>(),
+        std::vector<std::shared_ptr<const DeltaSegment>>{}, 0));
+    if (options_.background_merge) {
+        merger_ = std::thread([this] { mergeLoop(); });
+    }
+}
+
+CsrGraphStore::~CsrGraphStore() {
+    if (merger_.joinable()) {
+        {
+            std::lock_guard lock(merge_signal_mutex_);
+            stopping_ = true;
+        }
+        merge_cv_.notify_one();
+        merger_.join();
+    }
+}
+
+void CsrGraphStore::AddEdge(const core::Edge& edge) {
+    AddEdge(edge, edgeDay());
+}
+
+void CsrGraphStore::AddEdge(const core::Edge& edge, uint16_t day) {
+    bool merge = false;
+    uint64_t lsn = 0;
+    {
+        std::lock_guard lock(write_mutex_);
+        if (wal_) {
+            core::WalEncoder record;
+            record.put<uint64_t>(edge.src).put<uint64_t>(edge.dst).put(edge.type).put<float>(edge.weight).put(day);
+            lsn = wal_->append(core::WalStream::GRAPH, kWalAddEdge, record.bytes());
+        }
+        uint32_t src = internLocked(edge.src);
+        uint32_t dst = internLocked(edge.dst);
+        bufferLocked(src, dst, edge.type, edge.weight, 0, day);
+        if (buffered_ >= options_.max_buffered_edges) {
+            merge = freezeLocked();
+        }
+    }
+    if (merge) requestMerge();
+    if (lsn) wal_->commit(lsn);
+}
+
+void CsrGraphStore::RemoveEdge(core::NodeId src, core::NodeId dst, core::EdgeType type) {
+    bool merge = false;
+    uint64_t lsn = 0;
+    {
+        std::lock_guard lock(write_mutex_);
+        auto s = findLocked(src);
+        auto d = findLocked(dst);
+        if (!s || !d) return;
+        if (wal_) {
+            core::WalEncoder record;
+            record.put<uint64_t>(src).put<uint64_t>(dst).put(type);
+            lsn = wal_->append(core::WalStream::GRAPH, kWalRemoveEdge, record.bytes());
+        }
+        bufferLocked(*s, *d, type, 0.0f, kEdgeTombstone, 0);
+        if (buffered_ >= options_.max_buffered_edges) {
+            merge = freezeLocked();
+        }
+    }
+    if (merge) requestMerge();
+    if (lsn) wal_->commit(lsn);
+}
+
+void CsrGraphStore::SetNodeType(core::NodeId node, core::NodeType type) {
+    uint64_t lsn = 0;
+    {
+        std::lock_guard lock(write_mutex_);
+        if (wal_) {
+            lsn = wal_->append(core::WalStream::GRAPH, kWalNodeType,
+                               core::WalEncoder().put<uint64_t>(node).put(type).bytes());
+        }
+        concepts_.setNodeType(internLocked(node), type);
+    }
+    if (lsn) wal_->commit(lsn);
+}
+
+void CsrGraphStore::attachWal(std::shared_ptr<core::WriteAheadLog> wal, uint64_t after_lsn) {
+    // Replays through the public methods while nothing is logged yet
+    wal->replay(core::WalStream::GRAPH, after_lsn, [&](const core::WalRecord& record) {
+        core::WalDecoder decoder(record);
+        core::NodeId src = decoder.get<uint64_t>();
+        switch (record.op) {
+            case kWalAddEdge: {
+                core::Edge edge;
+                edge.src = src;
+                edge.dst = decoder.get<uint64_t>();
+                edge.type = decoder.get<core::EdgeType>();
+                edge.weight = decoder.get<float>();
+                AddEdge(edge, decoder.get<uint16_t>());
+                break;
+            }
+            case kWalRemoveEdge: {
+                core::NodeId dst = decoder.get<uint64_t>();
+                RemoveEdge(src, dst, decoder.get<core::EdgeType>());
+                break;
+            }
+            case kWalNodeType: SetNodeType(src, decoder.get<core::NodeType>()); break;
+            default:
+                throw core::StorageException("Unknown graph WAL op " + std::to_string(record.op) + " at LSN " +
+                                             std::to_string(record.lsn));
+        }
+    });
+    std::lock_guard lock(write_mutex_);
+    wal_ = std::move(wal);
+}
+
+void CsrGraphStore::attachVersions(std::shared_ptr<core::VersionSet> versions) {
+    std::lock_guard lock(write_mutex_);
+    versions_ = std::move(versions);
+    versions_->publish(snapshot_.load());
+}
+
+void CsrGraphStore::Flush() {
+    bool merge;
+    {
+        std::lock_guard lock(write_mutex_);
+        merge = freezeLocked();
+    }
+    if (merge) requestMerge();
+}
+
+void CsrGraphStore::Compact() {
+    {
+        std::lock_guard lock(write_mutex_);
+        freezeLocked();
+    }
+    mergeDeltas();
+}
+
+void CsrGraphStore::SetDegreeCaps(const DegreeCaps& caps) {
+    {
+        std::lock_guard lock(merge_mutex_);
+        options_.caps = caps;
+    }
+    {
+        std::lock_guard lock(write_mutex_);
+        freezeLocked();
+    }
+    mergeDeltas(true);
+}
+
+std::vector<HopNode> CsrGraphStore::KHopSeeds(std::span<const core::NodeId> seeds, int k,
+                                              std::span<const core::EdgeType> types) const {
+    return KHopSeeds(*snapshot(), seeds, k, types);
+}
+
+std::vector<HopNode> CsrGraphStore::KHopSeeds(const GraphSnapshot& snapshot, std::span<const core::NodeId> seeds,
+                                              int k, std::span<const core::EdgeType> types) const {
+    std::vector<uint32_t> dense;
+    dense.reserve(seeds.size());
+    for (core::NodeId seed : seeds) {
+        if (auto index = snapshot.nodeIndex(seed)) dense.push_back(*index);
+    }
+
+    std::vector<HopIndex> reached;
+    {
+        VisitedLease visited(*this);
+        expandKHop(snapshot, dense, static_cast<uint32_t>(std::max(k, 0)), edgeTypeMask(types), *visited, reached,
+                   pool_.get(), options_.khop);
+    }
+
+    std::vector<HopNode> result;
+    result.reserve(reached.size());
+    for (const HopIndex& hop : reached) {
+        result.push_back(HopNode{snapshot.nodeId(hop.node), hop.hops});
+    }
+    return result;
+}
+
+std::vector<HopNode> CsrGraphStore::ExpandSeeds(std::span<const core::NodeId> seeds, const core::RecallQuery& query,
+                                                std::span<const core::EdgeType> types,
+                                                ConceptRouteStats* stats) const {
+    return ExpandSeeds(*snapshot(), seeds, query, types, stats);
+}
+
+std::vector<HopNode> CsrGraphStore::ExpandSeeds(const GraphSnapshot& snapshot, std::span<const core::NodeId> seeds,
+                                                const core::RecallQuery& query, std::span<const core::EdgeType> types,
+                                                ConceptRouteStats* stats) const {
+    auto option = query.options.find("use_l2");
+    bool use_l2 = option != query.options.end() && (option->second == "true" || option->second == "1");
+    if (!use_l2 || !snapshot.concepts() || snapshot.concepts()->superNodeCount() == 0) {
+        return KHopSeeds(snapshot, seeds, query.k_hop, types);
+    }
+
+    EdgeTypeMask relations = edgeTypeMask(types) & kConceptRelationTypes;
+    if (relations & edgeTypeBit(core::EdgeType::CAUSED_BY)) relations |= edgeTypeBit(core::EdgeType::CAUSES);
+    std::vector<uint32_t> dense;
+    dense.reserve(seeds.size());
+    for (core::NodeId seed : seeds) {
+        if (auto index = snapshot.nodeIndex(seed)) dense.push_back(*index);
+    }
+
+    std::vector<HopIndex> reached;
+    ConceptRouteStats route;
+    {
+        VisitedLease visited(*this);
+        route = expandViaConcepts(snapshot, dense, static_cast<uint32_t>(std::max(query.k_hop, 0)), relations,
+                                  *visited, reached);
+    }
+    if (stats) *stats = route;
+
+    std::vector<HopNode> result;
+    result.reserve(reached.size());
+    for (const HopIndex& hop : reached) {
+        result.push_back(HopNode{snapshot.nodeId(hop.node), hop.hops});
+    }
+    return result;
+}
+
+std::vector<Neighbor> CsrGraphStore::Neighbors(core::NodeId node, Direction direction,
+                                               std::span<const core::EdgeType> types, GraphLayer layer) const {
+    EdgeTypeMask mask = edgeTypeMask(types);
+    std::shared_ptr<const GraphSnapshot> snap = snapshot();
+    std::vector<Neighbor> result;
+    auto index = snap->nodeIndex(node);
+    if (!index) return result;
+    std::vector<PackedEdge> scratch;
+    std::shared_ptr<const AdjacencyBlock> block;
+    auto edges = layer == GraphLayer::L0 ? snap->fullEdges(*index, direction, scratch, adjacency_cache_, block)
+                                         : snap->edges(*index, direction, scratch);
+    for (const PackedEdge& e : edges) {
+        if (mask & edgeTypeBit(e.edgeType())) {
+            result.push_back(Neighbor{snap->nodeId(e.dst), e.edgeType(), e.weight});
+        }
+    }
+    return result;
+}
+
+bool CsrGraphStore::PinNode(core::NodeId node) {
+    std::shared_ptr<const GraphSnapshot> snap = snapshot();
+    auto index = snap->nodeIndex(node);
+    if (!index) return false;
+    std::vector<PackedEdge> scratch;
+    std::shared_ptr<const AdjacencyBlock> block;
+    for (Direction direction : {Direction::OUT, Direction::IN}) {
+        adjacency_cache_.pin(AdjacencyKey{*index, direction});
+        snap->fullEdges(*index, direction, scratch, adjacency_cache_, block);  // Loads it
+    }
+    return true;
+}
+
+void CsrGraphStore::UnpinNode(core::NodeId node) {
+    if (auto index = nodeIndex(node)) {
+        adjacency_cache_.unpin(AdjacencyKey{*index, Direction::OUT});
+        adjacency_cache_.unpin(AdjacencyKey{*index, Direction::IN});
+    }
+}
+
+std::vector<core::ScoredId> CsrGraphStore::PersonalizedPageRank(std::span<const core::NodeId> seeds, size_t k,
+                                                                std::span<const float> seed_weights) const {
+    return PersonalizedPageRank(*snapshot(), seeds, k, seed_weights);
+}
+
+std::vector<core::ScoredId> CsrGraphStore::PersonalizedPageRank(const GraphSnapshot& snapshot,
+                                                                std::span<const core::NodeId> seeds, size_t k,
+                                                                std::span<const float> seed_weights) const {
+    std::vector<uint32_t> dense;
+    std::vector<float> weights;
+    dense.reserve(seeds.size());
+    for (size_t i = 0; i < seeds.size(); ++i) {
+        auto index = snapshot.nodeIndex(seeds[i]);
+        if (!index) continue;
+        dense.push_back(*index);
+        if (!seed_weights.empty()) weights.push_back(seed_weights[std::min(i, seed_weights.size() - 1)]);
+    }
+
+    core::TopKCollector top(k);
+    for (const PprScore& score : forwardPushPpr(snapshot, dense, weights, options_.ppr)) {
+        top.push(snapshot.nodeId(score.node), score.score);
+    }
+    return top.take();
+}
+
+std::optional<uint32_t> CsrGraphStore::nodeIndex(core::NodeId node) const {
+    return snapshot()->nodeIndex(node);
+}
+
+size_t CsrGraphStore::nodeCount() const {
+    return snapshot()->nodeCount();
+}
+
+uint64_t CsrGraphStore::edgeCount() const {
+    return snapshot()->edgeCount();
+}
+
+uint64_t CsrGraphStore::coldEdgeCount() const {
+    return snapshot()->coldEdgeCount();
+}
+
+size_t CsrGraphStore::bufferedCount() const {
+    std::lock_guard lock(write_mutex_);
+    return buffered_;
+}
+
+size_t CsrGraphStore::deltaCount() const {
+    return snapshot()->deltas().size();
+}
+
+size_t CsrGraphStore::memoryBytes() const {
+    return snapshot()->memoryBytes();
+}
+
+double CsrGraphStore::fragmentation() const {
+    return deltaShare(*snapshot());
+}
+
+bool CsrGraphStore::compactionDue(const core::CompactionOptions& options) const {
+    std::shared_ptr<const GraphSnapshot> current = snapshot();
+    return !current->deltas().empty() && deltaShare(*current) > options.fragmentation_threshold;
+}
+
+core::CompactionResult CsrGraphStore::compact(const core::CompactionOptions& options, core::RateLimiter& limiter) {
+    (void)options;
+    core::CompactionResult result;
+    result.target = compactionName();
+    std::shared_ptr<const GraphSnapshot> before = snapshot();
+    result.bytes_before = before->memoryBytes();
+    result.items_before = storedEdgeEntries(*before);
+    result.fragmentation_before = deltaShare(*before);
+    // The merge reads the whole graph in one go, so it pays up front
+    limiter.acquire(result.bytes_before);
+    mergeDeltas();
+
+    std::shared_ptr<const GraphSnapshot> after = snapshot();
+    result.bytes_after = after->memoryBytes();
+    result.items_after = storedEdgeEntries(*after);
+    result.fragmentation_after = deltaShare(*after);
+    return result;
+}
+
+CsrGraphStore::VisitedLease::VisitedLease(const CsrGraphStore& store) : store_(store) {
+    std::lock_guard lock(store_.visited_mutex_);
+    if (store_.visited_free_.empty()) {
+        visited_ = std::make_unique<EpochVisitedSet>();
+        return;
+    }
+    visited_ = std::move(store_.visited_free_.back());
+    store_.visited_free_.pop_back();
+}
+
+CsrGraphStore::VisitedLease::~VisitedLease() {
+    std::lock_guard lock(store_.visited_mutex_);
+    store_.visited_free_.push_back(std::move(visited_));
+}
+
+uint32_t CsrGraphStore::internLocked(core::NodeId node) {
+    if (auto index = findLocked(node)) return *index;
+    if (new_nodes_.ids.empty()) {
+        new_nodes_.first = snapshot_.load()->nodeCount();
+    }
+    if (new_nodes_.end() == std::numeric_limits<uint32_t>::max()) {
+        throw core::IndexException("Graph node limit reached at node " + std::to_string(node));
+    }
+    uint32_t index = new_nodes_.end();
+    new_nodes_.ids.push_back(node);
+    new_nodes_.index.emplace(node, index);
+    return index;
+}
+
+std::optional<uint32_t> CsrGraphStore::findLocked(core::NodeId node) const {
+    if (auto index = new_nodes_.find(node)) return index;
+    return snapshot_.load()->nodeIndex(node);
+}
+
+void CsrGraphStore::bufferLocked(uint32_t src, uint32_t dst, core::EdgeType type, float weight, uint8_t flags,
+                                 uint16_t day) {
+    auto t = static_cast<uint8_t>(type);
+    out_buffer_[src].push_back(PackedEdge{dst, weight, t, flags, day});
+    in_buffer_[dst].push_back(PackedEdge{src, weight, t, flags, day});
+    ++buffered_;
+}
+
+bool CsrGraphStore::freezeLocked() {
+    std::shared_ptr<const GraphSnapshot> current = snapshot_.load();
+    if (buffered_ == 0 && new_nodes_.ids.empty() && !concepts_.hasPendingTypes()) {
+        return current->deltas().size() >= options_.max_delta_segments;
+    }
+    if (new_nodes_.ids.empty()) {
+        new_nodes_.first = current->nodeCount();
+    }
+    auto delta = std::make_shared<const DeltaSegment>(out_buffer_, in_buffer_, std::move(new_nodes_));
+    new_nodes_ = NodeTable{};
+    buffered_ = 0;
+
+    // Net change in visible edges: upserts of absent edges add one,
+    // tombstones of present edges remove one
+    int64_t edge_count = static_cast<int64_t>(current->edgeCount());
+    std::vector<PackedEdge> scratch;
+    for (uint32_t node : delta->touchedNodes(Direction::OUT)) {
+        std::span<const PackedEdge> visible = current->edges(node, Direction::OUT, scratch);
+        for (const PackedEdge& e : delta->edges(node, Direction::OUT)) {
+            bool present = std::binary_search(visible.begin(), visible.end(), e, adjacencyLess);
+            if (e.tombstone()) {
+                edge_count -= present;
+            } else {
+                edge_count += !present;
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<const DeltaSegment>> deltas = current->deltas();
+    deltas.push_back(delta);
+    bool merge = deltas.size() >= options_.max_delta_segments;
+    GraphSnapshot next(current->base(), current->baseNodes(), deltas, static_cast<uint64_t>(edge_count),
+                       current->cold(), current->concepts());
+    std::shared_ptr<const ConceptGraph> concepts = concepts_.apply(*current, next, *delta);
+    publishLocked(std::make_shared<const GraphSnapshot>(current->base(), current->baseNodes(), std::move(deltas),
+                                                        static_cast<uint64_t>(edge_count), current->cold(),
+                                                        concepts->superNodeCount() > 0 ? concepts : nullptr));
+    return merge;
+}
+
+void CsrGraphStore::publishLocked(std::shared_ptr<const GraphSnapshot> snapshot) {
+    snapshot_.store(snapshot);
+    if (versions_) versions_->publish(std::move(snapshot));
+}
+
+void CsrGraphStore::mergeDeltas(bool force) {
+    std::lock_guard merge_lock(merge_mutex_);
+    std::shared_ptr<const GraphSnapshot> source = snapshot();
+    if (source->deltas().empty() && !force) return;
+
+    auto start = std::chrono::steady_clock::now();
+    auto nodes = std::make_shared<NodeTable>(*source->baseNodes());
+    for (const auto& delta : source->deltas()) {
+        const NodeTable& added = delta->nodes();
+        nodes->ids.insert(nodes->ids.end(), added.ids.begin(), added.ids.end());
+        nodes->index.insert(added.index.begin(), added.index.end());
+    }
+
+    // Hot and cold edges are re-ranked together, so edges can move both ways
+    CsrBuilder builder(source->nodeCount());
+    builder.reserve(source->edgeCount() + source->coldEdgeCount());
+    std::vector<ColdEdge> spilled;
+    PruneStats pruned = pruneToCaps(*source, options_.caps, builder, spilled);
+    auto base = std::make_shared<const CsrGraph>(builder.build());
+    std::shared_ptr<const ColdEdgeSegment> cold;
+    if (!spilled.empty()) {
+        std::string path;
+        if (!options_.cold_edge_dir.empty()) {
+            path = options_.cold_edge_dir + "/cold_" + std::to_string(cold_segments_++) + ".gcol";
+        }
+        cold = std::make_shared<const ColdEdgeSegment>(std::move(spilled), std::move(path));
+    }
+
+    // Deltas frozen while merging stay on top of the new base
+    {
+        std::lock_guard lock(write_mutex_);
+        std::shared_ptr<const GraphSnapshot> current = snapshot_.load();
+        std::vector<std::shared_ptr<const DeltaSegment>> remaining(
+            current->deltas().begin() + static_cast<std::ptrdiff_t>(source->deltas().size()),
+            current->deltas().end());
+        // Pruning changes the visible count, so recount what the remaining
+        // deltas add on top of the new base
+        uint64_t edge_count = base->edgeCount();
+        if (!remaining.empty()) {
+            GraphSnapshot merged(base, nodes, remaining, 0, cold);
+            std::vector<uint32_t> touched;
+            for (const auto& delta : remaining) {
+                auto delta_nodes = delta->touchedNodes(Direction::OUT);
+                touched.insert(touched.end(), delta_nodes.begin(), delta_nodes.end());
+            }
+            std::sort(touched.begin(), touched.end());
+            touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+            std::vector<PackedEdge> scratch;
+            for (uint32_t node : touched) {
+                edge_count += merged.edges(node, Direction::OUT, scratch).size();
+                if (node < base->nodeCount()) edge_count -= base->edges(node, Direction::OUT).size();
+            }
+        }
+        publishLocked(std::make_shared<const GraphSnapshot>(std::move(base), std::move(nodes), std::move(remaining),
+                                                            edge_count, std::move(cold), current->concepts()));
+    }
+    // Blocks of the old base no longer match; pinned ones reload on next read
+    adjacency_cache_.clear();
+    merges_.fetch_add(1);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_DEBUG("Merged " + std::to_string(source->deltas().size()) + " graph deltas into " +
+              std::to_string(pruned.kept) + " edges (" + std::to_string(pruned.spilled) + " cold, " +
+              std::to_string(pruned.capped_lists) + " capped lists) in " + std::to_string(ms) + " ms");
+}
+
+void CsrGraphStore::requestMerge() {
+    if (!options_.background_merge) {
+        mergeDeltas();
+        return;
+    }
+    {
+        std::lock_guard lock(merge_signal_mutex_);
+        merge_requested_ = true;
+    }
+    merge_cv_.notify_one();
+}
+
+void CsrGraphStore::mergeLoop() {
+    std::unique_lock lock(merge_signal_mutex_);
+    while (true) {
+        merge_cv_.wait(lock, [this] { return merge_requested_ || stopping_; });
+        if (stopping_) return;
+        merge_requested_ = false;
+        lock.unlock();
+        try {
+            mergeDeltas();
+        } catch (const std::exception& e) {
+            LOG_ERROR(std::string("Graph merge failed: ") + e.what());
+        }
+        lock.lock();
+    }
+}
+
+} // namespace memory::graph
@@ -0,0 +1,131 @@
+#include "memory/graph/degree_caps.h"
+#include "memory/core/config.h"
+#include "memory/graph/graph_snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace memory::graph {
+
+DegreeCaps DegreeCaps::unlimited() {
+    DegreeCaps caps;
+    caps.max_degree.fill(0);
+    return caps;
+}
+
+DegreeCaps DegreeCaps::fromConfig(const core::Config& config) {
+    DegreeCaps caps;
+    int per_type = config.get<int>("max_degree_per_type", static_cast<int>(caps.max_degree[0]));
+    caps.max_degree.fill(static_cast<uint32_t>(std::max(per_type, 0)));
+    auto& similar = caps.max_degree[static_cast<size_t>(core::EdgeType::SIMILAR_TO)];
+    similar = static_cast<uint32_t>(std::max(config.get<int>("similar_to_max_degree", static_cast<int>(similar)), 0));
+    caps.recency_tau_days = config.get<double>("edge_recency_tau_days", caps.recency_tau_days);
+    return caps;
+}
+
+bool DegreeCaps::enabled() const {
+    return std::any_of(max_degree.begin(), max_degree.end(), [](uint32_t cap) { return cap > 0; });
+}
+
+double DegreeCaps::retentionKey(const PackedEdge& edge) const {
+    if (!(edge.weight > 0)) return -std::numeric_limits<double>::infinity();
+    double key = std::log(static_cast<double>(edge.weight));
+    if (recency_tau_days > 0) key += static_cast<double>(edge.day) / recency_tau_days;
+    return key;
+}
+
+namespace {
+
+// Position of an edge in its (node, type) list; better ranks are kept
+struct Rank {
+    double key;
+    uint32_t neighbor;
+};
+
+bool better(const Rank& a, const Rank& b) {
+    return a.key != b.key ? a.key > b.key : a.neighbor < b.neighbor;
+}
+
+uint64_t listKey(uint32_t node, uint8_t type) {
+    return (static_cast<uint64_t>(node) << 8) | type;
+}
+
+// Calls fn(first, last) for each same-type run of a sorted adjacency list
+template <typename Fn>
+void forEachTypeRun(std::span<const PackedEdge> edges, Fn&& fn) {
+    size_t first = 0;
+    while (first < edges.size()) {
+        size_t last = first + 1;
+        while (last < edges.size() && edges[last].type == edges[first].type) ++last;
+        fn(first, last);
+        first = last;
+    }
+}
+
+// Worst rank still within the cap of an over-cap run
+Rank cutoff(const DegreeCaps& caps, std::span<const PackedEdge> run, std::vector<Rank>& ranks) {
+    uint32_t cap = caps.max_degree[run.front().type];
+    ranks.clear();
+    for (const PackedEdge& e : run) ranks.push_back(Rank{caps.retentionKey(e), e.dst});
+    std::nth_element(ranks.begin(), ranks.begin() + (cap - 1), ranks.end(), better);
+    return ranks[cap - 1];
+}
+
+bool overCap(const DegreeCaps& caps, size_t run_length, uint8_t type) {
+    uint32_t cap = caps.max_degree[type];
+    return cap > 0 && run_length > cap;
+}
+
+} // namespace
+
+PruneStats pruneToCaps(const GraphSnapshot& graph, const DegreeCaps& caps, CsrBuilder& kept,
+                       std::vector<ColdEdge>& spilled) {
+    PruneStats stats;
+    std::vector<PackedEdge> scratch;
+    std::vector<Rank> ranks;
+
+    // Cutoffs of over-cap in-lists, looked up while walking out-edges
+    std::unordered_map<uint64_t, Rank> in_cutoffs;
+    if (caps.enabled()) {
+        for (uint32_t node = 0; node < graph.nodeCount(); ++node) {
+            auto in = graph.fullEdges(node, Direction::IN, scratch);
+            forEachTypeRun(in, [&](size_t first, size_t last) {
+                if (!overCap(caps, last - first, in[first].type)) return;
+                in_cutoffs.emplace(listKey(node, in[first].type), cutoff(caps, in.subspan(first, last - first), ranks));
+                ++stats.capped_lists;
+            });
+        }
+    }
+
+    for (uint32_t node = 0; node < graph.nodeCount(); ++node) {
+        auto out = graph.fullEdges(node, Direction::OUT, scratch);
+        forEachTypeRun(out, [&](size_t first, size_t last) {
+            bool capped = overCap(caps, last - first, out[first].type);
+            Rank out_cutoff{};
+            if (capped) {
+                out_cutoff = cutoff(caps, out.subspan(first, last - first), ranks);
+                ++stats.capped_lists;
+            }
+            for (size_t i = first; i < last; ++i) {
+                const PackedEdge& e = out[i];
+                double key = caps.retentionKey(e);
+                bool keep = !capped || !better(out_cutoff, Rank{key, e.dst});
+                if (keep && !in_cutoffs.empty()) {
+                    auto it = in_cutoffs.find(listKey(e.dst, e.type));
+                    keep = it == in_cutoffs.end() || !better(it->second, Rank{key, node});
+                }
+                if (keep) {
+                    kept.add(node, e.dst, e.edgeType(), e.weight, e.day);
+                    ++stats.kept;
+                } else {
+                    spilled.push_back(ColdEdge{node, e});
+                    ++stats.spilled;
+                }
+            }
+        });
+    }
+    return stats;
+}
+
+} // namespace memory::graph
@@ -0,0 +1,206 @@
+#include "memory/graph/graph_snapshot.h"
+#include "memory/graph/concept_layer.h"
+#include <algorithm>
+
+namespace memory::graph {
+
+void mergeAdjacency(std::span<const PackedEdge> older, std::span<const PackedEdge> newer,
+                    std::vector<PackedEdge>& out, bool keep_tombstones) {
+    out.clear();
+    out.reserve(older.size() + newer.size());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < older.size() || j < newer.size()) {
+        if (j == newer.size() || (i < older.size() && adjacencyLess(older[i], newer[j]))) {
+            out.push_back(older[i++]);
+            continue;
+        }
+        if (i < older.size() && !adjacencyLess(newer[j], older[i])) {
+            ++i;  // Same (type, neighbor): newer wins
+        }
+        if (keep_tombstones || !newer[j].tombstone()) {
+            out.push_back(newer[j]);
+        }
+        ++j;
+    }
+}
+
+std::optional<uint32_t> NodeTable::find(core::NodeId node) const {
+    auto it = index.find(node);
+    if (it == index.end()) return std::nullopt;
+    return it->second;
+}
+
+DeltaSegment::DeltaSegment(Buffer& out, Buffer& in, NodeTable nodes)
+    : nodes_(std::move(nodes)) {
+    freeze(out, out_);
+    freeze(in, in_);
+}
+
+void DeltaSegment::freeze(Buffer& buffer, Adjacency& adj) {
+    adj.nodes.reserve(buffer.size());
+    size_t total = 0;
+    for (const auto& [node, entries] : buffer) {
+        adj.nodes.push_back(node);
+        total += entries.size();
+    }
+    std::sort(adj.nodes.begin(), adj.nodes.end());
+
+    adj.offsets.reserve(adj.nodes.size() + 1);
+    adj.offsets.push_back(0);
+    adj.edges.reserve(total);
+    for (uint32_t node : adj.nodes) {
+        std::vector<PackedEdge>& entries = buffer[node];
+        // Stable, so the last change to an edge ends up last in its run
+        std::stable_sort(entries.begin(), entries.end(), adjacencyLess);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (i + 1 < entries.size() && !adjacencyLess(entries[i], entries[i + 1])) continue;
+            adj.edges.push_back(entries[i]);
+        }
+        adj.offsets.push_back(static_cast<uint32_t>(adj.edges.size()));
+    }
+    buffer.clear();
+}
+
+std::span<const PackedEdge> DeltaSegment::edges(uint32_t node, Direction direction) const {
+    const Adjacency& adj = direction == Direction::OUT ? out_ : in_;
+    auto it = std::lower_bound(adj.nodes.begin(), adj.nodes.end(), node);
+    if (it == adj.nodes.end() || *it != node) return {};
+    size_t i = static_cast<size_t>(it - adj.nodes.begin());
+    return {adj.edges.data() + adj.offsets[i], adj.edges.data() + adj.offsets[i + 1]};
+}
+
+size_t DeltaSegment::memoryBytes() const {
+    size_t bytes = nodes_.ids.capacity() * sizeof(core::NodeId) +
+                   nodes_.index.size() * (sizeof(core::NodeId) + sizeof(uint32_t) + 2 * sizeof(void*));
+    for (const Adjacency* adj : {&out_, &in_}) {
+        bytes += (adj->nodes.capacity() + adj->offsets.capacity()) * sizeof(uint32_t) +
+                 adj->edges.capacity() * sizeof(PackedEdge);
+    }
+    return bytes;
+}
+
+GraphSnapshot::GraphSnapshot(std::shared_ptr<const CsrGraph> base, std::shared_ptr<const NodeTable> base_nodes,
+                             std::vector<std::shared_ptr<const DeltaSegment>> deltas, uint64_t edge_count,
+                             std::shared_ptr<const ColdEdgeSegment> cold,
+                             std::shared_ptr<const ConceptGraph> concepts)
+    : base_(std::move(base)),
+      base_nodes_(std::move(base_nodes)),
+      deltas_(std::move(deltas)),
+      cold_(std::move(cold)),
+      concepts_(std::move(concepts)),
+      node_count_(deltas_.empty() ? base_nodes_->end() : deltas_.back()->nodes().end()),
+      edge_count_(edge_count) {}
+
+std::optional<uint32_t> GraphSnapshot::nodeIndex(core::NodeId node) const {
+    if (auto index = base_nodes_->find(node)) return index;
+    for (const auto& delta : deltas_) {
+        if (auto index = delta->nodes().find(node)) return index;
+    }
+    return std::nullopt;
+}
+
+core::NodeId GraphSnapshot::nodeId(uint32_t index) const {
+    if (index < base_nodes_->end()) return base_nodes_->ids[index];
+    for (const auto& delta : deltas_) {
+        const NodeTable& nodes = delta->nodes();
+        if (index < nodes.end()) return nodes.ids[index - nodes.first];
+    }
+    return 0;
+}
+
+std::span<const PackedEdge> GraphSnapshot::edges(uint32_t node, Direction direction,
+                                                 std::vector<PackedEdge>& scratch) const {
+    std::span<const PackedEdge> visible;
+    if (node < base_->nodeCount()) {
+        visible = base_->edges(node, direction);
+    }
+    return overlay(visible, false, node, direction, scratch);
+}
+
+std::span<const PackedEdge> GraphSnapshot::fullEdges(uint32_t node, Direction direction,
+                                                     std::vector<PackedEdge>& scratch) const {
+    std::span<const PackedEdge> cold = cold_ ? cold_->edges(node, direction) : std::span<const PackedEdge>{};
+    if (cold.empty()) return edges(node, direction, scratch);
+    std::span<const PackedEdge> hot;
+    if (node < base_->nodeCount()) {
+        hot = base_->edges(node, direction);
+    }
+    mergeAdjacency(hot, cold, scratch);  // Disjoint, so this is a plain merge
+    return overlay(scratch, true, node, direction, scratch);
+}
+
+std::span<const PackedEdge> GraphSnapshot::fullEdges(uint32_t node, Direction direction,
+                                                     std::vector<PackedEdge>& scratch, AdjacencyCache& cache,
+                                                     std::shared_ptr<const AdjacencyBlock>& block) const {
+    std::span<const PackedEdge> cold = cold_ ? cold_->edges(node, direction) : std::span<const PackedEdge>{};
+    if (cold.empty()) return edges(node, direction, scratch);  // Already in memory
+    AdjacencyKey key{node, direction};
+    block = cache.find(key);
+    if (!block || !block->builtFrom(base_)) {
+        auto built = std::make_shared<AdjacencyBlock>();
+        built->base = base_;
+        std::span<const PackedEdge> hot;
+        if (node < base_->nodeCount()) {
+            hot = base_->edges(node, direction);
+        }
+        mergeAdjacency(hot, cold, built->edges);
+        cache.insert(key, built, built->memoryBytes());
+        block = std::move(built);
+    }
+    return overlay(block->edges, false, node, direction, scratch);
+}
+
+std::span<const PackedEdge> GraphSnapshot::overlay(std::span<const PackedEdge> visible, bool in_scratch,
+                                                   uint32_t node, Direction direction,
+                                                   std::vector<PackedEdge>& scratch) const {
+    thread_local std::vector<PackedEdge> merged;
+    for (const auto& delta : deltas_) {
+        std::span<const PackedEdge> changes = delta->edges(node, direction);
+        if (changes.empty()) continue;
+        mergeAdjacency(visible, changes, merged);
+        scratch.swap(merged);
+        visible = scratch;
+        in_scratch = true;
+    }
+    return in_scratch ? std::span<const PackedEdge>(scratch) : visible;
+}
+
+EdgeTypeMask GraphSnapshot::typeMask(uint32_t node, Direction direction) const {
+    EdgeTypeMask mask = node < base_->nodeCount() ? base_->typeMask(node, direction) : 0;
+    for (const auto& delta : deltas_) {
+        for (const PackedEdge& e : delta->edges(node, direction)) {
+            if (!e.tombstone()) mask |= edgeTypeBit(e.edgeType());
+        }
+    }
+    return mask;
+}
+
+uint32_t GraphSnapshot::degreeBound(uint32_t node, Direction direction) const {
+    auto degree = node < base_->nodeCount() ? static_cast<uint32_t>(base_->edges(node, direction).size()) : 0u;
+    for (const auto& delta : deltas_) {
+        degree += static_cast<uint32_t>(delta->edges(node, direction).size());
+    }
+    return degree;
+}
+
+size_t GraphSnapshot::deltaEntryCount() const {
+    size_t count = 0;
+    for (const auto& delta : deltas_) {
+        count += delta->entryCount();
+    }
+    return count;
+}
+
+size_t GraphSnapshot::memoryBytes() const {
+    size_t bytes = base_->memoryBytes() + base_nodes_->ids.capacity() * sizeof(core::NodeId) +
+                   base_nodes_->index.size() * (sizeof(core::NodeId) + sizeof(uint32_t) + 2 * sizeof(void*));
+    for (const auto& delta : deltas_) {
+        bytes += delta->memoryBytes();
+    }
+    if (cold_) bytes += cold_->memoryBytes();
+    if (concepts_) bytes += concepts_->memoryBytes();
+    return bytes;
+}
+
+} // namespace memory::graph
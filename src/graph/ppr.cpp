@@ -0,0 +1,208 @@
+#include "memory/graph/ppr.h"
+#include "memory/core/config.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+
+namespace memory::graph {
+
+namespace {
+
+// Forward push settles at least alpha of the pushed mass and stops pushing
+// once residuals fall below epsilon, so both must stay positive for it to
+// terminate
+constexpr float kMinAlpha = 0.01f;
+constexpr double kMinEpsilon = 1e-12;
+
+} // namespace
+
+PprOptions PprOptions::fromConfig(const core::Config& config) {
+    PprOptions options;
+    options.alpha = std::clamp(config.get<float>("ppr_alpha", options.alpha), kMinAlpha, 1.0f);
+    options.epsilon = std::clamp(config.get<double>("ppr_epsilon", options.epsilon), kMinEpsilon, 1.0);
+    int iterations = config.get<int>("ppr_iterations", static_cast<int>(options.max_iterations));
+    options.max_iterations = iterations > 0 ? static_cast<size_t>(iterations) : 1;
+    return options;
+}
+
+namespace {
+
+constexpr Direction kDirections[] = {Direction::OUT, Direction::IN};
+
+// Valid seeds with their normalized restart probabilities
+std::vector<std::pair<uint32_t, double>> restartDistribution(const GraphSnapshot& graph,
+                                                             std::span<const uint32_t> seeds,
+                                                             std::span<const float> weights) {
+    std::unordered_map<uint32_t, double> merged;
+    for (size_t i = 0; i < seeds.size(); ++i) {
+        if (seeds[i] >= graph.nodeCount()) continue;
+        double w = weights.empty() ? 1.0 : std::max(0.0f, weights[std::min(i, weights.size() - 1)]);
+        if (w > 0) merged[seeds[i]] += w;
+    }
+    double total = 0;
+    for (const auto& [node, w] : merged) total += w;
+    std::vector<std::pair<uint32_t, double>> restart(merged.begin(), merged.end());
+    for (auto& [node, w] : restart) w /= total;
+    std::sort(restart.begin(), restart.end());
+    return restart;
+}
+
+double transitionWeight(const PackedEdge& e, const PprOptions& options) {
+    return static_cast<double>(options.type_weights[e.type]) * std::max(0.0f, e.weight);
+}
+
+double weightedDegree(const GraphSnapshot& graph, uint32_t node, const PprOptions& options,
+                      std::vector<PackedEdge>& scratch) {
+    double degree = 0;
+    for (Direction direction : kDirections) {
+        for (const PackedEdge& e : graph.edges(node, direction, scratch)) {
+            degree += transitionWeight(e, options);
+        }
+    }
+    return degree;
+}
+
+template <typename Scores>
+std::vector<PprScore> sortedScores(const Scores& scores) {
+    std::vector<PprScore> result;
+    for (const auto& [node, score] : scores) {
+        if (score > 0) result.push_back(PprScore{node, static_cast<float>(score)});
+    }
+    std::sort(result.begin(), result.end(), [](const PprScore& a, const PprScore& b) {
+        return a.score != b.score ? a.score > b.score : a.node < b.node;
+    });
+    return result;
+}
+
+} // namespace
+
+std::vector<PprScore> forwardPushPpr(const GraphSnapshot& graph, std::span<const uint32_t> seeds,
+                                     std::span<const float> seed_weights, const PprOptions& options,
+                                     PprStats* stats) {
+    struct NodeState {
+        double estimate = 0;
+        double residual = 0;
+        double degree = -1;  // Weighted degree, computed on first push
+        bool queued = false;
+    };
+    std::unordered_map<uint32_t, NodeState> state;
+    std::deque<uint32_t> queue;
+    std::vector<PackedEdge> scratch;
+    const double alpha = std::clamp(static_cast<double>(options.alpha), static_cast<double>(kMinAlpha), 1.0);
+    const double epsilon = std::max(options.epsilon, kMinEpsilon);
+
+    auto restart = restartDistribution(graph, seeds, seed_weights);
+    auto threshold = [&](const NodeState& s) { return epsilon * std::max(s.degree, 1.0); };
+    auto addResidual = [&](uint32_t node, double mass) {
+        NodeState& s = state[node];
+        s.residual += mass;
+        // Degree is unknown until the first push; treat it as 1 meanwhile
+        if (!s.queued && s.residual > 0 && s.residual >= threshold(s)) {
+            s.queued = true;
+            queue.push_back(node);
+        }
+    };
+    for (const auto& [node, p] : restart) {
+        addResidual(node, p);
+    }
+
+    uint64_t pushes = 0;
+    while (!queue.empty()) {
+        uint32_t node = queue.front();
+        queue.pop_front();
+        // Element references survive rehashing, so s stays valid below
+        NodeState* s = &state[node];
+        s->queued = false;
+        if (s->degree < 0) {
+            s->degree = weightedDegree(graph, node, options, scratch);
+        }
+        if (s->residual <= 0 || s->residual < threshold(*s)) continue;
+
+        double mass = s->residual;
+        s->residual = 0;
+        s->estimate += alpha * mass;
+        double spread = (1.0 - alpha) * mass;
+        ++pushes;
+        if (s->degree <= 0) {
+            for (const auto& [seed, p] : restart) {
+                addResidual(seed, spread * p);
+            }
+            continue;
+        }
+        double scale = spread / s->degree;
+        for (Direction direction : kDirections) {
+            for (const PackedEdge& e : graph.edges(node, direction, scratch)) {
+                double w = transitionWeight(e, options);
+                if (w > 0) addResidual(e.dst, scale * w);
+            }
+        }
+    }
+
+    if (stats) {
+        stats->pushes = pushes;
+        stats->touched = state.size();
+        stats->residual_mass = 0;
+        for (const auto& [node, s] : state) stats->residual_mass += s.residual;
+    }
+    std::vector<std::pair<uint32_t, double>> estimates;
+    estimates.reserve(state.size());
+    for (const auto& [node, s] : state) estimates.emplace_back(node, s.estimate);
+    return sortedScores(estimates);
+}
+
+std::vector<PprScore> powerIterationPpr(const GraphSnapshot& graph, std::span<const uint32_t> seeds,
+                                        std::span<const float> seed_weights, const PprOptions& options,
+                                        PprStats* stats) {
+    const uint32_t n = graph.nodeCount();
+    const double alpha = options.alpha;
+    auto restart = restartDistribution(graph, seeds, seed_weights);
+
+    std::vector<PackedEdge> scratch;
+    std::vector<double> degree(n);
+    for (uint32_t u = 0; u < n; ++u) {
+        degree[u] = weightedDegree(graph, u, options, scratch);
+    }
+
+    std::vector<double> x(n, 0.0);
+    std::vector<double> next(n);
+    for (const auto& [node, p] : restart) x[node] = p;
+    size_t iteration = 0;
+    while (iteration < options.max_iterations) {
+        ++iteration;
+        std::fill(next.begin(), next.end(), 0.0);
+        double stuck = 0;
+        for (uint32_t u = 0; u < n; ++u) {
+            if (x[u] == 0) continue;
+            if (degree[u] <= 0) {
+                stuck += x[u];
+                continue;
+            }
+            double scale = (1.0 - alpha) * x[u] / degree[u];
+            for (Direction direction : kDirections) {
+                for (const PackedEdge& e : graph.edges(u, direction, scratch)) {
+                    next[e.dst] += scale * transitionWeight(e, options);
+                }
+            }
+        }
+        for (const auto& [node, p] : restart) {
+            next[node] += (alpha + (1.0 - alpha) * stuck) * p;
+        }
+        double delta = 0;
+        for (uint32_t u = 0; u < n; ++u) delta += std::fabs(next[u] - x[u]);
+        x.swap(next);
+        if (delta < options.tolerance) break;
+    }
+
+    if (stats) {
+        stats->iterations = iteration;
+        stats->touched = static_cast<size_t>(std::count_if(x.begin(), x.end(), [](double v) { return v > 0; }));
+    }
+    std::vector<std::pair<uint32_t, double>> scores;
+    for (uint32_t u = 0; u < n; ++u) {
+        if (x[u] > 0) scores.emplace_back(u, x[u]);
+    }
+    return sortedScores(scores);
+}
+
+} // namespace memory::graph
@@ -0,0 +1,267 @@
+#include "memory/graph/traversal.h"
+#include "memory/core/thread_pool.h"
+#include <algorithm>
+#include <limits>
+
+namespace memory::graph {
+
+void EpochVisitedSet::begin(uint32_t node_count, uint32_t max_hops) {
+    if (capacity_ < node_count) {
+        // Grow with headroom so a slowly growing graph does not reallocate
+        // on every query
+        size_t capacity = std::max<size_t>(node_count, capacity_ + capacity_ / 4);
+        stamps_ = std::make_unique<std::atomic<uint32_t>[]>(capacity);
+        capacity_ = capacity;
+        next_ = 1;
+    }
+    if (next_ > std::numeric_limits<uint32_t>::max() - max_hops - 1) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            stamps_[i].store(0, std::memory_order_relaxed);
+        }
+        next_ = 1;
+    }
+    base_ = next_;
+    next_ += max_hops + 1;
+}
+
+namespace {
+
+constexpr Direction kDirections[] = {Direction::OUT, Direction::IN};
+
+// One slice of top-down work: frontier[first, last), or a single hub node
+// restricted to [edge_begin, edge_end) of its out-edges followed by its
+// in-edges
+struct TopDownTask {
+    uint32_t first;
+    uint32_t last;
+    uint32_t edge_begin;
+    uint32_t edge_end;
+};
+
+class LevelExpander {
+public:
+    LevelExpander(const GraphSnapshot& graph, EdgeTypeMask types, EpochVisitedSet& visited,
+                  core::ThreadPool* pool, const KHopTuning& tuning)
+        : graph_(graph),
+          types_(types),
+          stamps_(visited.stamps()),
+          base_(visited.base()),
+          pool_(pool),
+          tuning_(tuning),
+          workers_(pool ? pool->size() + 1 : 1),
+          next_parts_(workers_),
+          scratch_(workers_ * 2) {}
+
+    bool parallel(size_t work) const { return workers_ > 1 && work >= tuning_.parallel_threshold; }
+
+    void topDown(const std::vector<uint32_t>& frontier, uint64_t frontier_edges, uint32_t hop,
+                 std::vector<uint32_t>& next) {
+        uint32_t stamp = base_ + hop;
+        if (!parallel(frontier_edges)) {
+            for (uint32_t node : frontier) {
+                for (Direction direction : kDirections) {
+                    EdgeTypeMask present = graph_.typeMask(node, direction) & types_;
+                    if (!present) continue;
+                    for (const PackedEdge& e : graph_.edges(node, direction, scratch_[0])) {
+                        if (!(present & edgeTypeBit(e.edgeType()))) continue;
+                        if (stamps_[e.dst].load(std::memory_order_relaxed) < base_) {
+                            stamps_[e.dst].store(stamp, std::memory_order_relaxed);
+                            next.push_back(e.dst);
+                        }
+                    }
+                }
+            }
+            return;
+        }
+
+        // Split by edges so one hub does not serialize the level
+        uint64_t chunk = std::max<uint64_t>({1, tuning_.parallel_threshold / 4, frontier_edges / (workers_ * 4)});
+        tasks_.clear();
+        uint64_t pending = 0;
+        uint32_t first = 0;
+        for (uint32_t i = 0; i < frontier.size(); ++i) {
+            uint64_t degree = graph_.degreeBound(frontier[i], Direction::OUT) +
+                              graph_.degreeBound(frontier[i], Direction::IN);
+            if (degree > chunk) {
+                if (first < i) tasks_.push_back(TopDownTask{first, i, 0, 0});
+                for (uint64_t begin = 0; begin < degree; begin += chunk) {
+                    auto end = static_cast<uint32_t>(std::min(degree, begin + chunk));
+                    tasks_.push_back(TopDownTask{i, i + 1, static_cast<uint32_t>(begin), end});
+                }
+                first = i + 1;
+                pending = 0;
+                continue;
+            }
+            pending += degree;
+            if (pending >= chunk) {
+                tasks_.push_back(TopDownTask{first, i + 1, 0, 0});
+                first = i + 1;
+                pending = 0;
+            }
+        }
+        if (first < frontier.size()) {
+            tasks_.push_back(TopDownTask{first, static_cast<uint32_t>(frontier.size()), 0, 0});
+        }
+
+        pool_->parallelFor(tasks_.size(), [&](size_t t, size_t worker) {
+            const TopDownTask& task = tasks_[t];
+            std::vector<uint32_t>& part = next_parts_[worker];
+            auto visit = [&](const PackedEdge& e, EdgeTypeMask present) {
+                if (!(present & edgeTypeBit(e.edgeType()))) return;
+                uint32_t seen = stamps_[e.dst].load(std::memory_order_relaxed);
+                while (seen < base_) {
+                    if (stamps_[e.dst].compare_exchange_weak(seen, stamp, std::memory_order_relaxed)) {
+                        part.push_back(e.dst);
+                        return;
+                    }
+                }
+            };
+            if (task.edge_end == 0) {
+                for (uint32_t i = task.first; i < task.last; ++i) {
+                    for (Direction direction : kDirections) {
+                        EdgeTypeMask present = graph_.typeMask(frontier[i], direction) & types_;
+                        if (!present) continue;
+                        for (const PackedEdge& e : graph_.edges(frontier[i], direction, scratch_[worker * 2])) {
+                            visit(e, present);
+                        }
+                    }
+                }
+                return;
+            }
+            uint32_t node = frontier[task.first];
+            auto out = graph_.edges(node, Direction::OUT, scratch_[worker * 2]);
+            auto in = graph_.edges(node, Direction::IN, scratch_[worker * 2 + 1]);
+            EdgeTypeMask out_present = graph_.typeMask(node, Direction::OUT) & types_;
+            EdgeTypeMask in_present = graph_.typeMask(node, Direction::IN) & types_;
+            size_t end = std::min<size_t>(task.edge_end, out.size() + in.size());
+            for (size_t e = task.edge_begin; e < end; ++e) {
+                if (e < out.size()) {
+                    visit(out[e], out_present);
+                } else {
+                    visit(in[e - out.size()], in_present);
+                }
+            }
+        });
+        gather(next);
+    }
+
+    void bottomUp(uint32_t hop, std::vector<uint32_t>& next) {
+        uint32_t node_count = graph_.nodeCount();
+        uint32_t frontier_stamp = base_ + hop - 1;
+        uint32_t stamp = base_ + hop;
+        // Each unvisited node looks for any neighbor on the frontier. Only
+        // the task owning a node writes its stamp, so no CAS is needed.
+        auto scan = [&](uint32_t first, uint32_t last, std::vector<PackedEdge>& scratch,
+                        std::vector<uint32_t>& found) {
+            for (uint32_t node = first; node < last; ++node) {
+                if (stamps_[node].load(std::memory_order_relaxed) >= base_) continue;
+                bool hit = false;
+                for (Direction direction : kDirections) {
+                    EdgeTypeMask present = graph_.typeMask(node, direction) & types_;
+                    if (!present) continue;
+                    for (const PackedEdge& e : graph_.edges(node, direction, scratch)) {
+                        if ((present & edgeTypeBit(e.edgeType())) &&
+                            stamps_[e.dst].load(std::memory_order_relaxed) == frontier_stamp) {
+                            hit = true;
+                            break;
+                        }
+                    }
+                    if (hit) break;
+                }
+                if (hit) {
+                    stamps_[node].store(stamp, std::memory_order_relaxed);
+                    found.push_back(node);
+                }
+            }
+        };
+
+        if (!parallel(node_count)) {
+            scan(0, node_count, scratch_[0], next);
+            return;
+        }
+        uint32_t chunk = static_cast<uint32_t>(
+            std::max<size_t>(4096, node_count / (workers_ * 8)));
+        size_t tasks = (static_cast<size_t>(node_count) + chunk - 1) / chunk;
+        pool_->parallelFor(tasks, [&](size_t t, size_t worker) {
+            auto first = static_cast<uint32_t>(t * chunk);
+            uint32_t last = std::min(node_count, first + chunk);
+            scan(first, last, scratch_[worker * 2], next_parts_[worker]);
+        });
+        gather(next);
+    }
+
+private:
+    void gather(std::vector<uint32_t>& next) {
+        for (auto& part : next_parts_) {
+            next.insert(next.end(), part.begin(), part.end());
+            part.clear();
+        }
+    }
+
+    const GraphSnapshot& graph_;
+    EdgeTypeMask types_;
+    std::atomic<uint32_t>* stamps_;
+    uint32_t base_;
+    core::ThreadPool* pool_;
+    const KHopTuning& tuning_;
+    size_t workers_;
+    std::vector<std::vector<uint32_t>> next_parts_;
+    std::vector<std::vector<PackedEdge>> scratch_;  // Two per worker
+    std::vector<TopDownTask> tasks_;
+};
+
+} // namespace
+
+KHopStats expandKHop(const GraphSnapshot& graph, std::span<const uint32_t> seeds, uint32_t k, EdgeTypeMask types,
+                     EpochVisitedSet& visited, std::vector<HopIndex>& out, core::ThreadPool* pool,
+                     const KHopTuning& tuning) {
+    KHopStats stats;
+    uint32_t node_count = graph.nodeCount();
+    visited.begin(node_count, k);
+    std::atomic<uint32_t>* stamps = visited.stamps();
+    uint32_t base = visited.base();
+
+    std::vector<uint32_t> frontier;
+    for (uint32_t seed : seeds) {
+        if (seed >= node_count || stamps[seed].load(std::memory_order_relaxed) >= base) continue;
+        stamps[seed].store(base, std::memory_order_relaxed);
+        frontier.push_back(seed);
+        out.push_back(HopIndex{seed, 0});
+    }
+    if (k == 0 || frontier.empty()) return stats;
+
+    LevelExpander expander(graph, types, visited, pool, tuning);
+    uint64_t unexplored = graph.edgeCount() * 2;  // Every edge is seen from both ends
+    bool bottom_up = false;
+    std::vector<uint32_t> next;
+    for (uint32_t hop = 1; hop <= k && !frontier.empty(); ++hop) {
+        uint64_t frontier_edges = 0;
+        for (uint32_t node : frontier) {
+            frontier_edges += graph.degreeBound(node, Direction::OUT) + graph.degreeBound(node, Direction::IN);
+        }
+        unexplored = unexplored > frontier_edges ? unexplored - frontier_edges : 0;
+        if (!bottom_up) {
+            bottom_up = static_cast<double>(frontier_edges) > static_cast<double>(unexplored) / tuning.alpha;
+        } else {
+            bottom_up = static_cast<double>(frontier.size()) >= static_cast<double>(node_count) / tuning.beta;
+        }
+
+        next.clear();
+        if (bottom_up) {
+            stats.parallel_levels += expander.parallel(node_count);
+            expander.bottomUp(hop, next);
+            ++stats.bottom_up_levels;
+        } else {
+            stats.parallel_levels += expander.parallel(frontier_edges);
+            expander.topDown(frontier, frontier_edges, hop, next);
+            ++stats.top_down_levels;
+        }
+        for (uint32_t node : next) {
+            out.push_back(HopIndex{node, hop});
+        }
+        frontier.swap(next);
+    }
+    return stats;
+}
+
+} // namespace memory::graph
@@ -0,0 +1,305 @@
+#include "memory/pipeline/recall_pipeline.h"
+#include "memory/core/config.h"
+#include "memory/core/logger.h"
+#include "memory/core/manifest.h"
+#include "memory/core/node_store.h"
+#include "memory/core/thread_pool.h"
+#include "memory/graph/csr_graph_store.h"
+#include "memory/search/inverted_index.h"
+#include "memory/vector/hnsw_index.h"
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace memory::pipeline {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// What a stage hands back; finished tells whether it made its deadline
+struct StageOutput {
+    std::vector<core::ScoredId> hits;
+    Clock::time_point finished;
+    bool unavailable = false;
+    std::string detail;
+};
+
+double millisBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+std::chrono::milliseconds readMillis(const core::Config& config, const std::string& key,
+                                     std::chrono::milliseconds fallback) {
+    int millis = config.get<int>(key, static_cast<int>(fallback.count()));
+    return std::chrono::milliseconds(std::max(millis, 1));
+}
+
+template <typename F>
+std::future<StageOutput> launch(core::ThreadPool& pool, F&& stage) {
+    if (pool.size() > 0) return pool.submit(std::forward<F>(stage));
+    std::promise<StageOutput> promise;
+    try {
+        promise.set_value(stage());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    return promise.get_future();
+}
+
+// Hits of the stage if it answered by deadline; otherwise records why not
+std::optional<std::vector<core::ScoredId>> await(std::future<StageOutput>& future, Clock::time_point started,
+                                                 Clock::time_point deadline, StageTrace& trace) {
+    bool ready = future.wait_until(deadline) == std::future_status::ready;
+    trace.millis = millisBetween(started, Clock::now());
+    if (!ready) {
+        trace.status = StageStatus::TIMED_OUT;
+        return std::nullopt;
+    }
+    StageOutput output;
+    try {
+        output = future.get();
+    } catch (const std::exception& e) {
+        trace.status = StageStatus::FAILED;
+        trace.detail = e.what();
+        return std::nullopt;
+    }
+    trace.millis = millisBetween(started, output.finished);
+    if (output.finished > deadline) {
+        trace.status = StageStatus::TIMED_OUT;
+        return std::nullopt;
+    }
+    if (output.unavailable) {
+        trace.status = StageStatus::UNAVAILABLE;
+        trace.detail = std::move(output.detail);
+        return std::nullopt;
+    }
+    trace.status = StageStatus::OK;
+    trace.hits = output.hits.size();
+    return std::move(output.hits);
+}
+
+// Adds weight * score / best of hits into scores
+void addTerm(std::unordered_map<core::NodeId, float>& scores, const std::vector<core::ScoredId>& hits,
+             float weight) {
+    float best = 0.0f;
+    for (const core::ScoredId& hit : hits) best = std::max(best, hit.score);
+    if (best <= 0.0f) return;
+    for (const core::ScoredId& hit : hits) scores[hit.id] += weight * std::max(hit.score, 0.0f) / best;
+}
+
+// Writes score / best of hits into column, adding candidates not seen yet
+void addColumn(CandidateColumns& columns, std::unordered_map<core::NodeId, size_t>& position,
+               const std::vector<core::ScoredId>& hits, std::vector<float> CandidateColumns::*column) {
+    float best = 0.0f;
+    for (const core::ScoredId& hit : hits) best = std::max(best, hit.score);
+    if (best <= 0.0f) return;
+    for (const core::ScoredId& hit : hits) {
+        auto [it, added] = position.try_emplace(hit.id, columns.size());
+        if (added) columns.add(hit.id);
+        (columns.*column)[it->second] = std::max(hit.score, 0.0f) / best;
+    }
+}
+
+std::string queryText(const core::RecallQuery& query) {
+    std::string text = query.text;
+    for (const std::string& keyword : query.keywords) {
+        if (!text.empty()) text += ' ';
+        text += keyword;
+    }
+    return text;
+}
+
+} // namespace
+
+RecallPipelineOptions RecallPipelineOptions::fromConfig(const core::Config& config) {
+    RecallPipelineOptions options;
+    options.weights = ScoreWeights::fromConfig(config);
+    int candidates = config.get<int>("topk_candidates", static_cast<int>(options.topk_candidates));
+    options.topk_candidates = static_cast<size_t>(std::max(candidates, 1));
+    int topk = config.get<int>("recall_topk", static_cast<int>(options.topk));
+    options.topk = static_cast<size_t>(std::max(topk, 1));
+    options.max_k_hop = std::clamp(config.get<int>("max_k_hop", options.max_k_hop), 0, 8);
+    // vector.enabled
+    options.vector_enabled = config.get<bool>("enabled", options.vector_enabled);
+    int threads = config.get<int>("max_threads", static_cast<int>(options.max_threads));
+    options.max_threads = static_cast<size_t>(std::max(threads, 1));
+    options.bm25_deadline = readMillis(config, "bm25_deadline_ms", options.bm25_deadline);
+    options.vector_deadline = readMillis(config, "vector_deadline_ms", options.vector_deadline);
+    options.graph_deadline = readMillis(config, "graph_deadline_ms", options.graph_deadline);
+    return options;
+}
+
+std::string stageStatusToString(StageStatus status) {
+    switch (status) {
+        case StageStatus::OK: return "ok";
+        case StageStatus::SKIPPED: return "skipped";
+        case StageStatus::UNAVAILABLE: return "unavailable";
+        case StageStatus::TIMED_OUT: return "timed_out";
+        case StageStatus::FAILED: return "failed";
+        default: return "unknown";
+    }
+}
+
+RecallPipeline::RecallPipeline(RecallPipelineOptions options, RecallSources sources,
+                               std::shared_ptr<core::ThreadPool> pool)
+    : options_(std::move(options)), sources_(std::move(sources)), pool_(std::move(pool)) {
+    if (!pool_) pool_ = std::make_shared<core::ThreadPool>(std::max<size_t>(options_.max_threads, 1));
+    if (sources_.versions) {
+        pinned_search_ = std::dynamic_pointer_cast<const search::InvertedIndex>(sources_.search);
+        pinned_vectors_ = std::dynamic_pointer_cast<const vector::HnswIndex>(sources_.vectors);
+    }
+}
+
+RecallPipeline::~RecallPipeline() = default;
+
+std::vector<core::ScoredId> RecallPipeline::Run(const core::RecallQuery& query) {
+    return Run(query, nullptr);
+}
+
+std::vector<core::ScoredId> RecallPipeline::Run(const core::RecallQuery& query, RecallTrace* trace) {
+    Clock::time_point started = Clock::now();
+    RecallTrace local;
+    RecallTrace& t = trace ? *trace : local;
+    t = RecallTrace();
+    std::string text = queryText(query);
+    size_t candidates = options_.topk_candidates;
+    // Pinned once, so every stage reads the same version of its engine
+    std::shared_ptr<const core::StoreView> view = sources_.versions ? sources_.versions->current() : nullptr;
+
+    // Stages capture what they use by value: one that misses its deadline
+    // may outlive this call, and the pipeline itself, so nothing may be
+    // captured by reference
+    std::optional<std::future<StageOutput>> bm25;
+    if (sources_.search) {
+        bm25 = launch(*pool_, [search = sources_.search, pinned = pinned_search_, view, text, candidates] {
+            StageOutput output;
+            if (pinned && view && view->search) {
+                output.hits = pinned->Search(*view->search, text, candidates);
+            } else {
+                output.hits = search->Search(text, candidates);
+            }
+            output.finished = Clock::now();
+            return output;
+        });
+    } else {
+        t.bm25.detail = "no search index";
+    }
+
+    std::optional<std::future<StageOutput>> ann;
+    if (!options_.vector_enabled) {
+        t.vector.detail = "vector.enabled is off";
+    } else if (!sources_.vectors) {
+        t.vector.detail = "no vector index";
+    } else if (!sources_.embed) {
+        t.vector.status = StageStatus::UNAVAILABLE;
+        t.vector.detail = "no embedder";
+    } else {
+        ann = launch(*pool_, [vectors = sources_.vectors, pinned = pinned_vectors_, view, embed = sources_.embed, text,
+                              candidates] {
+            StageOutput output;
+            std::vector<float> embedding = embed(text);
+            if (embedding.empty()) {
+                output.unavailable = true;
+                output.detail = "embedding unavailable";
+            } else if (pinned && view && view->vector) {
+                output.hits = pinned->Search(*view->vector, embedding, candidates);
+            } else {
+                output.hits = vectors->Search(embedding, candidates);
+            }
+            output.finished = Clock::now();
+            return output;
+        });
+    }
+
+    std::vector<core::ScoredId> bm25_hits;
+    std::vector<core::ScoredId> vector_hits;
+    std::vector<core::ScoredId> graph_hits;
+    if (bm25) {
+        if (auto hits = await(*bm25, started, started + options_.bm25_deadline, t.bm25)) bm25_hits = std::move(*hits);
+    }
+    if (ann) {
+        if (auto hits = await(*ann, started, started + options_.vector_deadline, t.vector)) {
+            vector_hits = std::move(*hits);
+        }
+    }
+
+    // Seeds of stage C, weighted by their first-stage scores
+    std::unordered_map<core::NodeId, float> seed_scores;
+    addTerm(seed_scores, bm25_hits, options_.weights.bm25);
+    addTerm(seed_scores, vector_hits, options_.weights.vector);
+    if (!sources_.graph) {
+        t.graph.detail = "no graph store";
+    } else if (seed_scores.empty()) {
+        t.graph.status = StageStatus::UNAVAILABLE;
+        t.graph.detail = "no seeds";
+    } else {
+        std::vector<core::NodeId> seeds;
+        std::vector<float> weights;
+        for (const auto& [node, score] : seed_scores) {
+            seeds.push_back(node);
+            weights.push_back(std::max(score, 1e-6f));
+        }
+        core::RecallQuery expansion = query;
+        expansion.k_hop = std::clamp(query.k_hop, 0, options_.max_k_hop);
+        Clock::time_point graph_started = Clock::now();
+        auto expand = launch(*pool_, [store = sources_.graph, view, seeds = std::move(seeds),
+                                     weights = std::move(weights), expansion = std::move(expansion), candidates] {
+            // Expansion and ranking see the same version of the graph
+            std::shared_ptr<const graph::GraphSnapshot> snapshot =
+                view && view->graph ? view->graph : store->snapshot();
+            std::vector<graph::HopNode> reached = store->ExpandSeeds(*snapshot, seeds, expansion);
+            std::vector<core::ScoredId> ranks = store->PersonalizedPageRank(*snapshot, seeds, candidates, weights);
+            std::unordered_map<core::NodeId, float> rank_of;
+            for (const core::ScoredId& rank : ranks) rank_of.emplace(rank.id, rank.score);
+            StageOutput output;
+            for (const graph::HopNode& hop : reached) {
+                auto it = rank_of.find(hop.node);
+                if (it != rank_of.end()) output.hits.push_back({hop.node, it->second});
+            }
+            output.finished = Clock::now();
+            return output;
+        });
+        if (auto hits = await(expand, graph_started, graph_started + options_.graph_deadline, t.graph)) {
+            graph_hits = std::move(*hits);
+        }
+    }
+
+    // §5.3 score over the union; a missing stage drops its term (§18)
+    CandidateColumns columns;
+    columns.reserve(bm25_hits.size() + vector_hits.size() + graph_hits.size());
+    std::unordered_map<core::NodeId, size_t> position;
+    position.reserve(columns.ids.capacity());
+    addColumn(columns, position, bm25_hits, &CandidateColumns::bm25);
+    addColumn(columns, position, vector_hits, &CandidateColumns::cosine);
+    addColumn(columns, position, graph_hits, &CandidateColumns::graph);
+    if (sources_.nodes) columns.gather(*sources_.nodes, std::chrono::system_clock::now());
+    std::vector<float> scores;
+    combineScores(columns, options_.weights, scores);
+    std::vector<core::ScoredId> results = selectTopK(columns.ids, scores, options_.topk);
+    std::erase_if(results, [](const core::ScoredId& result) { return result.score <= 0.0f; });
+
+    for (auto [stage, name] : {std::pair{&t.bm25, "A"}, std::pair{&t.vector, "B"}, std::pair{&t.graph, "C"}}) {
+        if (stage->status == StageStatus::OK) {
+            if (!t.path.empty()) t.path += "→";
+            t.path += name;
+        } else if (stage->status != StageStatus::SKIPPED) {
+            t.degraded = true;
+        }
+    }
+    if (t.path.empty()) t.path = "none";
+    t.millis = millisBetween(started, Clock::now());
+    if (t.degraded) {
+        std::string message = "Recall degraded to " + t.path;
+        message += " (A " + stageStatusToString(t.bm25.status);
+        message += ", B " + stageStatusToString(t.vector.status);
+        message += ", C " + stageStatusToString(t.graph.status) + ")";
+        LOG_DEBUG(message);
+    }
+    return results;
+}
+
+} // namespace memory::pipeline
@@ -0,0 +1,275 @@
+#include "memory/pipeline/score_combiner.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/node_store.h"
+#include "memory/core/top_k.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#if defined(MEMORY_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+namespace memory::pipeline {
+
+namespace {
+
+constexpr float kMillisPerDay = 86400000.0f;
+
+std::array<float, kNodeTypeSlots> inverseTau(const ScoreWeights& weights) {
+    std::array<float, kNodeTypeSlots> inverse{};
+    for (size_t slot = 0; slot < kNodeTypeSlots; ++slot) inverse[slot] = 1.0f / weights.tau_days[slot];
+    return inverse;
+}
+
+float combineOne(const CandidateColumns& c, const ScoreWeights& w, const std::array<float, kNodeTypeSlots>& inv_tau,
+                 size_t i) {
+    float decay = std::exp(-c.age_days[i] * inv_tau[c.types[i] % kNodeTypeSlots]);
+    float weight = w.importance * c.importance[i] + w.frequency * std::log1p(c.frequency[i]) + w.recency * decay;
+    return w.bm25 * c.bm25[i] + w.vector * c.cosine[i] + w.graph * c.graph[i] + w.node * weight;
+}
+
+// === Scalar ===
+
+void combineScalar(const CandidateColumns& columns, const ScoreWeights& weights, float* out) {
+    std::array<float, kNodeTypeSlots> inv_tau = inverseTau(weights);
+    for (size_t i = 0; i < columns.size(); ++i) out[i] = combineOne(columns, weights, inv_tau, i);
+}
+
+const ScoreKernels kScalarKernels{"scalar", core::SimdLevel::SCALAR, combineScalar};
+
+// === AVX2 + FMA ===
+
+#if defined(MEMORY_ARCH_X86)
+
+// e^x after Cephes expf: x = n·ln2 + r with |r| <= ln2 / 2, e^r by a
+// degree-7 polynomial, 2^n through the exponent bits. Inputs are clamped
+// to the normal range, so e^-∞ comes out as ~1e-38 rather than 0.
+MEMORY_TARGET("avx2,fma")
+inline __m256 expAvx2(__m256 x) {
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.0f));
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504f)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    // ln2 in two parts keeps r exact
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+    __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+    __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(exponent));
+}
+
+// ln(1 + f) for f >= 0 after Cephes logf: 1 + f = m·2^e with m in
+// [√½, √2), ln m by a degree-9 polynomial in m - 1
+MEMORY_TARGET("avx2,fma")
+inline __m256 log1pAvx2(__m256 f) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256i bits = _mm256_castps_si256(_mm256_add_ps(f, one));
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+    __m256 m = _mm256_castsi256_ps(
+        _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+    __m256 high = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), high);
+    e = _mm256_add_ps(e, _mm256_and_ps(high, one));
+    m = _mm256_sub_ps(m, one);
+
+    __m256 z = _mm256_mul_ps(m, m);
+    __m256 y = _mm256_set1_ps(7.0376836292e-2f);
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.1514610310e-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.1676998740e-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.2420140846e-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.4249322787e-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.6668057665e-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(2.0000714765e-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-2.4999993993e-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(3.3333331174e-1f));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+    y = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, y);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), _mm256_add_ps(m, y));
+}
+
+MEMORY_TARGET("avx2,fma")
+void combineAvx2(const CandidateColumns& columns, const ScoreWeights& weights, float* out) {
+    std::array<float, kNodeTypeSlots> inv_tau = inverseTau(weights);
+    // Eight types fit one register, so 1/τ is a permute instead of a gather
+    const __m256 tau_table = _mm256_loadu_ps(inv_tau.data());
+    const __m256i slot_mask = _mm256_set1_epi32(static_cast<int>(kNodeTypeSlots - 1));
+    const __m256 bm25 = _mm256_set1_ps(weights.bm25);
+    const __m256 vector = _mm256_set1_ps(weights.vector);
+    const __m256 graph = _mm256_set1_ps(weights.graph);
+    const __m256 node = _mm256_set1_ps(weights.node);
+    const __m256 importance = _mm256_set1_ps(weights.importance);
+    const __m256 frequency = _mm256_set1_ps(weights.frequency);
+    const __m256 recency = _mm256_set1_ps(weights.recency);
+
+    size_t n = columns.size();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i types = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(columns.types.data() + i));
+        __m256 inverse = _mm256_permutevar8x32_ps(tau_table, _mm256_and_si256(_mm256_cvtepu8_epi32(types), slot_mask));
+        __m256 decay = expAvx2(_mm256_fnmadd_ps(_mm256_loadu_ps(columns.age_days.data() + i), inverse,
+                                                _mm256_setzero_ps()));
+        __m256 weight = _mm256_mul_ps(importance, _mm256_loadu_ps(columns.importance.data() + i));
+        weight = _mm256_fmadd_ps(frequency, log1pAvx2(_mm256_loadu_ps(columns.frequency.data() + i)), weight);
+        weight = _mm256_fmadd_ps(recency, decay, weight);
+
+        __m256 score = _mm256_mul_ps(bm25, _mm256_loadu_ps(columns.bm25.data() + i));
+        score = _mm256_fmadd_ps(vector, _mm256_loadu_ps(columns.cosine.data() + i), score);
+        score = _mm256_fmadd_ps(graph, _mm256_loadu_ps(columns.graph.data() + i), score);
+        score = _mm256_fmadd_ps(node, weight, score);
+        _mm256_storeu_ps(out + i, score);
+    }
+    for (; i < n; ++i) out[i] = combineOne(columns, weights, inv_tau, i);
+}
+
+const ScoreKernels kAvx2Kernels{"avx2", core::SimdLevel::AVX2, combineAvx2};
+
+#endif
+
+float readTau(const core::Config& config, const std::string& key, float fallback) {
+    // At least an hour, so 1/τ stays finite
+    return std::max(config.get<float>(key, fallback), 1.0f / 24.0f);
+}
+
+} // namespace
+
+ScoreWeights ScoreWeights::fromConfig(const core::Config& config) {
+    ScoreWeights weights;
+    weights.bm25 = std::max(config.get<float>("bm25_weight", weights.bm25), 0.0f);
+    weights.vector = std::max(config.get<float>("vector_weight", weights.vector), 0.0f);
+    weights.graph = std::max(config.get<float>("graph_weight", weights.graph), 0.0f);
+    weights.node = std::max(config.get<float>("node_weight", weights.node), 0.0f);
+    weights.importance = std::max(config.get<float>("importance_weight", weights.importance), 0.0f);
+    weights.frequency = std::max(config.get<float>("frequency_weight", weights.frequency), 0.0f);
+    weights.recency = std::max(config.get<float>("recency_weight", weights.recency), 0.0f);
+
+    float episode = readTau(config, "episode_tau", weights.tau(core::NodeType::EPISODE));
+    float fact = readTau(config, "fact_tau", weights.tau(core::NodeType::FACT));
+    float abstract = readTau(config, "concept_tau", weights.tau(core::NodeType::CONCEPT));
+    weights.tau_days.fill(abstract);
+    weights.tau_days[static_cast<size_t>(core::NodeType::EPISODE)] = episode;
+    for (core::NodeType type : {core::NodeType::FACT, core::NodeType::PREFERENCE, core::NodeType::TASK}) {
+        weights.tau_days[static_cast<size_t>(type)] = fact;
+    }
+    return weights;
+}
+
+void CandidateColumns::clear() {
+    ids.clear();
+    bm25.clear();
+    cosine.clear();
+    graph.clear();
+    types.clear();
+    importance.clear();
+    frequency.clear();
+    age_days.clear();
+}
+
+void CandidateColumns::reserve(size_t n) {
+    ids.reserve(n);
+    bm25.reserve(n);
+    cosine.reserve(n);
+    graph.reserve(n);
+    types.reserve(n);
+    importance.reserve(n);
+    frequency.reserve(n);
+    age_days.reserve(n);
+}
+
+size_t CandidateColumns::add(core::NodeId id) {
+    ids.push_back(id);
+    bm25.push_back(0.0f);
+    cosine.push_back(0.0f);
+    graph.push_back(0.0f);
+    types.push_back(0);
+    importance.push_back(0.0f);
+    frequency.push_back(0.0f);
+    age_days.push_back(std::numeric_limits<float>::infinity());
+    return ids.size() - 1;
+}
+
+void CandidateColumns::gather(const core::NodeStore& nodes, core::Timestamp now) {
+    int64_t now_ms = core::NodeStore::toMillis(now);
+    std::span<const core::NodeType> node_types = nodes.types();
+    std::span<const float> node_importance = nodes.importance();
+    std::span<const uint32_t> node_frequency = nodes.frequency();
+    std::span<const int64_t> node_recency = nodes.recencyMillis();
+    for (size_t i = 0; i < size(); ++i) {
+        std::optional<uint32_t> index = nodes.find(ids[i]);
+        if (!index) continue;
+        types[i] = static_cast<uint8_t>(node_types[*index]);
+        importance[i] = node_importance[*index];
+        frequency[i] = static_cast<float>(node_frequency[*index]);
+        age_days[i] = std::max(static_cast<float>(now_ms - node_recency[*index]) / kMillisPerDay, 0.0f);
+    }
+}
+
+const ScoreKernels* scoreKernels(core::SimdLevel level) {
+    if (!core::simdLevelSupported(level)) return nullptr;
+    switch (level) {
+        case core::SimdLevel::SCALAR: return &kScalarKernels;
+#if defined(MEMORY_ARCH_X86)
+        case core::SimdLevel::AVX2: return core::cpuFeatures().fma ? &kAvx2Kernels : nullptr;
+#endif
+        default: return nullptr;
+    }
+}
+
+const ScoreKernels& scoreKernels() {
+    static const ScoreKernels* kernels = [] {
+        const ScoreKernels* best = scoreKernels(core::bestSimdLevel());
+        return best ? best : &kScalarKernels;
+    }();
+    return *kernels;
+}
+
+float nodeWeight(const ScoreWeights& weights, core::NodeType type, float importance, float frequency,
+                 float age_days) {
+    return weights.importance * importance + weights.frequency * std::log1p(frequency) +
+           weights.recency * std::exp(-age_days / weights.tau(type));
+}
+
+void combineScores(const CandidateColumns& columns, const ScoreWeights& weights, std::vector<float>& scores) {
+    size_t n = columns.size();
+    for (size_t column : {columns.bm25.size(), columns.cosine.size(), columns.graph.size(), columns.types.size(),
+                          columns.importance.size(), columns.frequency.size(), columns.age_days.size()}) {
+        if (column != n) throw core::QueryException("Candidate columns differ in length");
+    }
+    scores.resize(n);
+    if (n > 0) scoreKernels().combine(columns, weights, scores.data());
+}
+
+std::vector<core::ScoredId> selectTopK(std::span<const core::NodeId> ids, std::span<const float> scores, size_t k) {
+    size_t n = std::min(ids.size(), scores.size());
+    k = std::min(k, n);
+    if (k == 0) return {};
+
+    // Few winners: a bounded heap, and most candidates fail one comparison
+    // against its threshold without being touched
+    if (k * 8 <= n) {
+        core::TopKCollector top(k);
+        for (size_t i = 0; i < n; ++i) {
+            if (scores[i] < top.threshold()) continue;
+            top.push(ids[i], scores[i]);
+        }
+        return top.take();
+    }
+
+    std::vector<core::ScoredId> selected(n);
+    for (size_t i = 0; i < n; ++i) selected[i] = {ids[i], scores[i]};
+    auto cut = selected.begin() + static_cast<ptrdiff_t>(k);
+    std::nth_element(selected.begin(), cut, selected.end(), core::TopKCollector::better);
+    selected.resize(k);
+    std::sort(selected.begin(), selected.end(), core::TopKCollector::better);
+    return selected;
+}
+
+} // namespace memory::pipeline
@@ -0,0 +1,691 @@
+#include "memory/search/inverted_index.h"
+#include "memory/search/query_parser.h"
+#include "memory/search/simd_kernels.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/logger.h"
+#include "memory/core/manifest.h"
+#include "memory/core/top_k.h"
+#include "memory/core/wal.h"
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace memory::search {
+
+namespace {
+
+// Ops of WalStream::SEARCH records
+enum : uint8_t {
+    kWalUpsert = 1,  // doc id, text, fields
+    kWalRemove = 2   // doc id
+};
+
+// Postings read between two rate limiter charges while merging
+constexpr size_t kMergeChargeBytes = 64 << 10;
+
+// Bytes a segment occupies, mapped dictionary included
+uint64_t storedBytes(const Segment& segment) {
+    return segment.memoryBytes() + (segment.dictionaryMapped() ? segment.dictionaryImage().size() : 0);
+}
+
+double fragmentationOf(const SearchSnapshot& snapshot) {
+    uint64_t stored = 0;
+    uint64_t live = 0;
+    for (const auto& part : snapshot.segments) {
+        stored += part.segment->docCount();
+        live += part.live_count;
+    }
+    return stored ? static_cast<double>(stored - live) / static_cast<double>(stored) : 0.0;
+}
+
+// Re-inverts the docs of inputs live in version into one segment ordered by
+// doc id. sources receives the (input, ordinal) each merged doc came from.
+// Returns null if no doc is live.
+std::unique_ptr<Segment> mergeSegments(const std::vector<const Segment*>& inputs, uint64_t version,
+                                       bool with_positions, const std::string& dictionary_path,
+                                       core::RateLimiter& limiter,
+                                       std::vector<std::pair<uint32_t, uint32_t>>& sources) {
+    std::vector<std::tuple<uint64_t, uint32_t, uint32_t>> live;  // (doc id, input, ordinal)
+    for (uint32_t i = 0; i < inputs.size(); ++i) {
+        for (uint32_t ord = 0; ord < inputs[i]->docCount(); ++ord) {
+            if (inputs[i]->isLive(ord, version)) live.emplace_back(inputs[i]->docId(ord), i, ord);
+        }
+    }
+    sources.clear();
+    if (live.empty()) return nullptr;
+    std::sort(live.begin(), live.end());
+
+    std::vector<std::vector<uint32_t>> merged_ords(inputs.size());
+    for (uint32_t i = 0; i < inputs.size(); ++i) {
+        merged_ords[i].assign(inputs[i]->docCount(), kNoMoreDocs);
+    }
+    sources.reserve(live.size());
+    for (uint32_t m = 0; m < live.size(); ++m) {
+        auto [id, input, ord] = live[m];
+        merged_ords[input][ord] = m;
+        sources.emplace_back(input, ord);
+    }
+
+    // Each doc comes from one input, whose terms it receives in dictionary
+    // order; its positions follow in the same order
+    struct MergedDoc {
+        SegmentBuilder::TermFreqs term_freqs;
+        std::vector<uint32_t> positions;
+    };
+    std::vector<MergedDoc> docs(live.size());
+    TermInterner terms;
+    size_t pending = 0;
+    for (uint32_t i = 0; i < inputs.size(); ++i) {
+        const Segment& segment = *inputs[i];
+        bool positions = with_positions && segment.hasPositions();
+        for (auto it = segment.dictionary().iterate(0); it.valid(); it.next()) {
+            const TermInfo& info = segment.termInfo(it.ordinal());
+            PostingCursor cursor = segment.cursor(info);
+            PositionReader reader = positions ? segment.positions(info) : PositionReader();
+            uint32_t term = kNoMoreDocs;
+            for (; cursor.doc() != kNoMoreDocs; cursor.next()) {
+                uint32_t m = merged_ords[i][cursor.doc()];
+                if (m == kNoMoreDocs) continue;
+                if (term == kNoMoreDocs) term = terms.intern(it.term());
+                docs[m].term_freqs.emplace_back(term, cursor.freq());
+                if (positions) {
+                    auto doc_positions = reader.positions(cursor);
+                    docs[m].positions.insert(docs[m].positions.end(), doc_positions.begin(), doc_positions.end());
+                }
+                pending += sizeof(uint32_t) * (2 + (positions ? cursor.freq() : 0));
+            }
+            if (pending >= kMergeChargeBytes) {
+                limiter.acquire(pending);
+                pending = 0;
+            }
+        }
+    }
+    limiter.acquire(pending);
+
+    SegmentBuilder builder(with_positions);
+    for (uint32_t m = 0; m < live.size(); ++m) {
+        auto [id, input, ord] = live[m];
+        builder.addDocument(id, docs[m].term_freqs, inputs[input]->docLength(ord), docs[m].positions);
+        docs[m] = MergedDoc();
+    }
+    std::unique_ptr<Segment> merged = builder.build(terms, dictionary_path);
+    limiter.acquire(storedBytes(*merged));
+    return merged;
+}
+
+} // namespace
+
+SearchIndexOptions SearchIndexOptions::fromConfig(const core::Config& config) {
+    SearchIndexOptions options;
+    // Outside these ranges a term can score negative, which breaks the
+    // Block-Max WAND upper bounds
+    options.bm25.k1 = std::max(0.0f, config.get<float>("bm25_k1", options.bm25.k1));
+    options.bm25.b = std::clamp(config.get<float>("bm25_b", options.bm25.b), 0.0f, 1.0f);
+    int buffered = config.get<int>("max_buffered_docs", static_cast<int>(options.max_buffered_docs));
+    options.max_buffered_docs = buffered > 0 ? static_cast<size_t>(buffered) : 1;
+    options.evaluation = stringToQueryEvaluation(
+        config.get<std::string>("query_evaluation", "block_max_wand"));
+    options.tokenizer = TokenizerOptions::fromConfig(config);
+    int expansions = config.get<int>("max_prefix_expansions", static_cast<int>(options.max_prefix_expansions));
+    options.max_prefix_expansions = expansions > 0 ? static_cast<size_t>(expansions) : 1;
+    options.directory = config.get<std::string>("index_dir", "");
+    options.index_positions = config.get<bool>("index_positions", options.index_positions);
+    return options;
+}
+
+InvertedIndex::InvertedIndex(SearchIndexOptions options, std::shared_ptr<const Tokenizer> tokenizer)
+    : options_(std::move(options)),
+      tokenizer_(tokenizer ? std::move(tokenizer) : std::make_shared<StandardTokenizer>(options_.tokenizer)) {
+    if (!options_.directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(options_.directory, ec);
+        if (ec) {
+            throw core::StorageException("Cannot create index directory " + options_.directory + ": " + ec.message());
+        }
+    }
+    snapshot_.store(std::make_shared<const SearchSnapshot>());
+}
+
+void InvertedIndex::Upsert(uint64_t docId, std::string_view text, std::span<const uint32_t> fields) {
+    std::vector<std::pair<uint32_t, uint32_t>> tokens;  // (term ID, position)
+    core::WalEncoder record;
+    if (wal_) record.put<uint64_t>(docId).putString(text).putArray(fields);
+    uint64_t lsn = 0;
+    std::unique_lock lock(mutex_);
+    if (wal_) lsn = wal_->append(core::WalStream::SEARCH, kWalUpsert, record.bytes());
+    tokenizer_->tokenize(text, [&](const Token& token) {
+        tokens.emplace_back(terms_.intern(token.text), token.position);
+    });
+    std::sort(tokens.begin(), tokens.end());
+
+    BufferedDoc doc;
+    doc.length = static_cast<uint32_t>(tokens.size());
+    if (options_.index_positions) {
+        doc.positions.reserve(tokens.size());
+        for (const auto& token : tokens) {
+            doc.positions.push_back(token.second);
+        }
+    }
+    for (size_t i = 0; i < tokens.size();) {
+        size_t j = i;
+        while (j < tokens.size() && tokens[j].first == tokens[i].first) ++j;
+        doc.term_freqs.emplace_back(tokens[i].first, static_cast<uint32_t>(j - i));
+        i = j;
+    }
+
+    // A sealed copy stays searchable until this version replaces it on seal
+    buffer_[docId] = std::move(doc);
+    if (buffer_.size() >= options_.max_buffered_docs && sealBufferLocked()) {
+        publishLocked();
+    }
+    // Commit outside the lock, so concurrent writers share the sync
+    lock.unlock();
+    if (lsn) wal_->commit(lsn);
+}
+
+void InvertedIndex::Remove(uint64_t docId) {
+    uint64_t lsn = 0;
+    {
+        std::unique_lock lock(mutex_);
+        if (wal_) {
+            lsn = wal_->append(core::WalStream::SEARCH, kWalRemove, core::WalEncoder().put<uint64_t>(docId).bytes());
+        }
+        if (removeLocked(docId)) publishLocked();
+    }
+    if (lsn) wal_->commit(lsn);
+}
+
+void InvertedIndex::attachWal(std::shared_ptr<core::WriteAheadLog> wal, uint64_t after_lsn) {
+    // Replays through the public methods while nothing is logged yet
+    wal->replay(core::WalStream::SEARCH, after_lsn, [&](const core::WalRecord& record) {
+        core::WalDecoder decoder(record);
+        uint64_t doc_id = decoder.get<uint64_t>();
+        if (record.op == kWalUpsert) {
+            std::string_view text = decoder.getString();
+            Upsert(doc_id, text, decoder.getArray<uint32_t>());
+        } else if (record.op == kWalRemove) {
+            Remove(doc_id);
+        } else {
+            throw core::StorageException("Unknown search WAL op " + std::to_string(record.op) + " at LSN " +
+                                         std::to_string(record.lsn));
+        }
+    });
+    std::lock_guard lock(mutex_);
+    wal_ = std::move(wal);
+}
+
+void InvertedIndex::attachVersions(std::shared_ptr<core::VersionSet> versions) {
+    std::lock_guard lock(mutex_);
+    versions_ = std::move(versions);
+    versions_->publish(snapshot_.load());
+}
+
+void InvertedIndex::Flush() {
+    std::lock_guard lock(mutex_);
+    if (sealBufferLocked()) publishLocked();
+}
+
+bool InvertedIndex::removeLocked(uint64_t doc_id) {
+    buffer_.erase(doc_id);
+    return unsealLocked(doc_id);
+}
+
+bool InvertedIndex::unsealLocked(uint64_t doc_id) {
+    auto it = locations_.find(doc_id);
+    if (it == locations_.end()) return false;
+    DocLocation loc = it->second;
+    locations_.erase(it);
+    // Gone from the next snapshot on; pinned ones still see it
+    SealedSegment& sealed = segments_[loc.segment];
+    const Segment& segment = *sealed.segment;
+    if (!sealed.segment->markDeleted(loc.ord, version_ + 1)) return false;
+    --sealed.live_count;
+    --live_docs_;
+    live_length_ -= segment.docLength(loc.ord);
+    return true;
+}
+
+void InvertedIndex::publishLocked() {
+    auto next = std::make_shared<SearchSnapshot>();
+    next->version = ++version_;
+    next->segments.reserve(segments_.size());
+    for (const SealedSegment& sealed : segments_) {
+        next->segments.push_back(SearchSnapshot::Part{sealed.segment, sealed.live_count});
+    }
+    next->live_docs = live_docs_;
+    next->live_length = live_length_;
+    snapshot_.store(next);
+    if (versions_) versions_->publish(std::move(next));
+}
+
+bool InvertedIndex::sealBufferLocked() {
+    if (buffer_.empty()) return false;
+
+    std::vector<uint64_t> ids;
+    ids.reserve(buffer_.size());
+    for (const auto& entry : buffer_) {
+        ids.push_back(entry.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    // Replaced docs leave their old segments in the version that adds them
+    for (uint64_t id : ids) {
+        unsealLocked(id);
+    }
+
+    SegmentBuilder builder(options_.index_positions);
+    for (uint64_t id : ids) {
+        const BufferedDoc& doc = buffer_[id];
+        builder.addDocument(id, doc.term_freqs, doc.length, doc.positions);
+        live_length_ += doc.length;
+    }
+    live_docs_ += ids.size();
+    buffer_.clear();
+
+    std::string dictionary_path = nextDictionaryPathLocked();
+    std::shared_ptr<Segment> built = builder.build(terms_, dictionary_path);
+    terms_.clear();
+
+    const Segment& segment = *built;
+    segments_.push_back(SealedSegment{std::move(built), segment.docCount(), std::move(dictionary_path)});
+    auto index = static_cast<uint32_t>(segments_.size() - 1);
+    for (uint32_t ord = 0; ord < segment.docCount(); ++ord) {
+        locations_[segment.docId(ord)] = DocLocation{index, ord};
+    }
+    LOG_DEBUG("Sealed search segment #" + std::to_string(segments_.size()) + " with "
+              + std::to_string(segment.docCount()) + " docs, " + std::to_string(segment.termCount()) + " terms");
+    return true;
+}
+
+std::string InvertedIndex::nextDictionaryPathLocked() {
+    uint64_t number = next_segment_++;
+    if (options_.directory.empty()) return {};
+    return options_.directory + "/segment_" + std::to_string(number) + ".tdic";
+}
+
+double InvertedIndex::fragmentation() const {
+    return fragmentationOf(*snapshot());
+}
+
+bool InvertedIndex::compactionDue(const core::CompactionOptions& options) const {
+    return !compactionPlan(*snapshot(), options).empty();
+}
+
+std::vector<size_t> InvertedIndex::compactionPlan(const SearchSnapshot& snapshot,
+                                                  const core::CompactionOptions& options) {
+    // Segments past the threshold are rewritten first, together
+    std::vector<size_t> plan;
+    for (size_t i = 0; i < snapshot.segments.size(); ++i) {
+        const auto& part = snapshot.segments[i];
+        double dead = static_cast<double>(part.segment->docCount() - part.live_count);
+        if (dead > options.fragmentation_threshold * part.segment->docCount()) plan.push_back(i);
+    }
+    if (!plan.empty()) return plan;
+
+    // Then the oldest merge_factor segments of the smallest full tier
+    size_t factor = std::max<size_t>(options.merge_factor, 2);
+    std::map<uint32_t, std::vector<size_t>> tiers;
+    for (size_t i = 0; i < snapshot.segments.size(); ++i) {
+        uint32_t tier = 0;
+        for (uint64_t docs = snapshot.segments[i].live_count; docs >= factor; docs /= factor) ++tier;
+        tiers[tier].push_back(i);
+    }
+    for (auto& [tier, members] : tiers) {
+        if (members.size() >= factor) {
+            members.resize(factor);
+            return members;
+        }
+    }
+    return plan;
+}
+
+core::CompactionResult InvertedIndex::compact(const core::CompactionOptions& options, core::RateLimiter& limiter) {
+    std::lock_guard compaction_lock(compaction_mutex_);
+    core::CompactionResult result;
+    result.target = compactionName();
+    auto measure = [](const SearchSnapshot& snapshot, uint64_t& bytes, uint64_t& docs) {
+        for (const auto& part : snapshot.segments) {
+            bytes += storedBytes(*part.segment);
+            docs += part.segment->docCount();
+        }
+    };
+
+    // Segments only ever get appended outside compaction, so the plan's
+    // inputs stay in place while the merge runs without the writer lock
+    std::shared_ptr<const SearchSnapshot> base = snapshot();
+    measure(*base, result.bytes_before, result.items_before);
+    result.fragmentation_before = fragmentationOf(*base);
+    std::vector<size_t> plan = compactionPlan(*base, options);
+    if (plan.empty()) {
+        result.bytes_after = result.bytes_before;
+        result.items_after = result.items_before;
+        result.fragmentation_after = result.fragmentation_before;
+        return result;
+    }
+
+    std::vector<const Segment*> inputs;
+    bool with_positions = options_.index_positions;
+    for (size_t i : plan) {
+        inputs.push_back(base->segments[i].segment.get());
+        with_positions &= inputs.back()->hasPositions();
+    }
+    std::string dictionary_path;
+    {
+        std::lock_guard lock(mutex_);
+        dictionary_path = nextDictionaryPathLocked();
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> sources;
+    std::shared_ptr<Segment> merged =
+        mergeSegments(inputs, base->version, with_positions, dictionary_path, limiter, sources);
+
+    std::vector<std::string> obsolete;
+    {
+        std::lock_guard lock(mutex_);
+        // Docs deleted since the base snapshot are deleted from the merged
+        // segment too; it only appears in snapshots after this one
+        uint32_t live_count = 0;
+        for (uint32_t m = 0; m < sources.size(); ++m) {
+            auto [input, ord] = sources[m];
+            if (inputs[input]->isLive(ord, version_)) {
+                ++live_count;
+            } else {
+                merged->markDeleted(m, version_ + 1);
+            }
+        }
+
+        std::vector<SealedSegment> kept;
+        kept.reserve(segments_.size() - inputs.size() + 1);
+        size_t first = segments_.size();
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            SealedSegment& sealed = segments_[i];
+            if (std::find(inputs.begin(), inputs.end(), sealed.segment.get()) == inputs.end()) {
+                kept.push_back(std::move(sealed));
+                continue;
+            }
+            if (first == segments_.size()) {
+                first = kept.size();
+                if (merged) kept.push_back(SealedSegment{merged, live_count, dictionary_path});
+            }
+            if (!sealed.dictionary_path.empty()) obsolete.push_back(sealed.dictionary_path);
+        }
+        segments_ = std::move(kept);
+
+        // Segments from the first input on moved; repoint their live docs
+        for (size_t i = first; i < segments_.size(); ++i) {
+            const Segment& segment = *segments_[i].segment;
+            for (uint32_t ord = 0; ord < segment.docCount(); ++ord) {
+                if (segment.isLive(ord, version_)) {
+                    locations_[segment.docId(ord)] = DocLocation{static_cast<uint32_t>(i), ord};
+                }
+            }
+        }
+        publishLocked();
+    }
+
+    // Pinned snapshots keep their mappings of the removed dictionaries
+    for (const std::string& path : obsolete) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        if (ec) LOG_WARN("Cannot remove merged search segment " + path + ": " + ec.message());
+    }
+
+    std::shared_ptr<const SearchSnapshot> after = snapshot();
+    measure(*after, result.bytes_after, result.items_after);
+    result.fragmentation_after = fragmentationOf(*after);
+    return result;
+}
+
+ParsedQuery InvertedIndex::parse(const SearchSnapshot& snapshot, std::string_view query) const {
+    ParsedQuery parsed = parseQuery(query, *tokenizer_, [&](std::string_view prefix) {
+        return expandPrefix(snapshot, prefix);
+    });
+    if (!parsed.phrases.empty()) {
+        for (const auto& part : snapshot.segments) {
+            if (!part.segment->hasPositions()) {
+                throw core::QueryException("Phrase queries need positional postings (search.index_positions)");
+            }
+        }
+    }
+    return parsed;
+}
+
+bool InvertedIndex::phraseCursors(const Segment& segment, const ParsedQuery& query,
+                                  const std::vector<float>* phrase_idfs, std::vector<PhraseCursor>& phrases) const {
+    phrases.clear();
+    for (size_t p = 0; p < query.phrases.size(); ++p) {
+        const PhraseClause& clause = query.phrases[p];
+        PhraseCursor phrase;
+        phrase.offsets = clause.offsets;
+        phrase.slop = clause.slop;
+        phrase.idf = phrase_idfs ? (*phrase_idfs)[p] : 0.0f;
+        for (const auto& term : clause.terms) {
+            const TermInfo* info = segment.findTerm(term);
+            if (!info) return false;
+            phrase.cursors.push_back(segment.cursor(*info));
+            phrase.positions.push_back(segment.positions(*info));
+        }
+        phrases.push_back(std::move(phrase));
+    }
+    return true;
+}
+
+std::vector<std::string> InvertedIndex::expandPrefix(const SearchSnapshot& snapshot, std::string_view prefix) const {
+    std::unordered_map<std::string, uint64_t> doc_freqs;
+    for (const auto& part : snapshot.segments) {
+        const TermDictionary& dictionary = part.segment->dictionary();
+        auto [first, last] = dictionary.prefixRange(prefix);
+        for (auto it = dictionary.iterate(first, last); it.valid(); it.next()) {
+            doc_freqs[std::string(it.term())] += part.segment->termInfo(it.ordinal()).doc_freq;
+        }
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> ranked(doc_freqs.begin(), doc_freqs.end());
+    size_t keep = std::min(ranked.size(), options_.max_prefix_expansions);
+    std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    std::vector<std::string> terms;
+    terms.reserve(keep);
+    for (size_t i = 0; i < keep; ++i) {
+        terms.push_back(std::move(ranked[i].first));
+    }
+    return terms;
+}
+
+std::vector<core::ScoredId> InvertedIndex::Search(std::string_view query, size_t topk) const {
+    return Search(query, topk, options_.evaluation);
+}
+
+std::vector<core::ScoredId> InvertedIndex::Search(std::string_view query, size_t topk,
+                                                  QueryEvaluation evaluation) const {
+    return Search(*snapshot(), query, topk, evaluation);
+}
+
+std::vector<core::ScoredId> InvertedIndex::Search(const SearchSnapshot& snapshot, std::string_view query,
+                                                  size_t topk) const {
+    return Search(snapshot, query, topk, options_.evaluation);
+}
+
+std::vector<core::ScoredId> InvertedIndex::Search(const SearchSnapshot& snapshot, std::string_view query,
+                                                  size_t topk, QueryEvaluation evaluation) const {
+    core::TopKCollector collector(topk);
+    if (snapshot.live_docs == 0 || topk == 0) {
+        return collector.take();
+    }
+
+    ParsedQuery parsed = parse(snapshot, query);
+
+    // Prefix clauses contribute each expanded term as a scored term of its own
+    std::vector<std::string> terms;
+    for (auto& clause : parsed.terms) {
+        for (auto& term : clause.terms) {
+            terms.push_back(std::move(term));
+        }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (terms.empty() && parsed.phrases.empty()) {
+        return collector.take();
+    }
+
+    // Collection-wide statistics shared by all segments. doc_freq still counts
+    // deleted and superseded postings, so N is the stored doc count to match
+    uint64_t stored_docs = 0;
+    for (const auto& part : snapshot.segments) {
+        stored_docs += part.segment->docCount();
+    }
+    auto idf_of = [&](const std::string& term) {
+        uint64_t df = 0;
+        for (const auto& part : snapshot.segments) {
+            if (const TermInfo* info = part.segment->findTerm(term)) {
+                df += info->doc_freq;
+            }
+        }
+        return Bm25Scorer::idf(stored_docs, df);
+    };
+    std::vector<float> idfs(terms.size());
+    for (size_t t = 0; t < terms.size(); ++t) {
+        idfs[t] = idf_of(terms[t]);
+    }
+    std::vector<float> phrase_idfs(parsed.phrases.size(), 0.0f);
+    for (size_t p = 0; p < parsed.phrases.size(); ++p) {
+        for (const auto& term : parsed.phrases[p].terms) {
+            phrase_idfs[p] += idf_of(term);
+        }
+    }
+    Bm25Scorer scorer(options_.bm25,
+                      static_cast<double>(snapshot.live_length) / static_cast<double>(snapshot.live_docs));
+
+    std::vector<TermCursor> cursors;
+    cursors.reserve(terms.size());
+    std::vector<PhraseCursor> phrases;
+
+    for (const auto& part : snapshot.segments) {
+        if (part.live_count == 0) continue;
+        const Segment* segment = part.segment.get();
+        cursors.clear();
+        for (size_t t = 0; t < terms.size(); ++t) {
+            if (const TermInfo* info = segment->findTerm(terms[t])) {
+                cursors.push_back(makeTermCursor(segment->cursor(*info), idfs[t], t, scorer));
+            }
+        }
+
+        if (!parsed.phrases.empty()) {
+            if (phraseCursors(*segment, parsed, &phrase_idfs, phrases)) {
+                evaluatePhrases(*segment, snapshot.version, phrases, cursors, scorer, collector);
+            }
+        } else if (cursors.empty()) {
+            continue;
+        } else if (evaluation == QueryEvaluation::EXHAUSTIVE) {
+            evaluateExhaustive(*segment, snapshot.version, cursors, scorer, collector);
+        } else {
+            evaluateBlockMaxWand(*segment, snapshot.version, cursors, scorer, collector);
+        }
+    }
+    return collector.take();
+}
+
+std::vector<uint64_t> InvertedIndex::MatchAll(std::string_view query) const {
+    return matchBoolean(*snapshot(), query, true);
+}
+
+std::vector<uint64_t> InvertedIndex::MatchAny(std::string_view query) const {
+    return matchBoolean(*snapshot(), query, false);
+}
+
+std::vector<uint64_t> InvertedIndex::MatchAll(const SearchSnapshot& snapshot, std::string_view query) const {
+    return matchBoolean(snapshot, query, true);
+}
+
+std::vector<uint64_t> InvertedIndex::MatchAny(const SearchSnapshot& snapshot, std::string_view query) const {
+    return matchBoolean(snapshot, query, false);
+}
+
+std::vector<uint64_t> InvertedIndex::matchBoolean(const SearchSnapshot& snapshot, std::string_view query,
+                                                  bool conjunctive) const {
+    ParsedQuery parsed = parse(snapshot, query);
+
+    std::vector<uint64_t> ids;
+    if (parsed.empty()) return ids;
+
+    std::vector<std::vector<uint32_t>> lists;
+    std::vector<uint32_t> list;
+    std::vector<PhraseCursor> phrases;
+    for (const auto& part : snapshot.segments) {
+        if (part.live_count == 0) continue;
+        const Segment* segment = part.segment.get();
+
+        // One sorted ordinal list per clause; prefix clauses union their terms
+        lists.clear();
+        bool missing = false;
+        for (const auto& clause : parsed.terms) {
+            std::vector<uint32_t> docs;
+            for (const auto& term : clause.terms) {
+                const TermInfo* info = segment->findTerm(term);
+                if (!info) continue;
+                list.clear();
+                segment->cursor(*info).decodeAll(list);
+                docs = docs.empty() ? list : unionSorted(docs, list);
+            }
+            if (docs.empty()) {
+                missing = true;
+                if (conjunctive) break;
+                continue;
+            }
+            lists.push_back(std::move(docs));
+        }
+        if (conjunctive && missing) continue;
+
+        std::vector<uint32_t> result;
+        if (!lists.empty()) {
+            // Shortest lists first keeps intersections small
+            std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) {
+                return a.size() < b.size();
+            });
+            result = std::move(lists[0]);
+            for (size_t i = 1; i < lists.size() && !(conjunctive && result.empty()); ++i) {
+                result = conjunctive ? intersectSorted(result, lists[i]) : unionSorted(result, lists[i]);
+            }
+        }
+
+        // Phrases are required either way; optional terms add nothing to a filter
+        if (!parsed.phrases.empty()) {
+            if (!phraseCursors(*segment, parsed, nullptr, phrases)) continue;
+            std::vector<uint32_t> phrase_docs = matchPhrases(phrases);
+            result = conjunctive && !parsed.terms.empty() ? intersectSorted(result, phrase_docs)
+                                                          : std::move(phrase_docs);
+        }
+        for (uint32_t ord : result) {
+            if (segment->isLive(ord, snapshot.version)) ids.push_back(segment->docId(ord));
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+size_t InvertedIndex::segmentCount() const {
+    return snapshot()->segments.size();
+}
+
+size_t InvertedIndex::docCount() const {
+    return snapshot()->live_docs;
+}
+
+size_t InvertedIndex::bufferedCount() const {
+    std::lock_guard lock(mutex_);
+    return buffer_.size();
+}
+
+size_t InvertedIndex::memoryBytes() const {
+    std::lock_guard lock(mutex_);
+    size_t bytes = terms_.memoryBytes();
+    for (const SealedSegment& sealed : segments_) {
+        bytes += sealed.segment->memoryBytes();
+    }
+    return bytes;
+}
+
+} // namespace memory::search
@@ -0,0 +1,306 @@
+#include "memory/search/postings.h"
+#include "memory/search/simd_kernels.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace memory::search {
+
+uint32_t requiredBits(const uint32_t* values, size_t count) {
+    uint32_t acc = 0;
+    for (size_t i = 0; i < count; ++i) {
+        acc |= values[i];
+    }
+    return static_cast<uint32_t>(std::bit_width(acc));
+}
+
+void packBlock(const uint32_t* values, uint32_t bits, uint8_t* out) {
+    if (bits == 0) return;
+    uint32_t words[kPostingBlockSize] = {};
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+        for (uint32_t row = 0; row < kPostingBlockSize / 4; ++row) {
+            uint32_t value = values[row * 4 + lane];
+            uint32_t bit_pos = row * bits;
+            uint32_t word = bit_pos >> 5;
+            uint32_t shift = bit_pos & 31;
+            words[word * 4 + lane] |= value << shift;
+            if (shift + bits > 32) {
+                words[(word + 1) * 4 + lane] |= value >> (32 - shift);
+            }
+        }
+    }
+    std::memcpy(out, words, packedBlockBytes(bits));
+}
+
+void unpackBlock(const uint8_t* in, uint32_t bits, uint32_t* out) {
+    postingKernels().unpack(in, bits, out);
+}
+
+void prefixSumBlock(uint32_t* values, uint32_t base) {
+    postingKernels().prefix_sum(values, base);
+}
+
+void encodeVarint(uint32_t value, std::vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+const uint8_t* decodeVarint(const uint8_t* in, uint32_t& value) {
+    uint32_t result = 0;
+    uint32_t shift = 0;
+    while (*in & 0x80) {
+        result |= static_cast<uint32_t>(*in++ & 0x7F) << shift;
+        shift += 7;
+    }
+    result |= static_cast<uint32_t>(*in++) << shift;
+    value = result;
+    return in;
+}
+
+// === PostingsWriter ===
+
+PostingsWriter::PostingsWriter(std::vector<uint8_t>& bytes, std::vector<SkipEntry>& skips)
+    : bytes_(bytes), skips_(skips), term_start_(bytes.size()) {}
+
+void PostingsWriter::add(uint32_t doc, uint32_t freq, uint32_t doc_length) {
+    if (buffered_ == 0) {
+        max_freq_ = freq;
+        min_length_ = doc_length;
+    } else {
+        max_freq_ = std::max(max_freq_, freq);
+        min_length_ = std::min(min_length_, doc_length);
+    }
+    docs_[buffered_] = doc;
+    freqs_[buffered_] = freq;
+    ++buffered_;
+    ++count_;
+    if (buffered_ == kPostingBlockSize) {
+        writeBlock(true);
+    }
+}
+
+uint32_t PostingsWriter::finish() {
+    if (buffered_ > 0) {
+        writeBlock(false);
+    }
+    return count_;
+}
+
+void PostingsWriter::writeBlock(bool full) {
+    SkipEntry skip;
+    skip.last_doc = docs_[buffered_ - 1];
+    skip.offset = static_cast<uint32_t>(bytes_.size() - term_start_);
+    skip.max_freq = max_freq_;
+    skip.min_length = min_length_;
+
+    uint32_t deltas[kPostingBlockSize];
+    uint32_t prev = last_doc_;
+    for (uint32_t i = 0; i < buffered_; ++i) {
+        deltas[i] = docs_[i] - prev;
+        prev = docs_[i];
+        freqs_[i] -= 1;  // freq >= 1, store freq-1
+    }
+
+    if (full) {
+        uint32_t doc_bits = requiredBits(deltas, kPostingBlockSize);
+        uint32_t freq_bits = requiredBits(freqs_, kPostingBlockSize);
+        size_t pos = bytes_.size();
+        bytes_.resize(pos + 2 + packedBlockBytes(doc_bits) + packedBlockBytes(freq_bits));
+        bytes_[pos] = static_cast<uint8_t>(doc_bits);
+        bytes_[pos + 1] = static_cast<uint8_t>(freq_bits);
+        packBlock(deltas, doc_bits, bytes_.data() + pos + 2);
+        packBlock(freqs_, freq_bits, bytes_.data() + pos + 2 + packedBlockBytes(doc_bits));
+    } else {
+        for (uint32_t i = 0; i < buffered_; ++i) encodeVarint(deltas[i], bytes_);
+        for (uint32_t i = 0; i < buffered_; ++i) encodeVarint(freqs_[i], bytes_);
+    }
+
+    skips_.push_back(skip);
+    last_doc_ = skip.last_doc;
+    buffered_ = 0;
+}
+
+// === PostingCursor ===
+
+PostingCursor::PostingCursor(const uint8_t* data, const SkipEntry* skips, uint32_t doc_freq)
+    : data_(data),
+      skips_(skips),
+      doc_freq_(doc_freq),
+      block_count_((doc_freq + kPostingBlockSize - 1) / kPostingBlockSize) {
+    if (block_count_ > 0) {
+        loadBlock(0);
+    }
+}
+
+void PostingCursor::loadBlock(uint32_t block) {
+    block_ = block;
+    pos_ = 0;
+    const uint8_t* in = data_ + skips_[block].offset;
+    uint32_t base = block == 0 ? 0 : skips_[block - 1].last_doc;
+    bool full = block + 1 < block_count_ || doc_freq_ % kPostingBlockSize == 0;
+
+    if (full) {
+        block_len_ = kPostingBlockSize;
+        uint32_t doc_bits = in[0];
+        uint32_t freq_bits = in[1];
+        unpackBlock(in + 2, doc_bits, docs_);
+        prefixSumBlock(docs_, base);
+        unpackBlock(in + 2 + packedBlockBytes(doc_bits), freq_bits, freqs_);
+    } else {
+        block_len_ = doc_freq_ % kPostingBlockSize;
+        for (uint32_t i = 0; i < block_len_; ++i) {
+            uint32_t delta;
+            in = decodeVarint(in, delta);
+            base += delta;
+            docs_[i] = base;
+        }
+        for (uint32_t i = 0; i < block_len_; ++i) {
+            in = decodeVarint(in, freqs_[i]);
+        }
+    }
+    for (uint32_t i = 0; i < block_len_; ++i) {
+        freqs_[i] += 1;
+    }
+    doc_ = docs_[0];
+}
+
+void PostingCursor::next() {
+    if (doc_ == kNoMoreDocs) return;
+    if (++pos_ < block_len_) {
+        doc_ = docs_[pos_];
+    } else if (block_ + 1 < block_count_) {
+        loadBlock(block_ + 1);
+    } else {
+        doc_ = kNoMoreDocs;
+    }
+}
+
+void PostingCursor::advance(uint32_t target) {
+    if (doc_ >= target) return;
+    if (skips_[block_].last_doc < target) {
+        uint32_t block = block_ + 1;
+        while (block < block_count_ && skips_[block].last_doc < target) {
+            ++block;
+        }
+        if (block == block_count_) {
+            doc_ = kNoMoreDocs;
+            return;
+        }
+        loadBlock(block);
+    }
+    while (docs_[pos_] < target) {
+        ++pos_;
+    }
+    doc_ = docs_[pos_];
+}
+
+void PostingCursor::decodeAll(std::vector<uint32_t>& out) {
+    out.reserve(out.size() + doc_freq_);
+    for (uint32_t block = block_; block < block_count_; ++block) {
+        if (block != block_) {
+            loadBlock(block);
+        }
+        out.insert(out.end(), docs_ + pos_, docs_ + block_len_);
+    }
+    doc_ = kNoMoreDocs;
+}
+
+const SkipEntry* PostingCursor::shallowAdvance(uint32_t target) {
+    if (shallow_block_ < block_) {
+        shallow_block_ = block_;
+    }
+    while (shallow_block_ < block_count_ && skips_[shallow_block_].last_doc < target) {
+        ++shallow_block_;
+    }
+    return shallow_block_ < block_count_ ? &skips_[shallow_block_] : nullptr;
+}
+
+// === PositionsWriter ===
+
+PositionsWriter::PositionsWriter(std::vector<uint8_t>& bytes, std::vector<uint32_t>& block_offsets)
+    : bytes_(bytes), block_offsets_(block_offsets), term_start_(bytes.size()) {}
+
+void PositionsWriter::add(const uint32_t* positions, uint32_t count) {
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        gaps_.push_back(positions[i] - prev);
+        prev = positions[i];
+    }
+    if (++docs_ == kPostingBlockSize) {
+        writeBlock();
+    }
+}
+
+void PositionsWriter::finish() {
+    if (docs_ > 0) {
+        writeBlock();
+    }
+}
+
+void PositionsWriter::writeBlock() {
+    block_offsets_.push_back(static_cast<uint32_t>(bytes_.size() - term_start_));
+    size_t full = gaps_.size() / kPostingBlockSize * kPostingBlockSize;
+    for (size_t i = 0; i < full; i += kPostingBlockSize) {
+        uint32_t bits = requiredBits(gaps_.data() + i, kPostingBlockSize);
+        size_t pos = bytes_.size();
+        bytes_.resize(pos + 1 + packedBlockBytes(bits));
+        bytes_[pos] = static_cast<uint8_t>(bits);
+        packBlock(gaps_.data() + i, bits, bytes_.data() + pos + 1);
+    }
+    for (size_t i = full; i < gaps_.size(); ++i) {
+        encodeVarint(gaps_[i], bytes_);
+    }
+    gaps_.clear();
+    docs_ = 0;
+}
+
+// === PositionReader ===
+
+PositionReader::PositionReader(const uint8_t* data, const uint32_t* block_offsets)
+    : data_(data), block_offsets_(block_offsets) {}
+
+std::span<const uint32_t> PositionReader::positions(const PostingCursor& cursor) {
+    if (cursor.block() != block_) {
+        decodeBlock(cursor);
+    }
+    uint32_t pos = cursor.blockPosition();
+    return {values_.data() + starts_[pos], starts_[pos + 1] - starts_[pos]};
+}
+
+void PositionReader::decodeBlock(const PostingCursor& cursor) {
+    block_ = cursor.block();
+    const uint32_t* freqs = cursor.blockFreqs();
+    uint32_t docs = cursor.blockLength();
+    starts_[0] = 0;
+    for (uint32_t i = 0; i < docs; ++i) {
+        starts_[i + 1] = starts_[i] + freqs[i];
+    }
+    uint32_t total = starts_[docs];
+
+    // Full chunks unpack 128 values at a time
+    values_.resize((total + kPostingBlockSize - 1) / kPostingBlockSize * kPostingBlockSize);
+    const uint8_t* in = data_ + block_offsets_[block_];
+    uint32_t full = total / kPostingBlockSize * kPostingBlockSize;
+    for (uint32_t i = 0; i < full; i += kPostingBlockSize) {
+        uint32_t bits = *in++;
+        unpackBlock(in, bits, values_.data() + i);
+        in += packedBlockBytes(bits);
+    }
+    for (uint32_t i = full; i < total; ++i) {
+        in = decodeVarint(in, values_[i]);
+    }
+
+    // Gaps restart at every doc
+    for (uint32_t d = 0; d < docs; ++d) {
+        uint32_t acc = 0;
+        for (uint32_t i = starts_[d]; i < starts_[d + 1]; ++i) {
+            acc += values_[i];
+            values_[i] = acc;
+        }
+    }
+}
+
+} // namespace memory::search
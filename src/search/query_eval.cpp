@@ -0,0 +1,306 @@
+#include "memory/search/query_eval.h"
+#include "memory/search/segment.h"
+#include "memory/core/errors.h"
+#include "memory/core/top_k.h"
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <string>
+
+namespace memory::search {
+
+namespace {
+
+// Float bounds are computed with a different summation order than exact
+// scores; inflate them slightly so rounding can never prune a true hit.
+constexpr float kBoundSlack = 1.0001f;
+
+inline bool canEnter(float upper_bound, float threshold) {
+    return upper_bound * kBoundSlack >= threshold;
+}
+
+// Sums per-term contributions of the current doc in query-term order
+float scoreDoc(const Segment& segment, uint32_t doc, TermCursor* const* cursors, size_t count,
+               const Bm25Scorer& scorer, std::vector<float>& contrib) {
+    std::fill(contrib.begin(), contrib.end(), 0.0f);
+    uint32_t length = segment.docLength(doc);
+    for (size_t i = 0; i < count; ++i) {
+        TermCursor* tc = cursors[i];
+        contrib[tc->term] = scorer.score(tc->idf, tc->cursor.freq(), length);
+    }
+    float score = 0.0f;
+    for (float c : contrib) {
+        score += c;
+    }
+    return score;
+}
+
+// Leapfrogs the cursors of all phrases to docs containing every phrase term
+// and reports the docs where every phrase also matches positionally
+class PhraseConjunction {
+public:
+    explicit PhraseConjunction(std::vector<PhraseCursor>& phrases) : phrases_(phrases) {
+        for (auto& phrase : phrases_) {
+            for (auto& cursor : phrase.cursors) {
+                all_.push_back(&cursor);
+            }
+        }
+        // Rarest term leads
+        std::sort(all_.begin(), all_.end(), [](const PostingCursor* a, const PostingCursor* b) {
+            return a->docFreq() < b->docFreq();
+        });
+        tfs_.resize(phrases_.size());
+    }
+
+    // Next matching doc, kNoMoreDocs when exhausted; tf(i) then holds the
+    // occurrences of phrase i
+    uint32_t next() {
+        if (all_.empty()) return kNoMoreDocs;
+        uint32_t doc = started_ ? advanceLead() : all_[0]->doc();
+        started_ = true;
+        while (doc != kNoMoreDocs) {
+            bool aligned = true;
+            for (PostingCursor* cursor : all_) {
+                cursor->advance(doc);
+                if (cursor->doc() != doc) {
+                    doc = cursor->doc();
+                    aligned = false;
+                    break;
+                }
+            }
+            if (!aligned) continue;
+            bool matched = true;
+            for (size_t i = 0; i < phrases_.size() && matched; ++i) {
+                tfs_[i] = phrases_[i].matchCount();
+                matched = tfs_[i] > 0;
+            }
+            if (matched) return doc;
+            doc = advanceLead();
+        }
+        return kNoMoreDocs;
+    }
+
+    uint32_t tf(size_t phrase) const { return tfs_[phrase]; }
+
+private:
+    uint32_t advanceLead() {
+        all_[0]->next();
+        return all_[0]->doc();
+    }
+
+    std::vector<PhraseCursor>& phrases_;
+    std::vector<PostingCursor*> all_;
+    std::vector<uint32_t> tfs_;
+    bool started_ = false;
+};
+
+size_t termSlots(const std::vector<TermCursor>& cursors) {
+    size_t slots = 0;
+    for (const auto& tc : cursors) {
+        slots = std::max(slots, tc.term + 1);
+    }
+    return slots;
+}
+
+} // namespace
+
+QueryEvaluation stringToQueryEvaluation(std::string_view str) {
+    if (str == "block_max_wand" || str == "bmw") return QueryEvaluation::BLOCK_MAX_WAND;
+    if (str == "exhaustive") return QueryEvaluation::EXHAUSTIVE;
+    throw core::QueryException("Unknown query evaluation: " + std::string(str));
+}
+
+uint32_t PhraseCursor::matchCount() {
+    const size_t count = cursors.size();
+    const uint32_t max_offset = *std::max_element(offsets.begin(), offsets.end());
+    lists_.resize(count);
+    index_.assign(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        lists_[i] = positions[i].positions(cursors[i]);
+    }
+    // Shifted so that an exact phrase lines up on one value
+    auto adjusted = [&](size_t i) { return lists_[i][index_[i]] + (max_offset - offsets[i]); };
+
+    uint32_t matches = 0;
+    if (slop == 0) {
+        for (; index_[0] < lists_[0].size(); ++index_[0]) {
+            uint32_t target = adjusted(0);
+            bool all = true;
+            for (size_t i = 1; i < count && all; ++i) {
+                while (index_[i] < lists_[i].size() && adjusted(i) < target) ++index_[i];
+                if (index_[i] == lists_[i].size()) return matches;
+                all = adjusted(i) == target;
+            }
+            matches += all ? 1 : 0;
+        }
+        return matches;
+    }
+
+    // Sliding window: repeatedly advance the list holding the smallest value
+    for (;;) {
+        uint32_t lo = std::numeric_limits<uint32_t>::max();
+        uint32_t hi = 0;
+        size_t lowest = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t value = adjusted(i);
+            if (value < lo) {
+                lo = value;
+                lowest = i;
+            }
+            hi = std::max(hi, value);
+        }
+        if (hi - lo <= slop) ++matches;
+        if (++index_[lowest] == lists_[lowest].size()) return matches;
+    }
+}
+
+TermCursor makeTermCursor(PostingCursor cursor, float idf, size_t term, const Bm25Scorer& scorer) {
+    TermCursor tc;
+    tc.idf = std::max(idf, 0.0f);
+    tc.term = term;
+    for (uint32_t block = 0; block < cursor.blockCount(); ++block) {
+        const SkipEntry& entry = cursor.skipEntry(block);
+        tc.max_score = std::max(tc.max_score, scorer.score(tc.idf, entry.max_freq, entry.min_length));
+    }
+    tc.cursor = cursor;
+    return tc;
+}
+
+void evaluateExhaustive(const Segment& segment, uint64_t version, std::vector<TermCursor>& cursors,
+                        const Bm25Scorer& scorer, core::TopKCollector& collector) {
+    std::vector<float> contrib(termSlots(cursors));
+    std::vector<TermCursor*> matched;
+    matched.reserve(cursors.size());
+
+    for (;;) {
+        uint32_t doc = kNoMoreDocs;
+        for (const auto& tc : cursors) {
+            doc = std::min(doc, tc.cursor.doc());
+        }
+        if (doc == kNoMoreDocs) break;
+
+        matched.clear();
+        for (auto& tc : cursors) {
+            if (tc.cursor.doc() == doc) matched.push_back(&tc);
+        }
+        if (segment.isLive(doc, version)) {
+            float score = scoreDoc(segment, doc, matched.data(), matched.size(), scorer, contrib);
+            collector.push(segment.docId(doc), score);
+        }
+        for (TermCursor* tc : matched) {
+            tc->cursor.next();
+        }
+    }
+}
+
+void evaluateBlockMaxWand(const Segment& segment, uint64_t version, std::vector<TermCursor>& cursors,
+                          const Bm25Scorer& scorer, core::TopKCollector& collector) {
+    std::vector<float> contrib(termSlots(cursors));
+
+    std::vector<TermCursor*> order;
+    order.reserve(cursors.size());
+    for (auto& tc : cursors) {
+        order.push_back(&tc);
+    }
+    auto by_doc = [](const TermCursor* a, const TermCursor* b) {
+        return a->cursor.doc() < b->cursor.doc();
+    };
+    // Among order[0..last], the cursor with the largest bound behind `limit`
+    auto pick_lagging = [&](size_t last, uint32_t limit) {
+        TermCursor* best = nullptr;
+        for (size_t i = 0; i <= last; ++i) {
+            if (order[i]->cursor.doc() < limit && (!best || order[i]->max_score > best->max_score)) {
+                best = order[i];
+            }
+        }
+        return best;
+    };
+
+    for (;;) {
+        std::sort(order.begin(), order.end(), by_doc);
+        const float threshold = collector.threshold();
+
+        // 1. Pivot: first prefix of cursors whose summed bounds may beat the heap
+        float upper_bound = 0.0f;
+        size_t pivot = order.size();
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (order[i]->cursor.doc() == kNoMoreDocs) break;
+            upper_bound += order[i]->max_score;
+            if (canEnter(upper_bound, threshold)) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot == order.size()) return;
+
+        const uint32_t pivot_doc = order[pivot]->cursor.doc();
+        while (pivot + 1 < order.size() && order[pivot + 1]->cursor.doc() == pivot_doc) {
+            ++pivot;
+        }
+
+        // 2. Refine with the block-max bounds of the blocks holding pivot_doc
+        float block_bound = 0.0f;
+        uint32_t block_end = kNoMoreDocs;
+        for (size_t i = 0; i <= pivot; ++i) {
+            const SkipEntry* entry = order[i]->cursor.shallowAdvance(pivot_doc);
+            if (!entry) continue;  // List ends before pivot_doc
+            block_bound += scorer.score(order[i]->idf, entry->max_freq, entry->min_length);
+            block_end = std::min(block_end, entry->last_doc);
+        }
+
+        if (!canEnter(block_bound, threshold)) {
+            // No doc before the end of the current blocks can qualify
+            uint32_t target = block_end + 1;
+            if (pivot + 1 < order.size()) {
+                target = std::min(target, order[pivot + 1]->cursor.doc());
+            }
+            pick_lagging(pivot, target)->cursor.advance(target);
+            continue;
+        }
+
+        if (order[0]->cursor.doc() == pivot_doc) {
+            // 3. All pivot-prefix cursors sit on pivot_doc: score it exactly
+            if (segment.isLive(pivot_doc, version)) {
+                float score = scoreDoc(segment, pivot_doc, order.data(), pivot + 1, scorer, contrib);
+                collector.push(segment.docId(pivot_doc), score);
+            }
+            for (size_t i = 0; i <= pivot; ++i) {
+                order[i]->cursor.next();
+            }
+        } else {
+            pick_lagging(pivot, pivot_doc)->cursor.advance(pivot_doc);
+        }
+    }
+}
+
+void evaluatePhrases(const Segment& segment, uint64_t version, std::vector<PhraseCursor>& phrases,
+                     std::vector<TermCursor>& cursors, const Bm25Scorer& scorer,
+                     core::TopKCollector& collector) {
+    PhraseConjunction conjunction(phrases);
+    for (uint32_t doc = conjunction.next(); doc != kNoMoreDocs; doc = conjunction.next()) {
+        if (!segment.isLive(doc, version)) continue;
+        uint32_t length = segment.docLength(doc);
+        float score = 0.0f;
+        for (size_t i = 0; i < phrases.size(); ++i) {
+            score += scorer.score(phrases[i].idf, conjunction.tf(i), length);
+        }
+        for (auto& tc : cursors) {
+            tc.cursor.advance(doc);
+            if (tc.cursor.doc() == doc) {
+                score += scorer.score(tc.idf, tc.cursor.freq(), length);
+            }
+        }
+        collector.push(segment.docId(doc), score);
+    }
+}
+
+std::vector<uint32_t> matchPhrases(std::vector<PhraseCursor>& phrases) {
+    std::vector<uint32_t> docs;
+    PhraseConjunction conjunction(phrases);
+    for (uint32_t doc = conjunction.next(); doc != kNoMoreDocs; doc = conjunction.next()) {
+        docs.push_back(doc);
+    }
+    return docs;
+}
+
+} // namespace memory::search
@@ -0,0 +1,104 @@
+#include "memory/search/query_parser.h"
+#include <algorithm>
+
+namespace memory::search {
+
+namespace {
+
+class QueryParser {
+public:
+    QueryParser(const Tokenizer& tokenizer, const PrefixExpander& expand, ParsedQuery& out)
+        : tokenizer_(tokenizer), expand_(expand), out_(out) {}
+
+    void parse(std::string_view query) {
+        size_t plain_start = 0;
+        size_t i = 0;
+        while (i < query.size()) {
+            if (query[i] != '"') {
+                ++i;
+                continue;
+            }
+            addPlain(query.substr(plain_start, i - plain_start));
+            size_t close = std::min(query.find('"', i + 1), query.size());
+            std::string_view phrase = query.substr(i + 1, close - i - 1);
+            i = std::min(close + 1, query.size());
+
+            uint32_t slop = 0;
+            if (i < query.size() && query[i] == '~') {
+                ++i;
+                while (i < query.size() && query[i] >= '0' && query[i] <= '9') {
+                    slop = std::min<uint32_t>(slop * 10 + static_cast<uint32_t>(query[i] - '0'), 1u << 20);
+                    ++i;
+                }
+            }
+            addPhrase(phrase, slop);
+            plain_start = i;
+        }
+        addPlain(query.substr(plain_start));
+    }
+
+private:
+    void addTerm(std::string_view term) {
+        out_.terms.push_back(TermClause{{std::string(term)}});
+    }
+
+    void addText(std::string_view text) {
+        tokenizer_.tokenize(text, [&](const Token& token) { addTerm(token.text); });
+    }
+
+    // Plain text with optional `word*` prefix terms
+    void addPlain(std::string_view text) {
+        size_t plain_start = 0;
+        for (size_t star = text.find('*'); star != std::string_view::npos; star = text.find('*', star + 1)) {
+            size_t space = text.find_last_of(" \t\r\n", star);
+            size_t word_start = space == std::string_view::npos ? 0 : space + 1;
+            word_start = std::max(word_start, plain_start);
+            addText(text.substr(plain_start, word_start - plain_start));
+            plain_start = star + 1;
+
+            // Only the last token of the word is a prefix: "win1*" -> win1*,
+            // "蓝牙耳*" -> 蓝牙 牙耳 耳*
+            std::string last;
+            bool has_last = false;
+            tokenizer_.tokenize(text.substr(word_start, star - word_start), [&](const Token& token) {
+                if (has_last) addTerm(last);
+                last.assign(token.text);
+                has_last = true;
+            });
+            if (has_last) {
+                out_.terms.push_back(TermClause{expand_(last)});
+            }
+        }
+        addText(text.substr(plain_start));
+    }
+
+    void addPhrase(std::string_view text, uint32_t slop) {
+        PhraseClause phrase;
+        phrase.slop = slop;
+        uint32_t first = 0;
+        tokenizer_.tokenize(text, [&](const Token& token) {
+            if (phrase.terms.empty()) first = token.position;
+            phrase.terms.emplace_back(token.text);
+            phrase.offsets.push_back(token.position - first);
+        });
+        if (phrase.terms.size() == 1) {
+            addTerm(phrase.terms[0]);
+        } else if (!phrase.terms.empty()) {
+            out_.phrases.push_back(std::move(phrase));
+        }
+    }
+
+    const Tokenizer& tokenizer_;
+    const PrefixExpander& expand_;
+    ParsedQuery& out_;
+};
+
+} // namespace
+
+ParsedQuery parseQuery(std::string_view query, const Tokenizer& tokenizer, const PrefixExpander& expand) {
+    ParsedQuery parsed;
+    QueryParser(tokenizer, expand, parsed).parse(query);
+    return parsed;
+}
+
+} // namespace memory::search
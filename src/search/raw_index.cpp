@@ -0,0 +1,472 @@
+#include "memory/search/raw_index.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace memory::search {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct DigestHash {
+    size_t operator()(const core::Sha256Digest& digest) const {
+        size_t hash;
+        std::memcpy(&hash, digest.data(), sizeof(hash));
+        return hash;
+    }
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+bool isAsciiAlnum(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isHexDigit(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool isUtf8Continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// [begin, end) of text without the whitespace around it
+std::pair<size_t, size_t> trimmed(std::string_view text, size_t begin, size_t end) {
+    while (begin < end && isSpace(text[begin])) ++begin;
+    while (end > begin && isSpace(text[end - 1])) --end;
+    return {begin, end};
+}
+
+// Paragraphs of text: runs of lines between blank lines, trimmed
+std::vector<std::pair<size_t, size_t>> paragraphs(std::string_view text) {
+    std::vector<std::pair<size_t, size_t>> result;
+    size_t start = 0;
+    size_t line = 0;
+    while (line < text.size()) {
+        size_t next = text.find('\n', line);
+        next = next == std::string_view::npos ? text.size() : next + 1;
+        auto [b, e] = trimmed(text, line, next);
+        if (b == e) {
+            auto paragraph = trimmed(text, start, line);
+            if (paragraph.first < paragraph.second) result.push_back(paragraph);
+            start = next;
+        }
+        line = next;
+    }
+    auto paragraph = trimmed(text, start, text.size());
+    if (paragraph.first < paragraph.second) result.push_back(paragraph);
+    return result;
+}
+
+// Where to end a piece of text[begin, ...) that may not pass limit:
+// preferably after a line break, then after a sentence end, then after a
+// space, in the second half of the piece; else at the last UTF-8 boundary
+size_t cutPoint(std::string_view text, size_t begin, size_t limit) {
+    size_t half = begin + (limit - begin) / 2;
+    for (size_t i = limit; i > half; --i) {
+        if (text[i - 1] == '\n') return i;
+    }
+    static constexpr std::string_view kSentenceEnds[] = {"。", "！", "？", "；", ". ", "! ", "? ", "; "};
+    for (size_t i = limit; i > half; --i) {
+        for (std::string_view end : kSentenceEnds) {
+            if (i - begin >= end.size() && text.substr(i - end.size(), end.size()) == end) return i;
+        }
+    }
+    for (size_t i = limit; i > half; --i) {
+        if (isSpace(text[i - 1])) return i;
+    }
+    size_t cut = limit;
+    while (cut > begin + 1 && isUtf8Continuation(text[cut])) --cut;
+    return cut;
+}
+
+// Calls fn(begin, end) for every literal candidate of query: each maximal
+// run of printable ASCII without whitespace, less the punctuation around
+// it. Runs stop at other bytes, so literals inside CJK text are found too.
+template <typename Fn>
+void forEachAsciiRun(std::string_view query, Fn&& fn) {
+    auto printable = [](char c) { return c > ' ' && c < 0x7F; };
+    static constexpr std::string_view kLeading = "\"'`([{<";
+    static constexpr std::string_view kTrailing = "\"'`)]}>,;:!?.";
+    size_t i = 0;
+    while (i < query.size()) {
+        if (!printable(query[i])) {
+            ++i;
+            continue;
+        }
+        size_t end = i;
+        while (end < query.size() && printable(query[end])) ++end;
+        size_t b = i;
+        size_t e = end;
+        while (b < e && kLeading.find(query[b]) != std::string_view::npos) ++b;
+        // Keep the parentheses of a call such as f()
+        while (e > b && kTrailing.find(query[e - 1]) != std::string_view::npos
+               && !(query[e - 1] == ')' && e - b >= 2 && query[e - 2] == '(')) {
+            --e;
+        }
+        if (b < e) fn(b, e);
+        i = end;
+    }
+}
+
+int64_t daysSinceEpoch(core::Timestamp time) {
+    return std::chrono::floor<std::chrono::days>(time).time_since_epoch().count();
+}
+
+// YYYYMMDD of days since the epoch
+uint32_t dayNumber(int64_t days) {
+    std::chrono::year_month_day date{std::chrono::sys_days(std::chrono::days(days))};
+    return static_cast<uint32_t>(static_cast<int>(date.year())) * 10000 + static_cast<unsigned>(date.month()) * 100
+         + static_cast<unsigned>(date.day());
+}
+
+} // namespace
+
+RawIndexOptions RawIndexOptions::fromConfig(const core::Config& config) {
+    RawIndexOptions options;
+    options.window_days = std::clamp(config.get<int>("raw_window_days", options.window_days), 1, 3650);
+    int passage_bytes = config.get<int>("raw_passage_bytes", static_cast<int>(options.passage_bytes));
+    options.passage_bytes = static_cast<size_t>(std::clamp(passage_bytes, 64, 1 << 20));
+    options.directory = config.get<std::string>("raw_index_dir", "");
+    options.search = SearchIndexOptions::fromConfig(config);
+    options.search.index_positions = true;
+    options.search.directory.clear();
+    return options;
+}
+
+std::vector<Passage> splitPassages(std::string_view text, size_t passage_bytes) {
+    passage_bytes = std::max<size_t>(passage_bytes, 16);
+    std::vector<Passage> passages;
+    auto append = [&](size_t begin, size_t end) {
+        // Join short neighbours while the span they cover stays within limits
+        if (!passages.empty()) {
+            Passage& last = passages.back();
+            size_t span = end - last.offset;
+            bool short_pair = last.length < passage_bytes / 4 || end - begin < passage_bytes / 4;
+            if (short_pair && span <= passage_bytes) {
+                last.length = span;
+                return;
+            }
+        }
+        passages.push_back({begin, end - begin});
+    };
+    for (auto [begin, end] : paragraphs(text)) {
+        while (end - begin > passage_bytes) {
+            size_t cut = cutPoint(text, begin, begin + passage_bytes);
+            auto [b, e] = trimmed(text, begin, cut);
+            if (b < e) append(b, e);
+            begin = trimmed(text, cut, end).first;
+        }
+        if (begin < end) append(begin, end);
+    }
+    return passages;
+}
+
+RawFallbackOptions RawFallbackOptions::fromConfig(const core::Config& config) {
+    RawFallbackOptions options;
+    int topn = config.get<int>("raw_low_coverage_topn", static_cast<int>(options.low_coverage_topn));
+    options.low_coverage_topn = static_cast<size_t>(std::max(topn, 0));
+    options.pattern_trigger = config.get<bool>("raw_pattern_trigger", options.pattern_trigger);
+    return options;
+}
+
+bool looksLikeLiteral(std::string_view token) {
+    if (token.size() < 3) return false;
+    // URL
+    if (token.find("://") != std::string_view::npos || token.starts_with("www.")) return true;
+    // Path: C:\Windows, /var/log, ~/x, ./run.sh, src/core/wal.cpp
+    size_t slashes = static_cast<size_t>(std::count(token.begin(), token.end(), '/'));
+    if (token.find('\\') != std::string_view::npos || token[0] == '/' || token.starts_with("~/")
+        || token.starts_with("./") || token.starts_with("../") || slashes >= 2
+        || (slashes == 1 && token.find('.', token.find('/')) != std::string_view::npos)) {
+        return true;
+    }
+    // UUID
+    if (token.size() == 36) {
+        bool uuid = true;
+        for (size_t i = 0; i < token.size() && uuid; ++i) {
+            uuid = (i == 8 || i == 13 || i == 18 || i == 23) ? token[i] == '-' : isHexDigit(token[i]);
+        }
+        if (uuid) return true;
+    }
+    // Hex constant
+    if (token[0] == '0' && (token[1] == 'x' || token[1] == 'X')
+        && std::all_of(token.begin() + 2, token.end(), isHexDigit)) {
+        return true;
+    }
+
+    size_t digits = 0;
+    size_t letters = 0;
+    size_t digit_run = 0;
+    size_t longest_run = 0;
+    bool code_chars = true;  // Only [A-Za-z0-9_.:-]
+    for (char c : token) {
+        bool digit = c >= '0' && c <= '9';
+        digits += digit;
+        letters += isAsciiAlnum(c) && !digit;
+        digit_run = digit ? digit_run + 1 : 0;
+        longest_run = std::max(longest_run, digit_run);
+        code_chars = code_chars && (isAsciiAlnum(c) || c == '_' || c == '.' || c == ':' || c == '-');
+    }
+    if (longest_run >= 5) return true;
+    // Hash or hex id
+    if (token.size() >= 8 && digits && letters && std::all_of(token.begin(), token.end(), isHexDigit)) return true;
+    // Error code or version: E1234, ORA-00942, HTTP404, v1.2.3
+    if (token.size() >= 4 && digits && letters && code_chars) return true;
+    // Identifier
+    if (token.find("::") != std::string_view::npos || token.ends_with("()")) return true;
+    for (size_t i = 1; i + 1 < token.size(); ++i) {
+        if (token[i] == '_' && isAsciiAlnum(token[i - 1]) && isAsciiAlnum(token[i + 1])) return true;
+    }
+    // File name with a short extension: bthusb.sys, config.yaml
+    size_t dot = token.rfind('.');
+    if (dot != std::string_view::npos && dot > 0 && isAsciiAlnum(token[dot - 1])) {
+        std::string_view extension = token.substr(dot + 1);
+        if (extension.size() >= 2 && extension.size() <= 4
+            && std::all_of(extension.begin(), extension.end(), isAsciiAlnum)
+            && std::any_of(extension.begin(), extension.end(), [](char c) { return !(c >= '0' && c <= '9'); })) {
+            return true;
+        }
+    }
+    return false;
+}
+
+RawFallbackReason needsRawFallback(std::string_view query, size_t node_hits, const RawFallbackOptions& options,
+                                   bool explicit_request) {
+    if (explicit_request) return RawFallbackReason::EXPLICIT;
+    if (options.pattern_trigger) {
+        bool literal = false;
+        forEachAsciiRun(query, [&](size_t begin, size_t end) {
+            literal = literal || looksLikeLiteral(query.substr(begin, end - begin));
+        });
+        if (literal) return RawFallbackReason::LITERAL;
+    }
+    if (node_hits < options.low_coverage_topn) return RawFallbackReason::LOW_COVERAGE;
+    return RawFallbackReason::NONE;
+}
+
+// === RawIndex ===
+
+struct RawIndex::Partition {
+    uint32_t day = 0;  // YYYYMMDD
+    std::string directory;  // Empty when in memory
+    std::unique_ptr<InvertedIndex> index;
+    std::vector<core::RawRef> passages;  // By doc id
+    std::unordered_set<core::Sha256Digest, DigestHash> chunks;
+};
+
+RawIndex::RawIndex(RawIndexOptions options) : options_(std::move(options)) {
+    options_.window_days = std::max(options_.window_days, 1);
+    options_.search.index_positions = true;
+}
+
+RawIndex::~RawIndex() = default;
+
+int64_t RawIndex::firstDay(core::Timestamp now) const {
+    return daysSinceEpoch(now) - (options_.window_days - 1);
+}
+
+std::string RawIndex::rewriteQuery(std::string_view query) {
+    if (query.find('"') != std::string_view::npos) return std::string(query);
+    std::string rewritten;
+    size_t copied = 0;
+    forEachAsciiRun(query, [&](size_t begin, size_t end) {
+        std::string_view token = query.substr(begin, end - begin);
+        if (!looksLikeLiteral(token)) return;
+        rewritten.append(query.substr(copied, begin - copied));
+        rewritten += " \"";
+        rewritten.append(token);
+        rewritten += "\" ";
+        copied = end;
+    });
+    rewritten.append(query.substr(copied));
+    return rewritten;
+}
+
+size_t RawIndex::Add(std::string_view tenant, const core::Sha256Digest& chunk, std::string_view text,
+                     core::Timestamp created_at, core::Timestamp now) {
+    std::string name = core::RawStore::tenantName(tenant);
+    int64_t day = daysSinceEpoch(created_at);
+    if (day < firstDay(now)) return 0;
+    std::vector<Passage> passages = splitPassages(text, options_.passage_bytes);
+
+    std::unique_lock lock(mutex_);
+    std::unique_ptr<Partition>& slot = partitions_[name][day];
+    if (!slot) {
+        auto partition = std::make_unique<Partition>();
+        partition->day = dayNumber(day);
+        SearchIndexOptions search = options_.search;
+        if (!options_.directory.empty()) {
+            // Left over from an earlier run: the index is rebuilt, not reopened
+            partition->directory = (fs::path(options_.directory) / name / std::to_string(partition->day)).string();
+            std::error_code ec;
+            fs::remove_all(partition->directory, ec);
+            if (ec) {
+                throw core::StorageException("Cannot clear raw index directory " + partition->directory + ": "
+                                             + ec.message());
+            }
+            search.directory = partition->directory;
+        }
+        partition->index = std::make_unique<InvertedIndex>(std::move(search));
+        slot = std::move(partition);
+    }
+    Partition& partition = *slot;
+    if (!partition.chunks.insert(chunk).second) return 0;
+    for (const Passage& passage : passages) {
+        uint64_t doc_id = partition.passages.size();
+        partition.passages.push_back({chunk, passage.offset, passage.length});
+        partition.index->Upsert(doc_id, text.substr(passage.offset, passage.length));
+    }
+    return passages.size();
+}
+
+void RawIndex::Flush() {
+    std::shared_lock lock(mutex_);
+    for (auto& [tenant, days] : partitions_) {
+        for (auto& [day, partition] : days) partition->index->Flush();
+    }
+}
+
+size_t RawIndex::Rebuild(const core::RawStore& store, core::Timestamp now) {
+    core::Timestamp since{std::chrono::sys_days(std::chrono::days(firstDay(now)))};
+    size_t chunks = 0;
+    for (const std::string& tenant : store.tenants()) {
+        for (const core::RawChunkInfo& info : store.list(tenant, since)) {
+            std::vector<uint8_t> content = store.read(tenant, info.sha256);
+            std::string_view text(reinterpret_cast<const char*>(content.data()), content.size());
+            Add(tenant, info.sha256, text, info.created_at, now);
+            ++chunks;
+        }
+    }
+    Flush();
+    return chunks;
+}
+
+std::vector<RawHit> RawIndex::Search(std::string_view tenant, std::string_view query, size_t topk,
+                                     core::Timestamp now) const {
+    std::vector<RawHit> hits;
+    if (topk == 0) return hits;
+    std::string name = core::RawStore::tenantName(tenant);
+    std::string rewritten = rewriteQuery(query);
+    int64_t first_day = firstDay(now);
+
+    std::shared_lock lock(mutex_);
+    auto found = partitions_.find(name);
+    if (found == partitions_.end()) return hits;
+    // Newest first, so the stable sort below breaks ties toward newer days
+    for (auto it = found->second.rbegin(); it != found->second.rend() && it->first >= first_day; ++it) {
+        const Partition& partition = *it->second;
+        for (const core::ScoredId& result : partition.index->Search(rewritten, topk)) {
+            hits.push_back({partition.passages[result.id], result.score, partition.day});
+        }
+    }
+    lock.unlock();
+    std::stable_sort(hits.begin(), hits.end(), [](const RawHit& a, const RawHit& b) { return a.score > b.score; });
+    if (hits.size() > topk) hits.resize(topk);
+    return hits;
+}
+
+size_t RawIndex::Expire(core::Timestamp now) {
+    int64_t first_day = firstDay(now);
+    std::vector<std::string> directories;
+    size_t dropped = 0;
+    {
+        std::unique_lock lock(mutex_);
+        for (auto tenant = partitions_.begin(); tenant != partitions_.end();) {
+            auto& days = tenant->second;
+            auto keep = days.lower_bound(first_day);
+            for (auto it = days.begin(); it != keep; ++it) {
+                if (!it->second->directory.empty()) directories.push_back(it->second->directory);
+                ++dropped;
+            }
+            days.erase(days.begin(), keep);
+            tenant = days.empty() ? partitions_.erase(tenant) : std::next(tenant);
+        }
+    }
+    // The partitions are gone, so nothing maps these files any more
+    for (const std::string& directory : directories) {
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+        if (ec) LOG_WARN("Cannot remove expired raw index partition " + directory + ": " + ec.message());
+    }
+    return dropped;
+}
+
+size_t RawIndex::partitionCount() const {
+    std::shared_lock lock(mutex_);
+    size_t count = 0;
+    for (const auto& [tenant, days] : partitions_) count += days.size();
+    return count;
+}
+
+size_t RawIndex::passageCount() const {
+    std::shared_lock lock(mutex_);
+    size_t count = 0;
+    for (const auto& [tenant, days] : partitions_) {
+        for (const auto& [day, partition] : days) count += partition->passages.size();
+    }
+    return count;
+}
+
+// === Merge ===
+
+std::vector<RecallHit> mergeRawHits(std::span<const core::ScoredId> graph_hits, std::span<const RawHit> raw_hits,
+                                    size_t topk, const RawRefsOf& raw_refs_of, float raw_weight) {
+    auto bestOf = [](auto hits) {
+        float best = 0.0f;
+        for (const auto& hit : hits) best = std::max(best, hit.score);
+        return best > 0.0f ? best : 1.0f;
+    };
+    // Byte ranges already covered, per chunk
+    std::unordered_map<core::Sha256Digest, std::vector<std::pair<uint64_t, uint64_t>>, DigestHash> covered;
+    auto overlaps = [&](const core::RawRef& ref) {
+        auto it = covered.find(ref.chunk);
+        if (it == covered.end()) return false;
+        uint64_t end = ref.offset + ref.length;
+        return std::any_of(it->second.begin(), it->second.end(),
+                           [&](const auto& range) { return ref.offset < range.second && range.first < end; });
+    };
+
+    std::vector<RecallHit> merged;
+    merged.reserve(graph_hits.size() + raw_hits.size());
+    float graph_best = bestOf(graph_hits);
+    for (const core::ScoredId& hit : graph_hits) {
+        RecallHit recall;
+        recall.source = RecallHit::Source::GRAPH;
+        recall.node = hit.id;
+        recall.score = hit.score / graph_best;
+        merged.push_back(recall);
+        if (!raw_refs_of) continue;
+        for (const core::RawRef& ref : raw_refs_of(hit.id)) {
+            covered[ref.chunk].emplace_back(ref.offset, ref.offset + ref.length);
+        }
+    }
+    float raw_best = bestOf(raw_hits);
+    for (const RawHit& hit : raw_hits) {
+        if (overlaps(hit.ref)) continue;
+        covered[hit.ref.chunk].emplace_back(hit.ref.offset, hit.ref.offset + hit.ref.length);
+        RecallHit recall;
+        recall.source = RecallHit::Source::RAW;
+        recall.ref = hit.ref;
+        recall.score = hit.score / raw_best * raw_weight;
+        merged.push_back(recall);
+    }
+    std::stable_sort(merged.begin(), merged.end(),
+                     [](const RecallHit& a, const RecallHit& b) { return a.score > b.score; });
+    if (merged.size() > topk) merged.resize(topk);
+    return merged;
+}
+
+} // namespace memory::search
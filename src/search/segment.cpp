@@ -0,0 +1,128 @@
+#include "memory/search/segment.h"
+#include <algorithm>
+
+namespace memory::search {
+
+bool Segment::markDeleted(uint32_t ord, uint64_t version) {
+    std::atomic_ref deleted_at(deleted_at_[ord]);
+    if (deleted_at.load(std::memory_order_relaxed) != 0) return false;
+    deleted_at.store(version, std::memory_order_relaxed);
+    return true;
+}
+
+const TermInfo* Segment::findTerm(std::string_view term) const {
+    uint32_t ordinal = dictionary_.find(term);
+    return ordinal != TermDictionary::kNotFound ? &term_infos_[ordinal] : nullptr;
+}
+
+PositionReader Segment::positions(const TermInfo& info) const {
+    return PositionReader(positions_.data() + info.positions_offset, position_blocks_.data() + info.skip_start);
+}
+
+std::span<const uint8_t> Segment::dictionaryImage() const {
+    return dictionary_file_.isOpen() ? dictionary_file_.bytes() : std::span<const uint8_t>(dictionary_bytes_);
+}
+
+PostingCursor Segment::cursor(const TermInfo& info) const {
+    return PostingCursor(postings_.data() + info.postings_offset,
+                         skips_.data() + info.skip_start,
+                         info.doc_freq);
+}
+
+size_t Segment::memoryBytes() const {
+    size_t bytes = postings_.capacity() + skips_.capacity() * sizeof(SkipEntry)
+                 + doc_ids_.capacity() * sizeof(uint64_t)
+                 + doc_lengths_.capacity() * sizeof(uint32_t) + deleted_at_.capacity() * sizeof(uint64_t);
+    bytes += positions_.capacity() + position_blocks_.capacity() * sizeof(uint32_t);
+    bytes += dictionary_bytes_.capacity() + term_infos_.capacity() * sizeof(TermInfo);
+    return bytes;
+}
+
+uint32_t SegmentBuilder::addDocument(uint64_t doc_id, const TermFreqs& term_freqs, uint32_t length,
+                                     std::span<const uint32_t> positions) {
+    uint32_t ord = docCount();
+    doc_ids_.push_back(doc_id);
+    doc_lengths_.push_back(length);
+    size_t next = 0;
+    for (const auto& [term, freq] : term_freqs) {
+        PendingPostings& pending = postings_[term];
+        pending.docs.emplace_back(ord, freq);
+        if (has_positions_) {
+            pending.positions.insert(pending.positions.end(), positions.begin() + next,
+                                     positions.begin() + next + freq);
+            next += freq;
+        }
+    }
+    return ord;
+}
+
+std::unique_ptr<Segment> SegmentBuilder::build(const TermInterner& terms, const std::string& dictionary_path) {
+    auto segment = std::unique_ptr<Segment>(new Segment());
+    segment->term_infos_.reserve(postings_.size());
+    segment->doc_lengths_ = std::move(doc_lengths_);
+
+    std::vector<uint32_t> term_ids;
+    term_ids.reserve(postings_.size());
+    for (const auto& entry : postings_) {
+        term_ids.push_back(entry.first);
+    }
+    std::sort(term_ids.begin(), term_ids.end(), [&terms](uint32_t a, uint32_t b) {
+        return terms.str(a) < terms.str(b);
+    });
+
+    segment->has_positions_ = has_positions_;
+    TermDictionaryWriter dictionary(segment->dictionary_bytes_);
+    for (uint32_t term_id : term_ids) {
+        const PendingPostings& pending = postings_[term_id];
+        dictionary.add(terms.str(term_id));
+
+        TermInfo info;
+        info.skip_start = static_cast<uint32_t>(segment->skips_.size());
+        info.postings_offset = segment->postings_.size();
+        info.positions_offset = segment->positions_.size();
+
+        PostingsWriter writer(segment->postings_, segment->skips_);
+        for (const auto& [ord, freq] : pending.docs) {
+            writer.add(ord, freq, segment->doc_lengths_[ord]);
+        }
+        info.doc_freq = writer.finish();
+
+        if (has_positions_) {
+            PositionsWriter positions(segment->positions_, segment->position_blocks_);
+            const uint32_t* next = pending.positions.data();
+            for (const auto& [ord, freq] : pending.docs) {
+                positions.add(next, freq);
+                next += freq;
+            }
+            positions.finish();
+        }
+        segment->term_infos_.push_back(info);
+    }
+    dictionary.finish();
+    segment->dictionary_bytes_.shrink_to_fit();
+
+    if (!dictionary_path.empty()) {
+        core::writeFileAtomically(dictionary_path, segment->dictionary_bytes_);
+        segment->dictionary_file_ = core::MappedFile::open(dictionary_path);
+        std::vector<uint8_t>().swap(segment->dictionary_bytes_);
+    }
+    segment->dictionary_ = TermDictionary(segment->dictionaryImage());
+    segment->postings_.resize(segment->postings_.size() + kPostingPadding, 0);
+    segment->postings_.shrink_to_fit();
+    segment->skips_.shrink_to_fit();
+    if (has_positions_) {
+        segment->positions_.resize(segment->positions_.size() + kPostingPadding, 0);
+        segment->positions_.shrink_to_fit();
+        segment->position_blocks_.shrink_to_fit();
+    }
+
+    segment->doc_ids_ = std::move(doc_ids_);
+    segment->deleted_at_.assign(segment->doc_ids_.size(), 0);
+
+    postings_.clear();
+    doc_ids_.clear();
+    doc_lengths_.clear();
+    return segment;
+}
+
+} // namespace memory::search
@@ -0,0 +1,447 @@
+#include "memory/search/simd_kernels.h"
+#include "memory/search/postings.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(MEMORY_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+namespace memory::search {
+
+namespace {
+
+// Galloping pays off once one list is this many times longer than the other
+constexpr size_t kGallopRatio = 32;
+
+inline uint32_t lowMask(uint32_t bits) {
+    return bits >= 32 ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+}
+
+inline uint32_t loadWord(const uint8_t* in, size_t index) {
+    uint32_t word;
+    std::memcpy(&word, in + index * 4, sizeof(word));
+    return word;
+}
+
+// First index p >= from with b[p] >= x, by exponential then binary search
+inline size_t gallop(const uint32_t* b, size_t from, size_t nb, uint32_t x) {
+    if (from >= nb || b[from] >= x) return from;
+    size_t lo = from;  // b[lo] < x
+    size_t step = 1;
+    while (lo + step < nb && b[lo + step] < x) {
+        lo += step;
+        step <<= 1;
+    }
+    size_t hi = std::min(lo + step, nb);
+    return static_cast<size_t>(std::lower_bound(b + lo + 1, b + hi, x) - b);
+}
+
+// === Scalar ===
+
+void unpackScalar(const uint8_t* in, uint32_t bits, uint32_t* out) {
+    if (bits == 0) {
+        std::memset(out, 0, kPostingBlockSize * sizeof(uint32_t));
+        return;
+    }
+    const uint32_t mask = lowMask(bits);
+    for (uint32_t row = 0; row < kPostingBlockSize / 4; ++row) {
+        uint32_t bit_pos = row * bits;
+        uint32_t word = bit_pos >> 5;
+        uint32_t shift = bit_pos & 31;
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            uint32_t value = loadWord(in, word * 4 + lane) >> shift;
+            if (shift + bits > 32) {
+                value |= loadWord(in, (word + 1) * 4 + lane) << (32 - shift);
+            }
+            out[row * 4 + lane] = value & mask;
+        }
+    }
+}
+
+void prefixSumScalar(uint32_t* values, uint32_t base) {
+    for (uint32_t i = 0; i < kPostingBlockSize; ++i) {
+        base += values[i];
+        values[i] = base;
+    }
+}
+
+size_t gallopIntersectScalar(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    size_t k = 0;
+    size_t j = 0;
+    for (size_t i = 0; i < na; ++i) {
+        j = gallop(b, j, nb, a[i]);
+        if (j == nb) break;
+        if (b[j] == a[i]) out[k++] = a[i];
+    }
+    return k;
+}
+
+size_t mergeIntersectScalar(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        uint32_t x = a[i];
+        uint32_t y = b[j];
+        out[k] = x;
+        k += (x == y);
+        i += (x <= y);
+        j += (y <= x);
+    }
+    return k;
+}
+
+size_t intersectScalar(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0) return 0;
+    if (nb / na >= kGallopRatio) {
+        return gallopIntersectScalar(a, na, b, nb, out);
+    }
+    return mergeIntersectScalar(a, na, b, nb, out);
+}
+
+// Merges sorted tails while skipping values <= last (already emitted)
+size_t mergeTail(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                 uint32_t* out, size_t k, bool has_last, uint32_t last) {
+    size_t i = 0, j = 0;
+    while (i < na || j < nb) {
+        uint32_t v;
+        if (j == nb || (i < na && a[i] <= b[j])) {
+            v = a[i++];
+        } else {
+            v = b[j++];
+        }
+        if (!has_last || v != last) {
+            out[k++] = v;
+            last = v;
+            has_last = true;
+        }
+    }
+    return k;
+}
+
+size_t unionScalar(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    return mergeTail(a, na, b, nb, out, 0, false, 0);
+}
+
+#if defined(MEMORY_ARCH_X86)
+
+// pshufb masks moving the lanes selected by a 4-bit mask to the front
+struct CompactTable {
+    alignas(16) std::array<std::array<uint8_t, 16>, 16> masks{};
+
+    constexpr CompactTable() {
+        for (int mask = 0; mask < 16; ++mask) {
+            int out = 0;
+            for (int lane = 0; lane < 4; ++lane) {
+                if (mask & (1 << lane)) {
+                    for (int byte = 0; byte < 4; ++byte) {
+                        masks[mask][out * 4 + byte] = static_cast<uint8_t>(lane * 4 + byte);
+                    }
+                    ++out;
+                }
+            }
+            for (int pos = out * 4; pos < 16; ++pos) {
+                masks[mask][pos] = 0x80;
+            }
+        }
+    }
+};
+
+constexpr CompactTable kCompact;
+
+// === SSE4.2 ===
+
+MEMORY_TARGET("sse4.2")
+void unpackSse(const uint8_t* in, uint32_t bits, uint32_t* out) {
+    if (bits == 0) {
+        std::memset(out, 0, kPostingBlockSize * sizeof(uint32_t));
+        return;
+    }
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(lowMask(bits)));
+    for (uint32_t row = 0; row < kPostingBlockSize / 4; ++row) {
+        uint32_t bit_pos = row * bits;
+        uint32_t word = bit_pos >> 5;
+        uint32_t shift = bit_pos & 31;
+        // Shifting by 32 yields zero, so the spill word needs no branch
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + word * 16));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (word + 1) * 16));
+        __m128i value = _mm_or_si128(_mm_srl_epi32(lo, _mm_cvtsi32_si128(static_cast<int>(shift))),
+                                     _mm_sll_epi32(hi, _mm_cvtsi32_si128(static_cast<int>(32 - shift))));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + row * 4), _mm_and_si128(value, mask));
+    }
+}
+
+MEMORY_TARGET("sse4.2")
+void prefixSumSse(uint32_t* values, uint32_t base) {
+    __m128i carry = _mm_set1_epi32(static_cast<int>(base));
+    for (uint32_t i = 0; i < kPostingBlockSize; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+        carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+}
+
+MEMORY_TARGET("sse4.2")
+inline size_t storeCompacted(__m128i values, int mask, uint32_t* out) {
+    __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(kCompact.masks[mask].data()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(values, shuffle));
+    return static_cast<size_t>(std::popcount(static_cast<unsigned>(mask)));
+}
+
+// All-pairs 4x4 block comparison (Schlegel et al.) for lists of similar length
+MEMORY_TARGET("sse4.2")
+size_t shuffleIntersectSse(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    size_t i = 0, j = 0, k = 0;
+    const size_t na4 = na & ~size_t{3};
+    const size_t nb4 = nb & ~size_t{3};
+    while (i < na4 && j < nb4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        k += storeCompacted(va, _mm_movemask_ps(_mm_castsi128_ps(eq)), out + k);
+
+        uint32_t a_max = a[i + 3];
+        uint32_t b_max = b[j + 3];
+        i += (a_max <= b_max) ? 4 : 0;
+        j += (b_max <= a_max) ? 4 : 0;
+    }
+    return k + mergeIntersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+// Galloping over the long list, finishing each probe with one vector compare
+template <size_t W, typename Probe>
+inline size_t simdGallopIntersect(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                                  uint32_t* out, Probe probe) {
+    size_t i = 0, j = 0, k = 0;
+    for (; i < na && j + W <= nb; ++i) {
+        uint32_t x = a[i];
+        if (b[j + W - 1] < x) {
+            size_t p = gallop(b, j + W, nb, x);
+            if (p == nb) {
+                j = nb;
+                break;
+            }
+            // Window [j, j+W) now contains lower_bound(x) = p
+            j = std::min(p, nb - W);
+        }
+        out[k] = x;
+        k += probe(b + j, x) ? 1 : 0;
+    }
+    return k + gallopIntersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+MEMORY_TARGET("sse4.2")
+inline bool probeSse(const uint32_t* window, uint32_t x) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(window));
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, _mm_set1_epi32(static_cast<int>(x))))) != 0;
+}
+
+MEMORY_TARGET("sse4.2")
+size_t intersectSse(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0) return 0;
+    if (nb / na >= kGallopRatio) {
+        return simdGallopIntersect<4>(a, na, b, nb, out, [](const uint32_t* w, uint32_t x) { return probeSse(w, x); });
+    }
+    return shuffleIntersectSse(a, na, b, nb, out);
+}
+
+// Bitonic merge network: on return lo holds the 4 smallest, hi the 4 largest
+MEMORY_TARGET("sse4.2")
+inline void bitonicMerge4(__m128i& lo, __m128i& hi) {
+    hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(0, 1, 2, 3));
+    __m128i l1 = _mm_min_epu32(lo, hi);
+    __m128i h1 = _mm_max_epu32(lo, hi);
+
+    __m128i l1s = _mm_shuffle_epi32(l1, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128i h1s = _mm_shuffle_epi32(h1, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128i l2 = _mm_blend_epi16(_mm_min_epu32(l1, l1s), _mm_max_epu32(l1, l1s), 0xF0);
+    __m128i h2 = _mm_blend_epi16(_mm_min_epu32(h1, h1s), _mm_max_epu32(h1, h1s), 0xF0);
+
+    __m128i l2s = _mm_shuffle_epi32(l2, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128i h2s = _mm_shuffle_epi32(h2, _MM_SHUFFLE(2, 3, 0, 1));
+    lo = _mm_blend_epi16(_mm_min_epu32(l2, l2s), _mm_max_epu32(l2, l2s), 0xCC);
+    hi = _mm_blend_epi16(_mm_min_epu32(h2, h2s), _mm_max_epu32(h2, h2s), 0xCC);
+}
+
+MEMORY_TARGET("sse4.2")
+size_t unionSse(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    if (na < 4 || nb < 4) {
+        return unionScalar(a, na, b, nb, out);
+    }
+    size_t i = 4, j = 4, k = 0;
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    // Last emitted block, seeded so its top lane never equals the first output
+    __m128i prev = _mm_set1_epi32(static_cast<int>(std::min(a[0], b[0]) - 1));
+
+    for (;;) {
+        bitonicMerge4(lo, hi);
+        // Drop values equal to their predecessor (present in both lists)
+        __m128i shifted = _mm_alignr_epi8(lo, prev, 12);
+        int fresh = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, shifted))) & 0xF;
+        k += storeCompacted(lo, fresh, out + k);
+        prev = lo;
+
+        // Refill from the list with the smaller head while both have a full block
+        if (i + 4 > na || j + 4 > nb) break;
+        if (a[i] <= b[j]) {
+            lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            i += 4;
+        } else {
+            lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            j += 4;
+        }
+    }
+
+    // Scalar three-way merge of the pending block and both remainders
+    alignas(16) uint32_t pending[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(pending), hi);
+    uint32_t last = static_cast<uint32_t>(_mm_extract_epi32(prev, 3));
+    size_t p = 0;
+    while (p < 4 || i < na || j < nb) {
+        uint32_t v = UINT32_MAX;
+        int source = -1;
+        if (p < 4) { v = pending[p]; source = 0; }
+        if (i < na && (source < 0 || a[i] < v)) { v = a[i]; source = 1; }
+        if (j < nb && (source < 0 || b[j] < v)) { v = b[j]; source = 2; }
+        if (source == 0) ++p;
+        else if (source == 1) ++i;
+        else ++j;
+        if (v != last) {
+            out[k++] = v;
+            last = v;
+        }
+    }
+    return k;
+}
+
+// === AVX2 ===
+
+MEMORY_TARGET("avx2")
+void unpackAvx2(const uint8_t* in, uint32_t bits, uint32_t* out) {
+    if (bits == 0) {
+        std::memset(out, 0, kPostingBlockSize * sizeof(uint32_t));
+        return;
+    }
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(lowMask(bits)));
+    const __m256i thirty_two = _mm256_set1_epi32(32);
+    // Two rows (8 values) per iteration; each 128-bit half has its own shift
+    for (uint32_t row = 0; row < kPostingBlockSize / 4; row += 2) {
+        uint32_t pos0 = row * bits;
+        uint32_t pos1 = pos0 + bits;
+        uint32_t w0 = pos0 >> 5, s0 = pos0 & 31;
+        uint32_t w1 = pos1 >> 5, s1 = pos1 & 31;
+        __m256i lo = _mm256_set_m128i(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + w1 * 16)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + w0 * 16)));
+        __m256i hi = _mm256_set_m128i(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (w1 + 1) * 16)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (w0 + 1) * 16)));
+        __m256i shift = _mm256_set_epi32(s1, s1, s1, s1, s0, s0, s0, s0);
+        __m256i value = _mm256_or_si256(_mm256_srlv_epi32(lo, shift),
+                                        _mm256_sllv_epi32(hi, _mm256_sub_epi32(thirty_two, shift)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + row * 4), _mm256_and_si256(value, mask));
+    }
+}
+
+MEMORY_TARGET("avx2")
+void prefixSumAvx2(uint32_t* values, uint32_t base) {
+    __m256i carry = _mm256_set1_epi32(static_cast<int>(base));
+    const __m256i last_of_low = _mm256_set1_epi32(3);
+    const __m256i last = _mm256_set1_epi32(7);
+    for (uint32_t i = 0; i < kPostingBlockSize; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        // Carry the low half's total into the high half
+        __m256i low_total = _mm256_permutevar8x32_epi32(x, last_of_low);
+        x = _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(), low_total, 0xF0));
+        x = _mm256_add_epi32(x, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), x);
+        carry = _mm256_permutevar8x32_epi32(x, last);
+    }
+}
+
+MEMORY_TARGET("avx2")
+inline bool probeAvx2(const uint32_t* window, uint32_t x) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(window));
+    __m256i eq = _mm256_cmpeq_epi32(v, _mm256_set1_epi32(static_cast<int>(x)));
+    return _mm256_movemask_ps(_mm256_castsi256_ps(eq)) != 0;
+}
+
+MEMORY_TARGET("avx2")
+size_t intersectAvx2(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0) return 0;
+    if (nb / na >= kGallopRatio) {
+        return simdGallopIntersect<8>(a, na, b, nb, out, [](const uint32_t* w, uint32_t x) { return probeAvx2(w, x); });
+    }
+    return shuffleIntersectSse(a, na, b, nb, out);
+}
+
+#endif // MEMORY_ARCH_X86
+
+const PostingKernels kScalarKernels{
+    "scalar", core::SimdLevel::SCALAR, unpackScalar, prefixSumScalar, intersectScalar, unionScalar};
+
+#if defined(MEMORY_ARCH_X86)
+const PostingKernels kSseKernels{
+    "sse4.2", core::SimdLevel::SSE42, unpackSse, prefixSumSse, intersectSse, unionSse};
+// The 4-wide bitonic union is already memory bound, AVX2 reuses it
+const PostingKernels kAvx2Kernels{
+    "avx2", core::SimdLevel::AVX2, unpackAvx2, prefixSumAvx2, intersectAvx2, unionSse};
+#endif
+
+} // namespace
+
+const PostingKernels* postingKernels(core::SimdLevel level) {
+    if (!core::simdLevelSupported(level)) return nullptr;
+    switch (level) {
+        case core::SimdLevel::SCALAR: return &kScalarKernels;
+#if defined(MEMORY_ARCH_X86)
+        case core::SimdLevel::SSE42: return &kSseKernels;
+        case core::SimdLevel::AVX2: return &kAvx2Kernels;
+#endif
+        default: return nullptr;
+    }
+}
+
+const PostingKernels& postingKernels() {
+    static const PostingKernels* kernels = [] {
+        const PostingKernels* best = postingKernels(core::bestSimdLevel());
+        return best ? best : &kScalarKernels;
+    }();
+    return *kernels;
+}
+
+std::vector<uint32_t> intersectSorted(std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    std::vector<uint32_t> out(std::min(a.size(), b.size()) + kKernelOutputSlack);
+    out.resize(postingKernels().intersect(a.data(), a.size(), b.data(), b.size(), out.data()));
+    return out;
+}
+
+std::vector<uint32_t> unionSorted(std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    std::vector<uint32_t> out(a.size() + b.size() + kKernelOutputSlack);
+    out.resize(postingKernels().merge_union(a.data(), a.size(), b.data(), b.size(), out.data()));
+    return out;
+}
+
+} // namespace memory::search
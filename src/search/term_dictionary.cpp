@@ -0,0 +1,233 @@
+#include "memory/search/term_dictionary.h"
+#include "memory/search/postings.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <cstring>
+
+namespace memory::search {
+
+namespace {
+
+size_t commonPrefix(std::string_view a, std::string_view b) {
+    size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) ++i;
+    return i;
+}
+
+void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+    size_t pos = out.size();
+    out.resize(pos + sizeof(value));
+    std::memcpy(out.data() + pos, &value, sizeof(value));
+}
+
+uint32_t loadU32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+// === TermDictionaryWriter ===
+
+TermDictionaryWriter::TermDictionaryWriter(std::vector<uint8_t>& out)
+    : out_(out), header_offset_(core::beginFileHeader(out)) {}
+
+uint32_t TermDictionaryWriter::add(std::string_view term) {
+    if (count_ > 0 && term <= std::string_view(last_)) {
+        throw core::IndexException("Term dictionary input is not strictly increasing at '"
+                                   + std::string(term) + "'");
+    }
+    size_t payload_start = header_offset_ + sizeof(core::FileHeader);
+    if (count_ % kDictBlockTerms == 0) {
+        block_offsets_.push_back(static_cast<uint32_t>(out_.size() - payload_start));
+        encodeVarint(static_cast<uint32_t>(term.size()), out_);
+        out_.insert(out_.end(), term.begin(), term.end());
+    } else {
+        size_t shared = commonPrefix(last_, term);
+        encodeVarint(static_cast<uint32_t>(shared), out_);
+        encodeVarint(static_cast<uint32_t>(term.size() - shared), out_);
+        out_.insert(out_.end(), term.begin() + shared, term.end());
+    }
+    last_.assign(term);
+    return count_++;
+}
+
+void TermDictionaryWriter::finish() {
+    if (finished_) return;
+    size_t payload_start = header_offset_ + sizeof(core::FileHeader);
+    while ((out_.size() - payload_start) % sizeof(uint32_t) != 0) {
+        out_.push_back(0);
+    }
+    for (uint32_t offset : block_offsets_) {
+        appendU32(out_, offset);
+    }
+    appendU32(out_, count_);
+    appendU32(out_, static_cast<uint32_t>(block_offsets_.size()));
+    core::sealFileHeader(out_, header_offset_, kTermDictionaryMagic, kTermDictionaryVersion);
+    finished_ = true;
+}
+
+// === TermDictionary ===
+
+TermDictionary::TermDictionary(std::span<const uint8_t> image) {
+    auto payload = core::checkFileHeader(image, kTermDictionaryMagic, kTermDictionaryVersion, "term dictionary");
+    if (payload.size() < 2 * sizeof(uint32_t)) {
+        throw core::StorageException("term dictionary: missing trailer");
+    }
+    const uint8_t* trailer = payload.data() + payload.size() - 2 * sizeof(uint32_t);
+    uint32_t term_count = loadU32(trailer);
+    uint32_t block_count = loadU32(trailer + sizeof(uint32_t));
+    size_t table_bytes = static_cast<size_t>(block_count) * sizeof(uint32_t);
+    if (block_count != (term_count + kDictBlockTerms - 1) / kDictBlockTerms
+        || table_bytes > payload.size() - 2 * sizeof(uint32_t)) {
+        throw core::StorageException("term dictionary: inconsistent trailer");
+    }
+    const uint8_t* table = trailer - table_bytes;
+    uint32_t blocks_bytes = static_cast<uint32_t>(table - payload.data());
+    uint32_t prev = 0;
+    for (uint32_t b = 0; b < block_count; ++b) {
+        uint32_t offset = loadU32(table + b * sizeof(uint32_t));
+        if (offset >= blocks_bytes || (b > 0 && offset <= prev)) {
+            throw core::StorageException("term dictionary: bad block offset");
+        }
+        prev = offset;
+    }
+
+    payload_ = payload.data();
+    block_offsets_ = table;
+    term_count_ = term_count;
+    block_count_ = block_count;
+}
+
+uint32_t TermDictionary::blockOffset(uint32_t block) const {
+    return loadU32(block_offsets_ + block * sizeof(uint32_t));
+}
+
+std::string_view TermDictionary::blockFirstTerm(uint32_t block, const uint8_t** after) const {
+    uint32_t length;
+    const uint8_t* p = decodeVarint(payload_ + blockOffset(block), length);
+    if (after) *after = p + length;
+    return {reinterpret_cast<const char*>(p), length};
+}
+
+uint32_t TermDictionary::seek(std::string_view key, bool& exact) const {
+    exact = false;
+    // Last block whose first term is <= key
+    uint32_t lo = 0;
+    uint32_t hi = block_count_;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (blockFirstTerm(mid, nullptr) <= key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) return 0;
+
+    uint32_t block = lo - 1;
+    const uint8_t* p;
+    std::string_view first = blockFirstTerm(block, &p);
+    uint32_t ordinal = block * kDictBlockTerms;
+    if (first == key) {
+        exact = true;
+        return ordinal;
+    }
+
+    // Walk the block without rebuilding terms. `matched` is the common prefix
+    // of the previous term and key; a term sharing more than that with its
+    // predecessor is still below key, one sharing less is already above it.
+    size_t matched = commonPrefix(first, key);
+    uint32_t block_end = std::min(ordinal + kDictBlockTerms, term_count_);
+    for (uint32_t ord = ordinal + 1; ord < block_end; ++ord) {
+        uint32_t shared;
+        uint32_t suffix_len;
+        p = decodeVarint(p, shared);
+        p = decodeVarint(p, suffix_len);
+        std::string_view suffix(reinterpret_cast<const char*>(p), suffix_len);
+        p += suffix_len;
+
+        if (shared > matched) continue;
+        if (shared < matched) return ord;
+
+        std::string_view tail = key.substr(matched);
+        size_t common = commonPrefix(suffix, tail);
+        matched += common;
+        if (common == suffix.size()) {
+            if (common == tail.size()) {
+                exact = true;
+                return ord;
+            }
+            continue;  // Term is a proper prefix of key
+        }
+        if (common == tail.size()) return ord;  // Key is a proper prefix of term
+        if (static_cast<uint8_t>(suffix[common]) > static_cast<uint8_t>(tail[common])) return ord;
+    }
+    return block_end;
+}
+
+uint32_t TermDictionary::find(std::string_view term) const {
+    bool exact;
+    uint32_t ordinal = seek(term, exact);
+    return exact ? ordinal : kNotFound;
+}
+
+uint32_t TermDictionary::lowerBound(std::string_view key) const {
+    bool exact;
+    return seek(key, exact);
+}
+
+std::pair<uint32_t, uint32_t> TermDictionary::prefixRange(std::string_view prefix) const {
+    uint32_t first = lowerBound(prefix);
+    // Smallest string greater than every string starting with prefix
+    std::string upper(prefix);
+    while (!upper.empty() && static_cast<uint8_t>(upper.back()) == 0xFF) {
+        upper.pop_back();
+    }
+    if (upper.empty()) return {first, term_count_};
+    upper.back() = static_cast<char>(static_cast<uint8_t>(upper.back()) + 1);
+    return {first, lowerBound(upper)};
+}
+
+TermDictionary::Iterator TermDictionary::iterate(uint32_t first, uint32_t last) const {
+    Iterator it;
+    it.dict_ = this;
+    it.end_ = std::min(last, term_count_);
+    if (first >= it.end_) {
+        it.ordinal_ = it.end_;
+        return it;
+    }
+    uint32_t block = first / kDictBlockTerms;
+    it.ordinal_ = block * kDictBlockTerms;
+    it.pos_ = payload_ + blockOffset(block);
+    it.decode();
+    while (it.ordinal_ < first) {
+        it.next();
+    }
+    return it;
+}
+
+void TermDictionary::Iterator::next() {
+    if (++ordinal_ < end_) {
+        if (ordinal_ % kDictBlockTerms == 0) {
+            pos_ = dict_->payload_ + dict_->blockOffset(ordinal_ / kDictBlockTerms);
+        }
+        decode();
+    }
+}
+
+void TermDictionary::Iterator::decode() {
+    uint32_t shared = 0;
+    uint32_t suffix_len;
+    if (ordinal_ % kDictBlockTerms != 0) {
+        pos_ = decodeVarint(pos_, shared);
+    }
+    pos_ = decodeVarint(pos_, suffix_len);
+    term_.resize(shared);
+    term_.append(reinterpret_cast<const char*>(pos_), suffix_len);
+    pos_ += suffix_len;
+}
+
+} // namespace memory::search
@@ -0,0 +1,12 @@
+#include "memory/search/term_interner.h"
+
+namespace memory::search {
+
+void internTokens(const Tokenizer& tokenizer, std::string_view text, TermInterner& interner,
+                  std::vector<uint32_t>& ids) {
+    tokenizer.tokenize(text, [&](const Token& token) {
+        ids.push_back(interner.intern(token.text));
+    });
+}
+
+} // namespace memory::search
@@ -0,0 +1,192 @@
+#include "memory/search/tokenizer.h"
+#include "memory/core/config.h"
+#include <cstring>
+
+namespace memory::search {
+
+namespace {
+
+constexpr uint32_t kInvalidCodePoint = 0xFFFFFFFFu;
+
+// Lucene's English stop set plus high-frequency Chinese function characters.
+// Only whole tokens are filtered, so "在" is dropped while the bigram "在公"
+// of "在公园" is kept.
+constexpr const char* kDefaultStopwords[] = {
+    "a", "an", "and", "are", "as", "at", "be", "but", "by", "for", "if", "in", "into", "is", "it",
+    "no", "not", "of", "on", "or", "such", "that", "the", "their", "then", "there", "these",
+    "they", "this", "to", "was", "will", "with",
+    "的", "了", "和", "是", "在", "就", "都", "而", "及", "与", "着", "或", "也", "之", "其",
+};
+
+enum class CharClass { SEPARATOR, WORD, CJK };
+
+struct CodePoint {
+    uint32_t value;
+    uint32_t length;  // Encoded length in bytes
+};
+
+// Decodes one UTF-8 sequence. Malformed or truncated sequences yield
+// kInvalidCodePoint with length 1 so the caller resynchronizes byte-wise.
+CodePoint decodeUtf8(const unsigned char* p, size_t remaining) {
+    unsigned char c = p[0];
+    if (c < 0x80) return {c, 1};
+
+    uint32_t length;
+    uint32_t value;
+    if ((c & 0xE0) == 0xC0) {
+        length = 2;
+        value = c & 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+        length = 3;
+        value = c & 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+        length = 4;
+        value = c & 0x07;
+    } else {
+        return {kInvalidCodePoint, 1};
+    }
+    if (length > remaining) return {kInvalidCodePoint, 1};
+    for (uint32_t i = 1; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return {kInvalidCodePoint, 1};
+        value = (value << 6) | (p[i] & 0x3F);
+    }
+    return {value, length};
+}
+
+bool isFullwidthAlnum(uint32_t cp) {
+    return (cp >= 0xFF10 && cp <= 0xFF19) || (cp >= 0xFF21 && cp <= 0xFF3A) || (cp >= 0xFF41 && cp <= 0xFF5A);
+}
+
+CharClass classify(uint32_t cp) {
+    if (cp < 0x80) {
+        bool word = (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || cp == '_';
+        return word ? CharClass::WORD : CharClass::SEPARATOR;
+    }
+    if (cp < 0xC0 || cp == 0xD7 || cp == 0xF7) return CharClass::SEPARATOR;  // C1 controls, Latin-1 punctuation
+    if (cp >= 0x2000 && cp <= 0x2BFF) return CharClass::SEPARATOR;           // General punctuation .. misc symbols
+    if (cp >= 0x2E80 && cp <= 0x2FDF) return CharClass::CJK;                 // Radicals
+    if (cp >= 0x3000 && cp <= 0x303F) return CharClass::SEPARATOR;           // CJK symbols and punctuation
+    if (cp >= 0x3040 && cp <= 0x31FF) return CharClass::CJK;                 // Kana, bopomofo, compat jamo
+    if (cp >= 0x3400 && cp <= 0x4DBF) return CharClass::CJK;                 // Extension A
+    if (cp >= 0x4E00 && cp <= 0x9FFF) return CharClass::CJK;                 // Unified ideographs
+    if (cp >= 0xAC00 && cp <= 0xD7AF) return CharClass::CJK;                 // Hangul syllables
+    if (cp >= 0xF900 && cp <= 0xFAFF) return CharClass::CJK;                 // Compatibility ideographs
+    if (cp >= 0xFE30 && cp <= 0xFE4F) return CharClass::SEPARATOR;           // CJK compatibility forms
+    if (cp >= 0xFF00 && cp <= 0xFFEF) {                                      // Half/fullwidth forms
+        if (isFullwidthAlnum(cp)) return CharClass::WORD;
+        if (cp >= 0xFF66 && cp <= 0xFFDC) return CharClass::CJK;
+        return CharClass::SEPARATOR;
+    }
+    if (cp >= 0xFFF0 && cp <= 0xFFFF) return CharClass::SEPARATOR;           // Specials
+    if (cp >= 0x1F000 && cp <= 0x1FAFF) return CharClass::SEPARATOR;         // Emoji and pictographs
+    if (cp >= 0x20000 && cp <= 0x3134F) return CharClass::CJK;               // Extensions B..G
+    if (cp == kInvalidCodePoint) return CharClass::SEPARATOR;
+    return CharClass::WORD;
+}
+
+// Lowercases ASCII and folds fullwidth letters/digits into out, which must
+// hold at least word.size() bytes. Returns the rewritten view.
+std::string_view foldWord(std::string_view word, char* out) {
+    const auto* data = reinterpret_cast<const unsigned char*>(word.data());
+    size_t written = 0;
+    for (size_t i = 0; i < word.size();) {
+        CodePoint cp = decodeUtf8(data + i, word.size() - i);
+        uint32_t ascii = cp.value < 0x80 ? cp.value : isFullwidthAlnum(cp.value) ? cp.value - 0xFEE0 : 0;
+        if (ascii != 0) {
+            if (ascii >= 'A' && ascii <= 'Z') ascii += 'a' - 'A';
+            out[written++] = static_cast<char>(ascii);
+        } else {
+            std::memcpy(out + written, data + i, cp.length);
+            written += cp.length;
+        }
+        i += cp.length;
+    }
+    return {out, written};
+}
+
+} // namespace
+
+TokenizerOptions TokenizerOptions::fromConfig(const core::Config& config) {
+    TokenizerOptions options;
+    options.cjk_bigrams = config.get<bool>("cjk_bigrams", options.cjk_bigrams);
+    options.filter_stopwords = config.get<bool>("filter_stopwords", options.filter_stopwords);
+    return options;
+}
+
+StandardTokenizer::StandardTokenizer(TokenizerOptions options)
+    : options_(std::move(options)) {
+    if (options_.stopwords.empty()) {
+        stopwords_.insert(std::begin(kDefaultStopwords), std::end(kDefaultStopwords));
+    } else {
+        stopwords_.insert(options_.stopwords.begin(), options_.stopwords.end());
+    }
+}
+
+bool StandardTokenizer::isStopword(std::string_view token) const {
+    return stopwords_.find(token) != stopwords_.end();
+}
+
+void StandardTokenizer::tokenize(std::string_view text, TokenSink sink) const {
+    const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t size = text.size();
+    char scratch[kMaxTokenBytes];
+    uint32_t position = 0;
+
+    auto emit = [&](std::string_view token) {
+        uint32_t pos = position++;
+        if (options_.filter_stopwords && isStopword(token)) return;
+        sink(Token{token, pos});
+    };
+
+    size_t i = 0;
+    while (i < size) {
+        CodePoint cp = decodeUtf8(data + i, size - i);
+        CharClass cls = classify(cp.value);
+
+        if (cls == CharClass::SEPARATOR) {
+            i += cp.length;
+            continue;
+        }
+
+        if (cls == CharClass::CJK) {
+            // Sliding window over the run: each character pairs with the next
+            size_t prev = i;
+            bool paired = false;
+            i += cp.length;
+            while (i < size) {
+                CodePoint next = decodeUtf8(data + i, size - i);
+                if (classify(next.value) != CharClass::CJK) break;
+                if (options_.cjk_bigrams) {
+                    emit(text.substr(prev, i + next.length - prev));
+                    paired = true;
+                } else {
+                    emit(text.substr(prev, i - prev));
+                }
+                prev = i;
+                i += next.length;
+            }
+            if (!paired) {
+                emit(text.substr(prev, i - prev));
+            }
+            continue;
+        }
+
+        size_t start = i;
+        bool rewrite = false;
+        while (true) {
+            rewrite |= cp.value < 0x80 ? (cp.value >= 'A' && cp.value <= 'Z') : isFullwidthAlnum(cp.value);
+            i += cp.length;
+            if (i >= size) break;
+            cp = decodeUtf8(data + i, size - i);
+            if (classify(cp.value) != CharClass::WORD) break;
+        }
+        if (i - start > kMaxTokenBytes) {
+            ++position;
+            continue;
+        }
+        std::string_view token = text.substr(start, i - start);
+        emit(rewrite ? foldWord(token, scratch) : token);
+    }
+}
+
+} // namespace memory::search
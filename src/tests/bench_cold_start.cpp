@@ -0,0 +1,155 @@
+// Cold start: time from opening saved segments to the first answered query,
+// with the page cache dropped for the files first, against rebuilding the
+// HNSW index from the raw vectors as a process without segments must. The
+// HNSW file is opened with and without prefetching its upper layers; a CSR
+// graph of the same node count is opened and its first adjacency read.
+// Usage: bench_cold_start [nodes] [dimension] [queries] [directory]
+#include "memory/graph/csr_graph.h"
+#include "memory/vector/hnsw_index.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace memory::vector;
+using memory::graph::CsrBuilder;
+using memory::graph::CsrGraph;
+using memory::graph::Direction;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millis(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Evicts the file's pages from the page cache, so the next reads go to disk
+// (POSIX only; elsewhere the runs are warm)
+void dropCache(const std::string& path) {
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
+// Low-rank clustered embeddings, as in bench_hnsw
+std::vector<float> embeddings(size_t count, size_t dimension, uint64_t seed) {
+    constexpr size_t kLatent = 32;
+    constexpr size_t kClusters = 64;
+    std::mt19937_64 layout(7);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<float> centers(kClusters * kLatent);
+    for (float& x : centers) x = gauss(layout);
+    std::vector<float> projection(kLatent * dimension);
+    for (float& x : projection) x = gauss(layout);
+
+    std::mt19937_64 rng(seed);
+    std::vector<float> data(count * dimension);
+    std::vector<float> latent(kLatent);
+    for (size_t i = 0; i < count; ++i) {
+        const float* center = centers.data() + (rng() % kClusters) * kLatent;
+        for (size_t j = 0; j < kLatent; ++j) latent[j] = center[j] + 0.5f * gauss(rng);
+        float* out = data.data() + i * dimension;
+        for (size_t d = 0; d < dimension; ++d) out[d] = 0.3f * gauss(rng);
+        for (size_t j = 0; j < kLatent; ++j) {
+            for (size_t d = 0; d < dimension; ++d) out[d] += latent[j] * projection[j * dimension + d];
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t dimension = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 128;
+    size_t queries = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100;
+    std::filesystem::path dir = argc > 4 ? std::filesystem::path(argv[4])
+                                         : std::filesystem::temp_directory_path() / "memory_bench_cold_start";
+    std::filesystem::create_directories(dir);
+    std::string hnsw_path = (dir / "vectors.hnsw").string();
+    std::string graph_path = (dir / "graph.csr").string();
+    constexpr size_t k = 10;
+
+    std::vector<float> data = embeddings(count, dimension, 1);
+    std::vector<float> probe = embeddings(queries, dimension, 2);
+    auto query = [&](size_t q) { return std::span<const float>(&probe[q * dimension], dimension); };
+    std::cout << std::fixed << std::setprecision(2);
+
+    double rebuild_ms;
+    {
+        HnswIndex index(HnswOptions{.dimension = dimension, .ef_construction = 100});
+        auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i) index.Upsert(i, std::span<const float>(&data[i * dimension], dimension));
+        rebuild_ms = millis(start);
+        start = Clock::now();
+        index.save(hnsw_path);
+        std::cout << "hnsw: " << count << " x " << dimension << ", rebuild " << rebuild_ms / 1000.0 << " s, save "
+                  << millis(start) / 1000.0 << " s, file " << std::filesystem::file_size(hnsw_path) / (1 << 20)
+                  << " MiB\n";
+    }
+    {
+        std::mt19937_64 rng(3);
+        uint32_t nodes = static_cast<uint32_t>(count);
+        CsrBuilder builder(nodes);
+        builder.reserve(count * 8);
+        for (size_t i = 0; i < count * 8; ++i) {
+            builder.add(static_cast<uint32_t>(i / 8), static_cast<uint32_t>(rng() % nodes),
+                        static_cast<memory::core::EdgeType>(rng() % memory::graph::kEdgeTypeCount), 1.0f);
+        }
+        builder.build().save(graph_path);
+        std::cout << "csr: " << count << " nodes, " << count * 8 << " edges, file "
+                  << std::filesystem::file_size(graph_path) / (1 << 20) << " MiB\n";
+    }
+    data.clear();
+    data.shrink_to_fit();
+
+    std::cout << "hnsw open          open ms  first query ms  next queries ms/query\n";
+    struct Mode {
+        const char* name;
+        HnswLoadOptions load;
+    };
+    for (Mode mode : {Mode{"mmap", HnswLoadOptions{.prefetch_upper_layers = false}},
+                      Mode{"mmap + prefetch", HnswLoadOptions{}},
+                      Mode{"mmap + verify", HnswLoadOptions{.verify = true}}}) {
+        dropCache(hnsw_path);
+        auto start = Clock::now();
+        auto index = HnswIndex::open(hnsw_path, mode.load);
+        double open_ms = millis(start);
+        auto result = index->Search(query(0), k);
+        double first_ms = millis(start);
+        start = Clock::now();
+        for (size_t q = 1; q < queries; ++q) result = index->Search(query(q), k);
+        double rest_ms = millis(start) / static_cast<double>(std::max<size_t>(queries - 1, 1));
+        std::cout << std::left << std::setw(17) << mode.name << std::right << std::setw(9) << open_ms
+                  << std::setw(16) << first_ms << std::setw(23) << rest_ms << "\n";
+    }
+    std::cout << "rebuild instead    " << std::setw(7) << rebuild_ms << "\n";
+
+    dropCache(graph_path);
+    auto start = Clock::now();
+    CsrGraph graph = CsrGraph::open(graph_path);
+    double open_ms = millis(start);
+    size_t degree = graph.edges(static_cast<uint32_t>(count / 2), Direction::OUT).size();
+    std::cout << "csr open " << open_ms << " ms, first adjacency (" << degree << " edges) " << millis(start)
+              << " ms\n";
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,181 @@
+// GraphStore load and k-hop expansion latency on a synthetic memory graph
+// (design doc §25.7): episodes in temporal chains, linked to concepts and
+// entities with a power-law in-degree, plus SIMILAR_TO edges between facts.
+// Usage: bench_graph [nodes] [edges_per_node] [threads]
+#include "memory/graph/csr_graph_store.h"
+#include "memory/graph/traversal.h"
+#include "memory/core/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace memory::graph;
+using memory::core::Edge;
+using memory::core::EdgeType;
+using memory::core::NodeId;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t per_node = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+    size_t threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+    std::mt19937_64 rng(7);
+
+    // 5% of nodes are concepts/entities, targets drawn with a Zipf-like skew
+    size_t hubs = std::max<size_t>(1, nodes / 20);
+    auto hub = [&]() {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return static_cast<NodeId>(std::pow(u, 3.0) * static_cast<double>(hubs));
+    };
+
+    GraphStoreOptions options;
+    CsrGraphStore store(options);
+    auto start = Clock::now();
+    Edge e{};
+    size_t added = 0;
+    for (NodeId n = hubs; n < nodes; ++n) {
+        e.src = n;
+        if (n + 1 < nodes && rng() % 4 != 0) {
+            e.dst = n + 1;
+            e.type = EdgeType::TEMPORAL_NEXT;
+            e.weight = 0.3f;
+            store.AddEdge(e);
+            ++added;
+        }
+        for (size_t i = 0; i < per_node; ++i) {
+            e.dst = hub();
+            e.type = rng() % 3 == 0 ? EdgeType::MENTIONS : EdgeType::ABOUT;
+            e.weight = 1.0f;
+            store.AddEdge(e);
+            ++added;
+        }
+        if (rng() % 10 == 0) {
+            e.dst = hubs + rng() % (nodes - hubs);
+            e.type = EdgeType::SIMILAR_TO;
+            e.weight = 0.5f;
+            store.AddEdge(e);
+            ++added;
+        }
+    }
+    double ingest = seconds(start);
+    start = Clock::now();
+    store.Compact();
+    double build = seconds(start);
+    std::cout << store.nodeCount() << " nodes, " << store.edgeCount() << " edges (" << added << " added)\n"
+              << std::fixed << std::setprecision(2) << "ingest " << ingest << " s, CSR build " << build
+              << " s, " << static_cast<double>(store.memoryBytes()) / (1 << 20) << " MB\n\n";
+
+    std::vector<NodeId> seeds(1000);
+    for (auto& s : seeds) s = hubs + rng() % (nodes - hubs);
+    std::vector<EdgeType> temporal = {EdgeType::TEMPORAL_NEXT, EdgeType::SIMILAR_TO};
+
+    std::cout << std::left << std::setw(28) << "expansion" << std::right << std::setw(14) << "us/seed"
+              << std::setw(14) << "avg reached\n";
+    struct Case {
+        const char* name;
+        int k;
+        size_t seeds_per_query;
+        std::span<const EdgeType> types;
+    };
+    for (const Case& c : {Case{"k=1, all types", 1, 1, {}}, Case{"k=1, temporal+similar", 1, 1, temporal},
+                          Case{"k=2, temporal+similar", 2, 1, temporal}, Case{"k=2, all types", 2, 1, {}},
+                          Case{"k=1, 200 seeds", 1, 200, {}}}) {
+        // Second pass is timed; the first pays page faults on the fresh CSR
+        constexpr size_t kQueries = 200;
+        size_t reached = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            reached = 0;
+            start = Clock::now();
+            for (size_t q = 0; q < kQueries; ++q) {
+                size_t offset = (q * 37) % (seeds.size() - c.seeds_per_query + 1);
+                std::span<const NodeId> batch(seeds.data() + offset, c.seeds_per_query);
+                reached += store.KHopSeeds(batch, c.k, c.types).size();
+            }
+        }
+        double us = seconds(start) * 1e6 / static_cast<double>(kQueries * c.seeds_per_query);
+        std::cout << std::left << std::setw(28) << c.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << us << std::setw(13) << reached / kQueries << "\n";
+    }
+
+    // Hub-heavy k=2 expansions: top-down only vs direction-optimizing, one
+    // thread vs the pool
+    {
+        auto snap = store.snapshot();
+        memory::core::ThreadPool pool(threads > 1 ? threads - 1 : 0);
+        KHopTuning top_down;
+        top_down.alpha = 1e-12;
+        KHopTuning adaptive;
+        EpochVisitedSet visited;
+        std::vector<HopIndex> out;
+        std::vector<uint32_t> dense;
+        for (size_t i = 0; i < 20; ++i) dense.push_back(*snap->nodeIndex(seeds[i]));
+
+        std::cout << "\n" << std::left << std::setw(40) << "k=2 from 20 seeds" << std::right << std::setw(14)
+                  << "ms/query" << std::setw(14) << "reached\n";
+        struct Mode {
+            const char* name;
+            const KHopTuning* tuning;
+            memory::core::ThreadPool* pool;
+        };
+        for (const Mode& mode : {Mode{"top-down, 1 thread", &top_down, nullptr},
+                                 Mode{"direction-optimizing, 1 thread", &adaptive, nullptr},
+                                 Mode{"top-down, pool", &top_down, &pool},
+                                 Mode{"direction-optimizing, pool", &adaptive, &pool}}) {
+            constexpr int kRounds = 10;
+            start = Clock::now();
+            for (int r = 0; r < kRounds; ++r) {
+                out.clear();
+                expandKHop(*snap, dense, 2, kAllEdgeTypes, visited, out, mode.pool, *mode.tuning);
+            }
+            std::cout << std::left << std::setw(40) << mode.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << seconds(start) * 1e3 / kRounds << std::setw(13) << out.size() << "\n";
+        }
+        std::cout << "(pool: " << threads << " threads)\n";
+    }
+
+    // Linker-style ingestion while a reader keeps expanding
+    std::atomic<bool> done{false};
+    std::atomic<size_t> queries{0};
+    std::thread reader([&] {
+        size_t q = 0;
+        while (!done.load()) {
+            std::span<const NodeId> seed(&seeds[q++ % seeds.size()], 1);
+            store.KHopSeeds(seed, 1);
+            ++queries;
+        }
+    });
+    size_t extra = nodes;
+    uint64_t merges = store.mergeCount();
+    start = Clock::now();
+    for (size_t i = 0; i < extra; ++i) {
+        e.src = hubs + rng() % (nodes - hubs);
+        e.dst = hub();
+        e.type = EdgeType::ABOUT;
+        e.weight = 1.0f;
+        store.AddEdge(e);
+    }
+    double elapsed = seconds(start);
+    done = true;
+    reader.join();
+    std::cout << "\nconcurrent: " << std::fixed << std::setprecision(0) << static_cast<double>(extra) / elapsed
+              << " edges/s ingested alongside " << static_cast<double>(queries.load()) / elapsed
+              << " k=1 queries/s, " << store.mergeCount() - merges << " background merges, " << store.deltaCount()
+              << " deltas pending\n";
+    return 0;
+}
@@ -0,0 +1,158 @@
+// HNSW build and query throughput against brute force on synthetic
+// clustered embeddings; recall@10 is measured against an exact scan over
+// the same data. Each encoding (float, SQ8, PQ, with and without
+// re-ranking) is built and reported in turn.
+// Usage: bench_hnsw [nodes] [dimension] [queries] [threads] [encodings]
+//   encodings: comma-separated subset of none,sq8,sq8+rerank,pq,pq+rerank
+#include "memory/vector/hnsw_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace memory::vector;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millis(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Embeddings have far fewer degrees of freedom than dimensions: points are
+// drawn around cluster centers in a small latent space and projected up,
+// plus a little isotropic noise
+std::vector<float> clustered(size_t count, size_t dimension, uint64_t seed) {
+    constexpr size_t kLatent = 48;
+    constexpr size_t kClusters = 64;
+    std::mt19937_64 layout(7);  // Shared by data and queries
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<float> centers(kClusters * kLatent);
+    for (float& x : centers) x = gauss(layout);
+    std::vector<float> projection(kLatent * dimension);
+    for (float& x : projection) x = gauss(layout);
+
+    std::mt19937_64 rng(seed);
+    std::vector<float> data(count * dimension);
+    std::vector<float> latent(kLatent);
+    for (size_t i = 0; i < count; ++i) {
+        const float* center = centers.data() + (rng() % kClusters) * kLatent;
+        for (size_t j = 0; j < kLatent; ++j) latent[j] = center[j] + 0.5f * gauss(rng);
+        float* out = data.data() + i * dimension;
+        for (size_t d = 0; d < dimension; ++d) out[d] = 0.3f * gauss(rng);
+        for (size_t j = 0; j < kLatent; ++j) {
+            const float* row = projection.data() + j * dimension;
+            for (size_t d = 0; d < dimension; ++d) out[d] += latent[j] * row[d];
+        }
+    }
+    return data;
+}
+
+void normalize(std::vector<float>& data, size_t dimension, const DistanceKernels& kernels) {
+    for (size_t offset = 0; offset < data.size(); offset += dimension) {
+        float norm = std::sqrt(kernels.dot(&data[offset], &data[offset], dimension));
+        for (size_t j = 0; j < dimension; ++j) data[offset + j] /= norm;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t dimension = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 768;
+    size_t queries = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 200;
+    size_t threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : std::thread::hardware_concurrency();
+    threads = std::max<size_t>(threads, 1);
+    // Wrapped in commas, so ",sq8," matches whole names only
+    std::string selected = "all";
+    if (argc > 5) {
+        selected.assign(1, ',');
+        selected.append(argv[5]).push_back(',');
+    }
+    constexpr size_t k = 10;
+
+    const DistanceKernels& kernels = distanceKernels();
+    std::vector<float> data = clustered(count, dimension, 1);
+    std::vector<float> probe = clustered(queries, dimension, 2);
+    // Normalized up front so the exact scan below is a plain dot product
+    normalize(data, dimension, kernels);
+    normalize(probe, dimension, kernels);
+
+    std::vector<std::set<uint64_t>> truth(queries);
+    auto exact_start = Clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+        std::vector<std::pair<float, uint64_t>> scored(count);
+        for (size_t i = 0; i < count; ++i) {
+            scored[i] = {-kernels.dot(&probe[q * dimension], &data[i * dimension], dimension), i};
+        }
+        std::partial_sort(scored.begin(), scored.begin() + k, scored.end());
+        for (size_t i = 0; i < k; ++i) truth[q].insert(scored[i].second);
+    }
+    double exact_ms = millis(exact_start) / static_cast<double>(queries);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "nodes: " << count << " x " << dimension << ", kernels: " << kernels.name
+              << ", threads: " << threads << "\n";
+    std::cout << "brute force: " << exact_ms << " ms/query (" << 1000.0 / exact_ms << " QPS)\n";
+
+    struct Encoding {
+        const char* name;
+        Quantization quantization;
+        size_t rerank;
+    };
+    const Encoding encodings[] = {{"none", Quantization::NONE, 0},
+                                  {"sq8", Quantization::SQ8, 0},
+                                  {"sq8+rerank", Quantization::SQ8, 50},
+                                  {"pq", Quantization::PQ, 0},
+                                  {"pq+rerank", Quantization::PQ, 100}};
+    for (const Encoding& encoding : encodings) {
+        std::string name = ",";
+        name += encoding.name;
+        name += ",";
+        if (selected != "all" && selected.find(name) == std::string::npos) continue;
+        HnswIndex index(HnswOptions{.dimension = dimension,
+                                    .quantization = encoding.quantization,
+                                    .rerank = encoding.rerank});
+        auto train_start = Clock::now();
+        index.train(std::span<const float>(data).first(std::min<size_t>(count, 20000) * dimension));
+        double train_ms = millis(train_start);
+
+        auto build_start = Clock::now();
+        std::vector<std::thread> builders;
+        for (size_t t = 0; t < threads; ++t) {
+            builders.emplace_back([&, t] {
+                for (size_t i = t; i < count; i += threads) {
+                    index.Upsert(i, std::span<const float>(&data[i * dimension], dimension));
+                }
+            });
+        }
+        for (auto& builder : builders) builder.join();
+        double build_ms = millis(build_start);
+
+        double mib = static_cast<double>(index.memoryBytes()) / (1 << 20);
+        std::cout << "\n[" << encoding.name << "] train: " << train_ms / 1000.0 << " s, build: " << build_ms / 1000.0
+                  << " s (" << count / (build_ms / 1000.0) << " inserts/s), index: " << mib << " MiB ("
+                  << static_cast<double>(index.memoryBytes()) / count << " B/vector)\n";
+        for (size_t ef : {10, 20, 50, 100, 200}) {
+            size_t hits = 0;
+            auto start = Clock::now();
+            for (size_t q = 0; q < queries; ++q) {
+                auto result = index.Search(std::span<const float>(&probe[q * dimension], dimension), k, ef);
+                for (const auto& r : result) hits += truth[q].count(r.id);
+            }
+            double ms = millis(start) / static_cast<double>(queries);
+            std::cout << "ef=" << std::setw(3) << ef << "  recall@10: " << std::setprecision(3)
+                      << static_cast<double>(hits) / static_cast<double>(queries * k) << std::setprecision(2)
+                      << "  " << ms << " ms/query (" << 1000.0 / ms << " QPS, " << exact_ms / ms << "x)\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Scoring pass over node records: std::vector<core::Node> against the
+// columnar NodeStore. Both compute the same importance x recency x tenant
+// filter score the ranker needs, over every node.
+// Usage: bench_node_store [nodes] [passes]
+#include "memory/core/node_store.h"
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace memory::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millis(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+constexpr double kTauMillis = 30.0 * 24 * 3600 * 1000;
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    int passes = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::mt19937_64 rng(11);
+    const int64_t now = 1750000000000LL;
+    std::vector<Node> nodes;
+    nodes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Node node;
+        node.id = i;
+        node.type = static_cast<NodeType>(rng() % 7);
+        node.title = "node " + std::to_string(i);
+        node.text = std::string(80 + rng() % 200, 'x');
+        node.keywords = {"kw" + std::to_string(rng() % 5000), "kw" + std::to_string(rng() % 5000)};
+        node.entities = {"ent" + std::to_string(rng() % 2000)};
+        node.importance = static_cast<float>(rng() % 1000) / 1000.0f;
+        node.recency = NodeStore::fromMillis(now - static_cast<int64_t>(rng() % (90LL * 24 * 3600 * 1000)));
+        node.frequency = static_cast<int>(rng() % 20);
+        node.tenant_id = "tenant" + std::to_string(rng() % 8);
+        nodes.push_back(std::move(node));
+    }
+    // Shuffle allocation order, as a long-running process would
+    std::shuffle(nodes.begin(), nodes.end(), rng);
+
+    auto build_start = Clock::now();
+    NodeStore store;
+    for (const Node& node : nodes) store.upsert(node);
+    double build_ms = millis(build_start);
+
+    const std::string tenant = "tenant3";
+    double checksum_aos = 0;
+    auto aos_start = Clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const Node& node : nodes) {
+            if (node.tenant_id != tenant) continue;
+            double age = static_cast<double>(now - NodeStore::toMillis(node.recency));
+            checksum_aos += node.importance * std::exp(-age / kTauMillis);
+        }
+    }
+    double aos_ms = millis(aos_start) / passes;
+
+    double checksum_soa = 0;
+    auto soa_start = Clock::now();
+    uint32_t tenant_ordinal = store.tenantOrdinal(tenant);
+    auto tenants = store.tenants();
+    auto importance = store.importance();
+    auto recency = store.recencyMillis();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            if (tenants[i] != tenant_ordinal) continue;
+            double age = static_cast<double>(now - recency[i]);
+            checksum_soa += importance[i] * std::exp(-age / kTauMillis);
+        }
+    }
+    double soa_ms = millis(soa_start) / passes;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "nodes: " << count << ", build: " << build_ms << " ms, store: "
+              << static_cast<double>(store.memoryBytes()) / (1 << 20) << " MiB\n";
+    std::cout << "vector<Node> scoring pass: " << aos_ms << " ms\n";
+    std::cout << "NodeStore scoring pass:    " << soa_ms << " ms (" << aos_ms / soa_ms << "x)\n";
+    std::cout << "checksums: " << checksum_aos / passes << " / " << checksum_soa / passes << "\n";
+    return 0;
+}
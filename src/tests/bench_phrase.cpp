@@ -0,0 +1,118 @@
+// Phrase and proximity query latency over synthetic support-ticket passages
+// containing error codes and file paths, against the same words as a
+// bag-of-words query.
+// Usage: bench_phrase [passages]
+#include "memory/search/inverted_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace memory::search;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kWords[] = {
+    "driver", "update", "failed", "install", "error", "access", "denied", "service", "restart", "crash",
+    "network", "adapter", "bluetooth", "audio", "device", "missing", "timeout", "disk", "full", "retry",
+    "windows", "system32", "drivers", "temp", "program", "files", "logs", "user", "profile", "registry",
+    "蓝牙", "耳机", "连接", "断开", "驱动", "更新", "失败", "重启", "异常", "网络",
+};
+
+const char* const kCodes[] = {"0x80070005", "0x80004005", "0x8007045d", "0xc000021a", "0x80070002"};
+
+const char* const kPaths[] = {
+    R"(C:\Windows\System32\drivers\bthusb.sys)",
+    R"(C:\Windows\Temp\setup.log)",
+    R"(C:\Program Files\Common Files\update.exe)",
+    R"(C:\Users\Public\logs\crash.dmp)",
+};
+
+std::string passage(std::mt19937& rng) {
+    constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+    std::string text;
+    size_t length = 20 + rng() % 40;
+    for (size_t i = 0; i < length; ++i) {
+        uint32_t pick = rng() % 100;
+        if (pick < 3) {
+            text += "error ";
+            text += kCodes[rng() % 5];
+        } else if (pick < 5) {
+            text += kPaths[rng() % 4];
+        } else {
+            text += kWords[rng() % kWordCount];
+        }
+        text += ' ';
+    }
+    return text;
+}
+
+struct Timing {
+    double mean_us;
+    double p99_us;
+    size_t hits;
+};
+
+Timing measure(const InvertedIndex& index, const std::string& query, size_t rounds) {
+    std::vector<double> samples;
+    size_t hits = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+        auto start = Clock::now();
+        hits = index.Search(query, 10).size();
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double s : samples) total += s;
+    return {total / static_cast<double>(rounds), samples[samples.size() * 99 / 100], hits};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t passages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::mt19937 rng(2024);
+
+    SearchIndexOptions options;
+    options.index_positions = true;
+    options.max_buffered_docs = 10000;
+    InvertedIndex index(options);
+    auto start = Clock::now();
+    for (uint64_t id = 0; id < passages; ++id) {
+        index.Upsert(id, passage(rng));
+    }
+    index.Flush();
+    double build = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << passages << " passages, " << index.segmentCount() << " segments, indexed in " << std::fixed
+              << std::setprecision(2) << build << " s\n\n";
+
+    const std::vector<std::string> phrases = {
+        R"("error 0x80070005")",
+        R"("C:\Windows\System32\drivers\bthusb.sys")",
+        R"("access denied")",
+        R"("access denied"~3)",
+        R"("蓝牙 耳机")",
+        R"("error 0x8007045d" driver)",
+    };
+    std::cout << std::left << std::setw(44) << "query" << std::right << std::setw(12) << "mean(us)"
+              << std::setw(12) << "p99(us)" << std::setw(8) << "hits" << std::setw(14) << "bag mean(us)"
+              << std::setw(10) << "bag hits\n";
+    for (const auto& query : phrases) {
+        std::string bag = query;
+        bag.erase(std::remove(bag.begin(), bag.end(), '"'), bag.end());
+        if (auto slop = bag.find('~'); slop != std::string::npos) bag.erase(slop, 2);
+
+        Timing phrase = measure(index, query, 200);
+        Timing words = measure(index, bag, 200);
+        std::cout << std::left << std::setw(44) << query << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << phrase.mean_us << std::setw(12) << phrase.p99_us << std::setw(8)
+                  << phrase.hits << std::setw(14) << words.mean_us << std::setw(9) << words.hits << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Micro-benchmark for the postings kernels: block decode (unpack + prefix
+// sum), intersection and union throughput per available SIMD level.
+// Usage: bench_postings [lists_per_run]
+#include "memory/search/postings.h"
+#include "memory/search/simd_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace memory::search;
+using memory::core::SimdLevel;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::vector<uint32_t> sortedList(std::mt19937& rng, size_t count, uint32_t universe) {
+    std::vector<uint32_t> values(count);
+    for (auto& v : values) v = static_cast<uint32_t>(rng() % universe);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t blocks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    std::mt19937 rng(12345);
+
+    // Packed blocks of doc gaps at typical widths
+    std::vector<uint32_t> widths = {4, 8, 12, 20};
+    std::vector<std::vector<uint8_t>> packed;
+    for (uint32_t bits : widths) {
+        std::vector<uint8_t> bytes((packedBlockBytes(bits) + 2) * 256 + kPostingPadding);
+        for (size_t b = 0; b < 256; ++b) {
+            uint32_t values[kPostingBlockSize];
+            for (auto& v : values) v = static_cast<uint32_t>(rng()) >> (32 - bits);
+            packBlock(values, bits, bytes.data() + b * packedBlockBytes(bits));
+        }
+        packed.push_back(std::move(bytes));
+    }
+
+    auto dense_a = sortedList(rng, 200000, 1000000);
+    auto dense_b = sortedList(rng, 200000, 1000000);
+    auto sparse = sortedList(rng, 2000, 1000000);
+    std::vector<uint32_t> out(dense_a.size() + dense_b.size() + kKernelOutputSlack);
+
+    std::cout << "kernel   bits  decode(M ints/s)\n";
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2}) {
+        const PostingKernels* kernels = postingKernels(level);
+        if (!kernels) {
+            std::cout << std::left << std::setw(9) << memory::core::simdLevelToString(level)
+                      << "unsupported on this CPU\n";
+            continue;
+        }
+        uint32_t decoded[kPostingBlockSize];
+        for (size_t w = 0; w < widths.size(); ++w) {
+            uint32_t bits = widths[w];
+            uint64_t sink = 0;
+            auto start = Clock::now();
+            for (size_t i = 0; i < blocks; ++i) {
+                kernels->unpack(packed[w].data() + (i % 256) * packedBlockBytes(bits), bits, decoded);
+                kernels->prefix_sum(decoded, static_cast<uint32_t>(i));
+                sink += decoded[kPostingBlockSize - 1];
+            }
+            double rate = static_cast<double>(blocks * kPostingBlockSize) / seconds(start) / 1e6;
+            std::cout << std::left << std::setw(9) << kernels->name << std::setw(6) << bits
+                      << std::fixed << std::setprecision(1) << rate
+                      << (sink == 42 ? " " : "") << "\n";
+        }
+
+        size_t rounds = std::max<size_t>(1, blocks / 1000);
+        size_t found = 0;
+        auto start = Clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            found += kernels->intersect(dense_a.data(), dense_a.size(), dense_b.data(), dense_b.size(), out.data());
+        }
+        double dense = static_cast<double>(rounds * (dense_a.size() + dense_b.size())) / seconds(start) / 1e6;
+
+        start = Clock::now();
+        for (size_t r = 0; r < rounds * 10; ++r) {
+            found += kernels->intersect(sparse.data(), sparse.size(), dense_a.data(), dense_a.size(), out.data());
+        }
+        double gallop = static_cast<double>(rounds * 10 * sparse.size()) / seconds(start) / 1e6;
+
+        start = Clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            found += kernels->merge_union(dense_a.data(), dense_a.size(), dense_b.data(), dense_b.size(), out.data());
+        }
+        double merged = static_cast<double>(rounds * (dense_a.size() + dense_b.size())) / seconds(start) / 1e6;
+
+        std::cout << std::left << std::setw(9) << kernels->name << std::fixed << std::setprecision(1)
+                  << "intersect(similar) " << dense << " M in/s, intersect(1:100 gallop) " << gallop
+                  << " M probes/s, union " << merged << " M in/s" << (found == 42 ? " " : "") << "\n";
+    }
+    std::cout << "dispatched: " << postingKernels().name << "\n";
+    return 0;
+}
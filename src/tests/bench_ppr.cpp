@@ -0,0 +1,152 @@
+// Forward-push PPR against power iteration on a synthetic memory graph
+// (same shape as bench_graph): latency, L1 error and top-k precision per
+// epsilon, with power iteration at graph.ppr_iterations as the reference.
+// Usage: bench_ppr [nodes] [queries] [seeds_per_query]
+#include "memory/graph/csr_graph_store.h"
+#include "memory/graph/ppr.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace memory::graph;
+using memory::core::Edge;
+using memory::core::EdgeType;
+using memory::core::NodeId;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millis(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double l1Distance(const std::vector<PprScore>& a, const std::vector<PprScore>& b) {
+    std::unordered_map<uint32_t, double> right;
+    for (const PprScore& s : b) right.emplace(s.node, s.score);
+    double distance = 0;
+    for (const PprScore& s : a) {
+        auto it = right.find(s.node);
+        if (it == right.end()) {
+            distance += s.score;
+        } else {
+            distance += std::fabs(s.score - it->second);
+            right.erase(it);
+        }
+    }
+    for (const auto& [node, score] : right) distance += score;
+    return distance;
+}
+
+double precisionAt(const std::vector<PprScore>& result, const std::vector<PprScore>& reference, size_t k) {
+    std::unordered_set<uint32_t> truth;
+    for (size_t i = 0; i < std::min(k, reference.size()); ++i) truth.insert(reference[i].node);
+    size_t hits = 0;
+    for (size_t i = 0; i < std::min(k, result.size()); ++i) hits += truth.count(result[i].node);
+    return truth.empty() ? 1.0 : static_cast<double>(hits) / static_cast<double>(truth.size());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t queries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+    size_t seeds_per_query = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10;
+    constexpr size_t kTopK = 50;
+    std::mt19937_64 rng(7);
+
+    size_t hubs = std::max<size_t>(1, nodes / 20);
+    auto hub = [&]() {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return static_cast<NodeId>(std::pow(u, 3.0) * static_cast<double>(hubs));
+    };
+
+    GraphStoreOptions options;
+    options.background_merge = false;
+    CsrGraphStore store(options);
+    Edge e{};
+    for (NodeId n = hubs; n < nodes; ++n) {
+        e.src = n;
+        if (n + 1 < nodes && rng() % 4 != 0) {
+            e.dst = n + 1;
+            e.type = EdgeType::TEMPORAL_NEXT;
+            e.weight = 1.0f;
+            store.AddEdge(e);
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            e.dst = hub();
+            e.type = rng() % 3 == 0 ? EdgeType::MENTIONS : EdgeType::ABOUT;
+            e.weight = 1.0f;
+            store.AddEdge(e);
+        }
+        if (rng() % 10 == 0) {
+            e.dst = hubs + rng() % (nodes - hubs);
+            e.type = EdgeType::SIMILAR_TO;
+            e.weight = 1.0f;
+            store.AddEdge(e);
+        }
+    }
+    store.Compact();
+    auto snap = store.snapshot();
+    std::cout << snap->nodeCount() << " nodes, " << snap->edgeCount() << " edges, " << queries << " queries x "
+              << seeds_per_query << " episode seeds, top-" << kTopK << "\n";
+
+    // Seeds are episodes, as first-stage retrieval would return
+    std::vector<std::vector<uint32_t>> seed_sets(queries);
+    for (auto& seeds : seed_sets) {
+        for (size_t i = 0; i < seeds_per_query; ++i) {
+            seeds.push_back(*snap->nodeIndex(hubs + rng() % (nodes - hubs)));
+        }
+    }
+
+    PprOptions reference_options;
+    std::vector<std::vector<PprScore>> references;
+    double power_ms = 0;
+    for (const auto& seeds : seed_sets) {
+        auto start = Clock::now();
+        references.push_back(powerIterationPpr(*snap, seeds, {}, reference_options));
+        power_ms += millis(start);
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "power iteration (" << reference_options.max_iterations
+              << " iterations): " << power_ms / static_cast<double>(queries) << " ms/query\n\n";
+
+    std::cout << std::setw(10) << "epsilon" << std::setw(12) << "ms/query" << std::setw(12) << "pushes"
+              << std::setw(12) << "touched" << std::setw(12) << "L1 error" << std::setw(10) << "P@10"
+              << std::setw(10) << "P@" << kTopK << "\n";
+    for (double epsilon : {1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7}) {
+        PprOptions push_options;
+        push_options.epsilon = epsilon;
+        double ms = 0;
+        double error = 0;
+        double p10 = 0;
+        double pk = 0;
+        uint64_t pushes = 0;
+        size_t touched = 0;
+        for (size_t q = 0; q < queries; ++q) {
+            PprStats stats;
+            auto start = Clock::now();
+            auto result = forwardPushPpr(*snap, seed_sets[q], {}, push_options, &stats);
+            ms += millis(start);
+            pushes += stats.pushes;
+            touched += stats.touched;
+            error += l1Distance(result, references[q]);
+            p10 += precisionAt(result, references[q], 10);
+            pk += precisionAt(result, references[q], kTopK);
+        }
+        auto n = static_cast<double>(queries);
+        std::cout << std::setw(10) << std::scientific << std::setprecision(0) << epsilon << std::fixed
+                  << std::setprecision(3) << std::setw(12) << ms / n << std::setw(12)
+                  << static_cast<uint64_t>(static_cast<double>(pushes) / n) << std::setw(12)
+                  << static_cast<size_t>(static_cast<double>(touched) / n) << std::setw(12) << error / n
+                  << std::setw(10) << p10 / n << std::setw(10 + (kTopK >= 10)) << pk / n << "\n";
+    }
+    return 0;
+}
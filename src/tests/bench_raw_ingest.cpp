@@ -0,0 +1,137 @@
+// Raw chunk ingest: SHA-256 throughput of each implementation, LZ block
+// compression, then RawStore bulk ingest in MB/s on 1 and 4 threads and
+// the latency of raw_refs range reads.
+// Usage: bench_raw_ingest [chunks] [chunk KB] [directory]
+#include "memory/core/block_codec.h"
+#include "memory/core/raw_store.h"
+#include "memory/core/sha256.h"
+#include "memory/core/thread_pool.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace memory::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double megabytes(size_t bytes) {
+    return static_cast<double>(bytes) / (1 << 20);
+}
+
+// Conversation-log-like text, so compression sees realistic input
+std::vector<uint8_t> makeChunk(size_t size, uint32_t seed) {
+    static const char* kWords[] = {"用户", "助手", "会议", "蓝牙耳机", "周五", "下午", "预算", "项目",
+                                   "the",  "meeting", "notes", "deadline", "review", "budget", "Q3", "ok"};
+    std::mt19937 rng(seed);
+    std::string text;
+    text.reserve(size + 16);
+    while (text.size() < size) {
+        if (rng() % 9 == 0) text += "\n[" + std::to_string(rng() % 100000) + "] ";
+        text += kWords[rng() % 16];
+        text += ' ';
+    }
+    text.resize(size);
+    return {text.begin(), text.end()};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t chunks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    size_t chunk_bytes = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64) << 10;
+    std::filesystem::path root = argc > 3 ? std::filesystem::path(argv[3])
+                                          : std::filesystem::temp_directory_path() / "memory_bench_raw";
+    std::vector<std::vector<uint8_t>> data;
+    for (size_t i = 0; i < chunks; ++i) data.push_back(makeChunk(chunk_bytes, static_cast<uint32_t>(i)));
+    std::vector<std::span<const uint8_t>> contents(data.begin(), data.end());
+    size_t total = chunks * chunk_bytes;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "chunks: " << chunks << " x " << (chunk_bytes >> 10) << " KB (" << megabytes(total)
+              << " MB), directory: " << root.string() << "\n\n";
+
+    std::cout << "SHA-256            MB/s\n";
+    for (Sha256Impl impl : {Sha256Impl::SCALAR, Sha256Impl::SHA_NI}) {
+        if (!sha256Supported(impl)) continue;
+        auto start = Clock::now();
+        volatile uint8_t sink = 0;
+        for (const auto& chunk : contents) sink = sink ^ Sha256(impl).update(chunk).finish()[0];
+        double seconds = secondsSince(start);
+        std::cout << std::left << std::setw(15) << (impl == Sha256Impl::SHA_NI ? "sha-ni" : "scalar") << std::right
+                  << std::setw(9) << megabytes(total) / seconds << "\n";
+    }
+
+    // One 64 KB block at a time, as the store does
+    std::vector<uint8_t> compressed;
+    std::vector<size_t> sizes;
+    auto start = Clock::now();
+    for (const auto& chunk : contents) {
+        sizes.push_back(lzCompress(chunk.first(std::min<size_t>(chunk.size(), 65536)), compressed));
+    }
+    double compress_seconds = secondsSince(start);
+    size_t block_total = 0;
+    for (const auto& chunk : contents) block_total += std::min<size_t>(chunk.size(), 65536);
+    std::vector<uint8_t> out(65536);
+    start = Clock::now();
+    size_t position = 0;
+    for (size_t i = 0; i < contents.size(); ++i) {
+        size_t block = std::min<size_t>(contents[i].size(), 65536);
+        lzDecompress({compressed.data() + position, sizes[i]}, {out.data(), block});
+        position += sizes[i];
+    }
+    double decompress_seconds = secondsSince(start);
+    std::cout << "\nLZ blocks: compress " << megabytes(block_total) / compress_seconds << " MB/s, decompress "
+              << megabytes(block_total) / decompress_seconds << " MB/s, ratio " << std::setprecision(3)
+              << static_cast<double>(compressed.size()) / static_cast<double>(block_total) << std::setprecision(1)
+              << "\n";
+
+    std::cout << "\nRawStore ingest     threads    MB/s   hash s  compress s  write s   stored/in\n";
+    for (size_t threads : {0, 3}) {
+        std::filesystem::remove_all(root);
+        RawStoreOptions options;
+        options.directory = root.string();
+        RawStore store(options, threads ? std::make_shared<ThreadPool>(threads) : nullptr);
+        RawIngestStats stats;
+        store.ingest("bench", contents, std::chrono::system_clock::now(), &stats);
+        std::cout << std::left << std::setw(20) << "  bulk, synced" << std::right << std::setw(7) << threads + 1
+                  << std::setw(9) << stats.mbPerSecond() << std::setprecision(3) << std::setw(9)
+                  << stats.hash_seconds << std::setw(12) << stats.compress_seconds << std::setw(9)
+                  << stats.write_seconds << std::setw(12) << stats.compressionRatio() << std::setprecision(1)
+                  << "\n";
+    }
+
+    // Random 2 KB raw_refs reads into the last store
+    RawStoreOptions options;
+    options.directory = root.string();
+    RawStore store(options);
+    std::vector<Sha256Digest> ids;
+    for (const auto& chunk : contents) ids.push_back(sha256(chunk));
+    std::mt19937 rng(7);
+    size_t reads = 20000;
+    size_t range = 2048;
+    start = Clock::now();
+    size_t bytes_read = 0;
+    for (size_t i = 0; i < reads; ++i) {
+        size_t pick = rng() % contents.size();
+        RawRef ref{ids[pick], rng() % contents[pick].size(), range};
+        bytes_read += store.read("bench", ref).size();
+    }
+    double read_seconds = secondsSince(start);
+    std::cout << "\nRange reads of " << range << " B: " << std::setprecision(2)
+              << read_seconds / static_cast<double>(reads) * 1e6 << " us each (" << bytes_read / reads
+              << " B on average)\n";
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Final re-ranking of recall candidates: per-node map accumulation with a
+// full sort (the old path) against the column-wise combiner of every
+// compiled-in kernel with partial top-k selection.
+// Usage: bench_rerank [candidates] [rounds] [topk]
+#include "memory/pipeline/score_combiner.h"
+#include "memory/core/top_k.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace memory::pipeline;
+using memory::core::NodeId;
+using memory::core::NodeType;
+using memory::core::ScoredId;
+using memory::core::SimdLevel;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millis(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// One score per node through a hash map, node weight per candidate, then
+// sort everything
+std::vector<ScoredId> mapAndSort(const CandidateColumns& c, const ScoreWeights& w, size_t k) {
+    std::unordered_map<NodeId, float> scores;
+    for (size_t i = 0; i < c.size(); ++i) scores[c.ids[i]] += w.bm25 * c.bm25[i];
+    for (size_t i = 0; i < c.size(); ++i) scores[c.ids[i]] += w.vector * c.cosine[i];
+    for (size_t i = 0; i < c.size(); ++i) scores[c.ids[i]] += w.graph * c.graph[i];
+    for (size_t i = 0; i < c.size(); ++i) {
+        scores[c.ids[i]] += w.node * nodeWeight(w, static_cast<NodeType>(c.types[i]), c.importance[i],
+                                                c.frequency[i], c.age_days[i]);
+    }
+    std::vector<ScoredId> results;
+    results.reserve(scores.size());
+    for (const auto& [id, score] : scores) results.push_back({id, score});
+    std::sort(results.begin(), results.end());
+    if (results.size() > k) results.resize(k);
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t candidates = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+    size_t topk = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 20;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    CandidateColumns columns;
+    columns.reserve(candidates);
+    for (size_t i = 0; i < candidates; ++i) {
+        size_t at = columns.add(static_cast<NodeId>(rng()));
+        columns.bm25[at] = unit(rng) < 0.3f ? unit(rng) : 0.0f;
+        columns.cosine[at] = unit(rng) < 0.3f ? unit(rng) : 0.0f;
+        columns.graph[at] = unit(rng);
+        columns.types[at] = static_cast<uint8_t>(rng() % 7);
+        columns.importance[at] = unit(rng);
+        columns.frequency[at] = static_cast<float>(rng() % 200);
+        columns.age_days[at] = unit(rng) * 365.0f;
+    }
+    ScoreWeights weights;
+    std::cout << candidates << " candidates, top-" << topk << ", " << rounds << " rounds\n";
+    std::cout << std::fixed << std::setprecision(3);
+
+    auto start = Clock::now();
+    std::vector<ScoredId> reference;
+    for (size_t r = 0; r < rounds; ++r) reference = mapAndSort(columns, weights, topk);
+    std::cout << std::setw(24) << "map + full sort" << std::setw(12) << millis(start) / static_cast<double>(rounds)
+              << " ms\n";
+
+    std::vector<float> scores(candidates);
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2}) {
+        const ScoreKernels* kernels = scoreKernels(level);
+        if (!kernels) continue;
+        double combine_ms = 0;
+        double select_ms = 0;
+        std::vector<ScoredId> results;
+        for (size_t r = 0; r < rounds; ++r) {
+            start = Clock::now();
+            kernels->combine(columns, weights, scores.data());
+            combine_ms += millis(start);
+            start = Clock::now();
+            results = selectTopK(columns.ids, scores, topk);
+            select_ms += millis(start);
+        }
+        size_t agree = 0;
+        for (size_t i = 0; i < std::min(results.size(), reference.size()); ++i) {
+            agree += results[i].id == reference[i].id;
+        }
+        std::string label = kernels->name;
+        label += " + top-k";
+        std::cout << std::setw(24) << label << std::setw(12)
+                  << (combine_ms + select_ms) / static_cast<double>(rounds) << " ms  (combine "
+                  << combine_ms / static_cast<double>(rounds) << ", select " << select_ms / static_cast<double>(rounds)
+                  << "), " << agree << "/" << reference.size() << " ranks agree\n";
+    }
+    return 0;
+}
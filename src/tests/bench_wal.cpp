@@ -0,0 +1,97 @@
+// Write-ahead log ingest: acknowledged records per second from 1..16
+// concurrent writers with group commit, with one sync per record, and
+// without syncing, then the same through InvertedIndex upserts.
+// Usage: bench_wal [records] [payload bytes] [directory]
+#include "memory/core/wal.h"
+#include "memory/search/inverted_index.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace memory::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Mode {
+    const char* name;
+    WalOptions options;
+};
+
+const Mode kModes[] = {
+    {"group commit", WalOptions{.sync = true, .group_commit = true}},
+    {"sync per record", WalOptions{.sync = true, .group_commit = false}},
+    {"no sync", WalOptions{.sync = false, .group_commit = true}},
+};
+
+// Runs writers threads that together call write(i) for i in [0, total);
+// returns seconds
+template <typename Write>
+double runWriters(size_t threads, size_t total, const Write& write) {
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = t; i < total; i += threads) write(i);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t payload_bytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+    std::filesystem::path root = argc > 3 ? std::filesystem::path(argv[3])
+                                          : std::filesystem::temp_directory_path() / "memory_bench_wal";
+    std::vector<uint8_t> payload(payload_bytes, 0x5A);
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "records: " << records << " x " << payload_bytes << " B, directory: " << root.string() << "\n";
+    std::cout << "mode              writers   records/s   records/sync\n";
+    for (const Mode& mode : kModes) {
+        for (size_t threads : {1, 4, 16}) {
+            std::filesystem::remove_all(root);
+            WriteAheadLog wal(root.string(), mode.options);
+            // Syncing every record is slow; a tenth of the records is enough
+            size_t total = mode.options.sync && !mode.options.group_commit ? std::max<size_t>(records / 10, 1)
+                                                                           : records;
+            double seconds = runWriters(threads, total, [&](size_t) { wal.write(WalStream::SEARCH, 1, payload); });
+            WalStats stats = wal.stats();
+            std::cout << std::left << std::setw(18) << mode.name << std::right << std::setw(7) << threads
+                      << std::setw(12) << static_cast<double>(total) / seconds << std::setw(15)
+                      << std::setprecision(1)
+                      << (stats.syncs ? static_cast<double>(stats.records) / static_cast<double>(stats.syncs) : 0.0)
+                      << std::setprecision(0) << "\n";
+        }
+    }
+
+    // Short documents through the search engine, logged before they apply
+    std::cout << "\nInvertedIndex upserts, 16 writers\n";
+    std::vector<std::string> docs;
+    for (size_t i = 0; i < records; ++i) {
+        std::string doc = "会议 记录 蓝牙 耳机 term";
+        doc += std::to_string(i % 997);
+        docs.push_back(std::move(doc));
+    }
+    for (const Mode& mode : kModes) {
+        std::filesystem::remove_all(root);
+        auto wal = std::make_shared<WriteAheadLog>(root.string(), mode.options);
+        memory::search::InvertedIndex index;
+        index.attachWal(wal);
+        size_t total = mode.options.sync && !mode.options.group_commit ? std::max<size_t>(records / 10, 1) : records;
+        double seconds = runWriters(16, total, [&](size_t i) { index.Upsert(i, docs[i]); });
+        std::cout << std::left << std::setw(18) << mode.name << std::right << std::setw(12)
+                  << static_cast<double>(total) / seconds << " docs/s\n";
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "memory/core/cache.h"
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using memory::core::CacheStats;
+using memory::core::FrequencySketch;
+using memory::core::ShardedCache;
+
+namespace {
+
+using Cache = ShardedCache<uint64_t, uint64_t>;
+
+std::shared_ptr<const uint64_t> value(uint64_t v) {
+    return std::make_shared<const uint64_t>(v);
+}
+
+// Inserts key on a miss, like a read-through user of the cache
+bool read(Cache& cache, uint64_t key, size_t charge = 100) {
+    if (cache.find(key)) return true;
+    cache.insert(key, value(key), charge);
+    return false;
+}
+
+} // namespace
+
+TEST(FrequencySketchTest, CountsAndAges) {
+    FrequencySketch sketch(64);
+    for (int i = 0; i < 5; ++i) sketch.increment(42);
+    EXPECT_EQ(sketch.frequency(42), 5u);
+    EXPECT_EQ(sketch.frequency(43), 0u);
+    for (int i = 0; i < 100; ++i) sketch.increment(7);
+    EXPECT_EQ(sketch.frequency(7), 15u);  // Saturates
+
+    // 10 x width increments halve everything
+    for (uint64_t i = 0; i < 640; ++i) sketch.increment(1000 + i);
+    EXPECT_LE(sketch.frequency(7), 7u);
+}
+
+TEST(ShardedCacheTest, StaysWithinBudget) {
+    Cache cache(10000, 1);
+    for (uint64_t key = 0; key < 1000; ++key) read(cache, key);
+    CacheStats stats = cache.stats();
+    EXPECT_LE(stats.bytes, 10000u);
+    EXPECT_EQ(stats.bytes, stats.entries * 100);
+    EXPECT_GT(stats.evicted + stats.rejected, 0u);
+    EXPECT_EQ(stats.misses, 1000u);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_DOUBLE_EQ(stats.hitRate(), 0.0);
+
+    // Replacing an entry recharges it
+    cache.insert(999, value(1), 50);
+    EXPECT_EQ(*cache.find(999), 1u);
+    EXPECT_EQ(cache.stats().bytes, stats.bytes - 50);
+    cache.erase(999);
+    EXPECT_EQ(cache.find(999), nullptr);
+}
+
+TEST(ShardedCacheTest, ScanDoesNotFlushHotSet) {
+    Cache cache(100 * 100, 1, 100);  // Room for 100 entries
+    // Hot set of 50 keys, read repeatedly
+    for (int round = 0; round < 4; ++round) {
+        for (uint64_t key = 0; key < 50; ++key) read(cache, key);
+    }
+    // One pass over 5000 keys that are never read again
+    for (uint64_t key = 1000; key < 6000; ++key) read(cache, key);
+
+    // The last hot key may still sit in the window when the scan starts;
+    // the rest made it to the protected area
+    size_t resident = 0;
+    for (uint64_t key = 0; key < 50; ++key) resident += cache.find(key) != nullptr;
+    EXPECT_GE(resident, 49u);
+    EXPECT_GT(cache.stats().rejected, cache.stats().admitted);
+}
+
+TEST(ShardedCacheTest, FrequentNewcomersGetAdmitted) {
+    Cache cache(100 * 100, 1, 100);
+    for (uint64_t key = 0; key < 100; ++key) read(cache, key);
+    // A new working set read often enough displaces the old one
+    for (int round = 0; round < 6; ++round) {
+        for (uint64_t key = 500; key < 550; ++key) read(cache, key);
+    }
+    size_t resident = 0;
+    for (uint64_t key = 500; key < 550; ++key) resident += cache.find(key) != nullptr;
+    EXPECT_GE(resident, 45u);
+}
+
+TEST(ShardedCacheTest, PinnedEntriesSurviveEviction) {
+    Cache cache(100 * 100, 1);
+    cache.pin(1);
+    cache.insert(1, value(1), 100);
+    cache.insert(2, value(2), 100);
+    cache.pin(2);  // Pinning a resident entry
+    EXPECT_TRUE(cache.pinned(1));
+    for (int round = 0; round < 3; ++round) {
+        for (uint64_t key = 100; key < 400; ++key) read(cache, key);
+    }
+    EXPECT_NE(cache.find(1), nullptr);
+    EXPECT_NE(cache.find(2), nullptr);
+    EXPECT_EQ(cache.stats().pinned_bytes, 200u);
+
+    // Pins outlive clear(); the next insert is pinned again
+    cache.clear();
+    EXPECT_EQ(cache.stats().entries, 0u);
+    cache.insert(1, value(1), 100);
+    EXPECT_EQ(cache.stats().pinned_bytes, 100u);
+
+    // Pinned bytes over budget squeeze out everything else
+    for (uint64_t key = 1000; key < 1200; ++key) {
+        cache.pin(key);
+        cache.insert(key, value(key), 100);
+    }
+    CacheStats stats = cache.stats();
+    EXPECT_EQ(stats.entries, 201u);
+    EXPECT_EQ(stats.bytes, stats.pinned_bytes);
+
+    // Unpinned entries become evictable again
+    for (uint64_t key = 1000; key < 1200; ++key) cache.unpin(key);
+    cache.unpin(1);
+    EXPECT_FALSE(cache.pinned(1));
+    EXPECT_LE(cache.stats().bytes, 100u * 100u);
+    EXPECT_EQ(cache.stats().pinned_bytes, 0u);
+}
+
+TEST(ShardedCacheTest, HitRate) {
+    Cache cache(1 << 20);
+    for (int round = 0; round < 10; ++round) {
+        for (uint64_t key = 0; key < 100; ++key) read(cache, key);
+    }
+    CacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 1000u);
+    EXPECT_NEAR(stats.hitRate(), 0.9, 1e-9);
+    EXPECT_EQ(cache.capacityBytes(), size_t{1} << 20);
+}
+
+TEST(ShardedCacheTest, ConcurrentReaders) {
+    Cache cache(64 * 100, 8);
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t] {
+            for (uint64_t i = 0; i < 20000; ++i) {
+                uint64_t key = (i * 7 + t) % 200;
+                if (auto v = cache.find(key)) {
+                    EXPECT_EQ(*v, key);
+                } else {
+                    cache.insert(key, value(key), 100);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    CacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 80000u);
+    EXPECT_LE(stats.bytes, 64u * 100u);
+}
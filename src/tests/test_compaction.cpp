@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include "memory/core/compaction.h"
+#include "memory/core/config.h"
+#include "memory/graph/csr_graph_store.h"
+#include "memory/search/inverted_index.h"
+#include "memory/vector/hnsw_index.h"
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace memory::core;
+
+namespace {
+
+Edge edge(NodeId src, NodeId dst, EdgeType type) {
+    Edge e{};
+    e.src = src;
+    e.dst = dst;
+    e.type = type;
+    return e;
+}
+
+// Reports a fixed fragmentation until compacted, reading bytes_read
+// through the limiter on the way
+class FakeTarget : public ICompactable {
+public:
+    FakeTarget(std::string name, double fragmentation, size_t bytes_read = 0)
+        : name_(std::move(name)), fragmentation_(fragmentation), bytes_read_(bytes_read) {}
+
+    std::string compactionName() const override { return name_; }
+    double fragmentation() const override { return fragmentation_; }
+    bool compactionDue(const CompactionOptions& options) const override {
+        return fragmentation_ > options.fragmentation_threshold;
+    }
+    CompactionResult compact(const CompactionOptions&, RateLimiter& limiter) override {
+        limiter.acquire(bytes_read_);
+        CompactionResult result;
+        result.bytes_before = 1000;
+        result.bytes_after = 600;
+        result.fragmentation_before = fragmentation_;
+        fragmentation_ = 0.0;
+        ++runs;
+        return result;
+    }
+
+    int runs = 0;
+
+private:
+    std::string name_;
+    double fragmentation_;
+    size_t bytes_read_;
+};
+
+// Always due, always throws from compact()
+class FailingTarget : public ICompactable {
+public:
+    std::string compactionName() const override { return "failing"; }
+    double fragmentation() const override { return 0.9; }
+    bool compactionDue(const CompactionOptions&) const override { return true; }
+    CompactionResult compact(const CompactionOptions&, RateLimiter&) override {
+        throw std::runtime_error("disk full");
+    }
+};
+
+} // namespace
+
+TEST(RateLimiterTest, ThrottlesToRate) {
+    RateLimiter unlimited;
+    unlimited.acquire(size_t{1} << 40);
+    EXPECT_EQ(unlimited.throttled().count(), 0);
+
+    // A second's burst passes at once; the next 200 ms worth waits for it
+    RateLimiter limiter(1 << 20);
+    auto start = std::chrono::steady_clock::now();
+    limiter.acquire(1 << 20);
+    limiter.acquire(200 << 10);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+    EXPECT_GE(limiter.throttled(), std::chrono::milliseconds(150));
+}
+
+TEST(CompactorTest, CompactsDueTargetsAndKeepsMetrics) {
+    FakeTarget fragmented("fragmented", 0.4);
+    FakeTarget clean("clean", 0.1);
+    Compactor compactor;
+    compactor.add(fragmented);
+    compactor.add(clean);
+    compactor.add(fragmented);
+
+    auto results = compactor.runOnce();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].target, "fragmented");
+    EXPECT_DOUBLE_EQ(results[0].bytesRatio(), 0.6);
+    EXPECT_TRUE(compactor.runOnce().empty());
+    EXPECT_EQ(fragmented.runs, 1);
+    EXPECT_EQ(clean.runs, 0);
+
+    CompactionMetrics metrics = compactor.metrics();
+    EXPECT_EQ(metrics.runs, 1u);
+    EXPECT_DOUBLE_EQ(metrics.compactionRatio(), 0.6);
+    ASSERT_EQ(metrics.fragmentation.size(), 2u);
+    EXPECT_EQ(metrics.fragmentation[0].first, "fragmented");
+    EXPECT_EQ(metrics.fragmentation[0].second, 0.0);
+    EXPECT_EQ(metrics.fragmentation[1].second, 0.1);
+    EXPECT_EQ(compactor.history().size(), 1u);
+
+    compactor.remove(fragmented);
+    compactor.remove(clean);
+    EXPECT_TRUE(compactor.runOnce().empty());
+}
+
+TEST(CompactorTest, FailingTargetDoesNotAbortThePass) {
+    FakeTarget first("first", 0.4);
+    FailingTarget failing;
+    FakeTarget last("last", 0.4);
+    Compactor compactor;
+    compactor.add(first);
+    compactor.add(failing);
+    compactor.add(last);
+
+    auto results = compactor.runOnce();
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_TRUE(results[0].error.empty());
+    EXPECT_EQ(results[1].target, "failing");
+    EXPECT_EQ(results[1].error, "disk full");
+    EXPECT_TRUE(results[2].error.empty());
+    EXPECT_EQ(first.runs, 1);
+    EXPECT_EQ(last.runs, 1);
+
+    CompactionMetrics metrics = compactor.metrics();
+    EXPECT_EQ(metrics.runs, 2u);
+    EXPECT_EQ(metrics.failures, 1u);
+    EXPECT_DOUBLE_EQ(metrics.compactionRatio(), 0.6);
+    ASSERT_EQ(metrics.fragmentation.size(), 3u);
+    EXPECT_EQ(metrics.fragmentation[0].second, 0.0);
+    EXPECT_EQ(metrics.fragmentation[1].second, 0.9);
+    EXPECT_EQ(metrics.fragmentation[2].second, 0.0);
+    EXPECT_EQ(compactor.history().size(), 3u);
+
+    // The failing target keeps being retried without holding up the others
+    results = compactor.runOnce();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_FALSE(results[0].error.empty());
+    EXPECT_EQ(compactor.metrics().failures, 2u);
+}
+
+TEST(CompactorTest, BackgroundThreadIsRateLimited) {
+    CompactionOptions options;
+    options.rate_bytes = 1 << 20;
+    options.interval = std::chrono::milliseconds(5);
+    Compactor compactor(options);
+    FakeTarget first("first", 0.5, 1 << 20);
+    FakeTarget second("second", 0.5, 300 << 10);
+    compactor.add(first);
+    compactor.add(second);
+    compactor.start();
+    for (int i = 0; i < 400 && compactor.metrics().runs < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    compactor.stop();
+    EXPECT_EQ(compactor.metrics().runs, 2u);
+    EXPECT_GE(compactor.metrics().throttled_seconds, 0.2);
+}
+
+TEST(CompactionTest, OptionsFromConfig) {
+    auto& config = Config::getInstance();
+    config.set("compaction_threshold", "0.4");
+    config.set("compaction_rate_mb", "0");
+    config.set("compaction_interval_ms", "250");
+    config.set("merge_factor", "6");
+    CompactionOptions options = CompactionOptions::fromConfig(config);
+    EXPECT_DOUBLE_EQ(options.fragmentation_threshold, 0.4);
+    EXPECT_EQ(options.rate_bytes, 0.0);
+    EXPECT_EQ(options.interval, std::chrono::milliseconds(250));
+    EXPECT_EQ(options.merge_factor, 6u);
+}
+
+TEST(CompactionTest, GraphDeltasMergeOnceFragmented) {
+    memory::graph::GraphStoreOptions graph_options;
+    graph_options.background_merge = false;
+    graph_options.max_delta_segments = 100;
+    memory::graph::CsrGraphStore graph(graph_options);
+    for (NodeId id = 1; id <= 100; ++id) graph.AddEdge(edge(0, id, EdgeType::MENTIONS));
+    graph.Compact();
+    EXPECT_EQ(graph.fragmentation(), 0.0);
+
+    CompactionOptions options;
+    for (NodeId id = 1; id <= 40; ++id) graph.RemoveEdge(0, id, EdgeType::MENTIONS);
+    graph.Flush();
+    EXPECT_NEAR(graph.fragmentation(), 40.0 / 140.0, 1e-9);
+    ASSERT_TRUE(graph.compactionDue(options));
+
+    Compactor compactor(options);
+    compactor.add(graph);
+    auto results = compactor.runOnce();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].target, "graph");
+    EXPECT_EQ(results[0].items_before, 140u);
+    EXPECT_EQ(results[0].items_after, 60u);
+    EXPECT_LT(results[0].bytes_after, results[0].bytes_before);
+    EXPECT_EQ(graph.deltaCount(), 0u);
+    NodeId hub = 0;
+    EXPECT_EQ(graph.KHopSeeds(std::span(&hub, 1), 1).size(), 61u);
+}
+
+TEST(CompactionTest, OneCompactorServesEveryEngine) {
+    memory::search::SearchIndexOptions search_options;
+    search_options.max_buffered_docs = 10;
+    memory::search::InvertedIndex search(search_options);
+    memory::graph::GraphStoreOptions graph_options;
+    graph_options.background_merge = false;
+    memory::graph::CsrGraphStore graph(graph_options);
+    memory::vector::HnswIndex vectors(memory::vector::HnswOptions{.dimension = 8, .m = 8});
+
+    std::mt19937 rng(5);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    for (NodeId id = 1; id <= 100; ++id) {
+        search.Upsert(id, "记录 " + std::to_string(id));
+        graph.AddEdge(edge(id, id + 1, EdgeType::TEMPORAL_NEXT));
+        std::vector<float> v(8);
+        for (float& x : v) x = dist(rng);
+        vectors.Upsert(id, v);
+    }
+    graph.Compact();
+    for (NodeId id = 1; id <= 100; id += 2) {
+        search.Remove(id);
+        graph.RemoveEdge(id, id + 1, EdgeType::TEMPORAL_NEXT);
+        vectors.Remove(id);
+    }
+    graph.Flush();
+
+    CompactionOptions options;
+    options.interval = std::chrono::milliseconds(5);
+    Compactor compactor(options);
+    compactor.add(search);
+    compactor.add(graph);
+    compactor.add(vectors);
+    compactor.start();
+    for (int i = 0; i < 400 && compactor.metrics().runs < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    compactor.stop();
+
+    CompactionMetrics metrics = compactor.metrics();
+    EXPECT_EQ(metrics.runs, 3u);
+    ASSERT_EQ(metrics.fragmentation.size(), 3u);
+    for (const auto& [name, fragmentation] : metrics.fragmentation) {
+        EXPECT_EQ(fragmentation, 0.0) << name;
+    }
+    EXPECT_LT(metrics.compactionRatio(), 1.0);
+    EXPECT_EQ(search.MatchAny("记录").size(), 50u);
+    EXPECT_EQ(search.segmentCount(), 1u);
+}
@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include "memory/graph/concept_layer.h"
+#include "memory/graph/csr_graph_store.h"
+#include <map>
+#include <random>
+#include <set>
+#include <tuple>
+
+using namespace memory::graph;
+using memory::core::Edge;
+using memory::core::EdgeType;
+using memory::core::NodeId;
+using memory::core::NodeType;
+
+namespace {
+
+Edge edge(NodeId src, NodeId dst, EdgeType type, float weight = 1.0f) {
+    Edge e{};
+    e.src = src;
+    e.dst = dst;
+    e.type = type;
+    e.weight = weight;
+    return e;
+}
+
+GraphStoreOptions manualMerge() {
+    GraphStoreOptions options;
+    options.background_merge = false;
+    options.max_delta_segments = 3;
+    return options;
+}
+
+// (from, to, type) -> (weight, count), with external IDs
+using Aggregates = std::map<std::tuple<NodeId, NodeId, int>, std::pair<double, uint32_t>>;
+
+Aggregates layerAggregates(const GraphSnapshot& snap, std::map<NodeId, std::set<NodeId>>* members = nullptr) {
+    Aggregates result;
+    if (!snap.concepts()) return result;
+    for (const auto& super : snap.concepts()->superNodes()) {
+        NodeId from = snap.nodeId(super->node);
+        for (const ConceptEdge& e : super->out) {
+            result[{from, snap.nodeId(e.node), e.type}] = {e.weight, e.count};
+        }
+        if (members) {
+            auto& set = (*members)[from];
+            for (uint32_t m : super->members) set.insert(snap.nodeId(m));
+        }
+    }
+    return result;
+}
+
+const SuperNode* superNode(const CsrGraphStore& store, NodeId node) {
+    auto snap = store.snapshot();
+    auto index = snap->nodeIndex(node);
+    return index && snap->concepts() ? snap->concepts()->find(*index) : nullptr;
+}
+
+} // namespace
+
+TEST(ConceptLayerTest, AggregatesRelationsBetweenGroups) {
+    CsrGraphStore store(manualMerge());
+    store.SetNodeType(100, NodeType::CONCEPT);
+    store.SetNodeType(200, NodeType::CONCEPT);
+    store.SetNodeType(300, NodeType::ENTITY);
+    store.AddEdge(edge(1, 100, EdgeType::ABOUT));
+    store.AddEdge(edge(2, 100, EdgeType::ABOUT));
+    store.AddEdge(edge(3, 200, EdgeType::ABOUT));
+    store.AddEdge(edge(3, 300, EdgeType::MENTIONS));
+    store.AddEdge(edge(1, 3, EdgeType::SUPPORTS, 0.8f));
+    store.AddEdge(edge(2, 3, EdgeType::SUPPORTS, 0.5f));
+    store.AddEdge(edge(3, 2, EdgeType::CAUSED_BY, 0.4f));  // 2 CAUSES 3
+    store.AddEdge(edge(1, 2, EdgeType::CONTRADICTS));     // Same group: ignored
+    store.AddEdge(edge(1, 3, EdgeType::TEMPORAL_NEXT));   // Not a relation
+    store.Flush();
+
+    auto snap = store.snapshot();
+    ASSERT_NE(snap->concepts(), nullptr);
+    EXPECT_EQ(snap->concepts()->superNodeCount(), 3u);
+    std::map<NodeId, std::set<NodeId>> members;
+    Aggregates agg = layerAggregates(*snap, &members);
+    int supports = static_cast<int>(EdgeType::SUPPORTS);
+    int causes = static_cast<int>(EdgeType::CAUSES);
+    ASSERT_EQ(agg.size(), 4u);
+    EXPECT_NEAR(agg.at({100, 200, supports}).first, 1.3, 1e-6);
+    EXPECT_EQ(agg.at({100, 200, supports}).second, 2u);
+    EXPECT_EQ(agg.at({100, 300, supports}).second, 2u);
+    EXPECT_NEAR(agg.at({100, 200, causes}).first, 0.4, 1e-6);
+    EXPECT_EQ(agg.at({100, 300, causes}).second, 1u);
+    EXPECT_EQ(members[100], (std::set<NodeId>{1, 2}));
+    EXPECT_EQ(members[300], (std::set<NodeId>{3}));
+    EXPECT_EQ(snap->concepts()->edgeCount(), 4u);
+    EXPECT_EQ(snap->concepts()->memberCount(), 4u);
+
+    // Removing an edge takes its weight back out; emptied edges disappear
+    store.RemoveEdge(1, 3, EdgeType::SUPPORTS);
+    store.RemoveEdge(3, 2, EdgeType::CAUSED_BY);
+    store.Flush();
+    agg = layerAggregates(*store.snapshot());
+    ASSERT_EQ(agg.size(), 2u);
+    EXPECT_NEAR(agg.at({100, 200, supports}).first, 0.5, 1e-6);
+
+    // Super-node edges stay put across merges and untouched versions share
+    // the same super-node objects
+    const SuperNode* before = superNode(store, 300);
+    store.Compact();
+    EXPECT_EQ(superNode(store, 300), before);
+    EXPECT_EQ(layerAggregates(*store.snapshot()), agg);
+}
+
+TEST(ConceptLayerTest, TypingANodeLaterRegroupsItsMembers) {
+    CsrGraphStore store(manualMerge());
+    store.AddEdge(edge(1, 100, EdgeType::ABOUT));
+    store.AddEdge(edge(2, 200, EdgeType::ABOUT));
+    store.AddEdge(edge(1, 2, EdgeType::SUPPORTS, 0.7f));
+    store.Flush();
+    EXPECT_EQ(store.snapshot()->concepts(), nullptr);
+
+    store.SetNodeType(100, NodeType::CONCEPT);
+    store.Flush();
+    // 100 has no related group yet
+    EXPECT_TRUE(layerAggregates(*store.snapshot()).empty());
+    ASSERT_NE(superNode(store, 100), nullptr);
+    EXPECT_EQ(superNode(store, 100)->members, std::vector<uint32_t>{*store.nodeIndex(1)});
+
+    store.SetNodeType(200, NodeType::TASK);
+    store.Flush();
+    Aggregates agg = layerAggregates(*store.snapshot());
+    ASSERT_EQ(agg.size(), 1u);
+    EXPECT_NEAR(agg.begin()->second.first, 0.7, 1e-6);
+    EXPECT_EQ(superNode(store, 200)->type, NodeType::TASK);
+
+    // Demoting a super-node drops it and its relations
+    store.SetNodeType(200, NodeType::EPISODE);
+    store.Flush();
+    EXPECT_EQ(superNode(store, 200), nullptr);
+    EXPECT_TRUE(layerAggregates(*store.snapshot()).empty());
+}
+
+TEST(ConceptLayerTest, IncrementalMatchesRebuild) {
+    std::mt19937 rng(5);
+    GraphStoreOptions options = manualMerge();
+    options.caps.max_degree.fill(3);  // Pruning must not change the layer
+    CsrGraphStore store(options);
+    constexpr NodeId kNodes = 300;
+    std::map<NodeId, NodeType> types;
+    const EdgeType kTypes[] = {EdgeType::ABOUT, EdgeType::MENTIONS, EdgeType::SUPPORTS, EdgeType::CONTRADICTS,
+                               EdgeType::CAUSES, EdgeType::CAUSED_BY, EdgeType::TEMPORAL_NEXT};
+    std::map<std::tuple<NodeId, NodeId, int>, float> model;
+
+    for (int round = 0; round < 12; ++round) {
+        for (int i = 0; i < 400; ++i) {
+            NodeId src = rng() % kNodes;
+            NodeId dst = rng() % kNodes;
+            EdgeType type = kTypes[rng() % 7];
+            if (rng() % 6 == 0) {
+                store.RemoveEdge(src, dst, type);
+                model.erase({src, dst, static_cast<int>(type)});
+            } else {
+                float weight = 0.1f * static_cast<float>(1 + rng() % 10);
+                store.AddEdge(edge(src, dst, type, weight));
+                model[{src, dst, static_cast<int>(type)}] = weight;
+            }
+        }
+        for (int i = 0; i < 8; ++i) {
+            NodeId node = rng() % kNodes;
+            NodeType type = rng() % 4 == 0 ? NodeType::FACT : rng() % 2 ? NodeType::CONCEPT : NodeType::ENTITY;
+            store.SetNodeType(node, type);
+            types[node] = type;
+        }
+        store.Flush();
+
+        // Rebuild the layer from the model
+        auto isSuper = [&](NodeId n) {
+            auto it = types.find(n);
+            return it != types.end() && isSuperNodeType(it->second);
+        };
+        std::map<NodeId, std::set<NodeId>> groups;
+        std::map<NodeId, std::set<NodeId>> expected_members;
+        for (NodeId n = 0; n < kNodes; ++n) {
+            if (isSuper(n)) groups[n] = {n};
+        }
+        for (const auto& [key, weight] : model) {
+            auto [src, dst, type] = key;
+            bool membership = type == static_cast<int>(EdgeType::ABOUT) || type == static_cast<int>(EdgeType::MENTIONS);
+            if (membership && !isSuper(src) && isSuper(dst)) {
+                groups[src].insert(dst);
+                expected_members[dst].insert(src);
+            }
+        }
+        Aggregates expected;
+        for (const auto& [key, weight] : model) {
+            auto [src, dst, type] = key;
+            if (type == static_cast<int>(EdgeType::CAUSED_BY)) {
+                std::swap(src, dst);
+                type = static_cast<int>(EdgeType::CAUSES);
+            }
+            bool relation = type == static_cast<int>(EdgeType::SUPPORTS) ||
+                            type == static_cast<int>(EdgeType::CONTRADICTS) || type == static_cast<int>(EdgeType::CAUSES);
+            if (!relation) continue;
+            for (NodeId a : groups[src]) {
+                for (NodeId b : groups[dst]) {
+                    if (a == b) continue;
+                    auto& agg = expected[{a, b, type}];
+                    agg.first += weight;
+                    agg.second += 1;
+                }
+            }
+        }
+
+        std::map<NodeId, std::set<NodeId>> members;
+        Aggregates actual = layerAggregates(*store.snapshot(), &members);
+        ASSERT_EQ(actual.size(), expected.size()) << "round " << round;
+        for (const auto& [key, value] : expected) {
+            auto it = actual.find(key);
+            ASSERT_NE(it, actual.end()) << "round " << round;
+            EXPECT_NEAR(it->second.first, value.first, 1e-4);
+            EXPECT_EQ(it->second.second, value.second);
+        }
+        for (const auto& [super, set] : expected_members) {
+            EXPECT_EQ(members[super], set) << "round " << round << " super " << super;
+        }
+    }
+    EXPECT_GT(store.mergeCount(), 0u);
+}
+
+TEST(ConceptLayerTest, ExpandSeedsRoutesThroughL2) {
+    CsrGraphStore store(manualMerge());
+    // A chain of concepts C0 -> C1 -> ... -> C5 related through SUPPORTS
+    // between their episodes; each concept also has 50 episodes of its own
+    constexpr NodeId kConcepts = 6;
+    for (NodeId c = 0; c < kConcepts; ++c) {
+        store.SetNodeType(1000 + c, NodeType::CONCEPT);
+        for (NodeId e = 0; e < 50; ++e) {
+            store.AddEdge(edge(c * 100 + e, 1000 + c, EdgeType::ABOUT));
+            if (e > 0) store.AddEdge(edge(c * 100 + e - 1, c * 100 + e, EdgeType::TEMPORAL_NEXT));
+        }
+        if (c + 1 < kConcepts) store.AddEdge(edge(c * 100, (c + 1) * 100, EdgeType::SUPPORTS));
+    }
+    store.Flush();
+
+    memory::core::RecallQuery query;
+    query.k_hop = 3;
+    std::vector<NodeId> seeds = {7};  // An episode of C0
+    auto l1 = store.ExpandSeeds(seeds, query);
+    EXPECT_EQ(l1.size(), store.KHopSeeds(seeds, 3).size());
+
+    query.options["use_l2"] = "true";
+    ConceptRouteStats stats;
+    auto l2 = store.ExpandSeeds(seeds, query, {}, &stats);
+    std::map<NodeId, uint32_t> hops;
+    for (const HopNode& h : l2) hops[h.node] = h.hops;
+    EXPECT_EQ(hops.at(7), 0u);
+    EXPECT_EQ(hops.at(1000), 1u);  // Located
+    EXPECT_EQ(hops.at(1001), 2u);  // Related concept
+    EXPECT_EQ(hops.at(1002), 3u);
+    EXPECT_FALSE(hops.count(1003));
+    EXPECT_EQ(hops.at(25), 2u);    // Member of C0
+    EXPECT_EQ(hops.at(125), 3u);   // Member of C1
+    EXPECT_FALSE(hops.count(225));
+    EXPECT_EQ(stats.super_nodes, 2u);
+    EXPECT_LT(stats.l1_edges, 200u);
+
+    // Relation filter: CONTRADICTS only, so no related concepts
+    std::vector<EdgeType> contradicts = {EdgeType::CONTRADICTS};
+    auto filtered = store.ExpandSeeds(seeds, query, contradicts);
+    for (const HopNode& h : filtered) EXPECT_NE(h.node, 1001u);
+
+    // Without super-nodes the option falls back to L1
+    CsrGraphStore plain(manualMerge());
+    plain.AddEdge(edge(1, 2, EdgeType::ABOUT));
+    plain.Flush();
+    std::vector<NodeId> one = {1};
+    EXPECT_EQ(plain.ExpandSeeds(one, query).size(), 2u);
+}
@@ -71,4 +71,13 @@ TEST_F(ConfigTest, LoadFromFile) {
 
     EXPECT_EQ(config_->get<std::string>("database_url"), "sqlite://test.db");
     EXPECT_EQ(config_->get<std::string>("log_level"), "DEBUG");
-}
\ No newline at end of file
+}
+
+TEST_F(ConfigTest, GetFloatValue) {
+    config_->set("float_key", "0.75");
+    config_->set("bad_float_key", "abc");
+
+    EXPECT_FLOAT_EQ(config_->get<float>("float_key"), 0.75f);
+    EXPECT_DOUBLE_EQ(config_->get<double>("float_key"), 0.75);
+    EXPECT_FLOAT_EQ(config_->get<float>("bad_float_key", 1.2f), 1.2f);
+}
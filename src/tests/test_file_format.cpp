@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include "memory/core/crc32.h"
+#include "memory/core/errors.h"
+#include "memory/core/file_format.h"
+#include "memory/core/mapped_file.h"
+#include "memory/core/section_file.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace memory::core;
+
+TEST(Crc32cTest, KnownValuesAndChaining) {
+    std::string check = "123456789";
+    EXPECT_EQ(crc32c(check.data(), check.size()), 0xE3069283u);
+    EXPECT_EQ(crc32c(nullptr, 0), 0u);
+
+    std::vector<uint8_t> data(1000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i * 31 + 7);
+    uint32_t whole = crc32c(data);
+    for (size_t split : {0u, 1u, 7u, 8u, 333u, 999u}) {
+        uint32_t chained = crc32c(data.data() + split, data.size() - split, crc32c(data.data(), split));
+        EXPECT_EQ(chained, whole) << "split=" << split;
+    }
+}
+
+TEST(FileFormatTest, HeaderRoundTripAndCorruption) {
+    constexpr uint32_t kMagic = makeMagic('T', 'E', 'S', 'T');
+    std::vector<uint8_t> file = {0xAA};  // Header need not start at offset 0 of the buffer
+    size_t offset = beginFileHeader(file);
+    for (int i = 0; i < 100; ++i) file.push_back(static_cast<uint8_t>(i));
+    sealFileHeader(file, offset, kMagic, 3);
+
+    std::span<const uint8_t> image(file.data() + offset, file.size() - offset);
+    FileHeader header;
+    auto payload = checkFileHeader(image, kMagic, 3, "test", &header);
+    EXPECT_EQ(payload.size(), 100u);
+    EXPECT_EQ(payload[42], 42);
+    EXPECT_EQ(header.version, 3);
+
+    EXPECT_THROW(checkFileHeader(image, kMagic, 4, "test"), StorageException);
+    EXPECT_THROW(checkFileHeader(image, makeMagic('N', 'O', 'P', 'E'), 3, "test"), StorageException);
+    EXPECT_THROW(checkFileHeader(image.first(image.size() - 1), kMagic, 3, "test"), StorageException);
+    EXPECT_THROW(checkFileHeader(image.first(10), kMagic, 3, "test"), StorageException);
+
+    file[offset + sizeof(FileHeader) + 5] ^= 0x01;
+    EXPECT_THROW(checkFileHeader(image, kMagic, 3, "test"), StorageException);
+    file[offset + sizeof(FileHeader) + 5] ^= 0x01;
+    file[offset + 4] ^= 0x01;  // Version byte, caught by the header checksum
+    EXPECT_THROW(checkFileHeader(image, kMagic, 3, "test"), StorageException);
+}
+
+TEST(MappedFileTest, WriteAtomicallyAndMap) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_mapped_file";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "data.bin").string();
+
+    std::vector<uint8_t> bytes(10000);
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<uint8_t>(i);
+    writeFileAtomically(path, bytes);
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    MappedFile file = MappedFile::open(path);
+    ASSERT_EQ(file.size(), bytes.size());
+    EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), file.data()));
+
+    MappedFile moved = std::move(file);
+    EXPECT_FALSE(file.isOpen());
+    EXPECT_EQ(moved.bytes()[9999], static_cast<uint8_t>(9999));
+
+    writeFileAtomically(path, {});
+    EXPECT_EQ(MappedFile::open(path).size(), 0u);
+    EXPECT_THROW(MappedFile::open((dir / "missing.bin").string()), StorageException);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MappedFileTest, PrivateMappingAndAbandonedWriter) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_private_map";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "data.bin").string();
+    std::vector<uint8_t> bytes(8192, 7);
+    writeFileAtomically(path, bytes);
+
+    // Writes to a private mapping stay in memory
+    {
+        MappedFile file = MappedFile::open(path, MapMode::PRIVATE);
+        ASSERT_NE(file.mutableData(), nullptr);
+        file.mutableData()[100] = 42;
+        EXPECT_EQ(file.data()[100], 42);
+        file.advise(0, file.size(), Access::WILLNEED);
+        EXPECT_EQ(MappedFile::open(path).data()[100], 7);
+    }
+    EXPECT_EQ(MappedFile::open(path).mutableData(), nullptr);
+
+    // An uncommitted writer leaves the old file alone
+    {
+        AtomicFileWriter writer(path);
+        writer.append(std::vector<uint8_t>(10, 1));
+        writer.writeAt(2, std::vector<uint8_t>(1, 9));
+        EXPECT_EQ(writer.size(), 10u);
+        EXPECT_TRUE(std::filesystem::exists(writer.tmpPath()));
+    }
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+    EXPECT_EQ(MappedFile::open(path).size(), 8192u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SectionFileTest, RoundTripAlignmentAndDamage) {
+    constexpr uint32_t kMagic = makeMagic('S', 'E', 'C', 'T');
+    constexpr uint32_t kFloats = makeMagic('F', 'L', 'T', 'S');
+    constexpr uint32_t kBytes = makeMagic('B', 'Y', 'T', 'S');
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_section_file";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "sections.bin").string();
+
+    std::vector<float> floats(3000);
+    for (size_t i = 0; i < floats.size(); ++i) floats[i] = static_cast<float>(i) * 0.5f;
+    {
+        SectionFileWriter writer(path, kMagic, 2, 5);
+        writer.begin(kBytes);
+        writer.append("abc", 3);
+        writer.begin(kFloats);
+        writer.append(std::span<const float>(floats));
+        writer.appendZeros(2 * sizeof(float));
+        writer.commit();
+    }
+
+    SectionFile file = SectionFile::open(path, kMagic, 2, "test", MapMode::PRIVATE);
+    file.verify();
+    EXPECT_EQ(file.flags(), 5);
+    EXPECT_EQ(file.section(kBytes).size(), 3u);
+    auto values = file.array<float>(kFloats);
+    ASSERT_EQ(values.size(), floats.size() + 2);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(values.data()) % kSectionAlign, 0u);
+    EXPECT_EQ(values[2999], 1499.5f);
+    EXPECT_EQ(values[3001], 0.0f);
+    EXPECT_FALSE(file.has(makeMagic('N', 'O', 'N', 'E')));
+    EXPECT_THROW(file.section(makeMagic('N', 'O', 'N', 'E')), StorageException);
+    EXPECT_THROW(file.array<double>(kBytes), StorageException);
+    file.mutableArray<float>(kFloats)[0] = 9.0f;
+    EXPECT_EQ(file.array<float>(kFloats)[0], 9.0f);
+    EXPECT_THROW(SectionFile::open(path, kMagic, 2, "test").mutableArray<float>(kFloats), StorageException);
+    EXPECT_THROW(SectionFile::open(path, kMagic, 3, "test"), StorageException);
+
+    // A flipped payload byte passes open() but not verify(); a flipped
+    // directory byte fails open()
+    MappedFile original = MappedFile::open(path);
+    std::vector<uint8_t> image(original.data(), original.data() + original.size());
+    std::string damaged = (dir / "damaged.bin").string();
+    image[image.size() - 1] ^= 0x01;
+    writeFileAtomically(damaged, image);
+    SectionFile opened = SectionFile::open(damaged, kMagic, 2, "test");
+    EXPECT_THROW(opened.verify(), StorageException);
+    image[image.size() - 1] ^= 0x01;
+    image[sizeof(FileHeader) + 12] ^= 0x01;
+    writeFileAtomically(damaged, image);
+    EXPECT_THROW(SectionFile::open(damaged, kMagic, 2, "test"), StorageException);
+    image.resize(image.size() - 1);
+    writeFileAtomically(damaged, image);
+    EXPECT_THROW(SectionFile::open(damaged, kMagic, 2, "test"), StorageException);
+    std::filesystem::remove_all(dir);
+}
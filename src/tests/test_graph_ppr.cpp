@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "memory/graph/csr_graph_store.h"
+#include "memory/graph/ppr.h"
+#include "memory/core/config.h"
+#include <cmath>
+#include <random>
+#include <unordered_map>
+
+using namespace memory::graph;
+using memory::core::Edge;
+using memory::core::EdgeType;
+using memory::core::NodeId;
+
+namespace {
+
+std::unordered_map<uint32_t, double> toMap(const std::vector<PprScore>& scores) {
+    std::unordered_map<uint32_t, double> map;
+    for (const PprScore& s : scores) {
+        EXPECT_TRUE(map.emplace(s.node, s.score).second) << "duplicate node " << s.node;
+    }
+    return map;
+}
+
+double l1Distance(const std::vector<PprScore>& a, const std::vector<PprScore>& b) {
+    auto left = toMap(a);
+    auto right = toMap(b);
+    double distance = 0;
+    for (const auto& [node, score] : left) {
+        auto it = right.find(node);
+        distance += std::fabs(score - (it == right.end() ? 0.0 : it->second));
+    }
+    for (const auto& [node, score] : right) {
+        if (!left.count(node)) distance += score;
+    }
+    return distance;
+}
+
+double totalMass(const std::vector<PprScore>& scores) {
+    double total = 0;
+    for (const PprScore& s : scores) total += s.score;
+    return total;
+}
+
+void addEdge(CsrGraphStore& store, NodeId src, NodeId dst, EdgeType type, float weight = 1.0f) {
+    Edge e{};
+    e.src = src;
+    e.dst = dst;
+    e.type = type;
+    e.weight = weight;
+    store.AddEdge(e);
+}
+
+void buildGraph(CsrGraphStore& store, uint32_t nodes, uint32_t edges, uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (uint32_t i = 0; i < edges; ++i) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        addEdge(store, rng() % nodes, static_cast<NodeId>(u * u * nodes), static_cast<EdgeType>(rng() % 13),
+                0.5f + static_cast<float>(rng() % 100) / 100.0f);
+    }
+}
+
+GraphStoreOptions manualMerge() {
+    GraphStoreOptions options;
+    options.background_merge = false;
+    options.max_delta_segments = 100;
+    return options;
+}
+
+} // namespace
+
+TEST(PprTest, ForwardPushConvergesToPowerIteration) {
+    CsrGraphStore store(manualMerge());
+    buildGraph(store, 3000, 12000, 1);
+    store.Compact();
+    // Leave some changes in deltas so the merged view is exercised too
+    buildGraph(store, 3200, 1000, 2);
+    store.RemoveEdge(0, 0, EdgeType::ABOUT);
+    store.Flush();
+    auto snap = store.snapshot();
+    ASSERT_GT(snap->deltas().size(), 0u);
+
+    std::vector<uint32_t> seeds = {*snap->nodeIndex(5), *snap->nodeIndex(17), *snap->nodeIndex(250)};
+    PprOptions reference_options;
+    reference_options.max_iterations = 500;
+    reference_options.tolerance = 1e-12;
+    PprStats power_stats;
+    auto reference = powerIterationPpr(*snap, seeds, {}, reference_options, &power_stats);
+    EXPECT_LT(power_stats.iterations, 500u);
+    EXPECT_NEAR(totalMass(reference), 1.0, 1e-4);
+
+    double previous_error = 2.0;
+    uint64_t previous_pushes = 0;
+    for (double epsilon : {1e-3, 1e-5, 1e-7}) {
+        PprOptions options;
+        options.epsilon = epsilon;
+        PprStats stats;
+        auto push = forwardPushPpr(*snap, seeds, {}, options, &stats);
+        double error = l1Distance(push, reference);
+        // Settled plus unsettled mass is conserved, and the error is bounded
+        // by the unsettled mass
+        EXPECT_NEAR(totalMass(push) + stats.residual_mass, 1.0, 1e-4) << "epsilon " << epsilon;
+        EXPECT_LE(error, stats.residual_mass + 1e-4) << "epsilon " << epsilon;
+        EXPECT_LE(error, previous_error + 1e-6);
+        EXPECT_GE(stats.pushes, previous_pushes);
+        previous_error = error;
+        previous_pushes = stats.pushes;
+    }
+    EXPECT_LT(previous_error, 1e-3);
+}
+
+TEST(PprTest, TopKAgreesWithPowerIteration) {
+    CsrGraphStore store(manualMerge());
+    buildGraph(store, 5000, 20000, 3);
+    store.Compact();
+    auto snap = store.snapshot();
+    std::vector<uint32_t> seeds = {*snap->nodeIndex(42)};
+
+    auto reference = powerIterationPpr(*snap, seeds, {}, PprOptions{});
+    PprOptions options;
+    options.epsilon = 1e-6;
+    auto push = forwardPushPpr(*snap, seeds, {}, options);
+    ASSERT_GE(push.size(), 10u);
+    auto reference_top = toMap(std::vector<PprScore>(reference.begin(), reference.begin() + 10));
+    size_t hits = 0;
+    for (size_t i = 0; i < 10; ++i) hits += reference_top.count(push[i].node);
+    EXPECT_GE(hits, 9u);
+    EXPECT_EQ(push[0].node, seeds[0]);
+}
+
+TEST(PprTest, TypeWeightsSteerTheWalk) {
+    CsrGraphStore store(manualMerge());
+    addEdge(store, 1, 2, EdgeType::ABOUT);
+    addEdge(store, 1, 3, EdgeType::TEMPORAL_NEXT);
+    addEdge(store, 1, 4, EdgeType::CONTRADICTS);
+    store.Flush();
+    auto snap = store.snapshot();
+    std::vector<uint32_t> seeds = {*snap->nodeIndex(1)};
+
+    PprOptions options;
+    options.epsilon = 1e-8;
+    auto scores = toMap(forwardPushPpr(*snap, seeds, {}, options));
+    double about = scores[*snap->nodeIndex(2)];
+    double temporal = scores[*snap->nodeIndex(3)];
+    EXPECT_GT(about, temporal);
+    EXPECT_NEAR(about / temporal, 1.0 / 0.3, 1e-3);
+
+    // A zero weight keeps the walk off that type entirely
+    options.type_weights[static_cast<size_t>(EdgeType::CONTRADICTS)] = 0.0f;
+    scores = toMap(forwardPushPpr(*snap, seeds, {}, options));
+    EXPECT_EQ(scores.count(*snap->nodeIndex(4)), 0u);
+    EXPECT_NEAR(scores[*snap->nodeIndex(2)] + scores[*snap->nodeIndex(3)] + scores[seeds[0]], 1.0, 1e-6);
+}
+
+TEST(PprTest, DanglingSeedKeepsAllMass) {
+    CsrGraphStore store(manualMerge());
+    addEdge(store, 1, 2, EdgeType::ABOUT);
+    addEdge(store, 3, 4, EdgeType::ABOUT);
+    store.RemoveEdge(3, 4, EdgeType::ABOUT);
+    store.Flush();
+    auto snap = store.snapshot();
+    std::vector<uint32_t> seeds = {*snap->nodeIndex(3)};
+
+    auto push = forwardPushPpr(*snap, seeds, {}, PprOptions{});
+    ASSERT_EQ(push.size(), 1u);
+    EXPECT_EQ(push[0].node, seeds[0]);
+    EXPECT_NEAR(push[0].score, 1.0, 1e-3);  // Up to epsilon stays unsettled
+    auto power = powerIterationPpr(*snap, seeds, {}, PprOptions{});
+    ASSERT_EQ(power.size(), 1u);
+    EXPECT_NEAR(power[0].score, 1.0, 1e-6);
+}
+
+TEST(PprTest, StoreReturnsExternalIdsAndHonorsSeedWeights) {
+    CsrGraphStore store(manualMerge());
+    // Two separate chains hanging off seeds 100 and 200
+    addEdge(store, 100, 101, EdgeType::ABOUT);
+    addEdge(store, 101, 102, EdgeType::ABOUT);
+    addEdge(store, 200, 201, EdgeType::ABOUT);
+    addEdge(store, 201, 202, EdgeType::ABOUT);
+    store.Flush();
+
+    std::vector<NodeId> seeds = {100, 200, 999};
+    auto top = store.PersonalizedPageRank(seeds, 3);
+    ASSERT_EQ(top.size(), 3u);
+    for (size_t i = 1; i < top.size(); ++i) EXPECT_GE(top[i - 1].score, top[i].score);
+
+    std::vector<float> weights = {0.9f, 0.1f, 1.0f};
+    auto all = store.PersonalizedPageRank(seeds, 10, weights);
+    ASSERT_EQ(all.size(), 6u);
+    std::unordered_map<NodeId, float> scores;
+    for (const auto& s : all) scores[s.id] = s.score;
+    EXPECT_GT(scores[100], scores[200]);
+    EXPECT_GT(scores[101], scores[201]);
+    EXPECT_GT(scores[100] + scores[101] + scores[102], 0.8f);
+
+    std::vector<NodeId> unknown = {999};
+    EXPECT_TRUE(store.PersonalizedPageRank(unknown, 10).empty());
+}
+
+TEST(PprTest, DegenerateOptionsStillTerminate) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("ppr_alpha", "0");
+    config.set("ppr_epsilon", "0");
+    PprOptions options = PprOptions::fromConfig(config);
+    EXPECT_GT(options.alpha, 0.0f);
+    EXPECT_LE(options.alpha, 1.0f);
+    EXPECT_GT(options.epsilon, 0.0);
+    config.set("ppr_alpha", "1.5");
+    EXPECT_FLOAT_EQ(PprOptions::fromConfig(config).alpha, 1.0f);
+    config.set("ppr_alpha", "0.15");
+    config.set("ppr_epsilon", "0.0001");
+
+    GraphStoreOptions store_options = manualMerge();
+    store_options.ppr.alpha = 0.0f;
+    store_options.ppr.epsilon = 0.0;
+    CsrGraphStore store(store_options);
+    addEdge(store, 1, 2, EdgeType::ABOUT);
+    store.Flush();
+
+    std::vector<NodeId> seeds = {1};
+    auto top = store.PersonalizedPageRank(seeds, 5);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_NEAR(top[0].score + top[1].score, 1.0, 1e-3);
+}
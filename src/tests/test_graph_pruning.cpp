@@ -0,0 +1,338 @@
+#include <gtest/gtest.h>
+#include "memory/graph/csr_graph_store.h"
+#include "memory/graph/degree_caps.h"
+#include "memory/core/config.h"
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <set>
+#include <tuple>
+
+using namespace memory::graph;
+using memory::core::Edge;
+using memory::core::EdgeType;
+using memory::core::NodeId;
+
+namespace {
+
+Edge edge(NodeId src, NodeId dst, EdgeType type, float weight = 1.0f) {
+    Edge e{};
+    e.src = src;
+    e.dst = dst;
+    e.type = type;
+    e.weight = weight;
+    return e;
+}
+
+DegreeCaps capAll(uint32_t cap) {
+    DegreeCaps caps;
+    caps.max_degree.fill(cap);
+    return caps;
+}
+
+GraphStoreOptions manualMerge(DegreeCaps caps) {
+    GraphStoreOptions options;
+    options.background_merge = false;
+    options.max_delta_segments = 100;
+    options.caps = caps;
+    return options;
+}
+
+std::set<NodeId> neighborIds(const CsrGraphStore& store, NodeId node, Direction direction,
+                             GraphLayer layer = GraphLayer::L1) {
+    std::set<NodeId> ids;
+    for (const Neighbor& n : store.Neighbors(node, direction, {}, layer)) ids.insert(n.node);
+    return ids;
+}
+
+} // namespace
+
+TEST(DegreeCapsTest, KeepsTopKByWeightTimesRecency) {
+    CsrGraphStore store(manualMerge(capAll(3)));
+    // Same weight: the three newest survive
+    for (NodeId n = 0; n < 6; ++n) {
+        store.AddEdge(edge(1, 10 + n, EdgeType::SIMILAR_TO, 0.5f), static_cast<uint16_t>(1000 + n));
+    }
+    // Same day: the three heaviest survive
+    for (NodeId n = 0; n < 6; ++n) {
+        store.AddEdge(edge(2, 20 + n, EdgeType::ABOUT, 0.1f * static_cast<float>(n + 1)), 1000);
+    }
+    // A heavy old edge against light fresh ones: 0.9 x e^(-60/30) < 0.2
+    store.AddEdge(edge(3, 30, EdgeType::MENTIONS, 0.9f), 940);
+    for (NodeId n = 31; n < 34; ++n) store.AddEdge(edge(3, n, EdgeType::MENTIONS, 0.2f), 1000);
+    store.Compact();
+
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT), (std::set<NodeId>{13, 14, 15}));
+    EXPECT_EQ(neighborIds(store, 2, Direction::OUT), (std::set<NodeId>{23, 24, 25}));
+    EXPECT_EQ(neighborIds(store, 3, Direction::OUT), (std::set<NodeId>{31, 32, 33}));
+    EXPECT_EQ(store.edgeCount(), 9u);
+    EXPECT_EQ(store.coldEdgeCount(), 7u);
+
+    // The full layer pages the cold edges back in
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT, GraphLayer::L0).size(), 6u);
+    EXPECT_EQ(neighborIds(store, 10, Direction::IN, GraphLayer::L0), (std::set<NodeId>{1}));
+    EXPECT_TRUE(neighborIds(store, 10, Direction::IN).empty());
+
+    // Traversals only see the pruned graph
+    std::vector<NodeId> seeds = {1};
+    EXPECT_EQ(store.KHopSeeds(seeds, 1).size(), 4u);
+}
+
+TEST(DegreeCapsTest, CapsApplyPerTypeAndDirection) {
+    DegreeCaps caps = DegreeCaps::unlimited();
+    caps.max_degree[static_cast<size_t>(EdgeType::ABOUT)] = 2;
+    CsrGraphStore store(manualMerge(caps));
+    // Concept 100 has five ABOUT in-edges; each episode has one out-edge
+    for (NodeId n = 1; n <= 5; ++n) {
+        store.AddEdge(edge(n, 100, EdgeType::ABOUT, 0.1f * static_cast<float>(n)), 1000);
+        store.AddEdge(edge(n, 100, EdgeType::MENTIONS), 1000);
+    }
+    store.Compact();
+
+    auto about = store.Neighbors(100, Direction::IN, std::vector<EdgeType>{EdgeType::ABOUT});
+    ASSERT_EQ(about.size(), 2u);
+    EXPECT_EQ(about[0].node, 4u);
+    EXPECT_EQ(about[1].node, 5u);
+    // The episodes whose ABOUT edge was cut lose it from their side too
+    EXPECT_EQ(store.Neighbors(1, Direction::OUT).size(), 1u);
+    EXPECT_EQ(store.Neighbors(100, Direction::IN, std::vector<EdgeType>{EdgeType::MENTIONS}).size(), 5u);
+}
+
+TEST(DegreeCapsTest, ColdEdgesFollowUpdatesAndCapChanges) {
+    CsrGraphStore store(manualMerge(capAll(2)));
+    for (NodeId n = 10; n < 15; ++n) store.AddEdge(edge(1, n, EdgeType::REFERS_TO, 0.5f), 1000);
+    store.Compact();
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT), (std::set<NodeId>{10, 11}));
+    EXPECT_EQ(store.coldEdgeCount(), 3u);
+
+    // Deleting a cold edge removes it for good; re-weighting one promotes it
+    store.RemoveEdge(1, 12, EdgeType::REFERS_TO);
+    store.AddEdge(edge(1, 14, EdgeType::REFERS_TO, 0.9f), 1000);
+    store.Flush();
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT), (std::set<NodeId>{10, 11, 14}));  // Over cap until merged
+    EXPECT_EQ(store.edgeCount(), 3u);
+    store.Compact();
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT), (std::set<NodeId>{10, 14}));
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT, GraphLayer::L0), (std::set<NodeId>{10, 11, 13, 14}));
+    EXPECT_EQ(store.edgeCount(), 2u);
+    EXPECT_EQ(store.coldEdgeCount(), 2u);
+
+    // Deleting a hot edge lets the best cold one back in
+    store.RemoveEdge(1, 14, EdgeType::REFERS_TO);
+    store.Compact();
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT), (std::set<NodeId>{10, 11}));
+
+    store.SetDegreeCaps(DegreeCaps::unlimited());
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT), (std::set<NodeId>{10, 11, 13}));
+    EXPECT_EQ(store.coldEdgeCount(), 0u);
+    store.SetDegreeCaps(capAll(1));
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT), (std::set<NodeId>{10}));
+    EXPECT_EQ(store.edgeCount() + store.coldEdgeCount(), 3u);
+}
+
+TEST(DegreeCapsTest, PrunedGraphMatchesModel) {
+    // Random skewed graph, TEMPORAL_NEXT left uncapped; every cut edge must rank past
+    // the cap at one of its endpoints, and no list may exceed its cap
+    std::mt19937 rng(11);
+    DegreeCaps caps = DegreeCaps::unlimited();
+    caps.max_degree[static_cast<size_t>(EdgeType::ABOUT)] = 4;
+    caps.max_degree[static_cast<size_t>(EdgeType::MENTIONS)] = 6;
+    caps.max_degree[static_cast<size_t>(EdgeType::SIMILAR_TO)] = 3;
+    CsrGraphStore store(manualMerge(caps));
+
+    using Key = std::tuple<NodeId, NodeId, int>;
+    std::map<Key, std::pair<float, uint16_t>> model;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 3000; ++i) {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            NodeId src = rng() % 400;
+            auto dst = static_cast<NodeId>(u * u * 400);
+            auto type = static_cast<EdgeType>(rng() % 4 == 0 ? 9 : rng() % 3);
+            if (rng() % 10 == 0) {
+                store.RemoveEdge(src, dst, type);
+                model.erase({src, dst, static_cast<int>(type)});
+                continue;
+            }
+            float weight = 0.05f * static_cast<float>(1 + rng() % 20);
+            auto day = static_cast<uint16_t>(1000 + rng() % 90);
+            store.AddEdge(edge(src, dst, type, weight), day);
+            model[{src, dst, static_cast<int>(type)}] = {weight, day};
+        }
+        store.Compact();
+    }
+
+    // L0 is exactly the model
+    std::set<Key> full;
+    std::set<Key> hot;
+    for (NodeId n = 0; n < 400; ++n) {
+        for (const Neighbor& nb : store.Neighbors(n, Direction::OUT, {}, GraphLayer::L0)) {
+            full.insert({n, nb.node, static_cast<int>(nb.type)});
+        }
+        for (const Neighbor& nb : store.Neighbors(n, Direction::OUT)) {
+            hot.insert({n, nb.node, static_cast<int>(nb.type)});
+        }
+    }
+    std::set<Key> expected;
+    for (const auto& [key, value] : model) expected.insert(key);
+    EXPECT_EQ(full, expected);
+    EXPECT_EQ(store.edgeCount(), hot.size());
+    EXPECT_EQ(store.edgeCount() + store.coldEdgeCount(), model.size());
+
+    // Rank of an edge within its (node, type) list in the model
+    auto rankAt = [&](NodeId node, int type, NodeId neighbor, bool out) {
+        auto score = [&](NodeId a, NodeId b) {
+            auto [w, day] = model.at(out ? Key{node, b, type} : Key{b, node, type});
+            PackedEdge e{static_cast<uint32_t>(a), w, static_cast<uint8_t>(type), 0, day};
+            return caps.retentionKey(e);
+        };
+        double mine = score(neighbor, neighbor);
+        size_t better = 0;
+        for (const auto& [key, value] : model) {
+            auto [s, d, t] = key;
+            if (t != type || (out ? s : d) != node) continue;
+            NodeId other = out ? d : s;
+            double theirs = score(other, other);
+            better += theirs > mine || (theirs == mine && other < neighbor);
+        }
+        return better;
+    };
+    size_t cut = 0;
+    for (const Key& key : expected) {
+        if (hot.count(key)) continue;
+        auto [s, d, t] = key;
+        uint32_t cap = caps.max_degree[t];
+        ASSERT_GT(cap, 0u);
+        EXPECT_TRUE(rankAt(s, t, d, true) >= cap || rankAt(d, t, s, false) >= cap)
+            << s << " -> " << d << " type " << t;
+        ++cut;
+    }
+    EXPECT_GT(cut, 0u);
+
+    for (NodeId n = 0; n < 400; ++n) {
+        for (Direction direction : {Direction::OUT, Direction::IN}) {
+            std::map<EdgeType, uint32_t> degree;
+            for (const Neighbor& nb : store.Neighbors(n, direction)) ++degree[nb.type];
+            for (const auto& [type, count] : degree) {
+                uint32_t cap = caps.max_degree[static_cast<size_t>(type)];
+                if (cap > 0) {
+                    EXPECT_LE(count, cap);
+                }
+            }
+        }
+    }
+}
+
+TEST(DegreeCapsTest, ColdSegmentFileIsMappedAndRemoved) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_cold_edges";
+    std::filesystem::remove_all(dir);
+    GraphStoreOptions options = manualMerge(capAll(1));
+    options.cold_edge_dir = dir.string();
+    {
+        CsrGraphStore store(options);
+        for (NodeId n = 10; n < 20; ++n) store.AddEdge(edge(1, n, EdgeType::CAUSES), 1000);
+        store.Compact();
+        auto cold = store.snapshot()->cold();
+        ASSERT_NE(cold, nullptr);
+        EXPECT_TRUE(std::filesystem::exists(cold->path()));
+        EXPECT_EQ(cold->memoryBytes(), 0u);
+        EXPECT_EQ(neighborIds(store, 1, Direction::OUT, GraphLayer::L0).size(), 10u);
+
+        // A newer segment replaces the file once no snapshot holds the old one
+        std::string first = cold->path();
+        cold.reset();
+        store.AddEdge(edge(1, 20, EdgeType::CAUSES), 1000);
+        store.Compact();
+        EXPECT_FALSE(std::filesystem::exists(first));
+        EXPECT_EQ(store.coldEdgeCount(), 10u);
+    }
+    EXPECT_TRUE(std::filesystem::is_empty(dir));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(DegreeCapsTest, FullReadsGoThroughAdjacencyCache) {
+    CsrGraphStore store(manualMerge(capAll(2)));
+    for (NodeId n = 10; n < 20; ++n) store.AddEdge(edge(1, n, EdgeType::CAUSES), 1000);
+    store.AddEdge(edge(2, 3, EdgeType::CAUSES), 1000);
+    store.Compact();
+
+    // Only nodes with cold edges are cached; the rest is read in place
+    EXPECT_EQ(neighborIds(store, 2, Direction::OUT, GraphLayer::L0).size(), 1u);
+    EXPECT_EQ(store.cacheStats().hits + store.cacheStats().misses, 0u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(neighborIds(store, 1, Direction::OUT, GraphLayer::L0).size(), 10u);
+    }
+    auto stats = store.cacheStats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_GT(stats.bytes, 10 * sizeof(PackedEdge));
+
+    // Deltas are applied on top of a cached block
+    store.RemoveEdge(1, 15, EdgeType::CAUSES);
+    store.AddEdge(edge(1, 30, EdgeType::CAUSES), 1000);
+    store.Flush();
+    auto ids = neighborIds(store, 1, Direction::OUT, GraphLayer::L0);
+    EXPECT_EQ(ids.size(), 10u);
+    EXPECT_FALSE(ids.count(15));
+    EXPECT_TRUE(ids.count(30));
+    EXPECT_EQ(store.cacheStats().hits, 4u);
+
+    // A merge drops the blocks of the old base
+    store.Compact();
+    EXPECT_EQ(store.cacheStats().entries, 0u);
+    EXPECT_EQ(neighborIds(store, 1, Direction::OUT, GraphLayer::L0), ids);
+    EXPECT_EQ(store.cacheStats().misses, 2u);
+}
+
+TEST(DegreeCapsTest, PinnedNodesStayCached) {
+    GraphStoreOptions options = manualMerge(capAll(1));
+    options.cache_bytes = 16 * 1024;
+    CsrGraphStore store(options);
+    // Hub 0 and 500 nodes with a few cold edges each
+    for (NodeId n = 1; n <= 100; ++n) store.AddEdge(edge(0, n, EdgeType::ABOUT), 1000);
+    for (NodeId n = 1000; n < 1500; ++n) {
+        for (NodeId m = 0; m < 4; ++m) store.AddEdge(edge(n, 5000 + m, EdgeType::MENTIONS), 1000);
+    }
+    store.Compact();
+
+    EXPECT_FALSE(store.PinNode(99999));
+    ASSERT_TRUE(store.PinNode(0));
+    size_t pinned = store.cacheStats().pinned_bytes;
+    EXPECT_GT(pinned, 100 * sizeof(PackedEdge));
+    // A scan over every node's full adjacency
+    for (int round = 0; round < 3; ++round) {
+        for (NodeId n = 1000; n < 1500; ++n) store.Neighbors(n, Direction::OUT, {}, GraphLayer::L0);
+    }
+    auto before = store.cacheStats();
+    EXPECT_EQ(neighborIds(store, 0, Direction::OUT, GraphLayer::L0).size(), 100u);
+    EXPECT_EQ(store.cacheStats().hits, before.hits + 1);
+    EXPECT_LE(store.cacheStats().bytes, options.cache_bytes);
+
+    // Pins survive a merge; the block reloads on the next read
+    store.AddEdge(edge(0, 101, EdgeType::ABOUT), 1000);
+    store.Compact();
+    EXPECT_EQ(store.cacheStats().pinned_bytes, 0u);
+    EXPECT_EQ(neighborIds(store, 0, Direction::OUT, GraphLayer::L0).size(), 101u);
+    EXPECT_GT(store.cacheStats().pinned_bytes, pinned);
+    store.UnpinNode(0);
+    EXPECT_EQ(store.cacheStats().pinned_bytes, 0u);
+}
+
+TEST(DegreeCapsTest, ReadsConfig) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("max_degree_per_type", "128");
+    config.set("similar_to_max_degree", "32");
+    config.set("edge_recency_tau_days", "7");
+    GraphStoreOptions options = GraphStoreOptions::fromConfig(config);
+    EXPECT_EQ(options.caps.max_degree[static_cast<size_t>(EdgeType::ABOUT)], 128u);
+    EXPECT_EQ(options.caps.max_degree[static_cast<size_t>(EdgeType::SIMILAR_TO)], 32u);
+    EXPECT_DOUBLE_EQ(options.caps.recency_tau_days, 7.0);
+    EXPECT_TRUE(options.caps.enabled());
+    EXPECT_FALSE(DegreeCaps::unlimited().enabled());
+    config.set("cache_size_mb", "64");
+    EXPECT_EQ(GraphStoreOptions::fromConfig(config).cache_bytes, size_t{64} << 20);
+
+    EXPECT_EQ(edgeDay(kEdgeDayEpoch), 0u);
+    EXPECT_EQ(edgeDay(kEdgeDayEpoch + std::chrono::days{400} + std::chrono::hours{5}), 400u);
+    EXPECT_EQ(edgeDay(kEdgeDayEpoch - std::chrono::days{1}), 0u);
+}
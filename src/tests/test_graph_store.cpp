@@ -0,0 +1,403 @@
+#include <gtest/gtest.h>
+#include "memory/graph/csr_graph_store.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/wal.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <thread>
+
+using namespace memory::graph;
+using memory::core::Edge;
+using memory::core::EdgeType;
+using memory::core::NodeId;
+
+namespace {
+
+Edge edge(NodeId src, NodeId dst, EdgeType type, float weight = 1.0f) {
+    Edge e{};
+    e.src = src;
+    e.dst = dst;
+    e.type = type;
+    e.weight = weight;
+    return e;
+}
+
+std::vector<NodeId> sorted(const std::vector<HopNode>& hops) {
+    std::vector<NodeId> ids;
+    for (const auto& hop : hops) ids.push_back(hop.node);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // namespace
+
+TEST(CsrGraphTest, PartitionsByTypeAndKeepsLastDuplicate) {
+    CsrBuilder builder(4);
+    builder.add(0, 3, EdgeType::SIMILAR_TO, 0.5f);
+    builder.add(0, 2, EdgeType::ABOUT, 1.0f);
+    builder.add(0, 1, EdgeType::ABOUT, 1.0f);
+    builder.add(0, 1, EdgeType::SUPPORTS, 0.8f);
+    builder.add(0, 2, EdgeType::ABOUT, 0.25f);  // Re-weights the earlier edge
+    builder.add(2, 1, EdgeType::ABOUT, 1.0f);
+    EXPECT_THROW(builder.add(0, 4, EdgeType::ABOUT, 1.0f), memory::core::IndexException);
+    CsrGraph graph = builder.build();
+
+    EXPECT_EQ(graph.nodeCount(), 4u);
+    EXPECT_EQ(graph.edgeCount(), 5u);
+
+    auto out = graph.edges(0, Direction::OUT);
+    ASSERT_EQ(out.size(), 4u);
+    for (size_t i = 1; i < out.size(); ++i) {
+        EXPECT_LE(out[i - 1].type, out[i].type);
+    }
+    auto about = graph.edges(0, Direction::OUT, EdgeType::ABOUT);
+    ASSERT_EQ(about.size(), 2u);
+    EXPECT_EQ(about[0].dst, 1u);
+    EXPECT_EQ(about[1].dst, 2u);
+    EXPECT_FLOAT_EQ(about[1].weight, 0.25f);
+    EXPECT_TRUE(graph.edges(0, Direction::OUT, EdgeType::CAUSES).empty());
+    EXPECT_EQ(graph.typeMask(0, Direction::OUT),
+              edgeTypeBit(EdgeType::ABOUT) | edgeTypeBit(EdgeType::SUPPORTS) | edgeTypeBit(EdgeType::SIMILAR_TO));
+
+    auto in = graph.edges(1, Direction::IN, EdgeType::ABOUT);
+    ASSERT_EQ(in.size(), 2u);
+    EXPECT_EQ(in[0].dst, 0u);
+    EXPECT_EQ(in[1].dst, 2u);
+    EXPECT_EQ(graph.typeMask(3, Direction::OUT), 0u);
+}
+
+TEST(CsrGraphTest, MatchesAdjacencyLists) {
+    constexpr uint32_t kNodes = 500;
+    std::mt19937 rng(11);
+    CsrBuilder builder(kNodes);
+    std::vector<std::vector<std::pair<uint32_t, uint16_t>>> out(kNodes), in(kNodes);
+    for (int i = 0; i < 5000; ++i) {
+        uint32_t src = rng() % kNodes;
+        uint32_t dst = rng() % kNodes;
+        auto type = static_cast<uint16_t>(rng() % kEdgeTypeCount);
+        builder.add(src, dst, static_cast<EdgeType>(type), 1.0f);
+        out[src].emplace_back(dst, type);
+        in[dst].emplace_back(src, type);
+    }
+    CsrGraph graph = builder.build();
+
+    auto unique = [](std::vector<std::pair<uint32_t, uint16_t>> v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+        return v;
+    };
+    for (uint32_t n = 0; n < kNodes; ++n) {
+        for (auto [direction, expected] : {std::pair{Direction::OUT, &out[n]}, std::pair{Direction::IN, &in[n]}}) {
+            std::vector<std::pair<uint32_t, uint16_t>> actual;
+            for (const auto& e : graph.edges(n, direction)) actual.emplace_back(e.dst, e.type);
+            ASSERT_EQ(unique(actual), unique(*expected)) << "node " << n;
+            ASSERT_EQ(actual.size(), unique(*expected).size());
+        }
+    }
+}
+
+TEST(CsrGraphTest, SavedGraphOpensMapped) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_csr_graph";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "base.csr").string();
+    constexpr uint32_t kNodes = 300;
+    std::mt19937 rng(12);
+    CsrBuilder builder(kNodes);
+    for (int i = 0; i < 3000; ++i) {
+        builder.add(rng() % kNodes, rng() % kNodes, static_cast<EdgeType>(rng() % kEdgeTypeCount),
+                    static_cast<float>(rng() % 100) / 100.0f, static_cast<uint16_t>(rng() % 1000));
+    }
+    CsrGraph built = builder.build();
+    built.save(path);
+
+    CsrGraph opened = CsrGraph::open(path, true);
+    EXPECT_TRUE(opened.mapped());
+    EXPECT_FALSE(built.mapped());
+    EXPECT_EQ(opened.memoryBytes(), 0u);
+    ASSERT_EQ(opened.nodeCount(), kNodes);
+    ASSERT_EQ(opened.edgeCount(), built.edgeCount());
+    CsrGraph moved = std::move(opened);
+    for (uint32_t n = 0; n < kNodes; ++n) {
+        for (Direction direction : {Direction::OUT, Direction::IN}) {
+            auto expected = built.edges(n, direction);
+            auto actual = moved.edges(n, direction);
+            ASSERT_EQ(actual.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                EXPECT_EQ(actual[i].dst, expected[i].dst);
+                EXPECT_EQ(actual[i].type, expected[i].type);
+                EXPECT_EQ(actual[i].weight, expected[i].weight);
+                EXPECT_EQ(actual[i].day, expected[i].day);
+            }
+            EXPECT_EQ(moved.typeMask(n, direction), built.typeMask(n, direction));
+            EXPECT_EQ(moved.edges(n, direction, EdgeType::ABOUT).size(),
+                      built.edges(n, direction, EdgeType::ABOUT).size());
+        }
+    }
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) + 1);
+    EXPECT_THROW(CsrGraph::open(path), memory::core::StorageException);
+    std::filesystem::remove_all(dir);
+}
+
+class GraphStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Episodes 1..3 about concept 100, which supports fact 200
+        store_.AddEdge(edge(1, 100, EdgeType::ABOUT));
+        store_.AddEdge(edge(2, 100, EdgeType::ABOUT));
+        store_.AddEdge(edge(3, 100, EdgeType::ABOUT));
+        store_.AddEdge(edge(100, 200, EdgeType::SUPPORTS, 0.8f));
+        store_.AddEdge(edge(1, 2, EdgeType::TEMPORAL_NEXT, 0.3f));
+        store_.AddEdge(edge(200, 300, EdgeType::SIMILAR_TO, 0.5f));
+        store_.Flush();
+    }
+
+    CsrGraphStore store_;
+};
+
+TEST_F(GraphStoreTest, KHopFollowsBothDirections) {
+    std::vector<NodeId> seeds = {1};
+    EXPECT_EQ(sorted(store_.KHopSeeds(seeds, 0)), (std::vector<NodeId>{1}));
+    EXPECT_EQ(sorted(store_.KHopSeeds(seeds, 1)), (std::vector<NodeId>{1, 2, 100}));
+    EXPECT_EQ(sorted(store_.KHopSeeds(seeds, 2)), (std::vector<NodeId>{1, 2, 3, 100, 200}));
+    EXPECT_EQ(sorted(store_.KHopSeeds(seeds, 3)), (std::vector<NodeId>{1, 2, 3, 100, 200, 300}));
+
+    auto hops = store_.KHopSeeds(seeds, 3);
+    ASSERT_EQ(hops.size(), 6u);
+    EXPECT_EQ(hops[0].node, 1u);
+    for (size_t i = 1; i < hops.size(); ++i) {
+        EXPECT_LE(hops[i - 1].hops, hops[i].hops);  // Nearest first
+    }
+    for (const auto& hop : hops) {
+        uint32_t expected = hop.node == 1 ? 0 : hop.node == 2 || hop.node == 100 ? 1 : hop.node == 300 ? 3 : 2;
+        EXPECT_EQ(hop.hops, expected) << hop.node;
+    }
+}
+
+TEST_F(GraphStoreTest, KHopRestrictsEdgeTypes) {
+    std::vector<NodeId> seeds = {1, 999};  // Unknown seeds are ignored
+    std::vector<EdgeType> about = {EdgeType::ABOUT};
+    EXPECT_EQ(sorted(store_.KHopSeeds(seeds, 3, about)), (std::vector<NodeId>{1, 2, 3, 100}));
+    std::vector<EdgeType> chain = {EdgeType::ABOUT, EdgeType::SUPPORTS};
+    EXPECT_EQ(sorted(store_.KHopSeeds(seeds, 2, chain)), (std::vector<NodeId>{1, 2, 3, 100, 200}));
+}
+
+TEST_F(GraphStoreTest, ChangesVisibleAfterFlush) {
+    store_.RemoveEdge(1, 100, EdgeType::ABOUT);
+    store_.AddEdge(edge(1, 400, EdgeType::MENTIONS, 0.7f));
+    store_.AddEdge(edge(100, 200, EdgeType::SUPPORTS, 0.9f));
+    EXPECT_EQ(store_.bufferedCount(), 3u);
+    EXPECT_EQ(store_.Neighbors(1, Direction::OUT).size(), 2u);  // Not flushed yet
+
+    store_.Flush();
+    EXPECT_EQ(store_.bufferedCount(), 0u);
+    EXPECT_EQ(store_.edgeCount(), 6u);
+    auto out = store_.Neighbors(1, Direction::OUT);
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[0].node, 2u);
+    EXPECT_EQ(out[1].node, 400u);
+    EXPECT_EQ(out[1].type, EdgeType::MENTIONS);
+
+    auto supports = store_.Neighbors(200, Direction::IN, std::vector<EdgeType>{EdgeType::SUPPORTS});
+    ASSERT_EQ(supports.size(), 1u);
+    EXPECT_FLOAT_EQ(supports[0].weight, 0.9f);
+}
+
+TEST(GraphStoreOptionsTest, AutoRebuildAndConfig) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("max_buffered_edges", "10");
+    GraphStoreOptions options = GraphStoreOptions::fromConfig(config);
+    EXPECT_EQ(options.max_buffered_edges, 10u);
+
+    CsrGraphStore store(options);
+    for (NodeId n = 0; n < 25; ++n) {
+        store.AddEdge(edge(n, n + 1, EdgeType::TEMPORAL_NEXT));
+    }
+    EXPECT_EQ(store.edgeCount(), 20u);
+    EXPECT_EQ(store.bufferedCount(), 5u);
+    EXPECT_EQ(store.nodeCount(), 21u);  // Nodes of buffered edges are not visible yet
+    EXPECT_EQ(store.nodeIndex(7), 7u);
+    EXPECT_FALSE(store.nodeIndex(99).has_value());
+}
+
+TEST(GraphStoreWalTest, LogRebuildsUnsavedChanges) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_graph_wal";
+    std::filesystem::remove_all(dir);
+    GraphStoreOptions options;
+    options.max_buffered_edges = 8;
+    options.background_merge = false;
+    std::map<NodeId, std::vector<Neighbor>> before;
+    uint64_t edges = 0;
+    auto neighbors = [](const CsrGraphStore& store, NodeId node) {
+        auto list = store.Neighbors(node, Direction::OUT);
+        std::sort(list.begin(), list.end(), [](const Neighbor& a, const Neighbor& b) { return a.node < b.node; });
+        return list;
+    };
+    {
+        auto wal = std::make_shared<memory::core::WriteAheadLog>(dir.string());
+        CsrGraphStore store(options);
+        store.attachWal(wal);
+        for (NodeId n = 0; n < 60; ++n) {
+            store.AddEdge(edge(n, (n * 7) % 60, EdgeType::SIMILAR_TO, 0.01f * static_cast<float>(n)));
+            store.AddEdge(edge(n, 100 + n % 5, EdgeType::ABOUT));
+        }
+        for (NodeId n = 100; n < 105; ++n) store.SetNodeType(n, memory::core::NodeType::CONCEPT);
+        for (NodeId n = 0; n < 60; n += 3) store.RemoveEdge(n, 100 + n % 5, EdgeType::ABOUT);
+        store.RemoveEdge(999, 1, EdgeType::ABOUT);  // Unknown nodes log nothing
+        EXPECT_EQ(wal->lastLsn(), 145u);
+        store.Flush();
+        for (NodeId n = 0; n < 60; ++n) before[n] = neighbors(store, n);
+        edges = store.edgeCount();
+    }
+
+    auto wal = std::make_shared<memory::core::WriteAheadLog>(dir.string());
+    CsrGraphStore store(options);
+    store.attachWal(wal);
+    store.Flush();
+    EXPECT_EQ(store.edgeCount(), edges);
+    for (NodeId n = 0; n < 60; ++n) {
+        auto after = neighbors(store, n);
+        ASSERT_EQ(after.size(), before[n].size()) << n;
+        for (size_t i = 0; i < after.size(); ++i) {
+            EXPECT_EQ(after[i].node, before[n][i].node);
+            EXPECT_EQ(after[i].type, before[n][i].type);
+            EXPECT_FLOAT_EQ(after[i].weight, before[n][i].weight);
+        }
+    }
+    store.AddEdge(edge(1, 2, EdgeType::MENTIONS));
+    EXPECT_EQ(wal->lastLsn(), 146u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MergeAdjacencyTest, NewerEntriesWinAndTombstonesDelete) {
+    std::vector<PackedEdge> older = {{1, 1.0f, 0, 0, 0}, {2, 1.0f, 0, 0, 0}, {1, 1.0f, 1, 0, 0}};
+    std::vector<PackedEdge> newer = {{2, 0.5f, 0, 0, 0}, {3, 1.0f, 0, 0, 0}, {1, 0.0f, 1, kEdgeTombstone, 0}};
+    std::vector<PackedEdge> out;
+    mergeAdjacency(older, newer, out);
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_EQ(out[1].dst, 2u);
+    EXPECT_FLOAT_EQ(out[1].weight, 0.5f);
+    EXPECT_EQ(out[2].dst, 3u);
+
+    mergeAdjacency(older, newer, out, true);
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_TRUE(out[3].tombstone());
+}
+
+namespace {
+
+using Model = std::map<std::tuple<NodeId, NodeId, EdgeType>, float>;
+
+void expectMatchesModel(const CsrGraphStore& store, const Model& model, NodeId nodes) {
+    EXPECT_EQ(store.edgeCount(), model.size());
+    for (NodeId n = 0; n < nodes; ++n) {
+        std::map<std::pair<NodeId, EdgeType>, float> expected_out, expected_in;
+        for (const auto& [key, weight] : model) {
+            auto [src, dst, type] = key;
+            if (src == n) expected_out[{dst, type}] = weight;
+            if (dst == n) expected_in[{src, type}] = weight;
+        }
+        std::map<std::pair<NodeId, EdgeType>, float> out, in;
+        for (const auto& e : store.Neighbors(n, Direction::OUT)) out[{e.node, e.type}] = e.weight;
+        for (const auto& e : store.Neighbors(n, Direction::IN)) in[{e.node, e.type}] = e.weight;
+        ASSERT_EQ(out, expected_out) << "node " << n;
+        ASSERT_EQ(in, expected_in) << "node " << n;
+    }
+}
+
+} // namespace
+
+TEST(DeltaLayerTest, DeltasAndMergesMatchModel) {
+    GraphStoreOptions options;
+    options.max_buffered_edges = 64;
+    options.max_delta_segments = 3;
+    options.background_merge = false;
+    CsrGraphStore store(options);
+
+    constexpr NodeId kNodes = 60;
+    std::mt19937 rng(5);
+    Model model;
+    for (int i = 0; i < 3000; ++i) {
+        NodeId src = rng() % kNodes;
+        NodeId dst = rng() % kNodes;
+        auto type = static_cast<EdgeType>(rng() % 3);
+        if (rng() % 4 == 0) {
+            store.RemoveEdge(src, dst, type);
+            model.erase({src, dst, type});
+        } else {
+            float weight = static_cast<float>(rng() % 100) / 100.0f;
+            store.AddEdge(edge(src, dst, type, weight));
+            model[{src, dst, type}] = weight;
+        }
+        if (i % 500 == 499) {
+            store.Flush();
+            expectMatchesModel(store, model, kNodes);
+        }
+    }
+    EXPECT_GT(store.mergeCount(), 0u);
+
+    store.Compact();
+    EXPECT_EQ(store.deltaCount(), 0u);
+    expectMatchesModel(store, model, kNodes);
+}
+
+TEST(DeltaLayerTest, ReadersSeeConsistentSnapshotsDuringIngest) {
+    GraphStoreOptions options;
+    options.max_buffered_edges = 100;
+    options.max_delta_segments = 2;
+    CsrGraphStore store(options);
+
+    constexpr NodeId kNodes = 200;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> checks{0};
+    std::atomic<size_t> mismatches{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&, r] {
+            std::vector<PackedEdge> out_scratch, in_scratch;
+            uint32_t node = static_cast<uint32_t>(r);
+            while (!done.load()) {
+                auto snap = store.snapshot();
+                if (snap->nodeCount() == 0) continue;
+                // Every out-edge must show up as the matching in-edge of the
+                // same snapshot
+                uint32_t u = node++ % snap->nodeCount();
+                for (const PackedEdge& e : snap->edges(u, Direction::OUT, out_scratch)) {
+                    auto in = snap->edges(e.dst, Direction::IN, in_scratch);
+                    PackedEdge mirror{u, e.weight, e.type, 0, e.day};
+                    if (!std::binary_search(in.begin(), in.end(), mirror, adjacencyLess)) ++mismatches;
+                }
+                std::vector<NodeId> seed = {snap->nodeId(u)};
+                store.KHopSeeds(seed, 2);
+                ++checks;
+            }
+        });
+    }
+
+    std::mt19937 rng(9);
+    Model model;
+    for (int i = 0; i < 20000; ++i) {
+        NodeId src = rng() % kNodes;
+        NodeId dst = rng() % kNodes;
+        auto type = static_cast<EdgeType>(rng() % 4);
+        if (rng() % 5 == 0) {
+            store.RemoveEdge(src, dst, type);
+            model.erase({src, dst, type});
+        } else {
+            store.AddEdge(edge(src, dst, type, 1.0f));
+            model[{src, dst, type}] = 1.0f;
+        }
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+
+    EXPECT_EQ(mismatches.load(), 0u);
+    EXPECT_GT(checks.load(), 0u);
+    EXPECT_GT(store.mergeCount(), 0u);
+    store.Compact();
+    expectMatchesModel(store, model, kNodes);
+}
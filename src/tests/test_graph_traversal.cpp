@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "memory/graph/csr_graph_store.h"
+#include "memory/graph/traversal.h"
+#include "memory/core/thread_pool.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <random>
+
+using namespace memory::graph;
+using memory::core::Edge;
+using memory::core::EdgeType;
+using memory::core::NodeId;
+
+namespace {
+
+// Plain BFS over both directions as the reference
+std::map<uint32_t, uint32_t> referenceHops(const GraphSnapshot& graph, const std::vector<uint32_t>& seeds,
+                                           uint32_t k, EdgeTypeMask types) {
+    std::map<uint32_t, uint32_t> hops;
+    std::deque<uint32_t> queue;
+    for (uint32_t s : seeds) {
+        if (hops.emplace(s, 0).second) queue.push_back(s);
+    }
+    std::vector<PackedEdge> scratch;
+    while (!queue.empty()) {
+        uint32_t node = queue.front();
+        queue.pop_front();
+        if (hops[node] == k) continue;
+        for (Direction direction : {Direction::OUT, Direction::IN}) {
+            for (const PackedEdge& e : graph.edges(node, direction, scratch)) {
+                if (!(types & edgeTypeBit(e.edgeType()))) continue;
+                if (hops.emplace(e.dst, hops[node] + 1).second) queue.push_back(e.dst);
+            }
+        }
+    }
+    return hops;
+}
+
+std::map<uint32_t, uint32_t> toMap(const std::vector<HopIndex>& out) {
+    std::map<uint32_t, uint32_t> hops;
+    for (const auto& h : out) {
+        EXPECT_TRUE(hops.emplace(h.node, h.hops).second) << "duplicate node " << h.node;
+    }
+    return hops;
+}
+
+// Power-law graph: a few hubs carry most edges
+void buildGraph(CsrGraphStore& store, uint32_t nodes, uint32_t edges, uint32_t seed) {
+    std::mt19937 rng(seed);
+    Edge e{};
+    for (uint32_t i = 0; i < edges; ++i) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        e.src = rng() % nodes;
+        e.dst = static_cast<NodeId>(u * u * u * nodes);
+        e.type = static_cast<EdgeType>(rng() % 4);
+        store.AddEdge(e);
+    }
+}
+
+} // namespace
+
+TEST(EpochVisitedSetTest, StampsAdvanceAndWrap) {
+    EpochVisitedSet visited;
+    visited.begin(10, 2);
+    uint32_t first = visited.base();
+    visited.stamps()[3].store(first + 2);
+    visited.begin(10, 2);
+    EXPECT_GT(visited.base(), first + 2);  // Old marks read as unvisited
+    EXPECT_LT(visited.stamps()[3].load(), visited.base());
+
+    for (int i = 0; i < 5000; ++i) visited.begin(10, 1000000);
+    EXPECT_GE(visited.base(), 1u);
+    for (size_t i = 0; i < 10; ++i) EXPECT_LT(visited.stamps()[i].load(), visited.base());
+    visited.begin(100, 1);
+    EXPECT_GE(visited.capacity(), 100u);
+}
+
+TEST(KHopTraversalTest, TopDownBottomUpAndParallelAgree) {
+    GraphStoreOptions options;
+    options.background_merge = false;
+    CsrGraphStore store(options);
+    buildGraph(store, 5000, 30000, 1);
+    store.Compact();
+    buildGraph(store, 5200, 2000, 2);  // Leave some edges in a delta
+    store.Flush();
+    auto snap = store.snapshot();
+    ASSERT_GT(snap->deltas().size(), 0u);
+
+    memory::core::ThreadPool pool(3);
+    KHopTuning top_down;
+    top_down.alpha = 1e-12;  // Never switch
+    KHopTuning bottom_up;
+    bottom_up.alpha = 1e12;  // Switch at once
+    bottom_up.beta = 1e12;
+    KHopTuning parallel;
+    parallel.parallel_threshold = 1;
+
+    std::mt19937 rng(3);
+    EpochVisitedSet visited;
+    std::map<const KHopTuning*, KHopStats> totals;
+    for (int q = 0; q < 40; ++q) {
+        std::vector<uint32_t> seeds = {static_cast<uint32_t>(rng() % snap->nodeCount()),
+                                       static_cast<uint32_t>(rng() % 50)};
+        uint32_t k = 1 + q % 3;
+        EdgeTypeMask types = q % 2 ? kAllEdgeTypes : edgeTypeBit(EdgeType::ABOUT) | edgeTypeBit(EdgeType::MENTIONS);
+        auto expected = referenceHops(*snap, seeds, k, types);
+
+        for (const KHopTuning* tuning : {&top_down, &bottom_up, &parallel}) {
+            for (memory::core::ThreadPool* p : {static_cast<memory::core::ThreadPool*>(nullptr), &pool}) {
+                std::vector<HopIndex> out;
+                KHopStats stats = expandKHop(*snap, seeds, k, types, visited, out, p, *tuning);
+                ASSERT_EQ(toMap(out), expected) << "query " << q;
+                for (size_t i = 1; i < out.size(); ++i) ASSERT_LE(out[i - 1].hops, out[i].hops);
+                totals[tuning].top_down_levels += stats.top_down_levels;
+                totals[tuning].bottom_up_levels += stats.bottom_up_levels;
+                totals[tuning].parallel_levels += p ? stats.parallel_levels : 0;
+            }
+        }
+    }
+    // Seeds without matching edges, or an exhausted graph, can still flip a level
+    EXPECT_GT(totals[&top_down].top_down_levels, 10 * totals[&top_down].bottom_up_levels);
+    EXPECT_GT(totals[&bottom_up].bottom_up_levels, 10 * totals[&bottom_up].top_down_levels);
+    EXPECT_GT(totals[&parallel].parallel_levels, 0u);
+}
+
+TEST(KHopTraversalTest, HubFrontierSwitchesToBottomUp) {
+    GraphStoreOptions options;
+    options.background_merge = false;
+    options.max_threads = 4;
+    options.khop.parallel_threshold = 256;
+    options.caps = DegreeCaps::unlimited();  // Keep the hub whole
+    CsrGraphStore store(options);
+    Edge e{};
+    e.type = EdgeType::ABOUT;
+    for (NodeId n = 1; n <= 2000; ++n) {
+        e.src = n;
+        e.dst = 0;  // Concept hub
+        store.AddEdge(e);
+        e.src = n;
+        e.dst = n + 10000;  // Leaf behind every episode
+        store.AddEdge(e);
+    }
+    store.Compact();
+
+    auto snap = store.snapshot();
+    EpochVisitedSet visited;
+    std::vector<HopIndex> out;
+    std::vector<uint32_t> seeds = {*snap->nodeIndex(0)};
+    KHopStats stats = expandKHop(*snap, seeds, 2, kAllEdgeTypes, visited, out);
+    EXPECT_EQ(out.size(), 4001u);
+    EXPECT_GT(stats.bottom_up_levels, 0u);
+
+    std::vector<NodeId> hub = {0};
+    auto hops = store.KHopSeeds(hub, 2);
+    ASSERT_EQ(hops.size(), 4001u);
+    EXPECT_EQ(std::count_if(hops.begin(), hops.end(), [](const HopNode& h) { return h.hops == 1; }), 2000);
+}
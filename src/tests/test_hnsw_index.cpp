@@ -0,0 +1,667 @@
+#include <gtest/gtest.h>
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/wal.h"
+#include "memory/vector/hnsw_index.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace memory::vector;
+using memory::core::NodeId;
+using memory::core::SimdLevel;
+
+namespace {
+
+std::vector<std::vector<float>> randomVectors(size_t count, size_t dimension, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<std::vector<float>> vectors(count, std::vector<float>(dimension));
+    for (auto& v : vectors) {
+        for (float& x : v) x = dist(rng);
+    }
+    return vectors;
+}
+
+// Exact top-k ids by brute force, under metric, among ids keep() takes
+template <typename Keep>
+std::vector<NodeId> exactTopK(const std::vector<std::vector<float>>& data, const std::vector<float>& query,
+                              Metric metric, size_t k, const Keep& keep) {
+    auto normalized = [&](const std::vector<float>& v) {
+        std::vector<float> out = v;
+        if (metric == Metric::COSINE) {
+            double norm = 0;
+            for (float x : v) norm += double(x) * x;
+            for (float& x : out) x = static_cast<float>(x / std::sqrt(norm));
+        }
+        return out;
+    };
+    std::vector<float> q = normalized(query);
+    std::vector<std::pair<double, NodeId>> scored;
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (!keep(i)) continue;
+        std::vector<float> v = normalized(data[i]);
+        double d = 0;
+        for (size_t j = 0; j < v.size(); ++j) {
+            d += metric == Metric::L2 ? (double(q[j]) - v[j]) * (double(q[j]) - v[j]) : -double(q[j]) * v[j];
+        }
+        scored.emplace_back(d, i);
+    }
+    k = std::min(k, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + k, scored.end());
+    std::vector<NodeId> ids;
+    for (size_t i = 0; i < k; ++i) ids.push_back(scored[i].second);
+    return ids;
+}
+
+double recallAt(const HnswIndex& index, const std::vector<std::vector<float>>& data,
+                const std::vector<std::vector<float>>& queries, size_t k) {
+    size_t hits = 0;
+    for (const auto& query : queries) {
+        std::vector<NodeId> truth = exactTopK(data, query, index.options().metric, k, [](size_t) { return true; });
+        std::set<NodeId> expected(truth.begin(), truth.end());
+        for (const auto& result : index.Search(query, k)) hits += expected.count(result.id);
+    }
+    return static_cast<double>(hits) / static_cast<double>(queries.size() * k);
+}
+
+} // namespace
+
+TEST(DistanceKernelsTest, ScalarAlwaysAvailable) {
+    ASSERT_NE(distanceKernels(SimdLevel::SCALAR), nullptr);
+    EXPECT_STREQ(distanceKernels(SimdLevel::SCALAR)->name, "scalar");
+    EXPECT_TRUE(memory::core::simdLevelSupported(distanceKernels().level));
+}
+
+TEST(DistanceKernelsTest, AllLevelsMatchScalar) {
+    const DistanceKernels& scalar = *distanceKernels(SimdLevel::SCALAR);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2}) {
+        const DistanceKernels* kernels = distanceKernels(level);
+        if (!kernels) continue;
+        // Odd lengths exercise the tails
+        for (size_t n : {0, 1, 7, 15, 16, 17, 33, 100, 768}) {
+            std::vector<float> a(n), b(n);
+            for (size_t i = 0; i < n; ++i) {
+                a[i] = dist(rng);
+                b[i] = dist(rng);
+            }
+            float tolerance = 1e-4f * static_cast<float>(n + 1);
+            EXPECT_NEAR(kernels->dot(a.data(), b.data(), n), scalar.dot(a.data(), b.data(), n), tolerance)
+                << kernels->name << " n=" << n;
+            EXPECT_NEAR(kernels->l2_squared(a.data(), b.data(), n), scalar.l2_squared(a.data(), b.data(), n),
+                        tolerance)
+                << kernels->name << " n=" << n;
+
+            std::vector<uint8_t> codes(n);
+            for (uint8_t& c : codes) c = static_cast<uint8_t>(rng());
+            EXPECT_NEAR(kernels->dot_u8(a.data(), codes.data(), n), scalar.dot_u8(a.data(), codes.data(), n),
+                        255 * tolerance)
+                << kernels->name << " n=" << n;
+            EXPECT_NEAR(kernels->l2_u8(a.data(), b.data(), codes.data(), n),
+                        scalar.l2_u8(a.data(), b.data(), codes.data(), n), 255 * 255 * tolerance)
+                << kernels->name << " n=" << n;
+            std::vector<float> table(256 * n);
+            for (float& t : table) t = dist(rng);
+            EXPECT_NEAR(kernels->lookup_sum(table.data(), codes.data(), n),
+                        scalar.lookup_sum(table.data(), codes.data(), n), tolerance)
+                << kernels->name << " n=" << n;
+        }
+    }
+}
+
+TEST(DistanceKernelsTest, MetricsAndScores) {
+    const DistanceKernels& kernels = distanceKernels();
+    float a[] = {1, 0, 0, 0};
+    float b[] = {0.6f, 0.8f, 0, 0};
+    EXPECT_NEAR(metricDistance(kernels, Metric::COSINE, a, b, 4), 0.4f, 1e-6f);
+    EXPECT_NEAR(metricDistance(kernels, Metric::L2, a, b, 4), 0.16f + 0.64f, 1e-6f);
+    EXPECT_NEAR(distanceToScore(Metric::COSINE, 0.4f), 0.6f, 1e-6f);
+    EXPECT_NEAR(distanceToScore(Metric::L2, 0.8f), -0.8f, 1e-6f);
+
+    for (Metric metric : {Metric::COSINE, Metric::DOT, Metric::L2}) {
+        EXPECT_EQ(stringToMetric(metricToString(metric)), metric);
+    }
+    EXPECT_THROW(stringToMetric("manhattan"), std::invalid_argument);
+    EXPECT_EQ(paddedDimension(768), 768u);
+    EXPECT_EQ(paddedDimension(100), 112u);
+}
+
+TEST(HnswIndexTest, EmptyIndexReturnsNothing) {
+    HnswIndex index(HnswOptions{.dimension = 8});
+    std::vector<float> query(8, 1.0f);
+    EXPECT_TRUE(index.Search(query, 10).empty());
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_EQ(index.maxLevel(), -1);
+}
+
+TEST(HnswIndexTest, FindsExactMatchFirst) {
+    HnswIndex index(HnswOptions{.dimension = 20, .m = 8, .ef_construction = 64});
+    auto data = randomVectors(500, 20, 1);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i]);
+
+    for (size_t i = 0; i < data.size(); i += 37) {
+        auto result = index.Search(data[i], 1);
+        ASSERT_EQ(result.size(), 1u);
+        EXPECT_EQ(result[0].id, i);
+        EXPECT_NEAR(result[0].score, 1.0f, 1e-4f);
+    }
+}
+
+TEST(HnswIndexTest, RecallAgainstBruteForce) {
+    for (Metric metric : {Metric::COSINE, Metric::L2}) {
+        HnswIndex index(HnswOptions{.dimension = 32, .metric = metric, .m = 12, .ef_construction = 100,
+                                    .ef_search = 64});
+        auto data = randomVectors(3000, 32, 2);
+        for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i]);
+        auto queries = randomVectors(50, 32, 3);
+
+        EXPECT_GE(recallAt(index, data, queries, 10), 0.9) << metricToString(metric);
+        EXPECT_GT(index.maxLevel(), 0);
+    }
+}
+
+TEST(HnswIndexTest, ResultsAreSortedBestFirst) {
+    HnswIndex index(HnswOptions{.dimension = 16});
+    auto data = randomVectors(400, 16, 4);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i]);
+
+    auto result = index.Search(data[0], 20);
+    ASSERT_EQ(result.size(), 20u);
+    for (size_t i = 1; i < result.size(); ++i) EXPECT_GE(result[i - 1].score, result[i].score);
+    std::set<NodeId> ids;
+    for (const auto& r : result) ids.insert(r.id);
+    EXPECT_EQ(ids.size(), result.size());
+}
+
+TEST(HnswIndexTest, UpsertReplacesAndRemoveHides) {
+    HnswIndex index(HnswOptions{.dimension = 16});
+    auto data = randomVectors(300, 16, 5);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i]);
+
+    // Move id 7 onto the vector of id 100
+    index.Upsert(7, data[100]);
+    EXPECT_EQ(index.size(), 300u);
+    EXPECT_EQ(index.nodeCount(), 301u);
+    auto result = index.Search(data[100], 2);
+    ASSERT_EQ(result.size(), 2u);
+    std::set<NodeId> top{result[0].id, result[1].id};
+    EXPECT_EQ(top, (std::set<NodeId>{7, 100}));
+    for (const auto& r : index.Search(data[7], 10)) {
+        if (r.id == 7) {
+            EXPECT_LT(r.score, 0.99f);  // The old vector is gone
+        }
+    }
+
+    index.Remove(100);
+    index.Remove(12345);  // Unknown ids are ignored
+    EXPECT_EQ(index.size(), 299u);
+    for (const auto& r : index.Search(data[100], 50)) EXPECT_NE(r.id, 100u);
+    result = index.Search(data[100], 1);
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].id, 7u);
+}
+
+TEST(HnswIndexTest, RejectsBadInput) {
+    HnswIndex index(HnswOptions{.dimension = 4});
+    std::vector<float> wrong(5, 1.0f);
+    EXPECT_THROW(index.Upsert(1, wrong), memory::core::IndexException);
+    EXPECT_THROW(index.Search(wrong, 1), memory::core::IndexException);
+    std::vector<float> zero(4, 0.0f);
+    EXPECT_THROW(index.Upsert(1, zero), memory::core::IndexException);
+    EXPECT_EQ(index.nodeCount(), 0u);
+    EXPECT_THROW(HnswIndex(HnswOptions{.dimension = 0}), memory::core::IndexException);
+
+    // Zero vectors are fine where there is nothing to normalize
+    HnswIndex l2(HnswOptions{.dimension = 4, .metric = Metric::L2});
+    EXPECT_NO_THROW(l2.Upsert(1, zero));
+}
+
+TEST(HnswIndexTest, ConcurrentInsertsAndSearches) {
+    HnswIndex index(HnswOptions{.dimension = 24, .m = 12, .ef_construction = 100, .ef_search = 64});
+    auto data = randomVectors(4000, 24, 6);
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done.load()) {
+            for (const auto& r : index.Search(data[0], 5)) ASSERT_LT(r.id, data.size());
+        }
+    });
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < 4; ++t) {
+        writers.emplace_back([&, t] {
+            for (size_t i = t; i < data.size(); i += 4) index.Upsert(i, data[i]);
+        });
+    }
+    for (auto& w : writers) w.join();
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(index.size(), data.size());
+    auto queries = randomVectors(40, 24, 7);
+    EXPECT_GE(recallAt(index, data, queries, 10), 0.9);
+}
+
+TEST(HnswIndexTest, OptionsFromConfig) {
+    auto& config = memory::core::Config::getInstance();
+    HnswOptions defaults = HnswOptions::fromConfig(config);
+    EXPECT_EQ(defaults.dimension, 768u);
+    EXPECT_EQ(defaults.metric, Metric::COSINE);
+
+    config.set("dimension", "384");
+    config.set("hnsw_m", "24");
+    config.set("hnsw_ef_construction", "300");
+    config.set("hnsw_ef_search", "80");
+    config.set("distance_metric", "l2");
+    HnswOptions options = HnswOptions::fromConfig(config);
+    EXPECT_EQ(options.dimension, 384u);
+    EXPECT_EQ(options.m, 24u);
+    EXPECT_EQ(options.ef_construction, 300u);
+    EXPECT_EQ(options.ef_search, 80u);
+    EXPECT_EQ(options.metric, Metric::L2);
+}
+
+namespace {
+
+// Tenant i % 4, type i % 7, time i minutes after the epoch
+VectorAttributes attributesOf(size_t i) {
+    return VectorAttributes{"tenant" + std::to_string(i % 4), static_cast<memory::core::NodeType>(i % 7),
+                            memory::core::Timestamp{} + std::chrono::minutes(i)};
+}
+
+} // namespace
+
+TEST(HnswFilterTest, ResultsMatchFilterWithHighRecall) {
+    // Large enough that walking the graph beats scanning 3 / 28 of it
+    HnswIndex index(HnswOptions{.dimension = 24, .m = 12, .ef_construction = 100});
+    auto data = randomVectors(10000, 24, 8);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i], attributesOf(i));
+    auto queries = randomVectors(30, 24, 9);
+
+    VectorFilter filter;
+    filter.tenant = "tenant1";
+    filter.types = nodeTypeBit(memory::core::NodeType::FACT) | nodeTypeBit(memory::core::NodeType::TASK) |
+                   nodeTypeBit(memory::core::NodeType::META);
+    auto keep = [](size_t i) { return i % 4 == 1 && (i % 7 == 1 || i % 7 == 5 || i % 7 == 6); };
+    size_t hits = 0;
+    for (const auto& query : queries) {
+        FilteredSearchStats stats;
+        auto result = index.Search(query, 10, filter, 0, &stats);
+        EXPECT_FALSE(stats.scanned);
+        EXPECT_NEAR(stats.selectivity, 3.0 / 28, 0.04);
+        EXPECT_EQ(stats.ef, index.options().ef_search);
+        ASSERT_EQ(result.size(), 10u);
+        auto truth = exactTopK(data, query, Metric::COSINE, 10, keep);
+        std::set<NodeId> expected(truth.begin(), truth.end());
+        for (const auto& r : result) {
+            EXPECT_TRUE(keep(r.id)) << r.id;
+            hits += expected.count(r.id);
+        }
+    }
+    EXPECT_GE(hits, queries.size() * 10 * 9 / 10);
+}
+
+TEST(HnswFilterTest, SelectiveFilterScansExactly) {
+    HnswIndex index(HnswOptions{.dimension = 16});
+    auto data = randomVectors(3000, 16, 10);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i], attributesOf(i));
+
+    // One tenant, one type, first 1000 minutes: 1000 / 28 ~ 36 matches
+    VectorFilter filter;
+    filter.tenant = "tenant2";
+    filter.types = nodeTypeBit(memory::core::NodeType::EPISODE);
+    filter.until = memory::core::Timestamp{} + std::chrono::minutes(1000);
+    auto keep = [](size_t i) { return i % 4 == 2 && i % 7 == 0 && i < 1000; };
+    FilteredSearchStats stats;
+    auto result = index.Search(data[0], 5, filter, 0, &stats);
+    EXPECT_TRUE(stats.scanned);
+    EXPECT_LT(stats.selectivity, 0.02);
+    auto truth = exactTopK(data, data[0], Metric::COSINE, 5, keep);
+    ASSERT_EQ(result.size(), truth.size());
+    for (size_t i = 0; i < truth.size(); ++i) EXPECT_EQ(result[i].id, truth[i]);
+
+    // The window is half-open and removed vectors stay out
+    filter.since = memory::core::Timestamp{} + std::chrono::minutes(truth[0]);
+    filter.until = memory::core::Timestamp{} + std::chrono::minutes(truth[0] + 1);
+    result = index.Search(data[0], 5, filter);
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].id, truth[0]);
+    index.Remove(truth[0]);
+    EXPECT_TRUE(index.Search(data[0], 5, filter).empty());
+}
+
+TEST(HnswFilterTest, EdgeCases) {
+    HnswIndex index(HnswOptions{.dimension = 8});
+    auto data = randomVectors(200, 8, 11);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i], attributesOf(i));
+    index.Upsert(999, data[0]);  // No attributes: tenant "", untyped
+
+    VectorFilter unknown;
+    unknown.tenant = "nobody";
+    EXPECT_TRUE(index.Search(data[0], 5, unknown).empty());
+    VectorFilter no_types;
+    no_types.types = 0;
+    EXPECT_TRUE(index.Search(data[0], 5, no_types).empty());
+
+    // An empty filter is a plain search
+    auto plain = index.Search(data[0], 5);
+    auto filtered = index.Search(data[0], 5, VectorFilter{});
+    ASSERT_EQ(plain.size(), filtered.size());
+    for (size_t i = 0; i < plain.size(); ++i) EXPECT_EQ(plain[i].id, filtered[i].id);
+
+    // Untyped vectors pass tenant filters but not type filters
+    VectorFilter default_tenant;
+    default_tenant.tenant = "";
+    auto result = index.Search(data[0], 5, default_tenant);
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].id, 999u);
+    default_tenant.types = nodeTypeBit(memory::core::NodeType::EPISODE);
+    EXPECT_TRUE(index.Search(data[0], 5, default_tenant).empty());
+}
+
+TEST(HnswSegmentTest, OpenedIndexSearchesLikeTheSaved) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_hnsw_segment";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "index.hnsw").string();
+
+    HnswIndex index(HnswOptions{.dimension = 24, .m = 8, .ef_construction = 64});
+    auto data = randomVectors(3000, 24, 12);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i], attributesOf(i));
+    for (NodeId id = 0; id < 3000; id += 10) index.Remove(id);
+    index.save(path);
+
+    auto opened = HnswIndex::open(path);
+    EXPECT_EQ(opened->size(), index.size());
+    EXPECT_EQ(opened->nodeCount(), index.nodeCount());
+    EXPECT_EQ(opened->maxLevel(), index.maxLevel());
+    EXPECT_GT(opened->mappedBytes(), 0u);
+    EXPECT_LT(opened->memoryBytes(), index.memoryBytes() / 10);
+
+    VectorFilter filter;
+    filter.tenant = "tenant3";
+    auto queries = randomVectors(20, 24, 13);
+    for (const auto& query : queries) {
+        auto expected = index.Search(query, 10);
+        auto actual = opened->Search(query, 10);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i].id, expected[i].id);
+            EXPECT_EQ(actual[i].score, expected[i].score);
+            EXPECT_NE(actual[i].id % 10, 0u);
+        }
+        auto filtered = opened->Search(query, 5, filter);
+        ASSERT_EQ(filtered.size(), 5u);
+        for (const auto& r : filtered) EXPECT_EQ(r.id % 4, 3u);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(HnswSegmentTest, WritesAfterOpenStayOutOfTheFile) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_hnsw_segment_writes";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "index.hnsw").string();
+    auto data = randomVectors(6000, 16, 14);
+    {
+        HnswIndex index(HnswOptions{.dimension = 16, .m = 8, .ef_construction = 64});
+        for (size_t i = 0; i < 3000; ++i) index.Upsert(i, data[i]);
+        index.save(path);
+    }
+
+    // Inserts fill the mapped last block, then spill into heap blocks
+    auto opened = HnswIndex::open(path, HnswLoadOptions{.prefetch_upper_layers = false, .verify = true});
+    for (size_t i = 3000; i < 6000; ++i) opened->Upsert(i, data[i]);
+    opened->Remove(7);
+    EXPECT_EQ(opened->size(), 5999u);
+    EXPECT_EQ(opened->Search(data[5500], 1)[0].id, 5500u);
+    EXPECT_EQ(opened->Search(data[100], 1)[0].id, 100u);
+    EXPECT_NE(opened->Search(data[7], 1)[0].id, 7u);
+    std::string copy = (dir / "copy.hnsw").string();
+    opened->save(copy);
+
+    auto reopened = HnswIndex::open(path, HnswLoadOptions{.verify = true});
+    EXPECT_EQ(reopened->size(), 3000u);
+    EXPECT_EQ(reopened->Search(data[7], 1)[0].id, 7u);
+    auto copied = HnswIndex::open(copy);
+    EXPECT_EQ(copied->size(), 5999u);
+    EXPECT_EQ(copied->Search(data[5500], 1)[0].id, 5500u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(HnswSegmentTest, QuantizedAndDamagedFiles) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_hnsw_segment_sq8";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "index.hnsw").string();
+    auto data = randomVectors(1000, 32, 15);
+    {
+        HnswIndex index(HnswOptions{.dimension = 32, .quantization = Quantization::SQ8, .rerank = 20});
+        std::vector<float> samples;
+        for (size_t i = 0; i < 500; ++i) samples.insert(samples.end(), data[i].begin(), data[i].end());
+        index.train(samples);
+        for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i]);
+        index.save(path);
+    }
+    auto opened = HnswIndex::open(path, HnswLoadOptions{.ef_search = 80});
+    EXPECT_EQ(opened->options().quantization, Quantization::SQ8);
+    EXPECT_EQ(opened->options().ef_search, 80u);
+    EXPECT_TRUE(opened->trained());
+    for (size_t i = 0; i < data.size(); i += 97) EXPECT_EQ(opened->Search(data[i], 1)[0].id, i);
+    opened.reset();
+
+    EXPECT_THROW(HnswIndex::open((dir / "missing.hnsw").string()), memory::core::StorageException);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_THROW(HnswIndex::open(path), memory::core::StorageException);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(HnswWalTest, LogRebuildsUnsavedChanges) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_hnsw_wal";
+    std::filesystem::remove_all(dir);
+    HnswOptions options{.dimension = 16, .m = 8, .ef_construction = 64, .quantization = Quantization::SQ8,
+                        .rerank = 20};
+    auto data = randomVectors(800, 16, 16);
+    std::vector<float> samples;
+    for (size_t i = 0; i < 200; ++i) samples.insert(samples.end(), data[i].begin(), data[i].end());
+    {
+        auto wal = std::make_shared<memory::core::WriteAheadLog>(dir.string());
+        HnswIndex index(options);
+        index.attachWal(wal);
+        index.train(samples);
+        for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i], attributesOf(i));
+        for (NodeId id = 0; id < 800; id += 8) index.Remove(id);
+        index.Remove(5000);  // Unknown ids log nothing
+        EXPECT_EQ(wal->lastLsn(), 1u + 800 + 100);
+    }
+
+    auto wal = std::make_shared<memory::core::WriteAheadLog>(dir.string());
+    HnswIndex index(options);
+    index.attachWal(wal);
+    ASSERT_TRUE(index.trained());
+    EXPECT_EQ(index.size(), 700u);
+    VectorFilter filter;
+    filter.tenant = "tenant1";
+    filter.types = nodeTypeBit(memory::core::NodeType::EPISODE) | nodeTypeBit(memory::core::NodeType::FACT);
+    for (size_t i = 1; i < data.size(); i += 37) {
+        auto top = index.Search(data[i], 1);
+        ASSERT_EQ(top.size(), 1u);
+        if (i % 8 == 0) {
+            EXPECT_NE(top[0].id, i);
+        } else {
+            EXPECT_EQ(top[0].id, i);
+        }
+        for (const auto& r : index.Search(data[i], 5, filter)) {
+            EXPECT_EQ(r.id % 4, 1u);
+            EXPECT_LT(r.id % 7, 2u);
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(HnswSnapshotTest, PinnedSnapshotIgnoresLaterChanges) {
+    HnswOptions options{.dimension = 16, .m = 8, .ef_construction = 64};
+    auto data = randomVectors(400, 16, 23);
+    HnswIndex index(options);
+    for (size_t i = 0; i < 200; ++i) index.Upsert(i, data[i], attributesOf(i));
+    std::shared_ptr<const HnswSnapshot> pinned = index.snapshot();
+    EXPECT_EQ(pinned->nodes, 200u);
+
+    for (NodeId id = 0; id < 200; id += 4) index.Remove(id);
+    for (size_t i = 200; i < 400; ++i) index.Upsert(i, data[i], attributesOf(i));
+    index.Upsert(1, data[399]);  // Moves id 1 onto another vector
+    EXPECT_GT(index.snapshot()->version, pinned->version);
+
+    VectorFilter filter;
+    filter.tenant = "tenant1";
+    for (size_t i = 0; i < 200; i += 9) {
+        // Removed ids are still there, later inserts are not
+        auto top = index.Search(*pinned, data[i], 10, {}, 100);
+        ASSERT_FALSE(top.empty());
+        EXPECT_EQ(top[0].id, i);
+        for (const auto& r : top) EXPECT_LT(r.id, 200u);
+        for (const auto& r : index.Search(*pinned, data[i], 10, filter, 100)) {
+            EXPECT_LT(r.id, 200u);
+            EXPECT_EQ(r.id % 4, 1u);
+        }
+        auto current = index.Search(data[i], 1, 100);
+        ASSERT_EQ(current.size(), 1u);
+        if (i % 4 == 0) {
+            EXPECT_NE(current[0].id, i);
+        }
+    }
+    // The pinned snapshot still has id 1 on its old vector
+    EXPECT_EQ(index.Search(*pinned, data[1], 1, {}, 100)[0].id, 1u);
+    EXPECT_NE(index.Search(data[1], 1, 100)[0].id, 1u);
+}
+
+TEST(HnswSnapshotTest, PinnedViewNeverSeesAnInsertUnderWay) {
+    HnswIndex index(HnswOptions{.dimension = 16, .m = 8, .ef_construction = 64});
+    auto data = randomVectors(1500, 16, 31);
+    constexpr NodeId kMoving = 100000;
+    const std::vector<float>& moving = data[0];
+    index.Upsert(kMoving, moving, VectorAttributes{.tenant = "a"});
+
+    // One writer keeps replacing kMoving, flipping its tenant; the other
+    // publishes filler inserts while a replacement is still linking
+    std::atomic<bool> done{false};
+    std::thread replacer([&] {
+        for (int i = 1; !done; ++i) index.Upsert(kMoving, moving, VectorAttributes{.tenant = i % 2 ? "b" : "a"});
+    });
+    std::thread filler([&] {
+        for (size_t i = 1; i < data.size(); ++i) index.Upsert(i, data[i], VectorAttributes{.tenant = "filler"});
+        done = true;
+    });
+
+    VectorFilter in_a;
+    in_a.tenant = "a";
+    VectorFilter in_b;
+    in_b.tenant = "b";
+    auto has = [](const std::vector<memory::core::ScoredId>& results) {
+        return std::any_of(results.begin(), results.end(), [](const auto& r) { return r.id == kMoving; });
+    };
+    size_t views = 0;
+    while (!done || views == 0) {
+        std::shared_ptr<const HnswSnapshot> pinned = index.snapshot();
+        // Exactly one version of kMoving belongs to any published view
+        bool seen_a = has(index.Search(*pinned, moving, 5, in_a, 100));
+        bool seen_b = has(index.Search(*pinned, moving, 5, in_b, 100));
+        ASSERT_FALSE(seen_a && seen_b) << "view " << pinned->version;
+        ++views;
+    }
+    replacer.join();
+    filler.join();
+    EXPECT_EQ(index.size(), data.size());
+}
+
+TEST(HnswCompactionTest, UnlinksTombstonesAndKeepsRecall) {
+    HnswIndex index(HnswOptions{.dimension = 16, .m = 8, .ef_construction = 100, .ef_search = 64});
+    auto data = randomVectors(2000, 16, 11);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i]);
+    for (size_t i = 0; i < data.size(); i += 2) index.Remove(i);
+    EXPECT_NEAR(index.fragmentation(), 0.5, 1e-9);
+
+    memory::core::CompactionOptions options;
+    memory::core::RateLimiter unlimited;
+    ASSERT_TRUE(index.compactionDue(options));
+    memory::core::CompactionResult result = index.compact(options, unlimited);
+    EXPECT_EQ(result.target, "vector");
+    EXPECT_EQ(result.items_before, 2000u);
+    EXPECT_EQ(result.items_after, 1000u);
+    EXPECT_EQ(result.fragmentation_after, 0.0);
+    EXPECT_FALSE(index.compactionDue(options));
+
+    auto queries = randomVectors(50, 16, 12);
+    size_t hits = 0;
+    for (const auto& query : queries) {
+        auto truth = exactTopK(data, query, index.options().metric, 10, [](size_t i) { return i % 2 == 1; });
+        std::set<NodeId> expected(truth.begin(), truth.end());
+        for (const auto& found : index.Search(query, 10)) {
+            EXPECT_EQ(found.id % 2, 1u);
+            hits += expected.count(found.id);
+        }
+    }
+    EXPECT_GE(static_cast<double>(hits) / (queries.size() * 10), 0.9);
+    // Inserting still links into the repaired graph
+    index.Upsert(0, data[0]);
+    EXPECT_EQ(index.Search(data[0], 1)[0].id, 0u);
+}
+
+TEST(HnswCompactionTest, PinnedSnapshotDefersUnlinking) {
+    HnswIndex index(HnswOptions{.dimension = 8, .m = 8});
+    auto data = randomVectors(200, 8, 13);
+    for (size_t i = 0; i < data.size(); ++i) index.Upsert(i, data[i]);
+    auto pinned = index.snapshot();
+    for (size_t i = 0; i < 100; ++i) index.Remove(i);
+
+    memory::core::CompactionOptions options;
+    memory::core::RateLimiter unlimited;
+    // Still visible to the pinned snapshot, so still linked
+    EXPECT_EQ(index.compact(options, unlimited).items_after, 200u);
+    EXPECT_EQ(index.Search(*pinned, data[5], 1)[0].id, 5u);
+    pinned.reset();
+    EXPECT_EQ(index.compact(options, unlimited).items_after, 100u);
+    EXPECT_EQ(index.fragmentation(), 0.0);
+}
+
+TEST(HnswCompactionTest, CompactsWhileInsertingAndSearching) {
+    HnswIndex index(HnswOptions{.dimension = 16, .m = 8, .ef_construction = 64});
+    auto data = randomVectors(3000, 16, 14);
+    for (size_t i = 0; i < 1000; ++i) index.Upsert(i, data[i]);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (size_t i = 1000; i < data.size(); ++i) {
+            index.Upsert(i, data[i]);
+            index.Remove(i - 1000);
+        }
+        done = true;
+    });
+    memory::core::CompactionOptions options;
+    memory::core::RateLimiter unlimited;
+    size_t searches = 0;
+    while (!done) {
+        index.compact(options, unlimited);
+        for (const auto& found : index.Search(data[searches % data.size()], 5)) {
+            EXPECT_LT(found.id, data.size());
+        }
+        ++searches;
+    }
+    writer.join();
+    index.compact(options, unlimited);
+
+    EXPECT_EQ(index.size(), 1000u);
+    auto queries = randomVectors(30, 16, 15);
+    size_t hits = 0;
+    for (const auto& query : queries) {
+        auto truth = exactTopK(data, query, index.options().metric, 10, [](size_t i) { return i >= 2000; });
+        std::set<NodeId> expected(truth.begin(), truth.end());
+        for (const auto& found : index.Search(query, 10)) {
+            EXPECT_GE(found.id, 2000u);
+            hits += expected.count(found.id);
+        }
+    }
+    EXPECT_GE(static_cast<double>(hits) / (queries.size() * 10), 0.85);
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include "memory/core/errors.h"
+#include "memory/core/manifest.h"
+#include "memory/core/mapped_file.h"
+#include "memory/core/wal.h"
+#include "memory/graph/csr_graph_store.h"
+#include "memory/search/inverted_index.h"
+#include "memory/vector/hnsw_index.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace memory::core;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path freshDirectory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+void touch(const fs::path& path) {
+    std::ofstream(path) << "segment";
+}
+
+Edge edge(NodeId src, NodeId dst, EdgeType type) {
+    Edge e{};
+    e.src = src;
+    e.dst = dst;
+    e.type = type;
+    return e;
+}
+
+std::vector<float> vectorOf(uint64_t id) {
+    std::mt19937 rng(static_cast<uint32_t>(id));
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> v(8);
+    for (float& x : v) x = dist(rng);
+    return v;
+}
+
+} // namespace
+
+TEST(ManifestTest, SaveLoadRoundTrip) {
+    fs::path dir = freshDirectory("memory_test_manifest_round_trip");
+    EXPECT_FALSE(Manifest::load(dir.string()));
+
+    Manifest manifest;
+    manifest.version = 7;
+    manifest.lsn = 12345;
+    manifest.files = {{WalStream::SEARCH, "segment_0.tdic"},
+                      {WalStream::GRAPH, "graph_3.csr"},
+                      {WalStream::VECTOR, "vectors_2.hnsw"},
+                      {WalStream::SEARCH, "segment_1.tdic"}};
+    manifest.save(dir.string());
+
+    auto loaded = Manifest::load(dir.string());
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->version, 7u);
+    EXPECT_EQ(loaded->lsn, 12345u);
+    ASSERT_EQ(loaded->files.size(), 4u);
+    EXPECT_EQ(loaded->files[2].engine, WalStream::VECTOR);
+    EXPECT_EQ(loaded->files[2].name, "vectors_2.hnsw");
+    EXPECT_EQ(loaded->filesOf(WalStream::SEARCH), (std::vector<std::string>{"segment_0.tdic", "segment_1.tdic"}));
+    fs::remove_all(dir);
+}
+
+TEST(ManifestTest, DamagedManifestThrows) {
+    fs::path dir = freshDirectory("memory_test_manifest_damaged");
+    Manifest manifest;
+    manifest.version = 1;
+    manifest.files = {{WalStream::GRAPH, "graph_0.csr"}};
+    manifest.save(dir.string());
+
+    fs::path path = dir / "MANIFEST";
+    std::vector<uint8_t> image;
+    {
+        MappedFile file = MappedFile::open(path.string());
+        image.assign(file.bytes().begin(), file.bytes().end());
+    }
+    image.back() ^= 0x01;
+    writeFileAtomically(path.string(), image);
+    EXPECT_THROW(Manifest::load(dir.string()), StorageException);
+    fs::remove_all(dir);
+}
+
+TEST(VersionSetTest, CheckpointReplacesManifestAndReleasesLog) {
+    fs::path dir = freshDirectory("memory_test_version_set");
+    auto wal = std::make_shared<WriteAheadLog>((dir / "wal").string(), WalOptions{.segment_bytes = 256});
+    std::vector<uint8_t> payload(64, 1);
+    for (int i = 0; i < 40; ++i) wal->write(WalStream::SEARCH, 1, payload);
+    size_t segments = wal->segmentCount();
+    ASSERT_GT(segments, 4u);
+
+    touch(dir / "a.seg");
+    touch(dir / "b.seg");
+    touch(dir / "c.seg");
+    {
+        VersionSet versions(dir.string());
+        EXPECT_FALSE(versions.manifest());
+        Manifest first = versions.checkpoint(20, {{WalStream::SEARCH, "a.seg"}, {WalStream::GRAPH, "b.seg"}},
+                                             wal.get());
+        EXPECT_EQ(first.version, 1u);
+        EXPECT_LT(wal->segmentCount(), segments);
+
+        // b.seg is no longer listed and goes; a.seg stays
+        versions.checkpoint(40, {{WalStream::SEARCH, "a.seg"}, {WalStream::VECTOR, "c.seg"}}, wal.get());
+        EXPECT_TRUE(fs::exists(dir / "a.seg"));
+        EXPECT_FALSE(fs::exists(dir / "b.seg"));
+        EXPECT_EQ(wal->segmentCount(), 1u);
+    }
+
+    // A restart picks up the last manifest, and the log after its LSN
+    VersionSet versions(dir.string());
+    auto manifest = versions.manifest();
+    ASSERT_TRUE(manifest);
+    EXPECT_EQ(manifest->version, 2u);
+    EXPECT_EQ(manifest->lsn, 40u);
+    EXPECT_EQ(manifest->filesOf(WalStream::VECTOR), std::vector<std::string>{"c.seg"});
+    EXPECT_THROW(VersionSet().checkpoint(1, {}), StorageException);
+    fs::remove_all(dir);
+}
+
+TEST(StoreViewTest, PinnedViewSpansAllEngines) {
+    auto versions = std::make_shared<VersionSet>();
+    memory::search::InvertedIndex search;
+    memory::graph::GraphStoreOptions graph_options;
+    graph_options.background_merge = false;
+    memory::graph::CsrGraphStore graph(graph_options);
+    memory::vector::HnswIndex vectors(memory::vector::HnswOptions{.dimension = 8, .m = 8});
+    search.attachVersions(versions);
+    graph.attachVersions(versions);
+    vectors.attachVersions(versions);
+
+    for (uint64_t id = 1; id <= 20; ++id) {
+        search.Upsert(id, "会议 记录");
+        graph.AddEdge(edge(id, id + 1, EdgeType::TEMPORAL_NEXT));
+        vectors.Upsert(id, vectorOf(id));
+    }
+    search.Flush();
+    graph.Flush();
+
+    std::shared_ptr<const StoreView> view = versions->current();
+    ASSERT_TRUE(view->search && view->graph && view->vector);
+    uint64_t version = view->version;
+
+    // Changes after the pin, in every engine
+    for (uint64_t id = 1; id <= 20; id += 2) {
+        search.Remove(id);
+        graph.RemoveEdge(id, id + 1, EdgeType::TEMPORAL_NEXT);
+        vectors.Remove(id);
+    }
+    search.Flush();
+    graph.Compact();
+    EXPECT_GT(versions->version(), version);
+
+    EXPECT_EQ(search.Search(*view->search, "会议", 50).size(), 20u);
+    EXPECT_EQ(search.Search("会议", 50).size(), 10u);
+    NodeId seed = 1;
+    EXPECT_EQ(graph.KHopSeeds(*view->graph, std::span(&seed, 1), 3).size(), 4u);
+    EXPECT_EQ(graph.KHopSeeds(std::span(&seed, 1), 3).size(), 1u);
+    EXPECT_EQ(vectors.Search(*view->vector, vectorOf(1), 1)[0].id, 1u);
+    EXPECT_NE(vectors.Search(vectorOf(1), 1)[0].id, 1u);
+    EXPECT_EQ(view->version, version);
+}
+
+TEST(StoreViewTest, ConcurrentWritersNeverTearAView) {
+    auto versions = std::make_shared<VersionSet>();
+    memory::search::SearchIndexOptions search_options;
+    search_options.max_buffered_docs = 1;
+    memory::search::InvertedIndex search(search_options);
+    // The hub outgrows the default degree cap; a background merge would
+    // then spill some of its edges out of reach of KHopSeeds
+    memory::graph::GraphStoreOptions graph_options;
+    graph_options.caps = memory::graph::DegreeCaps::unlimited();
+    memory::graph::CsrGraphStore graph(graph_options);
+    memory::vector::HnswIndex vectors(memory::vector::HnswOptions{.dimension = 8, .m = 8, .ef_construction = 32});
+    search.attachVersions(versions);
+    graph.attachVersions(versions);
+    vectors.attachVersions(versions);
+
+    constexpr uint64_t kWrites = 300;
+    std::atomic<int> running{3};
+    std::vector<std::thread> writers;
+    writers.emplace_back([&] {
+        for (uint64_t id = 1; id <= kWrites; ++id) search.Upsert(id, "会议");
+        --running;
+    });
+    writers.emplace_back([&] {
+        for (uint64_t id = 1; id <= kWrites; ++id) {
+            graph.AddEdge(edge(0, id, EdgeType::MENTIONS));
+            graph.Flush();
+        }
+        --running;
+    });
+    writers.emplace_back([&] {
+        for (uint64_t id = 1; id <= kWrites; ++id) vectors.Upsert(id, vectorOf(id));
+        --running;
+    });
+
+    uint64_t last_version = 0;
+    size_t views = 0;
+    while (running > 0 || views == 0) {
+        std::shared_ptr<const StoreView> view = versions->current();
+        EXPECT_GE(view->version, last_version);
+        last_version = view->version;
+        // Each part answers the same way however often it is asked
+        auto docs = search.MatchAny(*view->search, "会议");
+        EXPECT_EQ(docs.size(), view->search->live_docs);
+        NodeId hub = 0;
+        auto hops = graph.KHopSeeds(*view->graph, std::span(&hub, 1), 1);
+        EXPECT_EQ(hops.size(), view->graph->nodeCount());
+        auto nearest = vectors.Search(*view->vector, vectorOf(1), 400, {}, 400);
+        EXPECT_LE(nearest.size(), view->vector->nodes);
+        EXPECT_EQ(search.MatchAny(*view->search, "会议"), docs);
+        EXPECT_EQ(graph.KHopSeeds(*view->graph, std::span(&hub, 1), 1).size(), hops.size());
+        ++views;
+    }
+    for (auto& writer : writers) writer.join();
+
+    auto view = versions->current();
+    EXPECT_EQ(search.MatchAny(*view->search, "会议").size(), kWrites);
+    EXPECT_EQ(view->graph->nodeCount(), kWrites + 1);
+    EXPECT_EQ(view->vector->nodes, kWrites);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "memory/core/errors.h"
+#include "memory/core/node_store.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace memory::core;
+
+namespace {
+
+std::string numbered(const char* prefix, uint64_t n) {
+    std::string result = prefix;
+    result += std::to_string(n);
+    return result;
+}
+
+Node makeNode(NodeId id, NodeType type, const std::string& text, const std::string& tenant = "t1") {
+    Node node;
+    node.id = id;
+    node.type = type;
+    node.title = numbered("title ", id);
+    node.text = text;
+    node.keywords = {numbered("k", id % 3), "shared"};
+    node.entities = {numbered("e", id % 5)};
+    node.importance = 0.1f * static_cast<float>(id % 10);
+    node.confidence = 0.9f;
+    node.recency = Timestamp(std::chrono::milliseconds(1700000000000LL + static_cast<int64_t>(id)));
+    node.frequency = static_cast<int>(id);
+    node.tenant_id = tenant;
+    return node;
+}
+
+void expectSame(const Node& a, const Node& b) {
+    EXPECT_EQ(a.id, b.id);
+    EXPECT_EQ(a.type, b.type);
+    EXPECT_EQ(a.title, b.title);
+    EXPECT_EQ(a.text, b.text);
+    EXPECT_EQ(a.keywords, b.keywords);
+    EXPECT_EQ(a.entities, b.entities);
+    EXPECT_FLOAT_EQ(a.importance, b.importance);
+    EXPECT_FLOAT_EQ(a.confidence, b.confidence);
+    EXPECT_EQ(a.recency, b.recency);
+    EXPECT_EQ(a.frequency, b.frequency);
+    EXPECT_EQ(a.tenant_id, b.tenant_id);
+    EXPECT_EQ(a.metadata, b.metadata);
+}
+
+} // namespace
+
+TEST(NodeStoreTest, RoundTripsNodes) {
+    NodeStore store;
+    Node fact = makeNode(42, NodeType::FACT, "用户喜欢蓝牙耳机");
+    fact.metadata = {{"source", "chat"}, {"lang", "zh"}};
+    Node episode = makeNode(7, NodeType::EPISODE, "", "t2");
+    episode.keywords.clear();
+
+    EXPECT_EQ(store.upsert(fact), 0u);
+    EXPECT_EQ(store.upsert(episode), 1u);
+    EXPECT_EQ(store.liveCount(), 2u);
+
+    auto view = store.get(42);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->title(), "title 42");
+    EXPECT_EQ(view->text(), "用户喜欢蓝牙耳机");
+    EXPECT_EQ(view->keywordIds().size(), 2u);
+    EXPECT_EQ(store.label(view->keywordIds()[1]), "shared");
+    EXPECT_EQ(view->tenant(), "t1");
+    ASSERT_NE(view->metadata(), nullptr);
+    EXPECT_EQ(view->metadata()->at("source"), "chat");
+    expectSame(view->materialize(), fact);
+    expectSame(store.view(1).materialize(), episode);
+    EXPECT_EQ(store.view(1).metadata(), nullptr);
+    EXPECT_FALSE(store.get(8).has_value());
+}
+
+TEST(NodeStoreTest, ColumnsAndOrdinals) {
+    NodeStore store;
+    for (NodeId id = 0; id < 100; ++id) {
+        store.upsert(makeNode(id, id % 2 ? NodeType::FACT : NodeType::CONCEPT, "text", id < 30 ? "a" : "b"));
+    }
+    ASSERT_EQ(store.importance().size(), 100u);
+    EXPECT_EQ(store.types()[3], NodeType::FACT);
+    EXPECT_FLOAT_EQ(store.importance()[13], 0.3f);
+    EXPECT_EQ(store.recencyMillis()[5], 1700000000005LL);
+    EXPECT_EQ(store.frequency()[99], 99u);
+
+    uint32_t tenant_a = store.tenantOrdinal("a");
+    EXPECT_NE(store.tenantOrdinal("b"), tenant_a);
+    EXPECT_EQ(store.tenantOrdinal("missing"), StringInterner::kUnknownId);
+    size_t in_a = 0;
+    for (uint32_t tenant : store.tenants()) in_a += tenant == tenant_a;
+    EXPECT_EQ(in_a, 30u);
+
+    // Keywords and entities share one ID space
+    uint32_t shared = store.labelId("shared");
+    ASSERT_NE(shared, StringInterner::kUnknownId);
+    EXPECT_EQ(store.view(50).keywordIds()[1], shared);
+    EXPECT_EQ(store.label(store.view(4).entityIds()[0]), "e4");
+}
+
+TEST(StringInternerTest, EmptyStringFirst) {
+    StringInterner interner;
+    EXPECT_EQ(interner.intern(""), 0u);
+    EXPECT_EQ(interner.intern("a"), 1u);
+    EXPECT_EQ(interner.find(""), 0u);
+    EXPECT_EQ(interner.str(1), "a");
+}
+
+TEST(NodeStoreTest, UpsertEraseAndCompact) {
+    NodeStore store;
+    for (NodeId id = 0; id < 10; ++id) store.upsert(makeNode(id, NodeType::FACT, std::string(100, 'x')));
+    EXPECT_EQ(store.garbageBytes(), 0u);
+
+    // Replacing keeps the index and leaves the old strings as garbage
+    Node updated = makeNode(3, NodeType::CONCEPT, "short");
+    updated.metadata = {{"v", "2"}};
+    EXPECT_EQ(store.upsert(updated), 3u);
+    EXPECT_GT(store.garbageBytes(), 100u);
+    expectSame(store.view(3).materialize(), updated);
+
+    EXPECT_TRUE(store.erase(5));
+    EXPECT_FALSE(store.erase(5));
+    EXPECT_FALSE(store.live(5));
+    EXPECT_EQ(store.size(), 10u);
+    EXPECT_EQ(store.liveCount(), 9u);
+    EXPECT_FALSE(store.find(5).has_value());
+
+    size_t before = store.memoryBytes();
+    store.compact();
+    EXPECT_EQ(store.garbageBytes(), 0u);
+    EXPECT_EQ(store.size(), 9u);
+    EXPECT_LT(store.memoryBytes(), before);
+    EXPECT_EQ(*store.find(6), 5u);  // Renumbered
+    expectSame(store.get(3)->materialize(), updated);
+    for (NodeId id : {0, 1, 2, 4, 6, 7, 8, 9}) {
+        expectSame(store.get(id)->materialize(), makeNode(id, NodeType::FACT, std::string(100, 'x')));
+    }
+
+    // An erased ID comes back with a new index
+    EXPECT_EQ(store.upsert(makeNode(5, NodeType::TASK, "back")), 9u);
+    EXPECT_EQ(store.get(5)->type(), NodeType::TASK);
+}
+
+TEST(NodeStoreTest, MatchesModelUnderRandomWrites) {
+    std::mt19937 rng(3);
+    NodeStore store;
+    std::unordered_map<NodeId, Node> model;
+    for (int step = 0; step < 5000; ++step) {
+        NodeId id = rng() % 300;
+        if (rng() % 5 == 0) {
+            EXPECT_EQ(store.erase(id), model.erase(id) > 0);
+        } else {
+            Node node = makeNode(id, static_cast<NodeType>(rng() % 7), std::string(rng() % 50, 'a' + rng() % 26),
+                                 numbered("t", rng() % 4));
+            if (rng() % 3 == 0) node.metadata = {{"step", std::to_string(step)}};
+            store.upsert(node);
+            model[id] = node;
+        }
+        if (step % 1000 == 999) store.compact();
+    }
+    EXPECT_EQ(store.liveCount(), model.size());
+    for (const auto& [id, node] : model) {
+        auto view = store.get(id);
+        ASSERT_TRUE(view.has_value());
+        expectSame(view->materialize(), node);
+    }
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "memory/search/inverted_index.h"
+#include "memory/search/query_parser.h"
+#include "memory/core/errors.h"
+
+using namespace memory::search;
+
+TEST(QueryParserTest, PhrasesProximityAndPrefixes) {
+    StandardTokenizer tokenizer;
+    auto expand = [](std::string_view prefix) {
+        return std::vector<std::string>{std::string(prefix) + "1", std::string(prefix) + "2"};
+    };
+
+    ParsedQuery query = parseQuery(R"(driver "blue screen"~3 "the kernel panic" win*)", tokenizer, expand);
+    ASSERT_EQ(query.terms.size(), 2u);
+    EXPECT_EQ(query.terms[0].terms, std::vector<std::string>{"driver"});
+    EXPECT_EQ(query.terms[1].terms, (std::vector<std::string>{"win1", "win2"}));
+
+    ASSERT_EQ(query.phrases.size(), 2u);
+    EXPECT_EQ(query.phrases[0].terms, (std::vector<std::string>{"blue", "screen"}));
+    EXPECT_EQ(query.phrases[0].slop, 3u);
+    // The leading stopword is dropped
+    EXPECT_EQ(query.phrases[1].terms, (std::vector<std::string>{"kernel", "panic"}));
+    EXPECT_EQ(query.phrases[1].offsets, (std::vector<uint32_t>{0, 1}));
+    EXPECT_EQ(parseQuery(R"("kernel of panic")", tokenizer, expand).phrases[0].offsets,
+              (std::vector<uint32_t>{0, 2}));
+    EXPECT_EQ(query.phrases[1].slop, 0u);
+
+    // A one-token phrase is a plain term; an open quote runs to the end
+    query = parseQuery(R"("bluetooth" "unterminated quote)", tokenizer, expand);
+    EXPECT_EQ(query.terms.size(), 1u);
+    ASSERT_EQ(query.phrases.size(), 1u);
+    EXPECT_EQ(query.phrases[0].terms, (std::vector<std::string>{"unterminated", "quote"}));
+}
+
+class PhraseQueryTest : public ::testing::Test {
+protected:
+    static SearchIndexOptions positional() {
+        SearchIndexOptions options;
+        options.index_positions = true;
+        return options;
+    }
+
+    void SetUp() override {
+        index_.Upsert(1, "Install failed with error 0x80070005 access denied");
+        index_.Upsert(2, "access to the share was denied, error 0x80070005 logged");
+        index_.Upsert(3, "Denied access: retry returned 0x80004005");
+        index_.Upsert(4, R"(Driver missing from C:\Windows\System32\drivers\bthusb.sys)");
+        index_.Upsert(5, R"(C:\Windows\Temp is full; System32 drivers unaffected)");
+        index_.Upsert(6, "蓝牙 耳机 连接 断开, 蓝牙耳机 无声");
+        index_.Flush();
+    }
+
+    static std::vector<uint64_t> ids(const std::vector<memory::core::ScoredId>& results) {
+        std::vector<uint64_t> out;
+        for (const auto& r : results) out.push_back(r.id);
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    InvertedIndex index_{positional()};
+};
+
+TEST_F(PhraseQueryTest, ExactPhraseRequiresAdjacency) {
+    EXPECT_EQ(ids(index_.Search(R"("access denied")", 10)), std::vector<uint64_t>{1});
+    EXPECT_EQ(ids(index_.Search(R"("denied access")", 10)), std::vector<uint64_t>{3});
+    EXPECT_EQ(ids(index_.Search(R"("error 0x80070005")", 10)), (std::vector<uint64_t>{1, 2}));
+    EXPECT_TRUE(index_.Search(R"("error 0x80004005")", 10).empty());
+}
+
+TEST_F(PhraseQueryTest, PathPhraseMatchesWholePath) {
+    EXPECT_EQ(ids(index_.Search(R"("C:\Windows\System32\drivers")", 10)), std::vector<uint64_t>{4});
+    EXPECT_EQ(index_.MatchAny(R"("windows system32")"), std::vector<uint64_t>{4});
+    // Bag of words also hits the near miss
+    EXPECT_EQ(ids(index_.Search(R"(C:\Windows\System32\drivers)", 10)), (std::vector<uint64_t>{4, 5}));
+}
+
+TEST_F(PhraseQueryTest, ProximityAllowsSlop) {
+    // Doc 2 has four tokens in between (stopwords keep their slots); the
+    // swapped order of doc 3 costs two moves, as in Lucene
+    EXPECT_EQ(ids(index_.Search(R"("access denied"~1)", 10)), std::vector<uint64_t>{1});
+    EXPECT_EQ(ids(index_.Search(R"("access denied"~2)", 10)), (std::vector<uint64_t>{1, 3}));
+    EXPECT_EQ(ids(index_.Search(R"("access denied"~3)", 10)), (std::vector<uint64_t>{1, 3}));
+    EXPECT_EQ(ids(index_.Search(R"("access denied"~4)", 10)), (std::vector<uint64_t>{1, 2, 3}));
+}
+
+TEST_F(PhraseQueryTest, PhraseCombinesWithTerms) {
+    // Phrases are required, plain terms only add to the score
+    auto results = index_.Search(R"("error 0x80070005" install)", 10);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].id, 1u);
+    EXPECT_GT(results[0].score, results[1].score);
+
+    EXPECT_EQ(index_.MatchAll(R"("error 0x80070005" logged)"), std::vector<uint64_t>{2});
+    EXPECT_EQ(index_.MatchAny(R"("error 0x80070005" logged)"), (std::vector<uint64_t>{1, 2}));
+    EXPECT_EQ(index_.MatchAll(R"("蓝牙 耳机" 无声)"), std::vector<uint64_t>{6});
+}
+
+TEST_F(PhraseQueryTest, RepeatedPhraseScoresHigher) {
+    index_.Upsert(7, "blue screen once");
+    index_.Upsert(8, "blue screen, blue screen again");
+    index_.Flush();
+    auto results = index_.Search(R"("blue screen")", 10);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].id, 8u);
+
+    index_.Remove(8);
+    EXPECT_EQ(ids(index_.Search(R"("blue screen")", 10)), std::vector<uint64_t>{7});
+}
+
+TEST(PhraseQueryOptionsTest, PhraseNeedsPositions) {
+    InvertedIndex index;
+    index.Upsert(1, "access denied");
+    index.Flush();
+    EXPECT_THROW(index.Search(R"("access denied")", 10), memory::core::QueryException);
+    // Bag-of-words queries still work
+    EXPECT_EQ(index.Search("access denied", 10).size(), 1u);
+}
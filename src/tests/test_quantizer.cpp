@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/vector/hnsw_index.h"
+#include "memory/vector/quantizer.h"
+#include <cmath>
+#include <random>
+#include <set>
+
+using namespace memory::vector;
+using memory::core::NodeId;
+
+namespace {
+
+// Rows of dimension floats clustered around a few centers, so PQ has
+// structure to learn
+std::vector<float> clusteredRows(size_t count, size_t dimension, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<float> centers(8 * dimension);
+    std::mt19937 layout(99);
+    for (float& x : centers) x = gauss(layout);
+    std::vector<float> rows(count * dimension);
+    for (size_t i = 0; i < count; ++i) {
+        const float* center = centers.data() + (rng() % 8) * dimension;
+        for (size_t d = 0; d < dimension; ++d) rows[i * dimension + d] = center[d] + 0.3f * gauss(rng);
+    }
+    return rows;
+}
+
+// Low-rank rows like real embeddings: Gaussian points in a small latent
+// space projected up, plus a little noise
+std::vector<float> embeddingRows(size_t count, size_t dimension, uint32_t seed) {
+    const size_t latent = 12;
+    std::mt19937 layout(98);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<float> projection(latent * dimension);
+    for (float& x : projection) x = gauss(layout);
+    std::mt19937 rng(seed);
+    std::vector<float> rows(count * dimension);
+    for (size_t i = 0; i < count; ++i) {
+        float* out = rows.data() + i * dimension;
+        for (size_t d = 0; d < dimension; ++d) out[d] = 0.1f * gauss(rng);
+        for (size_t j = 0; j < latent; ++j) {
+            float weight = gauss(rng);
+            for (size_t d = 0; d < dimension; ++d) out[d] += weight * projection[j * dimension + d];
+        }
+    }
+    return rows;
+}
+
+void normalizeRows(std::vector<float>& rows, size_t dimension) {
+    for (size_t offset = 0; offset < rows.size(); offset += dimension) {
+        double norm = 0;
+        for (size_t d = 0; d < dimension; ++d) norm += double(rows[offset + d]) * rows[offset + d];
+        for (size_t d = 0; d < dimension; ++d) rows[offset + d] = static_cast<float>(rows[offset + d] / std::sqrt(norm));
+    }
+}
+
+std::span<const float> row(const std::vector<float>& rows, size_t i, size_t dimension) {
+    return std::span<const float>(rows).subspan(i * dimension, dimension);
+}
+
+double recallAt(const HnswIndex& index, const std::vector<float>& data, const std::vector<float>& queries,
+                size_t dimension, size_t k) {
+    size_t count = data.size() / dimension;
+    size_t hits = 0;
+    size_t total = 0;
+    for (size_t q = 0; q < queries.size() / dimension; ++q) {
+        std::vector<std::pair<float, NodeId>> scored;
+        for (size_t i = 0; i < count; ++i) {
+            float dot = 0;
+            for (size_t d = 0; d < dimension; ++d) dot += queries[q * dimension + d] * data[i * dimension + d];
+            scored.emplace_back(-dot, i);
+        }
+        std::partial_sort(scored.begin(), scored.begin() + k, scored.end());
+        std::set<NodeId> truth;
+        for (size_t i = 0; i < k; ++i) truth.insert(scored[i].second);
+        for (const auto& r : index.Search(row(queries, q, dimension), k)) hits += truth.count(r.id);
+        total += k;
+    }
+    return static_cast<double>(hits) / static_cast<double>(total);
+}
+
+} // namespace
+
+TEST(QuantizerTest, NamesRoundTrip) {
+    for (Quantization q : {Quantization::NONE, Quantization::SQ8, Quantization::PQ}) {
+        EXPECT_EQ(stringToQuantization(quantizationToString(q)), q);
+    }
+    EXPECT_THROW(stringToQuantization("int4"), std::invalid_argument);
+    EXPECT_EQ(makeQuantizer(Quantization::NONE, Metric::L2, distanceKernels()), nullptr);
+}
+
+TEST(QuantizerTest, Sq8ReconstructsWithinOneStep) {
+    const size_t dim = 32;
+    auto rows = clusteredRows(500, dim, 1);
+    ScalarQuantizer sq(Metric::L2, distanceKernels());
+    EXPECT_FALSE(sq.trained());
+    sq.train(rows, dim);
+    ASSERT_TRUE(sq.trained());
+    EXPECT_EQ(sq.codeSize(), dim);
+
+    std::vector<uint8_t> code(dim);
+    std::vector<float> decoded(dim);
+    for (size_t i = 0; i < 500; i += 50) {
+        sq.encode(&rows[i * dim], code.data());
+        sq.decode(code.data(), decoded.data());
+        for (size_t d = 0; d < dim; ++d) {
+            // Half a quantization step: range / 255 / 2, ranges are < 10 here
+            EXPECT_NEAR(decoded[d], rows[i * dim + d], 10.0f / 255 / 2 + 1e-5f);
+        }
+    }
+    // Out-of-range values clamp instead of wrapping
+    std::vector<float> extreme(dim, 1e6f);
+    sq.encode(extreme.data(), code.data());
+    for (uint8_t c : code) EXPECT_EQ(c, 255);
+    EXPECT_THROW(sq.train(std::span<const float>(rows).first(dim + 1), dim), memory::core::IndexException);
+}
+
+TEST(QuantizerTest, AsymmetricDistanceMatchesDecoded) {
+    const size_t dim = 64;
+    auto rows = clusteredRows(1000, dim, 2);
+    normalizeRows(rows, dim);
+    const DistanceKernels& kernels = distanceKernels();
+    for (Metric metric : {Metric::COSINE, Metric::L2}) {
+        std::vector<std::unique_ptr<Quantizer>> quantizers;
+        quantizers.push_back(std::make_unique<ScalarQuantizer>(metric, kernels));
+        quantizers.push_back(std::make_unique<ProductQuantizer>(metric, kernels,
+                                                                ProductQuantizerOptions{.subspaces = 8}));
+        for (auto& quantizer : quantizers) {
+            quantizer->train(rows, dim);
+            std::vector<uint8_t> code(quantizer->codeSize());
+            std::vector<float> decoded(dim);
+            QueryTable table;
+            quantizer->prepareQuery(&rows[0], table);
+            for (size_t i = 1; i < 1000; i += 97) {
+                quantizer->encode(&rows[i * dim], code.data());
+                quantizer->decode(code.data(), decoded.data());
+                float expected = metricDistance(kernels, metric, &rows[0], decoded.data(), dim);
+                EXPECT_NEAR(quantizer->distance(table, code.data()), expected, 1e-3f)
+                    << metricToString(metric) << " " << quantizer->codeSize();
+            }
+        }
+    }
+}
+
+TEST(QuantizerTest, PqLearnsClusters) {
+    const size_t dim = 32;
+    auto rows = clusteredRows(2000, dim, 3);
+    ProductQuantizer pq(Metric::L2, distanceKernels(), ProductQuantizerOptions{.subspaces = 4});
+    pq.train(rows, dim);
+    EXPECT_EQ(pq.codeSize(), 4u);
+
+    // Mean squared reconstruction error well below the noise energy per
+    // row (32 x 0.3^2 = 2.9), let alone the spread of the centers
+    std::vector<uint8_t> code(4);
+    std::vector<float> decoded(dim);
+    double error = 0;
+    for (size_t i = 0; i < 2000; ++i) {
+        pq.encode(&rows[i * dim], code.data());
+        pq.decode(code.data(), decoded.data());
+        error += distanceKernels().l2_squared(&rows[i * dim], decoded.data(), dim);
+    }
+    EXPECT_LT(error / 2000, 2.0);
+
+    ProductQuantizer odd(Metric::L2, distanceKernels(), ProductQuantizerOptions{.subspaces = 5});
+    EXPECT_THROW(odd.train(rows, dim), memory::core::IndexException);
+    // Fewer samples than centroids still trains
+    ProductQuantizer tiny(Metric::L2, distanceKernels(), ProductQuantizerOptions{.subspaces = 4});
+    tiny.train(std::span<const float>(rows).first(10 * dim), dim);
+    EXPECT_TRUE(tiny.trained());
+}
+
+TEST(QuantizedHnswTest, RequiresTraining) {
+    HnswIndex index(HnswOptions{.dimension = 16, .quantization = Quantization::SQ8});
+    std::vector<float> vec(16, 1.0f);
+    EXPECT_FALSE(index.trained());
+    EXPECT_THROW(index.Upsert(1, vec), memory::core::IndexException);
+    EXPECT_THROW(index.train(std::span<const float>(vec).first(15)), memory::core::IndexException);
+    index.train(clusteredRows(100, 16, 4));
+    EXPECT_TRUE(index.trained());
+    index.Upsert(1, vec);
+    EXPECT_THROW(index.train(clusteredRows(100, 16, 4)), memory::core::IndexException);
+
+    EXPECT_THROW(HnswIndex(HnswOptions{.dimension = 16, .quantization = Quantization::PQ, .pq_subspaces = 5}),
+                 memory::core::IndexException);
+    // Unquantized indexes have nothing to train
+    HnswIndex plain(HnswOptions{.dimension = 16});
+    EXPECT_TRUE(plain.trained());
+    plain.train(vec);
+}
+
+TEST(QuantizedHnswTest, RecallAndMemoryPerEncoding) {
+    const size_t dim = 64;
+    auto data = embeddingRows(3000, dim, 5);
+    auto queries = embeddingRows(30, dim, 6);
+    normalizeRows(data, dim);
+    normalizeRows(queries, dim);
+
+    struct Setup {
+        Quantization quantization;
+        size_t rerank;
+        double min_recall;
+    };
+    size_t float_bytes = 0;
+    for (Setup setup : {Setup{Quantization::NONE, 0, 0.95}, Setup{Quantization::SQ8, 0, 0.9},
+                        Setup{Quantization::SQ8, 40, 0.95}, Setup{Quantization::PQ, 0, 0.45},
+                        Setup{Quantization::PQ, 100, 0.95}}) {
+        HnswIndex index(HnswOptions{.dimension = dim, .m = 12, .ef_construction = 100, .ef_search = 64,
+                                    .quantization = setup.quantization, .rerank = setup.rerank});
+        index.train(std::span<const float>(data).first(1000 * dim));
+        for (size_t i = 0; i < 3000; ++i) index.Upsert(i, row(data, i, dim));
+
+        std::string name = quantizationToString(setup.quantization) + " rerank=" + std::to_string(setup.rerank);
+        EXPECT_GE(recallAt(index, data, queries, dim, 10), setup.min_recall) << name;
+        // Exact matches still come first
+        auto top = index.Search(row(data, 42, dim), 1);
+        ASSERT_EQ(top.size(), 1u);
+        if (setup.quantization != Quantization::PQ || setup.rerank > 0) {
+            EXPECT_EQ(top[0].id, 42u) << name;
+        }
+
+        if (setup.quantization == Quantization::NONE) float_bytes = index.memoryBytes();
+        if (setup.rerank == 0 && setup.quantization != Quantization::NONE) {
+            EXPECT_LT(index.memoryBytes(), float_bytes) << name;
+        }
+    }
+}
+
+TEST(QuantizedHnswTest, OptionsFromConfig) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("quantization", "pq");
+    config.set("pq_subspaces", "48");
+    config.set("rerank_candidates", "100");
+    HnswOptions options = HnswOptions::fromConfig(config);
+    EXPECT_EQ(options.quantization, Quantization::PQ);
+    EXPECT_EQ(options.pq_subspaces, 48u);
+    EXPECT_EQ(options.rerank, 100u);
+}
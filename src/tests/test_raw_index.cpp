@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include "memory/search/raw_index.h"
+#include "memory/core/config.h"
+#include "memory/core/raw_store.h"
+#include "memory/core/sha256.h"
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace memory::search;
+using memory::core::RawRef;
+using memory::core::ScoredId;
+using memory::core::Timestamp;
+using memory::core::sha256;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path freshDirectory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+// Noon UTC, days after 2026-10-01
+Timestamp dayAt(int days) {
+    using namespace std::chrono;
+    return sys_days(year{2026} / October / 1) + days * 24h + 12h;
+}
+
+std::string_view slice(std::string_view text, const Passage& passage) {
+    return text.substr(passage.offset, passage.length);
+}
+
+} // namespace
+
+TEST(RawPassageTest, SplitsParagraphsJoinsShortAndCutsLong) {
+    std::string text = "  first line\nstill first\n\n\n  second  \n \nthird";
+    std::vector<Passage> passages = splitPassages(text, 24);
+    ASSERT_EQ(passages.size(), 2u);
+    EXPECT_EQ(slice(text, passages[0]), "first line\nstill first");
+    // A short paragraph joins its neighbour
+    EXPECT_EQ(slice(text, passages[1]), "second  \n \nthird");
+
+    passages = splitPassages(text, 1024);
+    ASSERT_EQ(passages.size(), 1u);
+    EXPECT_EQ(slice(text, passages[0]), text.substr(2));
+
+    // Long paragraphs break at sentence ends, and never inside a character
+    std::string sentences;
+    for (int i = 0; i < 40; ++i) sentences += "会议改到周五下午。";
+    passages = splitPassages(sentences, 100);
+    ASSERT_GT(passages.size(), 3u);
+    size_t covered = 0;
+    for (const Passage& passage : passages) {
+        EXPECT_LE(passage.length, 100u);
+        EXPECT_TRUE(slice(sentences, passage).ends_with("。"));
+        covered += passage.length;
+    }
+    EXPECT_EQ(covered, sentences.size());
+
+    std::string blob(300, 'x');
+    passages = splitPassages(blob, 100);
+    ASSERT_EQ(passages.size(), 3u);
+    EXPECT_TRUE(splitPassages(" \n\n\t ", 100).empty());
+}
+
+TEST(RawFallbackTest, LiteralsAndTrigger) {
+    for (std::string_view literal : {"https://example.com/a", R"(C:\Windows\System32)", "/var/log/syslog",
+                                     "src/core/wal.cpp", "0x80070005", "123e4567-e89b-12d3-a456-426614174000",
+                                     "E1234", "ORA-00942", "1234567", "deadbeef42", "ERR_CONN_RESET", "bthusb.sys",
+                                     "std::vector", "flush()"}) {
+        EXPECT_TRUE(looksLikeLiteral(literal)) << literal;
+    }
+    for (std::string_view word : {"meeting", "Q3", "and/or", "hello.", "e.g", "2026", "蓝牙耳机"}) {
+        EXPECT_FALSE(looksLikeLiteral(word)) << word;
+    }
+
+    RawFallbackOptions options;
+    options.low_coverage_topn = 5;
+    EXPECT_EQ(needsRawFallback("蓝牙耳机 会议", 10, options), RawFallbackReason::NONE);
+    EXPECT_EQ(needsRawFallback("蓝牙耳机 会议", 10, options, true), RawFallbackReason::EXPLICIT);
+    EXPECT_EQ(needsRawFallback("蓝牙耳机 会议", 2, options), RawFallbackReason::LOW_COVERAGE);
+    // Literals are found inside CJK text too
+    EXPECT_EQ(needsRawFallback("安装报错0x80070005怎么办", 10, options), RawFallbackReason::LITERAL);
+    options.pattern_trigger = false;
+    EXPECT_EQ(needsRawFallback("安装报错0x80070005怎么办", 10, options), RawFallbackReason::NONE);
+
+    EXPECT_EQ(RawIndex::rewriteQuery("why 0x80070005, again?"), R"(why  "0x80070005" , again?)");
+    EXPECT_EQ(RawIndex::rewriteQuery(R"(already "quoted phrase")"), R"(already "quoted phrase")");
+}
+
+TEST(RawIndexTest, SearchesLiteralsAsPhrases) {
+    RawIndexOptions options;
+    options.passage_bytes = 128;
+    RawIndex index(options);
+    std::string text =
+        "Install failed with error 0x80070005 access denied.\n\n"
+        "Retried later: 0x80004005 and the share was denied, error logged.\n\n"
+        R"(Driver missing from C:\Windows\System32\drivers\bthusb.sys after the update)";
+    auto digest = sha256(text);
+    EXPECT_EQ(index.Add("alice", digest, text, dayAt(10), dayAt(10)), 3u);
+    EXPECT_EQ(index.Add("alice", digest, text, dayAt(10), dayAt(10)), 0u);
+    index.Flush();
+
+    // The literal ranks its passage first; "error" alone matches another
+    std::vector<RawHit> hits = index.Search("alice", "error 0x80070005", 10, dayAt(10));
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[0].ref.chunk, digest);
+    EXPECT_TRUE(std::string_view(text).substr(hits[0].ref.offset, hits[0].ref.length).starts_with("Install"));
+    EXPECT_EQ(hits[0].day, 20261011u);
+
+    hits = index.Search("alice", R"(C:\Windows\System32\drivers)", 10, dayAt(10));
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_TRUE(std::string_view(text).substr(hits[0].ref.offset, hits[0].ref.length).starts_with("Driver"));
+
+    EXPECT_EQ(index.Search("alice", "denied", 10, dayAt(10)).size(), 2u);
+    EXPECT_TRUE(index.Search("bob", "denied", 10, dayAt(10)).empty());
+}
+
+TEST(RawIndexTest, WindowPartitionsAndExpiry) {
+    fs::path dir = freshDirectory("memory_test_raw_index");
+    RawIndexOptions options;
+    options.window_days = 3;
+    options.directory = dir.string();
+    options.search.max_buffered_docs = 1;
+    RawIndex index(options);
+
+    Timestamp now = dayAt(10);
+    EXPECT_EQ(index.Add("alice", sha256("old"), "bluetooth pairing notes", dayAt(7), now), 0u);
+    EXPECT_EQ(index.Add("alice", sha256("a"), "bluetooth pairing notes from monday", dayAt(8), now), 1u);
+    EXPECT_EQ(index.Add("alice", sha256("b"), "bluetooth pairing failed again", dayAt(10), now), 1u);
+    EXPECT_EQ(index.Add("bob", sha256("c"), "bluetooth headset", dayAt(9), now), 1u);
+    index.Flush();
+    EXPECT_EQ(index.partitionCount(), 3u);
+    EXPECT_EQ(index.passageCount(), 3u);
+    EXPECT_TRUE(fs::exists(dir / "alice" / "20261009"));
+
+    // Equal scores: the newer day first
+    std::vector<RawHit> hits = index.Search("alice", "bluetooth", 10, now);
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[0].day, 20261011u);
+
+    // A day past the window stops matching at once and is dropped on Expire
+    EXPECT_EQ(index.Search("alice", "bluetooth", 10, dayAt(11)).size(), 1u);
+    EXPECT_EQ(index.Expire(dayAt(11)), 1u);
+    EXPECT_FALSE(fs::exists(dir / "alice" / "20261009"));
+    EXPECT_TRUE(fs::exists(dir / "alice" / "20261011"));
+    EXPECT_EQ(index.Expire(dayAt(12)), 1u);
+    EXPECT_EQ(index.partitionCount(), 1u);
+    EXPECT_EQ(index.passageCount(), 1u);
+    fs::remove_all(dir);
+}
+
+TEST(RawIndexTest, RebuildsWindowFromRawStore) {
+    fs::path dir = freshDirectory("memory_test_raw_index_rebuild");
+    memory::core::RawStoreOptions store_options;
+    store_options.directory = dir.string();
+    store_options.sync = false;
+    memory::core::RawStore store(store_options);
+    store.put("alice", "expired: ticket ORA-00942 raised", dayAt(1));
+    store.put("alice", "ticket ORA-00942 raised\n\nfixed by granting select", dayAt(9));
+    store.put("bob", "ORA-00942 on the replica", dayAt(10));
+
+    std::vector<memory::core::RawChunkInfo> listed = store.list("alice", dayAt(5));
+    ASSERT_EQ(listed.size(), 1u);
+    EXPECT_EQ(store.list("alice").size(), 2u);
+
+    RawIndexOptions options;
+    options.passage_bytes = 32;
+    RawIndex index(options);
+    EXPECT_EQ(index.Rebuild(store, dayAt(10)), 2u);
+    EXPECT_EQ(index.passageCount(), 3u);
+    std::vector<RawHit> hits = index.Search("alice", "ORA-00942", 10, dayAt(10));
+    ASSERT_EQ(hits.size(), 1u);
+    std::vector<uint8_t> passage = store.read("alice", hits[0].ref);
+    EXPECT_EQ(std::string(passage.begin(), passage.end()), "ticket ORA-00942 raised");
+    fs::remove_all(dir);
+}
+
+TEST(RawIndexTest, MergeDedupsAgainstGraphRawRefs) {
+    auto chunk = sha256("chunk");
+    auto other = sha256("other");
+    std::vector<ScoredId> graph = {{1, 0.8f}, {2, 0.4f}};
+    std::vector<RawHit> raw = {
+        {RawRef{chunk, 100, 50}, 12.0f, 20261011},  // Inside node 1's raw_refs
+        {RawRef{other, 0, 40}, 9.0f, 20261011},
+        {RawRef{other, 20, 40}, 6.0f, 20261010},    // Overlaps the previous passage
+        {RawRef{chunk, 400, 50}, 3.0f, 20261010},
+    };
+    auto raw_refs = [&](memory::core::NodeId node) {
+        return node == 1 ? std::vector<RawRef>{{chunk, 0, 200}} : std::vector<RawRef>{};
+    };
+
+    std::vector<RecallHit> merged = mergeRawHits(graph, raw, 10, raw_refs);
+    ASSERT_EQ(merged.size(), 4u);
+    EXPECT_EQ(merged[0].source, RecallHit::Source::GRAPH);
+    EXPECT_EQ(merged[0].node, 1u);
+    EXPECT_FLOAT_EQ(merged[0].score, 1.0f);
+    EXPECT_EQ(merged[1].source, RecallHit::Source::RAW);
+    EXPECT_EQ(merged[1].ref.chunk, other);
+    EXPECT_FLOAT_EQ(merged[1].score, 0.75f);
+    EXPECT_EQ(merged[2].node, 2u);
+    EXPECT_EQ(merged[3].ref.offset, 400u);
+
+    merged = mergeRawHits(graph, raw, 2, raw_refs, 0.5f);
+    ASSERT_EQ(merged.size(), 2u);
+    EXPECT_EQ(merged[1].node, 2u);
+}
+
+TEST(RawIndexTest, OptionsFromConfig) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("raw_window_days", "0");
+    config.set("raw_passage_bytes", "2048");
+    config.set("raw_index_dir", "/tmp/raw_index");
+    config.set("raw_low_coverage_topn", "3");
+    config.set("raw_pattern_trigger", "false");
+    RawIndexOptions options = RawIndexOptions::fromConfig(config);
+    EXPECT_EQ(options.window_days, 1);
+    EXPECT_EQ(options.passage_bytes, 2048u);
+    EXPECT_EQ(options.directory, "/tmp/raw_index");
+    EXPECT_TRUE(options.search.index_positions);
+    RawFallbackOptions fallback = RawFallbackOptions::fromConfig(config);
+    EXPECT_EQ(fallback.low_coverage_topn, 3u);
+    EXPECT_FALSE(fallback.pattern_trigger);
+}
@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+#include "memory/core/block_codec.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/raw_store.h"
+#include "memory/core/sha256.h"
+#include "memory/core/thread_pool.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace memory::core;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path freshDirectory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+std::vector<Sha256Impl> supportedImpls() {
+    std::vector<Sha256Impl> impls;
+    for (Sha256Impl impl : {Sha256Impl::SCALAR, Sha256Impl::SHA_NI}) {
+        if (sha256Supported(impl)) impls.push_back(impl);
+    }
+    return impls;
+}
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t& b : bytes) b = static_cast<uint8_t>(rng());
+    return bytes;
+}
+
+// Log-like text: compressible, but not trivially
+std::vector<uint8_t> textBytes(size_t size, uint32_t seed) {
+    static const char* kWords[] = {"会议", "meeting", "蓝牙耳机", "deadline", "项目", "review",
+                                   "用户", "周五",  "下午",     "notes",    "预算", "季度"};
+    std::mt19937 rng(seed);
+    std::string text;
+    while (text.size() < size) {
+        text += kWords[rng() % 12];
+        text += rng() % 7 == 0 ? "\n" : " ";
+    }
+    text.resize(size);
+    return {text.begin(), text.end()};
+}
+
+RawStoreOptions storeOptions(const fs::path& dir) {
+    RawStoreOptions options;
+    options.directory = dir.string();
+    options.block_bytes = 4096;
+    options.sync = false;
+    return options;
+}
+
+Timestamp dayAt(int year, unsigned month, unsigned day) {
+    return std::chrono::sys_days{std::chrono::year{year} / month / day} + std::chrono::hours(12);
+}
+
+} // namespace
+
+TEST(Sha256Test, KnownVectors) {
+    const std::string million(1000000, 'a');
+    for (Sha256Impl impl : supportedImpls()) {
+        SCOPED_TRACE(static_cast<int>(impl));
+        EXPECT_EQ(toHex(Sha256(impl).finish()), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        EXPECT_EQ(toHex(Sha256(impl).update("abc", 3).finish()),
+                  "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        std::string two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+        EXPECT_EQ(toHex(Sha256(impl).update(two_blocks.data(), two_blocks.size()).finish()),
+                  "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        EXPECT_EQ(toHex(Sha256(impl).update(million.data(), million.size()).finish()),
+                  "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+}
+
+TEST(Sha256Test, IncrementalMatchesOneShotAcrossImplementations) {
+    std::vector<uint8_t> data = randomBytes(4096, 3);
+    for (size_t size : {0u, 1u, 55u, 56u, 63u, 64u, 65u, 119u, 120u, 128u, 1000u, 4096u}) {
+        std::span<const uint8_t> prefix(data.data(), size);
+        Sha256Digest expected = Sha256(Sha256Impl::SCALAR).update(prefix).finish();
+        for (Sha256Impl impl : supportedImpls()) {
+            Sha256 hasher(impl);
+            // Uneven pieces cross the 64-byte block boundaries
+            for (size_t at = 0, step = 1; at < size; at += step, step = step * 3 % 97 + 1) {
+                hasher.update(prefix.subspan(at, std::min(step, size - at)));
+            }
+            EXPECT_EQ(hasher.finish(), expected) << size;
+        }
+        EXPECT_EQ(sha256(prefix), expected);
+    }
+}
+
+TEST(Sha256Test, HexAndChunkIds) {
+    Sha256Digest digest = sha256(std::string_view("abc"));
+    auto parsed = sha256FromHex("BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD");
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(*parsed, digest);
+    EXPECT_FALSE(sha256FromHex("ba78"));
+    EXPECT_FALSE(sha256FromHex(std::string(64, 'g')));
+
+    std::string id = rawChunkId(digest);
+    EXPECT_EQ(id.substr(0, 12), "raw_ba7816bf");
+    EXPECT_EQ(parseRawChunkId(id), digest);
+    EXPECT_FALSE(parseRawChunkId(toHex(digest)));
+}
+
+TEST(BlockCodecTest, LzRoundTrips) {
+    std::vector<std::vector<uint8_t>> inputs = {{},
+                                                {42},
+                                                std::vector<uint8_t>(12, 'x'),
+                                                std::vector<uint8_t>(100000, 0),
+                                                randomBytes(70000, 1),
+                                                textBytes(65536, 2),
+                                                textBytes(13, 3)};
+    for (const auto& input : inputs) {
+        std::vector<uint8_t> compressed;
+        size_t size = lzCompress(input, compressed);
+        EXPECT_EQ(size, compressed.size());
+        EXPECT_LE(size, lzCompressBound(input.size()));
+        std::vector<uint8_t> output(input.size());
+        lzDecompress(compressed, output);
+        EXPECT_EQ(output, input) << input.size();
+    }
+
+    std::vector<uint8_t> compressed;
+    lzCompress(textBytes(65536, 4), compressed);
+    EXPECT_LT(compressed.size(), 65536u / 2);
+    EXPECT_EQ(stringToBlockCodec(blockCodecToString(BlockCodec::LZ)), BlockCodec::LZ);
+    EXPECT_THROW(stringToBlockCodec("zstd"), std::invalid_argument);
+}
+
+TEST(BlockCodecTest, MalformedInputThrows) {
+    std::vector<uint8_t> input = textBytes(5000, 5);
+    std::vector<uint8_t> compressed;
+    lzCompress(input, compressed);
+    std::vector<uint8_t> output(input.size());
+
+    std::vector<uint8_t> truncated(compressed.begin(), compressed.begin() + compressed.size() / 2);
+    EXPECT_THROW(lzDecompress(truncated, output), StorageException);
+    std::vector<uint8_t> too_small(input.size() - 1);
+    EXPECT_THROW(lzDecompress(compressed, too_small), StorageException);
+    // A match reaching back before the start of the output
+    std::vector<uint8_t> bad_offset = {0x10, 'a', 0x10, 0x00, 0x00};
+    std::vector<uint8_t> out(10);
+    EXPECT_THROW(lzDecompress(bad_offset, out), StorageException);
+}
+
+TEST(RawStoreTest, PutDeduplicatesPerTenant) {
+    fs::path dir = freshDirectory("memory_test_raw_dedup");
+    RawStore store(storeOptions(dir));
+    std::vector<uint8_t> content = textBytes(20000, 6);
+
+    RawPutResult first = store.put("alice", content);
+    EXPECT_FALSE(first.deduplicated);
+    EXPECT_EQ(first.sha256, sha256(content));
+    EXPECT_TRUE(store.put("alice", content).deduplicated);
+    EXPECT_FALSE(store.put("bob", content).deduplicated);
+    EXPECT_EQ(store.chunkCount(), 2u);
+    EXPECT_EQ(store.tenants(), (std::vector<std::string>{"alice", "bob"}));
+
+    EXPECT_EQ(store.read("alice", first.sha256), content);
+    EXPECT_TRUE(store.contains("bob", first.sha256));
+    EXPECT_FALSE(store.contains("carol", first.sha256));
+    EXPECT_THROW(store.read("carol", first.sha256), StorageException);
+    EXPECT_THROW(store.put("../etc", content), std::invalid_argument);
+
+    auto info = store.info("alice", first.sha256);
+    ASSERT_TRUE(info);
+    EXPECT_EQ(info->length, content.size());
+    EXPECT_LT(info->stored_bytes, content.size());
+    EXPECT_NE(info->pack.find("tenants"), std::string::npos);
+
+    // Empty content and the default tenant
+    RawPutResult empty = store.put("", std::string_view());
+    EXPECT_TRUE(store.read("default", empty.sha256).empty());
+    fs::remove_all(dir);
+}
+
+TEST(RawStoreTest, RangeReadsMatchTheContent) {
+    fs::path dir = freshDirectory("memory_test_raw_range");
+    RawStore store(storeOptions(dir));
+    std::vector<uint8_t> text = textBytes(50000, 7);
+    std::vector<uint8_t> noise = randomBytes(30000, 8);
+    Sha256Digest text_id = store.put("t", text).sha256;
+    Sha256Digest noise_id = store.put("t", noise).sha256;
+
+    std::mt19937 rng(9);
+    for (int i = 0; i < 200; ++i) {
+        const auto& content = i % 2 ? noise : text;
+        RawRef ref{i % 2 ? noise_id : text_id, rng() % content.size(), rng() % 9000};
+        uint64_t end = std::min<uint64_t>(content.size(), ref.offset + ref.length);
+        std::vector<uint8_t> expected(content.begin() + static_cast<ptrdiff_t>(ref.offset),
+                                      content.begin() + static_cast<ptrdiff_t>(end));
+        ASSERT_EQ(store.read("t", ref), expected) << ref.offset << "+" << ref.length;
+    }
+    // Whole blocks, and ranges clipped to the chunk
+    EXPECT_EQ(store.read("t", RawRef{text_id, 4096, 8192}),
+              std::vector<uint8_t>(text.begin() + 4096, text.begin() + 12288));
+    EXPECT_EQ(store.read("t", RawRef{text_id, 49990, 100}).size(), 10u);
+    EXPECT_TRUE(store.read("t", RawRef{text_id, 60000, 10}).empty());
+    fs::remove_all(dir);
+}
+
+TEST(RawStoreTest, PacksByDayAndRollsOver) {
+    fs::path dir = freshDirectory("memory_test_raw_packs");
+    RawStoreOptions options = storeOptions(dir);
+    options.pack_bytes = 10 << 10;
+    RawStore store(options);
+
+    std::vector<Sha256Digest> ids;
+    for (uint32_t i = 0; i < 6; ++i) ids.push_back(store.put("t", randomBytes(8000, 10 + i), dayAt(2025, 3, 7)).sha256);
+    Sha256Digest other = store.put("t", randomBytes(100, 20), dayAt(2025, 11, 30)).sha256;
+
+    fs::path march = dir / "tenants" / "t" / "raw" / "2025" / "03" / "07";
+    size_t packs = 0;
+    for (const auto& entry : fs::directory_iterator(march)) packs += entry.path().extension() == ".rawp";
+    EXPECT_EQ(packs, 3u);
+    fs::path november = dir / "tenants" / "t" / "raw" / "2025" / "11" / "30";
+    EXPECT_EQ(fs::path(store.info("t", other)->pack).parent_path(), november);
+    for (uint32_t i = 0; i < 6; ++i) EXPECT_EQ(store.read("t", ids[i]), randomBytes(8000, 10 + i));
+    fs::remove_all(dir);
+}
+
+TEST(RawStoreTest, ReopenCutsTornIndexTail) {
+    fs::path dir = freshDirectory("memory_test_raw_reopen");
+    std::vector<uint8_t> a = textBytes(10000, 21);
+    std::vector<uint8_t> b = textBytes(10000, 22);
+    Sha256Digest a_id;
+    {
+        RawStore store(storeOptions(dir));
+        a_id = store.put("t", a).sha256;
+        store.put("t", b);
+    }
+    fs::path index = dir / "tenants" / "t" / "raw" / "index.rawi";
+    // Half of the second record survived the crash
+    fs::resize_file(index, fs::file_size(index) - sizeof(RawIndexRecord) / 2);
+
+    RawStore store(storeOptions(dir));
+    EXPECT_EQ(store.chunkCount(), 1u);
+    EXPECT_EQ(store.read("t", a_id), a);
+    EXPECT_EQ(fs::file_size(index), sizeof(RawFileHeader) + sizeof(RawIndexRecord));
+    EXPECT_FALSE(store.put("t", b).deduplicated);
+    EXPECT_TRUE(store.put("t", a).deduplicated);
+    EXPECT_EQ(store.read("t", sha256(b)), b);
+    fs::remove_all(dir);
+}
+
+TEST(RawStoreTest, DamagedBlockFailsItsChecksum) {
+    fs::path dir = freshDirectory("memory_test_raw_damaged");
+    RawStore store(storeOptions(dir));
+    std::vector<uint8_t> content = textBytes(20000, 23);
+    Sha256Digest id = store.put("t", content).sha256;
+    std::string pack = store.info("t", id)->pack;
+    {
+        std::fstream file(pack, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-10, std::ios::end);
+        file.put('\x7f');
+    }
+    // The first block is intact; the last one is not
+    EXPECT_EQ(store.read("t", RawRef{id, 0, 100}).size(), 100u);
+    EXPECT_THROW(store.read("t", id), StorageException);
+    fs::remove_all(dir);
+}
+
+TEST(RawStoreTest, BulkIngestOnPool) {
+    fs::path dir = freshDirectory("memory_test_raw_ingest");
+    RawStore store(storeOptions(dir), std::make_shared<ThreadPool>(3));
+    std::vector<std::vector<uint8_t>> chunks;
+    for (uint32_t i = 0; i < 40; ++i) chunks.push_back(textBytes(5000 + i * 100, 30 + i % 30));
+    std::vector<std::span<const uint8_t>> contents(chunks.begin(), chunks.end());
+
+    RawIngestStats stats;
+    auto results = store.ingest("t", contents, std::chrono::system_clock::now(), &stats);
+    ASSERT_EQ(results.size(), 40u);
+    EXPECT_EQ(stats.chunks, 40u);
+    EXPECT_EQ(stats.deduplicated, 0u);
+    EXPECT_GT(stats.mbPerSecond(), 0.0);
+    EXPECT_LT(stats.compressionRatio(), 1.0);
+    for (size_t i = 0; i < 40; ++i) {
+        EXPECT_EQ(results[i].sha256, sha256(chunks[i]));
+        EXPECT_EQ(store.read("t", results[i].sha256), chunks[i]);
+    }
+
+    // Repeats within and across batches are stored once
+    std::vector<std::span<const uint8_t>> again = {contents[0], contents[5], contents[5]};
+    std::vector<uint8_t> fresh = textBytes(3000, 99);
+    again.push_back(fresh);
+    again.push_back(fresh);
+    results = store.ingest("t", again, std::chrono::system_clock::now(), &stats);
+    EXPECT_EQ(stats.deduplicated, 4u);
+    EXPECT_FALSE(results[3].deduplicated);
+    EXPECT_TRUE(results[4].deduplicated);
+    EXPECT_EQ(store.chunkCount(), 41u);
+    EXPECT_EQ(store.stats().chunks, 45u);
+    fs::remove_all(dir);
+}
+
+TEST(RawStoreTest, OptionsFromConfig) {
+    auto& config = Config::getInstance();
+    config.set("raw_dir", "/tmp/raw");
+    config.set("raw_block_kb", "16");
+    config.set("raw_pack_mb", "0");
+    config.set("raw_compression", "none");
+    config.set("raw_sync", "false");
+    RawStoreOptions options = RawStoreOptions::fromConfig(config);
+    EXPECT_EQ(options.directory, "/tmp/raw");
+    EXPECT_EQ(options.block_bytes, 16u << 10);
+    EXPECT_EQ(options.pack_bytes, 1u << 20);
+    EXPECT_EQ(options.codec, BlockCodec::NONE);
+    EXPECT_FALSE(options.sync);
+}
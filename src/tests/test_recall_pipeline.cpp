@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+#include "memory/pipeline/recall_pipeline.h"
+#include "memory/core/config.h"
+#include "memory/core/manifest.h"
+#include "memory/core/node_store.h"
+#include "memory/core/thread_pool.h"
+#include "memory/graph/csr_graph_store.h"
+#include "memory/search/inverted_index.h"
+#include "memory/vector/hnsw_index.h"
+#include "memory/vector/vector_index.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace memory::pipeline;
+using memory::core::NodeId;
+using memory::core::ScoredId;
+
+namespace {
+
+// Returns fixed hits after an optional delay, or throws
+class FakeVectorIndex : public memory::vector::IVectorIndex {
+public:
+    explicit FakeVectorIndex(std::vector<ScoredId> hits, std::chrono::milliseconds delay = {}, bool fail = false)
+        : hits_(std::move(hits)), delay_(delay), fail_(fail) {}
+
+    void Upsert(NodeId, std::span<const float>) override {}
+    void Remove(NodeId) override {}
+    std::vector<ScoredId> Search(std::span<const float>, size_t topk) const override {
+        std::this_thread::sleep_for(delay_);
+        if (fail_) throw std::runtime_error("ann shard offline");
+        return {hits_.begin(), hits_.begin() + static_cast<ptrdiff_t>(std::min(topk, hits_.size()))};
+    }
+    void Flush() override {}
+
+private:
+    std::vector<ScoredId> hits_;
+    std::chrono::milliseconds delay_;
+    bool fail_;
+};
+
+class RecallPipelineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        search_ = std::make_shared<memory::search::InvertedIndex>();
+        search_->Upsert(1, "bluetooth headset keeps disconnecting");
+        search_->Upsert(2, "bluetooth pairing fixed after driver update");
+        search_->Upsert(3, "quarterly budget review on friday");
+        search_->Flush();
+
+        // 1 and 2 are about topic 10, which 11 is also about
+        graph_ = std::make_shared<memory::graph::CsrGraphStore>();
+        memory::core::Edge e{};
+        e.type = memory::core::EdgeType::ABOUT;
+        for (NodeId src : {1, 2, 11}) {
+            e.src = src;
+            e.dst = 10;
+            graph_->AddEdge(e);
+        }
+        graph_->Flush();
+
+        options_.vector_enabled = true;
+        options_.topk = 10;
+        options_.bm25_deadline = std::chrono::milliseconds(2000);
+        options_.vector_deadline = std::chrono::milliseconds(2000);
+        options_.graph_deadline = std::chrono::milliseconds(2000);
+    }
+
+    RecallSources sources(std::shared_ptr<const memory::vector::IVectorIndex> vectors) const {
+        RecallSources sources;
+        sources.search = search_;
+        sources.graph = graph_;
+        sources.vectors = std::move(vectors);
+        sources.embed = [](std::string_view) { return std::vector<float>{1.0f, 0.0f}; };
+        return sources;
+    }
+
+    static memory::core::RecallQuery query(const std::string& text) {
+        memory::core::RecallQuery query;
+        query.text = text;
+        query.k_hop = 2;
+        return query;
+    }
+
+    static bool contains(const std::vector<ScoredId>& results, NodeId node) {
+        return std::any_of(results.begin(), results.end(), [&](const ScoredId& r) { return r.id == node; });
+    }
+
+    std::shared_ptr<memory::search::InvertedIndex> search_;
+    std::shared_ptr<memory::graph::CsrGraphStore> graph_;
+    RecallPipelineOptions options_;
+};
+
+} // namespace
+
+TEST_F(RecallPipelineTest, AllStagesAnswer) {
+    auto vectors = std::make_shared<FakeVectorIndex>(std::vector<ScoredId>{{2, 0.9f}, {3, 0.2f}});
+    RecallPipeline pipeline(options_, sources(vectors));
+    RecallTrace trace;
+    std::vector<ScoredId> results = pipeline.Run(query("bluetooth"), &trace);
+
+    EXPECT_EQ(trace.path, "A→B→C");
+    EXPECT_FALSE(trace.degraded);
+    EXPECT_EQ(trace.bm25.status, StageStatus::OK);
+    EXPECT_EQ(trace.bm25.hits, 2u);
+    EXPECT_EQ(trace.vector.hits, 2u);
+    EXPECT_EQ(trace.graph.status, StageStatus::OK);
+    ASSERT_FALSE(results.empty());
+    // Keyword, vector and graph evidence all point at 2
+    EXPECT_EQ(results[0].id, 2u);
+    // Reached only through the graph
+    EXPECT_TRUE(contains(results, 11));
+    EXPECT_TRUE(std::is_sorted(results.begin(), results.end()));
+}
+
+TEST_F(RecallPipelineTest, DegradesAlongCapabilityMatrix) {
+    auto vectors = std::make_shared<FakeVectorIndex>(std::vector<ScoredId>{{3, 0.9f}});
+    RecallTrace trace;
+
+    // Vector index switched off: A→C, as configured, so not degraded
+    options_.vector_enabled = false;
+    RecallPipeline keyword_graph(options_, sources(vectors));
+    std::vector<ScoredId> results = keyword_graph.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.path, "A→C");
+    EXPECT_FALSE(trace.degraded);
+    EXPECT_EQ(trace.vector.status, StageStatus::SKIPPED);
+    EXPECT_FALSE(contains(results, 3));
+
+    // Embedding down: A→C, degraded
+    options_.vector_enabled = true;
+    RecallSources no_embedding = sources(vectors);
+    no_embedding.embed = [](std::string_view) { return std::vector<float>(); };
+    RecallPipeline embedding_down(options_, no_embedding);
+    embedding_down.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.path, "A→C");
+    EXPECT_TRUE(trace.degraded);
+    EXPECT_EQ(trace.vector.status, StageStatus::UNAVAILABLE);
+    EXPECT_EQ(trace.vector.detail, "embedding unavailable");
+
+    // Graph under maintenance: A→B
+    RecallSources no_graph = sources(vectors);
+    no_graph.graph = nullptr;
+    RecallPipeline keyword_vector(options_, no_graph);
+    results = keyword_vector.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.path, "A→B");
+    EXPECT_TRUE(contains(results, 3));
+    EXPECT_FALSE(contains(results, 11));
+
+    // Keywords alone
+    RecallSources keywords;
+    keywords.search = search_;
+    RecallPipeline keyword_only(options_, keywords);
+    results = keyword_only.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.path, "A");
+    EXPECT_EQ(results.size(), 2u);
+
+    // A failing stage is contained like a missing one
+    auto failing = std::make_shared<FakeVectorIndex>(std::vector<ScoredId>{}, std::chrono::milliseconds(0), true);
+    RecallPipeline ann_failed(options_, sources(failing));
+    ann_failed.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.vector.status, StageStatus::FAILED);
+    EXPECT_EQ(trace.vector.detail, "ann shard offline");
+    EXPECT_EQ(trace.path, "A→C");
+}
+
+TEST_F(RecallPipelineTest, LateStageIsDroppedWithoutBlocking) {
+    auto slow = std::make_shared<FakeVectorIndex>(std::vector<ScoredId>{{3, 0.9f}}, std::chrono::milliseconds(500));
+    options_.vector_deadline = std::chrono::milliseconds(20);
+    RecallPipeline pipeline(options_, sources(slow));
+    RecallTrace trace;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ScoredId> results = pipeline.Run(query("bluetooth"), &trace);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(400));
+    EXPECT_EQ(trace.vector.status, StageStatus::TIMED_OUT);
+    EXPECT_EQ(trace.path, "A→C");
+    EXPECT_TRUE(trace.degraded);
+    EXPECT_FALSE(contains(results, 3));
+    EXPECT_TRUE(contains(results, 1));
+}
+
+TEST_F(RecallPipelineTest, InlineWithoutWorkersStillEnforcesDeadlines) {
+    auto slow = std::make_shared<FakeVectorIndex>(std::vector<ScoredId>{{3, 0.9f}}, std::chrono::milliseconds(60));
+    options_.vector_deadline = std::chrono::milliseconds(20);
+    RecallPipeline pipeline(options_, sources(slow), std::make_shared<memory::core::ThreadPool>(0));
+    RecallTrace trace;
+    std::vector<ScoredId> results = pipeline.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.vector.status, StageStatus::TIMED_OUT);
+    EXPECT_EQ(trace.path, "A→C");
+    EXPECT_FALSE(contains(results, 3));
+}
+
+TEST_F(RecallPipelineTest, SharedPoolAcrossConcurrentRuns) {
+    auto vectors = std::make_shared<FakeVectorIndex>(std::vector<ScoredId>{{2, 0.9f}});
+    auto pool = std::make_shared<memory::core::ThreadPool>(2);
+    RecallPipeline pipeline(options_, sources(vectors), pool);
+    std::vector<std::thread> callers;
+    std::vector<std::string> paths(4);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        callers.emplace_back([&, i] {
+            RecallTrace trace;
+            pipeline.Run(query("bluetooth driver"), &trace);
+            paths[i] = trace.path;
+        });
+    }
+    for (auto& caller : callers) caller.join();
+    for (const std::string& path : paths) EXPECT_EQ(path, "A→B→C");
+}
+
+TEST_F(RecallPipelineTest, StagesReadOnePinnedView) {
+    auto versions = std::make_shared<memory::core::VersionSet>();
+    auto vectors = std::make_shared<memory::vector::HnswIndex>(memory::vector::HnswOptions{.dimension = 2});
+    vectors->Upsert(1, std::vector<float>{1.0f, 0.1f});
+    vectors->Upsert(2, std::vector<float>{1.0f, 0.2f});
+    search_->attachVersions(versions);
+    graph_->attachVersions(versions);
+    vectors->attachVersions(versions);
+
+    // Without workers the stages run in order, so writes made while
+    // embedding land after stage A and before B searches and C expands
+    RecallSources pinned = sources(vectors);
+    pinned.versions = versions;
+    pinned.embed = [this, vectors](std::string_view) {
+        vectors->Remove(2);
+        graph_->RemoveEdge(11, 10, memory::core::EdgeType::ABOUT);
+        graph_->Flush();
+        return std::vector<float>{1.0f, 0.0f};
+    };
+    RecallPipeline pipeline(options_, pinned, std::make_shared<memory::core::ThreadPool>(0));
+    RecallTrace trace;
+    std::vector<ScoredId> results = pipeline.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.path, "A→B→C");
+    EXPECT_EQ(trace.vector.hits, 2u);
+    EXPECT_TRUE(contains(results, 11));
+
+    // The next run pins the view with both writes in
+    results = pipeline.Run(query("bluetooth"), &trace);
+    EXPECT_EQ(trace.vector.hits, 1u);
+    EXPECT_FALSE(contains(results, 11));
+}
+
+TEST_F(RecallPipelineTest, NodeWeightFavoursRecentMemories) {
+    auto search = std::make_shared<memory::search::InvertedIndex>();
+    search->Upsert(5, "printer jams on tray two");
+    search->Upsert(6, "printer jams on tray two");
+    search->Flush();
+    RecallSources keywords;
+    keywords.search = search;
+
+    // Equal text scores tie on the id
+    RecallPipeline text_only(options_, keywords);
+    std::vector<ScoredId> results = text_only.Run(query("printer"));
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].id, 5u);
+
+    auto nodes = std::make_shared<memory::core::NodeStore>();
+    memory::core::Node node;
+    node.type = memory::core::NodeType::EPISODE;
+    node.id = 5;
+    node.recency = std::chrono::system_clock::now() - std::chrono::hours(24 * 60);
+    nodes->upsert(node);
+    node.id = 6;
+    node.recency = std::chrono::system_clock::now();
+    nodes->upsert(node);
+    keywords.nodes = nodes;
+    RecallPipeline weighted(options_, keywords);
+    results = weighted.Run(query("printer"));
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].id, 6u);
+    EXPECT_GT(results[0].score, results[1].score);
+}
+
+TEST(RecallPipelineOptionsTest, FromConfig) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("bm25_weight", "0.5");
+    config.set("topk_candidates", "0");
+    config.set("recall_topk", "7");
+    config.set("max_k_hop", "3");
+    config.set("enabled", "true");
+    config.set("max_threads", "2");
+    config.set("bm25_deadline_ms", "15");
+    config.set("graph_deadline_ms", "-1");
+    RecallPipelineOptions options = RecallPipelineOptions::fromConfig(config);
+    EXPECT_FLOAT_EQ(options.weights.bm25, 0.5f);
+    EXPECT_EQ(options.topk_candidates, 1u);
+    EXPECT_EQ(options.topk, 7u);
+    EXPECT_EQ(options.max_k_hop, 3);
+    EXPECT_TRUE(options.vector_enabled);
+    EXPECT_EQ(options.max_threads, 2u);
+    EXPECT_EQ(options.bm25_deadline, std::chrono::milliseconds(15));
+    EXPECT_EQ(options.graph_deadline, std::chrono::milliseconds(1));
+    config.set("enabled", "false");
+}
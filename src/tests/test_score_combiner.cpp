@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "memory/pipeline/score_combiner.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/node_store.h"
+#include "memory/core/top_k.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace memory::pipeline;
+using memory::core::NodeId;
+using memory::core::NodeType;
+using memory::core::ScoredId;
+using memory::core::SimdLevel;
+
+namespace {
+
+std::vector<const ScoreKernels*> availableKernels() {
+    std::vector<const ScoreKernels*> kernels;
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2}) {
+        if (const ScoreKernels* k = scoreKernels(level)) kernels.push_back(k);
+    }
+    return kernels;
+}
+
+CandidateColumns randomColumns(std::mt19937& rng, size_t n) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> age(0.0f, 2000.0f);
+    CandidateColumns columns;
+    for (size_t i = 0; i < n; ++i) {
+        size_t at = columns.add(1000 + i);
+        columns.bm25[at] = unit(rng);
+        columns.cosine[at] = unit(rng);
+        columns.graph[at] = unit(rng);
+        // Every fourth candidate is unknown to the node store
+        if (i % 4 == 3) continue;
+        columns.types[at] = static_cast<uint8_t>(rng() % 7);
+        columns.importance[at] = unit(rng);
+        columns.frequency[at] = static_cast<float>(rng() % 5000);
+        columns.age_days[at] = age(rng);
+    }
+    return columns;
+}
+
+std::vector<ScoredId> fullSort(const std::vector<NodeId>& ids, const std::vector<float>& scores, size_t k) {
+    std::vector<ScoredId> all;
+    for (size_t i = 0; i < ids.size(); ++i) all.push_back({ids[i], scores[i]});
+    std::sort(all.begin(), all.end(), memory::core::TopKCollector::better);
+    all.resize(std::min(k, all.size()));
+    return all;
+}
+
+} // namespace
+
+TEST(ScoreCombinerTest, ScalarAlwaysAvailable) {
+    ASSERT_NE(scoreKernels(SimdLevel::SCALAR), nullptr);
+    EXPECT_STREQ(scoreKernels(SimdLevel::SCALAR)->name, "scalar");
+    EXPECT_TRUE(memory::core::simdLevelSupported(scoreKernels().level));
+}
+
+TEST(ScoreCombinerTest, KernelsMatchReference) {
+    std::mt19937 rng(3);
+    ScoreWeights weights;
+    // Tails of every length, past the 8-wide body
+    for (size_t n : {0u, 1u, 7u, 8u, 9u, 31u, 1000u}) {
+        CandidateColumns columns = randomColumns(rng, n);
+        for (const ScoreKernels* kernels : availableKernels()) {
+            std::vector<float> out(n);
+            kernels->combine(columns, weights, out.data());
+            for (size_t i = 0; i < n; ++i) {
+                float weight = nodeWeight(weights, static_cast<NodeType>(columns.types[i]), columns.importance[i],
+                                          columns.frequency[i], columns.age_days[i]);
+                float expected = weights.bm25 * columns.bm25[i] + weights.vector * columns.cosine[i] +
+                                 weights.graph * columns.graph[i] + weights.node * weight;
+                ASSERT_NEAR(out[i], expected, 1e-5f * std::max(1.0f, expected)) << kernels->name << " i=" << i;
+            }
+        }
+    }
+}
+
+TEST(ScoreCombinerTest, WeightDecaysByNodeType) {
+    ScoreWeights weights;
+    weights.importance = 0.0f;
+    weights.frequency = 0.0f;
+    weights.recency = 1.0f;
+    EXPECT_FLOAT_EQ(nodeWeight(weights, NodeType::EPISODE, 0.0f, 0.0f, 0.0f), 1.0f);
+    EXPECT_NEAR(nodeWeight(weights, NodeType::EPISODE, 0.0f, 0.0f, 14.0f), std::exp(-1.0f), 1e-6f);
+    EXPECT_NEAR(nodeWeight(weights, NodeType::FACT, 0.0f, 0.0f, 90.0f), std::exp(-1.0f), 1e-6f);
+    EXPECT_NEAR(nodeWeight(weights, NodeType::CONCEPT, 0.0f, 0.0f, 180.0f), std::exp(-1.0f), 1e-6f);
+    // A month-old episode has faded more than a month-old fact
+    EXPECT_LT(nodeWeight(weights, NodeType::EPISODE, 0.0f, 0.0f, 30.0f),
+              nodeWeight(weights, NodeType::FACT, 0.0f, 0.0f, 30.0f));
+
+    weights = ScoreWeights();
+    weights.recency = 0.0f;
+    EXPECT_NEAR(nodeWeight(weights, NodeType::FACT, 0.8f, 9.0f, 0.0f), 0.5f * 0.8f + 0.2f * std::log(10.0f), 1e-6f);
+}
+
+TEST(ScoreCombinerTest, GathersNodeColumns) {
+    memory::core::NodeStore nodes;
+    auto now = std::chrono::system_clock::now();
+    memory::core::Node node;
+    node.id = 7;
+    node.type = NodeType::PREFERENCE;
+    node.importance = 0.9f;
+    node.frequency = 3;
+    node.recency = now - std::chrono::hours(48);
+    nodes.upsert(node);
+
+    CandidateColumns columns;
+    columns.add(7);
+    columns.add(8);
+    columns.gather(nodes, now);
+    EXPECT_EQ(columns.types[0], static_cast<uint8_t>(NodeType::PREFERENCE));
+    EXPECT_FLOAT_EQ(columns.importance[0], 0.9f);
+    EXPECT_FLOAT_EQ(columns.frequency[0], 3.0f);
+    EXPECT_NEAR(columns.age_days[0], 2.0f, 1e-3f);
+    // Unknown nodes keep no weight
+    EXPECT_TRUE(std::isinf(columns.age_days[1]));
+
+    std::vector<float> scores;
+    combineScores(columns, ScoreWeights(), scores);
+    ASSERT_EQ(scores.size(), 2u);
+    EXPECT_GT(scores[0], 0.0f);
+    EXPECT_NEAR(scores[1], 0.0f, 1e-6f);
+
+    columns.bm25.pop_back();
+    EXPECT_THROW(combineScores(columns, ScoreWeights(), scores), memory::core::QueryException);
+}
+
+TEST(ScoreCombinerTest, SelectTopKMatchesFullSort) {
+    std::mt19937 rng(5);
+    std::vector<NodeId> ids;
+    std::vector<float> scores;
+    for (NodeId id = 0; id < 5000; ++id) {
+        ids.push_back(id);
+        // Few distinct values, so ties must fall back to the id
+        scores.push_back(static_cast<float>(rng() % 64) / 8.0f);
+    }
+    std::shuffle(ids.begin(), ids.end(), rng);
+    // Heap path, nth_element path, everything and more than everything
+    for (size_t k : {0u, 1u, 10u, 625u, 626u, 2000u, 5000u, 6000u}) {
+        std::vector<ScoredId> expected = fullSort(ids, scores, k);
+        std::vector<ScoredId> actual = selectTopK(ids, scores, k);
+        ASSERT_EQ(actual.size(), expected.size()) << "k=" << k;
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT_EQ(actual[i].id, expected[i].id) << "k=" << k << " i=" << i;
+            ASSERT_EQ(actual[i].score, expected[i].score);
+        }
+    }
+}
+
+TEST(ScoreCombinerTest, WeightsFromConfig) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("node_weight", "0.25");
+    config.set("recency_weight", "-1");
+    config.set("episode_tau", "7");
+    config.set("fact_tau", "30");
+    config.set("concept_tau", "0");
+    ScoreWeights weights = ScoreWeights::fromConfig(config);
+    EXPECT_FLOAT_EQ(weights.node, 0.25f);
+    EXPECT_FLOAT_EQ(weights.recency, 0.0f);
+    EXPECT_FLOAT_EQ(weights.tau(NodeType::EPISODE), 7.0f);
+    EXPECT_FLOAT_EQ(weights.tau(NodeType::FACT), 30.0f);
+    EXPECT_FLOAT_EQ(weights.tau(NodeType::PREFERENCE), 30.0f);
+    EXPECT_FLOAT_EQ(weights.tau(NodeType::TASK), 30.0f);
+    EXPECT_GT(weights.tau(NodeType::CONCEPT), 0.0f);
+    EXPECT_FLOAT_EQ(weights.tau(NodeType::ENTITY), weights.tau(NodeType::CONCEPT));
+    config.set("node_weight", "0.1");
+    config.set("recency_weight", "0.3");
+    config.set("episode_tau", "14");
+    config.set("fact_tau", "90");
+    config.set("concept_tau", "180");
+}
@@ -0,0 +1,534 @@
+#include <gtest/gtest.h>
+#include "memory/search/inverted_index.h"
+#include "memory/search/postings.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/wal.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+using namespace memory::search;
+
+TEST(PostingsTest, PackUnpackAllWidths) {
+    std::mt19937 rng(42);
+    for (uint32_t bits = 0; bits <= 32; ++bits) {
+        uint32_t values[kPostingBlockSize];
+        for (auto& v : values) {
+            v = bits == 0 ? 0 : static_cast<uint32_t>(rng()) >> (32 - bits);
+        }
+        std::vector<uint8_t> packed(packedBlockBytes(bits) + kPostingPadding, 0);
+        packBlock(values, bits, packed.data());
+
+        uint32_t decoded[kPostingBlockSize];
+        unpackBlock(packed.data(), bits, decoded);
+        for (uint32_t i = 0; i < kPostingBlockSize; ++i) {
+            ASSERT_EQ(decoded[i], values[i]) << "bits=" << bits << " i=" << i;
+        }
+    }
+}
+
+TEST(PostingsTest, VarintRoundTrip) {
+    std::vector<uint8_t> bytes;
+    std::vector<uint32_t> values = {0, 1, 127, 128, 16383, 16384, 0xFFFFFFFFu};
+    for (uint32_t v : values) encodeVarint(v, bytes);
+
+    const uint8_t* in = bytes.data();
+    for (uint32_t expected : values) {
+        uint32_t v;
+        in = decodeVarint(in, v);
+        EXPECT_EQ(v, expected);
+    }
+    EXPECT_EQ(in, bytes.data() + bytes.size());
+}
+
+TEST(PostingsTest, CursorNextAndAdvance) {
+    std::vector<uint8_t> bytes;
+    std::vector<SkipEntry> skips;
+    std::vector<uint32_t> docs;
+    PostingsWriter writer(bytes, skips);
+    for (uint32_t d = 3; docs.size() < 1000; d += 1 + (d % 7)) {
+        docs.push_back(d);
+        writer.add(d, 1 + d % 5, 10);
+    }
+    EXPECT_EQ(writer.finish(), 1000u);
+    EXPECT_EQ(skips.size(), 8u);  // 7 full blocks + tail
+    bytes.resize(bytes.size() + kPostingPadding, 0);
+
+    PostingCursor cursor(bytes.data(), skips.data(), 1000);
+    for (uint32_t d : docs) {
+        ASSERT_EQ(cursor.doc(), d);
+        ASSERT_EQ(cursor.freq(), 1 + d % 5);
+        cursor.next();
+    }
+    EXPECT_EQ(cursor.doc(), kNoMoreDocs);
+
+    PostingCursor skipper(bytes.data(), skips.data(), 1000);
+    skipper.advance(docs[500]);
+    EXPECT_EQ(skipper.doc(), docs[500]);
+    uint32_t target = docs[900] - 1;
+    skipper.advance(target);
+    EXPECT_EQ(skipper.doc(), *std::lower_bound(docs.begin(), docs.end(), target));
+    skipper.advance(docs.back() + 1);
+    EXPECT_EQ(skipper.doc(), kNoMoreDocs);
+}
+
+TEST(PostingsTest, PositionsRoundTrip) {
+    std::vector<uint8_t> bytes;
+    std::vector<SkipEntry> skips;
+    std::vector<uint8_t> position_bytes;
+    std::vector<uint32_t> position_blocks;
+    PostingsWriter writer(bytes, skips);
+    PositionsWriter positions_writer(position_bytes, position_blocks);
+
+    std::mt19937 rng(7);
+    std::vector<std::vector<uint32_t>> expected;
+    for (uint32_t d = 0; d < 1000; ++d) {
+        std::vector<uint32_t> positions(1 + rng() % 6);
+        uint32_t pos = rng() % 50;
+        for (auto& p : positions) {
+            p = pos;
+            pos += 1 + rng() % (d % 3 == 0 ? 100000 : 20);
+        }
+        writer.add(d, static_cast<uint32_t>(positions.size()), pos);
+        positions_writer.add(positions.data(), static_cast<uint32_t>(positions.size()));
+        expected.push_back(std::move(positions));
+    }
+    writer.finish();
+    positions_writer.finish();
+    ASSERT_EQ(position_blocks.size(), skips.size());
+    bytes.resize(bytes.size() + kPostingPadding, 0);
+    position_bytes.resize(position_bytes.size() + kPostingPadding, 0);
+
+    PostingCursor cursor(bytes.data(), skips.data(), 1000);
+    PositionReader reader(position_bytes.data(), position_blocks.data());
+    for (uint32_t d = 0; d < 1000; d += 1 + d % 11) {
+        cursor.advance(d);
+        ASSERT_EQ(cursor.doc(), d);
+        auto positions = reader.positions(cursor);
+        ASSERT_EQ(std::vector<uint32_t>(positions.begin(), positions.end()), expected[d]) << "doc " << d;
+    }
+}
+
+class InvertedIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        index_.Upsert(1, "Win11 蓝牙 打不开 驱动 异常");
+        index_.Upsert(2, "Win11 更新 失败");
+        index_.Upsert(3, "蓝牙 耳机 连接 断开");
+        index_.Upsert(4, "小明 在 公园 踢 足球");
+        index_.Flush();
+    }
+
+    InvertedIndex index_;
+};
+
+TEST_F(InvertedIndexTest, RanksDocumentsMatchingMoreTerms) {
+    auto results = index_.Search("Win11 蓝牙", 10);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].id, 1u);
+    EXPECT_GT(results[0].score, results[1].score);
+    EXPECT_GE(results[1].score, results[2].score);
+}
+
+TEST_F(InvertedIndexTest, QueryIsCaseInsensitive) {
+    auto results = index_.Search("WIN11", 10);
+    ASSERT_EQ(results.size(), 2u);
+}
+
+TEST_F(InvertedIndexTest, TopKLimitsResults) {
+    auto results = index_.Search("Win11 蓝牙", 1);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].id, 1u);
+    EXPECT_TRUE(index_.Search("不存在", 10).empty());
+}
+
+TEST_F(InvertedIndexTest, RemoveHidesDocument) {
+    index_.Remove(1);
+    auto results = index_.Search("Win11 蓝牙", 10);
+    ASSERT_EQ(results.size(), 2u);
+    for (const auto& r : results) EXPECT_NE(r.id, 1u);
+    EXPECT_EQ(index_.docCount(), 3u);
+}
+
+TEST_F(InvertedIndexTest, UpsertReplacesOnFlush) {
+    index_.Upsert(4, "蓝牙 鼠标");
+    // Buffered version is not searchable yet, old version still is
+    EXPECT_TRUE(index_.Search("鼠标", 10).empty());
+    auto old = index_.Search("足球", 10);
+    ASSERT_EQ(old.size(), 1u);
+    EXPECT_EQ(old[0].id, 4u);
+    EXPECT_EQ(index_.bufferedCount(), 1u);
+    EXPECT_EQ(index_.docCount(), 4u);
+
+    index_.Flush();
+    EXPECT_EQ(index_.segmentCount(), 2u);
+    EXPECT_TRUE(index_.Search("足球", 10).empty());
+    auto results = index_.Search("鼠标", 10);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].id, 4u);
+    EXPECT_EQ(index_.docCount(), 4u);
+}
+
+TEST_F(InvertedIndexTest, ReupsertKeepsDocumentFoundUntilSealed) {
+    index_.Upsert(1, "Win11 蓝牙 打不开 驱动 异常 重启");
+    auto results = index_.Search("蓝牙 驱动", 10);
+    ASSERT_FALSE(results.empty());
+    EXPECT_EQ(results[0].id, 1u);
+
+    // A remove still hides the buffered and the sealed copy at once
+    index_.Remove(1);
+    for (const auto& r : index_.Search("蓝牙 驱动", 10)) EXPECT_NE(r.id, 1u);
+    index_.Flush();
+    for (const auto& r : index_.Search("重启", 10)) EXPECT_NE(r.id, 1u);
+}
+
+TEST(InvertedIndexScoringTest, RepeatedUpsertsKeepScoresPositive) {
+    InvertedIndex index;
+    for (int round = 0; round < 4; ++round) {
+        index.Upsert(1, "bluetooth driver crash");
+        index.Flush();
+    }
+    EXPECT_EQ(index.docCount(), 1u);
+    for (auto evaluation : {QueryEvaluation::EXHAUSTIVE, QueryEvaluation::BLOCK_MAX_WAND}) {
+        auto results = index.Search("bluetooth", 10, evaluation);
+        ASSERT_EQ(results.size(), 1u);
+        EXPECT_EQ(results[0].id, 1u);
+        EXPECT_GT(results[0].score, 0.0f);
+    }
+    EXPECT_GE(Bm25Scorer::idf(1, 5), 0.0f);
+}
+
+TEST(InvertedIndexOptionsTest, AutoSealAndConfig) {
+    auto& config = memory::core::Config::getInstance();
+    config.set("bm25_k1", "1.5");
+    config.set("bm25_b", "0.5");
+    config.set("max_buffered_docs", "100");
+
+    SearchIndexOptions options = SearchIndexOptions::fromConfig(config);
+    EXPECT_FLOAT_EQ(options.bm25.k1, 1.5f);
+    EXPECT_FLOAT_EQ(options.bm25.b, 0.5f);
+    EXPECT_EQ(options.max_buffered_docs, 100u);
+
+    InvertedIndex index(options);
+    for (uint64_t id = 0; id < 1000; ++id) {
+        index.Upsert(id, "common term" + std::string(id % 10 == 0 ? " rare" : ""));
+    }
+    EXPECT_EQ(index.segmentCount(), 10u);
+    EXPECT_EQ(index.docCount(), 1000u);
+
+    auto results = index.Search("rare", 200);
+    ASSERT_EQ(results.size(), 100u);
+    for (size_t i = 1; i < results.size(); ++i) {
+        EXPECT_LT(results[i - 1].id, results[i].id);  // equal scores -> id order
+    }
+}
+
+TEST(InvertedIndexWalTest, LogRebuildsUnsavedChanges) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_search_wal";
+    std::filesystem::remove_all(dir);
+    SearchIndexOptions options;
+    options.max_buffered_docs = 4;
+    std::vector<memory::core::ScoredId> before;
+    {
+        auto wal = std::make_shared<memory::core::WriteAheadLog>(dir.string());
+        InvertedIndex index(options);
+        index.attachWal(wal);
+        for (uint64_t id = 0; id < 10; ++id) {
+            std::string text = "蓝牙 耳机 ";
+            text += std::to_string(id);
+            index.Upsert(id, text);
+        }
+        index.Upsert(3, "足球 比赛");
+        index.Remove(5);
+        before = index.Search("蓝牙", 20);
+        EXPECT_EQ(wal->lastLsn(), 12u);
+        EXPECT_EQ(wal->durableLsn(), 12u);
+    }
+
+    // Nothing was saved: the log alone rebuilds sealed and buffered docs
+    {
+        auto wal = std::make_shared<memory::core::WriteAheadLog>(dir.string());
+        InvertedIndex index(options);
+        index.attachWal(wal);
+        auto after = index.Search("蓝牙", 20);
+        ASSERT_EQ(after.size(), before.size());
+        for (size_t i = 0; i < before.size(); ++i) {
+            EXPECT_EQ(after[i].id, before[i].id);
+            EXPECT_FLOAT_EQ(after[i].score, before[i].score);
+        }
+        EXPECT_EQ(index.bufferedCount(), 3u);
+        index.Flush();
+        EXPECT_EQ(index.Search("足球", 10)[0].id, 3u);
+        EXPECT_TRUE(index.Search("5", 10).empty());
+        index.Upsert(20, "新 文档");
+        EXPECT_EQ(wal->lastLsn(), 13u);
+    }
+
+    // Records up to the LSN a snapshot covers are skipped
+    auto wal = std::make_shared<memory::core::WriteAheadLog>(dir.string());
+    InvertedIndex index(options);
+    index.attachWal(wal, 12);
+    index.Flush();
+    EXPECT_EQ(index.docCount(), 1u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SearchSnapshotTest, PinnedSnapshotIgnoresLaterChanges) {
+    SearchIndexOptions options;
+    options.max_buffered_docs = 8;
+    options.index_positions = true;
+    InvertedIndex index(options);
+    for (uint64_t id = 0; id < 40; ++id) {
+        std::string text = "蓝牙 耳机 ";
+        text += std::to_string(id % 5);
+        index.Upsert(id, text);
+    }
+    std::shared_ptr<const SearchSnapshot> pinned = index.snapshot();
+    auto before = index.Search(*pinned, "蓝牙", 50);
+    auto before_phrase = index.MatchAll(*pinned, "\"蓝牙 耳机\"");
+    ASSERT_EQ(before.size(), 40u);
+
+    for (uint64_t id = 0; id < 40; id += 3) index.Remove(id);
+    for (uint64_t id = 1; id < 40; id += 3) index.Upsert(id, "足球 比赛");
+    for (uint64_t id = 100; id < 120; ++id) index.Upsert(id, "蓝牙 音箱");
+    index.Flush();
+    EXPECT_GT(index.snapshot()->version, pinned->version);
+
+    // Same scores and ids: deletions after the pin and the new segments are invisible
+    auto after = index.Search(*pinned, "蓝牙", 50);
+    ASSERT_EQ(after.size(), before.size());
+    for (size_t i = 0; i < before.size(); ++i) {
+        EXPECT_EQ(after[i].id, before[i].id);
+        EXPECT_FLOAT_EQ(after[i].score, before[i].score);
+    }
+    EXPECT_EQ(index.MatchAll(*pinned, "\"蓝牙 耳机\""), before_phrase);
+    EXPECT_TRUE(index.Search(*pinned, "足球", 10).empty());
+
+    // The current snapshot has all of it
+    EXPECT_EQ(index.Search("蓝牙", 100).size(), 40u - 14 - 13 + 20);
+    EXPECT_EQ(index.Search("足球", 100).size(), 13u);
+}
+
+TEST(SearchSnapshotTest, ReadersNeverSeeAHalfAppliedWrite) {
+    // The writer keeps moving each doc a to a + 1000 and back, a removal
+    // then an upsert sealed on its own. Each snapshot must agree with its
+    // own statistics and lose at most the one doc between the two writes.
+    SearchIndexOptions options;
+    options.max_buffered_docs = 1;
+    InvertedIndex index(options);
+    for (uint64_t id = 0; id < 50; ++id) index.Upsert(id, "pair");
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int round = 0; round < 20; ++round) {
+            for (uint64_t id = 0; id < 50; ++id) {
+                uint64_t from = round % 2 == 0 ? id : id + 1000;
+                index.Remove(from);
+                index.Upsert(round % 2 == 0 ? id + 1000 : id, "pair");
+            }
+        }
+        done = true;
+    });
+    size_t checks = 0;
+    while (!done || checks == 0) {
+        auto snapshot = index.snapshot();
+        auto ids = index.MatchAny(*snapshot, "pair");
+        size_t live = 0;
+        for (const auto& part : snapshot->segments) live += part.live_count;
+        EXPECT_EQ(ids.size(), live);
+        EXPECT_EQ(ids.size(), snapshot->live_docs);
+        EXPECT_EQ(index.MatchAny(*snapshot, "pair"), ids);  // Repeatable
+        EXPECT_GE(ids.size(), 49u);
+        EXPECT_LE(ids.size(), 50u);
+        ++checks;
+    }
+    writer.join();
+    EXPECT_EQ(index.MatchAny("pair").size(), 50u);
+}
+
+TEST(QueryEvaluationTest, BlockMaxWandMatchesExhaustive) {
+    SearchIndexOptions options;
+    options.max_buffered_docs = 3000;
+    InvertedIndex index(options);
+
+    // Zipf-like vocabulary so some postings are long and some are rare
+    std::mt19937 rng(7);
+    auto pick_term = [&rng]() {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        std::string term = "t";
+        return term.append(std::to_string(static_cast<int>(std::pow(2000.0, u)) - 1));
+    };
+    for (uint64_t id = 0; id < 10000; ++id) {
+        std::string text;
+        int length = 5 + static_cast<int>(rng() % 60);
+        for (int i = 0; i < length; ++i) {
+            text += pick_term() + " ";
+        }
+        index.Upsert(id * 3, text);
+    }
+    index.Flush();
+    for (uint64_t id = 0; id < 10000; id += 17) {
+        index.Remove(id * 3);
+    }
+    // Update churn: stale postings of re-upserted ids pile up in older
+    // segments and push doc_freq well past the live doc count
+    for (int round = 0; round < 6; ++round) {
+        for (uint64_t id = 1; id < 10000; id += 4) {
+            std::string text;
+            int length = 5 + static_cast<int>(rng() % 60);
+            for (int i = 0; i < length; ++i) {
+                text += pick_term() + " ";
+            }
+            index.Upsert(id * 3, text);
+        }
+        index.Flush();
+    }
+    EXPECT_EQ(stringToQueryEvaluation("exhaustive"), QueryEvaluation::EXHAUSTIVE);
+    EXPECT_THROW(stringToQueryEvaluation("bogus"), memory::core::QueryException);
+
+    for (int q = 0; q < 60; ++q) {
+        std::string query;
+        int terms = 1 + q % 5;
+        for (int i = 0; i < terms; ++i) {
+            query += pick_term() + " ";
+        }
+        for (size_t topk : {1u, 10u, 200u}) {
+            auto pruned = index.Search(query, topk, QueryEvaluation::BLOCK_MAX_WAND);
+            auto exact = index.Search(query, topk, QueryEvaluation::EXHAUSTIVE);
+            ASSERT_EQ(pruned.size(), exact.size()) << query;
+            for (size_t i = 0; i < exact.size(); ++i) {
+                ASSERT_EQ(pruned[i].id, exact[i].id) << query << " rank " << i;
+                ASSERT_EQ(pruned[i].score, exact[i].score) << query << " rank " << i;
+                ASSERT_GE(exact[i].score, 0.0f) << query << " rank " << i;
+            }
+        }
+    }
+}
+
+TEST(SearchCompactionTest, MergeDropsDeletedDocsAndKeepsScores) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "memory_test_search_compaction";
+    fs::remove_all(dir);
+    SearchIndexOptions options;
+    options.max_buffered_docs = 20;
+    options.index_positions = true;
+    options.directory = dir.string();
+    InvertedIndex index(options);
+    // Reference: the surviving docs indexed from scratch in one segment
+    SearchIndexOptions fresh_options;
+    fresh_options.index_positions = true;
+    InvertedIndex fresh(fresh_options);
+    for (uint64_t id = 0; id < 200; ++id) {
+        std::string text = "会议 记录 topic" + std::to_string(id % 7) + " note" + std::to_string(id % 11);
+        index.Upsert(id, text);
+        if (id % 3 != 0) fresh.Upsert(id, text);
+    }
+    fresh.Flush();
+    for (uint64_t id = 0; id < 200; id += 3) index.Remove(id);
+    ASSERT_EQ(index.segmentCount(), 10u);
+    EXPECT_NEAR(index.fragmentation(), 67.0 / 200.0, 1e-9);
+
+    std::vector<std::string> queries = {"topic3", "topic1 note4", "\"会议 记录\" topic5", "note*"};
+    std::vector<std::vector<memory::core::ScoredId>> before;
+    for (const auto& query : queries) before.push_back(index.Search(query, 200));
+    auto pinned = index.snapshot();
+
+    memory::core::CompactionOptions compaction;
+    memory::core::RateLimiter unlimited;
+    ASSERT_TRUE(index.compactionDue(compaction));
+    memory::core::CompactionResult result = index.compact(compaction, unlimited);
+    EXPECT_EQ(result.target, "search");
+    EXPECT_EQ(result.items_before, 200u);
+    EXPECT_EQ(result.items_after, 133u);
+    EXPECT_LT(result.bytes_after, result.bytes_before);
+    EXPECT_EQ(result.fragmentation_after, 0.0);
+    EXPECT_EQ(index.segmentCount(), 1u);
+    EXPECT_FALSE(index.compactionDue(compaction));
+    size_t dictionaries = std::distance(fs::directory_iterator(dir), fs::directory_iterator());
+    EXPECT_EQ(dictionaries, 1u);
+
+    // Deleted docs no longer count towards document frequencies, so scores
+    // match a fresh build of the same docs exactly
+    for (size_t q = 0; q < queries.size(); ++q) {
+        auto after = index.Search(queries[q], 200);
+        auto expected = fresh.Search(queries[q], 200);
+        ASSERT_EQ(after.size(), before[q].size()) << queries[q];
+        ASSERT_EQ(after.size(), expected.size()) << queries[q];
+        for (size_t i = 0; i < after.size(); ++i) {
+            EXPECT_EQ(after[i].id, expected[i].id) << queries[q];
+            EXPECT_EQ(after[i].score, expected[i].score) << queries[q];
+        }
+    }
+    // The pinned snapshot still reads the merged-away segments
+    auto pinned_results = index.Search(*pinned, "topic3", 200);
+    ASSERT_EQ(pinned_results.size(), before[0].size());
+    for (size_t i = 0; i < pinned_results.size(); ++i) {
+        EXPECT_EQ(pinned_results[i].id, before[0][i].id);
+        EXPECT_EQ(pinned_results[i].score, before[0][i].score);
+    }
+
+    // Writes keep finding the moved docs
+    index.Remove(1);
+    index.Upsert(2, "replaced");
+    index.Flush();
+    EXPECT_EQ(index.docCount(), 132u);
+    EXPECT_EQ(index.MatchAny("topic1").size(), index.MatchAny(*pinned, "topic1").size() - 1);
+    EXPECT_EQ(index.MatchAny("topic2").size(), index.MatchAny(*pinned, "topic2").size() - 1);
+    EXPECT_EQ(index.MatchAll("replaced"), std::vector<uint64_t>{2});
+    fs::remove_all(dir);
+}
+
+TEST(SearchCompactionTest, MergesOneSizeTierAtATime) {
+    SearchIndexOptions options;
+    options.max_buffered_docs = 3;
+    InvertedIndex index(options);
+    for (uint64_t id = 0; id < 15; ++id) index.Upsert(id, "shared term" + std::to_string(id));
+    ASSERT_EQ(index.segmentCount(), 5u);
+
+    memory::core::CompactionOptions compaction;
+    compaction.merge_factor = 4;
+    memory::core::RateLimiter unlimited;
+    ASSERT_TRUE(index.compactionDue(compaction));
+    index.compact(compaction, unlimited);
+    // Four 3-doc segments became one of 12, the fifth waits for its tier
+    EXPECT_EQ(index.segmentCount(), 2u);
+    EXPECT_FALSE(index.compactionDue(compaction));
+    EXPECT_EQ(index.MatchAny("shared").size(), 15u);
+    EXPECT_EQ(index.MatchAll("term7").size(), 1u);
+}
+
+TEST(SearchCompactionTest, WritesDuringCompactionAreKept) {
+    SearchIndexOptions options;
+    options.max_buffered_docs = 10;
+    InvertedIndex index(options);
+    for (uint64_t id = 0; id < 400; ++id) index.Upsert(id, "alpha beta");
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        // Deletes and re-inserts land while merges are in flight
+        for (uint64_t id = 0; id < 400; id += 2) {
+            index.Remove(id);
+            if (id % 4 == 0) index.Upsert(id + 1000, "alpha gamma");
+        }
+        index.Flush();
+        done = true;
+    });
+    memory::core::CompactionOptions compaction;
+    compaction.fragmentation_threshold = 0.0;
+    compaction.merge_factor = 3;
+    memory::core::RateLimiter unlimited;
+    while (!done) index.compact(compaction, unlimited);
+    writer.join();
+    while (index.compactionDue(compaction)) index.compact(compaction, unlimited);
+
+    EXPECT_EQ(index.MatchAny("beta").size(), 200u);
+    EXPECT_EQ(index.MatchAny("gamma").size(), 100u);
+    EXPECT_EQ(index.docCount(), 300u);
+    EXPECT_EQ(index.fragmentation(), 0.0);
+    index.Remove(1);
+    index.Remove(1000);
+    EXPECT_EQ(index.MatchAny("alpha").size(), 298u);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "memory/search/inverted_index.h"
+#include "memory/search/postings.h"
+#include "memory/search/simd_kernels.h"
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+
+using namespace memory::search;
+using memory::core::SimdLevel;
+
+namespace {
+
+std::vector<const PostingKernels*> availableKernels() {
+    std::vector<const PostingKernels*> kernels;
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2}) {
+        if (const PostingKernels* k = postingKernels(level)) kernels.push_back(k);
+    }
+    return kernels;
+}
+
+// Sorted unique values drawn from [0, universe)
+std::vector<uint32_t> randomSet(std::mt19937& rng, size_t count, uint32_t universe) {
+    std::set<uint32_t> values;
+    while (values.size() < count) {
+        values.insert(static_cast<uint32_t>(rng() % universe));
+    }
+    return {values.begin(), values.end()};
+}
+
+} // namespace
+
+TEST(SimdKernelsTest, ScalarAlwaysAvailable) {
+    ASSERT_NE(postingKernels(SimdLevel::SCALAR), nullptr);
+    EXPECT_STREQ(postingKernels(SimdLevel::SCALAR)->name, "scalar");
+    EXPECT_TRUE(memory::core::simdLevelSupported(postingKernels().level));
+}
+
+TEST(SimdKernelsTest, UnpackAndPrefixSumMatchScalar) {
+    std::mt19937 rng(1);
+    const PostingKernels& scalar = *postingKernels(SimdLevel::SCALAR);
+    for (const PostingKernels* kernels : availableKernels()) {
+        for (uint32_t bits = 0; bits <= 32; ++bits) {
+            uint32_t values[kPostingBlockSize];
+            for (auto& v : values) {
+                v = bits == 0 ? 0 : static_cast<uint32_t>(rng()) >> (32 - bits);
+            }
+            std::vector<uint8_t> packed(packedBlockBytes(bits) + kPostingPadding, 0);
+            packBlock(values, bits, packed.data());
+
+            uint32_t expected[kPostingBlockSize];
+            uint32_t actual[kPostingBlockSize];
+            scalar.unpack(packed.data(), bits, expected);
+            kernels->unpack(packed.data(), bits, actual);
+            ASSERT_TRUE(std::equal(expected, expected + kPostingBlockSize, actual))
+                << kernels->name << " bits=" << bits;
+
+            scalar.prefix_sum(expected, 17);
+            kernels->prefix_sum(actual, 17);
+            ASSERT_TRUE(std::equal(expected, expected + kPostingBlockSize, actual))
+                << kernels->name << " prefix bits=" << bits;
+        }
+    }
+}
+
+TEST(SimdKernelsTest, IntersectAndUnionMatchStd) {
+    std::mt19937 rng(2);
+    struct Shape { size_t na, nb; uint32_t universe; };
+    std::vector<Shape> shapes = {
+        {0, 10, 100}, {1, 1, 2}, {3, 5, 10}, {7, 9, 20}, {100, 100, 150},
+        {1000, 1200, 5000}, {10, 5000, 20000}, {37, 100000, 200000}, {513, 511, 1024},
+        {4, 4, 8}, {5, 100, 1u << 31},
+    };
+    for (const PostingKernels* kernels : availableKernels()) {
+        for (const Shape& shape : shapes) {
+            for (int round = 0; round < 5; ++round) {
+                auto a = randomSet(rng, shape.na, shape.universe);
+                auto b = randomSet(rng, shape.nb, shape.universe);
+
+                std::vector<uint32_t> expected;
+                std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                std::vector<uint32_t> out(std::min(a.size(), b.size()) + kKernelOutputSlack);
+                out.resize(kernels->intersect(a.data(), a.size(), b.data(), b.size(), out.data()));
+                ASSERT_EQ(out, expected) << kernels->name << " intersect " << shape.na << "x" << shape.nb;
+
+                expected.clear();
+                std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                out.assign(a.size() + b.size() + kKernelOutputSlack, 0);
+                out.resize(kernels->merge_union(a.data(), a.size(), b.data(), b.size(), out.data()));
+                ASSERT_EQ(out, expected) << kernels->name << " union " << shape.na << "x" << shape.nb;
+            }
+        }
+    }
+}
+
+TEST(SimdKernelsTest, BooleanMatch) {
+    SearchIndexOptions options;
+    options.max_buffered_docs = 500;
+    InvertedIndex index(options);
+    for (uint64_t id = 0; id < 2000; ++id) {
+        std::string text = "doc";
+        if (id % 2 == 0) text += " even";
+        if (id % 3 == 0) text += " three";
+        if (id == 1998) text += " 0x8007045d";
+        index.Upsert(id, text);
+    }
+    index.Flush();
+    index.Remove(6);
+
+    auto both = index.MatchAll("even three");
+    EXPECT_EQ(both.size(), 333u);  // multiples of 6 below 2000, minus the removed one
+    EXPECT_TRUE(std::is_sorted(both.begin(), both.end()));
+    EXPECT_FALSE(std::binary_search(both.begin(), both.end(), 6u));
+
+    auto any = index.MatchAny("even three");
+    EXPECT_EQ(any.size(), 1000u + 667u - 334u - 1u);
+
+    auto code = index.MatchAll("错误码 0x8007045D");
+    EXPECT_TRUE(code.empty());
+    code = index.MatchAll("even 0x8007045D");
+    ASSERT_EQ(code.size(), 1u);
+    EXPECT_EQ(code[0], 1998u);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "memory/search/inverted_index.h"
+#include "memory/search/term_dictionary.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+using namespace memory::search;
+
+namespace {
+
+std::vector<std::string> sampleTerms() {
+    std::mt19937 rng(5);
+    std::set<std::string> terms = {"a", "ab", "abc", "abd", "b", "蓝", "蓝牙", "蓝色", "蓝天白云", "\xff", "\xff\xff"};
+    const char* stems[] = {"win", "error", "0x8007", "驱动", "更新"};
+    while (terms.size() < 1000) {
+        std::string term = stems[rng() % 5];
+        int extra = static_cast<int>(rng() % 6);
+        for (int i = 0; i < extra; ++i) term.push_back(static_cast<char>('a' + rng() % 26));
+        terms.insert(term);
+    }
+    return {terms.begin(), terms.end()};
+}
+
+std::vector<uint8_t> buildImage(const std::vector<std::string>& terms) {
+    std::vector<uint8_t> image;
+    TermDictionaryWriter writer(image);
+    for (size_t i = 0; i < terms.size(); ++i) {
+        EXPECT_EQ(writer.add(terms[i]), i);
+    }
+    writer.finish();
+    return image;
+}
+
+} // namespace
+
+TEST(TermDictionaryTest, ExactLookupAndLowerBound) {
+    auto terms = sampleTerms();
+    auto image = buildImage(terms);
+    TermDictionary dict(image);
+    ASSERT_EQ(dict.size(), terms.size());
+
+    for (size_t i = 0; i < terms.size(); ++i) {
+        ASSERT_EQ(dict.find(terms[i]), i) << terms[i];
+    }
+    for (std::string probe : {"", "0", "aa", "abcd", "b0", "win", "winzzzzzz", "蓝牙耳机", "zzz", "\xff\xff\xff"}) {
+        auto it = std::lower_bound(terms.begin(), terms.end(), probe);
+        EXPECT_EQ(dict.lowerBound(probe), static_cast<uint32_t>(it - terms.begin())) << probe;
+        bool present = it != terms.end() && *it == probe;
+        EXPECT_EQ(dict.find(probe) != TermDictionary::kNotFound, present) << probe;
+    }
+}
+
+TEST(TermDictionaryTest, PrefixRangeAndIteration) {
+    auto terms = sampleTerms();
+    auto image = buildImage(terms);
+    TermDictionary dict(image);
+
+    for (std::string prefix : {"", "a", "ab", "蓝", "蓝牙", "win", "errorq", "\xff", "nothing"}) {
+        std::vector<std::string> expected;
+        for (const auto& term : terms) {
+            if (term.compare(0, prefix.size(), prefix) == 0) expected.push_back(term);
+        }
+        auto [first, last] = dict.prefixRange(prefix);
+        std::vector<std::string> actual;
+        for (auto it = dict.iterate(first, last); it.valid(); it.next()) {
+            actual.emplace_back(it.term());
+        }
+        EXPECT_EQ(actual, expected) << prefix;
+    }
+
+    auto it = dict.iterate(37);
+    for (uint32_t ord = 37; ord < terms.size(); ++ord, it.next()) {
+        ASSERT_TRUE(it.valid());
+        ASSERT_EQ(it.term(), terms[ord]);
+    }
+    EXPECT_FALSE(it.valid());
+}
+
+TEST(TermDictionaryTest, EmptyAndInvalidInput) {
+    auto image = buildImage({});
+    TermDictionary empty(image);
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_EQ(empty.find("x"), TermDictionary::kNotFound);
+    EXPECT_EQ(empty.prefixRange("x"), std::make_pair(0u, 0u));
+
+    std::vector<uint8_t> out;
+    TermDictionaryWriter writer(out);
+    writer.add("b");
+    EXPECT_THROW(writer.add("a"), memory::core::IndexException);
+    EXPECT_THROW(writer.add("b"), memory::core::IndexException);
+
+    auto corrupt = buildImage(sampleTerms());
+    corrupt[100] ^= 0x20;
+    EXPECT_THROW(TermDictionary{corrupt}, memory::core::StorageException);
+}
+
+TEST(TermDictionaryTest, IndexPrefixQueriesAndMappedSegments) {
+    auto dir = std::filesystem::temp_directory_path() / "memory_test_term_dictionary";
+    std::filesystem::remove_all(dir);
+
+    SearchIndexOptions options;
+    options.directory = dir.string();
+    options.max_prefix_expansions = 2;
+    InvertedIndex index(options);
+    index.Upsert(1, "蓝牙 耳机 Win10");
+    index.Upsert(2, "蓝色 天空");
+    index.Flush();
+    index.Upsert(3, "蓝天 win11 windows");
+    index.Upsert(4, "红色 Windows");
+    index.Flush();
+    EXPECT_TRUE(std::filesystem::exists(dir / "segment_0.tdic"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "segment_1.tdic"));
+
+    EXPECT_EQ(index.MatchAny("蓝*"), (std::vector<uint64_t>{1, 3}));  // Capped at two expansions
+    EXPECT_EQ(index.MatchAll("windows win*"), (std::vector<uint64_t>{3, 4}));
+    EXPECT_EQ(index.MatchAll("耳机 win1*"), (std::vector<uint64_t>{1}));
+    EXPECT_TRUE(index.MatchAll("zz*").empty());
+
+    // Expands to windows (df 2) and win10 (df 1, ordered before win11)
+    auto results = index.Search("win*", 10);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].id, 1u);
+    EXPECT_EQ(index.MatchAny("win1*"), (std::vector<uint64_t>{1, 3}));
+    std::filesystem::remove_all(dir);
+}
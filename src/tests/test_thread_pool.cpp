@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "memory/core/thread_pool.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using memory::core::ThreadPool;
+
+TEST(ThreadPoolTest, SubmitReturnsResults) {
+    ThreadPool pool(3);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.submit([i] { return i * i; }));
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(results[i].get(), i * i);
+    }
+}
+
+TEST(ThreadPoolTest, ParallelForRunsEveryTaskOnce) {
+    for (size_t threads : {0u, 1u, 4u}) {
+        ThreadPool pool(threads);
+        std::vector<std::atomic<int>> runs(1000);
+        std::atomic<size_t> max_worker{0};
+        pool.parallelFor(runs.size(), [&](size_t task, size_t worker) {
+            ++runs[task];
+            size_t seen = max_worker.load();
+            while (worker > seen && !max_worker.compare_exchange_weak(seen, worker)) {}
+        });
+        for (const auto& r : runs) ASSERT_EQ(r.load(), 1);
+        EXPECT_LE(max_worker.load(), threads);
+    }
+}
+
+TEST(ThreadPoolTest, NestedParallelForAndExceptions) {
+    ThreadPool pool(2);
+    std::atomic<int> total{0};
+    // Every pool thread blocks in an inner parallelFor; callers finish alone
+    pool.parallelFor(8, [&](size_t, size_t) {
+        pool.parallelFor(8, [&](size_t, size_t) { ++total; });
+    });
+    EXPECT_EQ(total.load(), 64);
+
+    EXPECT_THROW(pool.parallelFor(10, [](size_t task, size_t) {
+        if (task == 7) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "memory/search/inverted_index.h"
+#include "memory/search/term_interner.h"
+#include "memory/search/tokenizer.h"
+#include "memory/core/config.h"
+#include <string>
+#include <vector>
+
+using namespace memory::search;
+
+namespace {
+
+std::vector<std::string> tokens(const Tokenizer& tokenizer, std::string_view text) {
+    std::vector<std::string> out;
+    tokenizer.tokenize(text, [&](const Token& token) { out.emplace_back(token.text); });
+    return out;
+}
+
+using Strings = std::vector<std::string>;
+
+} // namespace
+
+TEST(TokenizerTest, ChineseBigrams) {
+    StandardTokenizer tokenizer;
+    EXPECT_EQ(tokens(tokenizer, "小明在公园里踢足球"),
+              (Strings{"小明", "明在", "在公", "公园", "园里", "里踢", "踢足", "足球"}));
+    // Punctuation splits runs; a lone character is a unigram, stopwords are dropped
+    EXPECT_EQ(tokens(tokenizer, "蓝牙，踢！在。"), (Strings{"蓝牙", "踢"}));
+}
+
+TEST(TokenizerTest, MixedScriptLowercaseAndFolding) {
+    StandardTokenizer tokenizer;
+    EXPECT_EQ(tokens(tokenizer, "Win11蓝牙打不开, Error 0x8007045D"),
+              (Strings{"win11", "蓝牙", "牙打", "打不", "不开", "error", "0x8007045d"}));
+    // Only ASCII is lowercased; fullwidth letters and digits fold to ASCII
+    EXPECT_EQ(tokens(tokenizer, "ＷＩＮ１１ Café_Ünï"), (Strings{"win11", "café_Ünï"}));
+    EXPECT_EQ(tokens(tokenizer, "The cat is on the MAT"), (Strings{"cat", "mat"}));
+    EXPECT_EQ(tokens(tokenizer, "カタカナ 한국어"), (Strings{"カタ", "タカ", "カナ", "한국", "국어"}));
+}
+
+TEST(TokenizerTest, PositionsSkipStopwords) {
+    StandardTokenizer tokenizer;
+    std::vector<uint32_t> positions;
+    tokenizer.tokenize("the quick fox", [&](const Token& token) { positions.push_back(token.position); });
+    EXPECT_EQ(positions, (std::vector<uint32_t>{1, 2}));
+}
+
+TEST(TokenizerTest, MalformedAndOversizedInput) {
+    StandardTokenizer tokenizer;
+    std::string bad = "ab\xff" "cd\xe4\xb8" "ef";  // stray byte and truncated sequence
+    EXPECT_EQ(tokens(tokenizer, bad), (Strings{"ab", "cd", "ef"}));
+
+    std::string blob(kMaxTokenBytes + 1, 'x');
+    EXPECT_EQ(tokens(tokenizer, "keep " + blob + " this2"), (Strings{"keep", "this2"}));
+    EXPECT_TRUE(tokens(tokenizer, "").empty());
+    EXPECT_TRUE(tokens(tokenizer, " ,.!? —“”").empty());
+}
+
+TEST(TokenizerTest, Options) {
+    TokenizerOptions options;
+    options.cjk_bigrams = false;
+    options.filter_stopwords = false;
+    StandardTokenizer unigrams(options);
+    EXPECT_EQ(tokens(unigrams, "在公园 the"), (Strings{"在", "公", "园", "the"}));
+
+    options.cjk_bigrams = true;
+    options.filter_stopwords = true;
+    options.stopwords = {"公园", "foo"};
+    StandardTokenizer custom(options);
+    EXPECT_EQ(tokens(custom, "在公园 the foo"), (Strings{"在公", "the"}));
+
+    auto& config = memory::core::Config::getInstance();
+    config.set("cjk_bigrams", "false");
+    EXPECT_FALSE(TokenizerOptions::fromConfig(config).cjk_bigrams);
+    config.set("cjk_bigrams", "true");
+}
+
+TEST(TermInternerTest, DenseStableIds) {
+    TermInterner interner;
+    EXPECT_EQ(interner.intern("蓝牙"), 0u);
+    EXPECT_EQ(interner.intern("win11"), 1u);
+    EXPECT_EQ(interner.intern("蓝牙"), 0u);
+    EXPECT_EQ(interner.find("win11"), 1u);
+    EXPECT_EQ(interner.find("missing"), TermInterner::kUnknownId);
+
+    // Enough terms to spill into several arena chunks; earlier views stay valid
+    for (int i = 0; i < 20000; ++i) {
+        interner.intern("term" + std::to_string(i));
+    }
+    EXPECT_EQ(interner.size(), 20002u);
+    EXPECT_EQ(interner.str(0), "蓝牙");
+    EXPECT_EQ(interner.str(1234 + 2), "term1234");
+    EXPECT_EQ(interner.find("term19999"), 20001u);
+
+    StandardTokenizer tokenizer;
+    std::vector<uint32_t> ids;
+    internTokens(tokenizer, "Win11 蓝牙 win11", interner, ids);
+    EXPECT_EQ(ids, (std::vector<uint32_t>{1, 0, 1}));
+}
+
+TEST(TokenizerTest, IndexMatchesUnsegmentedChinese) {
+    InvertedIndex index;
+    index.Upsert(1, "小明在公园里踢足球");
+    index.Upsert(2, "今天公园人很多");
+    index.Upsert(3, "他喜欢看足球比赛");
+    index.Flush();
+
+    auto results = index.Search("小明 踢足球", 10);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].id, 1u);
+    EXPECT_EQ(results[1].id, 3u);
+    EXPECT_EQ(index.MatchAll("公园 足球"), (std::vector<uint64_t>{1}));
+}
+
+TEST(TokenizerTest, PluggableTokenizer) {
+    // Splits on '|' only, without normalization
+    class PipeTokenizer : public Tokenizer {
+    public:
+        void tokenize(std::string_view text, TokenSink sink) const override {
+            uint32_t position = 0;
+            size_t start = 0;
+            while (start <= text.size()) {
+                size_t end = std::min(text.find('|', start), text.size());
+                if (end > start) sink(Token{text.substr(start, end - start), position++});
+                start = end + 1;
+            }
+        }
+    };
+
+    InvertedIndex index({}, std::make_shared<PipeTokenizer>());
+    index.Upsert(1, "Hello World|foo");
+    index.Flush();
+    EXPECT_EQ(index.Search("Hello World", 10).size(), 1u);
+    EXPECT_TRUE(index.Search("hello world", 10).empty());
+    EXPECT_EQ(index.MatchAll("foo"), (std::vector<uint64_t>{1}));
+}
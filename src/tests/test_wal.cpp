@@ -0,0 +1,324 @@
+#include <gtest/gtest.h>
+#include "memory/core/errors.h"
+#include "memory/core/wal.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace memory::core;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path freshDirectory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    return dir;
+}
+
+// Payload of record i: its index and i % 50 bytes derived from it
+std::vector<uint8_t> payloadOf(uint64_t i) {
+    WalEncoder encoder;
+    encoder.put<uint64_t>(i);
+    for (uint64_t j = 0; j < i % 50; ++j) encoder.put<uint8_t>(static_cast<uint8_t>(i * 7 + j));
+    return {encoder.bytes().begin(), encoder.bytes().end()};
+}
+
+WalStream streamOf(uint64_t i) {
+    return static_cast<WalStream>(1 + i % 3);
+}
+
+// Replays the log and checks it holds records 0..n-1 of payloadOf at LSNs
+// 1..n; returns n
+uint64_t checkPrefix(const WriteAheadLog& wal) {
+    uint64_t n = 0;
+    wal.replay(0, [&](const WalRecord& record) {
+        EXPECT_EQ(record.lsn, n + 1);
+        EXPECT_EQ(record.stream, streamOf(n));
+        auto expected = payloadOf(n);
+        EXPECT_TRUE(std::equal(record.payload.begin(), record.payload.end(), expected.begin(), expected.end()))
+            << "record " << n;
+        ++n;
+    });
+    return n;
+}
+
+std::vector<fs::path> segmentFiles(const fs::path& dir) {
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir)) files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+#if !defined(_WIN32)
+// Body of a forked writer: continues each thread's sequence where the log
+// ends and reports every acknowledged record as (thread, seq) on fd until
+// it is killed
+[[noreturn]] void runWriter(const std::string& dir, WalOptions options, uint32_t thread_count, int fd) {
+    try {
+        WriteAheadLog wal(dir, options);
+        std::vector<uint64_t> start(thread_count, 0);
+        wal.replay(0, [&](const WalRecord& record) {
+            WalDecoder decoder(record);
+            uint32_t t = decoder.get<uint32_t>();
+            start[t] = decoder.get<uint64_t>() + 1;
+        });
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                std::vector<uint8_t> filler(1 + t * 37);
+                for (uint64_t seq = start[t];; ++seq) {
+                    WalEncoder record;
+                    record.put<uint32_t>(t).put<uint64_t>(seq).putArray<uint8_t>(filler);
+                    wal.write(WalStream::SEARCH, 1, record.bytes());
+                    uint64_t ack[2] = {t, seq};
+                    if (::write(fd, ack, sizeof(ack)) != static_cast<ssize_t>(sizeof(ack))) ::_exit(1);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    } catch (const std::exception&) {
+        ::_exit(2);
+    }
+    ::_exit(0);
+}
+#endif
+
+} // namespace
+
+TEST(WalTest, AppendReplayAndReopen) {
+    fs::path dir = freshDirectory("memory_test_wal_basic");
+    WalOptions options{.segment_bytes = 4096};
+    {
+        WriteAheadLog wal(dir.string(), options);
+        EXPECT_EQ(wal.lastLsn(), 0u);
+        for (uint64_t i = 0; i < 500; ++i) EXPECT_EQ(wal.write(streamOf(i), 7, payloadOf(i)), i + 1);
+        EXPECT_EQ(wal.durableLsn(), 500u);
+        EXPECT_GT(wal.segmentCount(), 3u);
+        EXPECT_EQ(checkPrefix(wal), 500u);
+    }
+
+    WriteAheadLog wal(dir.string(), options);
+    EXPECT_EQ(wal.lastLsn(), 500u);
+    EXPECT_EQ(checkPrefix(wal), 500u);
+    // Appends continue the sequence in a new segment
+    size_t segments = wal.segmentCount();
+    for (uint64_t i = 500; i < 600; ++i) wal.append(streamOf(i), 7, payloadOf(i));
+    wal.flush();
+    EXPECT_EQ(wal.segmentCount(), segments + 1);
+    EXPECT_EQ(checkPrefix(wal), 600u);
+
+    // One stream from an LSN on
+    std::vector<uint64_t> lsns;
+    wal.replay(WalStream::GRAPH, 550, [&](const WalRecord& record) {
+        EXPECT_EQ(record.op, 7);
+        lsns.push_back(record.lsn);
+    });
+    ASSERT_FALSE(lsns.empty());
+    EXPECT_EQ(lsns.front(), 551u);  // Record 550 is GRAPH
+    for (uint64_t lsn : lsns) EXPECT_EQ(streamOf(lsn - 1), WalStream::GRAPH);
+
+    // Released segments go; replay past them still works
+    wal.releaseUpTo(400);
+    EXPECT_LT(wal.segmentCount(), segments);
+    uint64_t first = 0;
+    size_t count = 0;
+    wal.replay(400, [&](const WalRecord& record) {
+        if (count++ == 0) first = record.lsn;
+    });
+    EXPECT_EQ(first, 401u);
+    EXPECT_EQ(count, 200u);
+    // The last segment always stays, so the LSNs carry on after a restart
+    wal.releaseUpTo(600);
+    EXPECT_EQ(wal.segmentCount(), 1u);
+}
+
+TEST(WalTest, TornTailIsCutOff) {
+    fs::path dir = freshDirectory("memory_test_wal_torn");
+    {
+        WriteAheadLog wal(dir.string());
+        for (uint64_t i = 0; i < 100; ++i) wal.append(streamOf(i), 1, payloadOf(i));
+        wal.flush();
+    }
+    auto files = segmentFiles(dir);
+    ASSERT_EQ(files.size(), 1u);
+    uint64_t size = fs::file_size(files[0]);
+
+    // A crash can stop the last write at any byte
+    std::mt19937 rng(1);
+    fs::path copy = freshDirectory("memory_test_wal_torn_copy");
+    for (int round = 0; round < 40; ++round) {
+        uint64_t cut = round == 0 ? size - 1 : rng() % size;
+        fs::remove_all(copy);
+        fs::create_directories(copy);
+        fs::copy_file(files[0], copy / files[0].filename());
+        fs::resize_file(copy / files[0].filename(), cut);
+
+        WriteAheadLog wal(copy.string());
+        uint64_t kept = checkPrefix(wal);
+        EXPECT_LT(kept, 100u);
+        EXPECT_EQ(wal.lastLsn(), kept);
+        if (round == 0) {
+            EXPECT_EQ(kept, 99u);
+        }
+        // Writing resumes right after the last whole record
+        for (uint64_t i = kept; i < kept + 10; ++i) wal.write(streamOf(i), 1, payloadOf(i));
+        EXPECT_EQ(checkPrefix(wal), kept + 10);
+    }
+
+    // A flipped bit in the last record also ends the log there
+    fs::remove_all(copy);
+    fs::create_directories(copy);
+    fs::copy_file(files[0], copy / files[0].filename());
+    {
+        std::fstream file(copy / files[0].filename(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(size - 3));
+        char byte = 0;
+        file.read(&byte, 1);
+        byte ^= 0x10;
+        file.seekp(static_cast<std::streamoff>(size - 3));
+        file.write(&byte, 1);
+    }
+    WriteAheadLog wal(copy.string());
+    EXPECT_EQ(checkPrefix(wal), 99u);
+}
+
+TEST(WalTest, DamageBeforeTheTailThrows) {
+    fs::path dir = freshDirectory("memory_test_wal_damaged");
+    {
+        WriteAheadLog wal(dir.string(), WalOptions{.segment_bytes = 4096});
+        for (uint64_t i = 0; i < 300; ++i) wal.write(streamOf(i), 1, payloadOf(i));
+    }
+    auto files = segmentFiles(dir);
+    ASSERT_GT(files.size(), 2u);
+    {
+        std::fstream file(files[0], std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(1000);
+        file.put('\x5A');
+    }
+    EXPECT_THROW(WriteAheadLog(dir.string()), StorageException);
+
+    // So does a missing segment in the middle
+    fs::path gap = freshDirectory("memory_test_wal_gap");
+    {
+        WriteAheadLog wal(gap.string(), WalOptions{.segment_bytes = 4096});
+        for (uint64_t i = 0; i < 300; ++i) wal.write(streamOf(i), 1, payloadOf(i));
+    }
+    fs::remove(segmentFiles(gap)[1]);
+    EXPECT_THROW(WriteAheadLog(gap.string()), StorageException);
+}
+
+TEST(WalTest, GroupCommitSharesSyncs) {
+    constexpr size_t kThreads = 8;
+    constexpr size_t kPerThread = 200;
+    for (bool group : {true, false}) {
+        fs::path dir = freshDirectory("memory_test_wal_group");
+        WriteAheadLog wal(dir.string(), WalOptions{.group_commit = group});
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < kPerThread; ++i) {
+                    WalEncoder record;
+                    record.put<uint64_t>(t).put<uint64_t>(i);
+                    uint64_t lsn = wal.write(WalStream::SEARCH, 1, record.bytes());
+                    // Acknowledged means durable
+                    EXPECT_GE(wal.durableLsn(), lsn);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        WalStats stats = wal.stats();
+        EXPECT_EQ(stats.records, kThreads * kPerThread);
+        if (group) {
+            EXPECT_LE(stats.syncs, stats.records);
+        } else {
+            EXPECT_EQ(stats.syncs, stats.records);
+        }
+        // Every thread's records in its own order
+        std::vector<uint64_t> next(kThreads, 0);
+        wal.replay(0, [&](const WalRecord& record) {
+            WalDecoder decoder(record);
+            uint64_t t = decoder.get<uint64_t>();
+            EXPECT_EQ(decoder.get<uint64_t>(), next[t]++);
+        });
+        for (uint64_t n : next) EXPECT_EQ(n, kPerThread);
+    }
+}
+
+#if !defined(_WIN32)
+// Kills a process writing from several threads at random points, then
+// checks that the log recovers to a gap-free prefix of every thread's
+// records that includes every record the writer acknowledged
+TEST(WalCrashTest, KilledWriterLosesNoAcknowledgedRecord) {
+    constexpr uint32_t kThreads = 4;
+    fs::path dir = freshDirectory("memory_test_wal_crash");
+    std::mt19937 rng(2024);
+    uint64_t records = 0;
+    for (int round = 0; round < 12; ++round) {
+        int acks[2];
+        ASSERT_EQ(::pipe(acks), 0);
+        pid_t child = ::fork();
+        ASSERT_GE(child, 0);
+        if (child == 0) {
+            ::close(acks[0]);
+            // Small segments, so crashes also hit rotations
+            runWriter(dir.string(), WalOptions{.group_commit = round % 3 != 2, .segment_bytes = 16384}, kThreads,
+                      acks[1]);
+        }
+
+        ::close(acks[1]);
+        // Read acknowledgements as they come until the kill
+        std::vector<int64_t> acked(kThreads, -1);
+        auto drain = [&](bool block) {
+            ::fcntl(acks[0], F_SETFL, block ? 0 : O_NONBLOCK);
+            uint64_t ack[2];
+            while (::read(acks[0], ack, sizeof(ack)) == static_cast<ssize_t>(sizeof(ack))) {
+                acked[ack[0]] = std::max<int64_t>(acked[ack[0]], static_cast<int64_t>(ack[1]));
+            }
+        };
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(5 + rng() % 60);
+        while (std::chrono::steady_clock::now() < deadline) {
+            drain(false);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        ::kill(child, SIGKILL);
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        drain(true);  // Until EOF: what was acknowledged before dying
+        ::close(acks[0]);
+        ASSERT_TRUE(WIFSIGNALED(status)) << "round " << round;
+
+        WriteAheadLog wal(dir.string());
+        std::vector<int64_t> last(kThreads, -1);
+        uint64_t lsn = 0;
+        wal.replay(0, [&](const WalRecord& record) {
+            EXPECT_EQ(record.lsn, ++lsn);
+            WalDecoder decoder(record);
+            uint32_t t = decoder.get<uint32_t>();
+            ASSERT_LT(t, kThreads);
+            int64_t seq = static_cast<int64_t>(decoder.get<uint64_t>());
+            EXPECT_EQ(seq, last[t] + 1) << "round " << round << " thread " << t;
+            last[t] = seq;
+        });
+        for (uint32_t t = 0; t < kThreads; ++t) {
+            EXPECT_GE(last[t], acked[t]) << "round " << round << " thread " << t;
+        }
+        EXPECT_GE(lsn, records);
+        records = lsn;
+    }
+    EXPECT_GT(records, 0u);
+}
+#endif
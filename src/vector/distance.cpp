@@ -0,0 +1,256 @@
+#include "memory/vector/distance.h"
+#include <stdexcept>
+
+#if defined(MEMORY_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+namespace memory::vector {
+
+namespace {
+
+// === Scalar ===
+
+float dotScalar(const float* a, const float* b, size_t n) {
+    // Four partial sums, so the compiler can vectorize without -ffast-math
+    float sums[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) sums[lane] += a[i + lane] * b[i + lane];
+    }
+    float sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+float l2SquaredScalar(const float* a, const float* b, size_t n) {
+    float sums[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            float d = a[i + lane] - b[i + lane];
+            sums[lane] += d * d;
+        }
+    }
+    float sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    for (; i < n; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+float dotU8Scalar(const float* q, const uint8_t* codes, size_t n) {
+    float sums[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) sums[lane] += q[i + lane] * codes[i + lane];
+    }
+    float sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    for (; i < n; ++i) sum += q[i] * codes[i];
+    return sum;
+}
+
+float l2U8Scalar(const float* q, const float* scale, const uint8_t* codes, size_t n) {
+    float sums[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            float d = q[i + lane] - scale[i + lane] * codes[i + lane];
+            sums[lane] += d * d;
+        }
+    }
+    float sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    for (; i < n; ++i) {
+        float d = q[i] - scale[i] * codes[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+float lookupSumScalar(const float* table, const uint8_t* codes, size_t m) {
+    float sums[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) sums[lane] += table[256 * (i + lane) + codes[i + lane]];
+    }
+    float sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    for (; i < m; ++i) sum += table[256 * i + codes[i]];
+    return sum;
+}
+
+const DistanceKernels kScalarKernels{"scalar",   core::SimdLevel::SCALAR, dotScalar,      l2SquaredScalar,
+                                     dotU8Scalar, l2U8Scalar,             lookupSumScalar};
+
+// === AVX2 + FMA ===
+
+#if defined(MEMORY_ARCH_X86)
+
+MEMORY_TARGET("avx2,fma")
+inline float horizontalSum(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+MEMORY_TARGET("avx2,fma")
+float dotAvx2(const float* a, const float* b, size_t n) {
+    // Two independent accumulators hide the FMA latency
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        i += 8;
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+MEMORY_TARGET("avx2,fma")
+float l2SquaredAvx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    if (i + 8 <= n) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        i += 8;
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Widens 8 codes to floats
+MEMORY_TARGET("avx2,fma")
+inline __m256 loadCodes(const uint8_t* codes) {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(codes));
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+}
+
+MEMORY_TARGET("avx2,fma")
+float dotU8Avx2(const float* q, const uint8_t* codes, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), loadCodes(codes + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 8), loadCodes(codes + i + 8), acc1);
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), loadCodes(codes + i), acc0);
+        i += 8;
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += q[i] * codes[i];
+    return sum;
+}
+
+MEMORY_TARGET("avx2,fma")
+float l2U8Avx2(const float* q, const float* scale, const uint8_t* codes, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_fnmadd_ps(_mm256_loadu_ps(scale + i), loadCodes(codes + i), _mm256_loadu_ps(q + i));
+        __m256 d1 =
+            _mm256_fnmadd_ps(_mm256_loadu_ps(scale + i + 8), loadCodes(codes + i + 8), _mm256_loadu_ps(q + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    if (i + 8 <= n) {
+        __m256 d0 = _mm256_fnmadd_ps(_mm256_loadu_ps(scale + i), loadCodes(codes + i), _mm256_loadu_ps(q + i));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        i += 8;
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) {
+        float d = q[i] - scale[i] * codes[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+MEMORY_TARGET("avx2,fma")
+float lookupSumAvx2(const float* table, const uint8_t* codes, size_t m) {
+    // Eight table rows per gather: row i starts at 256 * i
+    const __m256i rows = _mm256_setr_epi32(0, 256, 512, 768, 1024, 1280, 1536, 1792);
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= m; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(codes + i));
+        __m256i index = _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), rows);
+        acc = _mm256_add_ps(acc, _mm256_i32gather_ps(table + 256 * i, index, 4));
+    }
+    float sum = horizontalSum(acc);
+    for (; i < m; ++i) sum += table[256 * i + codes[i]];
+    return sum;
+}
+
+const DistanceKernels kAvx2Kernels{"avx2",    core::SimdLevel::AVX2, dotAvx2,      l2SquaredAvx2,
+                                   dotU8Avx2, l2U8Avx2,              lookupSumAvx2};
+
+#endif
+
+} // namespace
+
+std::string metricToString(Metric metric) {
+    switch (metric) {
+        case Metric::COSINE: return "cosine";
+        case Metric::DOT: return "dot";
+        case Metric::L2: return "l2";
+        default: return "unknown";
+    }
+}
+
+Metric stringToMetric(const std::string& str) {
+    if (str == "cosine") return Metric::COSINE;
+    if (str == "dot") return Metric::DOT;
+    if (str == "l2") return Metric::L2;
+    throw std::invalid_argument("Unknown vector metric: " + str);
+}
+
+const DistanceKernels* distanceKernels(core::SimdLevel level) {
+    if (!core::simdLevelSupported(level)) return nullptr;
+    switch (level) {
+        case core::SimdLevel::SCALAR: return &kScalarKernels;
+#if defined(MEMORY_ARCH_X86)
+        case core::SimdLevel::AVX2: return core::cpuFeatures().fma ? &kAvx2Kernels : nullptr;
+#endif
+        default: return nullptr;
+    }
+}
+
+const DistanceKernels& distanceKernels() {
+    static const DistanceKernels* kernels = [] {
+        const DistanceKernels* best = distanceKernels(core::bestSimdLevel());
+        return best ? best : &kScalarKernels;
+    }();
+    return *kernels;
+}
+
+float metricDistance(const DistanceKernels& kernels, Metric metric, const float* a, const float* b, size_t n) {
+    return metric == Metric::L2 ? kernels.l2_squared(a, b, n) : 1.0f - kernels.dot(a, b, n);
+}
+
+float distanceToScore(Metric metric, float distance) {
+    return metric == Metric::L2 ? -distance : 1.0f - distance;
+}
+
+} // namespace memory::vector
@@ -0,0 +1,1228 @@
+#include "memory/vector/hnsw_index.h"
+#include "memory/core/config.h"
+#include "memory/core/errors.h"
+#include "memory/core/manifest.h"
+#include "memory/core/wal.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+
+namespace memory::vector {
+
+namespace {
+
+// Sample size of the selectivity estimate; a filter matching a share p is
+// estimated to about +-sqrt(p / 512)
+constexpr uint32_t kSelectivitySample = 512;
+
+// Ops of WalStream::VECTOR records
+enum : uint8_t {
+    kWalTrain = 1,   // quantizer state
+    kWalUpsert = 2,  // id, tenant, type, time, vector
+    kWalRemove = 3   // id
+};
+constexpr uint8_t kNoType = 0xFF;  // Upsert without a node type
+
+// Link and vector bytes compaction reads between two rate limiter charges
+constexpr size_t kCompactionChargeBytes = 64 << 10;
+
+int64_t toMillis(core::Timestamp time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+struct AlignedDelete {
+    void operator()(float* data) const { ::operator delete[](data, std::align_val_t(kVectorAlignBytes)); }
+};
+
+float* allocateAligned(size_t floats) {
+    return static_cast<float*>(::operator new[](floats * sizeof(float), std::align_val_t(kVectorAlignBytes)));
+}
+
+struct AlignedBytesDelete {
+    void operator()(std::byte* data) const { ::operator delete[](data, std::align_val_t(kVectorAlignBytes)); }
+};
+
+// === Segment file layout ===
+//
+// Every column holds rows rounded up to whole blocks, so each block of an
+// opened index maps onto one slice per column and the last one has room
+// for new nodes.
+constexpr uint32_t kMetaSection = core::makeMagic('M', 'E', 'T', 'A');
+constexpr uint32_t kQuantizerSection = core::makeMagic('Q', 'N', 'T', 'Z');
+constexpr uint32_t kVectorsSection = core::makeMagic('V', 'E', 'C', 'S');
+constexpr uint32_t kCodesSection = core::makeMagic('C', 'O', 'D', 'E');
+constexpr uint32_t kLinks0Section = core::makeMagic('L', 'N', 'K', '0');
+constexpr uint32_t kUpperOffsetsSection = core::makeMagic('U', 'P', 'O', 'F');
+constexpr uint32_t kUpperSection = core::makeMagic('U', 'P', 'P', 'R');
+constexpr uint32_t kLevelsSection = core::makeMagic('L', 'V', 'L', 'S');
+constexpr uint32_t kLabelsSection = core::makeMagic('L', 'A', 'B', 'L');
+constexpr uint32_t kDeletedSection = core::makeMagic('D', 'E', 'L', 'D');
+constexpr uint32_t kCreatedSection = core::makeMagic('C', 'R', 'T', 'D');
+constexpr uint32_t kTenantsSection = core::makeMagic('T', 'N', 'N', 'T');
+constexpr uint32_t kTypesSection = core::makeMagic('T', 'Y', 'P', 'E');
+constexpr uint32_t kTimesSection = core::makeMagic('T', 'I', 'M', 'E');
+constexpr uint32_t kTenantNamesSection = core::makeMagic('T', 'N', 'A', 'M');
+
+struct SegmentMeta {
+    uint64_t dimension;
+    uint64_t padded;
+    uint64_t m;
+    uint64_t ef_construction;
+    uint64_t ef_search;
+    uint64_t seed;
+    uint64_t pq_subspaces;
+    uint64_t rerank;
+    uint32_t metric;
+    uint32_t quantization;
+    uint32_t nodes;
+    uint32_t rows;         // nodes rounded up to whole blocks
+    uint32_t upper_nodes;  // Nodes 0..upper_nodes - 1 have upper layers
+    uint32_t entry_point;
+    int32_t max_level;
+    uint32_t live;
+};
+static_assert(std::is_trivially_copyable_v<SegmentMeta>);
+
+} // namespace
+
+HnswOptions HnswOptions::fromConfig(const core::Config& config) {
+    HnswOptions options;
+    int dimension = config.get<int>("dimension", static_cast<int>(options.dimension));
+    options.dimension = dimension > 0 ? static_cast<size_t>(dimension) : options.dimension;
+    int m = config.get<int>("hnsw_m", static_cast<int>(options.m));
+    options.m = m >= 2 ? static_cast<size_t>(m) : 2;
+    int ef_construction = config.get<int>("hnsw_ef_construction", static_cast<int>(options.ef_construction));
+    options.ef_construction = ef_construction > 0 ? static_cast<size_t>(ef_construction) : 1;
+    int ef_search = config.get<int>("hnsw_ef_search", static_cast<int>(options.ef_search));
+    options.ef_search = ef_search > 0 ? static_cast<size_t>(ef_search) : 1;
+    options.metric = stringToMetric(config.get<std::string>("distance_metric", metricToString(options.metric)));
+    options.quantization =
+        stringToQuantization(config.get<std::string>("quantization", quantizationToString(options.quantization)));
+    int subspaces = config.get<int>("pq_subspaces", static_cast<int>(options.pq_subspaces));
+    options.pq_subspaces = subspaces > 0 ? static_cast<size_t>(subspaces) : 0;
+    int rerank = config.get<int>("rerank_candidates", static_cast<int>(options.rerank));
+    options.rerank = rerank > 0 ? static_cast<size_t>(rerank) : 0;
+    return options;
+}
+
+// Per-node state for kBlockNodes consecutive nodes. The columns point into
+// storage, or for an opened index into the mapped file.
+struct HnswIndex::Block {
+    float* vectors = nullptr;  // Only if keep_vectors_
+    uint8_t* codes = nullptr;  // Only with quantization
+    uint32_t* links0 = nullptr;  // Count, then max_links0 slots
+    uint8_t* levels = nullptr;
+    core::NodeId* labels = nullptr;
+    uint64_t* deleted_at = nullptr;  // Version stamps, 0 if live; accessed through std::atomic_ref
+    uint64_t* created_at = nullptr;  // Version stamps, 0 while the insert runs; same access
+    // Filter attributes
+    uint32_t* tenants = nullptr;
+    NodeTypeMask* types = nullptr;  // One bit, or none if untyped
+    int64_t* times = nullptr;       // Milliseconds since the epoch
+    // Upper layers, per node (count, m slots) per layer above 0. The first
+    // mapped_rows nodes of a mapped block find theirs at upper_base +
+    // upper_offsets[slot]; upper is allocated only for room left for inserts.
+    std::unique_ptr<std::unique_ptr<uint32_t[]>[]> upper;
+    const uint64_t* upper_offsets = nullptr;
+    uint32_t* upper_base = nullptr;
+    uint32_t mapped_rows = 0;
+    std::unique_ptr<std::byte[], AlignedBytesDelete> storage;
+};
+
+// Epoch-stamped visited marks, one per concurrent search
+class HnswIndex::VisitedList {
+public:
+    void reset(size_t size) {
+        if (marks_.size() < size) marks_.resize(size, 0);
+        if (++epoch_ == 0) {
+            std::fill(marks_.begin(), marks_.end(), 0);
+            epoch_ = 1;
+        }
+    }
+    // True if node was not visited yet
+    bool visit(uint32_t node) {
+        if (node >= marks_.size()) marks_.resize(node + 1, 0);  // Inserted since reset
+        if (marks_[node] == epoch_) return false;
+        marks_[node] = epoch_;
+        return true;
+    }
+
+private:
+    std::vector<uint16_t> marks_;
+    uint16_t epoch_ = 0;
+};
+
+HnswIndex::HnswIndex(HnswOptions options)
+    : options_(options),
+      kernels_(distanceKernels()),
+      padded_(paddedDimension(options.dimension)),
+      max_links0_(2 * options.m),
+      level_mult_(1.0 / std::log(static_cast<double>(std::max<size_t>(options.m, 2)))),
+      blocks_(std::make_unique<std::atomic<Block*>[]>(kMaxBlocks)),
+      link_locks_(std::make_unique<std::mutex[]>(kLockStripes)),
+      rng_(options.seed) {
+    if (options_.dimension == 0) throw core::IndexException("Vector dimension must be positive");
+    options_.m = std::max<size_t>(options_.m, 2);
+    max_links0_ = 2 * options_.m;
+    if (options_.quantization == Quantization::PQ) {
+        size_t subspaces = options_.pq_subspaces ? options_.pq_subspaces : padded_ / 8;
+        if (padded_ % subspaces != 0) {
+            throw core::IndexException("PQ subspaces (" + std::to_string(subspaces) +
+                                       ") must divide the padded dimension " + std::to_string(padded_));
+        }
+        options_.pq_subspaces = subspaces;
+        code_size_ = subspaces;
+    } else if (options_.quantization == Quantization::SQ8) {
+        code_size_ = padded_;
+    }
+    quantizer_ = makeQuantizer(options_.quantization, options_.metric, kernels_,
+                               ProductQuantizerOptions{.subspaces = options_.pq_subspaces, .seed = options_.seed});
+    keep_vectors_ = !quantizer_ || options_.rerank > 0;
+    snapshot_.store(std::make_shared<const HnswSnapshot>(HnswSnapshot{0, version_}));
+}
+
+HnswIndex::~HnswIndex() {
+    for (uint32_t b = 0; b < kMaxBlocks; ++b) {
+        Block* current = blocks_[b].load(std::memory_order_relaxed);
+        if (!current) break;
+        delete current;
+    }
+}
+
+HnswIndex::Block& HnswIndex::block(uint32_t node) const {
+    return *blocks_[node >> kBlockBits].load(std::memory_order_acquire);
+}
+
+size_t HnswIndex::layoutBlock(Block& b, std::byte* base) const {
+    size_t offset = 0;
+    auto column = [&](auto*& column, size_t count) {
+        using T = std::remove_reference_t<decltype(*column)>;
+        offset = (offset + kVectorAlignBytes - 1) / kVectorAlignBytes * kVectorAlignBytes;
+        if (base) column = reinterpret_cast<T*>(base + offset);
+        offset += count * sizeof(T);
+    };
+    if (keep_vectors_) column(b.vectors, static_cast<size_t>(kBlockNodes) * padded_);
+    if (quantizer_) column(b.codes, static_cast<size_t>(kBlockNodes) * code_size_);
+    column(b.links0, static_cast<size_t>(kBlockNodes) * (1 + max_links0_));
+    column(b.levels, kBlockNodes);
+    column(b.labels, kBlockNodes);
+    column(b.deleted_at, kBlockNodes);
+    column(b.created_at, kBlockNodes);
+    column(b.tenants, kBlockNodes);
+    column(b.types, kBlockNodes);
+    column(b.times, kBlockNodes);
+    return offset;
+}
+
+const float* HnswIndex::vectorOf(uint32_t node) const {
+    return block(node).vectors + static_cast<size_t>(node & (kBlockNodes - 1)) * padded_;
+}
+
+const uint8_t* HnswIndex::codeOf(uint32_t node) const {
+    return block(node).codes + static_cast<size_t>(node & (kBlockNodes - 1)) * code_size_;
+}
+
+const float* HnswIndex::fullVector(uint32_t node, float* scratch) const {
+    if (keep_vectors_) return vectorOf(node);
+    quantizer_->decode(codeOf(node), scratch);
+    return scratch;
+}
+
+uint32_t* HnswIndex::links(uint32_t node, int layer) const {
+    Block& b = block(node);
+    uint32_t slot = node & (kBlockNodes - 1);
+    if (layer == 0) return b.links0 + static_cast<size_t>(slot) * (1 + max_links0_);
+    uint32_t* upper = slot < b.mapped_rows ? b.upper_base + b.upper_offsets[slot] : b.upper[slot].get();
+    return upper + static_cast<size_t>(layer - 1) * (1 + options_.m);
+}
+
+int HnswIndex::levelOf(uint32_t node) const {
+    return block(node).levels[node & (kBlockNodes - 1)];
+}
+
+bool HnswIndex::deleted(uint32_t node) const {
+    return std::atomic_ref(block(node).deleted_at[node & (kBlockNodes - 1)]).load(std::memory_order_relaxed) != 0;
+}
+
+bool HnswIndex::created(uint32_t node) const {
+    return std::atomic_ref(block(node).created_at[node & (kBlockNodes - 1)]).load(std::memory_order_relaxed) != 0;
+}
+
+bool HnswIndex::visible(const HnswSnapshot& snapshot, uint32_t node) const {
+    if (node >= snapshot.nodes) return false;
+    const Block& b = block(node);
+    uint32_t slot = node & (kBlockNodes - 1);
+    // count_ covers inserts still under way; only the stamp, written just
+    // before the publish that acknowledges the insert, makes a node visible
+    uint64_t created_at = std::atomic_ref(b.created_at[slot]).load(std::memory_order_relaxed);
+    if (created_at == 0 || created_at > snapshot.version) return false;
+    uint64_t deleted_at = std::atomic_ref(b.deleted_at[slot]).load(std::memory_order_relaxed);
+    return deleted_at == 0 || deleted_at > snapshot.version;
+}
+
+void HnswIndex::markDeleted(uint32_t node, uint64_t version) const {
+    std::atomic_ref(block(node).deleted_at[node & (kBlockNodes - 1)]).store(version, std::memory_order_relaxed);
+}
+
+void HnswIndex::publishLocked() {
+    auto next = std::make_shared<const HnswSnapshot>(
+        HnswSnapshot{count_.load(std::memory_order_acquire), ++version_});
+    snapshot_.store(next);
+    published_.push_back(next);
+    while (published_.front().expired()) published_.pop_front();
+    if (published_.size() >= sweep_published_at_) {
+        // Amortized: a long-held snapshot keeps the front from advancing
+        std::erase_if(published_, [](const auto& held) { return held.expired(); });
+        sweep_published_at_ = std::max<size_t>(64, 2 * published_.size());
+    }
+    if (versions_) versions_->publish(std::move(next));
+}
+
+uint64_t HnswIndex::oldestHeldVersion() {
+    std::lock_guard lock(labels_mutex_);
+    for (; !published_.empty(); published_.pop_front()) {
+        if (auto held = published_.front().lock()) return held->version;
+    }
+    return version_;
+}
+
+core::NodeId HnswIndex::labelOf(uint32_t node) const {
+    return block(node).labels[node & (kBlockNodes - 1)];
+}
+
+bool HnswIndex::matches(const Predicate& predicate, uint32_t node) const {
+    const Block& b = block(node);
+    uint32_t slot = node & (kBlockNodes - 1);
+    if (!predicate.any_tenant && b.tenants[slot] != predicate.tenant) return false;
+    if (predicate.types != kAllNodeTypes && !(b.types[slot] & predicate.types)) return false;
+    return b.times[slot] >= predicate.since && b.times[slot] < predicate.until;
+}
+
+double HnswIndex::estimateSelectivity(const Predicate& predicate) const {
+    uint32_t nodes = static_cast<uint32_t>(nodeCount());
+    bool sample = nodes > kSelectivitySample;
+    uint32_t live = 0;
+    uint32_t matching = 0;
+    for (uint32_t i = 0; i < std::min(nodes, kSelectivitySample); ++i) {
+        // Scattered positions: a fixed stride would alias with periodic
+        // insert patterns
+        uint32_t node = sample ? static_cast<uint32_t>(uint64_t{i} * 2654435761u % nodes) : i;
+        if (deleted(node) || !created(node)) continue;
+        ++live;
+        matching += matches(predicate, node);
+    }
+    return live ? static_cast<double>(matching) / live : 0.0;
+}
+
+bool HnswIndex::prepare(std::span<const float> query, float* out) const {
+    std::copy(query.begin(), query.end(), out);
+    std::fill(out + query.size(), out + padded_, 0.0f);
+    if (options_.metric != Metric::COSINE) return true;
+    float norm = std::sqrt(kernels_.dot(out, out, padded_));
+    if (norm == 0.0f || !std::isfinite(norm)) return false;
+    for (size_t i = 0; i < query.size(); ++i) out[i] /= norm;
+    return true;
+}
+
+void HnswIndex::makeQuery(const float* prepared, bool exact, Query& query) const {
+    query.vector = prepared;
+    query.exact = exact || !quantizer_;
+    if (!query.exact) quantizer_->prepareQuery(prepared, query.table);
+}
+
+void HnswIndex::train(std::span<const float> samples) {
+    if (!quantizer_) return;
+    if (nodeCount() > 0) throw core::IndexException("Cannot train a populated HNSW index");
+    if (samples.empty() || samples.size() % options_.dimension != 0) {
+        throw core::IndexException("Training samples must be rows of " + std::to_string(options_.dimension) +
+                                   " floats");
+    }
+    // Samples go through the same padding and normalization as inserts
+    std::vector<float> rows;
+    rows.reserve(samples.size() / options_.dimension * padded_);
+    std::vector<float> prepared(padded_);
+    for (size_t offset = 0; offset < samples.size(); offset += options_.dimension) {
+        if (!prepare(samples.subspan(offset, options_.dimension), prepared.data())) continue;
+        rows.insert(rows.end(), prepared.begin(), prepared.end());
+    }
+    if (rows.empty()) throw core::IndexException("Training samples are all zero vectors");
+    quantizer_->train(rows, padded_);
+    // Logged as the trained state: replay must not depend on sampling
+    if (wal_) {
+        std::vector<float> state = quantizer_->state();
+        wal_->write(core::WalStream::VECTOR, kWalTrain, core::WalEncoder().putArray<float>(state).bytes());
+    }
+}
+
+uint32_t HnswIndex::allocate() {
+    std::lock_guard lock(grow_mutex_);
+    uint32_t node = count_.load(std::memory_order_relaxed);
+    uint32_t b = node >> kBlockBits;
+    if (b >= kMaxBlocks) {
+        throw core::IndexException("HNSW index is full at " + std::to_string(node) + " nodes");
+    }
+    if (!blocks_[b].load(std::memory_order_relaxed)) {
+        auto fresh = std::make_unique<Block>();
+        size_t bytes = layoutBlock(*fresh, nullptr);
+        fresh->storage.reset(new (std::align_val_t(kVectorAlignBytes)) std::byte[bytes]);
+        std::memset(fresh->storage.get(), 0, bytes);
+        layoutBlock(*fresh, fresh->storage.get());
+        fresh->upper = std::make_unique<std::unique_ptr<uint32_t[]>[]>(kBlockNodes);
+        blocks_[b].store(fresh.release(), std::memory_order_release);
+    }
+    count_.store(node + 1, std::memory_order_release);
+    return node;
+}
+
+int HnswIndex::randomLevel() {
+    std::lock_guard lock(rng_mutex_);
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+    double level = -std::log(std::max(u, 1e-12)) * level_mult_;
+    return static_cast<int>(std::min(level, 31.0));
+}
+
+size_t HnswIndex::readLinks(uint32_t node, int layer, std::vector<uint32_t>& out) const {
+    std::lock_guard lock(linkLock(node));
+    const uint32_t* list = links(node, layer);
+    out.assign(list + 1, list + 1 + list[0]);
+    return out.size();
+}
+
+void HnswIndex::greedySearch(const Query& query, uint32_t& current, float& current_distance, int layer) const {
+    std::vector<uint32_t> neighbors;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        readLinks(current, layer, neighbors);
+        for (uint32_t neighbor : neighbors) {
+            float d = distance(query, neighbor);
+            if (d < current_distance) {
+                current_distance = d;
+                current = neighbor;
+                changed = true;
+            }
+        }
+    }
+}
+
+template <typename Accept>
+void HnswIndex::searchLayer(const Query& query, uint32_t entry, float entry_distance, size_t ef, int layer,
+                            const Accept& accept, std::vector<Candidate>& out) const {
+    std::unique_ptr<VisitedList> visited = acquireVisited();
+    visited->reset(nodeCount());
+
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> candidates;  // Nearest on top
+    std::priority_queue<Candidate> results;                                            // Farthest on top
+    visited->visit(entry);
+    candidates.push({entry_distance, entry});
+    if (accept(entry)) results.push({entry_distance, entry});
+
+    std::vector<uint32_t> neighbors;
+    while (!candidates.empty()) {
+        Candidate current = candidates.top();
+        if (results.size() >= ef && current.distance > results.top().distance) break;
+        candidates.pop();
+        readLinks(current.node, layer, neighbors);
+        for (uint32_t neighbor : neighbors) {
+            if (!visited->visit(neighbor)) continue;
+            float d = distance(query, neighbor);
+            if (results.size() < ef || d < results.top().distance) {
+                candidates.push({d, neighbor});
+                if (accept(neighbor)) {
+                    results.push({d, neighbor});
+                    if (results.size() > ef) results.pop();
+                }
+            }
+        }
+    }
+    releaseVisited(std::move(visited));
+
+    out.resize(results.size());
+    for (size_t i = out.size(); i > 0; --i) {
+        out[i - 1] = results.top();
+        results.pop();
+    }
+}
+
+void HnswIndex::selectNeighbors(std::vector<Candidate>& sorted, size_t limit) const {
+    if (sorted.size() <= limit) return;
+    // Without the floats, each candidate is decoded once into the slot it
+    // keeps if selected
+    std::vector<float> decoded(keep_vectors_ ? 0 : limit * padded_);
+    std::vector<const float*> kept_vectors;
+    size_t kept = 0;
+    for (size_t i = 0; i < sorted.size() && kept < limit; ++i) {
+        const float* candidate = fullVector(sorted[i].node, decoded.data() + kept * padded_);
+        bool diverse = true;
+        for (size_t j = 0; j < kept; ++j) {
+            if (distance(candidate, kept_vectors[j]) < sorted[i].distance) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse) {
+            sorted[kept++] = sorted[i];
+            kept_vectors.push_back(candidate);
+        }
+    }
+    sorted.resize(kept);
+}
+
+void HnswIndex::link(uint32_t node, uint32_t neighbor, float d, int layer) {
+    size_t capacity = layer == 0 ? max_links0_ : options_.m;
+    std::lock_guard lock(linkLock(node));
+    uint32_t* list = links(node, layer);
+    if (list[0] < capacity) {
+        list[1 + list[0]] = neighbor;
+        ++list[0];
+        return;
+    }
+    // Full: keep the most diverse of the old neighbors plus the new one
+    std::vector<Candidate> candidates;
+    candidates.reserve(capacity + 1);
+    std::vector<float> scratch(keep_vectors_ ? 0 : 2 * padded_);
+    const float* base = fullVector(node, scratch.data());
+    for (uint32_t i = 0; i < list[0]; ++i) {
+        const float* other = fullVector(list[1 + i], scratch.data() + padded_);
+        candidates.push_back({distance(base, other), list[1 + i]});
+    }
+    candidates.push_back({d, neighbor});
+    std::sort(candidates.begin(), candidates.end());
+    selectNeighbors(candidates, capacity);
+    list[0] = static_cast<uint32_t>(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) list[1 + i] = candidates[i].node;
+}
+
+void HnswIndex::Upsert(core::NodeId id, std::span<const float> vec) {
+    Upsert(id, vec, VectorAttributes{});
+}
+
+void HnswIndex::Upsert(core::NodeId id, std::span<const float> vec, const VectorAttributes& attributes) {
+    if (vec.size() != options_.dimension) {
+        throw core::IndexException("Vector of id " + std::to_string(id) + " has dimension " +
+                                   std::to_string(vec.size()) + ", expected " +
+                                   std::to_string(options_.dimension));
+    }
+    if (!trained()) throw core::IndexException("Quantized HNSW index must be trained before inserting");
+    core::WalEncoder record;
+    if (wal_) {
+        record.put<uint64_t>(id).putString(attributes.tenant);
+        record.put<uint8_t>(attributes.type ? static_cast<uint8_t>(*attributes.type) : kNoType);
+        record.put<int64_t>(toMillis(attributes.time)).putArray(vec);
+    }
+    std::unique_ptr<float[], AlignedDelete> prepared(allocateAligned(padded_));
+    if (!prepare(vec, prepared.get())) {
+        throw core::IndexException("Zero vector for id " + std::to_string(id) + " under the cosine metric");
+    }
+    int level = randomLevel();
+    uint32_t node = allocate();
+    Block& b = block(node);
+    uint32_t slot = node & (kBlockNodes - 1);
+    if (keep_vectors_) {
+        std::memcpy(b.vectors + static_cast<size_t>(slot) * padded_, prepared.get(), padded_ * sizeof(float));
+    }
+    if (quantizer_) quantizer_->encode(prepared.get(), b.codes + static_cast<size_t>(slot) * code_size_);
+    // Linking uses exact distances whenever the floats are at hand
+    Query query;
+    makeQuery(prepared.get(), keep_vectors_, query);
+    b.levels[slot] = static_cast<uint8_t>(level);
+    b.labels[slot] = id;
+    std::atomic_ref(b.deleted_at[slot]).store(0, std::memory_order_relaxed);
+    std::atomic_ref(b.created_at[slot]).store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(tenants_mutex_);
+        b.tenants[slot] = tenants_.intern(attributes.tenant);
+    }
+    b.types[slot] = attributes.type ? nodeTypeBit(*attributes.type) : 0;
+    b.times[slot] = toMillis(attributes.time);
+    if (level > 0) {
+        b.upper[slot] = std::make_unique<uint32_t[]>(static_cast<size_t>(level) * (1 + options_.m));
+    }
+
+    std::unique_lock entry_lock(entry_mutex_);
+    int top = max_level_;
+    uint32_t current = entry_point_;
+    if (top < 0) {
+        entry_point_ = node;
+        max_level_ = level;
+    } else {
+        // Only a node raising the top layer keeps the entry point locked
+        if (level <= top) entry_lock.unlock();
+        float current_distance = distance(query, current);
+        for (int layer = top; layer > level; --layer) {
+            greedySearch(query, current, current_distance, layer);
+        }
+        std::vector<Candidate> candidates;
+        for (int layer = std::min(level, top); layer >= 0; --layer) {
+            searchLayer(query, current, current_distance, options_.ef_construction, layer,
+                        [](uint32_t) { return true; }, candidates);
+            current = candidates.front().node;
+            current_distance = candidates.front().distance;
+            selectNeighbors(candidates, options_.m);
+            {
+                std::lock_guard lock(linkLock(node));
+                uint32_t* list = links(node, layer);
+                list[0] = static_cast<uint32_t>(candidates.size());
+                for (size_t i = 0; i < candidates.size(); ++i) list[1 + i] = candidates[i].node;
+            }
+            for (const Candidate& neighbor : candidates) link(neighbor.node, node, neighbor.distance, layer);
+        }
+        if (level > top) {
+            entry_point_ = node;
+            max_level_ = level;
+        }
+    }
+    if (entry_lock.owns_lock()) entry_lock.unlock();
+
+    uint64_t lsn = 0;
+    {
+        std::lock_guard lock(labels_mutex_);
+        loadLabelsLocked();
+        if (wal_) {
+            try {
+                lsn = wal_->append(core::WalStream::VECTOR, kWalUpsert, record.bytes());
+            } catch (const core::StorageException&) {
+                // Unlogged: leave the id on its previous node
+                markDeleted(node, version_ + 1);
+                publishLocked();
+                throw;
+            }
+        }
+        auto [it, inserted] = labels_.try_emplace(id, node);
+        if (!inserted) {
+            markDeleted(it->second, version_ + 1);
+            it->second = node;
+        }
+        std::atomic_ref(b.created_at[slot]).store(version_ + 1, std::memory_order_relaxed);
+        publishLocked();
+    }
+    if (lsn) wal_->commit(lsn);
+}
+
+void HnswIndex::Remove(core::NodeId id) {
+    uint64_t lsn = 0;
+    {
+        std::lock_guard lock(labels_mutex_);
+        loadLabelsLocked();
+        auto it = labels_.find(id);
+        if (it == labels_.end()) return;
+        if (wal_) {
+            lsn = wal_->append(core::WalStream::VECTOR, kWalRemove, core::WalEncoder().put<uint64_t>(id).bytes());
+        }
+        markDeleted(it->second, version_ + 1);
+        labels_.erase(it);
+        publishLocked();
+    }
+    if (lsn) wal_->commit(lsn);
+}
+
+void HnswIndex::attachWal(std::shared_ptr<core::WriteAheadLog> wal, uint64_t after_lsn) {
+    // Replays through the public methods while nothing is logged yet
+    wal->replay(core::WalStream::VECTOR, after_lsn, [&](const core::WalRecord& record) {
+        core::WalDecoder decoder(record);
+        switch (record.op) {
+            case kWalTrain: {
+                if (!quantizer_) throw core::StorageException("WAL trains an unquantized HNSW index");
+                quantizer_->restore(decoder.getArray<float>(), padded_);
+                break;
+            }
+            case kWalUpsert: {
+                core::NodeId id = decoder.get<uint64_t>();
+                VectorAttributes attributes;
+                attributes.tenant = decoder.getString();
+                uint8_t type = decoder.get<uint8_t>();
+                if (type != kNoType) attributes.type = static_cast<core::NodeType>(type);
+                attributes.time = core::Timestamp{} + std::chrono::milliseconds(decoder.get<int64_t>());
+                Upsert(id, decoder.getArray<float>(), attributes);
+                break;
+            }
+            case kWalRemove: Remove(decoder.get<uint64_t>()); break;
+            default:
+                throw core::StorageException("Unknown vector WAL op " + std::to_string(record.op) + " at LSN " +
+                                             std::to_string(record.lsn));
+        }
+    });
+    wal_ = std::move(wal);
+}
+
+void HnswIndex::attachVersions(std::shared_ptr<core::VersionSet> versions) {
+    std::lock_guard lock(labels_mutex_);
+    versions_ = std::move(versions);
+    versions_->publish(snapshot_.load());
+}
+
+void HnswIndex::loadLabelsLocked() {
+    if (labels_loaded_) return;
+    // Only nodes from the file can be missing: inserts load labels first
+    uint32_t nodes = static_cast<uint32_t>(nodeCount());
+    labels_.reserve(mapped_live_);
+    for (uint32_t node = 0; node < nodes; ++node) {
+        // An insert still under way adds its own label once it completes
+        if (created(node) && !deleted(node)) labels_[labelOf(node)] = node;
+    }
+    labels_loaded_ = true;
+}
+
+std::vector<core::ScoredId> HnswIndex::Search(std::span<const float> query, size_t topk) const {
+    return Search(query, topk, options_.ef_search);
+}
+
+bool HnswIndex::descend(const Query& query, uint32_t& entry, float& entry_distance) const {
+    int top;
+    {
+        std::lock_guard lock(entry_mutex_);
+        entry = entry_point_;
+        top = max_level_;
+    }
+    if (top < 0) return false;
+    entry_distance = distance(query, entry);
+    for (int layer = top; layer > 0; --layer) greedySearch(query, entry, entry_distance, layer);
+    return true;
+}
+
+std::vector<core::ScoredId> HnswIndex::finish(std::vector<Candidate>& nearest, const float* prepared,
+                                              size_t topk) const {
+    size_t rerank = quantizer_ ? options_.rerank : 0;
+    if (rerank > 0) {
+        // Exact distances for the nearest candidates by code
+        nearest.resize(std::min(nearest.size(), std::max(rerank, topk)));
+        for (Candidate& c : nearest) c.distance = distance(prepared, vectorOf(c.node));
+        std::sort(nearest.begin(), nearest.end());
+    }
+
+    // A snapshot sees one version of an id; guard against stray duplicates
+    std::vector<core::ScoredId> result;
+    std::unordered_set<core::NodeId> seen;
+    for (const Candidate& c : nearest) {
+        core::NodeId id = labelOf(c.node);
+        if (!seen.insert(id).second) continue;
+        result.push_back(core::ScoredId{id, distanceToScore(options_.metric, c.distance)});
+        if (result.size() == topk) break;
+    }
+    return result;
+}
+
+std::vector<core::ScoredId> HnswIndex::Search(std::span<const float> query, size_t topk, size_t ef) const {
+    return searchAll(*snapshot(), query, topk, ef);
+}
+
+std::vector<core::ScoredId> HnswIndex::searchAll(const HnswSnapshot& snapshot, std::span<const float> query,
+                                                 size_t topk, size_t ef) const {
+    if (query.size() != options_.dimension) {
+        throw core::IndexException("Query has dimension " + std::to_string(query.size()) + ", expected " +
+                                   std::to_string(options_.dimension));
+    }
+    if (topk == 0) return {};
+    std::unique_ptr<float[], AlignedDelete> prepared(allocateAligned(padded_));
+    if (!prepare(query, prepared.get())) return {};
+
+    Query q;
+    makeQuery(prepared.get(), false, q);
+    uint32_t entry;
+    float entry_distance;
+    if (!descend(q, entry, entry_distance)) return {};
+    size_t rerank = quantizer_ ? options_.rerank : 0;
+    std::vector<Candidate> nearest;
+    searchLayer(q, entry, entry_distance, std::max({ef, topk, rerank}), 0,
+                [&](uint32_t node) { return visible(snapshot, node); }, nearest);
+    return finish(nearest, prepared.get(), topk);
+}
+
+std::vector<core::ScoredId> HnswIndex::Search(std::span<const float> query, size_t topk, const VectorFilter& filter,
+                                              size_t ef, FilteredSearchStats* stats) const {
+    return Search(*snapshot(), query, topk, filter, ef, stats);
+}
+
+std::vector<core::ScoredId> HnswIndex::Search(const HnswSnapshot& snapshot, std::span<const float> query,
+                                              size_t topk, const VectorFilter& filter, size_t ef,
+                                              FilteredSearchStats* stats) const {
+    if (ef == 0) ef = options_.ef_search;
+    if (filter.empty()) {
+        if (stats) *stats = FilteredSearchStats{1.0, false, ef};
+        return searchAll(snapshot, query, topk, ef);
+    }
+    if (query.size() != options_.dimension) {
+        throw core::IndexException("Query has dimension " + std::to_string(query.size()) + ", expected " +
+                                   std::to_string(options_.dimension));
+    }
+    if (stats) *stats = FilteredSearchStats{0.0, false, 0};
+    if (topk == 0) return {};
+
+    Predicate predicate{!filter.tenant, 0, filter.types,
+                        filter.since ? toMillis(*filter.since) : std::numeric_limits<int64_t>::min(),
+                        filter.until ? toMillis(*filter.until) : std::numeric_limits<int64_t>::max()};
+    if (filter.tenant) {
+        std::lock_guard lock(tenants_mutex_);
+        predicate.tenant = tenants_.find(*filter.tenant);
+        if (predicate.tenant == core::StringInterner::kUnknownId) return {};
+    }
+    if (predicate.types == 0) return {};
+
+    std::unique_ptr<float[], AlignedDelete> prepared(allocateAligned(padded_));
+    if (!prepare(query, prepared.get())) return {};
+    Query q;
+    makeQuery(prepared.get(), false, q);
+    auto accept = [&](uint32_t node) { return visible(snapshot, node) && matches(predicate, node); };
+    size_t rerank = quantizer_ ? options_.rerank : 0;
+    size_t want = std::max({ef, topk, rerank});
+
+    // Costs in distance computations. The graph search admits only matches
+    // into its result list, so it expands about want / selectivity nodes
+    // of up to max_links0_ neighbors each. The scan tests every node, about
+    // 64 floats' worth of work, and scores the matches.
+    double selectivity = estimateSelectivity(predicate);
+    double live = static_cast<double>(size());
+    double graph_cost = static_cast<double>(want * max_links0_) / std::max(selectivity, 1e-9);
+    double scan_cost = live * (selectivity + 64.0 / static_cast<double>(padded_));
+    std::vector<Candidate> nearest;
+    if (scan_cost < graph_cost) {
+        // Few matches: score every matching vector, keep the nearest want
+        std::priority_queue<Candidate> heap;  // Farthest on top
+        for (uint32_t node = 0; node < snapshot.nodes; ++node) {
+            if (!accept(node)) continue;
+            float d = distance(q, node);
+            if (heap.size() < want) {
+                heap.push({d, node});
+            } else if (d < heap.top().distance) {
+                heap.pop();
+                heap.push({d, node});
+            }
+        }
+        nearest.resize(heap.size());
+        for (size_t i = nearest.size(); i > 0; --i) {
+            nearest[i - 1] = heap.top();
+            heap.pop();
+        }
+        if (stats) *stats = FilteredSearchStats{selectivity, true, 0};
+    } else {
+        uint32_t entry;
+        float entry_distance;
+        if (!descend(q, entry, entry_distance)) return {};
+        searchLayer(q, entry, entry_distance, want, 0, accept, nearest);
+        if (stats) *stats = FilteredSearchStats{selectivity, false, want};
+    }
+    return finish(nearest, prepared.get(), topk);
+}
+
+size_t HnswIndex::size() const {
+    std::lock_guard lock(labels_mutex_);
+    return labels_loaded_ ? labels_.size() : mapped_live_;
+}
+
+int HnswIndex::maxLevel() const {
+    std::lock_guard lock(entry_mutex_);
+    return max_level_;
+}
+
+size_t HnswIndex::memoryBytes() const {
+    uint32_t nodes = nodeCount();
+    size_t blocks = (nodes + kBlockNodes - 1) / kBlockNodes;
+    Block layout;
+    size_t block_bytes = layoutBlock(layout, nullptr);
+    size_t bytes = 0;
+    for (uint32_t b = 0; b < blocks; ++b) {
+        const Block& current = *blocks_[b].load(std::memory_order_acquire);
+        if (current.storage) bytes += block_bytes;
+        if (current.upper) bytes += kBlockNodes * sizeof(std::unique_ptr<uint32_t[]>);
+    }
+    for (uint32_t node = 0; node < nodes; ++node) {
+        if ((node & (kBlockNodes - 1)) < block(node).mapped_rows) continue;
+        bytes += static_cast<size_t>(levelOf(node)) * (1 + options_.m) * sizeof(uint32_t);
+    }
+    size_t tenants;
+    {
+        std::lock_guard lock(tenants_mutex_);
+        tenants = tenants_.memoryBytes();
+    }
+    std::lock_guard lock(labels_mutex_);
+    return bytes + tenants + (quantizer_ ? quantizer_->memoryBytes() : 0) +
+           labels_.size() * (sizeof(core::NodeId) + sizeof(uint32_t) + sizeof(void*) * 2);
+}
+
+double HnswIndex::fragmentation() const {
+    size_t nodes = nodeCount();
+    size_t dead = nodes - std::min(nodes, size());
+    dead -= std::min(dead, unlinked_count_.load(std::memory_order_relaxed));
+    return nodes ? static_cast<double>(dead) / static_cast<double>(nodes) : 0.0;
+}
+
+bool HnswIndex::compactionDue(const core::CompactionOptions& options) const {
+    return fragmentation() > options.fragmentation_threshold;
+}
+
+core::CompactionResult HnswIndex::compact(const core::CompactionOptions& options, core::RateLimiter& limiter) {
+    (void)options;
+    std::lock_guard compaction_lock(compaction_mutex_);
+    core::CompactionResult result;
+    result.target = compactionName();
+    result.bytes_before = memoryBytes() + mappedBytes();
+    result.fragmentation_before = fragmentation();
+
+    // Tombstones every held snapshot already misses. A stamped node is
+    // fully linked, since removal follows the insert.
+    uint64_t safe = oldestHeldVersion();
+    auto nodes = static_cast<uint32_t>(nodeCount());
+    unlinked_.resize(nodes, 0);
+    result.items_before = nodes - unlinked_count_.load(std::memory_order_relaxed);
+    std::vector<uint8_t> gone(unlinked_);
+    std::vector<uint32_t> removed;
+    for (uint32_t node = 0; node < nodes; ++node) {
+        if (gone[node]) continue;
+        uint64_t stamp =
+            std::atomic_ref(block(node).deleted_at[node & (kBlockNodes - 1)]).load(std::memory_order_relaxed);
+        if (stamp != 0 && stamp <= safe) {
+            gone[node] = 1;
+            removed.push_back(node);
+        }
+    }
+    uint32_t entry;
+    int top;
+    {
+        std::lock_guard lock(entry_mutex_);
+        entry = entry_point_;
+        top = max_level_;
+    }
+
+    if (!removed.empty() && top >= 0) {
+        // Walks layer 0 from the entry point: a reachable node is fully
+        // linked, unlike one an in-flight insert has only allocated
+        std::vector<uint32_t> order{entry};
+        std::vector<uint8_t> seen(std::max(nodes, entry + 1), 0);
+        seen[entry] = 1;
+        std::vector<uint32_t> neighbors;
+        for (size_t i = 0; i < order.size(); ++i) {
+            readLinks(order[i], 0, neighbors);
+            for (uint32_t neighbor : neighbors) {
+                if (neighbor < nodes && !seen[neighbor]) {
+                    seen[neighbor] = 1;
+                    order.push_back(neighbor);
+                }
+            }
+        }
+        auto is_gone = [&](uint32_t node) { return node < nodes && gone[node]; };
+
+        size_t vector_bytes = keep_vectors_ ? padded_ * sizeof(float) : code_size_;
+        size_t pending = order.size() * (1 + max_links0_) * sizeof(uint32_t);
+        std::vector<uint32_t> merged;
+        std::vector<uint32_t> inherited;
+        std::vector<Candidate> candidates;
+        std::vector<float> scratch(keep_vectors_ ? 0 : 2 * padded_);
+        for (uint32_t node : order) {
+            if (gone[node]) continue;
+            for (int layer = levelOf(node); layer >= 0; --layer) {
+                readLinks(node, layer, neighbors);
+                if (std::none_of(neighbors.begin(), neighbors.end(), is_gone)) continue;
+                // The tombstones' own neighbors stand in for them
+                merged.clear();
+                for (uint32_t neighbor : neighbors) {
+                    if (!is_gone(neighbor)) continue;
+                    readLinks(neighbor, layer, inherited);
+                    merged.insert(merged.end(), inherited.begin(), inherited.end());
+                }
+
+                size_t capacity = layer == 0 ? max_links0_ : options_.m;
+                std::lock_guard lock(linkLock(node));
+                // Re-read under the lock: inserts may have linked to node
+                uint32_t* list = links(node, layer);
+                merged.insert(merged.end(), list + 1, list + 1 + list[0]);
+                std::sort(merged.begin(), merged.end());
+                merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+                candidates.clear();
+                const float* base = fullVector(node, scratch.data());
+                for (uint32_t other : merged) {
+                    if (other == node || is_gone(other)) continue;
+                    candidates.push_back({distance(base, fullVector(other, scratch.data() + padded_)), other});
+                }
+                std::sort(candidates.begin(), candidates.end());
+                selectNeighbors(candidates, capacity);
+                list[0] = static_cast<uint32_t>(candidates.size());
+                for (size_t i = 0; i < candidates.size(); ++i) list[1 + i] = candidates[i].node;
+                pending += merged.size() * (vector_bytes + sizeof(uint32_t));
+            }
+            // Never sleeps holding a link lock
+            if (pending >= kCompactionChargeBytes) {
+                limiter.acquire(pending);
+                pending = 0;
+            }
+        }
+        limiter.acquire(pending);
+
+        if (gone[entry]) {
+            uint32_t best = entry;
+            int best_level = -1;
+            for (uint32_t node : order) {
+                if (!gone[node] && levelOf(node) > best_level) {
+                    best = node;
+                    best_level = levelOf(node);
+                }
+            }
+            std::lock_guard lock(entry_mutex_);
+            // Unless an insert has raised the top layer meanwhile
+            if (best_level >= 0 && entry_point_ == entry) {
+                entry_point_ = best;
+                max_level_ = best_level;
+            }
+        }
+    }
+    for (uint32_t node : removed) unlinked_[node] = 1;
+    unlinked_count_.fetch_add(removed.size(), std::memory_order_relaxed);
+
+    result.bytes_after = memoryBytes() + mappedBytes();
+    result.items_after = nodes - unlinked_count_.load(std::memory_order_relaxed);
+    result.fragmentation_after = fragmentation();
+    return result;
+}
+
+void HnswIndex::save(const std::string& path) const {
+    uint32_t nodes = static_cast<uint32_t>(nodeCount());
+    uint32_t rows = (nodes + kBlockNodes - 1) / kBlockNodes * kBlockNodes;
+    // Upper-layer nodes first, so they take one prefix of every column
+    std::vector<uint32_t> order(nodes);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return levelOf(a) > levelOf(b); });
+    std::vector<uint32_t> rank(nodes);
+    for (uint32_t i = 0; i < nodes; ++i) rank[order[i]] = i;
+
+    SegmentMeta meta{};
+    meta.dimension = options_.dimension;
+    meta.padded = padded_;
+    meta.m = options_.m;
+    meta.ef_construction = options_.ef_construction;
+    meta.ef_search = options_.ef_search;
+    meta.seed = options_.seed;
+    meta.pq_subspaces = options_.pq_subspaces;
+    meta.rerank = options_.rerank;
+    meta.metric = static_cast<uint32_t>(options_.metric);
+    meta.quantization = static_cast<uint32_t>(options_.quantization);
+    meta.nodes = nodes;
+    meta.rows = rows;
+    meta.upper_nodes = static_cast<uint32_t>(
+        std::count_if(order.begin(), order.end(), [&](uint32_t node) { return levelOf(node) > 0; }));
+    {
+        std::lock_guard lock(entry_mutex_);
+        meta.entry_point = nodes > 0 ? rank[entry_point_] : 0;
+        meta.max_level = max_level_;
+    }
+    meta.live = static_cast<uint32_t>(size());
+
+    core::SectionFileWriter writer(path, kHnswSegmentMagic, kHnswSegmentVersion);
+    writer.begin(kMetaSection);
+    writer.append(&meta, sizeof(meta));
+    if (quantizer_) {
+        std::vector<float> state = quantizer_->state();
+        writer.begin(kQuantizerSection);
+        writer.append(std::span<const float>(state));
+    }
+
+    // One row per node in the new order, then zero rows up to a whole block
+    auto column = [&](uint32_t tag, size_t row_bytes, const auto& write_row) {
+        writer.begin(tag);
+        for (uint32_t node : order) write_row(node);
+        writer.appendZeros(static_cast<size_t>(rows - nodes) * row_bytes);
+    };
+    if (keep_vectors_) {
+        column(kVectorsSection, padded_ * sizeof(float),
+               [&](uint32_t node) { writer.append(vectorOf(node), padded_ * sizeof(float)); });
+    }
+    if (quantizer_) {
+        column(kCodesSection, code_size_, [&](uint32_t node) { writer.append(codeOf(node), code_size_); });
+    }
+    // Neighbor lists with the node numbers renamed
+    std::vector<uint32_t> list;
+    auto writeList = [&](uint32_t node, int layer, size_t capacity) {
+        list.assign(1 + capacity, 0);
+        {
+            std::lock_guard lock(linkLock(node));
+            const uint32_t* source = links(node, layer);
+            list[0] = source[0];
+            for (uint32_t i = 0; i < source[0]; ++i) list[1 + i] = rank[source[1 + i]];
+        }
+        writer.append(std::span<const uint32_t>(list));
+    };
+    column(kLinks0Section, (1 + max_links0_) * sizeof(uint32_t),
+           [&](uint32_t node) { writeList(node, 0, max_links0_); });
+    std::vector<uint64_t> upper_offsets(rows);
+    uint64_t upper_words = 0;
+    for (uint32_t i = 0; i < rows; ++i) {
+        upper_offsets[i] = upper_words;
+        if (i < nodes) upper_words += static_cast<uint64_t>(levelOf(order[i])) * (1 + options_.m);
+    }
+    writer.begin(kUpperOffsetsSection);
+    writer.append(std::span<const uint64_t>(upper_offsets));
+    writer.begin(kUpperSection);
+    for (uint32_t i = 0; i < meta.upper_nodes; ++i) {
+        for (int layer = 1; layer <= levelOf(order[i]); ++layer) writeList(order[i], layer, options_.m);
+    }
+
+    auto scalar = [&](uint32_t tag, const auto& value) {
+        using T = std::decay_t<decltype(value(0u))>;
+        column(tag, sizeof(T), [&](uint32_t node) {
+            T v = value(node);
+            writer.append(&v, sizeof(v));
+        });
+    };
+    auto at = [this](uint32_t node) -> const Block& { return block(node); };
+    auto slot = [](uint32_t node) { return node & (kBlockNodes - 1); };
+    scalar(kLevelsSection, [&](uint32_t node) { return at(node).levels[slot(node)]; });
+    scalar(kLabelsSection, [&](uint32_t node) { return at(node).labels[slot(node)]; });
+    // Deleted or created as of version 1, which the opened index starts at
+    scalar(kDeletedSection, [&](uint32_t node) { return static_cast<uint64_t>(deleted(node)); });
+    scalar(kCreatedSection, [&](uint32_t node) { return static_cast<uint64_t>(created(node)); });
+    scalar(kTenantsSection, [&](uint32_t node) { return at(node).tenants[slot(node)]; });
+    scalar(kTypesSection, [&](uint32_t node) { return at(node).types[slot(node)]; });
+    scalar(kTimesSection, [&](uint32_t node) { return at(node).times[slot(node)]; });
+
+    writer.begin(kTenantNamesSection);
+    {
+        std::lock_guard lock(tenants_mutex_);
+        for (uint32_t id = 0; id < tenants_.size(); ++id) {
+            std::string_view name = tenants_.str(id);
+            uint32_t length = static_cast<uint32_t>(name.size());
+            writer.append(&length, sizeof(length));
+            writer.append(name.data(), name.size());
+        }
+    }
+    writer.commit();
+}
+
+std::unique_ptr<HnswIndex> HnswIndex::open(const std::string& path, HnswLoadOptions load) {
+    std::string what = "HNSW segment " + path;
+    core::SectionFile file =
+        core::SectionFile::open(path, kHnswSegmentMagic, kHnswSegmentVersion, what, core::MapMode::PRIVATE);
+    if (load.verify) file.verify();
+    auto damaged = [&](const std::string& detail) { return core::StorageException(what + ": " + detail); };
+
+    auto meta_bytes = file.section(kMetaSection);
+    if (meta_bytes.size() != sizeof(SegmentMeta)) throw damaged("bad meta section");
+    SegmentMeta meta;
+    std::memcpy(&meta, meta_bytes.data(), sizeof(meta));
+    if (meta.metric > static_cast<uint32_t>(Metric::L2) || meta.quantization > static_cast<uint32_t>(Quantization::PQ)) {
+        throw damaged("unknown metric or quantization");
+    }
+    HnswOptions options{.dimension = meta.dimension,
+                        .metric = static_cast<Metric>(meta.metric),
+                        .m = meta.m,
+                        .ef_construction = meta.ef_construction,
+                        .ef_search = load.ef_search ? load.ef_search : meta.ef_search,
+                        .seed = meta.seed,
+                        .quantization = static_cast<Quantization>(meta.quantization),
+                        .pq_subspaces = meta.pq_subspaces,
+                        .rerank = meta.rerank};
+    std::unique_ptr<HnswIndex> index;
+    try {
+        index = std::make_unique<HnswIndex>(options);
+        if (index->quantizer_) index->quantizer_->restore(file.array<float>(kQuantizerSection), index->padded_);
+    } catch (const core::IndexException& e) {
+        throw damaged(e.what());
+    }
+    uint32_t nodes = meta.nodes;
+    uint32_t rows = meta.rows;
+    if (index->padded_ != meta.padded || index->options_.m != meta.m || rows % kBlockNodes != 0 || nodes > rows ||
+        rows / kBlockNodes > kMaxBlocks || meta.upper_nodes > nodes || (nodes > 0 && meta.entry_point >= nodes) ||
+        meta.live > nodes) {
+        throw damaged("inconsistent meta section");
+    }
+
+    // Each column must hold exactly rows rows
+    auto columnOf = [&](uint32_t tag, size_t row_bytes) {
+        auto bytes = file.mutableArray<uint8_t>(tag);
+        if (bytes.size() != static_cast<size_t>(rows) * row_bytes) throw damaged("bad column size");
+        return bytes.data();
+    };
+    HnswIndex& target = *index;
+    auto* vectors = target.keep_vectors_
+                        ? reinterpret_cast<float*>(columnOf(kVectorsSection, target.padded_ * sizeof(float)))
+                        : nullptr;
+    uint8_t* codes = target.quantizer_ ? columnOf(kCodesSection, target.code_size_) : nullptr;
+    auto* links0 = reinterpret_cast<uint32_t*>(columnOf(kLinks0Section, (1 + target.max_links0_) * sizeof(uint32_t)));
+    auto* upper_offsets = reinterpret_cast<const uint64_t*>(columnOf(kUpperOffsetsSection, sizeof(uint64_t)));
+    std::span<uint32_t> upper = file.mutableArray<uint32_t>(kUpperSection);
+    if (rows > 0 && upper_offsets[rows - 1] != upper.size()) throw damaged("bad upper layer size");
+    uint8_t* levels = columnOf(kLevelsSection, sizeof(uint8_t));
+    auto* labels = reinterpret_cast<core::NodeId*>(columnOf(kLabelsSection, sizeof(core::NodeId)));
+    auto* deleted_at = reinterpret_cast<uint64_t*>(columnOf(kDeletedSection, sizeof(uint64_t)));
+    auto* created_at = reinterpret_cast<uint64_t*>(columnOf(kCreatedSection, sizeof(uint64_t)));
+    auto* tenants = reinterpret_cast<uint32_t*>(columnOf(kTenantsSection, sizeof(uint32_t)));
+    NodeTypeMask* types = columnOf(kTypesSection, sizeof(NodeTypeMask));
+    auto* times = reinterpret_cast<int64_t*>(columnOf(kTimesSection, sizeof(int64_t)));
+
+    for (uint32_t b = 0; b < rows / kBlockNodes; ++b) {
+        size_t first = static_cast<size_t>(b) * kBlockNodes;
+        auto mapped = std::make_unique<Block>();
+        if (vectors) mapped->vectors = vectors + first * target.padded_;
+        if (codes) mapped->codes = codes + first * target.code_size_;
+        mapped->links0 = links0 + first * (1 + target.max_links0_);
+        mapped->levels = levels + first;
+        mapped->labels = labels + first;
+        mapped->deleted_at = deleted_at + first;
+        mapped->created_at = created_at + first;
+        mapped->tenants = tenants + first;
+        mapped->types = types + first;
+        mapped->times = times + first;
+        mapped->upper_offsets = upper_offsets + first;
+        mapped->upper_base = upper.data();
+        mapped->mapped_rows = static_cast<uint32_t>(std::min<size_t>(kBlockNodes, nodes - first));
+        // Only the last block has room for inserts
+        if (mapped->mapped_rows < kBlockNodes) {
+            mapped->upper = std::make_unique<std::unique_ptr<uint32_t[]>[]>(kBlockNodes);
+        }
+        target.blocks_[b].store(mapped.release(), std::memory_order_release);
+    }
+    target.count_.store(nodes, std::memory_order_release);
+    target.snapshot_.store(std::make_shared<const HnswSnapshot>(HnswSnapshot{nodes, target.version_}));
+    target.published_.push_back(target.snapshot_.load());
+    target.entry_point_ = meta.entry_point;
+    target.max_level_ = nodes > 0 ? meta.max_level : -1;
+    target.labels_loaded_ = false;
+    target.mapped_live_ = meta.live;
+
+    auto names = file.section(kTenantNamesSection);
+    for (size_t offset = 0; offset < names.size();) {
+        uint32_t length;
+        if (names.size() - offset < sizeof(length)) throw damaged("bad tenant names");
+        std::memcpy(&length, names.data() + offset, sizeof(length));
+        offset += sizeof(length);
+        if (names.size() - offset < length) throw damaged("bad tenant names");
+        target.tenants_.intern(std::string_view(reinterpret_cast<const char*>(names.data() + offset), length));
+        offset += length;
+    }
+
+    if (load.prefetch_upper_layers && meta.upper_nodes > 0) {
+        size_t upper_nodes = meta.upper_nodes;
+        file.advise(kUpperSection, core::Access::WILLNEED);
+        file.advise(kUpperOffsetsSection, core::Access::WILLNEED, 0, upper_nodes * sizeof(uint64_t));
+        file.advise(kLevelsSection, core::Access::WILLNEED, 0, upper_nodes);
+        file.advise(kLinks0Section, core::Access::WILLNEED, 0, upper_nodes * (1 + target.max_links0_) * sizeof(uint32_t));
+        // Searches compare against the codes if there are any
+        if (target.quantizer_) {
+            file.advise(kCodesSection, core::Access::WILLNEED, 0, upper_nodes * target.code_size_);
+        } else {
+            file.advise(kVectorsSection, core::Access::WILLNEED, 0, upper_nodes * target.padded_ * sizeof(float));
+        }
+    }
+    target.segment_ = std::move(file);
+    return index;
+}
+
+std::unique_ptr<HnswIndex::VisitedList> HnswIndex::acquireVisited() const {
+    std::lock_guard lock(visited_mutex_);
+    if (visited_free_.empty()) return std::make_unique<VisitedList>();
+    std::unique_ptr<VisitedList> visited = std::move(visited_free_.back());
+    visited_free_.pop_back();
+    return visited;
+}
+
+void HnswIndex::releaseVisited(std::unique_ptr<VisitedList> visited) const {
+    std::lock_guard lock(visited_mutex_);
+    visited_free_.push_back(std::move(visited));
+}
+
+} // namespace memory::vector
@@ -0,0 +1,249 @@
+#include "memory/vector/quantizer.h"
+#include "memory/core/errors.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace memory::vector {
+
+namespace {
+
+constexpr size_t kCentroids = ProductQuantizer::kCentroids;
+
+// Distance of slice to each of 256 centroids stored column-wise
+// (sub_dimension x 256); the inner loop runs across centroids, so it
+// vectorizes for any sub_dimension
+void columnDistances(const float* columns, const float* slice, size_t sub_dimension, bool l2, float* out) {
+    std::fill(out, out + kCentroids, 0.0f);
+    for (size_t d = 0; d < sub_dimension; ++d) {
+        const float* column = columns + d * kCentroids;
+        float x = slice[d];
+        if (l2) {
+            for (size_t c = 0; c < kCentroids; ++c) {
+                float diff = x - column[c];
+                out[c] += diff * diff;
+            }
+        } else {
+            for (size_t c = 0; c < kCentroids; ++c) out[c] += x * column[c];
+        }
+    }
+}
+
+uint8_t argmin(const float* values) {
+    return static_cast<uint8_t>(std::min_element(values, values + kCentroids) - values);
+}
+
+// centroids (256 x sub_dimension) -> columns (sub_dimension x 256)
+void transpose(const float* centroids, size_t sub_dimension, float* columns) {
+    for (size_t c = 0; c < kCentroids; ++c) {
+        for (size_t d = 0; d < sub_dimension; ++d) columns[d * kCentroids + c] = centroids[c * sub_dimension + d];
+    }
+}
+
+} // namespace
+
+std::string quantizationToString(Quantization quantization) {
+    switch (quantization) {
+        case Quantization::NONE: return "none";
+        case Quantization::SQ8: return "sq8";
+        case Quantization::PQ: return "pq";
+        default: return "unknown";
+    }
+}
+
+Quantization stringToQuantization(const std::string& str) {
+    if (str == "none") return Quantization::NONE;
+    if (str == "sq8") return Quantization::SQ8;
+    if (str == "pq") return Quantization::PQ;
+    throw std::invalid_argument("Unknown vector quantization: " + str);
+}
+
+// === ScalarQuantizer ===
+
+void ScalarQuantizer::train(std::span<const float> samples, size_t dimension) {
+    if (dimension == 0 || samples.empty() || samples.size() % dimension != 0) {
+        throw core::IndexException("SQ8 training needs whole rows of " + std::to_string(dimension) + " floats");
+    }
+    std::vector<float> low(samples.begin(), samples.begin() + dimension);
+    std::vector<float> high = low;
+    for (size_t offset = dimension; offset < samples.size(); offset += dimension) {
+        for (size_t i = 0; i < dimension; ++i) {
+            low[i] = std::min(low[i], samples[offset + i]);
+            high[i] = std::max(high[i], samples[offset + i]);
+        }
+    }
+    scale_.resize(dimension);
+    for (size_t i = 0; i < dimension; ++i) scale_[i] = (high[i] - low[i]) / 255.0f;
+    min_ = std::move(low);
+}
+
+void ScalarQuantizer::encode(const float* vec, uint8_t* code) const {
+    for (size_t i = 0; i < scale_.size(); ++i) {
+        // A constant dimension (scale 0) always decodes to its minimum
+        float level = scale_[i] > 0.0f ? std::round((vec[i] - min_[i]) / scale_[i]) : 0.0f;
+        code[i] = static_cast<uint8_t>(std::clamp(level, 0.0f, 255.0f));
+    }
+}
+
+void ScalarQuantizer::decode(const uint8_t* code, float* out) const {
+    for (size_t i = 0; i < scale_.size(); ++i) out[i] = min_[i] + scale_[i] * code[i];
+}
+
+void ScalarQuantizer::prepareQuery(const float* query, QueryTable& table) const {
+    size_t n = scale_.size();
+    table.values.resize(n);
+    table.bias = 0.0f;
+    if (metric_ == Metric::L2) {
+        // |q - min - scale * c|^2
+        for (size_t i = 0; i < n; ++i) table.values[i] = query[i] - min_[i];
+    } else {
+        // q . (min + scale * c) = q . min + (q * scale) . c
+        for (size_t i = 0; i < n; ++i) table.values[i] = query[i] * scale_[i];
+        table.bias = kernels_.dot(query, min_.data(), n);
+    }
+}
+
+float ScalarQuantizer::distance(const QueryTable& table, const uint8_t* code) const {
+    size_t n = scale_.size();
+    if (metric_ == Metric::L2) return kernels_.l2_u8(table.values.data(), scale_.data(), code, n);
+    return 1.0f - (table.bias + kernels_.dot_u8(table.values.data(), code, n));
+}
+
+std::vector<float> ScalarQuantizer::state() const {
+    std::vector<float> state(min_);
+    state.insert(state.end(), scale_.begin(), scale_.end());
+    return state;
+}
+
+void ScalarQuantizer::restore(std::span<const float> state, size_t dimension) {
+    if (dimension == 0 || state.size() != 2 * dimension) {
+        throw core::IndexException("SQ8 state of " + std::to_string(state.size()) + " floats does not fit dimension " +
+                                   std::to_string(dimension));
+    }
+    min_.assign(state.begin(), state.begin() + dimension);
+    scale_.assign(state.begin() + dimension, state.end());
+}
+
+// === ProductQuantizer ===
+
+void ProductQuantizer::train(std::span<const float> samples, size_t dimension) {
+    size_t subspaces = options_.subspaces;
+    if (subspaces == 0 || dimension % subspaces != 0) {
+        throw core::IndexException("PQ subspaces (" + std::to_string(subspaces) + ") must divide dimension " +
+                                   std::to_string(dimension));
+    }
+    if (samples.empty() || samples.size() % dimension != 0) {
+        throw core::IndexException("PQ training needs whole rows of " + std::to_string(dimension) + " floats");
+    }
+    sub_dimension_ = dimension / subspaces;
+
+    std::mt19937_64 rng(options_.seed);
+    std::vector<size_t> rows(samples.size() / dimension);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::shuffle(rows.begin(), rows.end(), rng);
+    rows.resize(std::min(rows.size(), std::max<size_t>(options_.max_samples, 1)));
+    size_t n = rows.size();
+    size_t k = std::min(n, kCentroids);
+
+    centroids_.assign(subspaces * kCentroids * sub_dimension_, 0.0f);
+    columns_.assign(centroids_.size(), 0.0f);
+    std::vector<float> slices(n * sub_dimension_);
+    std::vector<float> sums(kCentroids * sub_dimension_);
+    std::vector<uint32_t> counts(kCentroids);
+    std::vector<float> distances(kCentroids);
+    for (size_t s = 0; s < subspaces; ++s) {
+        for (size_t r = 0; r < n; ++r) {
+            const float* source = samples.data() + rows[r] * dimension + s * sub_dimension_;
+            std::copy(source, source + sub_dimension_, slices.data() + r * sub_dimension_);
+        }
+        float* centers = centroids_.data() + s * kCentroids * sub_dimension_;
+        float* columns = columns_.data() + s * kCentroids * sub_dimension_;
+        // Rows are shuffled, so the first k are a random pick; the rest of
+        // the 256 repeat them until training fills them
+        for (size_t c = 0; c < kCentroids; ++c) {
+            std::copy_n(slices.data() + (c % k) * sub_dimension_, sub_dimension_, centers + c * sub_dimension_);
+        }
+        for (size_t round = 0; round < options_.iterations; ++round) {
+            transpose(centers, sub_dimension_, columns);
+            std::fill(sums.begin(), sums.end(), 0.0f);
+            std::fill(counts.begin(), counts.end(), 0);
+            for (size_t r = 0; r < n; ++r) {
+                const float* slice = slices.data() + r * sub_dimension_;
+                columnDistances(columns, slice, sub_dimension_, true, distances.data());
+                uint8_t c = argmin(distances.data());
+                ++counts[c];
+                for (size_t d = 0; d < sub_dimension_; ++d) sums[c * sub_dimension_ + d] += slice[d];
+            }
+            for (size_t c = 0; c < kCentroids; ++c) {
+                float* center = centers + c * sub_dimension_;
+                if (counts[c] == 0) {
+                    // Empty cluster: restart it at a random sample
+                    std::copy_n(slices.data() + (rng() % n) * sub_dimension_, sub_dimension_, center);
+                    continue;
+                }
+                for (size_t d = 0; d < sub_dimension_; ++d) center[d] = sums[c * sub_dimension_ + d] / counts[c];
+            }
+        }
+        transpose(centers, sub_dimension_, columns);
+    }
+}
+
+uint8_t ProductQuantizer::nearest(size_t s, const float* slice) const {
+    float distances[kCentroids];
+    columnDistances(columns_.data() + s * kCentroids * sub_dimension_, slice, sub_dimension_, true, distances);
+    return argmin(distances);
+}
+
+void ProductQuantizer::encode(const float* vec, uint8_t* code) const {
+    for (size_t s = 0; s < options_.subspaces; ++s) code[s] = nearest(s, vec + s * sub_dimension_);
+}
+
+void ProductQuantizer::decode(const uint8_t* code, float* out) const {
+    for (size_t s = 0; s < options_.subspaces; ++s) {
+        std::copy_n(centroid(s, code[s]), sub_dimension_, out + s * sub_dimension_);
+    }
+}
+
+void ProductQuantizer::prepareQuery(const float* query, QueryTable& table) const {
+    // Row s holds the query slice's partial dot product or squared
+    // distance to each centroid of subspace s
+    table.values.resize(options_.subspaces * kCentroids);
+    table.bias = 0.0f;
+    for (size_t s = 0; s < options_.subspaces; ++s) {
+        columnDistances(columns_.data() + s * kCentroids * sub_dimension_, query + s * sub_dimension_,
+                        sub_dimension_, metric_ == Metric::L2, table.values.data() + s * kCentroids);
+    }
+}
+
+float ProductQuantizer::distance(const QueryTable& table, const uint8_t* code) const {
+    float sum = kernels_.lookup_sum(table.values.data(), code, options_.subspaces);
+    return metric_ == Metric::L2 ? sum : 1.0f - sum;
+}
+
+void ProductQuantizer::restore(std::span<const float> state, size_t dimension) {
+    size_t subspaces = options_.subspaces;
+    if (subspaces == 0 || dimension % subspaces != 0 || state.size() != kCentroids * dimension) {
+        throw core::IndexException("PQ state of " + std::to_string(state.size()) + " floats does not fit " +
+                                   std::to_string(subspaces) + " subspaces of dimension " + std::to_string(dimension));
+    }
+    sub_dimension_ = dimension / subspaces;
+    centroids_.assign(state.begin(), state.end());
+    columns_.resize(centroids_.size());
+    for (size_t s = 0; s < subspaces; ++s) {
+        size_t offset = s * kCentroids * sub_dimension_;
+        transpose(centroids_.data() + offset, sub_dimension_, columns_.data() + offset);
+    }
+}
+
+std::unique_ptr<Quantizer> makeQuantizer(Quantization quantization, Metric metric, const DistanceKernels& kernels,
+                                         ProductQuantizerOptions pq) {
+    switch (quantization) {
+        case Quantization::SQ8: return std::make_unique<ScalarQuantizer>(metric, kernels);
+        case Quantization::PQ: return std::make_unique<ProductQuantizer>(metric, kernels, pq);
+        default: return nullptr;
+    }
+}
+
+} // namespace memory::vector